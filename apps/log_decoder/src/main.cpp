@@ -0,0 +1,35 @@
+#include <fstream>
+#include <iostream>
+
+#include "cpptemplate/core/binary_log.hpp"
+
+#ifndef APP_VERSION
+#define APP_VERSION "unknown"
+#endif
+
+#ifndef APP_NAME
+#define APP_NAME "CppTemplate Log Decoder"
+#endif
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << APP_NAME << " v" << APP_VERSION << "\n"
+                  << "Usage: " << argv[0] << " <binary-log-file>" << std::endl;
+        return 2;
+    }
+
+    try {
+        std::ifstream input(argv[1], std::ios::binary);
+        if (!input) {
+            std::cerr << "Error: cannot open " << argv[1] << std::endl;
+            return 1;
+        }
+
+        cpptemplate::core::BinaryLog::decode(input, std::cout);
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cpptemplate/core/logger.hpp"
+#include "cpptemplate/network/http.hpp"
+#include "cpptemplate/network/tcp_server.hpp"
+
+namespace cpptemplate::server {
+
+/**
+ * @brief What a handler answers with
+ *
+ * Header names, header values and body are views, so a handler can answer
+ * with literals or parts of the request without copying; a body built for
+ * the reply goes in owned_body.
+ */
+struct Reply {
+    static constexpr std::size_t MaxHeaders = 8;
+
+    int status = 200;
+    std::string_view body;  ///< Must stay valid until the reply is sent
+    std::string owned_body; ///< Sent instead of body if not empty
+
+    /**
+     * @brief Add a header
+     * @throws std::length_error If MaxHeaders are already set
+     */
+    Reply& header(std::string_view name, std::string_view value);
+
+    [[nodiscard]] std::span<const network::HttpHeader> headers() const noexcept {
+        return {header_fields.data(), header_count};
+    }
+
+    std::array<network::HttpHeader, MaxHeaders> header_fields{};
+    std::size_t header_count = 0;
+};
+
+/// Produces the reply to a request
+using Handler = std::function<void(const network::HttpRequest& request, Reply& reply)>;
+
+/// Runs after the handler, e.g. to add headers or log
+using Middleware = std::function<void(const network::HttpRequest& request, Reply& reply)>;
+
+/**
+ * @brief Maps method and path to a handler
+ *
+ * Paths are matched exactly. A known path with another method is answered
+ * with 405, an unknown one with 404.
+ */
+class Router {
+public:
+    /// Register handler for method and path, replacing any previous one
+    void add(std::string_view method, std::string_view path, Handler handler);
+
+    /// Run the handler of the request, or fill in a 404 or 405 reply
+    void route(const network::HttpRequest& request, Reply& reply) const;
+
+private:
+    std::map<std::string, std::map<std::string, Handler, std::less<>>, std::less<>> routes_; ///< path -> method
+};
+
+/**
+ * @brief HTTP/1.1 server on network::TcpServer
+ *
+ * Each connection keeps an HttpParser; requests are parsed in place in the
+ * receive buffer, pipelined ones in a loop, and each reply goes out as one
+ * gather write of head and body. Malformed requests are answered with their
+ * status and the connection is closed.
+ */
+class HttpServer {
+public:
+    explicit HttpServer(network::ServerOptions options, network::HttpLimits limits = {});
+
+    [[nodiscard]] Router& router() noexcept {
+        return router_;
+    }
+
+    /// Add middleware; call before start(), they run in the order added
+    void use(Middleware middleware) {
+        middleware_.push_back(std::move(middleware));
+    }
+
+    void start() {
+        server_.start();
+    }
+
+    void stop() {
+        server_.stop();
+    }
+
+    [[nodiscard]] std::uint16_t port() const noexcept {
+        return server_.port();
+    }
+
+    [[nodiscard]] network::ServerStats stats() const noexcept {
+        return server_.stats();
+    }
+
+private:
+    std::size_t on_data(network::Connection& connection, std::string_view bytes);
+
+    network::TcpServer server_;
+    network::HttpLimits limits_;
+    Router router_;
+    std::vector<Middleware> middleware_;
+};
+
+/// Register the built-in routes: GET /, GET /health and POST /echo
+void register_handlers(Router& router);
+
+/// Middleware adding a Server header
+[[nodiscard]] Middleware server_header();
+
+/// Middleware logging method, target and status of each request at info level
+[[nodiscard]] Middleware access_log(std::shared_ptr<core::Logger> logger);
+
+} // namespace cpptemplate::server
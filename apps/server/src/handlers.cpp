@@ -1 +1,28 @@
-// Stub implementation
+#include "http_server.hpp"
+
+namespace cpptemplate::server {
+
+#ifndef APP_VERSION
+#define APP_VERSION "unknown"
+#endif
+
+void register_handlers(Router& router) {
+    router.add("GET", "/", [](const network::HttpRequest&, Reply& reply) {
+        reply.header("Content-Type", "text/plain");
+        reply.body = "Hello from CppTemplate Server " APP_VERSION "\n";
+    });
+
+    router.add("GET", "/health", [](const network::HttpRequest&, Reply& reply) {
+        reply.header("Content-Type", "application/json");
+        reply.body = "{\"status\":\"ok\"}";
+    });
+
+    // The body answered is a view of the receive buffer, sent back without a copy
+    router.add("POST", "/echo", [](const network::HttpRequest& request, Reply& reply) {
+        const std::string_view type = request.header("Content-Type");
+        reply.header("Content-Type", type.empty() ? "application/octet-stream" : type);
+        reply.body = request.body;
+    });
+}
+
+} // namespace cpptemplate::server
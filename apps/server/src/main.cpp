@@ -1 +1,69 @@
-// Stub implementation
+#include <csignal>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+
+#include "cpptemplate/core/logger.hpp"
+#include "cpptemplate/utils/number_utils.hpp"
+#include "http_server.hpp"
+
+#ifndef APP_VERSION
+#define APP_VERSION "unknown"
+#endif
+
+#ifndef APP_NAME
+#define APP_NAME "CppTemplate Server"
+#endif
+
+// Usage: cpp_template_server [port [threads]]
+int main(int argc, char* argv[]) {
+    try {
+        auto logger = cpptemplate::core::Logger::create("Server");
+
+        cpptemplate::network::ServerOptions options;
+        options.port = 8080;
+        if (argc > 1) {
+            const auto port = cpptemplate::utils::parse_int(argv[1]);
+            if (!port.has_value() || port.value() < 0 || port.value() > 65535) {
+                std::cerr << "Invalid port: " << argv[1] << '\n';
+                return 1;
+            }
+            options.port = static_cast<std::uint16_t>(port.value());
+        }
+        if (argc > 2) {
+            const auto threads = cpptemplate::utils::parse_int(argv[2]);
+            if (!threads.has_value() || threads.value() < 1) {
+                std::cerr << "Invalid thread count: " << argv[2] << '\n';
+                return 1;
+            }
+            options.threads = static_cast<std::size_t>(threads.value());
+        }
+
+        // Block the stop signals before the event loops start, so they inherit the mask
+        // and the signals are left for sigwait() below
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        cpptemplate::server::HttpServer server(options);
+        cpptemplate::server::register_handlers(server.router());
+        server.use(cpptemplate::server::server_header());
+        server.use(cpptemplate::server::access_log(logger));
+        server.start();
+        logger->info("{} v{} listening on port {}", APP_NAME, APP_VERSION, server.port());
+
+        int received = 0;
+        sigwait(&signals, &received);
+        logger->info("Stopping on signal {}", received);
+        const auto stats = server.stats();
+        server.stop();
+        logger->info("Served {} connections, {} bytes in, {} bytes out", stats.accepted, stats.bytes_received,
+                     stats.bytes_sent);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+}
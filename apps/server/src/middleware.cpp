@@ -1 +1,25 @@
-// Stub implementation
+#include "http_server.hpp"
+
+#include <utility>
+
+namespace cpptemplate::server {
+
+#ifndef APP_NAME
+#define APP_NAME "CppTemplate Server"
+#endif
+
+Middleware server_header() {
+    return [](const network::HttpRequest&, Reply& reply) {
+        if (reply.header_count < Reply::MaxHeaders) {
+            reply.header("Server", APP_NAME);
+        }
+    };
+}
+
+Middleware access_log(std::shared_ptr<core::Logger> logger) {
+    return [logger = std::move(logger)](const network::HttpRequest& request, Reply& reply) {
+        logger->info("{} {} -> {}", request.method, request.target, reply.status);
+    };
+}
+
+} // namespace cpptemplate::server
@@ -1 +1,106 @@
-// Stub implementation
+#include "http_server.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace cpptemplate::server {
+
+using network::Connection;
+using network::HttpParser;
+using network::HttpParseResult;
+using network::HttpRequest;
+using network::HttpResponse;
+
+namespace {
+
+/// Send reply as one gather write of head and body
+bool send_reply(Connection& connection, const Reply& reply, bool keep_alive) {
+    HttpResponse response(reply.status);
+    for (const network::HttpHeader& field : reply.headers()) {
+        response.header(field.name, field.value);
+    }
+    response.body(reply.owned_body.empty() ? reply.body : std::string_view(reply.owned_body)).keep_alive(keep_alive);
+    return response.send(connection);
+}
+
+} // namespace
+
+Reply& Reply::header(std::string_view name, std::string_view value) {
+    if (header_count == MaxHeaders) {
+        throw std::length_error("Too many reply headers");
+    }
+    header_fields[header_count++] = {name, value};
+    return *this;
+}
+
+void Router::add(std::string_view method, std::string_view path, Handler handler) {
+    auto by_path = routes_.find(path);
+    if (by_path == routes_.end()) {
+        by_path = routes_.emplace(std::string(path), std::map<std::string, Handler, std::less<>>{}).first;
+    }
+    by_path->second.insert_or_assign(std::string(method), std::move(handler));
+}
+
+void Router::route(const HttpRequest& request, Reply& reply) const {
+    const auto by_path = routes_.find(request.path);
+    if (by_path == routes_.end()) {
+        reply.status = 404;
+        reply.body = "Not Found\n";
+        return;
+    }
+    const auto handler = by_path->second.find(request.method);
+    if (handler == by_path->second.end()) {
+        reply.status = 405;
+        reply.body = "Method Not Allowed\n";
+        return;
+    }
+    handler->second(request, reply);
+}
+
+HttpServer::HttpServer(network::ServerOptions options, network::HttpLimits limits)
+    : server_(std::move(options)), limits_(limits) {
+    server_.on_connect(
+        [this](Connection& connection) { connection.set_user_data(std::make_shared<HttpParser>(limits_)); });
+    server_.on_data([this](Connection& connection, std::string_view bytes) { return on_data(connection, bytes); });
+}
+
+std::size_t HttpServer::on_data(Connection& connection, std::string_view bytes) {
+    auto& parser = *connection.user_data<HttpParser>();
+    HttpRequest request;
+    std::size_t consumed = 0;
+    // Pipelined requests are answered in order from the same buffer
+    while (consumed < bytes.size()) {
+        const HttpParseResult result = parser.parse(bytes.substr(consumed), request);
+        if (result.status == HttpParseResult::Status::Incomplete) {
+            break;
+        }
+        if (result.status == HttpParseResult::Status::Error) {
+            Reply reply;
+            reply.status = result.error;
+            reply.body = network::http_reason(result.error);
+            send_reply(connection, reply, false);
+            connection.close();
+            return bytes.size();
+        }
+        consumed += result.consumed;
+
+        Reply reply;
+        try {
+            router_.route(request, reply);
+            for (const Middleware& middleware : middleware_) {
+                middleware(request, reply);
+            }
+        } catch (const std::exception&) {
+            reply = Reply{};
+            reply.status = 500;
+            reply.body = "Internal Server Error\n";
+        }
+        if (!send_reply(connection, reply, request.keep_alive) || !request.keep_alive) {
+            connection.close();
+            return bytes.size();
+        }
+    }
+    return consumed;
+}
+
+} // namespace cpptemplate::server
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cpptemplate::benchmarks {
+
+/**
+ * @brief Number of global operator new calls so far in this process
+ *
+ * The benchmark binary replaces the global allocation functions to count
+ * calls; take the difference across a benchmark loop to get allocations per
+ * iteration.
+ *
+ * @return Allocation count
+ */
+[[nodiscard]] std::size_t allocation_count() noexcept;
+
+} // namespace cpptemplate::benchmarks
@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "cpptemplate/core/config.hpp"
+
+using namespace cpptemplate::core;
+
+namespace {
+
+std::string make_config(int generation) {
+    std::string text = "[server]\nport = " + std::to_string(8000 + generation % 100) + "\n";
+    text += "host = \"server-" + std::to_string(generation) + ".example.com\"\n";
+    // Pad with enough keys that parsing a reload is not trivial
+    for (int i = 0; i < 200; ++i) {
+        text += "key" + std::to_string(i) + " = " + std::to_string(i * generation) + "\n";
+    }
+    return text;
+}
+
+Config& shared_config() {
+    static Config config;
+    static const bool loaded = (config.load_string(make_config(0)), true);
+    static_cast<void>(loaded);
+    return config;
+}
+
+/// Reloads the shared config in a loop while the benchmark runs (range(0) != 0)
+class Reloader {
+public:
+    void start(benchmark::State& state) {
+        if (state.thread_index() != 0 || state.range(0) == 0) {
+            return;
+        }
+        stop_ = false;
+        reloads_ = 0;
+        thread_ = std::thread([this] {
+            auto& config = shared_config();
+            for (int generation = 1; !stop_.load(std::memory_order_relaxed); ++generation) {
+                config.load_string(make_config(generation));
+                reloads_.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    void stop(benchmark::State& state) {
+        if (state.thread_index() != 0 || !thread_.joinable()) {
+            return;
+        }
+        stop_ = true;
+        thread_.join();
+        state.counters["reloads"] = benchmark::Counter(static_cast<double>(reloads_.load()),
+                                                       benchmark::Counter::kIsRate);
+    }
+
+private:
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    std::atomic<std::int64_t> reloads_{0};
+};
+
+Reloader reloader;
+
+} // namespace
+
+// Typed handle: one hazard-pointer publish plus an array access
+static void BM_ConfigHandleRead(benchmark::State& state) {
+    auto& config = shared_config();
+    auto port = config.handle<std::int64_t>("server.port");
+    reloader.start(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(port.value_or(0));
+    }
+    reloader.stop(state);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConfigHandleRead)->ArgName("reloading")->Arg(0)->Arg(1)
+    ->Threads(1)->Threads(4)->Threads(8)->UseRealTime();
+
+static void BM_ConfigHandleReadString(benchmark::State& state) {
+    auto& config = shared_config();
+    auto host = config.handle<std::string>("server.host");
+    reloader.start(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(host.value_or(""));
+    }
+    reloader.stop(state);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConfigHandleReadString)->ArgName("reloading")->Arg(0)->Arg(1)
+    ->Threads(1)->Threads(8)->UseRealTime();
+
+// Lookup by name: hashes the key and takes the key-table lock on every call
+static void BM_ConfigNamedGet(benchmark::State& state) {
+    auto& config = shared_config();
+    reloader.start(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(config.get<std::int64_t>("server.port"));
+    }
+    reloader.stop(state);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConfigNamedGet)->ArgName("reloading")->Arg(0)->Arg(1)
+    ->Threads(1)->Threads(8)->UseRealTime();
@@ -0,0 +1,269 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include "cpptemplate/core/logger.hpp"
+#include "cpptemplate/core/logger_registry.hpp"
+#include "cpptemplate/core/mapped_file_sink.hpp"
+
+using namespace cpptemplate::core;
+
+namespace {
+
+// Debug records are below the console threshold, so only the file sink does I/O
+std::shared_ptr<Logger>& sync_logger() {
+    static auto logger = Logger::create("BenchSync", {.level = spdlog::level::debug});
+    return logger;
+}
+
+std::shared_ptr<Logger>& async_logger(OverflowPolicy policy) {
+    static auto block = Logger::create(
+        "BenchAsyncBlock", {.mode = LogMode::Async,
+                            .overflow_policy = OverflowPolicy::Block,
+                            .level = spdlog::level::debug});
+    static auto drop_newest = Logger::create(
+        "BenchAsyncDropNewest", {.mode = LogMode::Async,
+                                 .overflow_policy = OverflowPolicy::DropNewest,
+                                 .level = spdlog::level::debug});
+    return policy == OverflowPolicy::Block ? block : drop_newest;
+}
+
+// File sinks driven directly, same pattern and rotation size as the registry's file sink
+std::shared_ptr<spdlog::logger> file_sink_logger(const std::string& name, spdlog::sink_ptr sink,
+                                                 spdlog::level::level_enum flush_level) {
+    sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%s:%#] %v");
+    auto logger = std::make_shared<spdlog::logger>(name, std::move(sink));
+    logger->set_level(spdlog::level::debug);
+    logger->flush_on(flush_level);
+    return logger;
+}
+
+double percentile(std::vector<std::int64_t>& samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const auto rank = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank),
+                     samples.end());
+    return static_cast<double>(samples[rank]);
+}
+
+// Stands in for an expensive log argument
+double sum_history(const std::vector<double>& history) {
+    double sum = 0.0;
+    for (double value : history) {
+        sum += value;
+    }
+    return sum;
+}
+
+template<typename LogCall>
+void run_latency_benchmark(benchmark::State& state, LogCall&& log_call) {
+    std::vector<std::int64_t> samples;
+    samples.reserve(1 << 20);
+
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        log_call(i);
+        const auto stop = std::chrono::steady_clock::now();
+        if (samples.size() < samples.capacity()) {
+            samples.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        }
+        ++i;
+    }
+
+    state.counters["p50_ns"] = benchmark::Counter(percentile(samples, 0.50),
+                                                  benchmark::Counter::kAvgThreads);
+    state.counters["p99_ns"] = benchmark::Counter(percentile(samples, 0.99),
+                                                  benchmark::Counter::kAvgThreads);
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+static void BM_LoggerSync(benchmark::State& state) {
+    auto& logger = sync_logger();
+    run_latency_benchmark(state, [&](std::int64_t i) {
+        logger->debug("request {} handled in {} us by worker {}", i, 42.5, state.thread_index());
+    });
+}
+BENCHMARK(BM_LoggerSync)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
+
+static void BM_LoggerAsyncBlock(benchmark::State& state) {
+    auto& logger = async_logger(OverflowPolicy::Block);
+    run_latency_benchmark(state, [&](std::int64_t i) {
+        logger->debug("request {} handled in {} us by worker {}", i, 42.5, state.thread_index());
+    });
+    if (state.thread_index() == 0) {
+        state.counters["dropped"] = static_cast<double>(logger->dropped_messages());
+    }
+}
+BENCHMARK(BM_LoggerAsyncBlock)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
+
+static void BM_LoggerAsyncDropNewest(benchmark::State& state) {
+    auto& logger = async_logger(OverflowPolicy::DropNewest);
+    run_latency_benchmark(state, [&](std::int64_t i) {
+        logger->debug("request {} handled in {} us by worker {}", i, 42.5, state.thread_index());
+    });
+    if (state.thread_index() == 0) {
+        state.counters["dropped"] = static_cast<double>(logger->dropped_messages());
+    }
+}
+BENCHMARK(BM_LoggerAsyncDropNewest)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
+
+// Formatting happens on the backend thread; the caller only copies the arguments
+static void BM_LoggerDeferred(benchmark::State& state) {
+    static auto logger = Logger::create("BenchDeferred", {.level = spdlog::level::debug});
+    run_latency_benchmark(state, [&](std::int64_t i) {
+        logger->log_deferred(spdlog::level::debug, "request {} handled in {} us by worker {}", i,
+                             42.5, state.thread_index());
+    });
+}
+BENCHMARK(BM_LoggerDeferred)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
+
+// Disabled levels: the call should cost about as much as the baseline branch
+static void BM_LoggerDisabledBaseline(benchmark::State& state) {
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(i);
+        ++i;
+    }
+}
+BENCHMARK(BM_LoggerDisabledBaseline);
+
+static void BM_LoggerDisabledCall(benchmark::State& state) {
+    static auto logger = Logger::create("BenchDisabled", {.level = spdlog::level::warn});
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(i);
+        logger->debug("request {} handled in {} us by worker {}", i, 42.5, 7);
+        ++i;
+    }
+}
+BENCHMARK(BM_LoggerDisabledCall);
+
+static void BM_LoggerDisabledLazyCall(benchmark::State& state) {
+    static auto logger = Logger::create("BenchDisabledLazy", {.level = spdlog::level::warn});
+    std::vector<double> history(4096, 1.0);
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(i);
+        logger->debug("request {} history sum {}", i, lazy([&history] {
+            return sum_history(history);
+        }));
+        ++i;
+    }
+}
+BENCHMARK(BM_LoggerDisabledLazyCall);
+
+// A disabled member call still evaluates its arguments; the macro does not
+static void BM_LoggerDisabledCallCostlyArgument(benchmark::State& state) {
+    static auto logger = Logger::create("BenchDisabledCostly", {.level = spdlog::level::warn});
+    std::vector<double> history(4096, 1.0);
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(i);
+        logger->debug("request {} history sum {}", i, sum_history(history));
+        ++i;
+    }
+}
+BENCHMARK(BM_LoggerDisabledCallCostlyArgument);
+
+static void BM_LoggerDisabledMacroCostlyArgument(benchmark::State& state) {
+    static auto logger = Logger::create("BenchDisabledMacro", {.level = spdlog::level::warn});
+    std::vector<double> history(4096, 1.0);
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(i);
+        CPPTEMPLATE_LOG_DEBUG(logger, "request {} history sum {}", i, sum_history(history));
+        ++i;
+    }
+}
+BENCHMARK(BM_LoggerDisabledMacroCostlyArgument);
+
+// Registry: cached lookups and per-connection child loggers
+static void BM_LoggerRegistryFind(benchmark::State& state) {
+    auto& registry = LoggerRegistry::instance();
+    static_cast<void>(sync_logger());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(registry.find("BenchSync"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerRegistryFind)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
+
+static void BM_LoggerChildPerConnection(benchmark::State& state) {
+    auto& parent = sync_logger();
+    std::int64_t connection = 0;
+    for (auto _ : state) {
+        auto child = parent->child("conn");
+        child->debug("connection {} accepted", connection++);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerChildPerConnection)->Threads(1)->Threads(8)->UseRealTime();
+
+// What every Logger::create used to cost: fresh sinks, file open and formatters
+static void BM_LoggerPerLoggerSinks(benchmark::State& state) {
+    std::int64_t connection = 0;
+    for (auto _ : state) {
+        auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+        console_sink->set_level(spdlog::level::info);
+        console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v");
+        auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+            "logs/app.log", 1024 * 1024 * 5, 3);
+        file_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%s:%#] %v");
+        spdlog::logger logger("BenchSync.conn", {console_sink, file_sink});
+        logger.set_level(spdlog::level::debug);
+        logger.debug("connection {} accepted", connection++);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerPerLoggerSinks)->Threads(1)->Threads(8)->UseRealTime();
+
+// Sustained multi-threaded load on the file sink alone
+static void BM_FileSinkRotating(benchmark::State& state) {
+    static auto logger = file_sink_logger(
+        "BenchRotating",
+        std::make_shared<spdlog::sinks::rotating_file_sink_mt>("logs/bench_rotating.log",
+                                                               5 * 1024 * 1024, 3),
+        spdlog::level::err);
+    run_latency_benchmark(state, [&](std::int64_t i) {
+        logger->debug("request {} handled in {} us by worker {}", i, 42.5, state.thread_index());
+    });
+}
+BENCHMARK(BM_FileSinkRotating)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
+
+// What crash safety costs with the rotating sink: a flush per record
+static void BM_FileSinkRotatingFlushEach(benchmark::State& state) {
+    static auto logger = file_sink_logger(
+        "BenchRotatingFlush",
+        std::make_shared<spdlog::sinks::rotating_file_sink_mt>("logs/bench_rotating_flush.log",
+                                                               5 * 1024 * 1024, 3),
+        spdlog::level::trace);
+    run_latency_benchmark(state, [&](std::int64_t i) {
+        logger->debug("request {} handled in {} us by worker {}", i, 42.5, state.thread_index());
+    });
+}
+BENCHMARK(BM_FileSinkRotatingFlushEach)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
+
+static void BM_FileSinkMapped(benchmark::State& state) {
+    static auto logger = file_sink_logger(
+        "BenchMapped",
+        std::make_shared<MappedFileSink>(
+            MappedFileSinkOptions{"logs/bench_mapped.log", 5 * 1024 * 1024, 3}),
+        spdlog::level::err);
+    run_latency_benchmark(state, [&](std::int64_t i) {
+        logger->debug("request {} handled in {} us by worker {}", i, 42.5, state.thread_index());
+    });
+}
+BENCHMARK(BM_FileSinkMapped)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
@@ -0,0 +1,200 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/math/calculator.hpp"
+
+using namespace cpptemplate::math;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+
+namespace {
+
+/// Divisors of which range(0) percent are zero, shuffled deterministically
+std::vector<double> make_divisors(benchmark::State& state) {
+    constexpr std::size_t Count = 4096;
+    const auto zeros = Count * static_cast<std::size_t>(state.range(0)) / 100;
+    std::vector<double> divisors(Count, 3.0);
+    for (std::size_t i = 0; i < zeros; ++i) {
+        divisors[i] = 0.0;
+    }
+    std::mt19937 rng(42);
+    std::shuffle(divisors.begin(), divisors.end(), rng);
+    return divisors;
+}
+
+/// Operands for batch benchmarks, 1% zero divisors like make_divisors(1)
+struct BatchData {
+    explicit BatchData(std::size_t n) : a(n), b(n, 3.0), out(n), errors(n) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> dist(-100.0, 100.0);
+        for (std::size_t i = 0; i < n; ++i) {
+            a[i] = dist(rng);
+            b[i] = i % 100 == 0 ? 0.0 : dist(rng);
+        }
+    }
+
+    std::vector<double> a;
+    std::vector<double> b;
+    std::vector<double> out;
+    std::vector<std::uint8_t> errors;
+};
+
+/// Selects range(1) as the kernel level, skipping levels the CPU lacks
+bool select_level(benchmark::State& state) {
+    const auto requested = static_cast<SimdLevel>(state.range(1));
+    if (set_simd_level(requested) != requested) {
+        state.SkipWithError("SIMD level not supported on this CPU");
+        return false;
+    }
+    state.SetLabel(std::string(to_string(requested)));
+    return true;
+}
+
+void batch_args(benchmark::internal::Benchmark* bench) {
+    for (const std::int64_t n : {1 << 10, 1 << 16, 1 << 20}) {
+        for (const auto level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+            bench->Args({n, static_cast<std::int64_t>(level)});
+        }
+    }
+}
+
+} // namespace
+
+// Throwing divide, errors caught per call
+static void BM_CalculatorDivideThrow(benchmark::State& state) {
+    const Calculator calc;
+    const auto divisors = make_divisors(state);
+    std::size_t i = 0;
+    std::size_t errors = 0;
+    for (auto _ : state) {
+        try {
+            benchmark::DoNotOptimize(calc.divide(1.0, divisors[i]));
+        } catch (const std::invalid_argument&) {
+            ++errors;
+        }
+        i = (i + 1) % divisors.size();
+    }
+    state.counters["errors"] = static_cast<double>(errors);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CalculatorDivideThrow)->Arg(0)->Arg(1)->Arg(10);
+
+// Expected-returning divide, errors checked per call
+static void BM_CalculatorDivideExpected(benchmark::State& state) {
+    const Calculator calc;
+    const auto divisors = make_divisors(state);
+    std::size_t i = 0;
+    std::size_t errors = 0;
+    for (auto _ : state) {
+        const auto result = calc.divide(1.0, divisors[i], std::nothrow);
+        if (result) {
+            benchmark::DoNotOptimize(*result);
+        } else {
+            ++errors;
+        }
+        i = (i + 1) % divisors.size();
+    }
+    state.counters["errors"] = static_cast<double>(errors);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CalculatorDivideExpected)->Arg(0)->Arg(1)->Arg(10);
+
+// Batch baseline: one out-of-line scalar call per element
+static void BM_CalculatorAddScalarLoop(benchmark::State& state) {
+    const Calculator calc;
+    BatchData data(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < data.out.size(); ++i) {
+            data.out[i] = calc.add(data.a[i], data.b[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CalculatorAddScalarLoop)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_CalculatorAddBatch(benchmark::State& state) {
+    const Calculator calc;
+    BatchData data(static_cast<std::size_t>(state.range(0)));
+    if (!select_level(state)) {
+        return;
+    }
+    for (auto _ : state) {
+        calc.add(data.a, data.b, data.out);
+        benchmark::ClobberMemory();
+    }
+    set_simd_level(detected_simd_level());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CalculatorAddBatch)->Apply(batch_args);
+
+static void BM_CalculatorDivideScalarLoop(benchmark::State& state) {
+    const Calculator calc;
+    BatchData data(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < data.out.size(); ++i) {
+            const auto result = calc.divide(data.a[i], data.b[i], std::nothrow);
+            data.out[i] = result.value_or(0.0);
+            data.errors[i] = result ? 0 : 1;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CalculatorDivideScalarLoop)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_CalculatorDivideBatch(benchmark::State& state) {
+    const Calculator calc;
+    BatchData data(static_cast<std::size_t>(state.range(0)));
+    if (!select_level(state)) {
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calc.divide(data.a, data.b, data.out, data.errors));
+        benchmark::ClobberMemory();
+    }
+    set_simd_level(detected_simd_level());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CalculatorDivideBatch)->Apply(batch_args);
+
+static void BM_CalculatorSqrtScalarLoop(benchmark::State& state) {
+    const Calculator calc;
+    BatchData data(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < data.out.size(); ++i) {
+            const auto result = calc.sqrt(data.a[i], std::nothrow);
+            data.out[i] = result.value_or(0.0);
+            data.errors[i] = result ? 0 : 1;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CalculatorSqrtScalarLoop)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_CalculatorSqrtBatch(benchmark::State& state) {
+    const Calculator calc;
+    BatchData data(static_cast<std::size_t>(state.range(0)));
+    if (!select_level(state)) {
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calc.sqrt(data.a, data.out, data.errors));
+        benchmark::ClobberMemory();
+    }
+    set_simd_level(detected_simd_level());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CalculatorSqrtBatch)->Apply(batch_args);
@@ -0,0 +1,120 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "cpptemplate/math/expression.hpp"
+
+using namespace cpptemplate::math;
+
+namespace {
+
+constexpr const char* Formula = "sqrt(x^2 + y^2) * z - (x - y) / (z + 2) + 0.5 * x * y";
+
+/// Three random columns of the given length, shared by every benchmark
+std::array<std::vector<double>, 3>& columns(std::size_t rows) {
+    static std::array<std::vector<double>, 3> data;
+    if (data[0].size() != rows) {
+        std::mt19937_64 rng(9);
+        std::uniform_real_distribution<double> dist(-10.0, 10.0);
+        for (auto& column : data) {
+            column.resize(rows);
+            for (auto& v : column) {
+                v = dist(rng);
+            }
+        }
+    }
+    return data;
+}
+
+std::array<std::span<const double>, 3> spans(std::size_t rows) {
+    auto& data = columns(rows);
+    return {data[0], data[1], data[2]};
+}
+
+} // namespace
+
+static void BM_ExpressionBatch(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const auto expr = Expression::compile(Formula);
+    const auto input = spans(rows);
+    std::vector<double> out(rows);
+    for (auto _ : state) {
+        expr.evaluate(input, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["instructions"] = static_cast<double>(expr.instructions().size());
+}
+BENCHMARK(BM_ExpressionBatch)->Arg(1'000)->Arg(100'000)->Arg(10'000'000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ExpressionBatchPool(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const auto expr = Expression::compile(Formula);
+    const auto input = spans(rows);
+    std::vector<double> out(rows);
+    for (auto _ : state) {
+        expr.evaluate(input, out, cpptemplate::core::ThreadPool::shared());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ExpressionBatchPool)->Arg(10'000'000)->Unit(benchmark::kMicrosecond);
+
+/// Baseline: interpret the same program one row at a time
+static void BM_ExpressionPerRow(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const auto expr = Expression::compile(Formula);
+    const auto& data = columns(rows);
+    std::vector<double> out(rows);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < rows; ++i) {
+            const std::array<double, 3> row{data[0][i], data[1][i], data[2][i]};
+            out[i] = expr.evaluate(row);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ExpressionPerRow)->Arg(100'000)->Arg(10'000'000)->Unit(benchmark::kMicrosecond);
+
+/// Ceiling: the formula compiled by the C++ compiler (without the domain checks)
+static void BM_ExpressionNative(benchmark::State& state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    const auto& data = columns(rows);
+    const double* x = data[0].data();
+    const double* y = data[1].data();
+    const double* z = data[2].data();
+    std::vector<double> out(rows);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < rows; ++i) {
+            out[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]) * z[i] - (x[i] - y[i]) / (z[i] + 2) + 0.5 * x[i] * y[i];
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ExpressionNative)->Arg(100'000)->Arg(10'000'000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ExpressionCompile(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Expression::compile(Formula));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExpressionCompile);
+
+static void BM_ExpressionCacheHit(benchmark::State& state) {
+    ExpressionCache cache;
+    (void)cache.get(Formula);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(Formula));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExpressionCacheHit);
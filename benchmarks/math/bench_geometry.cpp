@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "cpptemplate/math/geometry.hpp"
+
+using namespace cpptemplate::math;
+
+namespace {
+
+/// Uniform points in the unit cube, cached per size
+const PointSet<3>& points(std::size_t n) {
+    static std::map<std::size_t, std::unique_ptr<PointSet<3>>> cache;
+    auto& entry = cache[n];
+    if (!entry) {
+        entry = std::make_unique<PointSet<3>>();
+        entry->reserve(n);
+        std::mt19937_64 rng(n);
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        for (std::size_t i = 0; i < n; ++i) {
+            entry->push_back(Point3{{dist(rng), dist(rng), dist(rng)}});
+        }
+    }
+    return *entry;
+}
+
+const PointIndex<3>& index(std::size_t n) {
+    static std::map<std::size_t, std::unique_ptr<PointIndex<3>>> cache;
+    auto& entry = cache[n];
+    if (!entry) {
+        entry = std::make_unique<PointIndex<3>>(points(n));
+    }
+    return *entry;
+}
+
+/// Cubes expected to hold about `expected` of n uniform points
+std::vector<Aabb3> query_boxes(std::size_t n, double expected) {
+    const double side = std::cbrt(expected / static_cast<double>(n));
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> corner(0.0, 1.0 - side);
+    std::vector<Aabb3> boxes(256);
+    for (auto& box : boxes) {
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            box.min[axis] = corner(rng);
+            box.max[axis] = box.min[axis] + side;
+        }
+    }
+    return boxes;
+}
+
+std::vector<Point3> query_points() {
+    std::mt19937_64 rng(43);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<Point3> result(256);
+    for (auto& p : result) {
+        p = Point3{{dist(rng), dist(rng), dist(rng)}};
+    }
+    return result;
+}
+
+} // namespace
+
+static void BM_PointIndexBuild(benchmark::State& state) {
+    const auto& set = points(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        const PointIndex<3> built(set);
+        benchmark::DoNotOptimize(built.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PointIndexBuild)
+    ->Arg(100'000)
+    ->Arg(1'000'000)
+    ->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond);
+
+/// range(0) points, range(1) expected hits per query
+static void BM_PointIndexQuery(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto& tree = index(n);
+    const auto boxes = query_boxes(n, static_cast<double>(state.range(1)));
+    std::vector<std::uint32_t> ids;
+    std::size_t q = 0;
+    std::size_t hits = 0;
+    for (auto _ : state) {
+        ids.clear();
+        hits += tree.query(boxes[q++ % boxes.size()], ids);
+        benchmark::DoNotOptimize(ids.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["hits"] = static_cast<double>(hits) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_PointIndexQuery)
+    ->Args({1'000'000, 10})
+    ->Args({1'000'000, 1'000})
+    ->Args({1'000'000, 100'000})
+    ->Args({10'000'000, 100})
+    ->Unit(benchmark::kMicrosecond);
+
+/// Baseline: a vectorized contains() pass over every point
+static void BM_BruteForceQuery(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto& set = points(n);
+    const auto boxes = query_boxes(n, static_cast<double>(state.range(1)));
+    std::vector<std::uint8_t> inside(n);
+    std::size_t q = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(contains(boxes[q++ % boxes.size()], set, inside));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BruteForceQuery)->Args({1'000'000, 1'000})->Unit(benchmark::kMicrosecond);
+
+/// range(0) points, range(1) neighbours
+static void BM_PointIndexNearest(benchmark::State& state) {
+    const auto& tree = index(static_cast<std::size_t>(state.range(0)));
+    const auto queries = query_points();
+    std::size_t q = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            tree.nearest(queries[q++ % queries.size()], static_cast<std::size_t>(state.range(1))));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PointIndexNearest)
+    ->Args({1'000'000, 1})
+    ->Args({1'000'000, 10})
+    ->Args({1'000'000, 100})
+    ->Args({10'000'000, 10})
+    ->Unit(benchmark::kMicrosecond);
+
+/// Baseline: squared_distances() over every point, then a partial selection
+static void BM_BruteForceNearest(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto& set = points(n);
+    const auto queries = query_points();
+    std::vector<double> distances(n);
+    std::size_t q = 0;
+    for (auto _ : state) {
+        squared_distances(set, queries[q++ % queries.size()], distances);
+        std::nth_element(distances.begin(), distances.begin() + state.range(1), distances.end());
+        benchmark::DoNotOptimize(distances.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BruteForceNearest)->Args({1'000'000, 10})->Unit(benchmark::kMicrosecond);
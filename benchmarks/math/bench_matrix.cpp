@@ -0,0 +1,195 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "common/allocation_counter.hpp"
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/math/matrix.hpp"
+
+using namespace cpptemplate::math;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+
+namespace {
+
+void set_flops(benchmark::State& state, std::size_t n) {
+    const double flops = 2.0 * static_cast<double>(n) * static_cast<double>(n) *
+                         static_cast<double>(n);
+    state.counters["FLOPS"] = benchmark::Counter(flops * static_cast<double>(state.iterations()),
+                                                 benchmark::Counter::kIsRate);
+}
+
+template<typename T>
+Matrix<T> random_matrix(std::size_t rows, std::size_t cols, std::uint32_t seed) {
+    Matrix<T> m(rows, cols);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<T> dist(T{-1}, T{1});
+    for (auto& value : m.elements()) {
+        value = dist(rng);
+    }
+    return m;
+}
+
+// Eager elementwise operations, one temporary per step, for comparison
+
+Matrix<double> eager_add(const Matrix<double>& a, const Matrix<double>& b) {
+    Matrix<double> result(a.rows(), a.cols());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        result.data()[i] = a.data()[i] + b.data()[i];
+    }
+    return result;
+}
+
+Matrix<double> eager_subtract(const Matrix<double>& a, const Matrix<double>& b) {
+    Matrix<double> result(a.rows(), a.cols());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        result.data()[i] = a.data()[i] - b.data()[i];
+    }
+    return result;
+}
+
+Matrix<double> eager_scale(const Matrix<double>& a, double scalar) {
+    Matrix<double> result(a.rows(), a.cols());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        result.data()[i] = a.data()[i] * scalar;
+    }
+    return result;
+}
+
+/// Operands of a + b * 3 - d; reports allocations and logical bytes moved
+struct ExpressionData {
+    explicit ExpressionData(std::size_t n)
+        : a(random_matrix<double>(n, n, 1)),
+          b(random_matrix<double>(n, n, 2)),
+          d(random_matrix<double>(n, n, 3)),
+          result(n, n) {}
+
+    void report(benchmark::State& state, std::size_t allocations) const {
+        state.counters["allocs/iter"] =
+            static_cast<double>(allocations) / static_cast<double>(state.iterations());
+        // Three inputs read and one result written
+        state.SetBytesProcessed(state.iterations() *
+                                static_cast<std::int64_t>(4 * a.size() * sizeof(double)));
+    }
+
+    Matrix<double> a;
+    Matrix<double> b;
+    Matrix<double> d;
+    Matrix<double> result;
+};
+
+void sizes_and_levels(benchmark::internal::Benchmark* bench) {
+    for (const std::int64_t n : {256, 1024}) {
+        for (const auto level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+            bench->Args({n, static_cast<std::int64_t>(level)});
+        }
+    }
+}
+
+} // namespace
+
+// n x n x n GEMM on the detected kernel level, all gemm_threads()
+template<typename T>
+static void BM_MatrixMultiply(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto a = random_matrix<T>(n, n, 1);
+    const auto b = random_matrix<T>(n, n, 2);
+    Matrix<T> c(n, n);
+    for (auto _ : state) {
+        multiply(a, b, c);
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(std::string(to_string(simd_level())));
+    set_flops(state, n);
+}
+BENCHMARK(BM_MatrixMultiply<float>)
+    ->RangeMultiplier(2)->Range(64, 4096)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_MatrixMultiply<double>)
+    ->RangeMultiplier(2)->Range(64, 4096)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Same product with a forced kernel level (range(1)), single-threaded
+static void BM_MatrixMultiplyLevel(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto level = static_cast<SimdLevel>(state.range(1));
+    if (set_simd_level(level) != level) {
+        state.SkipWithError("SIMD level not supported on this CPU");
+        return;
+    }
+    set_gemm_threads(1);
+    const auto a = random_matrix<double>(n, n, 1);
+    const auto b = random_matrix<double>(n, n, 2);
+    Matrix<double> c(n, n);
+    for (auto _ : state) {
+        multiply(a, b, c);
+        benchmark::ClobberMemory();
+    }
+    set_gemm_threads(0);
+    set_simd_level(detected_simd_level());
+    state.SetLabel(std::string(to_string(level)));
+    set_flops(state, n);
+}
+BENCHMARK(BM_MatrixMultiplyLevel)->Apply(sizes_and_levels)->Unit(benchmark::kMillisecond);
+
+// Baseline: textbook i-k-j loop over the same storage
+static void BM_MatrixMultiplyNaive(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto a = random_matrix<double>(n, n, 1);
+    const auto b = random_matrix<double>(n, n, 2);
+    Matrix<double> c(n, n);
+    for (auto _ : state) {
+        c.fill(0.0);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t p = 0; p < n; ++p) {
+                const double aip = a(i, p);
+                for (std::size_t j = 0; j < n; ++j) {
+                    c(i, j) += aip * b(p, j);
+                }
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    set_flops(state, n);
+}
+BENCHMARK(BM_MatrixMultiplyNaive)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond);
+
+// a + b * 3 - d fused into one pass over an existing result
+static void BM_MatrixExpressionFused(benchmark::State& state) {
+    ExpressionData data(static_cast<std::size_t>(state.range(0)));
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        data.result = data.a + data.b * 3.0 - data.d;
+        benchmark::ClobberMemory();
+    }
+    data.report(state, cpptemplate::benchmarks::allocation_count() - before);
+}
+BENCHMARK(BM_MatrixExpressionFused)->RangeMultiplier(4)->Range(64, 2048);
+
+// Same expression evaluated into a new matrix each time
+static void BM_MatrixExpressionFusedNew(benchmark::State& state) {
+    ExpressionData data(static_cast<std::size_t>(state.range(0)));
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        Matrix<double> result = data.a + data.b * 3.0 - data.d;
+        benchmark::DoNotOptimize(result.data());
+    }
+    data.report(state, cpptemplate::benchmarks::allocation_count() - before);
+}
+BENCHMARK(BM_MatrixExpressionFusedNew)->RangeMultiplier(4)->Range(64, 2048);
+
+// Same expression with a temporary per operation
+static void BM_MatrixExpressionEager(benchmark::State& state) {
+    ExpressionData data(static_cast<std::size_t>(state.range(0)));
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        data.result = eager_subtract(eager_add(data.a, eager_scale(data.b, 3.0)), data.d);
+        benchmark::ClobberMemory();
+    }
+    data.report(state, cpptemplate::benchmarks::allocation_count() - before);
+}
+BENCHMARK(BM_MatrixExpressionEager)->RangeMultiplier(4)->Range(64, 2048);
@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cpptemplate/math/parallel.hpp"
+
+using namespace cpptemplate::math;
+using cpptemplate::core::ThreadPool;
+
+namespace {
+
+constexpr std::size_t ReduceSize = std::size_t{1} << 24;
+constexpr std::size_t SortSize = std::size_t{1} << 23;
+
+const std::vector<double>& data() {
+    static const std::vector<double> values = [] {
+        std::vector<double> result(ReduceSize);
+        std::mt19937_64 rng(3);
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        for (auto& v : result) {
+            v = dist(rng);
+        }
+        return result;
+    }();
+    return values;
+}
+
+ThreadPool& pool(std::size_t threads) {
+    static std::map<std::size_t, std::unique_ptr<ThreadPool>> pools;
+    auto& entry = pools[threads];
+    if (!entry) {
+        entry = std::make_unique<ThreadPool>(threads);
+    }
+    return *entry;
+}
+
+/**
+ * Times op(pool) per iteration with range(0) threads and reports the
+ * speedup over the 1-thread run of the same benchmark, which runs first
+ */
+template<typename Prepare, typename Op>
+void scaling(benchmark::State& state, const std::string& name, Prepare&& prepare, Op&& op) {
+    static std::map<std::string, double> serial_seconds;
+    const auto threads = static_cast<std::size_t>(state.range(0));
+    ThreadPool& workers = pool(threads);
+    double total = 0.0;
+    for (auto _ : state) {
+        prepare();
+        const auto start = std::chrono::steady_clock::now();
+        op(workers);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        state.SetIterationTime(elapsed.count());
+        total += elapsed.count();
+    }
+    const double seconds = total / static_cast<double>(state.iterations());
+    if (threads == 1) {
+        serial_seconds[name] = seconds;
+    }
+    if (const auto it = serial_seconds.find(name); it != serial_seconds.end()) {
+        state.counters["speedup"] = it->second / seconds;
+    }
+    state.counters["threads"] = static_cast<double>(threads);
+}
+
+void thread_counts(benchmark::internal::Benchmark* bench) {
+    for (const std::int64_t threads : {1, 2, 4, 8, 16, 32}) {
+        bench->Arg(threads);
+    }
+    bench->UseManualTime()->Unit(benchmark::kMillisecond);
+}
+
+void no_prepare() {}
+
+} // namespace
+
+static void BM_ParallelSum(benchmark::State& state) {
+    const auto& values = data();
+    scaling(state, "sum", no_prepare, [&](ThreadPool& p) { benchmark::DoNotOptimize(parallel_sum(values, p)); });
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(ReduceSize * sizeof(double)));
+}
+BENCHMARK(BM_ParallelSum)->Apply(thread_counts);
+
+static void BM_ParallelDot(benchmark::State& state) {
+    const auto& values = data();
+    scaling(state, "dot", no_prepare,
+            [&](ThreadPool& p) { benchmark::DoNotOptimize(parallel_dot(values, values, p)); });
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(ReduceSize * sizeof(double)));
+}
+BENCHMARK(BM_ParallelDot)->Apply(thread_counts);
+
+static void BM_ParallelMinMax(benchmark::State& state) {
+    const auto& values = data();
+    scaling(state, "minmax", no_prepare,
+            [&](ThreadPool& p) { benchmark::DoNotOptimize(parallel_min_max(values, p)); });
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(ReduceSize * sizeof(double)));
+}
+BENCHMARK(BM_ParallelMinMax)->Apply(thread_counts);
+
+static void BM_ParallelHistogram(benchmark::State& state) {
+    const auto& values = data();
+    scaling(state, "histogram", no_prepare,
+            [&](ThreadPool& p) { benchmark::DoNotOptimize(parallel_histogram(values, 0.0, 1.0, 1024, p)); });
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ReduceSize));
+}
+BENCHMARK(BM_ParallelHistogram)->Apply(thread_counts);
+
+static void BM_ParallelSort(benchmark::State& state) {
+    const auto& source = data();
+    std::vector<double> values(SortSize);
+    scaling(
+        state, "sort", [&] { std::copy(source.begin(), source.begin() + SortSize, values.begin()); },
+        [&](ThreadPool& p) { parallel_sort(values, p); });
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(SortSize));
+}
+BENCHMARK(BM_ParallelSort)->Apply(thread_counts);
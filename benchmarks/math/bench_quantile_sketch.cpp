@@ -0,0 +1,113 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "cpptemplate/math/quantile_sketch.hpp"
+
+using namespace cpptemplate::math;
+
+namespace {
+
+constexpr double Quantiles[] = {0.5, 0.99, 0.999};
+
+/// Lognormal "latencies", shared by every benchmark
+const std::vector<double>& samples() {
+    static const std::vector<double> values = [] {
+        std::vector<double> result(std::size_t{1} << 20);
+        std::mt19937_64 rng(5);
+        std::lognormal_distribution<double> dist(0.0, 1.5);
+        for (auto& v : result) {
+            v = dist(rng);
+        }
+        return result;
+    }();
+    return values;
+}
+
+/// Exact quantiles by sorting a copy, the baseline sketches replace
+std::vector<double> sorted_quantiles(const std::vector<double>& values) {
+    std::vector<double> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<double> result;
+    for (const double q : Quantiles) {
+        result.push_back(sorted[static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1))]);
+    }
+    return result;
+}
+
+/// Largest relative error of the sketch over Quantiles
+double max_relative_error(const QuantileSketch& sketch) {
+    static const std::vector<double> exact = sorted_quantiles(samples());
+    double worst = 0.0;
+    for (std::size_t i = 0; i < exact.size(); ++i) {
+        worst = std::max(worst, std::abs(sketch.quantile(Quantiles[i]) - exact[i]) / exact[i]);
+    }
+    return worst;
+}
+
+/// range(0) is the relative accuracy in units of 1e-4
+double accuracy(const benchmark::State& state) {
+    return static_cast<double>(state.range(0)) * 1e-4;
+}
+
+/// Room for the whole sample range at every benchmarked accuracy, so none collapses
+constexpr std::size_t MaxBins = std::size_t{1} << 14;
+
+} // namespace
+
+static void BM_QuantileSketchAdd(benchmark::State& state) {
+    const auto& values = samples();
+    QuantileSketch sketch(accuracy(state), MaxBins);
+    for (auto _ : state) {
+        sketch.reset();
+        sketch.add(values);
+        benchmark::DoNotOptimize(sketch.count());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(values.size()));
+    state.counters["bins"] = static_cast<double>(sketch.bin_count());
+    state.counters["bytes"] = static_cast<double>(sketch.serialize().size());
+    state.counters["max_rel_err"] = max_relative_error(sketch);
+}
+BENCHMARK(BM_QuantileSketchAdd)->Arg(500)->Arg(100)->Arg(10)->Unit(benchmark::kMillisecond);
+
+static void BM_ConcurrentQuantileSketchAdd(benchmark::State& state) {
+    static ConcurrentQuantileSketch shared(0.01);
+    const auto& values = samples();
+    // Each thread records its own slice of the samples
+    const auto slice = values.size() / static_cast<std::size_t>(state.threads());
+    const auto begin = values.begin() + static_cast<std::ptrdiff_t>(slice * static_cast<std::size_t>(state.thread_index()));
+    for (auto _ : state) {
+        std::for_each(begin, begin + static_cast<std::ptrdiff_t>(slice), [](double v) { shared.add(v); });
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(slice));
+}
+BENCHMARK(BM_ConcurrentQuantileSketchAdd)->Threads(1)->Threads(2)->Threads(4)->Unit(benchmark::kMillisecond);
+
+static void BM_QuantileSketchMerge(benchmark::State& state) {
+    QuantileSketch part(accuracy(state), MaxBins);
+    part.add(samples());
+    for (auto _ : state) {
+        QuantileSketch total(accuracy(state), MaxBins);
+        for (int i = 0; i < 16; ++i) {
+            total.merge(part);
+        }
+        benchmark::DoNotOptimize(total.quantile(0.99));
+    }
+    state.SetItemsProcessed(state.iterations() * 16);
+}
+BENCHMARK(BM_QuantileSketchMerge)->Arg(500)->Arg(100)->Arg(10);
+
+static void BM_ExactSortQuantiles(benchmark::State& state) {
+    const auto& values = samples();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sorted_quantiles(values));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(values.size()));
+    state.counters["bytes"] = static_cast<double>(values.size() * sizeof(double));
+}
+BENCHMARK(BM_ExactSortQuantiles)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/math/statistics.hpp"
+
+using namespace cpptemplate::math;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+
+namespace {
+
+/// Streams longer than this re-read the same samples, so 10^9 fits in memory
+constexpr std::size_t SourceSize = std::size_t{1} << 24;
+
+/// Lognormal samples, shared by every benchmark
+const std::vector<double>& source() {
+    static const std::vector<double> values = [] {
+        std::vector<double> result(SourceSize);
+        std::mt19937_64 rng(11);
+        std::lognormal_distribution<double> dist(3.0, 0.5);
+        for (auto& v : result) {
+            v = dist(rng);
+        }
+        return result;
+    }();
+    return values;
+}
+
+/// Feed n samples to fn in chunks of at most SourceSize
+template<typename Fn>
+void stream(std::size_t n, Fn&& fn) {
+    const auto& values = source();
+    while (n > 0) {
+        const std::size_t chunk = std::min(n, values.size());
+        fn(std::span<const double>(values.data(), chunk));
+        n -= chunk;
+    }
+}
+
+/// Stored-data baseline: mean, then variance, skewness and kurtosis
+struct TwoPassResult {
+    double mean;
+    double variance;
+    double skewness;
+    double kurtosis;
+};
+
+TwoPassResult two_pass(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (const double v : values) {
+        sum += v;
+    }
+    const double n = static_cast<double>(values.size());
+    const double mean = sum / n;
+    double m2 = 0.0;
+    double m3 = 0.0;
+    double m4 = 0.0;
+    for (const double v : values) {
+        const double d = v - mean;
+        const double d2 = d * d;
+        m2 += d2;
+        m3 += d2 * d;
+        m4 += d2 * d2;
+    }
+    return {mean, m2 / n, std::sqrt(n) * m3 / std::pow(m2, 1.5), n * m4 / (m2 * m2) - 3.0};
+}
+
+void stream_args(benchmark::internal::Benchmark* bench) {
+    for (const std::int64_t n : {1'000'000, 10'000'000, 100'000'000, 1'000'000'000}) {
+        for (const auto level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+            bench->Args({n, static_cast<std::int64_t>(level)});
+        }
+    }
+    bench->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+static void BM_RunningStatsAddSample(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    source(); // Generate outside the timed loop
+    for (auto _ : state) {
+        RunningStats stats;
+        stream(n, [&](std::span<const double> chunk) {
+            for (const double v : chunk) {
+                stats.add(v);
+            }
+        });
+        benchmark::DoNotOptimize(stats.kurtosis());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RunningStatsAddSample)
+    ->Arg(1'000'000)
+    ->Arg(10'000'000)
+    ->Arg(100'000'000)
+    ->Arg(1'000'000'000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_RunningStatsAddSpan(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto requested = static_cast<SimdLevel>(state.range(1));
+    if (set_simd_level(requested) != requested) {
+        state.SkipWithError("SIMD level not supported on this CPU");
+        return;
+    }
+    state.SetLabel(std::string(to_string(requested)));
+    for (auto _ : state) {
+        RunningStats stats;
+        stream(n, [&](std::span<const double> chunk) { stats.add(chunk); });
+        benchmark::DoNotOptimize(stats.kurtosis());
+    }
+    set_simd_level(detected_simd_level());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RunningStatsAddSpan)->Apply(stream_args);
+
+// Needs all n samples in memory (8 bytes each), so stops at 10^8
+static void BM_TwoPassStoredSamples(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    std::vector<double> values;
+    values.reserve(n);
+    stream(n, [&](std::span<const double> chunk) { values.insert(values.end(), chunk.begin(), chunk.end()); });
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(two_pass(values));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TwoPassStoredSamples)
+    ->Arg(1'000'000)
+    ->Arg(10'000'000)
+    ->Arg(100'000'000)
+    ->Unit(benchmark::kMillisecond);
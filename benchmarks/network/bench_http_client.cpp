@@ -0,0 +1,141 @@
+#include <benchmark/benchmark.h>
+
+#if defined(__linux__)
+
+    #include <condition_variable>
+    #include <cstddef>
+    #include <cstdint>
+    #include <memory>
+    #include <mutex>
+    #include <string>
+    #include <string_view>
+
+    #include "cpptemplate/network/http.hpp"
+    #include "cpptemplate/network/http_client.hpp"
+    #include "cpptemplate/network/tcp_server.hpp"
+
+using namespace cpptemplate::network;
+
+namespace {
+
+constexpr std::string_view Body = "Hello, world!";
+
+/// Loopback HTTP server with one loop, answering every request with Body
+void serve(TcpServer& server) {
+    server.on_connect(
+        [](Connection& connection) { connection.set_user_data(std::make_shared<HttpParser>()); });
+    server.on_data([](Connection& connection, std::string_view bytes) {
+        auto& parser = *connection.user_data<HttpParser>();
+        std::size_t consumed = 0;
+        HttpRequest request;
+        while (!connection.closing()) {
+            const auto result = parser.parse(bytes.substr(consumed), request);
+            if (result.status != HttpParseResult::Status::Complete) {
+                break;
+            }
+            consumed += result.consumed;
+            HttpResponse response;
+            response.header("Content-Type", "text/plain")
+                .body(Body)
+                .keep_alive(request.keep_alive)
+                .send(connection);
+            if (!request.keep_alive) {
+                connection.close();
+            }
+        }
+        return consumed;
+    });
+    server.start();
+}
+
+/// Counts down the requests of one batch
+class Batch {
+public:
+    void start(std::size_t requests) {
+        const std::lock_guard lock(mutex_);
+        remaining_ = requests;
+    }
+
+    void done(bool ok) {
+        const std::lock_guard lock(mutex_);
+        failed_ = failed_ || !ok;
+        if (--remaining_ == 0) {
+            finished_.notify_one();
+        }
+    }
+
+    /// Wait for the batch; false if a request failed
+    bool wait() {
+        std::unique_lock lock(mutex_);
+        finished_.wait(lock, [this] { return remaining_ == 0; });
+        return !failed_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable finished_;
+    std::size_t remaining_ = 0;
+    bool failed_ = false;
+};
+
+const char* mode_name(std::int64_t mode) {
+    switch (mode) {
+        case 0: return "new connection per request";
+        case 1: return "keep-alive pool";
+        default: return "pipelined on one connection";
+    }
+}
+
+} // namespace
+
+/**
+ * Requests per second through HttpClient against a loopback server.
+ * range(0): 0 opens a connection per request, 1 reuses pooled keep-alive
+ * connections (one request in flight on each), 2 pipelines everything on
+ * one connection. range(1): requests in flight, the batch each iteration
+ * sends and waits for.
+ */
+static void BM_HttpClient(benchmark::State& state) {
+    ServerOptions server_options;
+    server_options.host = "127.0.0.1";
+    server_options.threads = 1;
+    TcpServer server(server_options);
+    serve(server);
+
+    const auto mode = state.range(0);
+    const auto in_flight = static_cast<std::size_t>(state.range(1));
+    HttpClientOptions options;
+    options.keep_alive = mode != 0;
+    options.max_connections_per_host = mode == 2 ? 1 : in_flight;
+    options.max_pipeline = mode == 2 ? in_flight : 1;
+    HttpClient client(options);
+    state.SetLabel(mode_name(mode));
+
+    std::string url = "http://127.0.0.1:";
+    url.append(std::to_string(server.port())).append("/index.html");
+    Batch batch;
+    const auto callback = [&batch](HttpResult result) {
+        batch.done(result.has_value() && result.value().body == Body);
+    };
+    for (auto _ : state) {
+        batch.start(in_flight);
+        for (std::size_t i = 0; i < in_flight; ++i) {
+            client.get(url, callback);
+        }
+        if (!batch.wait()) {
+            state.SkipWithError("request failed");
+            break;
+        }
+    }
+
+    const auto stats = client.stats();
+    state.counters["req/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * state.range(1)), benchmark::Counter::kIsRate);
+    state.counters["connections"] = static_cast<double>(stats.connections);
+}
+BENCHMARK(BM_HttpClient)
+    ->ArgsProduct({{0, 1, 2}, {1, 16}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+#endif
@@ -0,0 +1,301 @@
+#include <benchmark/benchmark.h>
+
+#if defined(__linux__)
+
+    #include <array>
+    #include <chrono>
+    #include <cstddef>
+    #include <cstdint>
+    #include <string>
+    #include <string_view>
+    #include <utility>
+    #include <vector>
+
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/epoll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+
+    #include "cpptemplate/math/quantile_sketch.hpp"
+    #include "cpptemplate/network/tcp_server.hpp"
+
+using namespace cpptemplate::network;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// A small request, the size of a typical RPC or cache lookup
+constexpr std::size_t RequestSize = 64;
+
+// Keep-alive GET and its canned reply, the shape of a small HTTP/1.1 exchange
+constexpr std::string_view HttpRequest = "GET /index.html HTTP/1.1\r\n"
+                                         "Host: localhost\r\n"
+                                         "User-Agent: bench\r\n"
+                                         "Accept: */*\r\n\r\n";
+constexpr std::string_view HttpHeader = "HTTP/1.1 200 OK\r\n"
+                                        "Content-Type: text/plain\r\n"
+                                        "Content-Length: 13\r\n\r\n";
+constexpr std::string_view HttpBody = "Hello, world!";
+
+/// Server on loopback with one loop per core; range(0) picks the backend
+ServerOptions server_options(const benchmark::State& state) {
+    ServerOptions options;
+    options.host = "127.0.0.1";
+    options.backend = state.range(0) == 0 ? Backend::Epoll : Backend::IoUring;
+    return options;
+}
+
+/// Skip the run if its backend is unavailable; otherwise label it with the backend
+bool use_backend(benchmark::State& state) {
+    if (state.range(0) != 0 && !io_uring_available()) {
+        state.SkipWithError("io_uring is not available");
+        return false;
+    }
+    state.SetLabel(state.range(0) == 0 ? "epoll" : "io_uring");
+    return true;
+}
+
+void echo(TcpServer& server) {
+    server.on_data([](Connection& connection, std::string_view bytes) {
+        connection.send(bytes);
+        return bytes.size();
+    });
+}
+
+/// Answer each complete request head with the canned reply, header and body as separate pieces
+void serve_http(TcpServer& server) {
+    server.on_data([](Connection& connection, std::string_view bytes) {
+        std::size_t consumed = 0;
+        for (std::size_t end = bytes.find("\r\n\r\n"); end != std::string_view::npos;
+             end = bytes.find("\r\n\r\n", consumed)) {
+            const std::string_view pieces[] = {HttpHeader, HttpBody};
+            connection.send(pieces);
+            consumed = end + 4;
+        }
+        return consumed;
+    });
+}
+
+/// Blocking loopback connection; -1 on failure
+int connect_to(std::uint16_t port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    // Reset on close, so churning connections do not exhaust ports in TIME_WAIT
+    const linger reset{1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof reset);
+    return fd;
+}
+
+/**
+ * Closed-loop load generator: every connection keeps one request in flight,
+ * and a round ends when each has its reply_size bytes back. Latency is
+ * measured from a connection's send to the last byte of its reply.
+ */
+class LoadGenerator {
+public:
+    LoadGenerator(std::uint16_t port,
+                  std::size_t connections,
+                  std::string request,
+                  std::size_t reply_size)
+        : epoll_fd_(::epoll_create1(EPOLL_CLOEXEC)),
+          request_(std::move(request)),
+          reply_(reply_size, '\0') {
+        for (std::size_t i = 0; i < connections; ++i) {
+            const int fd = connect_to(port);
+            if (fd < 0) {
+                break;
+            }
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = clients_.size();
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+            clients_.push_back({fd, 0, {}});
+        }
+    }
+
+    ~LoadGenerator() {
+        for (const Client& client : clients_) {
+            ::close(client.fd);
+        }
+        ::close(epoll_fd_);
+    }
+
+    LoadGenerator(const LoadGenerator&) = delete;
+    LoadGenerator& operator=(const LoadGenerator&) = delete;
+
+    [[nodiscard]] std::size_t connections() const noexcept {
+        return clients_.size();
+    }
+
+    /// One request per connection; false if a connection failed
+    bool round(cpptemplate::math::QuantileSketch& latencies_us) {
+        for (Client& client : clients_) {
+            client.received = 0;
+            client.sent_at = Clock::now();
+            if (::send(client.fd, request_.data(), request_.size(), MSG_NOSIGNAL) !=
+                static_cast<ssize_t>(request_.size())) {
+                return false;
+            }
+        }
+
+        std::size_t outstanding = clients_.size();
+        std::array<epoll_event, 256> events{};
+        while (outstanding > 0) {
+            const int count =
+                ::epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), 5000);
+            if (count <= 0) {
+                return false;
+            }
+            for (int i = 0; i < count; ++i) {
+                Client& client = clients_[events[static_cast<std::size_t>(i)].data.u64];
+                const auto n = ::recv(client.fd, reply_.data(), reply_.size() - client.received, 0);
+                if (n <= 0) {
+                    return false;
+                }
+                client.received += static_cast<std::size_t>(n);
+                if (client.received == reply_.size()) {
+                    const std::chrono::duration<double, std::micro> latency =
+                        Clock::now() - client.sent_at;
+                    latencies_us.add(latency.count());
+                    --outstanding;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Client {
+        int fd;
+        std::size_t received;
+        Clock::time_point sent_at;
+    };
+
+    int epoll_fd_;
+    std::string request_;
+    std::string reply_;
+    std::vector<Client> clients_;
+};
+
+void report_latency(benchmark::State& state,
+                    const cpptemplate::math::QuantileSketch& latencies_us) {
+    state.counters["p50_us"] = latencies_us.quantile(0.50);
+    state.counters["p99_us"] = latencies_us.quantile(0.99);
+}
+
+/// Load server for the benchmark's iterations; range(1) is the connection count
+void run_load(benchmark::State& state,
+              TcpServer& server,
+              std::string request,
+              std::size_t reply_size) {
+    const auto connections = static_cast<std::size_t>(state.range(1));
+    // Client and server end of each connection, plus slack
+    if (raise_open_file_limit() < 2 * connections + 64) {
+        state.SkipWithError("open file limit too low");
+        return;
+    }
+    server.start();
+    const std::size_t request_size = request.size();
+    LoadGenerator load(server.port(), connections, std::move(request), reply_size);
+    if (load.connections() != connections) {
+        state.SkipWithError("could not open every connection");
+        return;
+    }
+
+    cpptemplate::math::QuantileSketch latencies_us;
+    for (auto _ : state) {
+        if (!load.round(latencies_us)) {
+            state.SkipWithError("connection failed");
+            break;
+        }
+    }
+    state.counters["req/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * connections), benchmark::Counter::kIsRate);
+    report_latency(state, latencies_us);
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * connections * (request_size + reply_size)));
+}
+
+} // namespace
+
+// Requests per second over N open connections, each with one request in flight;
+// the first argument is the backend, 0 for epoll and 1 for io_uring
+static void BM_TcpServerEcho(benchmark::State& state) {
+    if (!use_backend(state)) {
+        return;
+    }
+    TcpServer server(server_options(state));
+    echo(server);
+    run_load(state, server, std::string(RequestSize, 'r'), RequestSize);
+}
+BENCHMARK(BM_TcpServerEcho)
+    ->ArgsProduct({{0, 1}, {1, 64, 1024, 8192}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// The same with a keep-alive GET and a two-piece response, as an HTTP server sees it
+static void BM_TcpServerHttp(benchmark::State& state) {
+    if (!use_backend(state)) {
+        return;
+    }
+    TcpServer server(server_options(state));
+    serve_http(server);
+    run_load(state, server, std::string(HttpRequest), HttpHeader.size() + HttpBody.size());
+}
+BENCHMARK(BM_TcpServerHttp)
+    ->ArgsProduct({{0, 1}, {1, 64, 1024, 8192}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// New connections per second: connect, one request, close
+static void BM_TcpServerConnect(benchmark::State& state) {
+    if (!use_backend(state)) {
+        return;
+    }
+    TcpServer server(server_options(state));
+    echo(server);
+    server.start();
+
+    const std::string request(RequestSize, 'r');
+    std::array<char, RequestSize> reply{};
+    cpptemplate::math::QuantileSketch latencies_us;
+    for (auto _ : state) {
+        const auto start = Clock::now();
+        const int fd = connect_to(server.port());
+        if (fd < 0 || ::send(fd, request.data(), request.size(), MSG_NOSIGNAL) !=
+                          static_cast<ssize_t>(RequestSize)) {
+            state.SkipWithError("connect failed");
+            break;
+        }
+        std::size_t received = 0;
+        while (received < RequestSize) {
+            const auto n = ::recv(fd, reply.data(), RequestSize - received, 0);
+            if (n <= 0) {
+                break;
+            }
+            received += static_cast<std::size_t>(n);
+        }
+        ::close(fd);
+        const std::chrono::duration<double, std::micro> latency = Clock::now() - start;
+        latencies_us.add(latency.count());
+    }
+    state.counters["conn/s"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                                  benchmark::Counter::kIsRate);
+    report_latency(state, latencies_us);
+}
+BENCHMARK(BM_TcpServerConnect)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+#endif
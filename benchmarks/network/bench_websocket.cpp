@@ -0,0 +1,267 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(__linux__)
+    #include <array>
+    #include <atomic>
+    #include <cerrno>
+    #include <string_view>
+    #include <thread>
+    #include <unordered_set>
+    #include <vector>
+
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/epoll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/network/tcp_server.hpp"
+#include "cpptemplate/network/websocket.hpp"
+
+using namespace cpptemplate::network;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+
+namespace {
+
+constexpr WsMaskKey Key{0x37, 0xFA, 0x21, 0x3D};
+
+} // namespace
+
+// In-place unmasking of a 64 KiB payload; the argument is the SIMD level
+static void BM_WsMask(benchmark::State& state) {
+    const auto level = static_cast<SimdLevel>(state.range(0));
+    if (set_simd_level(level) != level) {
+        state.SkipWithError("SIMD level not supported on this CPU");
+    }
+    state.SetLabel(std::string(to_string(level)));
+    std::string payload(64 * 1024, 'x');
+    for (auto _ : state) {
+        ws_mask(payload, Key);
+        benchmark::DoNotOptimize(payload.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * payload.size()));
+    set_simd_level(detected_simd_level());
+}
+BENCHMARK(BM_WsMask)->Arg(0)->Arg(1)->Arg(2);
+
+#if defined(__linux__)
+
+namespace {
+
+/// Blocking loopback connection that resets on close, so repeated runs do not exhaust
+/// ports; -1 on failure
+int connect_to(std::uint16_t port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    const linger reset{1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof reset);
+    return fd;
+}
+
+/// Connect and complete the WebSocket handshake for target; -1 on failure
+int open_websocket(std::uint16_t port, std::string_view target) {
+    const int fd = connect_to(port);
+    if (fd < 0) {
+        return -1;
+    }
+    const std::string key = ws_client_key();
+    const std::string request = ws_upgrade_request("127.0.0.1", target, key);
+    std::string head;
+    if (::send(fd, request.data(), request.size(), MSG_NOSIGNAL) ==
+        static_cast<ssize_t>(request.size())) {
+        std::array<char, 512> buffer{};
+        while (head.find("\r\n\r\n") == std::string::npos) {
+            const auto n = ::recv(fd, buffer.data(), buffer.size(), 0);
+            if (n <= 0) {
+                break;
+            }
+            head.append(buffer.data(), static_cast<std::size_t>(n));
+        }
+    }
+    if (!ws_check_upgrade_response(head, key)) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// Subscribers of one publisher, each counting the bytes it has received
+class Subscribers {
+public:
+    Subscribers(std::uint16_t port, std::size_t count) : epoll_fd_(::epoll_create1(EPOLL_CLOEXEC)) {
+        fds_.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const int fd = open_websocket(port, "/subscribe");
+            if (fd < 0) {
+                break;
+            }
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+            fds_.push_back(fd);
+        }
+    }
+
+    ~Subscribers() {
+        for (const int fd : fds_) {
+            ::close(fd);
+        }
+        ::close(epoll_fd_);
+    }
+
+    Subscribers(const Subscribers&) = delete;
+    Subscribers& operator=(const Subscribers&) = delete;
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return fds_.size();
+    }
+
+    /// Read until bytes more have arrived over all subscribers; false on a failure or timeout
+    bool drain(std::size_t bytes) {
+        std::array<epoll_event, 512> events{};
+        while (bytes > 0) {
+            const int count =
+                ::epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), 5000);
+            if (count <= 0) {
+                return false;
+            }
+            for (int i = 0; i < count; ++i) {
+                const auto n = ::recv(events[static_cast<std::size_t>(i)].data.fd,
+                                      scratch_.data(),
+                                      scratch_.size(),
+                                      0);
+                if (n == 0 || (n < 0 && errno != EAGAIN)) {
+                    return false;
+                }
+                bytes -= n > 0 ? std::min(bytes, static_cast<std::size_t>(n)) : 0;
+            }
+        }
+        return true;
+    }
+
+private:
+    int epoll_fd_;
+    std::vector<int> fds_;
+    std::array<char, 64 * 1024> scratch_{};
+};
+
+} // namespace
+
+/**
+ * Messages delivered per second when one publisher fans out to many
+ * subscribers. range(0): subscribers asked for, capped so that both ends of
+ * every connection fit under the open file limit. range(1): messages the
+ * publisher sends at once; each reaches every subscriber, so a batch is
+ * written to each with one system call. range(2): 0 broadcasts a WsFrame
+ * serialized once and shared by reference, 1 sends each subscriber its own
+ * copy through WsConnection::send(). range(3): payload size, 64 bytes for a
+ * ticker update or chat line, 4 KiB for a document patch.
+ *
+ * The server runs one loop, as a broadcast must stay on the loop that owns
+ * the connections, and the subscribers are read on the benchmark thread.
+ */
+static void BM_WsFanOut(benchmark::State& state) {
+    const auto requested = static_cast<std::size_t>(state.range(0));
+    const auto batch = static_cast<std::size_t>(state.range(1));
+    const bool shared = state.range(2) == 0;
+    const auto message_size = static_cast<std::size_t>(state.range(3));
+    std::array<char, WsMaxHeader> header{};
+    // What a subscriber receives per message: the payload behind an unmasked header
+    const std::size_t frame_size =
+        ws_frame_header(header.data(), WsOpcode::Text, message_size) + message_size;
+    // Both ends of every subscriber, the publisher and slack
+    const std::size_t fit = (raise_open_file_limit() - 64) / 2 - 1;
+    const std::size_t wanted = std::min(requested, fit);
+
+    // Touched only on the server loop; outlives the server
+    std::unordered_set<WsConnection*> subscribers;
+    std::atomic<std::size_t> opened{0};
+    WsServerOptions options;
+    options.tcp.host = "127.0.0.1";
+    options.tcp.threads = 1;
+    WebSocketServer server(options);
+    server.on_open([&](WsConnection& ws, const HttpRequest& request) {
+        if (request.path == "/subscribe") {
+            subscribers.insert(&ws);
+            ++opened;
+        }
+    });
+    server.on_close([&](WsConnection& ws) { subscribers.erase(&ws); });
+    server.on_message([&](WsConnection&, const WsMessage& message) {
+        if (shared) {
+            const WsFrame frame(message.opcode, message.payload);
+            for (WsConnection* subscriber : subscribers) {
+                subscriber->send(frame);
+            }
+        } else {
+            for (WsConnection* subscriber : subscribers) {
+                subscriber->send(message.opcode, message.payload);
+            }
+        }
+    });
+    server.start();
+
+    Subscribers clients(server.port(), wanted);
+    const int publisher = open_websocket(server.port(), "/publish");
+    if (publisher < 0 || clients.size() != wanted) {
+        if (publisher >= 0) {
+            ::close(publisher);
+        }
+        state.SkipWithError("could not open every connection");
+        return;
+    }
+    while (opened.load() != wanted) {
+        std::this_thread::yield();
+    }
+    std::string messages;
+    for (std::size_t i = 0; i < batch; ++i) {
+        ws_append_frame(messages, WsOpcode::Text, std::string(message_size, 'm'), ws_random_mask());
+    }
+
+    for (auto _ : state) {
+        if (::send(publisher, messages.data(), messages.size(), MSG_NOSIGNAL) !=
+                static_cast<ssize_t>(messages.size()) ||
+            !clients.drain(wanted * batch * frame_size)) {
+            state.SkipWithError("connection failed");
+            break;
+        }
+    }
+    ::close(publisher);
+
+    state.SetLabel(std::string(shared ? "shared frame" : "copy per connection"));
+    state.counters["clients"] = static_cast<double>(wanted);
+    state.counters["msg/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * wanted * batch), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_WsFanOut)
+    ->ArgsProduct({{10000}, {1, 16}, {0, 1}, {64, 4096}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+#endif
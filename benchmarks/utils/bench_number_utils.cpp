@@ -0,0 +1,176 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/math/calculator.hpp"
+#include "cpptemplate/utils/number_utils.hpp"
+#include "cpptemplate/utils/string_utils.hpp"
+
+using namespace cpptemplate::utils;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+
+namespace {
+
+/// Prices and measurements: up to 6 integer and 1 to 6 fraction digits, some negative
+std::vector<std::string> decimals(std::size_t n) {
+    std::mt19937 rng(4);
+    std::vector<std::string> result;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double value = (static_cast<double>(rng() % 2000000) - 500000.0) / 100.0;
+        result.push_back(format_double(value, 1 + static_cast<int>(rng() % 6)));
+    }
+    return result;
+}
+
+/// Same values in the shortest round-trip form, often 15 to 17 digits
+std::vector<std::string> full_precision(std::size_t n) {
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    std::vector<std::string> result;
+    for (std::size_t i = 0; i < n; ++i) {
+        result.push_back(format_double(dist(rng)));
+    }
+    return result;
+}
+
+std::string row_of(const std::vector<std::string>& fields) {
+    return join(fields, ",");
+}
+
+constexpr std::size_t FieldCount = 4096;
+
+/// range(0): 0 strtod, 1 std::stod, 2 istringstream, 3 parse_double
+void parse_each(benchmark::State& state, const std::vector<std::string>& fields) {
+    double sum = 0.0;
+    for (auto _ : state) {
+        for (const auto& field : fields) {
+            switch (state.range(0)) {
+                case 0: sum += std::strtod(field.c_str(), nullptr); break;
+                case 1: sum += std::stod(field); break;
+                case 2: {
+                    std::istringstream stream(field);
+                    double value = 0.0;
+                    stream >> value;
+                    sum += value;
+                    break;
+                }
+                default: sum += parse_double(field).value_or(0.0); break;
+            }
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(fields.size()));
+    static const char* const names[] = {"strtod", "std::stod", "istringstream", "parse_double"};
+    state.SetLabel(names[state.range(0)]);
+}
+
+} // namespace
+
+static void BM_ParseDoubleShort(benchmark::State& state) {
+    static const auto fields = decimals(FieldCount);
+    parse_each(state, fields);
+}
+BENCHMARK(BM_ParseDoubleShort)->DenseRange(0, 3);
+
+static void BM_ParseDoubleFull(benchmark::State& state) {
+    static const auto fields = full_precision(FieldCount);
+    parse_each(state, fields);
+}
+BENCHMARK(BM_ParseDoubleFull)->DenseRange(0, 3);
+
+// A whole CSV row into a column: split + stod against parse_row at each
+// SIMD level. range(1) is the field shape, 0 short decimals, 1 full precision
+static void BM_ParseRow(benchmark::State& state) {
+    const auto fields = state.range(1) == 0 ? decimals(FieldCount) : full_precision(FieldCount);
+    const auto row = row_of(fields);
+    std::vector<double> column;
+    const auto level = state.range(0);
+    if (level >= 0 &&
+        set_simd_level(static_cast<SimdLevel>(level)) != static_cast<SimdLevel>(level)) {
+        state.SkipWithError("SIMD level not supported on this CPU");
+    }
+    for (auto _ : state) {
+        if (level < 0) {
+            column.clear();
+            for (const auto& field : split(row, ',')) {
+                column.push_back(std::stod(field));
+            }
+        } else {
+            benchmark::DoNotOptimize(parse_row(row, ',', column));
+        }
+        benchmark::DoNotOptimize(column.data());
+    }
+    set_simd_level(detected_simd_level());
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(row.size()));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(fields.size()));
+    state.SetLabel(level < 0 ? "split+stod"
+                             : std::string(to_string(static_cast<SimdLevel>(level))));
+}
+BENCHMARK(BM_ParseRow)->ArgsProduct({{-1, 0, 1, 2}, {0, 1}});
+
+// Two parsed columns summed by the calculator's span overload
+static void BM_ParseRowsAndAdd(benchmark::State& state) {
+    const auto a = row_of(decimals(FieldCount));
+    const auto b = row_of(full_precision(FieldCount));
+    const cpptemplate::math::Calculator calculator;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> sum(FieldCount);
+    for (auto _ : state) {
+        (void)parse_row(a, ',', x);
+        (void)parse_row(b, ',', y);
+        calculator.add(x, y, sum);
+        benchmark::DoNotOptimize(sum.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(FieldCount));
+}
+BENCHMARK(BM_ParseRowsAndAdd);
+
+// range(0): 0 snprintf %.17g, 1 std::to_string (fixed 6 decimals), 2 ostringstream, 3 format_double
+static void BM_FormatDouble(benchmark::State& state) {
+    std::mt19937_64 rng(6);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    std::vector<double> values(FieldCount);
+    for (auto& value : values) {
+        value = dist(rng);
+    }
+    std::size_t bytes = 0;
+    for (auto _ : state) {
+        for (const double value : values) {
+            switch (state.range(0)) {
+                case 0: {
+                    char buffer[32];
+                    bytes += static_cast<std::size_t>(
+                        std::snprintf(buffer, sizeof(buffer), "%.17g", value));
+                    break;
+                }
+                case 1: bytes += std::to_string(value).size(); break;
+                case 2: {
+                    std::ostringstream stream;
+                    stream.precision(17);
+                    stream << value;
+                    bytes += stream.str().size();
+                    break;
+                }
+                default: bytes += format_double(value).size(); break;
+            }
+        }
+    }
+    benchmark::DoNotOptimize(bytes);
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(values.size()));
+    static const char* const names[] = {
+        "snprintf", "std::to_string", "ostringstream", "format_double"};
+    state.SetLabel(names[state.range(0)]);
+}
+BENCHMARK(BM_FormatDouble)->DenseRange(0, 3);
@@ -0,0 +1,362 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/allocation_counter.hpp"
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/utils/string_utils.hpp"
+
+using namespace cpptemplate::utils;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+
+namespace {
+
+// The byte-at-a-time implementations these functions replaced, kept as baselines
+
+namespace legacy {
+
+std::string to_upper(std::string_view str) {
+    std::string result;
+    result.reserve(str.size());
+    std::transform(str.begin(), str.end(), std::back_inserter(result),
+                   [](unsigned char ch) { return std::toupper(ch); });
+    return result;
+}
+
+std::string trim(std::string_view str) {
+    const auto space = [](unsigned char ch) { return std::isspace(ch); };
+    auto end = std::find_if_not(str.rbegin(), str.rend(), space).base();
+    auto start = std::find_if_not(str.begin(), end, space);
+    return std::string(start, end);
+}
+
+std::vector<std::string> split(std::string_view str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::string token;
+    for (char ch : str) {
+        if (ch == delimiter) {
+            if (!token.empty()) {
+                tokens.push_back(std::move(token));
+                token.clear();
+            }
+        } else {
+            token += ch;
+        }
+    }
+    if (!token.empty()) {
+        tokens.push_back(std::move(token));
+    }
+    return tokens;
+}
+
+std::string join(const std::vector<std::string>& strings, std::string_view delimiter) {
+    if (strings.empty()) {
+        return {};
+    }
+    std::ostringstream oss;
+    auto it = strings.begin();
+    oss << *it;
+    for (++it; it != strings.end(); ++it) {
+        oss << delimiter << *it;
+    }
+    return oss.str();
+}
+
+// Out of line, like the library function; inlined with constant arguments GCC 12
+// raises a false -Wrestrict in basic_string::replace
+[[gnu::noinline]] std::string replace_all(std::string str,
+                                          std::string_view from,
+                                          std::string_view to) {
+    std::size_t pos = 0;
+    while ((pos = str.find(from, pos)) != std::string::npos) {
+        str.replace(pos, from.length(), to);
+        pos += to.length();
+    }
+    return str;
+}
+
+} // namespace legacy
+
+/// Mixed-case header-like text
+std::string text(std::size_t n) {
+    static const std::string_view words[] = {"Content-Type",
+                                             "application/json",
+                                             "Keep-Alive",
+                                             "X-Request-Id",
+                                             "gzip",
+                                             "ACCEPT",
+                                             "charset=utf-8"};
+    std::mt19937 rng(1);
+    std::string result;
+    while (result.size() < n) {
+        result += words[rng() % std::size(words)];
+        result += ' ';
+    }
+    result.resize(n);
+    return result;
+}
+
+/// Text between runs of whitespace, so trimming scans range(0) / 2 bytes from each end
+std::string padded(std::size_t n) {
+    std::string result(n, ' ');
+    for (std::size_t i = 0; i < n; i += 4) {
+        result[i] = '\t';
+    }
+    result[n / 2] = 'x';
+    return result;
+}
+
+/// CSV-like line with fields of 1 to 24 bytes
+std::string fields(std::size_t n) {
+    std::mt19937 rng(2);
+    std::string result;
+    while (result.size() < n) {
+        result += std::string(1 + rng() % 24, 'v');
+        result += ',';
+    }
+    result.resize(n);
+    return result;
+}
+
+/// range(1) selects the level; the default level when it is -1
+class LevelGuard {
+public:
+    explicit LevelGuard(benchmark::State& state) {
+        if (state.range(1) >= 0) {
+            const auto requested = static_cast<SimdLevel>(state.range(1));
+            if (set_simd_level(requested) != requested) {
+                state.SkipWithError("SIMD level not supported on this CPU");
+            }
+            state.SetLabel(std::string(to_string(requested)));
+        } else {
+            state.SetLabel("legacy");
+        }
+    }
+
+    ~LevelGuard() {
+        set_simd_level(detected_simd_level());
+    }
+
+    LevelGuard(const LevelGuard&) = delete;
+    LevelGuard& operator=(const LevelGuard&) = delete;
+};
+
+void sizes_and_levels(benchmark::internal::Benchmark* bench) {
+    for (const std::int64_t size : {16, 256, 4 << 10, 64 << 10, 1 << 20}) {
+        for (const std::int64_t level : {-1, 0, 1, 2}) {
+            bench->Args({size, level});
+        }
+    }
+}
+
+/// Bytes processed plus heap allocations per iteration since before
+void report(benchmark::State& state, std::size_t before) {
+    state.counters["allocs/iter"] =
+        static_cast<double>(cpptemplate::benchmarks::allocation_count() - before) /
+        static_cast<double>(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+static void BM_ToUpper(benchmark::State& state) {
+    const LevelGuard guard(state);
+    const auto input = text(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(state.range(1) < 0 ? legacy::to_upper(input) : to_upper(input));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ToUpper)->Apply(sizes_and_levels);
+
+static void BM_Trim(benchmark::State& state) {
+    const LevelGuard guard(state);
+    const auto input = padded(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(state.range(1) < 0 ? legacy::trim(input) : trim(input));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Trim)->Apply(sizes_and_levels);
+
+static void BM_Split(benchmark::State& state) {
+    const LevelGuard guard(state);
+    const auto input = fields(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(state.range(1) < 0 ? legacy::split(input, ',')
+                                                    : split(input, ','));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Split)->Apply(sizes_and_levels);
+
+// Zero-copy variants at the default level, against the owning ones above
+
+static void BM_TrimView(benchmark::State& state) {
+    const auto input = padded(static_cast<std::size_t>(state.range(0)));
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(trim_view(input));
+    }
+    report(state, before);
+}
+BENCHMARK(BM_TrimView)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+static void BM_SplitOwning(benchmark::State& state) {
+    const auto input = fields(static_cast<std::size_t>(state.range(0)));
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(split(input, ','));
+    }
+    report(state, before);
+}
+BENCHMARK(BM_SplitOwning)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+static void BM_SplitView(benchmark::State& state) {
+    const auto input = fields(static_cast<std::size_t>(state.range(0)));
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(split_view(input, ','));
+    }
+    report(state, before);
+}
+BENCHMARK(BM_SplitView)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+// Reused buffer: no allocations once it has grown
+static void BM_SplitBuffer(benchmark::State& state) {
+    const auto input = fields(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::string_view> tokens;
+    split(input, ',', tokens);
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(split(input, ',', tokens));
+    }
+    report(state, before);
+}
+BENCHMARK(BM_SplitBuffer)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+static void BM_Tokenizer(benchmark::State& state) {
+    const auto input = fields(static_cast<std::size_t>(state.range(0)));
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        std::size_t bytes = 0;
+        for (const std::string_view token : Tokenizer(input, ',')) {
+            bytes += token.size();
+        }
+        benchmark::DoNotOptimize(bytes);
+    }
+    report(state, before);
+}
+BENCHMARK(BM_Tokenizer)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+// join and replace_all: range(1) is 0 for the legacy stream / in-place versions,
+// 1 for the current ones
+
+static void BM_Join(benchmark::State& state) {
+    const auto parts = split(fields(static_cast<std::size_t>(state.range(0))), ',');
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(state.range(1) == 0 ? legacy::join(parts, ", ")
+                                                     : join(parts, ", "));
+    }
+    report(state, before);
+    state.SetLabel(state.range(1) == 0 ? "ostringstream" : "exact size");
+}
+BENCHMARK(BM_Join)->ArgsProduct({{256, 4 << 10, 64 << 10, 1 << 20}, {0, 1}});
+
+// Every field boundary is a match and the replacement is longer, so the
+// in-place version shifts the tail of the string once per match
+static void BM_ReplaceAllManyMatches(benchmark::State& state) {
+    const auto input = fields(static_cast<std::size_t>(state.range(0)));
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(state.range(1) == 0 ? legacy::replace_all(input, ",", ", ")
+                                                     : replace_all(input, ",", ", "));
+    }
+    report(state, before);
+    state.SetLabel(state.range(1) == 0 ? "in place" : "one pass");
+}
+BENCHMARK(BM_ReplaceAllManyMatches)->ArgsProduct({{256, 4 << 10, 64 << 10, 1 << 20}, {0, 1}});
+
+// Large input with rare matches, where both versions are bound by the search
+static void BM_ReplaceAllFewMatches(benchmark::State& state) {
+    auto input = text(static_cast<std::size_t>(state.range(0)));
+    for (std::size_t i = 0; i + 8 < input.size(); i += 4096) {
+        input.replace(i, 8, "{{name}}");
+    }
+    const auto before = cpptemplate::benchmarks::allocation_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(state.range(1) == 0
+                                     ? legacy::replace_all(input, "{{name}}", "value")
+                                     : replace_all(input, "{{name}}", "value"));
+    }
+    report(state, before);
+    state.SetLabel(state.range(1) == 0 ? "in place" : "one pass");
+}
+BENCHMARK(BM_ReplaceAllFewMatches)->ArgsProduct({{64 << 10, 1 << 20}, {0, 1}});
+
+namespace {
+
+/// range(1) patterns: HTML escapes, then template keys
+std::vector<std::pair<std::string, std::string>> patterns(std::size_t count) {
+    std::vector<std::pair<std::string, std::string>> result = {
+        {"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}, {"\"", "&quot;"}};
+    for (std::size_t i = 0; result.size() < count; ++i) {
+        result.emplace_back("Key-" + std::to_string(i), "value");
+    }
+    result.resize(count);
+    return result;
+}
+
+/// Header-like text with a pattern every 64 bytes or so
+std::string marked_text(std::size_t n,
+                        const std::vector<std::pair<std::string, std::string>>& pairs) {
+    auto result = text(n);
+    std::mt19937 rng(3);
+    for (std::size_t i = 0; i < result.size(); i += 64) {
+        const auto& pattern = pairs[rng() % pairs.size()].first;
+        result.replace(i, std::min(pattern.size(), result.size() - i), pattern);
+    }
+    result.resize(n);
+    return result;
+}
+
+} // namespace
+
+// One replace_all per pattern, the usual alternative
+static void BM_ReplaceEachPattern(benchmark::State& state) {
+    const auto pairs = patterns(static_cast<std::size_t>(state.range(1)));
+    const auto input = marked_text(static_cast<std::size_t>(state.range(0)), pairs);
+    for (auto _ : state) {
+        std::string result = input;
+        for (const auto& [from, to] : pairs) {
+            result = replace_all(std::move(result), from, to);
+        }
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReplaceEachPattern)->ArgsProduct({{4 << 10, 1 << 20}, {4, 32, 256}});
+
+// All patterns in one Aho-Corasick scan
+static void BM_MultiReplacer(benchmark::State& state) {
+    const auto pairs = patterns(static_cast<std::size_t>(state.range(1)));
+    const auto input = marked_text(static_cast<std::size_t>(state.range(0)), pairs);
+    const MultiReplacer replacer(pairs);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(replacer.replace(input));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MultiReplacer)->ArgsProduct({{4 << 10, 1 << 20}, {4, 32, 256}});
@@ -20,11 +20,13 @@ class CppTemplateConan(ConanFile):
         "shared": [True, False],
         "fPIC": [True, False],
         "with_tests": [True, False],
+        "with_benchmarks": [True, False],
     }
     default_options = {
         "shared": False,
         "fPIC": True,
         "with_tests": True,
+        "with_benchmarks": False,
     }
 
     # Sources are located in the same place as this recipe, copy them to the recipe
@@ -46,6 +48,8 @@ class CppTemplateConan(ConanFile):
         self.requires("spdlog/1.12.0")
         if self.options.with_tests:
             self.requires("gtest/1.14.0")
+        if self.options.with_benchmarks:
+            self.requires("benchmark/1.8.3")
 
     def build_requirements(self):
         self.tool_requires("cmake/[>=3.20]")
@@ -55,6 +59,7 @@ class CppTemplateConan(ConanFile):
         deps.generate()
         tc = CMakeToolchain(self)
         tc.variables["BUILD_TESTS"] = self.options.with_tests
+        tc.variables["BUILD_BENCHMARKS"] = self.options.with_benchmarks
         tc.generate()
 
     def build(self):
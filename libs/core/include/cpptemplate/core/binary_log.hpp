@@ -0,0 +1,328 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <spdlog/common.h>
+
+#include "cpptemplate/core/export.hpp"
+
+namespace spdlog {
+class logger;
+} // namespace spdlog
+
+namespace cpptemplate::core {
+
+/**
+ * @brief Options for the deferred (binary) logging backend
+ */
+struct BinaryLogOptions {
+    std::size_t thread_buffer_size = 1 << 20; ///< Bytes per producer thread, rounded up to a power of two
+    std::string output_path;                  ///< If set, records are written undecoded for BinaryLog::decode
+};
+
+/**
+ * @brief Backend for Logger::log_deferred
+ *
+ * Deferred records carry only the format-string pointer and the raw bytes of
+ * their arguments. Each producer thread appends them to its own
+ * single-producer ring buffer; one backend thread drains every buffer and
+ * either formats the text into the originating logger's sinks or, when an
+ * output path is configured, writes the binary records to disk for offline
+ * decoding.
+ */
+class CPPTEMPLATE_CORE_API BinaryLog {
+public:
+    BinaryLog() = delete;
+
+    /**
+     * @brief Configure the backend
+     * @param options Backend options
+     * @throws Exception if a deferred record has already been written
+     */
+    static void configure(const BinaryLogOptions& options);
+
+    /**
+     * @brief Wait until every record written before the call has been processed
+     */
+    static void flush();
+
+    /**
+     * @brief Number of records discarded because they did not fit a thread buffer
+     * @return Dropped record count
+     */
+    [[nodiscard]] static std::uint64_t dropped() noexcept;
+
+    /**
+     * @brief Convert a binary log file into text, one record per line
+     * @param input Stream positioned at the start of a binary log file
+     * @param output Destination for the formatted lines
+     * @return Number of records decoded
+     * @throws Exception if the input is not a valid binary log
+     */
+    static std::size_t decode(std::istream& input, std::ostream& output);
+};
+
+namespace detail {
+
+/**
+ * @brief Wire type of a deferred log argument
+ */
+enum class ArgType : std::uint8_t {
+    Bool,
+    Char,
+    Int8,
+    Int16,
+    Int32,
+    Int64,
+    UInt8,
+    UInt16,
+    UInt32,
+    UInt64,
+    Float,
+    Double,
+    Pointer,
+    String
+};
+
+/**
+ * @brief Fixed-size prefix of every record in a thread buffer
+ */
+struct RecordHeader {
+    std::uint32_t size;        ///< Header plus payload, padded to 8 bytes; high bit marks padding
+    std::uint32_t format_size;
+    std::uint32_t logger_id;
+    std::uint8_t level;
+    std::uint8_t arg_count;
+    const char* format;
+    const ArgType* arg_types;
+    std::int64_t timestamp_ns;
+};
+
+inline constexpr std::uint32_t PaddingFlag = 0x8000'0000u;
+
+template<typename T>
+struct BinaryArg {
+    static constexpr bool supported = false;
+};
+
+template<>
+struct BinaryArg<bool> {
+    static constexpr bool supported = true;
+    static constexpr ArgType type = ArgType::Bool;
+};
+
+template<>
+struct BinaryArg<char> {
+    static constexpr bool supported = true;
+    static constexpr ArgType type = ArgType::Char;
+};
+
+template<typename T>
+    requires(std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>)
+struct BinaryArg<T> {
+    static constexpr bool supported = sizeof(T) <= 8;
+    static constexpr ArgType type = [] {
+        constexpr bool is_signed = std::is_signed_v<T>;
+        switch (sizeof(T)) {
+            case 1: return is_signed ? ArgType::Int8 : ArgType::UInt8;
+            case 2: return is_signed ? ArgType::Int16 : ArgType::UInt16;
+            case 4: return is_signed ? ArgType::Int32 : ArgType::UInt32;
+            default: return is_signed ? ArgType::Int64 : ArgType::UInt64;
+        }
+    }();
+};
+
+template<>
+struct BinaryArg<float> {
+    static constexpr bool supported = true;
+    static constexpr ArgType type = ArgType::Float;
+};
+
+template<>
+struct BinaryArg<double> {
+    static constexpr bool supported = true;
+    static constexpr ArgType type = ArgType::Double;
+};
+
+template<>
+struct BinaryArg<const void*> {
+    static constexpr bool supported = true;
+    static constexpr ArgType type = ArgType::Pointer;
+};
+
+template<>
+struct BinaryArg<void*> : BinaryArg<const void*> {};
+
+template<typename T>
+    requires(std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+             std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+struct BinaryArg<T> {
+    static constexpr bool supported = true;
+    static constexpr ArgType type = ArgType::String;
+};
+
+template<std::size_t N>
+struct BinaryArg<char[N]> : BinaryArg<const char*> {};
+
+template<std::size_t N>
+struct BinaryArg<const char[N]> : BinaryArg<const char*> {};
+
+template<typename... Args>
+inline constexpr std::array<ArgType, sizeof...(Args)> ArgTypes{
+    BinaryArg<std::remove_cvref_t<Args>>::type...};
+
+/// Text of a string argument; a null C string is captured as "(null)"
+template<typename T>
+std::string_view string_argument(const T& value) noexcept {
+    if constexpr (std::is_pointer_v<T>) {
+        return value != nullptr ? std::string_view{value} : std::string_view{"(null)"};
+    } else {
+        return std::string_view{value};
+    }
+}
+
+template<typename T>
+std::size_t encoded_size(const T& value) noexcept {
+    if constexpr (BinaryArg<std::remove_cv_t<T>>::type == ArgType::String) {
+        return sizeof(std::uint32_t) + string_argument(value).size();
+    } else {
+        return sizeof(value);
+    }
+}
+
+template<typename T>
+std::byte* encode(std::byte* out, const T& value) noexcept {
+    if constexpr (BinaryArg<std::remove_cv_t<T>>::type == ArgType::String) {
+        const std::string_view text = string_argument(value);
+        const auto length = static_cast<std::uint32_t>(text.size());
+        std::memcpy(out, &length, sizeof length);
+        std::memcpy(out + sizeof length, text.data(), text.size());
+        return out + sizeof length + text.size();
+    } else {
+        std::memcpy(out, &value, sizeof value);
+        return out + sizeof value;
+    }
+}
+
+/**
+ * @brief Reserve space for one record in the calling thread's buffer
+ * @param size Record size including header, a multiple of 8
+ * @return Write position, or nullptr if the record can never fit
+ */
+CPPTEMPLATE_CORE_API std::byte* reserve_record(std::size_t size);
+
+/**
+ * @brief Publish the record written after the last reserve_record
+ */
+CPPTEMPLATE_CORE_API void commit_record() noexcept;
+
+/// Logger id of a logger that has not written a deferred record yet
+inline constexpr std::uint32_t NoBinaryLoggerId = 0xFFFF'FFFFu;
+
+/**
+ * @brief Register a logger as a destination for deferred records
+ * @param logger spdlog logger to format into
+ * @return Identifier stored in each record
+ * @throws Exception if too many loggers are registered at once
+ */
+CPPTEMPLATE_CORE_API std::uint32_t register_binary_logger(std::weak_ptr<spdlog::logger> logger);
+
+/**
+ * @brief Release an identifier returned by register_binary_logger
+ * 
+ * Records still queued under the identifier are discarded.
+ * 
+ * @param id Identifier to release
+ */
+CPPTEMPLATE_CORE_API void unregister_binary_logger(std::uint32_t id) noexcept;
+
+/**
+ * @brief Format an encoded payload
+ * @param format Format string of the call site
+ * @param types Argument types of the call site
+ * @param payload Encoded arguments
+ * @param out Destination buffer
+ */
+CPPTEMPLATE_CORE_API void format_payload(std::string_view format, std::span<const ArgType> types,
+                                         const std::byte* payload, spdlog::memory_buf_t& out);
+
+/**
+ * @brief Append one deferred record to the calling thread's buffer
+ */
+template<typename... Args>
+void write_record(std::uint32_t logger_id, spdlog::level::level_enum level,
+                  std::string_view format, const Args&... args) {
+    const std::size_t payload = (std::size_t{0} + ... + encoded_size(args));
+    const std::size_t size = (sizeof(RecordHeader) + payload + 7) & ~std::size_t{7};
+
+    std::byte* out = reserve_record(size);
+    if (out == nullptr) {
+        return;
+    }
+
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    const RecordHeader header{
+        static_cast<std::uint32_t>(size),
+        static_cast<std::uint32_t>(format.size()),
+        logger_id,
+        static_cast<std::uint8_t>(level),
+        static_cast<std::uint8_t>(sizeof...(Args)),
+        format.data(),
+        ArgTypes<Args...>.data(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()};
+    std::memcpy(out, &header, sizeof header);
+    out += sizeof header;
+    ((out = encode(out, args)), ...);
+
+    commit_record();
+}
+
+} // namespace detail
+
+/**
+ * @brief Argument types that can be captured by Logger::log_deferred
+ *
+ * Arithmetic values, untyped pointers and strings (copied by value).
+ */
+template<typename T>
+concept DeferredLogArgument = detail::BinaryArg<std::remove_cvref_t<T>>::supported;
+
+/**
+ * @brief Format string of a deferred record
+ *
+ * Records keep a pointer to the format text, so only string literals convert
+ * to it; runtime strings such as fmt::runtime(text) would dangle before the
+ * backend formats the record. The text is checked against the argument types
+ * at compile time, like spdlog::format_string_t.
+ */
+template<typename... Args>
+class BasicDeferredFormat {
+public:
+    template<std::size_t N>
+    consteval BasicDeferredFormat(const char (&text)[N]) : text_(text, N - 1) { // NOLINT
+        static_cast<void>(spdlog::format_string_t<Args...>(text));
+    }
+
+    [[nodiscard]] constexpr std::string_view get() const noexcept {
+        return text_;
+    }
+
+private:
+    std::string_view text_;
+};
+
+/// BasicDeferredFormat with the argument types excluded from deduction
+template<typename... Args>
+using DeferredFormat = BasicDeferredFormat<std::type_identity_t<Args>...>;
+
+} // namespace cpptemplate::core
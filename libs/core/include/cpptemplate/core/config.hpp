@@ -1,21 +1,261 @@
 #pragma once
 
-#include "cpptemplate/core/logger.hpp" // For export macros
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "cpptemplate/core/export.hpp"
+#include "cpptemplate/core/string_hash.hpp"
 
 namespace cpptemplate::core {
 
+namespace detail {
+struct ConfigSnapshot;
+} // namespace detail
+
+/**
+ * @brief Value types a configuration entry can be read as
+ */
+template<typename T>
+concept ConfigValueType = std::same_as<T, bool> || std::same_as<T, std::int64_t> ||
+                          std::same_as<T, double> || std::same_as<T, std::string>;
+
+class Config;
+
+/**
+ * @brief Typed handle to one configuration key
+ *
+ * Holds the key's interned index, so get() is an array access into the
+ * current snapshot: no hashing and no locking. Handles stay valid across
+ * reloads and must not outlive their Config.
+ *
+ * @tparam T Value type
+ */
+template<ConfigValueType T>
+class ConfigValue {
+public:
+    /**
+     * @brief Read the value from the current snapshot
+     * @return The value, or std::nullopt if the key is missing or not convertible to T
+     */
+    [[nodiscard]] std::optional<T> get() const;
+
+    /**
+     * @brief Read the value, falling back to a default
+     * @param fallback Value returned if get() would return std::nullopt
+     * @return The value or fallback
+     */
+    [[nodiscard]] T value_or(T fallback) const {
+        auto value = get();
+        return value ? std::move(*value) : std::move(fallback);
+    }
+
+    /**
+     * @brief Get the key name
+     * @return Key name
+     */
+    [[nodiscard]] const std::string& key() const noexcept {
+        return key_;
+    }
+
+private:
+    friend class Config;
+
+    ConfigValue(const Config* config, std::uint32_t id, std::string key)
+        : config_(config), id_(id), key_(std::move(key)) {}
+
+    const Config* config_;
+    std::uint32_t id_;
+    std::string key_;
+};
+
 /**
- * @brief Configuration management class
- * 
- * This class provides configuration management functionality.
- * Add actual implementation as needed.
+ * @brief Configuration store with lock-free hot reload
+ *
+ * Reads INI-style text: `key = value` lines, `[section]` and
+ * `[section.subsection]` headers that prefix the keys below them with
+ * "section.", `#`/`;` comments, and optionally double-quoted values.
+ *
+ * Each load parses the text once into an immutable snapshot: a flat array
+ * indexed by interned key id in which every value is pre-converted to the
+ * types it can be read as. A reload builds a new snapshot and swaps it in
+ * with one atomic exchange; readers protect the snapshot they are using with
+ * a per-thread hazard pointer, so they never block on a reload and a snapshot
+ * is freed only once no reader can still see it.
+ *
+ * @example
+ * ```cpp
+ * Config config;
+ * config.load_file("server.ini");
+ * config.watch();
+ * auto port = config.handle<std::int64_t>("server.port");
+ * listen(port.value_or(8080));
+ * ```
  */
 class CPPTEMPLATE_CORE_API Config {
 public:
-    // Add configuration methods here
-    
+    /**
+     * @brief Create an empty configuration
+     */
+    Config();
+
+    /**
+     * @brief Destructor, stops the watcher if running
+     */
+    ~Config();
+
+    Config(const Config&) = delete;
+    Config& operator=(const Config&) = delete;
+    Config(Config&&) = delete;
+    Config& operator=(Config&&) = delete;
+
+    /**
+     * @brief Parse a file and publish it; later reloads re-read this file
+     * @param path Configuration file
+     * @throws Exception if the file cannot be read or parsed
+     */
+    void load_file(const std::filesystem::path& path);
+
+    /**
+     * @brief Parse text and publish it
+     * @param text Configuration text
+     * @throws Exception if the text cannot be parsed; the current snapshot is kept
+     */
+    void load_string(std::string_view text);
+
+    /**
+     * @brief Re-read the file passed to load_file
+     * @throws Exception if no file was loaded or it cannot be read or parsed
+     */
+    void reload();
+
+    /**
+     * @brief Reload automatically whenever the file changes (Linux inotify)
+     *
+     * The directory is watched so editors that replace the file by renaming
+     * are handled. Failed reloads keep the current snapshot and are reported
+     * through last_error().
+     *
+     * @throws Exception if no file was loaded or watching is not supported
+     */
+    void watch();
+
+    /**
+     * @brief Stop the watcher started by watch()
+     */
+    void stop_watching();
+
+    /**
+     * @brief Get a typed handle for a key
+     *
+     * The key does not have to exist yet; the handle starts returning a value
+     * once a reload defines it.
+     *
+     * @tparam T Value type
+     * @param key Full key name, e.g. "server.port"
+     * @return Handle reading the key in O(1)
+     */
+    template<ConfigValueType T>
+    [[nodiscard]] ConfigValue<T> handle(std::string_view key) {
+        return ConfigValue<T>(this, intern(key), std::string{key});
+    }
+
+    /**
+     * @brief Read a key by name
+     *
+     * Hashes the key on every call; prefer handle() on hot paths.
+     *
+     * @tparam T Value type
+     * @param key Full key name
+     * @return The value, or std::nullopt if missing or not convertible to T
+     */
+    template<ConfigValueType T>
+    [[nodiscard]] std::optional<T> get(std::string_view key) const {
+        const auto id = find(key);
+        if (!id) {
+            return std::nullopt;
+        }
+        T value{};
+        if (!read(*id, value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Check whether the current snapshot defines a key
+     * @param key Full key name
+     * @return True if the key is present
+     */
+    [[nodiscard]] bool contains(std::string_view key) const;
+
+    /**
+     * @brief Number of keys defined by the current snapshot
+     * @return Key count
+     */
+    [[nodiscard]] std::size_t size() const;
+
+    /**
+     * @brief Number of snapshots published so far
+     * @return Version counter, 0 before the first load
+     */
+    [[nodiscard]] std::uint64_t version() const noexcept {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Error message of the last failed automatic reload
+     * @return Message, empty if the last automatic reload succeeded
+     */
+    [[nodiscard]] std::string last_error() const;
+
 private:
-    // Add configuration data here
+    template<ConfigValueType>
+    friend class ConfigValue;
+
+    std::uint32_t intern(std::string_view key);
+    [[nodiscard]] std::optional<std::uint32_t> find(std::string_view key) const;
+
+    bool read(std::uint32_t id, bool& out) const;
+    bool read(std::uint32_t id, std::int64_t& out) const;
+    bool read(std::uint32_t id, double& out) const;
+    bool read(std::uint32_t id, std::string& out) const;
+
+    void publish(detail::ConfigSnapshot* snapshot);
+    void watch_loop(int inotify_fd, int stop_fd);
+
+    std::atomic<const detail::ConfigSnapshot*> current_;
+    std::atomic<std::uint64_t> version_{0};
+
+    mutable std::mutex keys_mutex_; ///< Guards key_ids_
+    std::unordered_map<std::string, std::uint32_t, detail::StringHash, std::equal_to<>> key_ids_;
+
+    std::mutex publish_mutex_; ///< Serializes loads; guards retired_ and path_
+    std::vector<const detail::ConfigSnapshot*> retired_;
+    std::filesystem::path path_;
+
+    mutable std::mutex error_mutex_;
+    std::string last_error_;
+
+    std::thread watcher_;
+    int stop_fd_ = -1;
 };
 
-} // namespace cpptemplate::core
\ No newline at end of file
+template<ConfigValueType T>
+std::optional<T> ConfigValue<T>::get() const {
+    T value{};
+    if (!config_->read(id_, value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+} // namespace cpptemplate::core
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "cpptemplate/core/export.hpp"
+
+namespace cpptemplate::core {
+
+/**
+ * @brief Instruction set extensions usable on the running CPU
+ *
+ * Detected once at first use. An extension is reported only if both the CPU
+ * and the operating system support it (e.g. AVX-512 register state is saved
+ * on context switch), so code selected from these flags is safe to run.
+ */
+struct CpuFeatures {
+    bool sse42 = false;    ///< x86 SSE4.2
+    bool avx2 = false;     ///< x86 AVX2
+    bool fma = false;      ///< x86 FMA3
+    bool avx512f = false;  ///< x86 AVX-512 Foundation
+    bool avx512bw = false; ///< x86 AVX-512 Byte and Word
+    bool neon = false;     ///< ARM Advanced SIMD
+};
+
+/**
+ * @brief Get the features of the running CPU
+ * @return Features, detected on the first call
+ */
+[[nodiscard]] CPPTEMPLATE_CORE_API const CpuFeatures& cpu_features() noexcept;
+
+} // namespace cpptemplate::core
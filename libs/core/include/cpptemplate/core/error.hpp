@@ -0,0 +1,130 @@
+#pragma once
+
+#include <concepts>
+#include <string_view>
+#include <type_traits>
+
+#include "cpptemplate/core/export.hpp"
+
+namespace cpptemplate::core {
+
+/**
+ * @brief Static description of a family of error codes
+ *
+ * Categories are singletons with static storage duration and return messages
+ * as string literals, so creating, copying and describing an Error never
+ * allocates.
+ */
+class CPPTEMPLATE_CORE_API ErrorCategory {
+public:
+    constexpr ErrorCategory() noexcept = default;
+    virtual ~ErrorCategory() = default;
+
+    ErrorCategory(const ErrorCategory&) = delete;
+    ErrorCategory& operator=(const ErrorCategory&) = delete;
+
+    /**
+     * @brief Category name
+     * @return Static string naming the category
+     */
+    [[nodiscard]] virtual std::string_view name() const noexcept = 0;
+
+    /**
+     * @brief Describe an error code of this category
+     * @param code Error code
+     * @return Static string describing the code
+     */
+    [[nodiscard]] virtual std::string_view message(int code) const noexcept = 0;
+};
+
+/**
+ * @brief Error codes of the core category
+ */
+enum class Errc {
+    InvalidArgument = 1,
+    DivisionByZero,
+    DomainError,
+    OutOfRange,
+    Overflow,
+    ParseError,
+    NotFound
+};
+
+/**
+ * @brief Category of core::Errc
+ * @return Category singleton
+ */
+[[nodiscard]] CPPTEMPLATE_CORE_API const ErrorCategory& core_category() noexcept;
+
+/**
+ * @brief Enums that convert to Error through an ADL-found make_error()
+ */
+template<typename E>
+concept ErrorCodeEnum = std::is_enum_v<E> && requires(E e) {
+    { make_error(e) };
+};
+
+/**
+ * @brief A trivially copyable error value: code plus static category
+ *
+ * Two words, no allocation and no unwinding; the allocation-free counterpart
+ * of core::Exception for hot paths that see bad input regularly.
+ */
+class Error {
+public:
+    constexpr Error(int code, const ErrorCategory& category) noexcept
+        : code_(code), category_(&category) {}
+
+    /**
+     * @brief Create from an error enum, e.g. Error{Errc::DivisionByZero}
+     */
+    template<ErrorCodeEnum E>
+    constexpr Error(E code) noexcept : Error(make_error(code)) {} // NOLINT(google-explicit-constructor)
+
+    [[nodiscard]] constexpr int code() const noexcept {
+        return code_;
+    }
+
+    [[nodiscard]] constexpr const ErrorCategory& category() const noexcept {
+        return *category_;
+    }
+
+    [[nodiscard]] std::string_view message() const noexcept {
+        return category_->message(code_);
+    }
+
+    friend constexpr bool operator==(const Error& lhs, const Error& rhs) noexcept {
+        return lhs.code_ == rhs.code_ && lhs.category_ == rhs.category_;
+    }
+
+    template<ErrorCodeEnum E>
+    friend constexpr bool operator==(const Error& lhs, E rhs) noexcept {
+        return lhs == Error(rhs);
+    }
+
+private:
+    int code_;
+    const ErrorCategory* category_;
+};
+
+namespace detail {
+
+/**
+ * @brief Throw core::Exception describing an error
+ *
+ * Out of line so headers using Error do not need exception.hpp.
+ */
+[[noreturn]] CPPTEMPLATE_CORE_API void throw_error(const Error& error);
+
+} // namespace detail
+
+/**
+ * @brief Convert a core error code to an Error
+ * @param code Error code
+ * @return Error in core_category()
+ */
+[[nodiscard]] inline Error make_error(Errc code) noexcept {
+    return Error(static_cast<int>(code), core_category());
+}
+
+} // namespace cpptemplate::core
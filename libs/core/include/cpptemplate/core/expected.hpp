@@ -0,0 +1,296 @@
+#pragma once
+
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "cpptemplate/core/error.hpp"
+
+namespace cpptemplate::core {
+
+/**
+ * @brief Wrapper marking a value as the error alternative of an Expected
+ * @tparam E Error type
+ */
+template<typename E>
+class Unexpected {
+public:
+    constexpr explicit Unexpected(E error) noexcept(std::is_nothrow_move_constructible_v<E>)
+        : error_(std::move(error)) {}
+
+    [[nodiscard]] constexpr const E& error() const& noexcept {
+        return error_;
+    }
+
+    [[nodiscard]] constexpr E&& error() && noexcept {
+        return std::move(error_);
+    }
+
+private:
+    E error_;
+};
+
+template<typename E>
+Unexpected(E) -> Unexpected<E>;
+
+/**
+ * @brief Shorthand for returning a core error from a function returning Expected
+ *
+ * @example
+ * ```cpp
+ * if (b == 0.0) {
+ *     return unexpected(Errc::DivisionByZero);
+ * }
+ * ```
+ */
+template<ErrorCodeEnum E>
+[[nodiscard]] constexpr Unexpected<Error> unexpected(E code) noexcept {
+    return Unexpected<Error>(Error(code));
+}
+
+/**
+ * @brief Either a value or an error, in the style of C++23 std::expected
+ *
+ * Stored in place (no allocation); with trivially copyable T and E the whole
+ * object is trivially copyable and returned in registers where the ABI allows.
+ * value() on an error throws core::Exception, so use has_value() or
+ * value_or() on paths that must not throw.
+ *
+ * @tparam T Value type
+ * @tparam E Error type
+ */
+template<typename T, typename E = Error>
+class [[nodiscard]] Expected {
+public:
+    using value_type = T;
+    using error_type = E;
+
+    constexpr Expected()
+        requires std::default_initializable<T>
+        : value_(), has_value_(true) {}
+
+    template<typename U = T>
+        requires(std::constructible_from<T, U &&> &&
+                 !std::same_as<std::remove_cvref_t<U>, Expected> &&
+                 !std::same_as<std::remove_cvref_t<U>, std::in_place_t>)
+    constexpr Expected(U&& value) // NOLINT(google-explicit-constructor)
+        : value_(std::forward<U>(value)), has_value_(true) {}
+
+    template<typename G>
+        requires std::constructible_from<E, const G&>
+    constexpr Expected(const Unexpected<G>& error) // NOLINT(google-explicit-constructor)
+        : error_(error.error()), has_value_(false) {}
+
+    template<typename G>
+        requires std::constructible_from<E, G &&>
+    constexpr Expected(Unexpected<G>&& error) // NOLINT(google-explicit-constructor)
+        : error_(std::move(error).error()), has_value_(false) {}
+
+    constexpr Expected(const Expected&)
+        requires(std::is_trivially_copy_constructible_v<T> &&
+                 std::is_trivially_copy_constructible_v<E>)
+    = default;
+
+    constexpr Expected(const Expected& other) : has_value_(other.has_value_) {
+        if (has_value_) {
+            std::construct_at(std::addressof(value_), other.value_);
+        } else {
+            std::construct_at(std::addressof(error_), other.error_);
+        }
+    }
+
+    constexpr Expected(Expected&&)
+        requires(std::is_trivially_move_constructible_v<T> &&
+                 std::is_trivially_move_constructible_v<E>)
+    = default;
+
+    constexpr Expected(Expected&& other) noexcept(std::is_nothrow_move_constructible_v<T> &&
+                                                  std::is_nothrow_move_constructible_v<E>)
+        : has_value_(other.has_value_) {
+        if (has_value_) {
+            std::construct_at(std::addressof(value_), std::move(other.value_));
+        } else {
+            std::construct_at(std::addressof(error_), std::move(other.error_));
+        }
+    }
+
+    constexpr Expected& operator=(const Expected&)
+        requires(std::is_trivially_copy_assignable_v<T> && std::is_trivially_copy_assignable_v<E> &&
+                 std::is_trivially_destructible_v<T> && std::is_trivially_destructible_v<E>)
+    = default;
+
+    constexpr Expected& operator=(const Expected& other) {
+        if (this != &other) {
+            destroy();
+            std::construct_at(this, other);
+        }
+        return *this;
+    }
+
+    constexpr Expected& operator=(Expected&&)
+        requires(std::is_trivially_move_assignable_v<T> && std::is_trivially_move_assignable_v<E> &&
+                 std::is_trivially_destructible_v<T> && std::is_trivially_destructible_v<E>)
+    = default;
+
+    constexpr Expected& operator=(Expected&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_constructible_v<E>) {
+        if (this != &other) {
+            destroy();
+            std::construct_at(this, std::move(other));
+        }
+        return *this;
+    }
+
+    constexpr ~Expected()
+        requires(std::is_trivially_destructible_v<T> && std::is_trivially_destructible_v<E>)
+    = default;
+
+    constexpr ~Expected() {
+        destroy();
+    }
+
+    [[nodiscard]] constexpr bool has_value() const noexcept {
+        return has_value_;
+    }
+
+    constexpr explicit operator bool() const noexcept {
+        return has_value_;
+    }
+
+    /**
+     * @brief Access the value
+     * @throws Exception with the error message if there is no value
+     */
+    [[nodiscard]] constexpr T& value() & {
+        check();
+        return value_;
+    }
+
+    [[nodiscard]] constexpr const T& value() const& {
+        check();
+        return value_;
+    }
+
+    [[nodiscard]] constexpr T&& value() && {
+        check();
+        return std::move(value_);
+    }
+
+    /// Unchecked access; the caller must have tested has_value()
+    [[nodiscard]] constexpr T& operator*() & noexcept {
+        return value_;
+    }
+
+    [[nodiscard]] constexpr const T& operator*() const& noexcept {
+        return value_;
+    }
+
+    [[nodiscard]] constexpr T* operator->() noexcept {
+        return std::addressof(value_);
+    }
+
+    [[nodiscard]] constexpr const T* operator->() const noexcept {
+        return std::addressof(value_);
+    }
+
+    /// Unchecked access; the caller must have tested !has_value()
+    [[nodiscard]] constexpr const E& error() const& noexcept {
+        return error_;
+    }
+
+    template<typename U>
+    [[nodiscard]] constexpr T value_or(U&& fallback) const& {
+        return has_value_ ? value_ : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    /**
+     * @brief Chain an operation that itself returns an Expected
+     * @param f Callable taking the value and returning Expected<U, E>
+     * @return f(value) or this error
+     */
+    template<typename F>
+    constexpr auto and_then(F&& f) const& {
+        using Result = std::remove_cvref_t<std::invoke_result_t<F, const T&>>;
+        if (has_value_) {
+            return std::invoke(std::forward<F>(f), value_);
+        }
+        return Result(Unexpected<E>(error_));
+    }
+
+    /**
+     * @brief Map the value, keeping the error
+     * @param f Callable taking the value
+     * @return Expected holding f(value) or this error
+     */
+    template<typename F>
+    constexpr auto transform(F&& f) const& {
+        using U = std::remove_cvref_t<std::invoke_result_t<F, const T&>>;
+        if (has_value_) {
+            return Expected<U, E>(std::invoke(std::forward<F>(f), value_));
+        }
+        return Expected<U, E>(Unexpected<E>(error_));
+    }
+
+private:
+    constexpr void check() const {
+        if (!has_value_) {
+            if constexpr (std::same_as<E, Error>) {
+                detail::throw_error(error_);
+            } else {
+                detail::throw_error(make_error(Errc::InvalidArgument));
+            }
+        }
+    }
+
+    constexpr void destroy() noexcept {
+        if (has_value_) {
+            std::destroy_at(std::addressof(value_));
+        } else {
+            std::destroy_at(std::addressof(error_));
+        }
+    }
+
+    union {
+        T value_;
+        E error_;
+    };
+    bool has_value_;
+};
+
+/**
+ * @brief Status-only Expected: success or an error
+ */
+template<typename E>
+class [[nodiscard]] Expected<void, E> {
+public:
+    using value_type = void;
+    using error_type = E;
+
+    constexpr Expected() noexcept = default;
+
+    template<typename G>
+        requires std::constructible_from<E, const G&>
+    constexpr Expected(const Unexpected<G>& error) // NOLINT(google-explicit-constructor)
+        : error_(error.error()) {}
+
+    [[nodiscard]] constexpr bool has_value() const noexcept {
+        return !error_.has_value();
+    }
+
+    constexpr explicit operator bool() const noexcept {
+        return has_value();
+    }
+
+    /// Unchecked access; the caller must have tested !has_value()
+    [[nodiscard]] constexpr const E& error() const noexcept {
+        return *error_;
+    }
+
+private:
+    std::optional<E> error_;
+};
+
+} // namespace cpptemplate::core
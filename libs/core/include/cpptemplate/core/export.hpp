@@ -0,0 +1,20 @@
+#pragma once
+
+// Export macros for dynamic libraries
+#ifdef CPPTEMPLATE_CORE_STATIC
+    #define CPPTEMPLATE_CORE_API
+#else
+    #ifdef CPPTEMPLATE_CORE_BUILDING
+        #if defined(_WIN32) || defined(_WIN64)
+            #define CPPTEMPLATE_CORE_API __declspec(dllexport)
+        #else
+            #define CPPTEMPLATE_CORE_API __attribute__((visibility("default")))
+        #endif
+    #else
+        #if defined(_WIN32) || defined(_WIN64)
+            #define CPPTEMPLATE_CORE_API __declspec(dllimport)
+        #else
+            #define CPPTEMPLATE_CORE_API
+        #endif
+    #endif
+#endif
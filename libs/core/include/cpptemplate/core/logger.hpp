@@ -1,32 +1,112 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 
 #include <spdlog/spdlog.h>
 
-// Export macros for dynamic libraries
-#ifdef CPPTEMPLATE_CORE_STATIC
-    #define CPPTEMPLATE_CORE_API
-#else
-    #ifdef CPPTEMPLATE_CORE_BUILDING
-        #if defined(_WIN32) || defined(_WIN64)
-            #define CPPTEMPLATE_CORE_API __declspec(dllexport)
-        #else
-            #define CPPTEMPLATE_CORE_API __attribute__((visibility("default")))
-        #endif
-    #else
-        #if defined(_WIN32) || defined(_WIN64)
-            #define CPPTEMPLATE_CORE_API __declspec(dllimport)
-        #else
-            #define CPPTEMPLATE_CORE_API
-        #endif
-    #endif
+#include "cpptemplate/core/binary_log.hpp"
+#include "cpptemplate/core/export.hpp"
+
+// Lowest level compiled into Logger calls; set via the CPPTEMPLATE_LOG_ACTIVE_LEVEL CMake option
+#ifndef CPPTEMPLATE_LOG_ACTIVE_LEVEL
+    #define CPPTEMPLATE_LOG_ACTIVE_LEVEL 0
 #endif
 
 namespace cpptemplate::core {
 
+class LoggerRegistry;
+
+namespace detail {
+class AsyncSink;
+} // namespace detail
+
+/**
+ * @brief Compile-time minimum log level
+ * 
+ * The bodies of Logger calls below this level compile to nothing, but their
+ * arguments are still evaluated. The CPPTEMPLATE_LOG_* macros drop the whole
+ * call instead; lazy() defers a single argument.
+ */
+inline constexpr auto ActiveLevel =
+    static_cast<spdlog::level::level_enum>(CPPTEMPLATE_LOG_ACTIVE_LEVEL);
+
+/**
+ * @brief Check whether a level survives compile-time elision
+ * @param level Log level
+ * @return True if calls at this level are compiled in
+ */
+[[nodiscard]] constexpr bool is_compiled_in(spdlog::level::level_enum level) noexcept {
+    return level >= ActiveLevel && level != spdlog::level::off;
+}
+
+/**
+ * @brief A log argument computed only when the message is actually formatted
+ * 
+ * Create with lazy(); the wrapped callable runs at most once per formatted
+ * record and never when the level is disabled.
+ * 
+ * @tparam F Callable returning a formattable value
+ */
+template<typename F>
+class Lazy {
+public:
+    explicit Lazy(F producer) : producer_(std::move(producer)) {}
+
+    [[nodiscard]] decltype(auto) operator()() const {
+        return producer_();
+    }
+
+private:
+    F producer_;
+};
+
+/**
+ * @brief Wrap an expensive log argument so it is evaluated lazily
+ * 
+ * @example
+ * ```cpp
+ * logger->debug("state: {}", lazy([&] { return dump_state(); }));
+ * ```
+ */
+template<typename F>
+[[nodiscard]] Lazy<std::decay_t<F>> lazy(F&& producer) {
+    return Lazy<std::decay_t<F>>(std::forward<F>(producer));
+}
+
+/**
+ * @brief How log records reach the sinks
+ */
+enum class LogMode {
+    Sync,  ///< Format and write on the calling thread
+    Async  ///< Enqueue on the calling thread, write on a dedicated writer thread
+};
+
+/**
+ * @brief What an asynchronous logger does when its queue is full
+ */
+enum class OverflowPolicy {
+    Block,      ///< Wait until the writer thread frees a slot
+    DropOldest, ///< Discard the oldest queued record to make room
+    DropNewest  ///< Discard the record being logged
+};
+
+/**
+ * @brief Options accepted by Logger::create
+ */
+struct LoggerOptions {
+    LogMode mode = LogMode::Sync;
+    std::size_t queue_size = 8192; ///< Ring capacity, rounded up to a power of two
+    OverflowPolicy overflow_policy = OverflowPolicy::Block;
+    spdlog::level::level_enum level = spdlog::level::info; ///< Initial runtime level
+};
+
 /**
  * @brief A logger wrapper around spdlog providing a clean interface
  * 
@@ -36,22 +116,54 @@ namespace cpptemplate::core {
 class CPPTEMPLATE_CORE_API Logger {
 public:
     /**
-     * @brief Create a logger instance
+     * @brief Get or create a logger instance
+     * 
+     * Loggers are cached by name in LoggerRegistry; asking for an existing name
+     * returns the same instance.
+     * 
      * @param name Logger name
      * @return Shared pointer to logger instance
      */
     [[nodiscard]] static std::shared_ptr<Logger> create(std::string_view name);
 
+    /**
+     * @brief Get or create a logger instance with explicit options
+     * 
+     * In LogMode::Async the calling thread only copies the formatted record into
+     * a bounded lock-free ring buffer; console and file output happen on the
+     * logger's writer thread. The initial level only applies when the logger
+     * is first created.
+     * 
+     * @param name Logger name
+     * @param options Delivery mode and queue configuration
+     * @return Shared pointer to logger instance
+     * @throws Exception if the logger exists with a different mode, queue size or overflow policy
+     */
+    [[nodiscard]] static std::shared_ptr<Logger> create(std::string_view name,
+                                                        const LoggerOptions& options);
+
+    /**
+     * @brief Create a child logger named "<name>.<component>"
+     * 
+     * The child shares this logger's sinks and starts at its current level. It
+     * is not added to the registry, which makes it cheap enough to create per
+     * connection or per request; it lives as long as the returned pointer.
+     * 
+     * @param component Component suffix
+     * @return Shared pointer to the child logger
+     */
+    [[nodiscard]] std::shared_ptr<Logger> child(std::string_view component) const;
+
     /**
      * @brief Destructor
      */
-    ~Logger() = default;
+    ~Logger();
 
     // Make the class non-copyable but movable
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
-    Logger(Logger&&) = default;
-    Logger& operator=(Logger&&) = default;
+    Logger(Logger&& other) noexcept;
+    Logger& operator=(Logger&& other) noexcept;
 
     /**
      * @brief Log trace message
@@ -61,7 +173,11 @@ public:
      */
     template<typename... Args>
     void trace(spdlog::format_string_t<Args...> fmt, Args&&... args) {
-        logger_->trace(fmt, std::forward<Args>(args)...);
+        if constexpr (is_compiled_in(spdlog::level::trace)) {
+            if (should_log(spdlog::level::trace)) {
+                logger_->log(spdlog::level::trace, fmt, std::forward<Args>(args)...);
+            }
+        }
     }
 
     /**
@@ -72,7 +188,11 @@ public:
      */
     template<typename... Args>
     void debug(spdlog::format_string_t<Args...> fmt, Args&&... args) {
-        logger_->debug(fmt, std::forward<Args>(args)...);
+        if constexpr (is_compiled_in(spdlog::level::debug)) {
+            if (should_log(spdlog::level::debug)) {
+                logger_->log(spdlog::level::debug, fmt, std::forward<Args>(args)...);
+            }
+        }
     }
 
     /**
@@ -83,7 +203,11 @@ public:
      */
     template<typename... Args>
     void info(spdlog::format_string_t<Args...> fmt, Args&&... args) {
-        logger_->info(fmt, std::forward<Args>(args)...);
+        if constexpr (is_compiled_in(spdlog::level::info)) {
+            if (should_log(spdlog::level::info)) {
+                logger_->log(spdlog::level::info, fmt, std::forward<Args>(args)...);
+            }
+        }
     }
 
     /**
@@ -94,7 +218,11 @@ public:
      */
     template<typename... Args>
     void warn(spdlog::format_string_t<Args...> fmt, Args&&... args) {
-        logger_->warn(fmt, std::forward<Args>(args)...);
+        if constexpr (is_compiled_in(spdlog::level::warn)) {
+            if (should_log(spdlog::level::warn)) {
+                logger_->log(spdlog::level::warn, fmt, std::forward<Args>(args)...);
+            }
+        }
     }
 
     /**
@@ -105,7 +233,11 @@ public:
      */
     template<typename... Args>
     void error(spdlog::format_string_t<Args...> fmt, Args&&... args) {
-        logger_->error(fmt, std::forward<Args>(args)...);
+        if constexpr (is_compiled_in(spdlog::level::err)) {
+            if (should_log(spdlog::level::err)) {
+                logger_->log(spdlog::level::err, fmt, std::forward<Args>(args)...);
+            }
+        }
     }
 
     /**
@@ -116,7 +248,44 @@ public:
      */
     template<typename... Args>
     void critical(spdlog::format_string_t<Args...> fmt, Args&&... args) {
-        logger_->critical(fmt, std::forward<Args>(args)...);
+        if constexpr (is_compiled_in(spdlog::level::critical)) {
+            if (should_log(spdlog::level::critical)) {
+                logger_->log(spdlog::level::critical, fmt, std::forward<Args>(args)...);
+            }
+        }
+    }
+
+    /**
+     * @brief Log a message whose formatting is deferred to the backend thread
+     * 
+     * Only the format-string pointer and the raw argument bytes are captured on
+     * the calling thread (see BinaryLog); the format string is still checked at
+     * compile time against the argument types. It must be a string literal.
+     * 
+     * @tparam Args Argument types, restricted to DeferredLogArgument
+     * @param level Log level
+     * @param fmt Format string literal
+     * @param args Arguments
+     */
+    template<DeferredLogArgument... Args>
+    void log_deferred(spdlog::level::level_enum level, DeferredFormat<Args...> fmt,
+                      Args&&... args) {
+        if (!should_log(level)) {
+            return;
+        }
+        detail::write_record(binary_id(), level, fmt.get(), args...);
+    }
+
+    /**
+     * @brief Check whether a message at the given level would be logged
+     * 
+     * Costs one relaxed atomic load and a compare.
+     * 
+     * @param level Log level
+     * @return True if the level is compiled in and enabled at runtime
+     */
+    [[nodiscard]] bool should_log(spdlog::level::level_enum level) const noexcept {
+        return is_compiled_in(level) && logger_->should_log(level);
     }
 
     /**
@@ -131,14 +300,118 @@ public:
      */
     [[nodiscard]] std::string name() const;
 
+    /**
+     * @brief Flush all sinks
+     * 
+     * Deferred records and, for asynchronous loggers, queued records written
+     * before the call are delivered first.
+     */
+    void flush();
+
+    /**
+     * @brief Number of records discarded because the async queue was full
+     * 
+     * Child loggers share their parent's queue, so the count covers them too.
+     * 
+     * @return Dropped record count (always zero for synchronous loggers)
+     */
+    [[nodiscard]] std::uint64_t dropped_messages() const noexcept;
+
 private:
+    friend class LoggerRegistry;
+
     /**
      * @brief Private constructor - use factory method
      * @param logger spdlog logger instance
+     * @param async_sink Queue feeding the writer thread, null for synchronous loggers
      */
-    explicit Logger(std::shared_ptr<spdlog::logger> logger);
+    Logger(std::shared_ptr<spdlog::logger> logger, std::shared_ptr<detail::AsyncSink> async_sink);
+
+    /// Deferred-logging id, registered on first use so loggers that never defer cost nothing
+    [[nodiscard]] std::uint32_t binary_id() {
+        const auto id = binary_id_.load(std::memory_order_acquire);
+        return id != detail::NoBinaryLoggerId ? id : register_binary_id();
+    }
+
+    std::uint32_t register_binary_id();
 
     std::shared_ptr<spdlog::logger> logger_;
+    std::shared_ptr<detail::AsyncSink> async_sink_;
+    std::atomic<std::uint32_t> binary_id_{detail::NoBinaryLoggerId};
 };
 
-} // namespace cpptemplate::core
\ No newline at end of file
+} // namespace cpptemplate::core
+
+/**
+ * @brief Formats Lazy arguments by invoking them, reusing the result type's formatter
+ */
+template<typename F, typename Char>
+struct fmt::formatter<cpptemplate::core::Lazy<F>, Char>
+    : fmt::formatter<std::remove_cvref_t<std::invoke_result_t<const F&>>, Char> {
+    template<typename FormatContext>
+    auto format(const cpptemplate::core::Lazy<F>& value, FormatContext& ctx) const {
+        using Result = std::remove_cvref_t<std::invoke_result_t<const F&>>;
+        return fmt::formatter<Result, Char>::format(value(), ctx);
+    }
+};
+
+/**
+ * @brief Call-site logging macros
+ * 
+ * Unlike the Logger member functions, these skip argument evaluation: below
+ * CPPTEMPLATE_LOG_ACTIVE_LEVEL the whole statement compiles to nothing, and
+ * above it the arguments are only evaluated when the runtime level is enabled.
+ * 
+ * @example
+ * ```cpp
+ * CPPTEMPLATE_LOG_DEBUG(logger, "state: {}", dump_state());
+ * ```
+ */
+#define CPPTEMPLATE_LOG_CALL(logger, level, method, ...) \
+    do {                                                 \
+        if ((logger)->should_log(level)) {               \
+            (logger)->method(__VA_ARGS__);               \
+        }                                                \
+    } while (false)
+
+#if CPPTEMPLATE_LOG_ACTIVE_LEVEL <= 0
+    #define CPPTEMPLATE_LOG_TRACE(logger, ...) \
+        CPPTEMPLATE_LOG_CALL(logger, ::spdlog::level::trace, trace, __VA_ARGS__)
+#else
+    #define CPPTEMPLATE_LOG_TRACE(logger, ...) static_cast<void>(0)
+#endif
+
+#if CPPTEMPLATE_LOG_ACTIVE_LEVEL <= 1
+    #define CPPTEMPLATE_LOG_DEBUG(logger, ...) \
+        CPPTEMPLATE_LOG_CALL(logger, ::spdlog::level::debug, debug, __VA_ARGS__)
+#else
+    #define CPPTEMPLATE_LOG_DEBUG(logger, ...) static_cast<void>(0)
+#endif
+
+#if CPPTEMPLATE_LOG_ACTIVE_LEVEL <= 2
+    #define CPPTEMPLATE_LOG_INFO(logger, ...) \
+        CPPTEMPLATE_LOG_CALL(logger, ::spdlog::level::info, info, __VA_ARGS__)
+#else
+    #define CPPTEMPLATE_LOG_INFO(logger, ...) static_cast<void>(0)
+#endif
+
+#if CPPTEMPLATE_LOG_ACTIVE_LEVEL <= 3
+    #define CPPTEMPLATE_LOG_WARN(logger, ...) \
+        CPPTEMPLATE_LOG_CALL(logger, ::spdlog::level::warn, warn, __VA_ARGS__)
+#else
+    #define CPPTEMPLATE_LOG_WARN(logger, ...) static_cast<void>(0)
+#endif
+
+#if CPPTEMPLATE_LOG_ACTIVE_LEVEL <= 4
+    #define CPPTEMPLATE_LOG_ERROR(logger, ...) \
+        CPPTEMPLATE_LOG_CALL(logger, ::spdlog::level::err, error, __VA_ARGS__)
+#else
+    #define CPPTEMPLATE_LOG_ERROR(logger, ...) static_cast<void>(0)
+#endif
+
+#if CPPTEMPLATE_LOG_ACTIVE_LEVEL <= 5
+    #define CPPTEMPLATE_LOG_CRITICAL(logger, ...) \
+        CPPTEMPLATE_LOG_CALL(logger, ::spdlog::level::critical, critical, __VA_ARGS__)
+#else
+    #define CPPTEMPLATE_LOG_CRITICAL(logger, ...) static_cast<void>(0)
+#endif
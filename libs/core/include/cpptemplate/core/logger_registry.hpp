@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cpptemplate/core/export.hpp"
+#include "cpptemplate/core/logger.hpp"
+#include "cpptemplate/core/string_hash.hpp"
+
+namespace cpptemplate::core {
+
+/**
+ * @brief Implementation of the shared log file sink
+ */
+enum class FileSinkType {
+    Rotating, ///< spdlog rotating file sink; buffered, flushed at error level
+    Mapped    ///< MappedFileSink; lock-free and crash-safe
+};
+
+/**
+ * @brief Options accepted by LoggerRegistry::configure
+ */
+struct LoggerRegistryOptions {
+    FileSinkType file_sink = FileSinkType::Rotating;
+    std::string file_path = "logs/app.log";
+    std::size_t max_file_size = 5 * 1024 * 1024; ///< Bytes per file before rotating
+    std::size_t max_files = 3;                   ///< Rotated files kept besides the active one
+};
+
+/**
+ * @brief Process-wide cache of named loggers
+ *
+ * All loggers write to one shared console sink and one shared file sink
+ * ("logs/app.log" by default, see configure()), so creating a logger no longer
+ * opens files or builds formatters. Each asynchronous logger has its own queue
+ * and writer thread in front of those sinks.
+ *
+ * Lookups are lock-free: the name table is an immutable snapshot replaced
+ * copy-on-write when a logger is added or dropped, and each thread caches the
+ * snapshot it last saw together with a version counter. A lookup is one
+ * atomic load plus one hash probe; the mutex is only taken after the table
+ * has changed.
+ */
+class CPPTEMPLATE_CORE_API LoggerRegistry {
+public:
+    /**
+     * @brief Get the process-wide registry
+     * @return Registry instance
+     */
+    [[nodiscard]] static LoggerRegistry& instance();
+
+    /**
+     * @brief Configure the shared sinks
+     * @param options File sink options
+     * @throws Exception if the registry has already been created
+     */
+    static void configure(const LoggerRegistryOptions& options);
+
+    ~LoggerRegistry();
+
+    LoggerRegistry(const LoggerRegistry&) = delete;
+    LoggerRegistry& operator=(const LoggerRegistry&) = delete;
+    LoggerRegistry(LoggerRegistry&&) = delete;
+    LoggerRegistry& operator=(LoggerRegistry&&) = delete;
+
+    /**
+     * @brief Get a logger, creating it on first use
+     * The initial level only applies when the logger is created; the level
+     * can be changed later through Logger::set_level(). The mode and queue
+     * configuration cannot, so they must match an existing logger.
+     *
+     * @param name Logger name
+     * @param options Options for a new logger
+     * @return Shared pointer to the cached logger
+     * @throws Exception if the logger exists with a different mode, queue size or overflow policy
+     */
+    [[nodiscard]] std::shared_ptr<Logger> get(std::string_view name,
+                                              const LoggerOptions& options = {});
+
+    /**
+     * @brief Look up an existing logger
+     * @param name Logger name
+     * @return Shared pointer to the logger, or nullptr if it is not registered
+     */
+    [[nodiscard]] std::shared_ptr<Logger> find(std::string_view name) const;
+
+    /**
+     * @brief Remove a logger from the registry
+     *
+     * Existing shared pointers stay valid; the next get() with the same name
+     * creates a fresh logger.
+     *
+     * @param name Logger name
+     * @return True if a logger was removed
+     */
+    bool drop(std::string_view name);
+
+    /**
+     * @brief Number of registered loggers
+     * @return Logger count
+     */
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    using LoggerMap = std::unordered_map<std::string, std::shared_ptr<Logger>, detail::StringHash,
+                                         std::equal_to<>>;
+
+    LoggerRegistry();
+
+    /// Shared sink list for a new logger; caller holds mutex_
+    std::vector<spdlog::sink_ptr> sinks_for(const LoggerOptions& options,
+                                            std::shared_ptr<detail::AsyncSink>& async_sink);
+
+    /// Throw if an existing logger was created with a different mode or queue
+    static void check_options(std::string_view name, const Logger& logger,
+                              const LoggerOptions& options);
+
+    /// Replace the snapshot and publish the new version; caller holds mutex_
+    void publish(std::shared_ptr<const LoggerMap> loggers);
+
+    mutable std::mutex mutex_;
+    std::vector<spdlog::sink_ptr> sinks_;
+    std::shared_ptr<const LoggerMap> loggers_;
+    std::atomic<std::uint64_t> version_{0};
+};
+
+} // namespace cpptemplate::core
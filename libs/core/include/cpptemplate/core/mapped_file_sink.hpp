@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/formatter.h>
+#include <spdlog/sinks/sink.h>
+
+#include "cpptemplate/core/export.hpp"
+
+namespace cpptemplate::core {
+
+/**
+ * @brief Options for MappedFileSink
+ */
+struct MappedFileSinkOptions {
+    std::string path = "logs/app.log";
+    std::size_t file_size = 5 * 1024 * 1024; ///< Bytes per file, rounded up to the page size
+    std::size_t max_files = 3;               ///< Rotated files kept besides the active one
+};
+
+/**
+ * @brief Crash-safe file sink writing into a memory-mapped, pre-sized file
+ *
+ * The active file is extended to its full size up front and mapped shared.
+ * Writers format on their own thread, reserve a byte range with one atomic
+ * add and copy the record into the mapping, so no lock is taken and nothing
+ * is buffered in the process: once log() returns the record is in the page
+ * cache and survives a crash of the process.
+ *
+ * When a reservation no longer fits, the file is trimmed to the bytes written,
+ * rotated like spdlog's rotating sink (app.log -> app.1.log -> ...) and a new
+ * file is mapped. Until the sink is destroyed or rotates, the unused tail of
+ * the active file reads as NUL bytes; a file left behind by a crash is trimmed
+ * when the next sink opens it.
+ *
+ * Only available on POSIX systems; the constructor throws elsewhere.
+ */
+class CPPTEMPLATE_CORE_API MappedFileSink final : public spdlog::sinks::sink {
+public:
+    /**
+     * @brief Open (or recover) the active file and map it
+     * @param options File location, size and rotation depth
+     * @throws Exception if the file cannot be created or mapped
+     */
+    explicit MappedFileSink(MappedFileSinkOptions options);
+    ~MappedFileSink() override;
+
+    MappedFileSink(const MappedFileSink&) = delete;
+    MappedFileSink& operator=(const MappedFileSink&) = delete;
+    MappedFileSink(MappedFileSink&&) = delete;
+    MappedFileSink& operator=(MappedFileSink&&) = delete;
+
+    void log(const spdlog::details::log_msg& msg) override;
+
+    /**
+     * @brief Schedule write-back of the mapping
+     *
+     * Not needed for crash safety of the process, only to bound data loss if
+     * the whole machine goes down.
+     */
+    void flush() override;
+
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    /**
+     * @brief Number of records discarded because they are larger than a file
+     * @return Dropped record count
+     */
+    [[nodiscard]] std::uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Segment {
+        std::byte* base = nullptr; ///< capacity_ bytes mapped, null while closed
+        int fd = -1;
+        alignas(64) std::atomic<std::size_t> reserved{0};
+        alignas(64) std::atomic<std::uint32_t> writers{0};
+    };
+
+    void write(const char* data, std::size_t size);
+    void rotate(Segment* full);
+    void open_segment(Segment& segment);
+    void close_segment(Segment& segment);
+    void rotate_files();
+
+    const MappedFileSinkOptions options_;
+    const std::size_t capacity_;
+    const std::uint64_t id_; ///< Distinguishes sinks in the per-thread formatter cache
+
+    std::mutex mutex_; ///< Serializes rotation, flush and formatter changes
+    std::unique_ptr<spdlog::formatter> formatter_;
+    std::atomic<std::uint64_t> formatter_version_{0};
+
+    // A writer may load current_ and stall until after the segment is
+    // retired, so a retired segment is never freed: the two alternate,
+    // active and retired. A stale writer's reservation on a retired segment
+    // fails because its reserved count is past capacity; once the segment
+    // is reopened the reservation is fresh and lands in the new file.
+    std::array<Segment, 2> segments_;
+    std::atomic<Segment*> current_{nullptr};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+} // namespace cpptemplate::core
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "cpptemplate/core/export.hpp"
+
+// x86 kernels are compiled per function with target attributes, so the rest
+// of each library keeps the build's baseline instruction set
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    #define CPPTEMPLATE_X86_KERNELS 1
+    #define CPPTEMPLATE_SSE42       __attribute__((target("sse4.2")))
+    #define CPPTEMPLATE_AVX2        __attribute__((target("avx2")))
+    #define CPPTEMPLATE_AVX2_FMA    __attribute__((target("avx2,fma")))
+    #define CPPTEMPLATE_AVX512      __attribute__((target("avx512f")))
+#else
+    #define CPPTEMPLATE_X86_KERNELS 0
+#endif
+
+// Advanced SIMD is part of the AArch64 baseline, so no attributes are needed
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    #define CPPTEMPLATE_NEON_KERNELS 1
+#else
+    #define CPPTEMPLATE_NEON_KERNELS 0
+#endif
+
+namespace cpptemplate::core {
+
+/**
+ * @brief Instruction set the SIMD kernels of every library dispatch to
+ *
+ * Each kernel table maps a level to the best kernels it has at or below it;
+ * the string kernels, for instance, use AVX2 at Avx512.
+ */
+enum class SimdLevel : std::uint8_t {
+    Scalar, ///< Portable C++ loops (auto-vectorized to the build's baseline)
+    Sse42,  ///< x86 SSE4.2, 128-bit vectors
+    Avx2,   ///< x86 AVX2, 256-bit vectors
+    Avx512, ///< x86 AVX-512F, 512-bit vectors
+    Neon    ///< ARM Advanced SIMD, 128-bit vectors
+};
+
+/**
+ * @brief Best level supported by both this build and the running CPU
+ * @return Detected level
+ */
+[[nodiscard]] CPPTEMPLATE_CORE_API SimdLevel detected_simd_level() noexcept;
+
+/**
+ * @brief Level the SIMD kernels currently dispatch to
+ *
+ * Defaults to detected_simd_level().
+ *
+ * @return Active level
+ */
+[[nodiscard]] CPPTEMPLATE_CORE_API SimdLevel simd_level() noexcept;
+
+/**
+ * @brief Select the level the SIMD kernels dispatch to
+ *
+ * Mainly for tests and benchmarks comparing kernels. A level the running
+ * CPU lacks falls back to the best supported level below it (Avx512 to
+ * Avx2 to Sse42, Neon to Scalar). Thread-safe; calls already in progress
+ * finish on the level they started with.
+ *
+ * @param level Requested level
+ * @return Level now in effect
+ */
+CPPTEMPLATE_CORE_API SimdLevel set_simd_level(SimdLevel level) noexcept;
+
+/**
+ * @brief Get the name of a level
+ * @param level Level
+ * @return "scalar", "sse4.2", "avx2", "avx512" or "neon"
+ */
+[[nodiscard]] CPPTEMPLATE_CORE_API std::string_view to_string(SimdLevel level) noexcept;
+
+} // namespace cpptemplate::core
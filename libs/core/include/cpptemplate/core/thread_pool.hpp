@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cpptemplate/core/export.hpp"
+
+namespace cpptemplate::core {
+
+/**
+ * @brief Fork/join thread pool with work stealing
+ *
+ * parallel_for() splits an index range in halves down to a grain size:
+ * each thread keeps splitting its own range, pushing the other half onto
+ * its own deque, and idle threads steal the largest pending halves from
+ * the front of other deques. The calling thread works too, so a pool of
+ * size() N runs N - 1 background threads, and a pool of size 1 runs
+ * everything inline. Calls may nest and may come from several threads.
+ *
+ * @example
+ * ```cpp
+ * ThreadPool& pool = ThreadPool::shared();
+ * pool.parallel_for(values.size(), 4096, [&](std::size_t begin, std::size_t end) {
+ *     for (std::size_t i = begin; i < end; ++i) {
+ *         values[i] = std::sqrt(values[i]);
+ *     }
+ * });
+ * ```
+ */
+class CPPTEMPLATE_CORE_API ThreadPool {
+public:
+    /**
+     * @brief Start a pool
+     * @param threads Threads working on each call, including the caller; 0 means
+     *                std::thread::hardware_concurrency()
+     */
+    explicit ThreadPool(std::size_t threads = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    /**
+     * @brief Stop and join the background threads
+     *
+     * No parallel_for() may be running.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Process-wide pool sized to the hardware, created on first use
+     * @return Shared pool
+     */
+    [[nodiscard]] static ThreadPool& shared();
+
+    /// Threads working on each call, including the caller
+    [[nodiscard]] std::size_t size() const noexcept {
+        return workers_.size() + 1;
+    }
+
+    /**
+     * @brief Run body over [0, count) in parallel and wait for it
+     *
+     * body(begin, end) is called on disjoint subranges covering every
+     * index once, each at most grain long (and at least grain / 2 unless the
+     * whole range is smaller). If a call throws, subranges not yet started
+     * are skipped and the first exception is rethrown here once the others
+     * have finished.
+     *
+     * @param count Number of indices
+     * @param grain Largest subrange handed to one body call, at least 1
+     * @param body Callable as body(std::size_t begin, std::size_t end)
+     */
+    template<typename Body>
+        requires std::is_invocable_v<Body&, std::size_t, std::size_t>
+    void parallel_for(std::size_t count, std::size_t grain, Body&& body) {
+        // Body may be const; the cast back restores the qualifiers body was passed with
+        using Target = std::remove_reference_t<Body>;
+        auto invoke = [](const void* context, std::size_t begin, std::size_t end) {
+            (*static_cast<Target*>(const_cast<void*>(context)))(begin, end);
+        };
+        run(count, grain, invoke, static_cast<const void*>(std::addressof(body)));
+    }
+
+private:
+    struct Job;
+    struct Task;
+    struct Worker;
+
+    using Invoke = void (*)(const void* context, std::size_t begin, std::size_t end);
+
+    void run(std::size_t count, std::size_t grain, Invoke invoke, const void* context);
+    void execute(Task task, std::size_t queue);
+    void push(Task task, std::size_t queue);
+    bool try_pop(std::size_t queue, Task& task);
+    bool try_steal(std::size_t thief, Task& task);
+    void worker_loop(std::size_t index);
+
+    std::vector<std::unique_ptr<Worker>> queues_; ///< One per background thread, plus one for callers
+    std::vector<std::thread> workers_;
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<std::size_t> sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+} // namespace cpptemplate::core
@@ -0,0 +1,209 @@
+#include "async_sink.hpp"
+
+#include <cstdio>
+#include <exception>
+
+#include <spdlog/details/fmt_helper.h>
+
+namespace cpptemplate::core::detail {
+
+void AsyncSink::Record::assign(const spdlog::details::log_msg& source) {
+    buffer.clear();
+    spdlog::details::fmt_helper::append_string_view(source.logger_name, buffer);
+    spdlog::details::fmt_helper::append_string_view(source.payload, buffer);
+
+    msg = source;
+    msg.logger_name = spdlog::string_view_t{buffer.data(), source.logger_name.size()};
+    msg.payload = spdlog::string_view_t{buffer.data() + source.logger_name.size(),
+                                        source.payload.size()};
+}
+
+AsyncSink::AsyncSink(std::vector<spdlog::sink_ptr> sinks, std::size_t queue_size,
+                     OverflowPolicy policy)
+    : sinks_(std::move(sinks)),
+      policy_(policy),
+      mask_(capacity_for(queue_size) - 1),
+      slots_(std::make_unique<Slot[]>(mask_ + 1)) {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer_ = std::thread([this] { writer_loop(); });
+}
+
+AsyncSink::~AsyncSink() {
+    stopping_.store(true, std::memory_order_release);
+    {
+        std::lock_guard lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+    writer_.join();
+}
+
+void AsyncSink::log(const spdlog::details::log_msg& msg) {
+    switch (policy_) {
+        case OverflowPolicy::Block:
+            while (!try_push(msg)) {
+                wake_writer();
+                std::this_thread::yield();
+            }
+            break;
+        case OverflowPolicy::DropOldest:
+            while (!try_push(msg)) {
+                if (try_pop([](Record&) {})) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    completed_.fetch_add(1, std::memory_order_release);
+                }
+            }
+            break;
+        case OverflowPolicy::DropNewest:
+            if (!try_push(msg)) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            break;
+    }
+    wake_writer();
+}
+
+void AsyncSink::flush() {
+    const auto target = enqueue_pos_.load(std::memory_order_acquire);
+    while (completed_.load(std::memory_order_acquire) < target) {
+        wake_writer();
+        std::this_thread::yield();
+    }
+    for (auto& sink : sinks_) {
+        sink->flush();
+    }
+}
+
+void AsyncSink::set_pattern(const std::string& pattern) {
+    for (auto& sink : sinks_) {
+        sink->set_pattern(pattern);
+    }
+}
+
+void AsyncSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    for (auto& sink : sinks_) {
+        sink->set_formatter(sink_formatter->clone());
+    }
+}
+
+bool AsyncSink::try_push(const spdlog::details::log_msg& msg) {
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // Queue is full
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record.assign(msg);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename Consumer>
+bool AsyncSink::try_pop(Consumer&& consumer) {
+    auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+        if (diff == 0) {
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // Queue is empty
+        } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    consumer(slot->record);
+    slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+void AsyncSink::wake_writer() {
+    // Pairs with the fence in writer_loop: either the writer sees the new
+    // record before going to sleep, or we see it idle and wake it up.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (writer_idle_.load(std::memory_order_relaxed) && writer_idle_.exchange(false)) {
+        std::lock_guard lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+void AsyncSink::writer_loop() {
+    // Copy each record out before writing it, so a slow sink never keeps a
+    // slot from producers (drop-oldest would otherwise find nothing to evict)
+    Record current;
+    auto take = [&current](Record& record) { current.assign(record.msg); };
+    auto forward = [&] {
+        write(current.msg);
+        completed_.fetch_add(1, std::memory_order_release);
+    };
+
+    for (;;) {
+        if (try_pop(take)) {
+            forward();
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        writer_idle_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (try_pop(take)) {
+            writer_idle_.store(false, std::memory_order_relaxed);
+            forward();
+            continue;
+        }
+
+        std::unique_lock lock(wake_mutex_);
+        wake_cv_.wait(lock, [this] {
+            return !writer_idle_.load() || stopping_.load(std::memory_order_acquire);
+        });
+        writer_idle_.store(false, std::memory_order_relaxed);
+    }
+
+    // Drain whatever producers managed to enqueue before shutdown
+    while (try_pop(take)) {
+        forward();
+    }
+    for (auto& sink : sinks_) {
+        sink->flush();
+    }
+}
+
+void AsyncSink::write(const spdlog::details::log_msg& msg) {
+    const bool flush = msg.level >= flush_level_.load(std::memory_order_relaxed);
+    for (auto& sink : sinks_) {
+        if (!sink->should_log(msg.level)) {
+            continue;
+        }
+        try {
+            sink->log(msg);
+            if (flush) {
+                sink->flush();
+            }
+        } catch (const std::exception& ex) {
+            // There is no caller to report to on the writer thread
+            std::fprintf(stderr, "[cpptemplate] async log sink error: %s\n", ex.what());
+        }
+    }
+}
+
+} // namespace cpptemplate::core::detail
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/sink.h>
+
+#include "cpptemplate/core/logger.hpp"
+
+namespace cpptemplate::core::detail {
+
+/**
+ * @brief spdlog sink that hands records to a dedicated writer thread
+ *
+ * Producers copy each record into a preallocated slot of a bounded
+ * multi-producer ring buffer (Vyukov-style sequence numbers, no locks on the
+ * enqueue path). A single writer thread drains the ring and forwards records
+ * to the wrapped sinks, which do the actual formatting and I/O.
+ */
+class AsyncSink final : public spdlog::sinks::sink {
+public:
+    AsyncSink(std::vector<spdlog::sink_ptr> sinks, std::size_t queue_size, OverflowPolicy policy);
+    ~AsyncSink() override;
+
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+    AsyncSink(AsyncSink&&) = delete;
+    AsyncSink& operator=(AsyncSink&&) = delete;
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    /// Records at or above @p level make the writer flush the wrapped sinks after writing them
+    void flush_on(spdlog::level::level_enum level) noexcept {
+        flush_level_.store(level, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    [[nodiscard]] OverflowPolicy policy() const noexcept {
+        return policy_;
+    }
+
+    /// Ring capacity used for a requested queue size
+    [[nodiscard]] static std::size_t capacity_for(std::size_t queue_size) noexcept {
+        return std::bit_ceil(std::max<std::size_t>(queue_size, 2));
+    }
+
+private:
+    /// Owns copies of the logger name and payload so the record outlives the caller's buffers
+    struct Record {
+        void assign(const spdlog::details::log_msg& source);
+
+        spdlog::details::log_msg msg;
+        spdlog::memory_buf_t buffer;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<std::size_t> sequence{0};
+        Record record;
+    };
+
+    bool try_push(const spdlog::details::log_msg& msg);
+
+    template<typename Consumer>
+    bool try_pop(Consumer&& consumer);
+
+    void wake_writer();
+    void writer_loop();
+    void write(const spdlog::details::log_msg& msg);
+
+    std::vector<spdlog::sink_ptr> sinks_;
+    const OverflowPolicy policy_;
+    const std::size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<std::size_t> dequeue_pos_{0};
+    alignas(64) std::atomic<std::uint64_t> completed_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<spdlog::level::level_enum> flush_level_{spdlog::level::off};
+
+    std::atomic<bool> writer_idle_{false};
+    std::atomic<bool> stopping_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::thread writer_;
+};
+
+} // namespace cpptemplate::core::detail
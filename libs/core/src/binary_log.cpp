@@ -0,0 +1,649 @@
+#include "cpptemplate/core/binary_log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fmt/args.h>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <spdlog/logger.h>
+
+#include "cpptemplate/core/exception.hpp"
+
+namespace cpptemplate::core {
+namespace detail {
+namespace {
+
+constexpr char FileMagic[8] = {'C', 'T', 'B', 'L', 'O', 'G', '1', '\n'};
+
+// Entry kinds of the on-disk format
+enum class EntryKind : std::uint8_t { Format = 1, Logger = 2, Record = 3 };
+
+/**
+ * @brief Single-producer single-consumer byte ring holding one thread's records
+ */
+class ThreadBuffer {
+public:
+    explicit ThreadBuffer(std::size_t capacity)
+        : capacity_(std::bit_ceil(std::max<std::size_t>(capacity, 4096))),
+          mask_(capacity_ - 1),
+          data_(std::make_unique<std::byte[]>(capacity_)) {}
+
+    [[nodiscard]] std::size_t max_record_size() const noexcept {
+        return capacity_ / 2;
+    }
+
+    template<typename Idle>
+    std::byte* reserve(std::size_t size, Idle&& idle) {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        auto offset = pos & mask_;
+        const auto contiguous = capacity_ - offset;
+        const auto padding = contiguous < size ? contiguous : 0;
+        const auto needed = padding + size;
+
+        while (capacity_ - (pos - cached_head_) < needed) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (capacity_ - (pos - cached_head_) >= needed) {
+                break;
+            }
+            idle();
+        }
+
+        if (padding != 0) {
+            const auto marker = static_cast<std::uint32_t>(PaddingFlag | padding);
+            std::memcpy(data_.get() + offset, &marker, sizeof marker);
+            pos += padding;
+            offset = 0;
+        }
+        reserved_end_ = pos + size;
+        return data_.get() + offset;
+    }
+
+    void commit() noexcept {
+        tail_.store(reserved_end_, std::memory_order_release);
+    }
+
+    template<typename Handler>
+    bool drain(Handler&& handler) {
+        auto head = head_.load(std::memory_order_relaxed);
+        const auto tail = tail_.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+
+        while (head != tail) {
+            const std::byte* record = data_.get() + (head & mask_);
+            std::uint32_t size = 0;
+            std::memcpy(&size, record, sizeof size);
+            if ((size & PaddingFlag) == 0) {
+                RecordHeader header{};
+                std::memcpy(&header, record, sizeof header);
+                handler(header, record + sizeof header);
+            }
+            head += size & ~PaddingFlag;
+        }
+        head_.store(head, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] std::uint64_t head() const noexcept {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] std::uint64_t tail() const noexcept {
+        return tail_.load(std::memory_order_acquire);
+    }
+
+    std::atomic<bool> abandoned{false};
+
+private:
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    std::unique_ptr<std::byte[]> data_;
+
+    alignas(64) std::atomic<std::uint64_t> head_{0};
+    alignas(64) std::atomic<std::uint64_t> tail_{0};
+    std::uint64_t cached_head_ = 0; // Producer-local view of head_
+    std::uint64_t reserved_end_ = 0;
+};
+
+/**
+ * @brief Bounds-checked reader over an encoded payload
+ */
+class PayloadReader {
+public:
+    PayloadReader(const std::byte* data, std::size_t size) : data_(data), remaining_(size) {}
+
+    template<typename T>
+    T read() {
+        T value{};
+        require(sizeof value);
+        std::memcpy(&value, data_, sizeof value);
+        advance(sizeof value);
+        return value;
+    }
+
+    std::string_view read_string() {
+        const auto length = read<std::uint32_t>();
+        require(length);
+        const std::string_view text{reinterpret_cast<const char*>(data_), length};
+        advance(length);
+        return text;
+    }
+
+private:
+    void require(std::size_t size) const {
+        if (size > remaining_) {
+            throw Exception("Truncated binary log payload");
+        }
+    }
+
+    void advance(std::size_t size) noexcept {
+        data_ += size;
+        remaining_ -= size;
+    }
+
+    const std::byte* data_;
+    std::size_t remaining_;
+};
+
+void format_checked(std::string_view format, std::span<const ArgType> types,
+                    PayloadReader& reader, spdlog::memory_buf_t& out) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    store.reserve(types.size(), 0);
+
+    for (const auto type : types) {
+        switch (type) {
+            case ArgType::Bool: store.push_back(reader.read<bool>()); break;
+            case ArgType::Char: store.push_back(reader.read<char>()); break;
+            case ArgType::Int8: store.push_back(reader.read<std::int8_t>()); break;
+            case ArgType::Int16: store.push_back(reader.read<std::int16_t>()); break;
+            case ArgType::Int32: store.push_back(reader.read<std::int32_t>()); break;
+            case ArgType::Int64: store.push_back(reader.read<std::int64_t>()); break;
+            case ArgType::UInt8: store.push_back(reader.read<std::uint8_t>()); break;
+            case ArgType::UInt16: store.push_back(reader.read<std::uint16_t>()); break;
+            case ArgType::UInt32: store.push_back(reader.read<std::uint32_t>()); break;
+            case ArgType::UInt64: store.push_back(reader.read<std::uint64_t>()); break;
+            case ArgType::Float: store.push_back(reader.read<float>()); break;
+            case ArgType::Double: store.push_back(reader.read<double>()); break;
+            case ArgType::Pointer: store.push_back(reader.read<const void*>()); break;
+            case ArgType::String: store.push_back(reader.read_string()); break;
+            default: throw Exception("Unknown binary log argument type");
+        }
+    }
+
+    fmt::vformat_to(std::back_inserter(out), fmt::string_view{format.data(), format.size()},
+                    store);
+}
+
+spdlog::log_clock::time_point to_time_point(std::int64_t timestamp_ns) {
+    return spdlog::log_clock::time_point{std::chrono::duration_cast<spdlog::log_clock::duration>(
+        std::chrono::nanoseconds{timestamp_ns})};
+}
+
+template<typename T>
+void write_value(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+template<typename T>
+T read_value(std::istream& in) {
+    T value{};
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof value)) {
+        throw Exception("Truncated binary log file");
+    }
+    return value;
+}
+
+std::string read_bytes(std::istream& in, std::size_t size) {
+    std::string bytes(size, '\0');
+    if (!in.read(bytes.data(), static_cast<std::streamsize>(size))) {
+        throw Exception("Truncated binary log file");
+    }
+    return bytes;
+}
+
+/**
+ * @brief Process-wide owner of the thread buffers and the backend thread
+ */
+class Backend {
+public:
+    static Backend& instance() {
+        static Backend backend;
+        return backend;
+    }
+
+    ~Backend() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    Backend(const Backend&) = delete;
+    Backend& operator=(const Backend&) = delete;
+    Backend(Backend&&) = delete;
+    Backend& operator=(Backend&&) = delete;
+
+    void configure(const BinaryLogOptions& options) {
+        std::lock_guard lock(mutex_);
+        if (thread_.joinable()) {
+            throw Exception("BinaryLog::configure must be called before the first deferred record");
+        }
+        options_ = options;
+    }
+
+    ThreadBuffer& thread_buffer() {
+        thread_local Handle handle;
+        if (!handle.buffer) {
+            handle.buffer = attach();
+        }
+        return *handle.buffer;
+    }
+
+    std::uint32_t register_logger(std::weak_ptr<spdlog::logger> logger) {
+        std::lock_guard lock(loggers_mutex_);
+        std::uint32_t index = 0;
+        if (!free_logger_slots_.empty()) {
+            index = free_logger_slots_.back();
+            free_logger_slots_.pop_back();
+        } else {
+            if (loggers_.size() >= LoggerIndexMask) {
+                throw Exception("Too many loggers registered for deferred logging");
+            }
+            index = static_cast<std::uint32_t>(loggers_.size());
+            loggers_.emplace_back();
+        }
+        auto& slot = loggers_[index];
+        slot.logger = std::move(logger);
+        return (slot.generation << LoggerIndexBits) | index;
+    }
+
+    void unregister_logger(std::uint32_t id) {
+        std::lock_guard lock(loggers_mutex_);
+        const auto index = id & LoggerIndexMask;
+        if (index >= loggers_.size() || loggers_[index].generation != id >> LoggerIndexBits) {
+            return;
+        }
+        // Records still in flight for the old id resolve to nothing once the generation moves on
+        auto& slot = loggers_[index];
+        slot.logger.reset();
+        slot.generation = (slot.generation + 1) & LoggerGenerationMask;
+        free_logger_slots_.push_back(index);
+    }
+
+    void wake() {
+        {
+            std::lock_guard lock(mutex_);
+            wake_requested_ = true;
+        }
+        cv_.notify_one();
+    }
+
+    void flush() {
+        std::vector<std::pair<std::shared_ptr<ThreadBuffer>, std::uint64_t>> targets;
+        {
+            std::lock_guard lock(mutex_);
+            if (!thread_.joinable()) {
+                return;
+            }
+            targets.reserve(buffers_.size());
+            for (const auto& buffer : buffers_) {
+                targets.emplace_back(buffer, buffer->tail());
+            }
+        }
+
+        for (const auto& [buffer, tail] : targets) {
+            while (buffer->head() < tail) {
+                wake();
+                std::this_thread::yield();
+            }
+        }
+
+        std::lock_guard lock(file_mutex_);
+        if (file_.is_open()) {
+            file_.flush();
+        }
+    }
+
+    std::atomic<std::uint64_t> dropped{0};
+
+private:
+    /// Thread-local owner; marks the buffer for removal once its thread exits
+    struct Handle {
+        ~Handle() {
+            if (buffer) {
+                buffer->abandoned.store(true, std::memory_order_release);
+            }
+        }
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+
+    Backend() = default;
+
+    std::shared_ptr<ThreadBuffer> attach() {
+        std::lock_guard lock(mutex_);
+        auto buffer = std::make_shared<ThreadBuffer>(options_.thread_buffer_size);
+        buffers_.push_back(buffer);
+        buffers_changed_ = true;
+        if (!thread_.joinable()) {
+            if (!options_.output_path.empty()) {
+                file_.open(options_.output_path, std::ios::binary | std::ios::trunc);
+                if (!file_) {
+                    throw Exception("Cannot open binary log file: " + options_.output_path);
+                }
+                file_.write(FileMagic, sizeof FileMagic);
+            }
+            thread_ = std::thread([this] { run(); });
+        }
+        return buffer;
+    }
+
+    void run() {
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        auto handler = [this](const RecordHeader& header, const std::byte* payload) {
+            try {
+                process(header, payload);
+            } catch (const std::exception& ex) {
+                std::fprintf(stderr, "[cpptemplate] deferred log record error: %s\n", ex.what());
+            }
+        };
+
+        for (;;) {
+            bool stopping = false;
+            {
+                std::lock_guard lock(mutex_);
+                if (buffers_changed_) {
+                    buffers = buffers_;
+                    buffers_changed_ = false;
+                }
+                stopping = stopping_;
+            }
+
+            bool progressed = false;
+            for (const auto& buffer : buffers) {
+                progressed |= buffer->drain(handler);
+            }
+            if (progressed) {
+                continue;
+            }
+            if (stopping) {
+                break;
+            }
+
+            reap_abandoned();
+            std::unique_lock lock(mutex_);
+            cv_.wait_for(lock, std::chrono::milliseconds(1),
+                         [this] { return wake_requested_ || stopping_; });
+            wake_requested_ = false;
+        }
+
+        std::lock_guard lock(file_mutex_);
+        if (file_.is_open()) {
+            file_.flush();
+        }
+    }
+
+    void reap_abandoned() {
+        std::lock_guard lock(mutex_);
+        const auto before = buffers_.size();
+        std::erase_if(buffers_, [](const std::shared_ptr<ThreadBuffer>& buffer) {
+            return buffer->abandoned.load(std::memory_order_acquire) &&
+                   buffer->head() == buffer->tail();
+        });
+        buffers_changed_ |= buffers_.size() != before;
+    }
+
+    std::shared_ptr<spdlog::logger> resolve_logger(std::uint32_t id) {
+        std::lock_guard lock(loggers_mutex_);
+        const auto index = id & LoggerIndexMask;
+        if (index >= loggers_.size() || loggers_[index].generation != id >> LoggerIndexBits) {
+            return nullptr;
+        }
+        return loggers_[index].logger.lock();
+    }
+
+    void process(const RecordHeader& header, const std::byte* payload) {
+        const std::string_view format{header.format, header.format_size};
+        const std::span<const ArgType> types{header.arg_types, header.arg_count};
+        const auto payload_size = header.size - sizeof(RecordHeader);
+        const auto level = static_cast<spdlog::level::level_enum>(header.level);
+
+        if (file_.is_open()) {
+            write_to_file(header, format, types, payload, payload_size);
+            return;
+        }
+
+        auto logger = resolve_logger(header.logger_id);
+        if (!logger) {
+            return;
+        }
+        text_.clear();
+        PayloadReader reader{payload, payload_size};
+        format_checked(format, types, reader, text_);
+        logger->log(to_time_point(header.timestamp_ns), spdlog::source_loc{}, level,
+                    spdlog::string_view_t{text_.data(), text_.size()});
+    }
+
+    void write_to_file(const RecordHeader& header, std::string_view format,
+                       std::span<const ArgType> types, const std::byte* payload,
+                       std::size_t payload_size) {
+        std::lock_guard lock(file_mutex_);
+
+        const auto site = std::make_pair(header.format, header.arg_types);
+        auto format_it = format_ids_.find(site);
+        if (format_it == format_ids_.end()) {
+            const auto id = static_cast<std::uint32_t>(format_ids_.size());
+            format_it = format_ids_.emplace(site, id).first;
+            write_value(file_, EntryKind::Format);
+            write_value(file_, id);
+            write_value(file_, static_cast<std::uint32_t>(format.size()));
+            file_.write(format.data(), static_cast<std::streamsize>(format.size()));
+            write_value(file_, header.arg_count);
+            file_.write(reinterpret_cast<const char*>(types.data()),
+                        static_cast<std::streamsize>(types.size()));
+        }
+
+        if (!logger_names_written_.contains(header.logger_id)) {
+            auto logger = resolve_logger(header.logger_id);
+            const std::string name = logger ? logger->name() : std::string{};
+            write_value(file_, EntryKind::Logger);
+            write_value(file_, header.logger_id);
+            write_value(file_, static_cast<std::uint32_t>(name.size()));
+            file_.write(name.data(), static_cast<std::streamsize>(name.size()));
+            logger_names_written_.emplace(header.logger_id, true);
+        }
+
+        write_value(file_, EntryKind::Record);
+        write_value(file_, format_it->second);
+        write_value(file_, header.logger_id);
+        write_value(file_, header.level);
+        write_value(file_, header.timestamp_ns);
+        write_value(file_, static_cast<std::uint32_t>(payload_size));
+        file_.write(reinterpret_cast<const char*>(payload),
+                    static_cast<std::streamsize>(payload_size));
+    }
+
+    BinaryLogOptions options_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+    bool buffers_changed_ = false;
+    bool wake_requested_ = false;
+    bool stopping_ = false;
+    std::thread thread_;
+
+    // Logger ids are a slot index tagged with the slot's generation, so slots
+    // freed by short-lived loggers can be reused without misattributing records
+    static constexpr std::uint32_t LoggerIndexBits = 20;
+    static constexpr std::uint32_t LoggerIndexMask = (1u << LoggerIndexBits) - 1;
+    static constexpr std::uint32_t LoggerGenerationMask = (1u << (32 - LoggerIndexBits)) - 1;
+
+    struct LoggerSlot {
+        std::weak_ptr<spdlog::logger> logger;
+        std::uint32_t generation = 0;
+    };
+
+    std::mutex loggers_mutex_;
+    std::vector<LoggerSlot> loggers_;
+    std::vector<std::uint32_t> free_logger_slots_;
+
+    // Backend-thread state
+    spdlog::memory_buf_t text_;
+    std::mutex file_mutex_;
+    std::ofstream file_;
+    std::map<std::pair<const char*, const ArgType*>, std::uint32_t> format_ids_;
+    std::unordered_map<std::uint32_t, bool> logger_names_written_;
+};
+
+} // namespace
+
+std::byte* reserve_record(std::size_t size) {
+    auto& backend = Backend::instance();
+    auto& buffer = backend.thread_buffer();
+    if (size > buffer.max_record_size()) {
+        backend.dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return buffer.reserve(size, [&backend] {
+        backend.wake();
+        std::this_thread::yield();
+    });
+}
+
+void commit_record() noexcept {
+    Backend::instance().thread_buffer().commit();
+}
+
+std::uint32_t register_binary_logger(std::weak_ptr<spdlog::logger> logger) {
+    return Backend::instance().register_logger(std::move(logger));
+}
+
+void unregister_binary_logger(std::uint32_t id) noexcept {
+    Backend::instance().unregister_logger(id);
+}
+
+void format_payload(std::string_view format, std::span<const ArgType> types,
+                    const std::byte* payload, spdlog::memory_buf_t& out) {
+    PayloadReader reader{payload, std::numeric_limits<std::size_t>::max()};
+    format_checked(format, types, reader, out);
+}
+
+} // namespace detail
+
+void BinaryLog::configure(const BinaryLogOptions& options) {
+    detail::Backend::instance().configure(options);
+}
+
+void BinaryLog::flush() {
+    detail::Backend::instance().flush();
+}
+
+std::uint64_t BinaryLog::dropped() noexcept {
+    return detail::Backend::instance().dropped.load(std::memory_order_relaxed);
+}
+
+std::size_t BinaryLog::decode(std::istream& input, std::ostream& output) {
+    using detail::ArgType;
+    using detail::EntryKind;
+
+    char magic[sizeof detail::FileMagic] = {};
+    if (!input.read(magic, sizeof magic) ||
+        !std::equal(std::begin(magic), std::end(magic), std::begin(detail::FileMagic))) {
+        throw Exception("Not a binary log file");
+    }
+
+    struct FormatEntry {
+        std::string format;
+        std::vector<ArgType> types;
+    };
+    std::unordered_map<std::uint32_t, FormatEntry> formats;
+    std::unordered_map<std::uint32_t, std::string> loggers;
+    spdlog::memory_buf_t text;
+    std::size_t records = 0;
+
+    for (;;) {
+        const auto kind_byte = input.get();
+        if (kind_byte == std::char_traits<char>::eof()) {
+            break;
+        }
+
+        switch (static_cast<EntryKind>(kind_byte)) {
+            case EntryKind::Format: {
+                const auto id = detail::read_value<std::uint32_t>(input);
+                const auto size = detail::read_value<std::uint32_t>(input);
+                FormatEntry entry{detail::read_bytes(input, size), {}};
+                const auto arg_count = detail::read_value<std::uint8_t>(input);
+                const auto types = detail::read_bytes(input, arg_count);
+                for (const char type : types) {
+                    entry.types.push_back(static_cast<ArgType>(type));
+                }
+                formats[id] = std::move(entry);
+                break;
+            }
+            case EntryKind::Logger: {
+                const auto id = detail::read_value<std::uint32_t>(input);
+                const auto size = detail::read_value<std::uint32_t>(input);
+                loggers[id] = detail::read_bytes(input, size);
+                break;
+            }
+            case EntryKind::Record: {
+                const auto format_id = detail::read_value<std::uint32_t>(input);
+                const auto logger_id = detail::read_value<std::uint32_t>(input);
+                const auto level = detail::read_value<std::uint8_t>(input);
+                const auto timestamp_ns = detail::read_value<std::int64_t>(input);
+                const auto size = detail::read_value<std::uint32_t>(input);
+                const auto payload = detail::read_bytes(input, size);
+
+                const auto format_it = formats.find(format_id);
+                if (format_it == formats.end() || level >= spdlog::level::n_levels) {
+                    throw Exception("Corrupt binary log record");
+                }
+
+                text.clear();
+                detail::PayloadReader reader{reinterpret_cast<const std::byte*>(payload.data()),
+                                             payload.size()};
+                detail::format_checked(format_it->second.format, format_it->second.types, reader,
+                                       text);
+
+                const auto time = detail::to_time_point(timestamp_ns);
+                const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        time.time_since_epoch()) % 1000;
+                const auto level_name =
+                    spdlog::level::to_string_view(static_cast<spdlog::level::level_enum>(level));
+                output << fmt::format("[{:%Y-%m-%d %H:%M:%S}.{:03}] [{}] [{}] {}\n",
+                                      fmt::localtime(spdlog::log_clock::to_time_t(time)),
+                                      millis.count(), loggers[logger_id],
+                                      std::string_view{level_name.data(), level_name.size()},
+                                      std::string_view{text.data(), text.size()});
+                ++records;
+                break;
+            }
+            default:
+                throw Exception("Unknown binary log entry");
+        }
+    }
+
+    return records;
+}
+
+} // namespace cpptemplate::core
@@ -1,8 +1,545 @@
 #include "cpptemplate/core/config.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <system_error>
+
+#if defined(__linux__)
+    #include <poll.h>
+    #include <sys/eventfd.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+#include "cpptemplate/core/exception.hpp"
+
 namespace cpptemplate::core {
 
-// Stub implementation for config
-// Add actual configuration functionality as needed
+namespace detail {
+
+/// One key's value in every representation it parsed as
+struct ConfigEntry {
+    enum Kind : std::uint8_t {
+        Present = 1 << 0,
+        Bool = 1 << 1,
+        Int = 1 << 2,
+        Double = 1 << 3
+    };
+
+    std::int64_t integer = 0;
+    double number = 0.0;
+    std::uint32_t text_offset = 0;
+    std::uint32_t text_size = 0;
+    std::uint8_t kinds = 0;
+    bool boolean = false;
+};
+
+/// Immutable parsed configuration, indexed by interned key id
+struct ConfigSnapshot {
+    std::vector<ConfigEntry> entries;
+    std::string text; ///< String values back to back
+    std::size_t present = 0;
+
+    [[nodiscard]] const ConfigEntry* entry(std::uint32_t id) const noexcept {
+        if (id >= entries.size() || (entries[id].kinds & ConfigEntry::Present) == 0) {
+            return nullptr;
+        }
+        return &entries[id];
+    }
+};
+
+} // namespace detail
+
+namespace {
+
+using detail::ConfigEntry;
+using detail::ConfigSnapshot;
+
+/**
+ * Hazard pointers shared by every Config. A reader publishes the snapshot it
+ * is about to use in its thread's slot; publish() frees a retired snapshot
+ * only when no slot holds it. Slots are never freed, only recycled when their
+ * thread exits, so the list can be walked without locking.
+ */
+struct ReaderSlot {
+    std::atomic<const ConfigSnapshot*> hazard{nullptr};
+    std::atomic<bool> active{true};
+    ReaderSlot* next = nullptr;
+};
+
+std::atomic<ReaderSlot*> reader_slots{nullptr};
+
+ReaderSlot* acquire_reader_slot() {
+    for (auto* slot = reader_slots.load(std::memory_order_acquire); slot; slot = slot->next) {
+        bool expected = false;
+        if (!slot->active.load(std::memory_order_relaxed) &&
+            slot->active.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return slot;
+        }
+    }
+    auto* slot = new ReaderSlot;
+    slot->next = reader_slots.load(std::memory_order_relaxed);
+    while (!reader_slots.compare_exchange_weak(slot->next, slot, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+    }
+    return slot;
+}
+
+ReaderSlot& local_reader_slot() {
+    struct Owner {
+        ReaderSlot* slot = acquire_reader_slot();
+        ~Owner() {
+            slot->hazard.store(nullptr, std::memory_order_release);
+            slot->active.store(false, std::memory_order_release);
+        }
+    };
+    thread_local Owner owner;
+    return *owner.slot;
+}
+
+/// Protects the current snapshot for the lifetime of the guard
+class SnapshotGuard {
+public:
+    explicit SnapshotGuard(const std::atomic<const ConfigSnapshot*>& current)
+        : slot_(local_reader_slot()) {
+        auto* snapshot = current.load(std::memory_order_acquire);
+        for (;;) {
+            // seq_cst pairs with publish(): either it sees our hazard or we see its new pointer
+            slot_.hazard.store(snapshot);
+            auto* confirmed = current.load();
+            if (confirmed == snapshot) {
+                break;
+            }
+            snapshot = confirmed;
+        }
+        snapshot_ = snapshot;
+    }
+
+    ~SnapshotGuard() {
+        slot_.hazard.store(nullptr, std::memory_order_release);
+    }
+
+    SnapshotGuard(const SnapshotGuard&) = delete;
+    SnapshotGuard& operator=(const SnapshotGuard&) = delete;
+
+    const ConfigSnapshot* operator->() const noexcept {
+        return snapshot_;
+    }
+
+private:
+    ReaderSlot& slot_;
+    const ConfigSnapshot* snapshot_;
+};
+
+[[noreturn]] void throw_parse_error(std::size_t line, const std::string& message) {
+    throw Exception("Config parse error at line " + std::to_string(line) + ": " + message);
+}
+
+std::string_view trim(std::string_view text) {
+    const auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+    while (!text.empty() && is_space(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && is_space(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool valid_key(std::string_view key) {
+    if (key.empty() || key.front() == '.' || key.back() == '.') {
+        return false;
+    }
+    return std::all_of(key.begin(), key.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_' || c == '-' ||
+               c == '.';
+    });
+}
+
+/// Strips comments and quotes; returns the value as it should be stored
+std::string parse_value(std::string_view raw, std::size_t line) {
+    raw = trim(raw);
+    if (raw.empty() || raw.front() != '"') {
+        // Unquoted: a '#' or ';' that starts a word begins a comment
+        for (std::size_t i = 0; i < raw.size(); ++i) {
+            if ((raw[i] == '#' || raw[i] == ';') &&
+                (i == 0 || std::isspace(static_cast<unsigned char>(raw[i - 1])) != 0)) {
+                raw = trim(raw.substr(0, i));
+                break;
+            }
+        }
+        return std::string{raw};
+    }
+
+    std::string value;
+    std::size_t i = 1;
+    for (; i < raw.size() && raw[i] != '"'; ++i) {
+        if (raw[i] != '\\') {
+            value.push_back(raw[i]);
+            continue;
+        }
+        if (++i == raw.size()) {
+            break;
+        }
+        switch (raw[i]) {
+            case 'n': value.push_back('\n'); break;
+            case 't': value.push_back('\t'); break;
+            case '"': value.push_back('"'); break;
+            case '\\': value.push_back('\\'); break;
+            default: throw_parse_error(line, "unknown escape '\\" + std::string(1, raw[i]) + "'");
+        }
+    }
+    if (i >= raw.size()) {
+        throw_parse_error(line, "unterminated string");
+    }
+    const auto rest = trim(raw.substr(i + 1));
+    if (!rest.empty() && rest.front() != '#' && rest.front() != ';') {
+        throw_parse_error(line, "unexpected text after string");
+    }
+    return value;
+}
+
+void convert(ConfigEntry& entry, std::string_view text) {
+    entry.kinds = ConfigEntry::Present;
+
+    const auto* first = text.data();
+    const auto* last = text.data() + text.size();
+    const auto* start = first != last && *first == '+' ? first + 1 : first;
+
+    if (auto [ptr, ec] = std::from_chars(start, last, entry.integer); ec == std::errc{} &&
+                                                                       ptr == last) {
+        entry.kinds |= ConfigEntry::Int;
+    }
+    if (auto [ptr, ec] = std::from_chars(start, last, entry.number); ec == std::errc{} &&
+                                                                      ptr == last) {
+        entry.kinds |= ConfigEntry::Double;
+    }
+
+    std::string lower{text};
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "true" || lower == "yes" || lower == "on" || lower == "1") {
+        entry.kinds |= ConfigEntry::Bool;
+        entry.boolean = true;
+    } else if (lower == "false" || lower == "no" || lower == "off" || lower == "0") {
+        entry.kinds |= ConfigEntry::Bool;
+        entry.boolean = false;
+    }
+}
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw Exception("Failed to open config file '" + path.string() + "'");
+    }
+    std::ostringstream content;
+    content << input.rdbuf();
+    return content.str();
+}
+
+} // namespace
+
+Config::Config() : current_(new ConfigSnapshot) {
+}
+
+Config::~Config() {
+    stop_watching();
+    // No reader may outlive the Config, so nothing can still hold these
+    delete current_.load(std::memory_order_acquire);
+    for (const auto* snapshot : retired_) {
+        delete snapshot;
+    }
+}
+
+void Config::load_file(const std::filesystem::path& path) {
+    load_string(read_file(path));
+    std::lock_guard lock(publish_mutex_);
+    path_ = path;
+}
+
+void Config::load_string(std::string_view text) {
+    struct Pending {
+        std::uint32_t id;
+        std::string value;
+    };
+    std::vector<Pending> pending;
+    std::unordered_map<std::string, std::size_t, detail::StringHash, std::equal_to<>> seen;
+
+    std::string section;
+    std::size_t line_number = 0;
+    while (!text.empty()) {
+        ++line_number;
+        const auto end = text.find('\n');
+        auto line = trim(text.substr(0, end));
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+        if (line.empty() || line.front() == '#' || line.front() == ';') {
+            continue;
+        }
+
+        if (line.front() == '[') {
+            if (line.back() != ']') {
+                throw_parse_error(line_number, "unterminated section header");
+            }
+            section = std::string{trim(line.substr(1, line.size() - 2))};
+            if (!section.empty() && !valid_key(section)) {
+                throw_parse_error(line_number, "invalid section name '" + section + "'");
+            }
+            continue;
+        }
+
+        const auto equals = line.find('=');
+        if (equals == std::string_view::npos) {
+            throw_parse_error(line_number, "expected 'key = value'");
+        }
+        const auto name = trim(line.substr(0, equals));
+        if (!valid_key(name)) {
+            throw_parse_error(line_number, "invalid key '" + std::string{name} + "'");
+        }
+
+        auto key = section.empty() ? std::string{name} : section + "." + std::string{name};
+        if (!seen.emplace(key, line_number).second) {
+            throw_parse_error(line_number, "duplicate key '" + key + "'");
+        }
+        pending.push_back({intern(key), parse_value(line.substr(equals + 1), line_number)});
+    }
+
+    // Ids are stable across loads, so size the table for every key interned so far
+    auto snapshot = std::make_unique<ConfigSnapshot>();
+    {
+        std::lock_guard lock(keys_mutex_);
+        snapshot->entries.resize(key_ids_.size());
+    }
+    for (const auto& [id, value] : pending) {
+        auto& entry = snapshot->entries[id];
+        convert(entry, value);
+        entry.text_offset = static_cast<std::uint32_t>(snapshot->text.size());
+        entry.text_size = static_cast<std::uint32_t>(value.size());
+        snapshot->text += value;
+    }
+    snapshot->present = pending.size();
+
+    publish(snapshot.release());
+}
+
+void Config::reload() {
+    std::filesystem::path path;
+    {
+        std::lock_guard lock(publish_mutex_);
+        path = path_;
+    }
+    if (path.empty()) {
+        throw Exception("Config::reload requires a file loaded with load_file");
+    }
+    load_string(read_file(path));
+}
+
+void Config::watch() {
+#if defined(__linux__)
+    std::filesystem::path path;
+    {
+        std::lock_guard lock(publish_mutex_);
+        path = path_;
+    }
+    if (path.empty()) {
+        throw Exception("Config::watch requires a file loaded with load_file");
+    }
+    if (watcher_.joinable()) {
+        return;
+    }
+
+    const int inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        throw Exception("inotify_init1 failed: " + std::generic_category().message(errno));
+    }
+    auto directory = path.parent_path();
+    if (directory.empty()) {
+        directory = ".";
+    }
+    if (::inotify_add_watch(inotify_fd, directory.c_str(),
+                            IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        const auto message = std::generic_category().message(errno);
+        ::close(inotify_fd);
+        throw Exception("Failed to watch '" + directory.string() + "': " + message);
+    }
+    stop_fd_ = ::eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0) {
+        ::close(inotify_fd);
+        throw Exception("eventfd failed: " + std::generic_category().message(errno));
+    }
+    watcher_ = std::thread([this, inotify_fd] { watch_loop(inotify_fd, stop_fd_); });
+#else
+    throw Exception("Config::watch is only supported on Linux");
+#endif
+}
+
+void Config::stop_watching() {
+#if defined(__linux__)
+    if (!watcher_.joinable()) {
+        return;
+    }
+    const std::uint64_t one = 1;
+    if (::write(stop_fd_, &one, sizeof one) < 0) {
+        // The watcher also polls with a timeout, so it still notices the join
+    }
+    watcher_.join();
+    ::close(stop_fd_);
+    stop_fd_ = -1;
+#endif
+}
+
+void Config::watch_loop([[maybe_unused]] int inotify_fd, [[maybe_unused]] int stop_fd) {
+#if defined(__linux__)
+    const auto file_name = [this] {
+        std::lock_guard lock(publish_mutex_);
+        return path_.filename().string();
+    }();
+
+    alignas(inotify_event) char buffer[4096];
+    pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+    for (;;) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if ((fds[1].revents & POLLIN) != 0) {
+            break;
+        }
+
+        bool changed = false;
+        for (;;) {
+            const auto length = ::read(inotify_fd, buffer, sizeof buffer);
+            if (length <= 0) {
+                break;
+            }
+            for (auto* cursor = buffer; cursor < buffer + length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+                if (event->len > 0 && file_name == event->name) {
+                    changed = true;
+                }
+                cursor += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (!changed) {
+            continue;
+        }
+
+        try {
+            reload();
+            std::lock_guard lock(error_mutex_);
+            last_error_.clear();
+        } catch (const std::exception& ex) {
+            std::lock_guard lock(error_mutex_);
+            last_error_ = ex.what();
+        }
+    }
+    ::close(inotify_fd);
+#endif
+}
+
+bool Config::contains(std::string_view key) const {
+    const auto id = find(key);
+    if (!id) {
+        return false;
+    }
+    SnapshotGuard snapshot(current_);
+    return snapshot->entry(*id) != nullptr;
+}
+
+std::size_t Config::size() const {
+    SnapshotGuard snapshot(current_);
+    return snapshot->present;
+}
+
+std::string Config::last_error() const {
+    std::lock_guard lock(error_mutex_);
+    return last_error_;
+}
+
+std::uint32_t Config::intern(std::string_view key) {
+    std::lock_guard lock(keys_mutex_);
+    if (const auto it = key_ids_.find(key); it != key_ids_.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<std::uint32_t>(key_ids_.size());
+    key_ids_.emplace(std::string{key}, id);
+    return id;
+}
+
+std::optional<std::uint32_t> Config::find(std::string_view key) const {
+    std::lock_guard lock(keys_mutex_);
+    if (const auto it = key_ids_.find(key); it != key_ids_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+bool Config::read(std::uint32_t id, bool& out) const {
+    SnapshotGuard snapshot(current_);
+    const auto* entry = snapshot->entry(id);
+    if (entry == nullptr || (entry->kinds & ConfigEntry::Bool) == 0) {
+        return false;
+    }
+    out = entry->boolean;
+    return true;
+}
+
+bool Config::read(std::uint32_t id, std::int64_t& out) const {
+    SnapshotGuard snapshot(current_);
+    const auto* entry = snapshot->entry(id);
+    if (entry == nullptr || (entry->kinds & ConfigEntry::Int) == 0) {
+        return false;
+    }
+    out = entry->integer;
+    return true;
+}
+
+bool Config::read(std::uint32_t id, double& out) const {
+    SnapshotGuard snapshot(current_);
+    const auto* entry = snapshot->entry(id);
+    if (entry == nullptr || (entry->kinds & ConfigEntry::Double) == 0) {
+        return false;
+    }
+    out = entry->number;
+    return true;
+}
+
+bool Config::read(std::uint32_t id, std::string& out) const {
+    SnapshotGuard snapshot(current_);
+    const auto* entry = snapshot->entry(id);
+    if (entry == nullptr) {
+        return false;
+    }
+    out.assign(snapshot->text, entry->text_offset, entry->text_size);
+    return true;
+}
+
+void Config::publish(ConfigSnapshot* snapshot) {
+    std::lock_guard lock(publish_mutex_);
+    retired_.push_back(current_.exchange(snapshot));
+    version_.fetch_add(1, std::memory_order_release);
+
+    // Free every retired snapshot no reader has published as its hazard
+    std::vector<const ConfigSnapshot*> in_use;
+    for (auto* slot = reader_slots.load(std::memory_order_acquire); slot; slot = slot->next) {
+        if (const auto* hazard = slot->hazard.load()) {
+            in_use.push_back(hazard);
+        }
+    }
+    std::erase_if(retired_, [&in_use](const ConfigSnapshot* retired) {
+        if (std::find(in_use.begin(), in_use.end(), retired) != in_use.end()) {
+            return false;
+        }
+        delete retired;
+        return true;
+    });
+}
 
-} // namespace cpptemplate::core
\ No newline at end of file
+} // namespace cpptemplate::core
@@ -0,0 +1,52 @@
+#include "cpptemplate/core/cpu_features.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+namespace cpptemplate::core {
+
+namespace {
+
+CpuFeatures detect() noexcept {
+    CpuFeatures features;
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    // libgcc/compiler-rt also check XCR0, so OS support is included
+    __builtin_cpu_init();
+    features.sse42 = __builtin_cpu_supports("sse4.2") != 0;
+    features.avx2 = __builtin_cpu_supports("avx2") != 0;
+    features.fma = __builtin_cpu_supports("fma") != 0;
+    features.avx512f = __builtin_cpu_supports("avx512f") != 0;
+    features.avx512bw = __builtin_cpu_supports("avx512bw") != 0;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4] = {};
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    features.sse42 = (info[2] & (1 << 20)) != 0;
+    features.fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool avx_state = (xcr0 & 0x6) == 0x6;
+    const bool avx512_state = (xcr0 & 0xE6) == 0xE6;
+    features.fma = features.fma && avx_state;
+    if (max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        features.avx2 = avx_state && (info[1] & (1 << 5)) != 0;
+        features.avx512f = avx512_state && (info[1] & (1 << 16)) != 0;
+        features.avx512bw = avx512_state && (info[1] & (1 << 30)) != 0;
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+    features.neon = true;
+#endif
+    return features;
+}
+
+} // namespace
+
+const CpuFeatures& cpu_features() noexcept {
+    static const CpuFeatures features = detect();
+    return features;
+}
+
+} // namespace cpptemplate::core
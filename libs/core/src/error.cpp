@@ -0,0 +1,46 @@
+#include "cpptemplate/core/error.hpp"
+
+#include <string>
+
+#include "cpptemplate/core/exception.hpp"
+
+namespace cpptemplate::core {
+
+namespace {
+
+class CoreCategory final : public ErrorCategory {
+public:
+    std::string_view name() const noexcept override {
+        return "core";
+    }
+
+    std::string_view message(int code) const noexcept override {
+        switch (static_cast<Errc>(code)) {
+            case Errc::InvalidArgument: return "Invalid argument";
+            case Errc::DivisionByZero: return "Division by zero is not allowed";
+            case Errc::DomainError: return "Argument outside the domain of the operation";
+            case Errc::OutOfRange: return "Value out of range";
+            case Errc::Overflow: return "Arithmetic overflow";
+            case Errc::ParseError: return "Parse error";
+            case Errc::NotFound: return "Not found";
+        }
+        return "Unknown error";
+    }
+};
+
+} // namespace
+
+const ErrorCategory& core_category() noexcept {
+    static const CoreCategory category;
+    return category;
+}
+
+namespace detail {
+
+void throw_error(const Error& error) {
+    throw Exception(std::string{error.message()});
+}
+
+} // namespace detail
+
+} // namespace cpptemplate::core
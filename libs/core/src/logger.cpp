@@ -1,38 +1,67 @@
 #include "cpptemplate/core/logger.hpp"
 
-#include <spdlog/sinks/stdout_color_sinks.h>
-#include <spdlog/sinks/rotating_file_sink.h>
+#include "cpptemplate/core/logger_registry.hpp"
+
+#include "async_sink.hpp"
 
 namespace cpptemplate::core {
 
 std::shared_ptr<Logger> Logger::create(std::string_view name) {
-    // Create console sink with colors
-    auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-    console_sink->set_level(spdlog::level::info);
-    console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v");
+    return create(name, LoggerOptions{});
+}
+
+std::shared_ptr<Logger> Logger::create(std::string_view name, const LoggerOptions& options) {
+    return LoggerRegistry::instance().get(name, options);
+}
+
+Logger::Logger(std::shared_ptr<spdlog::logger> logger,
+               std::shared_ptr<detail::AsyncSink> async_sink)
+    : logger_(std::move(logger)), async_sink_(std::move(async_sink)) {
+}
+
+Logger::~Logger() {
+    const auto id = binary_id_.load(std::memory_order_acquire);
+    if (id != detail::NoBinaryLoggerId) {
+        detail::unregister_binary_logger(id);
+    }
+}
 
-    // Create rotating file sink
-    auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-        "logs/app.log", 1024 * 1024 * 5, 3); // 5MB files, keep 3 files
-    file_sink->set_level(spdlog::level::trace);
-    file_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%s:%#] %v");
+Logger::Logger(Logger&& other) noexcept
+    : logger_(std::move(other.logger_)),
+      async_sink_(std::move(other.async_sink_)),
+      binary_id_(other.binary_id_.exchange(detail::NoBinaryLoggerId)) {
+}
 
-    // Create logger with both sinks
-    std::vector<spdlog::sink_ptr> sinks{console_sink, file_sink};
-    auto spdlog_logger = std::make_shared<spdlog::logger>(
-        std::string{name}, sinks.begin(), sinks.end());
-    
-    spdlog_logger->set_level(spdlog::level::trace);
-    spdlog_logger->flush_on(spdlog::level::error);
+Logger& Logger::operator=(Logger&& other) noexcept {
+    if (this != &other) {
+        const auto id = binary_id_.exchange(other.binary_id_.exchange(detail::NoBinaryLoggerId));
+        if (id != detail::NoBinaryLoggerId) {
+            detail::unregister_binary_logger(id);
+        }
+        logger_ = std::move(other.logger_);
+        async_sink_ = std::move(other.async_sink_);
+    }
+    return *this;
+}
 
-    // Register the logger
-    spdlog::register_logger(spdlog_logger);
+std::shared_ptr<Logger> Logger::child(std::string_view component) const {
+    std::string child_name;
+    child_name.reserve(logger_->name().size() + 1 + component.size());
+    child_name.append(logger_->name()).append(1, '.').append(component);
 
-    return std::shared_ptr<Logger>(new Logger(spdlog_logger));
+    // clone() copies the sink pointers, level and flush level; no sinks are created
+    return std::shared_ptr<Logger>(new Logger(logger_->clone(std::move(child_name)), async_sink_));
 }
 
-Logger::Logger(std::shared_ptr<spdlog::logger> logger) 
-    : logger_(std::move(logger)) {
+std::uint32_t Logger::register_binary_id() {
+    auto expected = detail::NoBinaryLoggerId;
+    const auto id = detail::register_binary_logger(logger_);
+    if (!binary_id_.compare_exchange_strong(expected, id, std::memory_order_acq_rel)) {
+        // Another thread registered first; use its id
+        detail::unregister_binary_logger(id);
+        return expected;
+    }
+    return id;
 }
 
 void Logger::set_level(spdlog::level::level_enum level) {
@@ -43,4 +72,13 @@ std::string Logger::name() const {
     return logger_->name();
 }
 
-} // namespace cpptemplate::core
\ No newline at end of file
+void Logger::flush() {
+    BinaryLog::flush();
+    logger_->flush();
+}
+
+std::uint64_t Logger::dropped_messages() const noexcept {
+    return async_sink_ ? async_sink_->dropped() : 0;
+}
+
+} // namespace cpptemplate::core
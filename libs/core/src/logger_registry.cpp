@@ -0,0 +1,175 @@
+#include "cpptemplate/core/logger_registry.hpp"
+
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include "cpptemplate/core/exception.hpp"
+#include "cpptemplate/core/mapped_file_sink.hpp"
+
+#include "async_sink.hpp"
+
+namespace cpptemplate::core {
+
+namespace {
+
+std::mutex options_mutex;
+LoggerRegistryOptions pending_options;
+bool registry_created = false;
+
+} // namespace
+
+LoggerRegistry& LoggerRegistry::instance() {
+    static LoggerRegistry registry;
+    return registry;
+}
+
+void LoggerRegistry::configure(const LoggerRegistryOptions& options) {
+    std::lock_guard lock(options_mutex);
+    if (registry_created) {
+        throw Exception("LoggerRegistry::configure must be called before the first logger is created");
+    }
+    pending_options = options;
+}
+
+LoggerRegistry::LoggerRegistry() : loggers_(std::make_shared<const LoggerMap>()) {
+    LoggerRegistryOptions options;
+    {
+        std::lock_guard lock(options_mutex);
+        registry_created = true;
+        options = pending_options;
+    }
+
+    // Construct the deferred-logging backend first so it outlives the loggers held here
+    static_cast<void>(BinaryLog::dropped());
+
+    // Create console sink with colors
+    auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    console_sink->set_level(spdlog::level::info);
+    console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v");
+
+    // Create the file sink; both kinds rotate at the same size and keep the same number of files
+    spdlog::sink_ptr file_sink;
+    if (options.file_sink == FileSinkType::Mapped) {
+        file_sink = std::make_shared<MappedFileSink>(MappedFileSinkOptions{
+            options.file_path, options.max_file_size, options.max_files});
+    } else {
+        file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+            options.file_path, options.max_file_size, options.max_files);
+    }
+    file_sink->set_level(spdlog::level::trace);
+    file_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%s:%#] %v");
+
+    sinks_ = {std::move(console_sink), std::move(file_sink)};
+}
+
+LoggerRegistry::~LoggerRegistry() {
+    // Deliver pending deferred records while their loggers still exist
+    BinaryLog::flush();
+}
+
+std::shared_ptr<Logger> LoggerRegistry::get(std::string_view name, const LoggerOptions& options) {
+    if (auto logger = find(name)) {
+        check_options(name, *logger, options);
+        return logger;
+    }
+
+    std::lock_guard lock(mutex_);
+    // Another thread may have created it between the lookup and the lock
+    if (const auto it = loggers_->find(name); it != loggers_->end()) {
+        check_options(name, *it->second, options);
+        return it->second;
+    }
+
+    std::shared_ptr<detail::AsyncSink> async_sink;
+    const auto sinks = sinks_for(options, async_sink);
+
+    auto spdlog_logger = std::make_shared<spdlog::logger>(
+        std::string{name}, sinks.begin(), sinks.end());
+    spdlog_logger->set_level(options.level);
+    if (async_sink) {
+        // Producers only queue the error record; the writer flushes once it has written it
+        async_sink->flush_on(spdlog::level::err);
+    } else {
+        spdlog_logger->flush_on(spdlog::level::err);
+    }
+
+    // Keep spdlog::get() working for code that looks loggers up through spdlog
+    spdlog::register_logger(spdlog_logger);
+
+    auto logger = std::shared_ptr<Logger>(new Logger(spdlog_logger, std::move(async_sink)));
+    auto loggers = std::make_shared<LoggerMap>(*loggers_);
+    loggers->emplace(std::string{name}, logger);
+    publish(std::move(loggers));
+    return logger;
+}
+
+std::shared_ptr<Logger> LoggerRegistry::find(std::string_view name) const {
+    struct Cache {
+        const LoggerRegistry* owner = nullptr;
+        std::uint64_t version = 0;
+        std::shared_ptr<const LoggerMap> loggers;
+    };
+    thread_local Cache cache;
+
+    const auto version = version_.load(std::memory_order_acquire);
+    if (cache.owner != this || cache.version != version) {
+        std::lock_guard lock(mutex_);
+        cache.owner = this;
+        cache.version = version_.load(std::memory_order_relaxed);
+        cache.loggers = loggers_;
+    }
+
+    const auto it = cache.loggers->find(name);
+    return it != cache.loggers->end() ? it->second : nullptr;
+}
+
+bool LoggerRegistry::drop(std::string_view name) {
+    std::lock_guard lock(mutex_);
+    const auto it = loggers_->find(name);
+    if (it == loggers_->end()) {
+        return false;
+    }
+
+    spdlog::drop(it->first);
+    auto loggers = std::make_shared<LoggerMap>(*loggers_);
+    loggers->erase(it->first);
+    publish(std::move(loggers));
+    return true;
+}
+
+std::size_t LoggerRegistry::size() const {
+    std::lock_guard lock(mutex_);
+    return loggers_->size();
+}
+
+std::vector<spdlog::sink_ptr> LoggerRegistry::sinks_for(
+    const LoggerOptions& options, std::shared_ptr<detail::AsyncSink>& async_sink) {
+    if (options.mode != LogMode::Async) {
+        return sinks_;
+    }
+
+    // In async mode the logger only talks to its own queue; its writer thread feeds the shared sinks
+    async_sink = std::make_shared<detail::AsyncSink>(sinks_, options.queue_size,
+                                                     options.overflow_policy);
+    return {async_sink};
+}
+
+void LoggerRegistry::check_options(std::string_view name, const Logger& logger,
+                                   const LoggerOptions& options) {
+    const auto& async_sink = logger.async_sink_;
+    const bool matches = options.mode == LogMode::Async
+        ? async_sink && async_sink->policy() == options.overflow_policy &&
+              async_sink->capacity() == detail::AsyncSink::capacity_for(options.queue_size)
+        : !async_sink;
+    if (!matches) {
+        throw Exception("Logger '" + std::string{name} +
+                        "' already exists with a different mode or queue configuration");
+    }
+}
+
+void LoggerRegistry::publish(std::shared_ptr<const LoggerMap> loggers) {
+    loggers_ = std::move(loggers);
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace cpptemplate::core
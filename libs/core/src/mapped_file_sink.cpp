@@ -0,0 +1,250 @@
+#include "cpptemplate/core/mapped_file_sink.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "cpptemplate/core/exception.hpp"
+
+namespace cpptemplate::core {
+
+namespace {
+
+std::atomic<std::uint64_t> next_sink_id{1};
+
+[[noreturn]] void throw_system_error(const std::string& what, const std::string& path) {
+    throw Exception(what + " '" + path + "': " + std::generic_category().message(errno));
+}
+
+std::size_t round_to_pages(std::size_t size) {
+#if !defined(_WIN32)
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#else
+    const std::size_t page = 4096;
+#endif
+    return (std::max<std::size_t>(size, 1) + page - 1) / page * page;
+}
+
+/// Length of the data in a mapped file, ignoring the NUL tail left by pre-sizing
+std::size_t used_length(const std::byte* base, std::size_t size) {
+    while (size > 0 && base[size - 1] == std::byte{0}) {
+        --size;
+    }
+    return size;
+}
+
+/// Each thread formats with its own clone of the sink's formatter
+struct FormatCache {
+    std::uint64_t sink_id = 0;
+    std::uint64_t version = 0;
+    std::unique_ptr<spdlog::formatter> formatter;
+    spdlog::memory_buf_t buffer;
+};
+
+} // namespace
+
+MappedFileSink::MappedFileSink(MappedFileSinkOptions options)
+    : options_(std::move(options)),
+      capacity_(round_to_pages(options_.file_size)),
+      id_(next_sink_id.fetch_add(1, std::memory_order_relaxed)),
+      formatter_(std::make_unique<spdlog::pattern_formatter>()) {
+#if defined(_WIN32)
+    throw Exception("MappedFileSink requires POSIX mmap");
+#else
+    const auto directory = std::filesystem::path(options_.path).parent_path();
+    if (!directory.empty()) {
+        std::filesystem::create_directories(directory);
+    }
+    open_segment(segments_[0]);
+    current_.store(&segments_[0], std::memory_order_release);
+#endif
+}
+
+MappedFileSink::~MappedFileSink() {
+    if (auto* segment = current_.load(std::memory_order_acquire)) {
+        close_segment(*segment);
+    }
+}
+
+void MappedFileSink::log(const spdlog::details::log_msg& msg) {
+    thread_local FormatCache cache;
+
+    const auto version = formatter_version_.load(std::memory_order_acquire);
+    if (cache.sink_id != id_ || cache.version != version) {
+        std::lock_guard lock(mutex_);
+        cache.formatter = formatter_->clone();
+        cache.version = formatter_version_.load(std::memory_order_relaxed);
+        cache.sink_id = id_;
+    }
+
+    cache.buffer.clear();
+    cache.formatter->format(msg, cache.buffer);
+    write(cache.buffer.data(), cache.buffer.size());
+}
+
+void MappedFileSink::flush() {
+#if !defined(_WIN32)
+    // Rotation holds the mutex, so the current mapping cannot go away underneath us
+    std::lock_guard lock(mutex_);
+    const auto* segment = current_.load(std::memory_order_acquire);
+    ::msync(segment->base, capacity_, MS_ASYNC);
+#endif
+}
+
+void MappedFileSink::set_pattern(const std::string& pattern) {
+    set_formatter(std::make_unique<spdlog::pattern_formatter>(pattern));
+}
+
+void MappedFileSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    std::lock_guard lock(mutex_);
+    formatter_ = std::move(sink_formatter);
+    formatter_version_.fetch_add(1, std::memory_order_release);
+}
+
+void MappedFileSink::write(const char* data, std::size_t size) {
+    if (size > capacity_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    for (;;) {
+        auto* segment = current_.load(std::memory_order_acquire);
+
+        // seq_cst on writers and reserved lets rotate() rely on seeing every
+        // writer whose reservation succeeded before the one that overflowed
+        segment->writers.fetch_add(1);
+        const auto offset = segment->reserved.fetch_add(size);
+        if (offset + size <= capacity_) {
+            std::memcpy(segment->base + offset, data, size);
+            segment->writers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        segment->writers.fetch_sub(1, std::memory_order_release);
+
+        // Once one reservation overflows every later one does too, so nobody
+        // writes into this segment until it is reopened; whoever gets the
+        // mutex first rotates
+        rotate(segment);
+    }
+}
+
+void MappedFileSink::rotate(Segment* full) {
+    std::lock_guard lock(mutex_);
+    // A stale writer whose reservation failed before full was reopened finds
+    // it current again but not overflowed; only a real overflow rotates
+    if (current_.load(std::memory_order_acquire) != full || full->reserved.load() <= capacity_) {
+        return;
+    }
+
+    while (full->writers.load() != 0) {
+        std::this_thread::yield();
+    }
+    close_segment(*full);
+    rotate_files();
+
+    Segment& next = full == &segments_[0] ? segments_[1] : segments_[0];
+    open_segment(next);
+    current_.store(&next, std::memory_order_release);
+}
+
+void MappedFileSink::open_segment(Segment& segment) {
+#if !defined(_WIN32)
+    int fd = ::open(options_.path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw_system_error("Failed to open log file", options_.path);
+    }
+
+    // Recover a file left behind by a crash or a previous run: drop its NUL tail
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw_system_error("Failed to stat log file", options_.path);
+    }
+    auto existing = static_cast<std::size_t>(info.st_size);
+    if (existing > 0) {
+        void* old = ::mmap(nullptr, existing, PROT_READ, MAP_SHARED, fd, 0);
+        if (old != MAP_FAILED) {
+            existing = used_length(static_cast<const std::byte*>(old), existing);
+            ::munmap(old, static_cast<std::size_t>(info.st_size));
+        }
+        if (::ftruncate(fd, static_cast<off_t>(existing)) != 0) {
+            ::close(fd);
+            throw_system_error("Failed to trim log file", options_.path);
+        }
+    }
+    if (existing >= capacity_) {
+        ::close(fd);
+        rotate_files();
+        fd = ::open(options_.path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw_system_error("Failed to open log file", options_.path);
+        }
+        existing = 0;
+    }
+
+    if (::ftruncate(fd, static_cast<off_t>(capacity_)) != 0) {
+        ::close(fd);
+        throw_system_error("Failed to size log file", options_.path);
+    }
+    void* base = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        throw_system_error("Failed to map log file", options_.path);
+    }
+
+    segment.base = static_cast<std::byte*>(base);
+    segment.fd = fd;
+    // Publishes base to writers whose reservation reads this value
+    segment.reserved.store(existing, std::memory_order_release);
+#endif
+}
+
+void MappedFileSink::close_segment(Segment& segment) {
+#if !defined(_WIN32)
+    if (segment.base == nullptr) {
+        return;
+    }
+    const auto end = std::min(segment.reserved.load(), capacity_);
+    const auto used = used_length(segment.base, end);
+    ::munmap(segment.base, capacity_);
+    if (::ftruncate(segment.fd, static_cast<off_t>(used)) != 0) {
+        // Nothing sensible to do here; the NUL tail is trimmed on the next open
+    }
+    ::close(segment.fd);
+    segment.base = nullptr;
+    segment.fd = -1;
+#endif
+}
+
+void MappedFileSink::rotate_files() {
+    // Same naming as spdlog's rotating sink: app.log -> app.1.log -> app.2.log ...
+    using spdlog::sinks::rotating_file_sink_mt;
+    std::error_code ignored;
+    for (auto i = options_.max_files; i > 0; --i) {
+        const auto source = rotating_file_sink_mt::calc_filename(options_.path, i - 1);
+        if (std::filesystem::exists(source, ignored)) {
+            // Remove first: renaming over a file makes some filesystems (ext4) write it back synchronously
+            const auto target = rotating_file_sink_mt::calc_filename(options_.path, i);
+            std::filesystem::remove(target, ignored);
+            std::filesystem::rename(source, target, ignored);
+        }
+    }
+    if (options_.max_files == 0) {
+        std::filesystem::remove(options_.path, ignored);
+    }
+}
+
+} // namespace cpptemplate::core
@@ -0,0 +1,77 @@
+#include "cpptemplate/core/simd.hpp"
+
+#include <atomic>
+
+#include "cpptemplate/core/cpu_features.hpp"
+
+namespace cpptemplate::core {
+
+namespace {
+
+bool supported(SimdLevel level) noexcept {
+    [[maybe_unused]] const auto& features = cpu_features();
+    switch (level) {
+        case SimdLevel::Scalar: return true;
+#if CPPTEMPLATE_X86_KERNELS
+        case SimdLevel::Sse42: return features.sse42;
+        case SimdLevel::Avx2: return features.avx2;
+        case SimdLevel::Avx512: return features.avx512f;
+#endif
+#if CPPTEMPLATE_NEON_KERNELS
+        case SimdLevel::Neon: return features.neon;
+#endif
+        default: return false;
+    }
+}
+
+/// Best level at or below the requested one that the running CPU supports
+SimdLevel usable(SimdLevel level) noexcept {
+    while (!supported(level)) {
+        switch (level) {
+            case SimdLevel::Avx512: level = SimdLevel::Avx2; break;
+            case SimdLevel::Avx2: level = SimdLevel::Sse42; break;
+            default: level = SimdLevel::Scalar; break;
+        }
+    }
+    return level;
+}
+
+SimdLevel detect() noexcept {
+    const auto x86 = usable(SimdLevel::Avx512);
+    return x86 != SimdLevel::Scalar ? x86 : usable(SimdLevel::Neon);
+}
+
+std::atomic<SimdLevel>& active_level() noexcept {
+    static std::atomic<SimdLevel> level{detected_simd_level()};
+    return level;
+}
+
+} // namespace
+
+SimdLevel detected_simd_level() noexcept {
+    static const SimdLevel level = detect();
+    return level;
+}
+
+SimdLevel simd_level() noexcept {
+    return active_level().load(std::memory_order_relaxed);
+}
+
+SimdLevel set_simd_level(SimdLevel level) noexcept {
+    level = usable(level);
+    active_level().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+std::string_view to_string(SimdLevel level) noexcept {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::Sse42: return "sse4.2";
+        case SimdLevel::Avx2: return "avx2";
+        case SimdLevel::Avx512: return "avx512";
+        case SimdLevel::Neon: return "neon";
+    }
+    return "unknown";
+}
+
+} // namespace cpptemplate::core
@@ -0,0 +1,177 @@
+#include "cpptemplate/core/thread_pool.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+
+namespace cpptemplate::core {
+
+namespace {
+
+/// Pool and queue of the current thread if it is a pool worker
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+
+} // namespace
+
+struct ThreadPool::Job {
+    Job(Invoke invoke_fn, const void* context_ptr, std::size_t grain_size, std::size_t count) noexcept
+        : invoke(invoke_fn), context(context_ptr), grain(grain_size), remaining(count) {}
+
+    Invoke invoke;
+    const void* context;
+    std::size_t grain;
+    std::atomic<std::size_t> remaining; ///< Indices not yet processed; 0 releases the caller
+    std::atomic<bool> failed{false};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+};
+
+struct ThreadPool::Task {
+    Job* job;
+    std::size_t begin;
+    std::size_t end;
+};
+
+/// Owner pushes and pops at the back; thieves take the oldest, largest ranges from the front
+struct ThreadPool::Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0) {
+        threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Worker>());
+    }
+    workers_.reserve(threads - 1);
+    for (std::size_t i = 0; i + 1 < threads; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::run(std::size_t count, std::size_t grain, Invoke invoke, const void* context) {
+    grain = std::max<std::size_t>(grain, 1);
+    if (count == 0) {
+        return;
+    }
+    if (count <= grain) {
+        invoke(context, 0, count);
+        return;
+    }
+
+    Job job(invoke, context, grain, count);
+    // Threads outside the pool share the last queue
+    const std::size_t queue = current_pool == this ? current_queue : queues_.size() - 1;
+    execute(Task{&job, 0, count}, queue);
+    while (job.remaining.load(std::memory_order_acquire) != 0) {
+        Task task{};
+        if (try_pop(queue, task) || try_steal(queue, task)) {
+            execute(task, queue);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+void ThreadPool::execute(Task task, std::size_t queue) {
+    Job& job = *task.job;
+    while (task.end - task.begin > job.grain) {
+        const std::size_t middle = task.begin + (task.end - task.begin) / 2;
+        push(Task{&job, middle, task.end}, queue);
+        task.end = middle;
+    }
+    if (!job.failed.load(std::memory_order_relaxed)) {
+        try {
+            job.invoke(job.context, task.begin, task.end);
+        } catch (...) {
+            std::lock_guard lock(job.error_mutex);
+            if (!job.error) {
+                job.error = std::current_exception();
+            }
+            job.failed.store(true, std::memory_order_relaxed);
+        }
+    }
+    // Last access to job: the caller may return as soon as this reaches 0
+    job.remaining.fetch_sub(task.end - task.begin, std::memory_order_acq_rel);
+}
+
+void ThreadPool::push(Task task, std::size_t queue) {
+    {
+        std::lock_guard lock(queues_[queue]->mutex);
+        queues_[queue]->tasks.push_back(task);
+    }
+    queued_.fetch_add(1);
+    if (sleeping_.load() != 0) {
+        std::lock_guard lock(sleep_mutex_);
+        wake_.notify_one();
+    }
+}
+
+bool ThreadPool::try_pop(std::size_t queue, Task& task) {
+    Worker& worker = *queues_[queue];
+    std::lock_guard lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = worker.tasks.back();
+    worker.tasks.pop_back();
+    queued_.fetch_sub(1);
+    return true;
+}
+
+bool ThreadPool::try_steal(std::size_t thief, Task& task) {
+    for (std::size_t i = 1; i < queues_.size() && queued_.load(std::memory_order_relaxed) != 0; ++i) {
+        Worker& victim = *queues_[(thief + i) % queues_.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::worker_loop(std::size_t index) {
+    current_pool = this;
+    current_queue = index;
+    for (;;) {
+        Task task{};
+        if (try_pop(index, task) || try_steal(index, task)) {
+            execute(task, index);
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex_);
+        sleeping_.fetch_add(1);
+        wake_.wait(lock, [this] { return stop_ || queued_.load() != 0; });
+        sleeping_.fetch_sub(1);
+        if (stop_) {
+            return;
+        }
+    }
+}
+
+} // namespace cpptemplate::core
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
 #include <stdexcept>
 
+#include "cpptemplate/core/expected.hpp"
+
 // Export macros for dynamic libraries
 #ifdef CPPTEMPLATE_MATH_STATIC
     #define CPPTEMPLATE_MATH_API
@@ -28,6 +34,11 @@ namespace cpptemplate::math {
  * 
  * This class provides basic mathematical operations with proper error handling
  * and follows modern C++ best practices.
+ *
+ * Each operation also has a batch overload working elementwise on spans.
+ * Batch calls dispatch once per call to AVX-512, AVX2 or scalar kernels
+ * chosen from the running CPU (see simd.hpp). The output span may be the same
+ * as an input span for in-place operation but must not otherwise overlap one.
  */
 class CPPTEMPLATE_MATH_API Calculator {
 public:
@@ -80,6 +91,19 @@ public:
      */
     [[nodiscard]] double divide(double a, double b) const;
 
+    /**
+     * @brief Divide two numbers without throwing
+     *
+     * For callers where a zero divisor is ordinary input: the error is
+     * returned by value, with no allocation and no unwinding.
+     *
+     * @param a Dividend
+     * @param b Divisor
+     * @return Quotient of a and b, or core::Errc::DivisionByZero if b is zero
+     */
+    [[nodiscard]] core::Expected<double> divide(double a, double b,
+                                                std::nothrow_t) const noexcept;
+
     /**
      * @brief Calculate power of a number
      * @param base Base number
@@ -95,6 +119,83 @@ public:
      * @throws std::invalid_argument if value is negative
      */
     [[nodiscard]] double sqrt(double value) const;
+
+    /**
+     * @brief Calculate square root of a number without throwing
+     * @param value Input value
+     * @return Square root of the input value, or core::Errc::DomainError if value is negative
+     */
+    [[nodiscard]] core::Expected<double> sqrt(double value, std::nothrow_t) const noexcept;
+
+    /**
+     * @brief Add two arrays elementwise: out[i] = a[i] + b[i]
+     * @param a First operands
+     * @param b Second operands
+     * @param out Results
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    void add(std::span<const double> a, std::span<const double> b, std::span<double> out) const;
+
+    /**
+     * @brief Subtract two arrays elementwise: out[i] = a[i] - b[i]
+     * @param a First operands
+     * @param b Second operands
+     * @param out Results
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    void subtract(std::span<const double> a, std::span<const double> b,
+                  std::span<double> out) const;
+
+    /**
+     * @brief Multiply two arrays elementwise: out[i] = a[i] * b[i]
+     * @param a First operands
+     * @param b Second operands
+     * @param out Results
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    void multiply(std::span<const double> a, std::span<const double> b,
+                  std::span<double> out) const;
+
+    /**
+     * @brief Divide two arrays elementwise: out[i] = a[i] / b[i]
+     *
+     * A zero divisor does not throw: out[i] is set to quiet NaN and, if
+     * `errors` is given, errors[i] to 1 (0 for elements that succeeded).
+     *
+     * @param a Dividends
+     * @param b Divisors
+     * @param out Quotients
+     * @param errors Optional per-element error flags, empty or the size of out
+     * @return Number of elements whose divisor was zero
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    std::size_t divide(std::span<const double> a, std::span<const double> b,
+                       std::span<double> out, std::span<std::uint8_t> errors = {}) const;
+
+    /**
+     * @brief Raise an array to powers elementwise: out[i] = base[i] ^ exponent[i]
+     * @param base Base numbers
+     * @param exponent Exponents
+     * @param out Results
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    void power(std::span<const double> base, std::span<const double> exponent,
+               std::span<double> out) const;
+
+    /**
+     * @brief Square root of an array elementwise
+     *
+     * A negative value does not throw: out[i] is set to quiet NaN and, if
+     * `errors` is given, errors[i] to 1 (0 for elements that succeeded).
+     *
+     * @param values Input values
+     * @param out Square roots
+     * @param errors Optional per-element error flags, empty or the size of out
+     * @return Number of negative input values
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    std::size_t sqrt(std::span<const double> values, std::span<double> out,
+                     std::span<std::uint8_t> errors = {}) const;
 };
 
 } // namespace cpptemplate::math
\ No newline at end of file
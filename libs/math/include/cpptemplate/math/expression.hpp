@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "calculator.hpp" // For export macros
+#include "cpptemplate/core/string_hash.hpp"
+#include "cpptemplate/core/thread_pool.hpp"
+
+namespace cpptemplate::math {
+
+/**
+ * @brief A formula compiled to register bytecode for evaluation over columns
+ *
+ * Grammar, with the usual precedence and `^` binding tightest and to the
+ * right (so `-x^2` is `-(x^2)` and `2^3^2` is `2^9`):
+ *
+ *     expr    := term (('+' | '-') term)*
+ *     term    := unary (('*' | '/') unary)*
+ *     unary   := ('-' | '+') unary | power
+ *     power   := primary ('^' unary)?
+ *     primary := number | variable | 'sqrt(' expr ')' | 'pow(' expr ',' expr ')' | '(' expr ')'
+ *
+ * Variables are identifiers and are numbered in order of first appearance.
+ * Compilation folds constant subexpressions, turns `x^2` into `x*x` and
+ * shares repeated subexpressions, then assigns registers so temporaries are
+ * reused once dead. Evaluation runs the program over blocks of rows that
+ * stay in L1, each instruction one call into the Calculator's batch kernels
+ * (AVX-512, AVX2 or scalar).
+ *
+ * Semantics match the Calculator's batch operations: division by a divisor
+ * smaller in magnitude than epsilon and the square root of a negative
+ * number give quiet NaN instead of throwing.
+ *
+ * @example
+ * ```cpp
+ * const auto expr = Expression::compile("sqrt(x^2 + y^2) / 2");
+ * std::array<std::span<const double>, 2> columns{xs, ys}; // In expr.variables() order
+ * expr.evaluate(columns, out);
+ * ```
+ */
+class CPPTEMPLATE_MATH_API Expression {
+public:
+    /// Bytecode operations, one per batch kernel
+    enum class OpCode : std::uint8_t { Add, Subtract, Multiply, Divide, Power, Sqrt };
+
+    /**
+     * @brief One instruction: out = op(a, b)
+     *
+     * Operands index the register file: variables first, then constants,
+     * then temporaries, then the result. Sqrt ignores b.
+     */
+    struct Instruction {
+        OpCode op;
+        std::uint16_t out;
+        std::uint16_t a;
+        std::uint16_t b;
+    };
+
+    /// Rows evaluated per block; a few temporaries of this size stay in L1
+    static constexpr std::size_t BlockRows = 512;
+
+    /**
+     * @brief Parse and compile a formula
+     * @param formula Formula text
+     * @return Compiled expression
+     * @throws std::invalid_argument on a syntax error, naming its position
+     */
+    [[nodiscard]] static Expression compile(std::string_view formula);
+
+    /// Variable names, in the order evaluate() expects their values
+    [[nodiscard]] const std::vector<std::string>& variables() const noexcept {
+        return variables_;
+    }
+
+    /// Compiled program
+    [[nodiscard]] std::span<const Instruction> instructions() const noexcept {
+        return code_;
+    }
+
+    /**
+     * @brief Evaluate over columns of rows
+     * @param columns One column per variable, in variables() order, each out.size() long
+     * @param out Receives one result per row; may be one of the columns but must not partly overlap one
+     * @throws std::invalid_argument if the number or sizes of the columns are wrong
+     */
+    void evaluate(std::span<const std::span<const double>> columns, std::span<double> out) const;
+
+    /**
+     * @brief Evaluate over columns of rows, blocks split between the threads of a pool
+     * @copydetails evaluate(std::span<const std::span<const double>>, std::span<double>) const
+     * @param pool Pool to run on
+     */
+    void evaluate(std::span<const std::span<const double>> columns, std::span<double> out,
+                  core::ThreadPool& pool) const;
+
+    /**
+     * @brief Evaluate a single row by interpreting the program one value at a time
+     * @param row One value per variable, in variables() order
+     * @return Result
+     * @throws std::invalid_argument if row.size() != variables().size()
+     */
+    [[nodiscard]] double evaluate(std::span<const double> row) const;
+
+private:
+    Expression() = default;
+
+    void evaluate_rows(std::span<const std::span<const double>> columns, std::span<double> out,
+                       std::size_t begin, std::size_t end) const;
+    void check_columns(std::span<const std::span<const double>> columns, std::size_t rows) const;
+
+    std::vector<std::string> variables_;
+    std::vector<double> constants_;
+    std::vector<Instruction> code_;
+    std::size_t temporaries_ = 0;
+    std::uint16_t result_ = 0; ///< Register holding the result; a variable or constant if code_ is empty
+};
+
+/**
+ * @brief Thread-safe cache of compiled expressions keyed by formula text
+ *
+ * Keeps the most recently used formulas up to a capacity. Compilation runs
+ * outside the lock, so a slow compile does not stall lookups of other
+ * formulas; if two threads compile the same formula at once, the first
+ * insert wins and both get the same Expression.
+ */
+class CPPTEMPLATE_MATH_API ExpressionCache {
+public:
+    /**
+     * @brief Create an empty cache
+     * @param capacity Formulas kept before the least recently used is evicted, at least 1
+     */
+    explicit ExpressionCache(std::size_t capacity = 1024);
+
+    /**
+     * @brief Get the compiled form of a formula, compiling it on a miss
+     * @param formula Formula text, matched exactly
+     * @return Compiled expression, valid after eviction
+     * @throws std::invalid_argument if the formula does not compile; failures are not cached
+     */
+    [[nodiscard]] std::shared_ptr<const Expression> get(std::string_view formula);
+
+    /// Number of cached formulas
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    /// Drop every cached formula
+    void clear();
+
+private:
+    struct Entry {
+        std::shared_ptr<const Expression> expression;
+        std::list<std::string>::iterator recency;
+    };
+
+    std::size_t capacity_;
+    mutable std::mutex mutex_;
+    std::list<std::string> recency_; ///< Most recently used first
+    std::unordered_map<std::string, Entry, core::detail::StringHash, std::equal_to<>> entries_;
+};
+
+} // namespace cpptemplate::math
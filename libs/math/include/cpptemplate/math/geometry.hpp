@@ -0,0 +1,418 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "calculator.hpp" // For export macros
+#include "cpptemplate/core/thread_pool.hpp"
+
+namespace cpptemplate::math {
+
+/**
+ * @brief Point in 2D or 3D space
+ * @tparam D Dimension, 2 or 3
+ */
+template<std::size_t D>
+    requires(D == 2 || D == 3)
+struct Point {
+    std::array<double, D> coords{};
+
+    [[nodiscard]] double& operator[](std::size_t axis) noexcept {
+        return coords[axis];
+    }
+
+    [[nodiscard]] double operator[](std::size_t axis) const noexcept {
+        return coords[axis];
+    }
+
+    friend bool operator==(const Point&, const Point&) = default;
+};
+
+using Point2 = Point<2>;
+using Point3 = Point<3>;
+
+/**
+ * @brief Squared Euclidean distance
+ */
+template<std::size_t D>
+[[nodiscard]] double squared_distance(const Point<D>& a, const Point<D>& b) noexcept {
+    double sum = 0.0;
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        const double d = a[axis] - b[axis];
+        sum += d * d;
+    }
+    return sum;
+}
+
+/**
+ * @brief Euclidean distance
+ */
+template<std::size_t D>
+[[nodiscard]] double distance(const Point<D>& a, const Point<D>& b) noexcept {
+    return std::sqrt(squared_distance(a, b));
+}
+
+/**
+ * @brief Axis-aligned bounding box, closed on both ends
+ *
+ * A default-constructed box is empty (min > max) and is the identity for
+ * expand().
+ *
+ * @tparam D Dimension, 2 or 3
+ */
+template<std::size_t D>
+struct Aabb {
+    Point<D> min = filled(std::numeric_limits<double>::infinity());
+    Point<D> max = filled(-std::numeric_limits<double>::infinity());
+
+    /// True if no point is inside
+    [[nodiscard]] bool empty() const noexcept {
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            if (min[axis] > max[axis]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool contains(const Point<D>& p) const noexcept {
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            if (p[axis] < min[axis] || p[axis] > max[axis]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// True if the boxes share at least one point (touching counts)
+    [[nodiscard]] bool intersects(const Aabb& other) const noexcept {
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            if (other.min[axis] > max[axis] || other.max[axis] < min[axis]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Grow to include p
+    void expand(const Point<D>& p) noexcept {
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            min[axis] = std::min(min[axis], p[axis]);
+            max[axis] = std::max(max[axis], p[axis]);
+        }
+    }
+
+    /// Grow to include another box
+    void expand(const Aabb& other) noexcept {
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            min[axis] = std::min(min[axis], other.min[axis]);
+            max[axis] = std::max(max[axis], other.max[axis]);
+        }
+    }
+
+    /// Squared distance from p to the nearest point of the box, 0 inside
+    [[nodiscard]] double squared_distance(const Point<D>& p) const noexcept {
+        double sum = 0.0;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            const double d = std::max({min[axis] - p[axis], 0.0, p[axis] - max[axis]});
+            sum += d * d;
+        }
+        return sum;
+    }
+
+    friend bool operator==(const Aabb&, const Aabb&) = default;
+
+private:
+    static Point<D> filled(double value) noexcept {
+        Point<D> p;
+        p.coords.fill(value);
+        return p;
+    }
+};
+
+using Aabb2 = Aabb<2>;
+using Aabb3 = Aabb<3>;
+
+/**
+ * @brief Points stored structure-of-arrays: one contiguous array per axis
+ *
+ * The layout batch kernels and the spatial index read with full-width
+ * vector loads.
+ *
+ * @tparam D Dimension, 2 or 3
+ */
+template<std::size_t D>
+class PointSet {
+public:
+    PointSet() = default;
+
+    /// Copy from an array of points
+    explicit PointSet(std::span<const Point<D>> points) {
+        reserve(points.size());
+        for (const auto& p : points) {
+            push_back(p);
+        }
+    }
+
+    void reserve(std::size_t n) {
+        for (auto& axis : axes_) {
+            axis.reserve(n);
+        }
+    }
+
+    void push_back(const Point<D>& p) {
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            axes_[axis].push_back(p[axis]);
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return axes_[0].size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return axes_[0].empty();
+    }
+
+    /// Gather point i
+    [[nodiscard]] Point<D> operator[](std::size_t i) const noexcept {
+        Point<D> p;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            p[axis] = axes_[axis][i];
+        }
+        return p;
+    }
+
+    /// All coordinates along one axis
+    [[nodiscard]] std::span<const double> axis(std::size_t axis) const noexcept {
+        return axes_[axis];
+    }
+
+    [[nodiscard]] std::span<double> axis(std::size_t axis) noexcept {
+        return axes_[axis];
+    }
+
+    /// Smallest box containing every point
+    [[nodiscard]] Aabb<D> bounds() const noexcept {
+        Aabb<D> box;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            if (!empty()) {
+                const auto [lo, hi] = std::minmax_element(axes_[axis].begin(), axes_[axis].end());
+                box.min[axis] = *lo;
+                box.max[axis] = *hi;
+            }
+        }
+        return box;
+    }
+
+private:
+    std::array<std::vector<double>, D> axes_;
+};
+
+/**
+ * @brief Boxes stored structure-of-arrays: lower and upper corner per axis
+ * @tparam D Dimension, 2 or 3
+ */
+template<std::size_t D>
+class BoxSet {
+public:
+    void reserve(std::size_t n) {
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            lower_[axis].reserve(n);
+            upper_[axis].reserve(n);
+        }
+    }
+
+    void push_back(const Aabb<D>& box) {
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            lower_[axis].push_back(box.min[axis]);
+            upper_[axis].push_back(box.max[axis]);
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return lower_[0].size();
+    }
+
+    [[nodiscard]] Aabb<D> operator[](std::size_t i) const noexcept {
+        Aabb<D> box;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            box.min[axis] = lower_[axis][i];
+            box.max[axis] = upper_[axis][i];
+        }
+        return box;
+    }
+
+    /// Lower corner coordinates along one axis
+    [[nodiscard]] std::span<const double> lower(std::size_t axis) const noexcept {
+        return lower_[axis];
+    }
+
+    /// Upper corner coordinates along one axis
+    [[nodiscard]] std::span<const double> upper(std::size_t axis) const noexcept {
+        return upper_[axis];
+    }
+
+private:
+    std::array<std::vector<double>, D> lower_;
+    std::array<std::vector<double>, D> upper_;
+};
+
+// Batch kernels: AVX-512, AVX2 or scalar, chosen by core::simd_level()
+
+/**
+ * @brief Test every box against a query box
+ * @param boxes Boxes
+ * @param query Query box
+ * @param hits Receives 1 for each box intersecting query and 0 otherwise
+ * @return Number of intersecting boxes
+ * @throws std::invalid_argument if hits.size() != boxes.size()
+ */
+CPPTEMPLATE_MATH_API std::size_t intersect(const BoxSet<2>& boxes,
+                                           const Aabb2& query,
+                                           std::span<std::uint8_t> hits);
+
+/// @copydoc intersect(const BoxSet<2>&, const Aabb2&, std::span<std::uint8_t>)
+CPPTEMPLATE_MATH_API std::size_t intersect(const BoxSet<3>& boxes,
+                                           const Aabb3& query,
+                                           std::span<std::uint8_t> hits);
+
+/**
+ * @brief Test every point against a box
+ * @param points Points
+ * @param box Box
+ * @param inside Receives 1 for each point inside box and 0 otherwise
+ * @return Number of points inside
+ * @throws std::invalid_argument if inside.size() != points.size()
+ */
+CPPTEMPLATE_MATH_API std::size_t contains(const Aabb2& box,
+                                          const PointSet<2>& points,
+                                          std::span<std::uint8_t> inside);
+
+/// @copydoc contains(const Aabb2&, const PointSet<2>&, std::span<std::uint8_t>)
+CPPTEMPLATE_MATH_API std::size_t contains(const Aabb3& box,
+                                          const PointSet<3>& points,
+                                          std::span<std::uint8_t> inside);
+
+/**
+ * @brief Squared distance from every point to a query point
+ * @param points Points
+ * @param query Query point
+ * @param out Receives one distance per point
+ * @throws std::invalid_argument if out.size() != points.size()
+ */
+CPPTEMPLATE_MATH_API void squared_distances(const PointSet<2>& points,
+                                            const Point2& query,
+                                            std::span<double> out);
+
+/// @copydoc squared_distances(const PointSet<2>&, const Point2&, std::span<double>)
+CPPTEMPLATE_MATH_API void squared_distances(const PointSet<3>& points,
+                                            const Point3& query,
+                                            std::span<double> out);
+
+/**
+ * @brief Result of PointIndex::nearest()
+ */
+struct Neighbor {
+    std::uint32_t id;        ///< Index of the point in the PointSet the index was built from
+    double squared_distance; ///< Squared distance to the query, bit-equal to squared_distance()
+};
+
+/**
+ * @brief Static spatial index over points: a bulk-loaded, packed R-tree
+ *
+ * Built once with Sort-Tile-Recursive packing into fanout-8 nodes, with
+ * slabs tiled in parallel on a ThreadPool. Each level is stored
+ * structure-of-arrays and the 8 children of a node are adjacent, so one
+ * AVX-512 compare (two with AVX2) tests all of them; the points are
+ * reordered the same way and leaf tests load them directly. Queries are
+ * read-only and may run concurrently.
+ *
+ * @example
+ * ```cpp
+ * PointIndex<3> index(points);
+ * std::vector<std::uint32_t> hits;
+ * index.query(Aabb3{{0, 0, 0}, {1, 1, 1}}, hits);
+ * auto nearest = index.nearest(Point3{{0.5, 0.5, 0.5}}, 10);
+ * ```
+ *
+ * @tparam D Dimension, 2 or 3
+ */
+template<std::size_t D>
+class PointIndex {
+public:
+    /// Children per node
+    static constexpr std::size_t Fanout = 8;
+
+    /**
+     * @brief Build the index
+     * @param points Points, at most 2^32 - 1; NaN coordinates are not allowed
+     * @param pool Pool used to tile slabs in parallel
+     */
+    explicit PointIndex(const PointSet<D>& points,
+                        core::ThreadPool& pool = core::ThreadPool::shared());
+
+    /// Number of indexed points
+    [[nodiscard]] std::size_t size() const noexcept {
+        return ids_.size();
+    }
+
+    /// Box containing every point
+    [[nodiscard]] Aabb<D> bounds() const noexcept {
+        return bounds_;
+    }
+
+    /**
+     * @brief Find the points inside a box
+     *
+     * Subtrees whose box lies entirely inside the query are emitted without
+     * testing their points, so large queries cost little more than copying
+     * the ids.
+     *
+     * @param box Query box, closed
+     * @param out Receives the ids of matching points, appended in no particular order
+     * @return Number of ids appended
+     */
+    std::size_t query(const Aabb<D>& box, std::vector<std::uint32_t>& out) const;
+
+    /**
+     * @brief Count the points inside a box
+     * @param box Query box, closed
+     * @return Number of points inside
+     */
+    [[nodiscard]] std::size_t count(const Aabb<D>& box) const;
+
+    /**
+     * @brief Find the k points nearest to a query point
+     * @param query Query point
+     * @param k Number of neighbours
+     * @return min(k, size()) neighbours by ascending distance
+     */
+    [[nodiscard]] std::vector<Neighbor> nearest(const Point<D>& query, std::size_t k) const;
+
+private:
+    /// One tree level's boxes, structure-of-arrays, padded to a multiple of Fanout with empty boxes
+    struct Level {
+        std::array<std::vector<double>, D> lower;
+        std::array<std::vector<double>, D> upper;
+    };
+
+    template<typename Emit>
+    void visit(const Aabb<D>& box, Emit&& emit) const;
+
+    std::array<std::vector<double>, D> coords_; ///< Points in tree order, padded with +infinity
+    std::vector<std::uint32_t> ids_;            ///< Original index of each point in tree order
+    std::vector<Level> levels_;                 ///< [0] bounds groups of 8 points, back() the root
+    Aabb<D> bounds_;
+};
+
+extern template class CPPTEMPLATE_MATH_API PointIndex<2>;
+extern template class CPPTEMPLATE_MATH_API PointIndex<3>;
+
+} // namespace cpptemplate::math
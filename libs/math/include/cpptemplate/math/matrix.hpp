@@ -1,21 +1,348 @@
 #pragma once
 
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
 #include "calculator.hpp" // For export macros
+#include "cpptemplate/core/thread_pool.hpp"
+#include "matrix_expression.hpp"
+#include "matrix_view.hpp"
 
 namespace cpptemplate::math {
 
 /**
- * @brief Matrix operations class
- * 
- * This class provides matrix operations.
- * Add actual implementation as needed.
+ * @brief Dense row-major matrix of float or double
+ *
+ * Storage is one contiguous, 64-byte aligned allocation, so rows of
+ * multiples of 16 floats or 8 doubles start on cache-line boundaries.
+ * Matrices are move-only; use clone() for an explicit deep copy and views
+ * to pass blocks around without copying.
+ *
+ * `a * b` between matrices is the matrix product (see multiply()). The
+ * elementwise operators (+, -, unary -, scaling, hadamard()) build
+ * expressions instead of temporaries; assigning one to a Matrix evaluates
+ * the whole chain in a single pass into a single allocation.
+ *
+ * @example
+ * ```cpp
+ * Matrix<double> a(512, 256), b(256, 128);
+ * Matrix<double> c = a * b;
+ * multiply(a.view().block(0, 0, 64, 256), b, c.view().block(0, 0, 64, 128), 1.0, 1.0);
+ * Matrix<double> d = c + c * 0.5 - c; // One pass, one allocation
+ * ```
+ *
+ * @tparam T Element type
  */
-class CPPTEMPLATE_MATH_API Matrix {
+template<MatrixElement T>
+class Matrix {
 public:
-    // Add matrix methods here
-    
+    using value_type = T;
+
+    /// Alignment of the storage in bytes
+    static constexpr std::size_t Alignment = 64;
+
+    /**
+     * @brief Create an empty 0 x 0 matrix
+     */
+    Matrix() noexcept = default;
+
+    /**
+     * @brief Create a zero-filled matrix
+     * @param rows Number of rows
+     * @param cols Number of columns
+     */
+    Matrix(std::size_t rows, std::size_t cols) : Matrix(rows, cols, T{0}) {}
+
+    /**
+     * @brief Create a matrix with every element set to value
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @param value Initial value
+     */
+    Matrix(std::size_t rows, std::size_t cols, T value)
+        : data_(allocate(rows, cols)), rows_(rows), cols_(cols) {
+        fill(value);
+    }
+
+    /**
+     * @brief Evaluate an expression into a new matrix
+     * @param expression Elementwise expression, e.g. `a + b * 2.0`
+     */
+    template<MatrixExpression E>
+        requires std::same_as<typename E::value_type, T>
+    Matrix(const E& expression) // NOLINT(google-explicit-constructor)
+        : data_(allocate(expression.rows(), expression.cols())),
+          rows_(expression.rows()),
+          cols_(expression.cols()) {
+        detail::evaluate(expression, view());
+    }
+
+    /**
+     * @brief Create from nested rows, e.g. Matrix<double>{{1, 2}, {3, 4}}
+     * @throws std::invalid_argument if the rows differ in length
+     */
+    Matrix(std::initializer_list<std::initializer_list<T>> rows)
+        : Matrix(rows.size(), rows.size() == 0 ? 0 : rows.begin()->size()) {
+        std::size_t r = 0;
+        for (const auto& row : rows) {
+            if (row.size() != cols_) {
+                throw std::invalid_argument("Matrix rows must all have the same length");
+            }
+            std::copy(row.begin(), row.end(), data_.get() + r * cols_);
+            ++r;
+        }
+    }
+
+    /**
+     * @brief Create an n x n identity matrix
+     * @param n Size
+     * @return Identity matrix
+     */
+    [[nodiscard]] static Matrix identity(std::size_t n) {
+        Matrix result(n, n);
+        for (std::size_t i = 0; i < n; ++i) {
+            result(i, i) = T{1};
+        }
+        return result;
+    }
+
+    Matrix(const Matrix&) = delete;
+    Matrix& operator=(const Matrix&) = delete;
+
+    Matrix(Matrix&& other) noexcept
+        : data_(std::move(other.data_)),
+          rows_(std::exchange(other.rows_, 0)),
+          cols_(std::exchange(other.cols_, 0)) {}
+
+    Matrix& operator=(Matrix&& other) noexcept {
+        data_ = std::move(other.data_);
+        rows_ = std::exchange(other.rows_, 0);
+        cols_ = std::exchange(other.cols_, 0);
+        return *this;
+    }
+
+    ~Matrix() = default;
+
+    /**
+     * @brief Evaluate an expression into this matrix
+     *
+     * Reuses the storage if the shape matches, so the expression may refer
+     * to this matrix (`x = x * 2.0 + y`).
+     *
+     * @param expression Elementwise expression
+     */
+    template<MatrixExpression E>
+        requires std::same_as<typename E::value_type, T>
+    Matrix& operator=(const E& expression) {
+        if (expression.rows() == rows_ && expression.cols() == cols_) {
+            detail::evaluate(expression, view());
+        } else {
+            *this = Matrix(expression);
+        }
+        return *this;
+    }
+
+    /// Elementwise in-place sum
+    template<MatrixOperand E>
+    Matrix& operator+=(E&& other) {
+        return *this = *this + std::forward<E>(other);
+    }
+
+    /// Elementwise in-place difference
+    template<MatrixOperand E>
+    Matrix& operator-=(E&& other) {
+        return *this = *this - std::forward<E>(other);
+    }
+
+    /// Scale every element in place
+    Matrix& operator*=(T scalar) {
+        return *this = *this * scalar;
+    }
+
+    /// Divide every element in place
+    Matrix& operator/=(T scalar) {
+        return *this = *this / scalar;
+    }
+
+    /**
+     * @brief Deep copy
+     * @return New matrix with the same shape and elements
+     */
+    [[nodiscard]] Matrix clone() const {
+        Matrix result;
+        result.data_ = allocate(rows_, cols_);
+        result.rows_ = rows_;
+        result.cols_ = cols_;
+        std::copy(data_.get(), data_.get() + size(), result.data_.get());
+        return result;
+    }
+
+    [[nodiscard]] std::size_t rows() const noexcept {
+        return rows_;
+    }
+
+    [[nodiscard]] std::size_t cols() const noexcept {
+        return cols_;
+    }
+
+    /// Number of elements
+    [[nodiscard]] std::size_t size() const noexcept {
+        return rows_ * cols_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    [[nodiscard]] T* data() noexcept {
+        return data_.get();
+    }
+
+    [[nodiscard]] const T* data() const noexcept {
+        return data_.get();
+    }
+
+    /// Unchecked element access
+    [[nodiscard]] T& operator()(std::size_t row, std::size_t col) noexcept {
+        return data_[row * cols_ + col];
+    }
+
+    [[nodiscard]] const T& operator()(std::size_t row, std::size_t col) const noexcept {
+        return data_[row * cols_ + col];
+    }
+
+    /// Unchecked row access
+    [[nodiscard]] std::span<T> row(std::size_t row) noexcept {
+        return {data_.get() + row * cols_, cols_};
+    }
+
+    [[nodiscard]] std::span<const T> row(std::size_t row) const noexcept {
+        return {data_.get() + row * cols_, cols_};
+    }
+
+    /// All elements in row-major order
+    [[nodiscard]] std::span<T> elements() noexcept {
+        return {data_.get(), size()};
+    }
+
+    [[nodiscard]] std::span<const T> elements() const noexcept {
+        return {data_.get(), size()};
+    }
+
+    [[nodiscard]] MatrixView<T> view() noexcept {
+        return {data_.get(), rows_, cols_};
+    }
+
+    [[nodiscard]] MatrixView<const T> view() const noexcept {
+        return {data_.get(), rows_, cols_};
+    }
+
+    operator MatrixView<T>() noexcept { // NOLINT(google-explicit-constructor)
+        return view();
+    }
+
+    operator MatrixView<const T>() const noexcept { // NOLINT(google-explicit-constructor)
+        return view();
+    }
+
+    /**
+     * @brief Set every element to value
+     * @param value Value
+     */
+    void fill(T value) noexcept {
+        std::fill(data_.get(), data_.get() + size(), value);
+    }
+
 private:
-    // Add matrix data here
+    struct AlignedDelete {
+        void operator()(T* data) const noexcept {
+            ::operator delete[](data, std::align_val_t{Alignment});
+        }
+    };
+
+    using Storage = std::unique_ptr<T[], AlignedDelete>;
+
+    static Storage allocate(std::size_t rows, std::size_t cols) {
+        if (cols != 0 && rows > static_cast<std::size_t>(-1) / sizeof(T) / cols) {
+            throw std::length_error("Matrix dimensions too large");
+        }
+        const std::size_t bytes = std::max<std::size_t>(rows * cols * sizeof(T), 1);
+        return Storage(static_cast<T*>(::operator new[](bytes, std::align_val_t{Alignment})));
+    }
+
+    Storage data_;
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
 };
 
-} // namespace cpptemplate::math
\ No newline at end of file
+template<typename Derived>
+auto MatrixExpressionBase<Derived>::eval() const {
+    return Matrix<typename Derived::value_type>(static_cast<const Derived&>(*this));
+}
+
+using MatrixF = Matrix<float>;
+using MatrixD = Matrix<double>;
+
+/**
+ * @brief General matrix multiply: c = alpha * a * b + beta * c
+ *
+ * Uses cache-blocked packing and register-tiled AVX-512, AVX2+FMA or scalar
+ * micro-kernels chosen by core::simd_level(). Large products are split into
+ * up to gemm_threads() parts, one per pool thread, so repeated multiplies
+ * reuse the pool's threads instead of starting their own. With beta == 0,
+ * c is overwritten and its previous contents (even NaN) are ignored. c must
+ * not overlap a or b.
+ *
+ * @param a Left operand, m x k
+ * @param b Right operand, k x n
+ * @param c Result, m x n
+ * @param alpha Scale of the product
+ * @param beta Scale of the previous c
+ * @param pool Pool to run on
+ * @throws std::invalid_argument if the shapes do not match
+ */
+CPPTEMPLATE_MATH_API void multiply(MatrixView<const float> a, MatrixView<const float> b,
+                                   MatrixView<float> c, float alpha = 1.0F, float beta = 0.0F,
+                                   core::ThreadPool& pool = core::ThreadPool::shared());
+
+/// @copydoc multiply(MatrixView<const float>, MatrixView<const float>, MatrixView<float>, float, float, core::ThreadPool&)
+CPPTEMPLATE_MATH_API void multiply(MatrixView<const double> a, MatrixView<const double> b,
+                                   MatrixView<double> c, double alpha = 1.0, double beta = 0.0,
+                                   core::ThreadPool& pool = core::ThreadPool::shared());
+
+/**
+ * @brief Matrix product
+ * @return a * b
+ * @throws std::invalid_argument if a.cols() != b.rows()
+ */
+template<MatrixElement T>
+[[nodiscard]] Matrix<T> operator*(const Matrix<T>& a, const Matrix<T>& b) {
+    Matrix<T> c(a.rows(), b.cols());
+    multiply(a.view(), b.view(), c.view());
+    return c;
+}
+
+/**
+ * @brief Maximum number of threads one multiply() may use
+ *
+ * The pool's size caps it as well.
+ *
+ * @return Thread limit, defaults to std::thread::hardware_concurrency()
+ */
+[[nodiscard]] CPPTEMPLATE_MATH_API std::size_t gemm_threads() noexcept;
+
+/**
+ * @brief Set the maximum number of threads one multiply() may use
+ * @param threads Thread limit, 0 to restore the default
+ */
+CPPTEMPLATE_MATH_API void set_gemm_threads(std::size_t threads) noexcept;
+
+} // namespace cpptemplate::math
@@ -0,0 +1,360 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "matrix_view.hpp"
+
+namespace cpptemplate::math {
+
+template<MatrixElement T>
+class Matrix;
+
+namespace detail {
+
+/// Common base of expression nodes, used to recognise them
+struct MatrixExpressionTag {};
+
+} // namespace detail
+
+/**
+ * @brief Lazily evaluated elementwise matrix expression
+ *
+ * Expressions provide value_type, rows(), cols() and element access
+ * `expr(i, j)`; nothing is computed until they are assigned to a Matrix or
+ * eval() is called.
+ */
+template<typename E>
+concept MatrixExpression = std::derived_from<std::remove_cvref_t<E>, detail::MatrixExpressionTag>;
+
+/**
+ * @brief CRTP base of expression nodes
+ * @tparam Derived Node type
+ */
+template<typename Derived>
+class MatrixExpressionBase : public detail::MatrixExpressionTag {
+public:
+    /**
+     * @brief Evaluate into a new matrix in one pass
+     * @return Matrix<value_type> holding the result
+     */
+    [[nodiscard]] auto eval() const;
+};
+
+namespace detail {
+
+/// Leaf reading a matrix or view that outlives the expression
+template<MatrixElement T>
+class ViewLeaf : public MatrixExpressionBase<ViewLeaf<T>> {
+public:
+    using value_type = T;
+
+    explicit ViewLeaf(MatrixView<const T> view) noexcept : view_(view) {}
+
+    [[nodiscard]] std::size_t rows() const noexcept {
+        return view_.rows();
+    }
+
+    [[nodiscard]] std::size_t cols() const noexcept {
+        return view_.cols();
+    }
+
+    [[nodiscard]] T operator()(std::size_t i, std::size_t j) const noexcept {
+        return view_(i, j);
+    }
+
+private:
+    MatrixView<const T> view_;
+};
+
+/// Leaf owning a temporary matrix (e.g. a product) so the expression cannot dangle
+template<MatrixElement T>
+class OwnedLeaf : public MatrixExpressionBase<OwnedLeaf<T>> {
+public:
+    using value_type = T;
+
+    explicit OwnedLeaf(Matrix<T>&& matrix) noexcept : matrix_(std::move(matrix)) {}
+
+    [[nodiscard]] std::size_t rows() const noexcept {
+        return matrix_.rows();
+    }
+
+    [[nodiscard]] std::size_t cols() const noexcept {
+        return matrix_.cols();
+    }
+
+    [[nodiscard]] T operator()(std::size_t i, std::size_t j) const noexcept {
+        return matrix_(i, j);
+    }
+
+private:
+    Matrix<T> matrix_;
+};
+
+/// Scalar operand, broadcast to every element
+template<MatrixElement T>
+struct ScalarLeaf {
+    T value;
+};
+
+struct Plus {
+    template<typename T>
+    static T apply(T a, T b) noexcept {
+        return a + b;
+    }
+};
+
+struct Minus {
+    template<typename T>
+    static T apply(T a, T b) noexcept {
+        return a - b;
+    }
+};
+
+struct Multiplies {
+    template<typename T>
+    static T apply(T a, T b) noexcept {
+        return a * b;
+    }
+};
+
+struct Divides {
+    template<typename T>
+    static T apply(T a, T b) noexcept {
+        return a / b;
+    }
+};
+
+struct Negate {
+    template<typename T>
+    static T apply(T a) noexcept {
+        return -a;
+    }
+};
+
+template<typename Operand>
+auto element(const Operand& operand, std::size_t i, std::size_t j) noexcept {
+    if constexpr (MatrixExpression<Operand>) {
+        return operand(i, j);
+    } else {
+        return operand.value;
+    }
+}
+
+/// Elementwise binary node; at most one side is a ScalarLeaf
+template<typename Op, typename L, typename R>
+class BinaryExpr : public MatrixExpressionBase<BinaryExpr<Op, L, R>> {
+public:
+    using value_type =
+        typename std::conditional_t<MatrixExpression<L>, L, R>::value_type;
+
+    BinaryExpr(L lhs, R rhs) : lhs_(std::move(lhs)), rhs_(std::move(rhs)) {
+        if constexpr (MatrixExpression<L> && MatrixExpression<R>) {
+            if (lhs_.rows() != rhs_.rows() || lhs_.cols() != rhs_.cols()) {
+                throw std::invalid_argument("Matrix dimensions do not match for elementwise operation");
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t rows() const noexcept {
+        return shape().rows();
+    }
+
+    [[nodiscard]] std::size_t cols() const noexcept {
+        return shape().cols();
+    }
+
+    [[nodiscard]] value_type operator()(std::size_t i, std::size_t j) const noexcept {
+        return Op::apply(element(lhs_, i, j), element(rhs_, i, j));
+    }
+
+private:
+    [[nodiscard]] const auto& shape() const noexcept {
+        if constexpr (MatrixExpression<L>) {
+            return lhs_;
+        } else {
+            return rhs_;
+        }
+    }
+
+    L lhs_;
+    R rhs_;
+};
+
+/// Elementwise unary node
+template<typename Op, typename E>
+class UnaryExpr : public MatrixExpressionBase<UnaryExpr<Op, E>> {
+public:
+    using value_type = typename E::value_type;
+
+    explicit UnaryExpr(E operand) : operand_(std::move(operand)) {}
+
+    [[nodiscard]] std::size_t rows() const noexcept {
+        return operand_.rows();
+    }
+
+    [[nodiscard]] std::size_t cols() const noexcept {
+        return operand_.cols();
+    }
+
+    [[nodiscard]] value_type operator()(std::size_t i, std::size_t j) const noexcept {
+        return Op::apply(operand_(i, j));
+    }
+
+private:
+    E operand_;
+};
+
+// Operands become expression nodes: lvalue matrices and views by reference,
+// temporary matrices by value, expressions as themselves
+
+template<MatrixElement T>
+ViewLeaf<T> as_expression(const Matrix<T>& matrix) noexcept {
+    return ViewLeaf<T>(matrix.view());
+}
+
+template<MatrixElement T>
+OwnedLeaf<T> as_expression(Matrix<T>&& matrix) noexcept {
+    return OwnedLeaf<T>(std::move(matrix));
+}
+
+template<MatrixElement T>
+ViewLeaf<T> as_expression(MatrixView<T> view) noexcept {
+    return ViewLeaf<T>(view);
+}
+
+template<MatrixElement T>
+ViewLeaf<T> as_expression(MatrixView<const T> view) noexcept {
+    return ViewLeaf<T>(view);
+}
+
+template<MatrixExpression E>
+std::remove_cvref_t<E> as_expression(E&& expression) {
+    return std::forward<E>(expression);
+}
+
+/// Write every element of expression into out, row by row
+template<MatrixExpression E, MatrixElement T>
+void evaluate(const E& expression, MatrixView<T> out) noexcept {
+    const std::size_t cols = out.cols();
+    for (std::size_t i = 0; i < out.rows(); ++i) {
+        T* row = out.data() + i * out.stride();
+        for (std::size_t j = 0; j < cols; ++j) {
+            row[j] = expression(i, j);
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Types usable as operands of elementwise matrix operators
+ *
+ * Matrix, MatrixView and expressions.
+ */
+template<typename E>
+concept MatrixOperand = requires(E&& operand) { detail::as_expression(std::forward<E>(operand)); };
+
+/// Expression node type an operand becomes
+template<MatrixOperand E>
+using matrix_expression_t = decltype(detail::as_expression(std::declval<E>()));
+
+/// Element type of an operand
+template<MatrixOperand E>
+using matrix_value_t = typename matrix_expression_t<E>::value_type;
+
+/**
+ * @brief Elementwise sum, evaluated lazily
+ * @throws std::invalid_argument if the shapes differ
+ */
+template<MatrixOperand L, MatrixOperand R>
+    requires std::same_as<matrix_value_t<L>, matrix_value_t<R>>
+[[nodiscard]] auto operator+(L&& lhs, R&& rhs) {
+    return detail::BinaryExpr<detail::Plus, matrix_expression_t<L>, matrix_expression_t<R>>(
+        detail::as_expression(std::forward<L>(lhs)), detail::as_expression(std::forward<R>(rhs)));
+}
+
+/**
+ * @brief Elementwise difference, evaluated lazily
+ * @throws std::invalid_argument if the shapes differ
+ */
+template<MatrixOperand L, MatrixOperand R>
+    requires std::same_as<matrix_value_t<L>, matrix_value_t<R>>
+[[nodiscard]] auto operator-(L&& lhs, R&& rhs) {
+    return detail::BinaryExpr<detail::Minus, matrix_expression_t<L>, matrix_expression_t<R>>(
+        detail::as_expression(std::forward<L>(lhs)), detail::as_expression(std::forward<R>(rhs)));
+}
+
+/**
+ * @brief Elementwise (Hadamard) product, evaluated lazily
+ *
+ * operator* between two matrices is the matrix product; this is the
+ * elementwise one.
+ *
+ * @throws std::invalid_argument if the shapes differ
+ */
+template<MatrixOperand L, MatrixOperand R>
+    requires std::same_as<matrix_value_t<L>, matrix_value_t<R>>
+[[nodiscard]] auto hadamard(L&& lhs, R&& rhs) {
+    return detail::BinaryExpr<detail::Multiplies, matrix_expression_t<L>, matrix_expression_t<R>>(
+        detail::as_expression(std::forward<L>(lhs)), detail::as_expression(std::forward<R>(rhs)));
+}
+
+/// Scale every element, evaluated lazily
+template<MatrixOperand E, typename S>
+    requires std::is_arithmetic_v<S>
+[[nodiscard]] auto operator*(E&& matrix, S scalar) {
+    using T = matrix_value_t<E>;
+    return detail::BinaryExpr<detail::Multiplies, matrix_expression_t<E>, detail::ScalarLeaf<T>>(
+        detail::as_expression(std::forward<E>(matrix)), detail::ScalarLeaf<T>{static_cast<T>(scalar)});
+}
+
+/// Scale every element, evaluated lazily
+template<typename S, MatrixOperand E>
+    requires std::is_arithmetic_v<S>
+[[nodiscard]] auto operator*(S scalar, E&& matrix) {
+    using T = matrix_value_t<E>;
+    return detail::BinaryExpr<detail::Multiplies, detail::ScalarLeaf<T>, matrix_expression_t<E>>(
+        detail::ScalarLeaf<T>{static_cast<T>(scalar)}, detail::as_expression(std::forward<E>(matrix)));
+}
+
+/// Divide every element by a scalar, evaluated lazily
+template<MatrixOperand E, typename S>
+    requires std::is_arithmetic_v<S>
+[[nodiscard]] auto operator/(E&& matrix, S scalar) {
+    using T = matrix_value_t<E>;
+    return detail::BinaryExpr<detail::Divides, matrix_expression_t<E>, detail::ScalarLeaf<T>>(
+        detail::as_expression(std::forward<E>(matrix)), detail::ScalarLeaf<T>{static_cast<T>(scalar)});
+}
+
+/// Negate every element, evaluated lazily
+template<MatrixOperand E>
+[[nodiscard]] auto operator-(E&& matrix) {
+    return detail::UnaryExpr<detail::Negate, matrix_expression_t<E>>(
+        detail::as_expression(std::forward<E>(matrix)));
+}
+
+/**
+ * @brief Evaluate an expression into an existing view, e.g. a block
+ *
+ * The expression may read the elements it overwrites (`x = x * 2`), but
+ * must not read other elements of the view.
+ *
+ * @param out Destination
+ * @param expression Expression with the same shape as out
+ * @throws std::invalid_argument if the shapes differ
+ */
+template<MatrixElement T, MatrixOperand E>
+    requires std::same_as<matrix_value_t<E>, T>
+void assign(MatrixView<T> out, E&& expression) {
+    const auto node = detail::as_expression(std::forward<E>(expression));
+    if (node.rows() != out.rows() || node.cols() != out.cols()) {
+        throw std::invalid_argument("Matrix dimensions do not match for assignment");
+    }
+    detail::evaluate(node, out);
+}
+
+} // namespace cpptemplate::math
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+namespace cpptemplate::math {
+
+/**
+ * @brief Element types supported by Matrix
+ */
+template<typename T>
+concept MatrixElement = std::same_as<T, float> || std::same_as<T, double>;
+
+/**
+ * @brief Non-owning view of a row-major matrix
+ *
+ * Rows are `stride` elements apart, so a view can describe a block of a
+ * larger matrix without copying. MatrixView<const T> is the read-only form;
+ * a MatrixView<T> converts to it implicitly.
+ *
+ * @tparam T Element type, optionally const-qualified
+ */
+template<typename T>
+class MatrixView {
+public:
+    using value_type = std::remove_const_t<T>;
+
+    constexpr MatrixView() noexcept = default;
+
+    /**
+     * @brief View rows x cols elements whose rows are stride elements apart
+     * @throws std::invalid_argument if stride < cols
+     */
+    constexpr MatrixView(T* data, std::size_t rows, std::size_t cols, std::size_t stride)
+        : data_(data), rows_(rows), cols_(cols), stride_(stride) {
+        if (stride < cols) {
+            throw std::invalid_argument("Matrix view stride must be at least the column count");
+        }
+    }
+
+    /**
+     * @brief View densely packed rows x cols elements
+     */
+    constexpr MatrixView(T* data, std::size_t rows, std::size_t cols) noexcept
+        : data_(data), rows_(rows), cols_(cols), stride_(cols) {}
+
+    template<typename U>
+        requires(std::same_as<const U, T> && !std::same_as<U, T>)
+    constexpr MatrixView(MatrixView<U> other) noexcept // NOLINT(google-explicit-constructor)
+        : data_(other.data()), rows_(other.rows()), cols_(other.cols()), stride_(other.stride()) {}
+
+    [[nodiscard]] constexpr std::size_t rows() const noexcept {
+        return rows_;
+    }
+
+    [[nodiscard]] constexpr std::size_t cols() const noexcept {
+        return cols_;
+    }
+
+    /// Distance between the starts of consecutive rows, in elements
+    [[nodiscard]] constexpr std::size_t stride() const noexcept {
+        return stride_;
+    }
+
+    [[nodiscard]] constexpr bool empty() const noexcept {
+        return rows_ == 0 || cols_ == 0;
+    }
+
+    [[nodiscard]] constexpr T* data() const noexcept {
+        return data_;
+    }
+
+    /// Unchecked element access
+    [[nodiscard]] constexpr T& operator()(std::size_t row, std::size_t col) const noexcept {
+        return data_[row * stride_ + col];
+    }
+
+    /// Unchecked row access
+    [[nodiscard]] constexpr std::span<T> row(std::size_t row) const noexcept {
+        return {data_ + row * stride_, cols_};
+    }
+
+    /**
+     * @brief View a rectangular block of this view
+     * @param row First row of the block
+     * @param col First column of the block
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @return View sharing this view's storage and stride
+     * @throws std::out_of_range if the block does not fit
+     */
+    [[nodiscard]] constexpr MatrixView block(std::size_t row, std::size_t col, std::size_t rows,
+                                             std::size_t cols) const {
+        if (row > rows_ || rows > rows_ - row || col > cols_ || cols > cols_ - col) {
+            throw std::out_of_range("Matrix block out of range");
+        }
+        return MatrixView(data_ + row * stride_ + col, rows, cols, stride_);
+    }
+
+private:
+    T* data_ = nullptr;
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    std::size_t stride_ = 0;
+};
+
+} // namespace cpptemplate::math
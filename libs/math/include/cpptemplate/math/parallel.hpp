@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "calculator.hpp" // For export macros
+#include "cpptemplate/core/thread_pool.hpp"
+
+namespace cpptemplate::math {
+
+/**
+ * @brief Result of parallel_min_max()
+ */
+struct MinMax {
+    double min;
+    double max;
+    std::size_t argmin; ///< Index of the first occurrence of min
+    std::size_t argmax; ///< Index of the first occurrence of max
+};
+
+/**
+ * @brief Sum of all values, pairwise for accuracy
+ *
+ * Values are split into fixed chunks regardless of the pool size, each
+ * summed pairwise, and the chunk sums are added pairwise in order, so the
+ * error grows with log(n) rather than n and the result is bit-identical
+ * for any number of threads.
+ *
+ * @param values Values
+ * @param pool Pool to run on
+ * @return Sum, 0 if values is empty
+ */
+[[nodiscard]] CPPTEMPLATE_MATH_API double parallel_sum(std::span<const double> values,
+                                                       core::ThreadPool& pool = core::ThreadPool::shared());
+
+/**
+ * @brief Dot product, summed pairwise like parallel_sum()
+ * @param a First operand
+ * @param b Second operand
+ * @param pool Pool to run on
+ * @return Sum of a[i] * b[i]
+ * @throws std::invalid_argument if the sizes differ
+ */
+[[nodiscard]] CPPTEMPLATE_MATH_API double parallel_dot(std::span<const double> a, std::span<const double> b,
+                                                       core::ThreadPool& pool = core::ThreadPool::shared());
+
+/**
+ * @brief Smallest and largest value with their first positions
+ * @param values Values, none of them NaN
+ * @param pool Pool to run on
+ * @return Extremes and their indices
+ * @throws std::invalid_argument if values is empty
+ */
+[[nodiscard]] CPPTEMPLATE_MATH_API MinMax parallel_min_max(std::span<const double> values,
+                                                           core::ThreadPool& pool = core::ThreadPool::shared());
+
+/**
+ * @brief Count values in equal-width bins over [low, high]
+ *
+ * Bin i covers [low + i * w, low + (i + 1) * w) with w = (high - low) / bins;
+ * high itself falls in the last bin. Values outside [low, high] and NaN are
+ * not counted.
+ *
+ * @param values Values
+ * @param low Lower edge of the first bin
+ * @param high Upper edge of the last bin
+ * @param bins Number of bins
+ * @param pool Pool to run on
+ * @return Count per bin
+ * @throws std::invalid_argument if bins is 0 or low >= high
+ */
+[[nodiscard]] CPPTEMPLATE_MATH_API std::vector<std::uint64_t> parallel_histogram(
+    std::span<const double> values, double low, double high, std::size_t bins,
+    core::ThreadPool& pool = core::ThreadPool::shared());
+
+/**
+ * @brief Sort ascending in place
+ *
+ * Sorts one run per thread, then merges pairs of runs with the output of
+ * every merge split between threads, so all threads stay busy to the last
+ * round. Needs a temporary buffer the size of values.
+ *
+ * @param values Values, none of them NaN
+ * @param pool Pool to run on
+ */
+CPPTEMPLATE_MATH_API void parallel_sort(std::span<double> values,
+                                        core::ThreadPool& pool = core::ThreadPool::shared());
+
+} // namespace cpptemplate::math
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "calculator.hpp" // For export macros
+
+namespace cpptemplate::math {
+
+namespace detail {
+
+/**
+ * @brief Logarithmic value-to-bin mapping of a DDSketch
+ *
+ * Bin i covers magnitudes (gamma^(i-1), gamma^i] with
+ * gamma = (1 + a) / (1 - a); reporting 2 gamma^i / (gamma + 1) for every
+ * value in the bin is off by at most a relative to the true value.
+ */
+struct CPPTEMPLATE_MATH_API LogMapping {
+    explicit LogMapping(double relative_accuracy);
+
+    /// Bin of a magnitude >= min_indexable
+    [[nodiscard]] std::int32_t index(double magnitude) const noexcept {
+        return static_cast<std::int32_t>(std::ceil(std::log(magnitude) * multiplier));
+    }
+
+    /// Representative magnitude of a bin
+    [[nodiscard]] double value(std::int32_t index) const noexcept {
+        return std::exp(static_cast<double>(index) / multiplier) * representative_scale;
+    }
+
+    double relative_accuracy;
+    double multiplier;           ///< 1 / ln(gamma)
+    double representative_scale; ///< 2 / (gamma + 1)
+    double min_indexable;        ///< Smaller magnitudes count as zero
+};
+
+} // namespace detail
+
+/**
+ * @brief Mergeable quantile sketch with a relative-error guarantee (DDSketch)
+ *
+ * Counts samples in logarithmically sized bins, so any quantile it reports
+ * is within relative_accuracy of the true sample at that rank (p99 of a
+ * 100 ms latency comes back as 99..101 ms at 1%), independent of the
+ * distribution. Memory is bounded by max_bins per sign; a stream spanning
+ * more bins than that collapses its smallest magnitudes first, so upper
+ * percentiles keep the guarantee.
+ *
+ * 1% accuracy covers 1 ns..1 h in about 1450 bins. Sketches with the same
+ * accuracy merge exactly: keep one per thread and merge() them, or feed a
+ * ConcurrentQuantileSketch. Non-finite samples are ignored.
+ *
+ * @example
+ * ```cpp
+ * QuantileSketch latency(0.01);
+ * for (double ms : samples) {
+ *     latency.add(ms);
+ * }
+ * log.info("p50 {} p99 {} p999 {}", latency.quantile(0.5), latency.quantile(0.99),
+ *          latency.quantile(0.999));
+ * auto bytes = latency.serialize(); // A few KiB, send to an aggregator
+ * ```
+ */
+class CPPTEMPLATE_MATH_API QuantileSketch {
+public:
+    /// Default bin limit per sign
+    static constexpr std::size_t DefaultMaxBins = 2048;
+
+    /**
+     * @brief Create an empty sketch
+     * @param relative_accuracy Maximum relative error of reported quantiles, in [1e-6, 1)
+     * @param max_bins Bin limit per sign, trading memory for range
+     * @throws std::invalid_argument if relative_accuracy is out of range or max_bins is 0
+     */
+    explicit QuantileSketch(double relative_accuracy = 0.01, std::size_t max_bins = DefaultMaxBins);
+
+    /**
+     * @brief Add one sample
+     * @param value Sample
+     */
+    void add(double value) {
+        add(value, 1);
+    }
+
+    /**
+     * @brief Add a sample several times
+     * @param value Sample
+     * @param count Number of occurrences
+     */
+    void add(double value, std::uint64_t count);
+
+    /**
+     * @brief Add every sample of a span
+     * @param values Samples
+     */
+    void add(std::span<const double> values);
+
+    /**
+     * @brief Fold another sketch's samples into this one
+     * @param other Sketch with the same relative accuracy
+     * @throws std::invalid_argument if the accuracies differ
+     */
+    void merge(const QuantileSketch& other);
+
+    /**
+     * @brief Approximate sample at a rank
+     * @param q Quantile, 0 for the minimum and 1 for the maximum
+     * @return Sample within relative_accuracy() of the exact quantile, NaN if empty
+     * @throws std::invalid_argument if q is not in [0, 1]
+     */
+    [[nodiscard]] double quantile(double q) const;
+
+    /**
+     * @brief Forget all samples, keeping the configuration
+     */
+    void reset() noexcept;
+
+    /// Number of samples
+    [[nodiscard]] std::uint64_t count() const noexcept {
+        return count_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return count_ == 0;
+    }
+
+    /// Exact sum of the samples
+    [[nodiscard]] double sum() const noexcept {
+        return sum_;
+    }
+
+    /// Exact smallest sample, +infinity if empty
+    [[nodiscard]] double min() const noexcept {
+        return min_;
+    }
+
+    /// Exact largest sample, -infinity if empty
+    [[nodiscard]] double max() const noexcept {
+        return max_;
+    }
+
+    [[nodiscard]] double relative_accuracy() const noexcept {
+        return mapping_.relative_accuracy;
+    }
+
+    [[nodiscard]] std::size_t max_bins() const noexcept {
+        return max_bins_;
+    }
+
+    /// Bins currently allocated, a measure of memory use
+    [[nodiscard]] std::size_t bin_count() const noexcept {
+        return positive_.bins.size() + negative_.bins.size();
+    }
+
+    /**
+     * @brief Encode as a compact byte string (varint bin counts)
+     * @return Bytes accepted by deserialize()
+     */
+    [[nodiscard]] std::vector<std::byte> serialize() const;
+
+    /**
+     * @brief Decode a sketch written by serialize()
+     * @param bytes Encoded sketch
+     * @return Sketch
+     * @throws std::invalid_argument if bytes is not a valid encoding
+     */
+    [[nodiscard]] static QuantileSketch deserialize(std::span<const std::byte> bytes);
+
+private:
+    friend class ConcurrentQuantileSketch;
+
+    /// Dense counts of consecutive bins starting at offset
+    struct Store {
+        void add(std::int32_t index, std::uint64_t count, std::size_t max_bins, bool collapse_high) {
+            const auto slot = static_cast<std::size_t>(static_cast<std::int64_t>(index) - offset);
+            if (slot < bins.size()) {
+                bins[slot] += count;
+                return;
+            }
+            grow(index, count, max_bins, collapse_high);
+        }
+
+        void grow(std::int32_t index, std::uint64_t count, std::size_t max_bins, bool collapse_high);
+
+        std::vector<std::uint64_t> bins;
+        std::int32_t offset = 0;
+    };
+
+    void add_bin(bool negative, std::int32_t index, std::uint64_t count);
+
+    detail::LogMapping mapping_;
+    std::size_t max_bins_;
+    Store positive_;
+    Store negative_; ///< Indexed by magnitude; collapses its highest bins, the lowest values
+    std::uint64_t zero_count_ = 0;
+    std::uint64_t count_ = 0;
+    double sum_ = 0.0;
+    double min_ = std::numeric_limits<double>::infinity();
+    double max_ = -std::numeric_limits<double>::infinity();
+};
+
+/**
+ * @brief Quantile sketch that many threads update without locks
+ *
+ * Preallocates one atomic counter per bin for magnitudes in
+ * [min_magnitude, max_magnitude]; add() and merge() are relaxed atomic
+ * increments, so recording threads never block each other or a reader
+ * taking a snapshot(). Magnitudes outside the range are counted in the
+ * nearest bin, so their quantiles lose the accuracy guarantee (min() and
+ * max() of the snapshot stay exact).
+ *
+ * Under heavy contention, recording into a thread-local QuantileSketch and
+ * merging it periodically avoids sharing cache lines on every sample.
+ */
+class CPPTEMPLATE_MATH_API ConcurrentQuantileSketch {
+public:
+    /**
+     * @brief Create an empty sketch
+     * @param relative_accuracy Maximum relative error, in [1e-6, 1)
+     * @param min_magnitude Smallest magnitude counted accurately
+     * @param max_magnitude Largest magnitude counted accurately
+     * @throws std::invalid_argument if the accuracy or range is invalid
+     */
+    explicit ConcurrentQuantileSketch(double relative_accuracy = 0.01, double min_magnitude = 1e-9,
+                                      double max_magnitude = 1e9);
+
+    /**
+     * @brief Add one sample; lock-free and thread-safe
+     * @param value Sample, ignored if not finite
+     */
+    void add(double value) noexcept;
+
+    /**
+     * @brief Fold a sketch's samples in; lock-free and thread-safe
+     * @param sketch Sketch with the same relative accuracy
+     * @throws std::invalid_argument if the accuracies differ
+     */
+    void merge(const QuantileSketch& sketch);
+
+    /**
+     * @brief Copy the current counts into a QuantileSketch
+     *
+     * Updates racing with the copy may be partly included, e.g. min, max and
+     * sum can run ahead of the bin counts; quiesce writers for an exact
+     * cut.
+     *
+     * @return Sketch for querying, merging or serializing
+     */
+    [[nodiscard]] QuantileSketch snapshot() const;
+
+    [[nodiscard]] double relative_accuracy() const noexcept {
+        return mapping_.relative_accuracy;
+    }
+
+private:
+    void add_bin(bool negative, std::int32_t index, std::uint64_t count) noexcept;
+    void update_bounds(double min, double max, double sum) noexcept;
+
+    detail::LogMapping mapping_;
+    std::int32_t min_index_;
+    std::size_t bins_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> positive_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> negative_;
+    std::atomic<std::uint64_t> zero_count_{0};
+    std::atomic<double> sum_{0.0};
+    std::atomic<double> min_{std::numeric_limits<double>::infinity()};
+    std::atomic<double> max_{-std::numeric_limits<double>::infinity()};
+};
+
+} // namespace cpptemplate::math
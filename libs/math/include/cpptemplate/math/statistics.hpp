@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "calculator.hpp" // For export macros
+
+namespace cpptemplate::math {
+
+/**
+ * @brief Single-pass descriptive statistics over an unbounded stream
+ *
+ * Keeps count, mean, the second to fourth central moment sums, min and max:
+ * O(1) memory however many samples are added. Single samples use the
+ * Welford/Terriberry update; spans are summarized in cache-sized blocks by
+ * SIMD kernels (see simd.hpp) and folded in with the same merge formula
+ * used by merge(), so results match the sample-by-sample update to
+ * rounding.
+ *
+ * Accumulators are independent values: keep one per thread and merge()
+ * them at the end. Samples must not be NaN.
+ *
+ * @example
+ * ```cpp
+ * RunningStats latency;
+ * for (double sample : batch) {
+ *     latency.add(sample);
+ * }
+ * latency.add(std::span<const double>(more_samples));
+ * log.info("mean {} stddev {}", latency.mean(), latency.stddev());
+ * ```
+ */
+class CPPTEMPLATE_MATH_API RunningStats {
+public:
+    /**
+     * @brief Add one sample
+     * @param value Sample
+     */
+    void add(double value) noexcept {
+        const double n1 = static_cast<double>(count_);
+        ++count_;
+        const double n = static_cast<double>(count_);
+        const double delta = value - mean_;
+        const double delta_n = delta / n;
+        const double delta_n2 = delta_n * delta_n;
+        const double term = delta * delta_n * n1;
+        mean_ += delta_n;
+        m4_ += term * delta_n2 * (n * n - 3.0 * n + 3.0) + 6.0 * delta_n2 * m2_ -
+               4.0 * delta_n * m3_;
+        m3_ += term * delta_n * (n - 2.0) - 3.0 * delta_n * m2_;
+        m2_ += term;
+        min_ = value < min_ ? value : min_;
+        max_ = value > max_ ? value : max_;
+    }
+
+    /**
+     * @brief Add every sample of a span, vectorized
+     * @param values Samples
+     */
+    void add(std::span<const double> values) noexcept;
+
+    /**
+     * @brief Fold another accumulator's samples into this one
+     *
+     * The result is the same as if all samples had been added to one
+     * accumulator (Chan/Pébay pairwise update).
+     *
+     * @param other Accumulator to merge
+     */
+    void merge(const RunningStats& other) noexcept;
+
+    /**
+     * @brief Forget all samples
+     */
+    void reset() noexcept {
+        *this = RunningStats{};
+    }
+
+    /// Number of samples
+    [[nodiscard]] std::uint64_t count() const noexcept {
+        return count_;
+    }
+
+    /// Arithmetic mean, 0 without samples
+    [[nodiscard]] double mean() const noexcept {
+        return mean_;
+    }
+
+    /// Sum of all samples
+    [[nodiscard]] double sum() const noexcept {
+        return mean_ * static_cast<double>(count_);
+    }
+
+    /// Population variance, 0 with fewer than 2 samples
+    [[nodiscard]] double variance() const noexcept {
+        return count_ < 2 ? 0.0 : m2_ / static_cast<double>(count_);
+    }
+
+    /// Unbiased sample variance (n - 1 denominator), 0 with fewer than 2 samples
+    [[nodiscard]] double sample_variance() const noexcept {
+        return count_ < 2 ? 0.0 : m2_ / static_cast<double>(count_ - 1);
+    }
+
+    /// Population standard deviation
+    [[nodiscard]] double stddev() const noexcept {
+        return std::sqrt(variance());
+    }
+
+    /// Sample standard deviation
+    [[nodiscard]] double sample_stddev() const noexcept {
+        return std::sqrt(sample_variance());
+    }
+
+    /// Population skewness g1, 0 if the samples do not vary
+    [[nodiscard]] double skewness() const noexcept {
+        if (m2_ <= 0.0) {
+            return 0.0;
+        }
+        return std::sqrt(static_cast<double>(count_)) * m3_ / std::pow(m2_, 1.5);
+    }
+
+    /// Population excess kurtosis g2 (0 for a normal distribution), 0 if the samples do not vary
+    [[nodiscard]] double kurtosis() const noexcept {
+        if (m2_ <= 0.0) {
+            return 0.0;
+        }
+        return static_cast<double>(count_) * m4_ / (m2_ * m2_) - 3.0;
+    }
+
+    /// Smallest sample, +infinity without samples
+    [[nodiscard]] double min() const noexcept {
+        return min_;
+    }
+
+    /// Largest sample, -infinity without samples
+    [[nodiscard]] double max() const noexcept {
+        return max_;
+    }
+
+private:
+    void merge(std::uint64_t count, double mean, double m2, double m3, double m4, double min,
+               double max) noexcept;
+
+    std::uint64_t count_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0; ///< Sum of squared deviations from the mean
+    double m3_ = 0.0; ///< Sum of cubed deviations
+    double m4_ = 0.0; ///< Sum of fourth-power deviations
+    double min_ = std::numeric_limits<double>::infinity();
+    double max_ = -std::numeric_limits<double>::infinity();
+};
+
+} // namespace cpptemplate::math
@@ -0,0 +1,286 @@
+#include "batch_kernels.hpp"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if CPPTEMPLATE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+namespace cpptemplate::math::detail {
+
+namespace {
+
+constexpr double DivisorEpsilon = std::numeric_limits<double>::epsilon();
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+// Scalar kernels: plain loops the compiler vectorizes for the baseline ISA
+
+void add_scalar(const double* a, const double* b, double* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+void subtract_scalar(const double* a, const double* b, double* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = a[i] - b[i];
+    }
+}
+
+void multiply_scalar(const double* a, const double* b, double* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+std::size_t divide_scalar(const double* a, const double* b, double* out, std::uint8_t* errors,
+                          std::size_t n) noexcept {
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const bool bad = std::abs(b[i]) < DivisorEpsilon;
+        out[i] = bad ? NaN : a[i] / b[i];
+        failed += bad ? 1 : 0;
+        if (errors != nullptr) {
+            errors[i] = bad ? 1 : 0;
+        }
+    }
+    return failed;
+}
+
+void power_scalar(const double* base, const double* exponent, double* out,
+                  std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = std::pow(base[i], exponent[i]);
+    }
+}
+
+std::size_t sqrt_scalar(const double* values, double* out, std::uint8_t* errors,
+                        std::size_t n) noexcept {
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const bool bad = values[i] < 0.0;
+        out[i] = bad ? NaN : std::sqrt(values[i]);
+        failed += bad ? 1 : 0;
+        if (errors != nullptr) {
+            errors[i] = bad ? 1 : 0;
+        }
+    }
+    return failed;
+}
+
+constexpr BatchKernels ScalarKernels{
+    add_scalar, subtract_scalar, multiply_scalar, divide_scalar, power_scalar, sqrt_scalar,
+};
+
+#if CPPTEMPLATE_X86_KERNELS
+
+/// Lane mask bit i -> byte i set to 1, for writing error flags of a vector
+constexpr auto MaskBytes = [] {
+    std::array<std::uint64_t, 256> table{};
+    for (std::size_t mask = 0; mask < table.size(); ++mask) {
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            if ((mask >> lane) & 1U) {
+                table[mask] |= std::uint64_t{1} << (lane * 8);
+            }
+        }
+    }
+    return table;
+}();
+
+inline void store_error_flags(std::uint8_t* errors, unsigned mask, std::size_t lanes) noexcept {
+    // Little-endian: byte i of the table entry is lane i
+    std::memcpy(errors, &MaskBytes[mask], lanes);
+}
+
+// AVX2 kernels: 4 doubles per vector, scalar tail
+
+CPPTEMPLATE_AVX2 void add_avx2(const double* a, const double* b, double* out,
+                               std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    add_scalar(a + i, b + i, out + i, n - i);
+}
+
+CPPTEMPLATE_AVX2 void subtract_avx2(const double* a, const double* b, double* out,
+                                    std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    subtract_scalar(a + i, b + i, out + i, n - i);
+}
+
+CPPTEMPLATE_AVX2 void multiply_avx2(const double* a, const double* b, double* out,
+                                    std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    multiply_scalar(a + i, b + i, out + i, n - i);
+}
+
+CPPTEMPLATE_AVX2 std::size_t divide_avx2(const double* a, const double* b, double* out,
+                                         std::uint8_t* errors, std::size_t n) noexcept {
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFF));
+    const __m256d epsilon = _mm256_set1_pd(DivisorEpsilon);
+    const __m256d nan = _mm256_set1_pd(NaN);
+    std::size_t failed = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d divisor = _mm256_loadu_pd(b + i);
+        const __m256d quotient = _mm256_div_pd(_mm256_loadu_pd(a + i), divisor);
+        const __m256d bad =
+            _mm256_cmp_pd(_mm256_and_pd(divisor, abs_mask), epsilon, _CMP_LT_OQ);
+        _mm256_storeu_pd(out + i, _mm256_blendv_pd(quotient, nan, bad));
+        const auto mask = static_cast<unsigned>(_mm256_movemask_pd(bad));
+        failed += static_cast<std::size_t>(std::popcount(mask));
+        if (errors != nullptr) {
+            store_error_flags(errors + i, mask, 4);
+        }
+    }
+    return failed + divide_scalar(a + i, b + i, out + i, errors ? errors + i : nullptr, n - i);
+}
+
+CPPTEMPLATE_AVX2 std::size_t sqrt_avx2(const double* values, double* out, std::uint8_t* errors,
+                                       std::size_t n) noexcept {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d nan = _mm256_set1_pd(NaN);
+    std::size_t failed = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d value = _mm256_loadu_pd(values + i);
+        const __m256d bad = _mm256_cmp_pd(value, zero, _CMP_LT_OQ);
+        _mm256_storeu_pd(out + i, _mm256_blendv_pd(_mm256_sqrt_pd(value), nan, bad));
+        const auto mask = static_cast<unsigned>(_mm256_movemask_pd(bad));
+        failed += static_cast<std::size_t>(std::popcount(mask));
+        if (errors != nullptr) {
+            store_error_flags(errors + i, mask, 4);
+        }
+    }
+    return failed + sqrt_scalar(values + i, out + i, errors ? errors + i : nullptr, n - i);
+}
+
+constexpr BatchKernels Avx2Kernels{
+    add_avx2, subtract_avx2, multiply_avx2, divide_avx2, power_scalar, sqrt_avx2,
+};
+
+// AVX-512 kernels: 8 doubles per vector, tail handled with masked loads/stores
+
+CPPTEMPLATE_AVX512 inline __mmask8 tail_mask(std::size_t remaining) noexcept {
+    return static_cast<__mmask8>((1U << remaining) - 1U);
+}
+
+CPPTEMPLATE_AVX512 void add_avx512(const double* a, const double* b, double* out,
+                                   std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_add_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    }
+    if (i < n) {
+        const __mmask8 m = tail_mask(n - i);
+        _mm512_mask_storeu_pd(out + i, m,
+                              _mm512_add_pd(_mm512_maskz_loadu_pd(m, a + i),
+                                            _mm512_maskz_loadu_pd(m, b + i)));
+    }
+}
+
+CPPTEMPLATE_AVX512 void subtract_avx512(const double* a, const double* b, double* out,
+                                        std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    }
+    if (i < n) {
+        const __mmask8 m = tail_mask(n - i);
+        _mm512_mask_storeu_pd(out + i, m,
+                              _mm512_sub_pd(_mm512_maskz_loadu_pd(m, a + i),
+                                            _mm512_maskz_loadu_pd(m, b + i)));
+    }
+}
+
+CPPTEMPLATE_AVX512 void multiply_avx512(const double* a, const double* b, double* out,
+                                        std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    }
+    if (i < n) {
+        const __mmask8 m = tail_mask(n - i);
+        _mm512_mask_storeu_pd(out + i, m,
+                              _mm512_mul_pd(_mm512_maskz_loadu_pd(m, a + i),
+                                            _mm512_maskz_loadu_pd(m, b + i)));
+    }
+}
+
+/// One vector of divide; inactive lanes of `active` are neither computed nor stored
+CPPTEMPLATE_AVX512 inline unsigned divide_block_avx512(const double* a, const double* b,
+                                                       double* out, __mmask8 active) noexcept {
+    const __m512d divisor = _mm512_maskz_loadu_pd(active, b);
+    const __m512d magnitude = _mm512_castsi512_pd(
+        _mm512_and_epi64(_mm512_castpd_si512(divisor), _mm512_set1_epi64(0x7FFFFFFFFFFFFFFF)));
+    const __mmask8 bad =
+        _mm512_mask_cmp_pd_mask(active, magnitude, _mm512_set1_pd(DivisorEpsilon), _CMP_LT_OQ);
+    const __m512d quotient = _mm512_mask_div_pd(_mm512_set1_pd(NaN), active & ~bad,
+                                                _mm512_maskz_loadu_pd(active, a), divisor);
+    _mm512_mask_storeu_pd(out, active, quotient);
+    return bad;
+}
+
+CPPTEMPLATE_AVX512 std::size_t divide_avx512(const double* a, const double* b, double* out,
+                                             std::uint8_t* errors, std::size_t n) noexcept {
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < n; i += 8) {
+        const std::size_t lanes = n - i < 8 ? n - i : 8;
+        const unsigned mask = divide_block_avx512(a + i, b + i, out + i, tail_mask(lanes));
+        failed += static_cast<std::size_t>(std::popcount(mask));
+        if (errors != nullptr) {
+            store_error_flags(errors + i, mask, lanes);
+        }
+    }
+    return failed;
+}
+
+CPPTEMPLATE_AVX512 std::size_t sqrt_avx512(const double* values, double* out,
+                                           std::uint8_t* errors, std::size_t n) noexcept {
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d nan = _mm512_set1_pd(NaN);
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < n; i += 8) {
+        const std::size_t lanes = n - i < 8 ? n - i : 8;
+        const __mmask8 active = tail_mask(lanes);
+        const __m512d value = _mm512_maskz_loadu_pd(active, values + i);
+        const __mmask8 bad = _mm512_mask_cmp_pd_mask(active, value, zero, _CMP_LT_OQ);
+        _mm512_mask_storeu_pd(out + i, active, _mm512_mask_sqrt_pd(nan, active & ~bad, value));
+        failed += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(bad)));
+        if (errors != nullptr) {
+            store_error_flags(errors + i, bad, lanes);
+        }
+    }
+    return failed;
+}
+
+constexpr BatchKernels Avx512Kernels{
+    add_avx512, subtract_avx512, multiply_avx512, divide_avx512, power_scalar, sqrt_avx512,
+};
+
+#endif // CPPTEMPLATE_X86_KERNELS
+
+} // namespace
+
+const BatchKernels& batch_kernels(core::SimdLevel level) noexcept {
+    switch (level) {
+#if CPPTEMPLATE_X86_KERNELS
+        case core::SimdLevel::Avx512: return Avx512Kernels;
+        case core::SimdLevel::Avx2: return Avx2Kernels;
+#endif
+        default: return ScalarKernels;
+    }
+}
+
+} // namespace cpptemplate::math::detail
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cpptemplate/core/simd.hpp"
+
+namespace cpptemplate::math::detail {
+
+/**
+ * @brief Elementwise kernels for one SimdLevel
+ *
+ * Pointers may alias exactly (in-place operation) but must not otherwise
+ * overlap. `errors` may be null; otherwise it receives 1 for each element
+ * that failed the domain check and 0 for the rest. Failed elements are set
+ * to quiet NaN and the functions return how many there were.
+ */
+struct BatchKernels {
+    void (*add)(const double* a, const double* b, double* out, std::size_t n) noexcept;
+    void (*subtract)(const double* a, const double* b, double* out, std::size_t n) noexcept;
+    void (*multiply)(const double* a, const double* b, double* out, std::size_t n) noexcept;
+    std::size_t (*divide)(const double* a, const double* b, double* out, std::uint8_t* errors,
+                          std::size_t n) noexcept;
+    void (*power)(const double* base, const double* exponent, double* out, std::size_t n) noexcept;
+    std::size_t (*sqrt)(const double* values, double* out, std::uint8_t* errors,
+                        std::size_t n) noexcept;
+};
+
+/**
+ * @brief Get the kernels of a level
+ * @param level Level, which must be supported by the running CPU
+ * @return Kernel table with static storage duration
+ */
+const BatchKernels& batch_kernels(core::SimdLevel level) noexcept;
+
+/**
+ * @brief Get the kernels of the active level
+ * @return Kernel table for core::simd_level()
+ */
+inline const BatchKernels& batch_kernels() noexcept {
+    return batch_kernels(core::simd_level());
+}
+
+} // namespace cpptemplate::math::detail
@@ -3,8 +3,26 @@
 #include <cmath>
 #include <limits>
 
+#include "batch_kernels.hpp"
+
 namespace cpptemplate::math {
 
+namespace {
+
+void check_sizes(std::size_t expected, std::size_t actual) {
+    if (actual != expected) {
+        throw std::invalid_argument("Batch operands must have the same size");
+    }
+}
+
+void check_errors_size(std::size_t expected, std::span<std::uint8_t> errors) {
+    if (!errors.empty()) {
+        check_sizes(expected, errors.size());
+    }
+}
+
+} // namespace
+
 double Calculator::add(double a, double b) const noexcept {
     return a + b;
 }
@@ -24,6 +42,13 @@ double Calculator::divide(double a, double b) const {
     return a / b;
 }
 
+core::Expected<double> Calculator::divide(double a, double b, std::nothrow_t) const noexcept {
+    if (std::abs(b) < std::numeric_limits<double>::epsilon()) {
+        return core::unexpected(core::Errc::DivisionByZero);
+    }
+    return a / b;
+}
+
 double Calculator::power(double base, double exponent) const noexcept {
     return std::pow(base, exponent);
 }
@@ -35,4 +60,56 @@ double Calculator::sqrt(double value) const {
     return std::sqrt(value);
 }
 
-} // namespace cpptemplate::math
\ No newline at end of file
+core::Expected<double> Calculator::sqrt(double value, std::nothrow_t) const noexcept {
+    if (value < 0.0) {
+        return core::unexpected(core::Errc::DomainError);
+    }
+    return std::sqrt(value);
+}
+
+void Calculator::add(std::span<const double> a, std::span<const double> b,
+                     std::span<double> out) const {
+    check_sizes(out.size(), a.size());
+    check_sizes(out.size(), b.size());
+    detail::batch_kernels().add(a.data(), b.data(), out.data(), out.size());
+}
+
+void Calculator::subtract(std::span<const double> a, std::span<const double> b,
+                          std::span<double> out) const {
+    check_sizes(out.size(), a.size());
+    check_sizes(out.size(), b.size());
+    detail::batch_kernels().subtract(a.data(), b.data(), out.data(), out.size());
+}
+
+void Calculator::multiply(std::span<const double> a, std::span<const double> b,
+                          std::span<double> out) const {
+    check_sizes(out.size(), a.size());
+    check_sizes(out.size(), b.size());
+    detail::batch_kernels().multiply(a.data(), b.data(), out.data(), out.size());
+}
+
+std::size_t Calculator::divide(std::span<const double> a, std::span<const double> b,
+                               std::span<double> out, std::span<std::uint8_t> errors) const {
+    check_sizes(out.size(), a.size());
+    check_sizes(out.size(), b.size());
+    check_errors_size(out.size(), errors);
+    return detail::batch_kernels().divide(a.data(), b.data(), out.data(),
+                                          errors.empty() ? nullptr : errors.data(), out.size());
+}
+
+void Calculator::power(std::span<const double> base, std::span<const double> exponent,
+                       std::span<double> out) const {
+    check_sizes(out.size(), base.size());
+    check_sizes(out.size(), exponent.size());
+    detail::batch_kernels().power(base.data(), exponent.data(), out.data(), out.size());
+}
+
+std::size_t Calculator::sqrt(std::span<const double> values, std::span<double> out,
+                             std::span<std::uint8_t> errors) const {
+    check_sizes(out.size(), values.size());
+    check_errors_size(out.size(), errors);
+    return detail::batch_kernels().sqrt(values.data(), out.data(),
+                                        errors.empty() ? nullptr : errors.data(), out.size());
+}
+
+} // namespace cpptemplate::math
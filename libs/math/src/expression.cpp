@@ -0,0 +1,489 @@
+#include "cpptemplate/math/expression.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "batch_kernels.hpp"
+
+namespace cpptemplate::math {
+
+namespace {
+
+using OpCode = Expression::OpCode;
+using Instruction = Expression::Instruction;
+
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+/// Deepest nesting accepted, so hostile input cannot exhaust the stack
+constexpr int MaxDepth = 256;
+
+/// Rows per parallel task
+constexpr std::size_t TaskBlocks = 64;
+
+/// One value, with the batch kernels' domain rules
+double apply(OpCode op, double a, double b) noexcept {
+    switch (op) {
+        case OpCode::Add: return a + b;
+        case OpCode::Subtract: return a - b;
+        case OpCode::Multiply: return a * b;
+        case OpCode::Divide: return std::abs(b) < std::numeric_limits<double>::epsilon() ? NaN : a / b;
+        case OpCode::Power: return std::pow(a, b);
+        case OpCode::Sqrt: return a < 0.0 ? NaN : std::sqrt(a);
+    }
+    return NaN;
+}
+
+/// Expression tree node; children always precede their parents
+struct Node {
+    enum class Kind : std::uint8_t { Variable, Constant, Operation };
+
+    Kind kind;
+    OpCode op = OpCode::Add;
+    std::uint32_t a = 0; ///< Variable index, or first operand node
+    std::uint32_t b = 0; ///< Second operand node
+    double value = 0.0;  ///< Constant value
+};
+
+/**
+ * Recursive-descent parser building a folded, deduplicated tree: constant
+ * operations are evaluated on the spot and structurally equal nodes are
+ * created once
+ */
+class Parser {
+public:
+    explicit Parser(std::string_view text) : text_(text) {}
+
+    std::uint32_t parse() {
+        const std::uint32_t root = expr();
+        skip_space();
+        if (pos_ != text_.size()) {
+            fail();
+        }
+        return root;
+    }
+
+    std::vector<Node> nodes;
+    std::vector<std::string> variables;
+
+private:
+    std::uint32_t expr() {
+        const Nesting nesting(*this);
+        std::uint32_t left = term();
+        while (true) {
+            if (accept('+')) {
+                left = operation(OpCode::Add, left, term());
+            } else if (accept('-')) {
+                left = operation(OpCode::Subtract, left, term());
+            } else {
+                return left;
+            }
+        }
+    }
+
+    std::uint32_t term() {
+        std::uint32_t left = unary();
+        while (true) {
+            if (accept('*')) {
+                left = operation(OpCode::Multiply, left, unary());
+            } else if (accept('/')) {
+                left = operation(OpCode::Divide, left, unary());
+            } else {
+                return left;
+            }
+        }
+    }
+
+    std::uint32_t unary() {
+        const Nesting nesting(*this);
+        if (accept('-')) {
+            // Multiplying by -1 negates exactly, signed zeros included
+            return operation(OpCode::Multiply, unary(), constant(-1.0));
+        }
+        if (accept('+')) {
+            return unary();
+        }
+        return power();
+    }
+
+    std::uint32_t power() {
+        const std::uint32_t base = primary();
+        if (accept('^')) {
+            return operation(OpCode::Power, base, unary());
+        }
+        return base;
+    }
+
+    std::uint32_t primary() {
+        skip_space();
+        if (pos_ == text_.size()) {
+            fail();
+        }
+        const char c = text_[pos_];
+        if ((c >= '0' && c <= '9') || c == '.') {
+            double value = 0.0;
+            const auto [end, error] = std::from_chars(text_.data() + pos_, text_.data() + text_.size(), value);
+            if (error != std::errc{}) {
+                fail();
+            }
+            pos_ = static_cast<std::size_t>(end - text_.data());
+            return constant(value);
+        }
+        if (is_identifier_start(c)) {
+            const std::size_t begin = pos_;
+            while (pos_ < text_.size() && (is_identifier_start(text_[pos_]) || (text_[pos_] >= '0' && text_[pos_] <= '9'))) {
+                ++pos_;
+            }
+            const std::string_view name = text_.substr(begin, pos_ - begin);
+            if (name == "sqrt") {
+                expect('(');
+                const std::uint32_t argument = expr();
+                expect(')');
+                return operation(OpCode::Sqrt, argument, argument);
+            }
+            if (name == "pow") {
+                expect('(');
+                const std::uint32_t base = expr();
+                expect(',');
+                const std::uint32_t exponent = expr();
+                expect(')');
+                return operation(OpCode::Power, base, exponent);
+            }
+            skip_space();
+            if (pos_ < text_.size() && text_[pos_] == '(') {
+                throw std::invalid_argument("Unknown function '" + std::string(name) + "' at position " +
+                                            std::to_string(begin));
+            }
+            return variable(name);
+        }
+        if (accept('(')) {
+            const std::uint32_t inner = expr();
+            expect(')');
+            return inner;
+        }
+        fail();
+    }
+
+    std::uint32_t operation(OpCode op, std::uint32_t a, std::uint32_t b) {
+        if (nodes[a].kind == Node::Kind::Constant && nodes[b].kind == Node::Kind::Constant) {
+            return constant(apply(op, nodes[a].value, nodes[b].value));
+        }
+        // Squares are common in formulas and a multiply is far cheaper than pow
+        if (op == OpCode::Power && nodes[b].kind == Node::Kind::Constant && nodes[b].value == 2.0) {
+            return operation(OpCode::Multiply, a, a);
+        }
+        return intern({Node::Kind::Operation, op, a, b, 0.0}, std::bit_cast<std::uint64_t>(0.0));
+    }
+
+    std::uint32_t constant(double value) {
+        return intern({Node::Kind::Constant, OpCode::Add, 0, 0, value}, std::bit_cast<std::uint64_t>(value));
+    }
+
+    std::uint32_t variable(std::string_view name) {
+        auto it = std::find(variables.begin(), variables.end(), name);
+        if (it == variables.end()) {
+            variables.emplace_back(name);
+            it = variables.end() - 1;
+        }
+        const auto index = static_cast<std::uint32_t>(it - variables.begin());
+        return intern({Node::Kind::Variable, OpCode::Add, index, 0, 0.0}, 0);
+    }
+
+    std::uint32_t intern(const Node& node, std::uint64_t bits) {
+        const auto key = std::make_tuple(node.kind, node.op, node.a, node.b, bits);
+        const auto [it, inserted] = unique_.try_emplace(key, static_cast<std::uint32_t>(nodes.size()));
+        if (inserted) {
+            nodes.push_back(node);
+        }
+        return it->second;
+    }
+
+    static bool is_identifier_start(char c) noexcept {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    void skip_space() noexcept {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+                                       text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool accept(char c) noexcept {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!accept(c)) {
+            fail();
+        }
+    }
+
+    [[noreturn]] void fail() const {
+        if (pos_ >= text_.size()) {
+            throw std::invalid_argument("Unexpected end of formula");
+        }
+        throw std::invalid_argument("Unexpected '" + std::string(1, text_[pos_]) + "' at position " +
+                                    std::to_string(pos_));
+    }
+
+    /// Depth guard for the recursive rules
+    class Nesting {
+    public:
+        explicit Nesting(Parser& parser) : parser_(parser) {
+            if (++parser_.depth_ > MaxDepth) {
+                throw std::invalid_argument("Formula nests too deeply");
+            }
+        }
+
+        ~Nesting() {
+            --parser_.depth_;
+        }
+
+        Nesting(const Nesting&) = delete;
+        Nesting& operator=(const Nesting&) = delete;
+
+    private:
+        Parser& parser_;
+    };
+
+    std::string_view text_;
+    std::size_t pos_ = 0;
+    int depth_ = 0;
+    std::map<std::tuple<Node::Kind, OpCode, std::uint32_t, std::uint32_t, std::uint64_t>, std::uint32_t> unique_;
+};
+
+std::uint16_t checked_register(std::size_t index) {
+    if (index >= std::numeric_limits<std::uint16_t>::max()) {
+        throw std::invalid_argument("Formula is too large to compile");
+    }
+    return static_cast<std::uint16_t>(index);
+}
+
+} // namespace
+
+Expression Expression::compile(std::string_view formula) {
+    Parser parser(formula);
+    const std::uint32_t root = parser.parse();
+    const auto& nodes = parser.nodes;
+
+    Expression result;
+    result.variables_ = std::move(parser.variables);
+
+    // Folding leaves some nodes unreferenced; count uses of the live ones
+    std::vector<std::uint32_t> uses(nodes.size(), 0);
+    uses[root] = 1;
+    for (std::size_t i = nodes.size(); i-- > 0;) {
+        if (uses[i] > 0 && nodes[i].kind == Node::Kind::Operation) {
+            ++uses[nodes[i].a];
+            if (nodes[i].op != OpCode::Sqrt) {
+                ++uses[nodes[i].b];
+            }
+        }
+    }
+
+    // Registers: variables, then constants, then temporaries, then the result
+    const std::size_t variables = result.variables_.size();
+    std::vector<std::uint16_t> reg(nodes.size(), 0);
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        if (uses[i] == 0) {
+            continue;
+        }
+        if (nodes[i].kind == Node::Kind::Variable) {
+            reg[i] = static_cast<std::uint16_t>(nodes[i].a);
+        } else if (nodes[i].kind == Node::Kind::Constant) {
+            reg[i] = checked_register(variables + result.constants_.size());
+            result.constants_.push_back(nodes[i].value);
+        }
+    }
+    const std::size_t first_temporary = variables + result.constants_.size();
+    constexpr std::uint16_t ResultPlaceholder = std::numeric_limits<std::uint16_t>::max();
+
+    // Nodes are in dependency order; a temporary is recycled as soon as its last reader is emitted
+    std::vector<std::uint16_t> free_temporaries;
+    const auto release = [&](std::uint32_t operand) {
+        if (--uses[operand] == 0 && nodes[operand].kind == Node::Kind::Operation) {
+            free_temporaries.push_back(reg[operand]);
+        }
+    };
+    for (std::uint32_t i = 0; i < nodes.size(); ++i) {
+        if (uses[i] == 0 || nodes[i].kind != Node::Kind::Operation) {
+            continue;
+        }
+        const Node& node = nodes[i];
+        Instruction instruction{node.op, 0, reg[node.a], reg[node.b]};
+        release(node.a);
+        if (node.op != OpCode::Sqrt) {
+            release(node.b);
+        }
+        // The kernels allow out to alias an input exactly, so a freed operand register is reusable here
+        if (i == root) {
+            instruction.out = ResultPlaceholder;
+        } else if (!free_temporaries.empty()) {
+            instruction.out = free_temporaries.back();
+            free_temporaries.pop_back();
+        } else {
+            instruction.out = checked_register(first_temporary + result.temporaries_++);
+        }
+        reg[i] = instruction.out;
+        result.code_.push_back(instruction);
+    }
+
+    if (result.code_.empty()) {
+        result.result_ = reg[root];
+    } else {
+        result.result_ = checked_register(first_temporary + result.temporaries_);
+        result.code_.back().out = result.result_;
+    }
+    return result;
+}
+
+void Expression::check_columns(std::span<const std::span<const double>> columns, std::size_t rows) const {
+    if (columns.size() != variables_.size()) {
+        throw std::invalid_argument("Expected one column per variable (" + std::to_string(variables_.size()) +
+                                    "), got " + std::to_string(columns.size()));
+    }
+    for (const auto& column : columns) {
+        if (column.size() != rows) {
+            throw std::invalid_argument("Columns must have the same size as the output");
+        }
+    }
+}
+
+void Expression::evaluate(std::span<const std::span<const double>> columns, std::span<double> out) const {
+    check_columns(columns, out.size());
+    evaluate_rows(columns, out, 0, out.size());
+}
+
+void Expression::evaluate(std::span<const std::span<const double>> columns, std::span<double> out,
+                          core::ThreadPool& pool) const {
+    check_columns(columns, out.size());
+    const std::size_t blocks = (out.size() + BlockRows - 1) / BlockRows;
+    pool.parallel_for(blocks, TaskBlocks, [&](std::size_t first, std::size_t last) {
+        evaluate_rows(columns, out, first * BlockRows, std::min(out.size(), last * BlockRows));
+    });
+}
+
+void Expression::evaluate_rows(std::span<const std::span<const double>> columns, std::span<double> out,
+                               std::size_t begin, std::size_t end) const {
+    const std::size_t variables = variables_.size();
+    if (code_.empty()) {
+        if (result_ < variables) {
+            std::copy(columns[result_].begin() + static_cast<std::ptrdiff_t>(begin),
+                      columns[result_].begin() + static_cast<std::ptrdiff_t>(end),
+                      out.begin() + static_cast<std::ptrdiff_t>(begin));
+        } else {
+            std::fill(out.begin() + static_cast<std::ptrdiff_t>(begin), out.begin() + static_cast<std::ptrdiff_t>(end),
+                      constants_[result_ - variables]);
+        }
+        return;
+    }
+
+    // Constants broadcast once, then temporaries, one block each
+    std::vector<double> scratch((constants_.size() + temporaries_) * BlockRows);
+    for (std::size_t c = 0; c < constants_.size(); ++c) {
+        std::fill_n(scratch.begin() + static_cast<std::ptrdiff_t>(c * BlockRows), BlockRows, constants_[c]);
+    }
+    const auto& kernels = detail::batch_kernels();
+
+    for (std::size_t row = begin; row < end; row += BlockRows) {
+        const std::size_t n = std::min(BlockRows, end - row);
+        const auto target = [&](std::uint16_t r) {
+            return r == result_ ? out.data() + row : scratch.data() + (r - variables) * BlockRows;
+        };
+        const auto source = [&](std::uint16_t r) -> const double* {
+            return r < variables ? columns[r].data() + row : target(r);
+        };
+        for (const Instruction& instruction : code_) {
+            const double* a = source(instruction.a);
+            const double* b = source(instruction.b);
+            double* result = target(instruction.out);
+            switch (instruction.op) {
+                case OpCode::Add: kernels.add(a, b, result, n); break;
+                case OpCode::Subtract: kernels.subtract(a, b, result, n); break;
+                case OpCode::Multiply: kernels.multiply(a, b, result, n); break;
+                case OpCode::Divide: kernels.divide(a, b, result, nullptr, n); break;
+                case OpCode::Power: kernels.power(a, b, result, n); break;
+                case OpCode::Sqrt: kernels.sqrt(a, result, nullptr, n); break;
+            }
+        }
+    }
+}
+
+double Expression::evaluate(std::span<const double> row) const {
+    if (row.size() != variables_.size()) {
+        throw std::invalid_argument("Expected one value per variable (" + std::to_string(variables_.size()) +
+                                    "), got " + std::to_string(row.size()));
+    }
+    const std::size_t registers = static_cast<std::size_t>(result_) + 1;
+    double local[64];
+    std::vector<double> heap;
+    double* reg = local;
+    if (registers > std::size(local)) {
+        heap.resize(registers);
+        reg = heap.data();
+    }
+    std::copy(row.begin(), row.end(), reg);
+    std::copy(constants_.begin(), constants_.end(), reg + row.size());
+    for (const Instruction& instruction : code_) {
+        reg[instruction.out] = apply(instruction.op, reg[instruction.a], reg[instruction.b]);
+    }
+    return reg[result_];
+}
+
+// ExpressionCache
+
+ExpressionCache::ExpressionCache(std::size_t capacity) : capacity_(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("Expression cache capacity must be at least 1");
+    }
+}
+
+std::shared_ptr<const Expression> ExpressionCache::get(std::string_view formula) {
+    {
+        const std::lock_guard lock(mutex_);
+        if (const auto it = entries_.find(formula); it != entries_.end()) {
+            recency_.splice(recency_.begin(), recency_, it->second.recency);
+            return it->second.expression;
+        }
+    }
+
+    auto compiled = std::make_shared<const Expression>(Expression::compile(formula));
+
+    const std::lock_guard lock(mutex_);
+    if (const auto it = entries_.find(formula); it != entries_.end()) {
+        recency_.splice(recency_.begin(), recency_, it->second.recency);
+        return it->second.expression;
+    }
+    recency_.emplace_front(formula);
+    entries_.emplace(std::string(formula), Entry{compiled, recency_.begin()});
+    if (entries_.size() > capacity_) {
+        entries_.erase(entries_.find(recency_.back()));
+        recency_.pop_back();
+    }
+    return compiled;
+}
+
+std::size_t ExpressionCache::size() const {
+    const std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+void ExpressionCache::clear() {
+    const std::lock_guard lock(mutex_);
+    entries_.clear();
+    recency_.clear();
+}
+
+} // namespace cpptemplate::math
@@ -1 +1,609 @@
-// Stub implementation
+#include "cpptemplate/math/geometry.hpp"
+
+#include <bit>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+#include "batch_kernels.hpp"
+
+#if CPPTEMPLATE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+namespace cpptemplate::math {
+
+namespace {
+
+constexpr std::size_t Lanes = 8;
+constexpr double Infinity = std::numeric_limits<double>::infinity();
+
+/**
+ * Eight boxes in structure-of-arrays form: lower[axis][0..8), upper[axis][0..8).
+ * Points are boxes with lower == upper.
+ */
+template<std::size_t D>
+struct Boxes8 {
+    std::array<const double*, D> lower;
+    std::array<const double*, D> upper;
+};
+
+/// Per-lane results of testing eight boxes against a query box
+struct Masks {
+    unsigned overlap; ///< Box intersects the query
+    unsigned inside;  ///< Box lies entirely inside the query
+};
+
+template<std::size_t D>
+struct Kernels {
+    Masks (*classify)(const Boxes8<D>& boxes, const Aabb<D>& query) noexcept;
+    void (*distance)(const Boxes8<D>& boxes, const Point<D>& query, double* out) noexcept;
+};
+
+template<std::size_t D>
+Masks classify_scalar(const Boxes8<D>& boxes, const Aabb<D>& query) noexcept {
+    Masks masks{0, 0};
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        bool overlap = true;
+        bool inside = true;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            const double lo = boxes.lower[axis][lane];
+            const double hi = boxes.upper[axis][lane];
+            overlap = overlap && lo <= query.max[axis] && hi >= query.min[axis];
+            inside = inside && lo >= query.min[axis] && hi <= query.max[axis];
+        }
+        masks.overlap |= static_cast<unsigned>(overlap) << lane;
+        masks.inside |= static_cast<unsigned>(inside) << lane;
+    }
+    return masks;
+}
+
+template<std::size_t D>
+void distance_scalar(const Boxes8<D>& boxes, const Point<D>& query, double* out) noexcept {
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        double sum = 0.0;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            const double d = std::max({boxes.lower[axis][lane] - query[axis], 0.0,
+                                       query[axis] - boxes.upper[axis][lane]});
+            sum += d * d;
+        }
+        out[lane] = sum;
+    }
+}
+
+#if CPPTEMPLATE_X86_KERNELS
+
+template<std::size_t D>
+CPPTEMPLATE_AVX2 Masks classify_avx2(const Boxes8<D>& boxes, const Aabb<D>& query) noexcept {
+    Masks masks{0, 0};
+    for (std::size_t half = 0; half < Lanes; half += 4) {
+        __m256d overlap = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        __m256d inside = overlap;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            const __m256d lo = _mm256_loadu_pd(boxes.lower[axis] + half);
+            const __m256d hi = _mm256_loadu_pd(boxes.upper[axis] + half);
+            const __m256d qlo = _mm256_set1_pd(query.min[axis]);
+            const __m256d qhi = _mm256_set1_pd(query.max[axis]);
+            overlap = _mm256_and_pd(overlap, _mm256_and_pd(_mm256_cmp_pd(lo, qhi, _CMP_LE_OQ),
+                                                           _mm256_cmp_pd(hi, qlo, _CMP_GE_OQ)));
+            inside = _mm256_and_pd(inside, _mm256_and_pd(_mm256_cmp_pd(lo, qlo, _CMP_GE_OQ),
+                                                         _mm256_cmp_pd(hi, qhi, _CMP_LE_OQ)));
+        }
+        masks.overlap |= static_cast<unsigned>(_mm256_movemask_pd(overlap)) << half;
+        masks.inside |= static_cast<unsigned>(_mm256_movemask_pd(inside)) << half;
+    }
+    return masks;
+}
+
+template<std::size_t D>
+CPPTEMPLATE_AVX2 void distance_avx2(const Boxes8<D>& boxes,
+                                    const Point<D>& query,
+                                    double* out) noexcept {
+    const __m256d zero = _mm256_setzero_pd();
+    for (std::size_t half = 0; half < Lanes; half += 4) {
+        __m256d sum = zero;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            const __m256d q = _mm256_set1_pd(query[axis]);
+            const __m256d below = _mm256_sub_pd(_mm256_loadu_pd(boxes.lower[axis] + half), q);
+            const __m256d above = _mm256_sub_pd(q, _mm256_loadu_pd(boxes.upper[axis] + half));
+            const __m256d d = _mm256_max_pd(_mm256_max_pd(below, above), zero);
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(d, d));
+        }
+        _mm256_storeu_pd(out + half, sum);
+    }
+}
+
+// The unmasked _mm512_max_pd passes an undefined merge source that GCC 12
+// flags with -Wmaybe-uninitialized; the full-mask form is the same instruction
+CPPTEMPLATE_AVX512 inline __m512d max512(__m512d a, __m512d b) noexcept {
+    return _mm512_mask_max_pd(a, 0xFF, a, b);
+}
+
+template<std::size_t D>
+CPPTEMPLATE_AVX512 Masks classify_avx512(const Boxes8<D>& boxes, const Aabb<D>& query) noexcept {
+    __mmask8 overlap = 0xFF;
+    __mmask8 inside = 0xFF;
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        const __m512d lo = _mm512_loadu_pd(boxes.lower[axis]);
+        const __m512d hi = _mm512_loadu_pd(boxes.upper[axis]);
+        const __m512d qlo = _mm512_set1_pd(query.min[axis]);
+        const __m512d qhi = _mm512_set1_pd(query.max[axis]);
+        overlap = _mm512_mask_cmp_pd_mask(overlap, lo, qhi, _CMP_LE_OQ);
+        overlap = _mm512_mask_cmp_pd_mask(overlap, hi, qlo, _CMP_GE_OQ);
+        inside = _mm512_mask_cmp_pd_mask(inside, lo, qlo, _CMP_GE_OQ);
+        inside = _mm512_mask_cmp_pd_mask(inside, hi, qhi, _CMP_LE_OQ);
+    }
+    return {overlap, inside};
+}
+
+template<std::size_t D>
+CPPTEMPLATE_AVX512 void distance_avx512(const Boxes8<D>& boxes,
+                                        const Point<D>& query,
+                                        double* out) noexcept {
+    const __m512d zero = _mm512_setzero_pd();
+    __m512d sum = zero;
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        const __m512d q = _mm512_set1_pd(query[axis]);
+        const __m512d below = _mm512_sub_pd(_mm512_loadu_pd(boxes.lower[axis]), q);
+        const __m512d above = _mm512_sub_pd(q, _mm512_loadu_pd(boxes.upper[axis]));
+        const __m512d d = max512(max512(below, above), zero);
+        sum = _mm512_add_pd(sum, _mm512_mul_pd(d, d));
+    }
+    _mm512_storeu_pd(out, sum);
+}
+
+#endif // CPPTEMPLATE_X86_KERNELS
+
+template<std::size_t D>
+const Kernels<D>& kernels() noexcept {
+    static constexpr Kernels<D> scalar{classify_scalar<D>, distance_scalar<D>};
+#if CPPTEMPLATE_X86_KERNELS
+    static constexpr Kernels<D> avx2{classify_avx2<D>, distance_avx2<D>};
+    static constexpr Kernels<D> avx512{classify_avx512<D>, distance_avx512<D>};
+    switch (core::simd_level()) {
+        case core::SimdLevel::Avx512: return avx512;
+        case core::SimdLevel::Avx2: return avx2;
+        default: break;
+    }
+#endif
+    return scalar;
+}
+
+template<std::size_t D>
+Boxes8<D> boxes_at(const std::array<const double*, D>& lower,
+                   const std::array<const double*, D>& upper,
+                   std::size_t offset) noexcept {
+    Boxes8<D> boxes;
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        boxes.lower[axis] = lower[axis] + offset;
+        boxes.upper[axis] = upper[axis] + offset;
+    }
+    return boxes;
+}
+
+/// Batch driver: full groups of eight through the kernel, the tail through a padded copy
+template<std::size_t D, typename Group>
+void for_each_group(const std::array<const double*, D>& lower,
+                    const std::array<const double*, D>& upper,
+                    std::size_t n,
+                    Group&& group) {
+    std::size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes) {
+        group(boxes_at<D>(lower, upper, i), i, Lanes);
+    }
+    if (i < n) {
+        // Empty boxes (lower > upper) never match and are infinitely far away
+        std::array<std::array<double, Lanes>, D> lo;
+        std::array<std::array<double, Lanes>, D> hi;
+        Boxes8<D> tail;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            lo[axis].fill(Infinity);
+            hi[axis].fill(-Infinity);
+            std::copy(lower[axis] + i, lower[axis] + n, lo[axis].begin());
+            std::copy(upper[axis] + i, upper[axis] + n, hi[axis].begin());
+            tail.lower[axis] = lo[axis].data();
+            tail.upper[axis] = hi[axis].data();
+        }
+        group(tail, i, n - i);
+    }
+}
+
+/// Mask of the first count of eight lanes
+unsigned lanes_below(std::size_t count) noexcept {
+    return count >= Lanes ? 0xFFU : (1U << count) - 1;
+}
+
+std::size_t write_mask(unsigned mask, std::size_t count, std::uint8_t* out) noexcept {
+    for (std::size_t lane = 0; lane < count; ++lane) {
+        out[lane] = static_cast<std::uint8_t>((mask >> lane) & 1U);
+    }
+    return static_cast<std::size_t>(std::popcount(mask & lanes_below(count)));
+}
+
+template<std::size_t D, typename Array>
+std::array<const double*, D> data_of(const std::array<Array, D>& arrays) noexcept {
+    std::array<const double*, D> result;
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        result[axis] = arrays[axis].data();
+    }
+    return result;
+}
+
+void check_output_size(std::size_t expected, std::size_t actual) {
+    if (expected != actual) {
+        throw std::invalid_argument("Output size must match the number of elements");
+    }
+}
+
+template<std::size_t D>
+std::size_t intersect_impl(const BoxSet<D>& boxes,
+                           const Aabb<D>& query,
+                           std::span<std::uint8_t> hits) {
+    check_output_size(boxes.size(), hits.size());
+    std::array<std::span<const double>, D> lower;
+    std::array<std::span<const double>, D> upper;
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        lower[axis] = boxes.lower(axis);
+        upper[axis] = boxes.upper(axis);
+    }
+    const auto classify = kernels<D>().classify;
+    std::size_t total = 0;
+    for_each_group<D>(data_of<D>(lower),
+                      data_of<D>(upper),
+                      boxes.size(),
+                      [&](const Boxes8<D>& group, std::size_t offset, std::size_t count) {
+                          total += write_mask(
+                              classify(group, query).overlap, count, hits.data() + offset);
+                      });
+    return total;
+}
+
+template<std::size_t D>
+std::array<const double*, D> point_axes(const PointSet<D>& points) noexcept {
+    std::array<const double*, D> result;
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        result[axis] = points.axis(axis).data();
+    }
+    return result;
+}
+
+template<std::size_t D>
+std::size_t contains_impl(const Aabb<D>& box,
+                          const PointSet<D>& points,
+                          std::span<std::uint8_t> inside) {
+    check_output_size(points.size(), inside.size());
+    const auto axes = point_axes(points);
+    const auto classify = kernels<D>().classify;
+    std::size_t total = 0;
+    for_each_group<D>(axes,
+                      axes,
+                      points.size(),
+                      [&](const Boxes8<D>& group, std::size_t offset, std::size_t count) {
+                          total += write_mask(
+                              classify(group, box).overlap, count, inside.data() + offset);
+                      });
+    return total;
+}
+
+template<std::size_t D>
+void squared_distances_impl(const PointSet<D>& points,
+                            const Point<D>& query,
+                            std::span<double> out) {
+    check_output_size(points.size(), out.size());
+    const auto axes = point_axes(points);
+    const auto distance = kernels<D>().distance;
+    for_each_group<D>(axes,
+                      axes,
+                      points.size(),
+                      [&](const Boxes8<D>& group, std::size_t offset, std::size_t count) {
+                          double lanes[Lanes];
+                          distance(group, query, lanes);
+                          std::copy(lanes, lanes + count, out.data() + offset);
+                      });
+}
+
+// Bulk loading
+
+template<std::size_t D>
+struct Entry {
+    std::array<double, D> p;
+    std::uint32_t id;
+};
+
+/// Partition [begin, end) along axis so each consecutive run of group entries holds the next
+/// smallest coordinates
+template<std::size_t D>
+void select_groups(Entry<D>* begin, Entry<D>* end, std::size_t axis, std::size_t group) {
+    const auto count = static_cast<std::size_t>(end - begin);
+    if (count <= group) {
+        return;
+    }
+    const std::size_t groups = (count + group - 1) / group;
+    Entry<D>* middle = begin + static_cast<std::ptrdiff_t>(groups / 2 * group);
+    std::nth_element(begin, middle, end, [axis](const Entry<D>& a, const Entry<D>& b) {
+        return a.p[axis] < b.p[axis];
+    });
+    select_groups(begin, middle, axis, group);
+    select_groups(middle, end, axis, group);
+}
+
+/**
+ * Sort-Tile-Recursive: cut into ~leaves^(1/remaining axes) slabs along axis,
+ * each a whole number of leaves, and tile every slab along the next axis
+ */
+template<std::size_t D>
+void tile(Entry<D>* begin, Entry<D>* end, std::size_t axis, core::ThreadPool& pool) {
+    const auto count = static_cast<std::size_t>(end - begin);
+    const std::size_t leaves = (count + Lanes - 1) / Lanes;
+    if (axis + 1 == D || leaves <= 1) {
+        select_groups(begin, end, axis, Lanes);
+        return;
+    }
+    const auto slabs = static_cast<std::size_t>(
+        std::ceil(std::pow(static_cast<double>(leaves), 1.0 / static_cast<double>(D - axis))));
+    const std::size_t slab_size = (leaves + slabs - 1) / slabs * Lanes;
+    select_groups(begin, end, axis, slab_size);
+    const std::size_t used = (count + slab_size - 1) / slab_size;
+    pool.parallel_for(used, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t s = first; s < last; ++s) {
+            Entry<D>* slab = begin + static_cast<std::ptrdiff_t>(s * slab_size);
+            Entry<D>* slab_end = std::min(slab + static_cast<std::ptrdiff_t>(slab_size), end);
+            tile(slab, slab_end, axis + 1, pool);
+        }
+    });
+}
+
+std::size_t padded(std::size_t n) noexcept {
+    return std::max(Lanes, (n + Lanes - 1) / Lanes * Lanes);
+}
+
+} // namespace
+
+std::size_t intersect(const BoxSet<2>& boxes, const Aabb2& query, std::span<std::uint8_t> hits) {
+    return intersect_impl(boxes, query, hits);
+}
+
+std::size_t intersect(const BoxSet<3>& boxes, const Aabb3& query, std::span<std::uint8_t> hits) {
+    return intersect_impl(boxes, query, hits);
+}
+
+std::size_t contains(const Aabb2& box, const PointSet<2>& points, std::span<std::uint8_t> inside) {
+    return contains_impl(box, points, inside);
+}
+
+std::size_t contains(const Aabb3& box, const PointSet<3>& points, std::span<std::uint8_t> inside) {
+    return contains_impl(box, points, inside);
+}
+
+void squared_distances(const PointSet<2>& points, const Point2& query, std::span<double> out) {
+    squared_distances_impl(points, query, out);
+}
+
+void squared_distances(const PointSet<3>& points, const Point3& query, std::span<double> out) {
+    squared_distances_impl(points, query, out);
+}
+
+// PointIndex
+
+template<std::size_t D>
+PointIndex<D>::PointIndex(const PointSet<D>& points, core::ThreadPool& pool) {
+    const std::size_t n = points.size();
+    if (n >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("PointIndex supports fewer than 2^32 - 1 points");
+    }
+    std::vector<Entry<D>> entries(n);
+    pool.parallel_for(n, 1 << 16, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            for (std::size_t axis = 0; axis < D; ++axis) {
+                entries[i].p[axis] = points.axis(axis)[i];
+            }
+            entries[i].id = static_cast<std::uint32_t>(i);
+        }
+    });
+    tile(entries.data(), entries.data() + n, 0, pool);
+
+    ids_.resize(n);
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        coords_[axis].assign(padded(n), Infinity);
+    }
+    pool.parallel_for(n, 1 << 16, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            ids_[i] = entries[i].id;
+            for (std::size_t axis = 0; axis < D; ++axis) {
+                coords_[axis][i] = entries[i].p[axis];
+            }
+        }
+    });
+    entries = {};
+
+    // Levels bottom-up: box i of a level bounds children [8i, 8i + 8) of the level below
+    std::array<const double*, D> child_lower;
+    std::array<const double*, D> child_upper;
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        child_lower[axis] = coords_[axis].data();
+        child_upper[axis] = coords_[axis].data();
+    }
+    std::size_t children = n;
+    do {
+        const std::size_t count = (children + Lanes - 1) / Lanes;
+        Level level;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            level.lower[axis].assign(padded(count), Infinity);
+            level.upper[axis].assign(padded(count), -Infinity);
+        }
+        pool.parallel_for(count, 1 << 12, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const std::size_t end = std::min(children, (i + 1) * Lanes);
+                for (std::size_t axis = 0; axis < D; ++axis) {
+                    double lo = Infinity;
+                    double hi = -Infinity;
+                    for (std::size_t c = i * Lanes; c < end; ++c) {
+                        lo = std::min(lo, child_lower[axis][c]);
+                        hi = std::max(hi, child_upper[axis][c]);
+                    }
+                    level.lower[axis][i] = lo;
+                    level.upper[axis][i] = hi;
+                }
+            }
+        });
+        levels_.push_back(std::move(level));
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            child_lower[axis] = levels_.back().lower[axis].data();
+            child_upper[axis] = levels_.back().upper[axis].data();
+        }
+        children = count;
+    } while (children > 1);
+
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        bounds_.min[axis] = levels_.back().lower[axis][0];
+        bounds_.max[axis] = levels_.back().upper[axis][0];
+    }
+}
+
+template<std::size_t D>
+template<typename Emit>
+void PointIndex<D>::visit(const Aabb<D>& box, Emit&& emit) const {
+    if (ids_.empty()) {
+        return;
+    }
+    struct Node {
+        std::uint32_t level; ///< Level whose box this is; its children live one level down
+        std::uint32_t index;
+    };
+    // Depth-first: at most 8 pending children per level, and 2^32 points need fewer than 12 levels
+    std::array<Node, Lanes * 12> stack;
+    std::size_t top = 0;
+    stack[top++] = {static_cast<std::uint32_t>(levels_.size() - 1), 0};
+    const auto classify = kernels<D>().classify;
+
+    while (top > 0) {
+        const Node node = stack[--top];
+        const std::size_t offset = std::size_t{node.index} * Lanes;
+        const std::size_t span = std::size_t{1} << (3 * node.level); // Points below each child
+        // Padding lanes hold empty boxes or infinite points, which unbounded queries still match
+        const unsigned valid = lanes_below((ids_.size() + span - 1) / span - offset);
+        if (node.level == 0) {
+            const unsigned mask =
+                classify(boxes_at<D>(data_of<D>(coords_), data_of<D>(coords_), offset), box)
+                    .overlap;
+            for (unsigned bits = mask & valid; bits != 0; bits &= bits - 1) {
+                emit(offset + static_cast<std::size_t>(std::countr_zero(bits)), 1);
+            }
+            continue;
+        }
+        const Level& children = levels_[node.level - 1];
+        const Masks masks = classify(
+            boxes_at<D>(data_of<D>(children.lower), data_of<D>(children.upper), offset), box);
+        // Children entirely inside match every point below them, consecutive in tree order
+        for (unsigned bits = masks.inside & valid; bits != 0; bits &= bits - 1) {
+            const std::size_t first =
+                (offset + static_cast<std::size_t>(std::countr_zero(bits))) * span;
+            emit(first, std::min(span, ids_.size() - first));
+        }
+        for (unsigned bits = masks.overlap & ~masks.inside & valid; bits != 0; bits &= bits - 1) {
+            stack[top++] = {node.level - 1,
+                            static_cast<std::uint32_t>(
+                                offset + static_cast<std::size_t>(std::countr_zero(bits)))};
+        }
+    }
+}
+
+template<std::size_t D>
+std::size_t PointIndex<D>::query(const Aabb<D>& box, std::vector<std::uint32_t>& out) const {
+    const std::size_t before = out.size();
+    visit(box, [&](std::size_t first, std::size_t count) {
+        out.insert(out.end(), ids_.begin() + static_cast<std::ptrdiff_t>(first),
+                   ids_.begin() + static_cast<std::ptrdiff_t>(first + count));
+    });
+    return out.size() - before;
+}
+
+template<std::size_t D>
+std::size_t PointIndex<D>::count(const Aabb<D>& box) const {
+    std::size_t total = 0;
+    visit(box, [&](std::size_t, std::size_t count) { total += count; });
+    return total;
+}
+
+template<std::size_t D>
+std::vector<Neighbor> PointIndex<D>::nearest(const Point<D>& query, std::size_t k) const {
+    std::vector<Neighbor> result;
+    k = std::min(k, ids_.size());
+    if (k == 0) {
+        return result;
+    }
+    struct Pending {
+        double squared_distance;
+        std::uint32_t level;
+        std::uint32_t index;
+
+        bool operator>(const Pending& other) const noexcept {
+            return squared_distance > other.squared_distance;
+        }
+    };
+    const auto farther = [](const Neighbor& a, const Neighbor& b) {
+        return a.squared_distance < b.squared_distance;
+    };
+
+    // Best-first: expand nodes by distance until the nearest pending node lies beyond the
+    // k-th neighbour
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<>> pending;
+    pending.push({0.0, static_cast<std::uint32_t>(levels_.size() - 1), 0});
+    result.reserve(k + 1);
+    const auto distance = kernels<D>().distance;
+    double lanes[Lanes];
+
+    while (!pending.empty()) {
+        const Pending node = pending.top();
+        if (result.size() == k && node.squared_distance > result.front().squared_distance) {
+            break;
+        }
+        pending.pop();
+        const std::size_t offset = std::size_t{node.index} * Lanes;
+        const std::size_t span = std::size_t{1} << (3 * node.level);
+        const std::size_t valid = std::min(Lanes, (ids_.size() + span - 1) / span - offset);
+        if (node.level == 0) {
+            distance(boxes_at<D>(data_of<D>(coords_), data_of<D>(coords_), offset), query, lanes);
+            for (std::size_t lane = 0; lane < valid; ++lane) {
+                if (result.size() < k || lanes[lane] < result.front().squared_distance) {
+                    // Tree position for now; replaced by the point's id below
+                    result.push_back({static_cast<std::uint32_t>(offset + lane), lanes[lane]});
+                    std::push_heap(result.begin(), result.end(), farther);
+                    if (result.size() > k) {
+                        std::pop_heap(result.begin(), result.end(), farther);
+                        result.pop_back();
+                    }
+                }
+            }
+            continue;
+        }
+        const Level& children = levels_[node.level - 1];
+        distance(boxes_at<D>(data_of<D>(children.lower), data_of<D>(children.upper), offset),
+                 query, lanes);
+        for (std::size_t lane = 0; lane < valid; ++lane) {
+            if (result.size() < k || lanes[lane] <= result.front().squared_distance) {
+                pending.push(
+                    {lanes[lane], node.level - 1, static_cast<std::uint32_t>(offset + lane)});
+            }
+        }
+    }
+    // Report distances as squared_distance() computes them, which the kernels
+    // may miss by an ulp, and order by those
+    for (Neighbor& neighbor : result) {
+        Point<D> point{};
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            point[axis] = coords_[axis][neighbor.id];
+        }
+        neighbor = {ids_[neighbor.id], squared_distance(point, query)};
+    }
+    std::sort(result.begin(), result.end(), [](const Neighbor& a, const Neighbor& b) {
+        return a.squared_distance < b.squared_distance ||
+               (a.squared_distance == b.squared_distance && a.id < b.id);
+    });
+    return result;
+}
+
+template class CPPTEMPLATE_MATH_API PointIndex<2>;
+template class CPPTEMPLATE_MATH_API PointIndex<3>;
+
+} // namespace cpptemplate::math
@@ -1,8 +1,421 @@
 #include "cpptemplate/math/matrix.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "batch_kernels.hpp"
+#include "cpptemplate/core/cpu_features.hpp"
+
+#if CPPTEMPLATE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
 namespace cpptemplate::math {
 
-// Stub implementation for matrix operations
-// Add actual matrix functionality as needed
+namespace {
+
+/**
+ * Micro-kernel: c[MR x NR] += alpha * A * B over k steps, where A is a packed
+ * panel of MR values per step and B a packed panel of NR values per step.
+ * Rows of c are ldc elements apart.
+ */
+template<typename T>
+using MicroKernel = void (*)(std::size_t k, const T* a, const T* b, T* c, std::size_t ldc,
+                             T alpha) noexcept;
+
+/// A micro-kernel and the blocking it is tuned for
+template<typename T>
+struct GemmKernel {
+    MicroKernel<T> kernel;
+    std::size_t mr; ///< Rows per register tile
+    std::size_t nr; ///< Columns per register tile
+    std::size_t kc; ///< Depth of a packed panel (A panel stays in L1, B panel in L2)
+    std::size_t mc; ///< Rows of a packed A block (stays in L2)
+    std::size_t nc; ///< Columns of a packed B block (stays in L3)
+};
+
+// Scalar micro-kernel: 4 x 8 tile the compiler vectorizes for the baseline ISA
+
+template<typename T>
+void kernel_scalar(std::size_t k, const T* a, const T* b, T* c, std::size_t ldc,
+                   T alpha) noexcept {
+    constexpr std::size_t MR = 4;
+    constexpr std::size_t NR = 8;
+    T acc[MR][NR] = {};
+    for (std::size_t p = 0; p < k; ++p) {
+        for (std::size_t r = 0; r < MR; ++r) {
+            const T ar = a[r];
+            for (std::size_t j = 0; j < NR; ++j) {
+                acc[r][j] += ar * b[j];
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+    for (std::size_t r = 0; r < MR; ++r) {
+        for (std::size_t j = 0; j < NR; ++j) {
+            c[r * ldc + j] += alpha * acc[r][j];
+        }
+    }
+}
+
+#if CPPTEMPLATE_X86_KERNELS
+
+    #define CPPTEMPLATE_AVX2_FMA_INLINE CPPTEMPLATE_AVX2_FMA __attribute__((always_inline)) inline
+    #define CPPTEMPLATE_AVX512_INLINE CPPTEMPLATE_AVX512 __attribute__((always_inline)) inline
+
+template<typename T>
+struct Avx2;
+
+template<>
+struct Avx2<double> {
+    using Vec = __m256d;
+    static constexpr std::size_t Lanes = 4;
+    CPPTEMPLATE_AVX2_FMA_INLINE static Vec zero() noexcept { return _mm256_setzero_pd(); }
+    CPPTEMPLATE_AVX2_FMA_INLINE static Vec load(const double* p) noexcept {
+        return _mm256_loadu_pd(p);
+    }
+    CPPTEMPLATE_AVX2_FMA_INLINE static Vec broadcast(const double* p) noexcept {
+        return _mm256_broadcast_sd(p);
+    }
+    CPPTEMPLATE_AVX2_FMA_INLINE static void store(double* p, Vec v) noexcept {
+        _mm256_storeu_pd(p, v);
+    }
+    CPPTEMPLATE_AVX2_FMA_INLINE static Vec fmadd(Vec a, Vec b, Vec c) noexcept {
+        return _mm256_fmadd_pd(a, b, c);
+    }
+};
+
+template<>
+struct Avx2<float> {
+    using Vec = __m256;
+    static constexpr std::size_t Lanes = 8;
+    CPPTEMPLATE_AVX2_FMA_INLINE static Vec zero() noexcept { return _mm256_setzero_ps(); }
+    CPPTEMPLATE_AVX2_FMA_INLINE static Vec load(const float* p) noexcept {
+        return _mm256_loadu_ps(p);
+    }
+    CPPTEMPLATE_AVX2_FMA_INLINE static Vec broadcast(const float* p) noexcept {
+        return _mm256_broadcast_ss(p);
+    }
+    CPPTEMPLATE_AVX2_FMA_INLINE static void store(float* p, Vec v) noexcept {
+        _mm256_storeu_ps(p, v);
+    }
+    CPPTEMPLATE_AVX2_FMA_INLINE static Vec fmadd(Vec a, Vec b, Vec c) noexcept {
+        return _mm256_fmadd_ps(a, b, c);
+    }
+};
+
+template<typename T>
+struct Avx512;
+
+template<>
+struct Avx512<double> {
+    using Vec = __m512d;
+    static constexpr std::size_t Lanes = 8;
+    CPPTEMPLATE_AVX512_INLINE static Vec zero() noexcept { return _mm512_setzero_pd(); }
+    CPPTEMPLATE_AVX512_INLINE static Vec load(const double* p) noexcept {
+        return _mm512_loadu_pd(p);
+    }
+    CPPTEMPLATE_AVX512_INLINE static Vec broadcast(const double* p) noexcept {
+        return _mm512_set1_pd(*p);
+    }
+    CPPTEMPLATE_AVX512_INLINE static void store(double* p, Vec v) noexcept {
+        _mm512_storeu_pd(p, v);
+    }
+    CPPTEMPLATE_AVX512_INLINE static Vec fmadd(Vec a, Vec b, Vec c) noexcept {
+        return _mm512_fmadd_pd(a, b, c);
+    }
+};
+
+template<>
+struct Avx512<float> {
+    using Vec = __m512;
+    static constexpr std::size_t Lanes = 16;
+    CPPTEMPLATE_AVX512_INLINE static Vec zero() noexcept { return _mm512_setzero_ps(); }
+    CPPTEMPLATE_AVX512_INLINE static Vec load(const float* p) noexcept {
+        return _mm512_loadu_ps(p);
+    }
+    CPPTEMPLATE_AVX512_INLINE static Vec broadcast(const float* p) noexcept {
+        return _mm512_set1_ps(*p);
+    }
+    CPPTEMPLATE_AVX512_INLINE static void store(float* p, Vec v) noexcept {
+        _mm512_storeu_ps(p, v);
+    }
+    CPPTEMPLATE_AVX512_INLINE static Vec fmadd(Vec a, Vec b, Vec c) noexcept {
+        return _mm512_fmadd_ps(a, b, c);
+    }
+};
+
+    #undef CPPTEMPLATE_AVX2_FMA_INLINE
+    #undef CPPTEMPLATE_AVX512_INLINE
+
+// The register tile is MR rows by NV vectors: MR * NV accumulators, NV
+// vectors of B and one broadcast of A must fit the register file (16 ymm
+// for AVX2, 32 zmm for AVX-512). The two kernels differ only in their
+// target attribute and tile shape.
+
+    #define CPPTEMPLATE_GEMM_KERNEL_BODY                                                  \
+        using Vec = typename Isa::Vec;                                                    \
+        constexpr std::size_t L = Isa::Lanes;                                             \
+        Vec acc[MR][NV];                                                                  \
+        _Pragma("GCC unroll 16") for (std::size_t r = 0; r < MR; ++r) {                   \
+            _Pragma("GCC unroll 4") for (std::size_t v = 0; v < NV; ++v) {                \
+                acc[r][v] = Isa::zero();                                                  \
+            }                                                                             \
+        }                                                                                 \
+        for (std::size_t p = 0; p < k; ++p) {                                             \
+            Vec bv[NV];                                                                   \
+            _Pragma("GCC unroll 4") for (std::size_t v = 0; v < NV; ++v) {                \
+                bv[v] = Isa::load(b + v * L);                                             \
+            }                                                                             \
+            _Pragma("GCC unroll 16") for (std::size_t r = 0; r < MR; ++r) {               \
+                const Vec ar = Isa::broadcast(a + r);                                     \
+                _Pragma("GCC unroll 4") for (std::size_t v = 0; v < NV; ++v) {            \
+                    acc[r][v] = Isa::fmadd(ar, bv[v], acc[r][v]);                         \
+                }                                                                         \
+            }                                                                             \
+            a += MR;                                                                      \
+            b += NV * L;                                                                  \
+        }                                                                                 \
+        const Vec va = Isa::broadcast(&alpha);                                            \
+        _Pragma("GCC unroll 16") for (std::size_t r = 0; r < MR; ++r) {                   \
+            _Pragma("GCC unroll 4") for (std::size_t v = 0; v < NV; ++v) {                \
+                T* out = c + r * ldc + v * L;                                             \
+                Isa::store(out, Isa::fmadd(va, acc[r][v], Isa::load(out)));               \
+            }                                                                             \
+        }
+
+template<typename T, std::size_t MR, std::size_t NV>
+CPPTEMPLATE_AVX2_FMA void kernel_avx2(std::size_t k, const T* a, const T* b, T* c,
+                                      std::size_t ldc, T alpha) noexcept {
+    using Isa = Avx2<T>;
+    CPPTEMPLATE_GEMM_KERNEL_BODY
+}
+
+template<typename T, std::size_t MR, std::size_t NV>
+CPPTEMPLATE_AVX512 void kernel_avx512(std::size_t k, const T* a, const T* b, T* c,
+                                      std::size_t ldc, T alpha) noexcept {
+    using Isa = Avx512<T>;
+    CPPTEMPLATE_GEMM_KERNEL_BODY
+}
+
+    #undef CPPTEMPLATE_GEMM_KERNEL_BODY
+
+#endif // CPPTEMPLATE_X86_KERNELS
+
+template<typename T>
+GemmKernel<T> select_kernel() noexcept {
+    constexpr std::size_t KC = 256;
+#if CPPTEMPLATE_X86_KERNELS
+    const auto level = core::simd_level();
+    if (level == core::SimdLevel::Avx512) {
+        // 8 x 3 vectors: 24 accumulators
+        constexpr std::size_t NR = 3 * Avx512<T>::Lanes;
+        return {kernel_avx512<T, 8, 3>, 8, NR, KC, 128, 128 * NR};
+    }
+    if (level == core::SimdLevel::Avx2 && core::cpu_features().fma) {
+        // 6 x 2 vectors: 12 accumulators
+        constexpr std::size_t NR = 2 * Avx2<T>::Lanes;
+        return {kernel_avx2<T, 6, 2>, 6, NR, KC, 144, 256 * NR};
+    }
+#endif
+    return {kernel_scalar<T>, 4, 8, KC, 128, 4096};
+}
+
+/// 64-byte aligned scratch buffer for packed panels
+template<typename T>
+class PackBuffer {
+public:
+    explicit PackBuffer(std::size_t size)
+        : data_(static_cast<T*>(::operator new[](std::max<std::size_t>(size, 1) * sizeof(T),
+                                                 std::align_val_t{Matrix<T>::Alignment}))) {}
+
+    ~PackBuffer() {
+        ::operator delete[](data_, std::align_val_t{Matrix<T>::Alignment});
+    }
+
+    PackBuffer(const PackBuffer&) = delete;
+    PackBuffer& operator=(const PackBuffer&) = delete;
+
+    [[nodiscard]] T* data() const noexcept {
+        return data_;
+    }
+
+private:
+    T* data_;
+};
+
+/// Pack a (rows x depth) block of A into MR-row panels, zero-padding the last
+template<typename T>
+void pack_a(MatrixView<const T> a, std::size_t mr, T* out) noexcept {
+    for (std::size_t i = 0; i < a.rows(); i += mr) {
+        const std::size_t rows = std::min(mr, a.rows() - i);
+        for (std::size_t p = 0; p < a.cols(); ++p) {
+            std::size_t r = 0;
+            for (; r < rows; ++r) {
+                out[r] = a(i + r, p);
+            }
+            for (; r < mr; ++r) {
+                out[r] = T{0};
+            }
+            out += mr;
+        }
+    }
+}
+
+/// Pack a (depth x cols) block of B into NR-column panels, zero-padding the last
+template<typename T>
+void pack_b(MatrixView<const T> b, std::size_t nr, T* out) noexcept {
+    for (std::size_t j = 0; j < b.cols(); j += nr) {
+        const std::size_t cols = std::min(nr, b.cols() - j);
+        for (std::size_t p = 0; p < b.rows(); ++p) {
+            const T* row = &b(p, j);
+            std::copy(row, row + cols, out);
+            std::fill(out + cols, out + nr, T{0});
+            out += nr;
+        }
+    }
+}
+
+template<typename T>
+void scale(MatrixView<T> c, T beta) noexcept {
+    for (std::size_t i = 0; i < c.rows(); ++i) {
+        auto row = c.row(i);
+        if (beta == T{0}) {
+            std::fill(row.begin(), row.end(), T{0});
+        } else {
+            for (auto& value : row) {
+                value *= beta;
+            }
+        }
+    }
+}
+
+/// Single-threaded blocked GEMM: c += alpha * a * b
+template<typename T>
+void gemm_serial(const GemmKernel<T>& g, MatrixView<const T> a, MatrixView<const T> b,
+                 MatrixView<T> c, T alpha) {
+    const std::size_t m = c.rows();
+    const std::size_t n = c.cols();
+    const std::size_t k = a.cols();
+    const std::size_t kc_max = std::min(g.kc, k);
+    const std::size_t mc_max = std::min(g.mc, (m + g.mr - 1) / g.mr * g.mr);
+    const std::size_t nc_max = std::min(g.nc, (n + g.nr - 1) / g.nr * g.nr);
+    PackBuffer<T> packed_a(mc_max * kc_max);
+    PackBuffer<T> packed_b(kc_max * nc_max);
+    alignas(64) T edge[16 * 64];
+
+    for (std::size_t jc = 0; jc < n; jc += g.nc) {
+        const std::size_t nc = std::min(g.nc, n - jc);
+        for (std::size_t pc = 0; pc < k; pc += g.kc) {
+            const std::size_t kc = std::min(g.kc, k - pc);
+            pack_b(b.block(pc, jc, kc, nc), g.nr, packed_b.data());
+            for (std::size_t ic = 0; ic < m; ic += g.mc) {
+                const std::size_t mc = std::min(g.mc, m - ic);
+                pack_a(a.block(ic, pc, mc, kc), g.mr, packed_a.data());
+                for (std::size_t jr = 0; jr < nc; jr += g.nr) {
+                    const std::size_t cols = std::min(g.nr, nc - jr);
+                    const T* b_panel = packed_b.data() + jr * kc;
+                    for (std::size_t ir = 0; ir < mc; ir += g.mr) {
+                        const std::size_t rows = std::min(g.mr, mc - ir);
+                        const T* a_panel = packed_a.data() + ir * kc;
+                        T* out = &c(ic + ir, jc + jr);
+                        if (rows == g.mr && cols == g.nr) {
+                            g.kernel(kc, a_panel, b_panel, out, c.stride(), alpha);
+                            continue;
+                        }
+                        // Partial tile: compute the full tile aside, add the valid part
+                        std::fill(edge, edge + g.mr * g.nr, T{0});
+                        g.kernel(kc, a_panel, b_panel, edge, g.nr, alpha);
+                        for (std::size_t r = 0; r < rows; ++r) {
+                            for (std::size_t j = 0; j < cols; ++j) {
+                                out[r * c.stride() + j] += edge[r * g.nr + j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// Products below this many flops run on the calling thread only
+constexpr double ParallelFlops = 8.0e6;
+
+std::atomic<std::size_t> gemm_thread_limit{0};
+
+template<typename T>
+void gemm(MatrixView<const T> a, MatrixView<const T> b, MatrixView<T> c, T alpha, T beta,
+          core::ThreadPool& pool) {
+    if (a.cols() != b.rows() || a.rows() != c.rows() || b.cols() != c.cols()) {
+        throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+    }
+    if (beta != T{1}) {
+        scale(c, beta);
+    }
+    if (c.empty() || a.cols() == 0 || alpha == T{0}) {
+        return;
+    }
+
+    const auto g = select_kernel<T>();
+    const std::size_t m = c.rows();
+    const std::size_t n = c.cols();
+    const double flops = 2.0 * static_cast<double>(m) * static_cast<double>(n) *
+                         static_cast<double>(a.cols());
+    std::size_t threads = std::min(gemm_threads(), pool.size());
+    if (flops < ParallelFlops) {
+        threads = 1;
+    }
+
+    // Split the larger of m and n into whole register tiles, one part per thread
+    const bool split_rows = m >= n;
+    const std::size_t unit = split_rows ? g.mr : g.nr;
+    const std::size_t tiles = ((split_rows ? m : n) + unit - 1) / unit;
+    threads = std::min(threads, tiles);
+    if (threads <= 1) {
+        gemm_serial(g, a, b, c, alpha);
+        return;
+    }
+
+    const std::size_t extent = split_rows ? m : n;
+    pool.parallel_for(threads, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t t = first; t < last; ++t) {
+            const std::size_t begin = std::min(extent, tiles * t / threads * unit);
+            const std::size_t end = std::min(extent, tiles * (t + 1) / threads * unit);
+            if (split_rows) {
+                gemm_serial(g, a.block(begin, 0, end - begin, a.cols()), b,
+                            c.block(begin, 0, end - begin, n), alpha);
+            } else {
+                gemm_serial(g, a, b.block(0, begin, b.rows(), end - begin),
+                            c.block(0, begin, m, end - begin), alpha);
+            }
+        }
+    });
+}
+
+} // namespace
+
+void multiply(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c,
+              float alpha, float beta, core::ThreadPool& pool) {
+    gemm(a, b, c, alpha, beta, pool);
+}
+
+void multiply(MatrixView<const double> a, MatrixView<const double> b, MatrixView<double> c,
+              double alpha, double beta, core::ThreadPool& pool) {
+    gemm(a, b, c, alpha, beta, pool);
+}
+
+std::size_t gemm_threads() noexcept {
+    const std::size_t limit = gemm_thread_limit.load(std::memory_order_relaxed);
+    if (limit != 0) {
+        return limit;
+    }
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void set_gemm_threads(std::size_t threads) noexcept {
+    gemm_thread_limit.store(threads, std::memory_order_relaxed);
+}
 
-} // namespace cpptemplate::math
\ No newline at end of file
+} // namespace cpptemplate::math
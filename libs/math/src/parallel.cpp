@@ -0,0 +1,229 @@
+#include "cpptemplate/math/parallel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace cpptemplate::math {
+
+namespace {
+
+/// Elements per reduction chunk; fixed so results do not depend on the pool size
+constexpr std::size_t ReduceChunk = std::size_t{1} << 15;
+
+/// Shortest run worth sorting on its own thread
+constexpr std::size_t SortRun = std::size_t{1} << 14;
+
+/// Output elements per merge task
+constexpr std::size_t MergePiece = std::size_t{1} << 16;
+
+/// Pairwise below 256 elements: 8 independent accumulators, which also vectorize
+template<typename Term>
+double pairwise_sum(std::size_t begin, std::size_t end, const Term& term) noexcept {
+    if (end - begin > 256) {
+        const std::size_t middle = begin + (end - begin) / 2;
+        return pairwise_sum(begin, middle, term) + pairwise_sum(middle, end, term);
+    }
+    double acc[8] = {};
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        for (std::size_t k = 0; k < 8; ++k) {
+            acc[k] += term(i + k);
+        }
+    }
+    for (; i < end; ++i) {
+        acc[0] += term(i);
+    }
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+/// Sum term(0..n) chunk by chunk on the pool
+template<typename Term>
+double parallel_pairwise_sum(std::size_t n, const Term& term, core::ThreadPool& pool) {
+    const std::size_t chunks = (n + ReduceChunk - 1) / ReduceChunk;
+    if (chunks <= 1) {
+        return pairwise_sum(0, n, term);
+    }
+    std::vector<double> partial(chunks);
+    pool.parallel_for(chunks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last; ++c) {
+            partial[c] = pairwise_sum(c * ReduceChunk, std::min(n, (c + 1) * ReduceChunk), term);
+        }
+    });
+    return pairwise_sum(0, chunks, [&](std::size_t c) { return partial[c]; });
+}
+
+MinMax min_max(std::span<const double> values, std::size_t offset) noexcept {
+    MinMax result{values[0], values[0], offset, offset};
+    for (std::size_t i = 1; i < values.size(); ++i) {
+        if (values[i] < result.min) {
+            result.min = values[i];
+            result.argmin = offset + i;
+        }
+        if (values[i] > result.max) {
+            result.max = values[i];
+            result.argmax = offset + i;
+        }
+    }
+    return result;
+}
+
+/**
+ * Number of elements taken from a when the first k outputs of a stable
+ * merge of a and b are formed (merge path co-rank)
+ */
+std::size_t co_rank(std::size_t k, std::span<const double> a, std::span<const double> b) noexcept {
+    std::size_t low = k > b.size() ? k - b.size() : 0;
+    std::size_t high = std::min(k, a.size());
+    while (low < high) {
+        const std::size_t i = low + (high - low) / 2;
+        const std::size_t j = k - i;
+        if (j > 0 && i < a.size() && b[j - 1] >= a[i]) {
+            low = i + 1; // a[i] precedes b[j - 1] in the merge, so take more of a
+        } else {
+            high = i;
+        }
+    }
+    return low;
+}
+
+} // namespace
+
+double parallel_sum(std::span<const double> values, core::ThreadPool& pool) {
+    return parallel_pairwise_sum(values.size(), [values](std::size_t i) { return values[i]; }, pool);
+}
+
+double parallel_dot(std::span<const double> a, std::span<const double> b, core::ThreadPool& pool) {
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("Dot product operands must have the same size");
+    }
+    return parallel_pairwise_sum(a.size(), [a, b](std::size_t i) { return a[i] * b[i]; }, pool);
+}
+
+MinMax parallel_min_max(std::span<const double> values, core::ThreadPool& pool) {
+    if (values.empty()) {
+        throw std::invalid_argument("Minimum and maximum of an empty range are undefined");
+    }
+    const std::size_t chunks = (values.size() + ReduceChunk - 1) / ReduceChunk;
+    std::vector<MinMax> partial(chunks);
+    pool.parallel_for(chunks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last; ++c) {
+            const std::size_t begin = c * ReduceChunk;
+            partial[c] = min_max(values.subspan(begin, std::min(ReduceChunk, values.size() - begin)), begin);
+        }
+    });
+    // Chunks in index order with strict comparisons keep the first occurrence
+    MinMax result = partial[0];
+    for (std::size_t c = 1; c < chunks; ++c) {
+        if (partial[c].min < result.min) {
+            result.min = partial[c].min;
+            result.argmin = partial[c].argmin;
+        }
+        if (partial[c].max > result.max) {
+            result.max = partial[c].max;
+            result.argmax = partial[c].argmax;
+        }
+    }
+    return result;
+}
+
+std::vector<std::uint64_t> parallel_histogram(std::span<const double> values, double low, double high,
+                                              std::size_t bins, core::ThreadPool& pool) {
+    if (bins == 0 || !(low < high)) {
+        throw std::invalid_argument("Histogram needs at least one bin and low < high");
+    }
+    // A few private histograms per thread for load balance, each at least one chunk of values
+    const std::size_t chunk = std::max(ReduceChunk, (values.size() + 4 * pool.size() - 1) / (4 * pool.size()));
+    const std::size_t chunks = (values.size() + chunk - 1) / chunk;
+    const double scale = static_cast<double>(bins) / (high - low);
+    std::vector<std::vector<std::uint64_t>> partial(chunks);
+    pool.parallel_for(chunks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last; ++c) {
+            std::vector<std::uint64_t> counts(bins);
+            const std::size_t end = std::min(values.size(), (c + 1) * chunk);
+            for (std::size_t i = c * chunk; i < end; ++i) {
+                const double v = values[i];
+                if (v >= low && v <= high) {
+                    const auto bin = static_cast<std::size_t>((v - low) * scale);
+                    ++counts[std::min(bin, bins - 1)];
+                }
+            }
+            partial[c] = std::move(counts);
+        }
+    });
+
+    std::vector<std::uint64_t> result(bins);
+    pool.parallel_for(bins, 4096, [&](std::size_t first, std::size_t last) {
+        for (const auto& counts : partial) {
+            for (std::size_t b = first; b < last; ++b) {
+                result[b] += counts[b];
+            }
+        }
+    });
+    return result;
+}
+
+void parallel_sort(std::span<double> values, core::ThreadPool& pool) {
+    const std::size_t n = values.size();
+    std::size_t runs = std::bit_ceil(pool.size());
+    while (runs > 1 && n / runs < SortRun) {
+        runs /= 2;
+    }
+    if (runs == 1) {
+        std::sort(values.begin(), values.end());
+        return;
+    }
+    const auto bound = [n, runs](std::size_t run) { return run * n / runs; };
+
+    pool.parallel_for(runs, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t r = first; r < last; ++r) {
+            std::sort(values.begin() + static_cast<std::ptrdiff_t>(bound(r)),
+                      values.begin() + static_cast<std::ptrdiff_t>(bound(r + 1)));
+        }
+    });
+
+    // Merge pairs of sorted groups, doubling the group size each round
+    std::vector<double> buffer(n);
+    std::span<double> source = values;
+    std::span<double> target = buffer;
+    for (std::size_t width = 1; width < runs; width *= 2) {
+        const std::size_t pairs = runs / (2 * width);
+        std::vector<std::size_t> first_piece(pairs + 1, 0);
+        for (std::size_t p = 0; p < pairs; ++p) {
+            const std::size_t length = bound((2 * p + 2) * width) - bound(2 * p * width);
+            first_piece[p + 1] = first_piece[p] + (length + MergePiece - 1) / MergePiece;
+        }
+        pool.parallel_for(first_piece[pairs], 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t piece = first; piece < last; ++piece) {
+                const auto pair = static_cast<std::size_t>(
+                    std::upper_bound(first_piece.begin(), first_piece.end(), piece) - first_piece.begin() - 1);
+                const std::size_t begin = bound(2 * pair * width);
+                const std::size_t middle = bound((2 * pair + 1) * width);
+                const std::size_t end = bound((2 * pair + 2) * width);
+                const auto a = std::span<const double>(source).subspan(begin, middle - begin);
+                const auto b = std::span<const double>(source).subspan(middle, end - middle);
+
+                const std::size_t out_begin = (piece - first_piece[pair]) * MergePiece;
+                const std::size_t out_end = std::min(out_begin + MergePiece, end - begin);
+                const std::size_t a_begin = co_rank(out_begin, a, b);
+                const std::size_t a_end = co_rank(out_end, a, b);
+                std::merge(a.begin() + static_cast<std::ptrdiff_t>(a_begin),
+                           a.begin() + static_cast<std::ptrdiff_t>(a_end),
+                           b.begin() + static_cast<std::ptrdiff_t>(out_begin - a_begin),
+                           b.begin() + static_cast<std::ptrdiff_t>(out_end - a_end),
+                           target.begin() + static_cast<std::ptrdiff_t>(begin + out_begin));
+            }
+        });
+        std::swap(source, target);
+    }
+
+    if (source.data() != values.data()) {
+        pool.parallel_for(n, ReduceChunk, [&](std::size_t first, std::size_t last) {
+            std::copy(source.begin() + static_cast<std::ptrdiff_t>(first),
+                      source.begin() + static_cast<std::ptrdiff_t>(last),
+                      values.begin() + static_cast<std::ptrdiff_t>(first));
+        });
+    }
+}
+
+} // namespace cpptemplate::math
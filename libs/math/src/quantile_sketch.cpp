@@ -0,0 +1,405 @@
+#include "cpptemplate/math/quantile_sketch.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+namespace cpptemplate::math {
+
+namespace {
+
+constexpr std::uint8_t FormatVersion = 1;
+
+/// Upper bound on max_bins accepted from an encoding, so a corrupt header cannot demand gigabytes
+constexpr std::uint64_t MaxEncodedBins = std::uint64_t{1} << 24;
+
+[[noreturn]] void malformed() {
+    throw std::invalid_argument("Malformed quantile sketch encoding");
+}
+
+class Writer {
+public:
+    void byte(std::uint8_t value) {
+        bytes_.push_back(static_cast<std::byte>(value));
+    }
+
+    void varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            byte(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        byte(static_cast<std::uint8_t>(value));
+    }
+
+    void zigzag(std::int64_t value) {
+        varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void f64(double value) {
+        const auto bits = std::bit_cast<std::uint64_t>(value);
+        for (int shift = 0; shift < 64; shift += 8) {
+            byte(static_cast<std::uint8_t>(bits >> shift));
+        }
+    }
+
+    std::vector<std::byte> take() noexcept {
+        return std::move(bytes_);
+    }
+
+private:
+    std::vector<std::byte> bytes_;
+};
+
+class Reader {
+public:
+    explicit Reader(std::span<const std::byte> bytes) noexcept : bytes_(bytes) {}
+
+    std::uint8_t byte() {
+        if (position_ >= bytes_.size()) {
+            malformed();
+        }
+        return std::to_integer<std::uint8_t>(bytes_[position_++]);
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t b = byte();
+            value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return value;
+            }
+        }
+        malformed();
+    }
+
+    std::int64_t zigzag() {
+        const std::uint64_t value = varint();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    double f64() {
+        std::uint64_t bits = 0;
+        for (int shift = 0; shift < 64; shift += 8) {
+            bits |= static_cast<std::uint64_t>(byte()) << shift;
+        }
+        return std::bit_cast<double>(bits);
+    }
+
+    [[nodiscard]] bool done() const noexcept {
+        return position_ == bytes_.size();
+    }
+
+private:
+    std::span<const std::byte> bytes_;
+    std::size_t position_ = 0;
+};
+
+void check_same_accuracy(double a, double b) {
+    if (a != b) {
+        throw std::invalid_argument("Cannot merge quantile sketches with different accuracies");
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+LogMapping::LogMapping(double accuracy) : relative_accuracy(accuracy) {
+    if (!(accuracy >= 1e-6 && accuracy < 1.0)) {
+        throw std::invalid_argument("Relative accuracy must be in [1e-6, 1)");
+    }
+    const double gamma = (1.0 + accuracy) / (1.0 - accuracy);
+    multiplier = 1.0 / std::log1p(2.0 * accuracy / (1.0 - accuracy));
+    representative_scale = 2.0 / (gamma + 1.0);
+    min_indexable = std::numeric_limits<double>::min() * gamma;
+}
+
+} // namespace detail
+
+// QuantileSketch
+
+QuantileSketch::QuantileSketch(double relative_accuracy, std::size_t max_bins)
+    : mapping_(relative_accuracy), max_bins_(max_bins) {
+    if (max_bins == 0) {
+        throw std::invalid_argument("Quantile sketch needs at least one bin");
+    }
+}
+
+void QuantileSketch::add(double value, std::uint64_t count) {
+    if (!std::isfinite(value) || count == 0) {
+        return;
+    }
+    if (value > mapping_.min_indexable) {
+        positive_.add(mapping_.index(value), count, max_bins_, false);
+    } else if (value < -mapping_.min_indexable) {
+        negative_.add(mapping_.index(-value), count, max_bins_, true);
+    } else {
+        zero_count_ += count;
+    }
+    count_ += count;
+    sum_ += value * static_cast<double>(count);
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void QuantileSketch::add(std::span<const double> values) {
+    for (const double value : values) {
+        add(value, 1);
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    check_same_accuracy(relative_accuracy(), other.relative_accuracy());
+    if (other.count_ == 0) {
+        return;
+    }
+    for (std::size_t i = 0; i < other.positive_.bins.size(); ++i) {
+        if (other.positive_.bins[i] != 0) {
+            add_bin(false, other.positive_.offset + static_cast<std::int32_t>(i), other.positive_.bins[i]);
+        }
+    }
+    for (std::size_t i = 0; i < other.negative_.bins.size(); ++i) {
+        if (other.negative_.bins[i] != 0) {
+            add_bin(true, other.negative_.offset + static_cast<std::int32_t>(i), other.negative_.bins[i]);
+        }
+    }
+    zero_count_ += other.zero_count_;
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (!(q >= 0.0 && q <= 1.0)) {
+        throw std::invalid_argument("Quantile must be in [0, 1]");
+    }
+    if (count_ == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count_ - 1));
+    if (rank == 0) {
+        return min_;
+    }
+    if (rank == count_ - 1) {
+        return max_;
+    }
+    // The exact bounds are tighter than the edge bins' representatives
+    const auto clamp = [this](double value) { return std::clamp(value, min_, max_); };
+
+    // Ascending value order: negatives by decreasing magnitude, zeros, positives
+    std::uint64_t seen = 0;
+    for (std::size_t i = negative_.bins.size(); i-- > 0;) {
+        seen += negative_.bins[i];
+        if (seen > rank) {
+            return clamp(-mapping_.value(negative_.offset + static_cast<std::int32_t>(i)));
+        }
+    }
+    seen += zero_count_;
+    if (seen > rank) {
+        return clamp(0.0);
+    }
+    for (std::size_t i = 0; i < positive_.bins.size(); ++i) {
+        seen += positive_.bins[i];
+        if (seen > rank) {
+            return clamp(mapping_.value(positive_.offset + static_cast<std::int32_t>(i)));
+        }
+    }
+    return max_;
+}
+
+void QuantileSketch::reset() noexcept {
+    positive_ = Store{};
+    negative_ = Store{};
+    zero_count_ = 0;
+    count_ = 0;
+    sum_ = 0.0;
+    min_ = std::numeric_limits<double>::infinity();
+    max_ = -std::numeric_limits<double>::infinity();
+}
+
+std::vector<std::byte> QuantileSketch::serialize() const {
+    Writer out;
+    out.byte(FormatVersion);
+    out.f64(relative_accuracy());
+    out.varint(max_bins_);
+    out.varint(zero_count_);
+    out.f64(sum_);
+    out.f64(min_);
+    out.f64(max_);
+    for (const Store* store : {&positive_, &negative_}) {
+        out.zigzag(store->offset);
+        out.varint(store->bins.size());
+        for (const std::uint64_t count : store->bins) {
+            out.varint(count);
+        }
+    }
+    return out.take();
+}
+
+QuantileSketch QuantileSketch::deserialize(std::span<const std::byte> bytes) {
+    Reader in(bytes);
+    if (in.byte() != FormatVersion) {
+        malformed();
+    }
+    const double accuracy = in.f64();
+    const std::uint64_t max_bins = in.varint();
+    if (!(accuracy >= 1e-6 && accuracy < 1.0) || max_bins == 0 || max_bins > MaxEncodedBins) {
+        malformed();
+    }
+    QuantileSketch sketch(accuracy, static_cast<std::size_t>(max_bins));
+    sketch.zero_count_ = in.varint();
+    sketch.sum_ = in.f64();
+    sketch.min_ = in.f64();
+    sketch.max_ = in.f64();
+    sketch.count_ = sketch.zero_count_;
+    for (Store* store : {&sketch.positive_, &sketch.negative_}) {
+        const std::int64_t offset = in.zigzag();
+        const std::uint64_t size = in.varint();
+        if (size > max_bins || offset < std::numeric_limits<std::int32_t>::min() ||
+            offset + static_cast<std::int64_t>(size) > std::numeric_limits<std::int32_t>::max()) {
+            malformed();
+        }
+        store->offset = static_cast<std::int32_t>(offset);
+        store->bins.resize(static_cast<std::size_t>(size));
+        for (auto& count : store->bins) {
+            count = in.varint();
+            sketch.count_ += count;
+        }
+    }
+    if (!in.done() || (sketch.count_ != 0 && !(sketch.min_ <= sketch.max_))) {
+        malformed();
+    }
+    return sketch;
+}
+
+void QuantileSketch::add_bin(bool negative, std::int32_t index, std::uint64_t count) {
+    (negative ? negative_ : positive_).add(index, count, max_bins_, negative);
+}
+
+void QuantileSketch::Store::grow(std::int32_t index, std::uint64_t count, std::size_t max_bins,
+                                 bool collapse_high) {
+    if (bins.empty()) {
+        bins.assign(1, count);
+        offset = index;
+        return;
+    }
+    const std::int64_t old_high = offset + static_cast<std::int64_t>(bins.size()) - 1;
+    std::int64_t low = std::min<std::int64_t>(offset, index);
+    std::int64_t high = std::max<std::int64_t>(old_high, index);
+    const auto limit = static_cast<std::int64_t>(max_bins);
+    if (high - low + 1 > limit) {
+        if (collapse_high) {
+            high = low + limit - 1;
+        } else {
+            low = high - limit + 1;
+        }
+    }
+    const std::int64_t target = std::clamp<std::int64_t>(index, low, high);
+
+    if (low == offset) {
+        // Growing upwards (or collapsing into the top bin): amortized append
+        bins.resize(static_cast<std::size_t>(high - low + 1));
+        bins[static_cast<std::size_t>(target - low)] += count;
+        return;
+    }
+    std::vector<std::uint64_t> grown(static_cast<std::size_t>(high - low + 1));
+    for (std::size_t i = 0; i < bins.size(); ++i) {
+        const std::int64_t slot = std::clamp<std::int64_t>(offset + static_cast<std::int64_t>(i), low, high);
+        grown[static_cast<std::size_t>(slot - low)] += bins[i];
+    }
+    grown[static_cast<std::size_t>(target - low)] += count;
+    bins = std::move(grown);
+    offset = static_cast<std::int32_t>(low);
+}
+
+// ConcurrentQuantileSketch
+
+ConcurrentQuantileSketch::ConcurrentQuantileSketch(double relative_accuracy, double min_magnitude,
+                                                   double max_magnitude)
+    : mapping_(relative_accuracy) {
+    if (!(min_magnitude > 0.0 && min_magnitude <= max_magnitude && std::isfinite(max_magnitude))) {
+        throw std::invalid_argument("Magnitude range must satisfy 0 < min <= max < infinity");
+    }
+    min_index_ = mapping_.index(std::max(min_magnitude, mapping_.min_indexable));
+    const std::int32_t max_index = mapping_.index(std::max(max_magnitude, mapping_.min_indexable));
+    bins_ = static_cast<std::size_t>(max_index - min_index_ + 1);
+    positive_ = std::make_unique<std::atomic<std::uint64_t>[]>(bins_);
+    negative_ = std::make_unique<std::atomic<std::uint64_t>[]>(bins_);
+}
+
+void ConcurrentQuantileSketch::add(double value) noexcept {
+    if (!std::isfinite(value)) {
+        return;
+    }
+    const double magnitude = std::abs(value);
+    if (magnitude > mapping_.min_indexable) {
+        add_bin(value < 0.0, mapping_.index(magnitude), 1);
+    } else {
+        zero_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    update_bounds(value, value, value);
+}
+
+void ConcurrentQuantileSketch::merge(const QuantileSketch& sketch) {
+    check_same_accuracy(relative_accuracy(), sketch.relative_accuracy());
+    if (sketch.empty()) {
+        return;
+    }
+    for (std::size_t i = 0; i < sketch.positive_.bins.size(); ++i) {
+        if (sketch.positive_.bins[i] != 0) {
+            add_bin(false, sketch.positive_.offset + static_cast<std::int32_t>(i), sketch.positive_.bins[i]);
+        }
+    }
+    for (std::size_t i = 0; i < sketch.negative_.bins.size(); ++i) {
+        if (sketch.negative_.bins[i] != 0) {
+            add_bin(true, sketch.negative_.offset + static_cast<std::int32_t>(i), sketch.negative_.bins[i]);
+        }
+    }
+    zero_count_.fetch_add(sketch.zero_count_, std::memory_order_relaxed);
+    update_bounds(sketch.min_, sketch.max_, sketch.sum_);
+}
+
+QuantileSketch ConcurrentQuantileSketch::snapshot() const {
+    QuantileSketch result(relative_accuracy(), std::max(QuantileSketch::DefaultMaxBins, bins_));
+    for (std::size_t i = 0; i < bins_; ++i) {
+        const auto index = min_index_ + static_cast<std::int32_t>(i);
+        if (const auto count = positive_[i].load(std::memory_order_relaxed); count != 0) {
+            result.add_bin(false, index, count);
+            result.count_ += count;
+        }
+        if (const auto count = negative_[i].load(std::memory_order_relaxed); count != 0) {
+            result.add_bin(true, index, count);
+            result.count_ += count;
+        }
+    }
+    result.zero_count_ = zero_count_.load(std::memory_order_relaxed);
+    result.count_ += result.zero_count_;
+    if (result.count_ != 0) {
+        result.sum_ = sum_.load(std::memory_order_relaxed);
+        result.min_ = min_.load(std::memory_order_relaxed);
+        result.max_ = max_.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void ConcurrentQuantileSketch::add_bin(bool negative, std::int32_t index, std::uint64_t count) noexcept {
+    const auto slot = static_cast<std::size_t>(
+        std::clamp<std::int64_t>(static_cast<std::int64_t>(index) - min_index_, 0,
+                                 static_cast<std::int64_t>(bins_) - 1));
+    (negative ? negative_ : positive_)[slot].fetch_add(count, std::memory_order_relaxed);
+}
+
+void ConcurrentQuantileSketch::update_bounds(double min, double max, double sum) noexcept {
+    sum_.fetch_add(sum, std::memory_order_relaxed);
+    double current = min_.load(std::memory_order_relaxed);
+    while (min < current && !min_.compare_exchange_weak(current, min, std::memory_order_relaxed)) {
+    }
+    current = max_.load(std::memory_order_relaxed);
+    while (max > current && !max_.compare_exchange_weak(current, max, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace cpptemplate::math
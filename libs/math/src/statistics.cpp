@@ -1 +1,261 @@
-// Stub implementation
+#include "cpptemplate/math/statistics.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "batch_kernels.hpp"
+
+#if CPPTEMPLATE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+namespace cpptemplate::math {
+
+namespace {
+
+/// Values summarized per kernel call; 16 KiB stays in L1 for the second pass
+constexpr std::size_t BlockSize = 2048;
+
+/// Exact moments of one block, from a two-pass summary of L1-resident data
+struct BlockMoments {
+    double mean;
+    double m2;
+    double m3;
+    double m4;
+    double min;
+    double max;
+};
+
+using BlockKernel = BlockMoments (*)(const double* values, std::size_t n) noexcept;
+
+BlockMoments block_scalar(const double* values, std::size_t n) noexcept {
+    double sum = 0.0;
+    double min = values[0];
+    double max = values[0];
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += values[i];
+        min = std::min(min, values[i]);
+        max = std::max(max, values[i]);
+    }
+    const double mean = sum / static_cast<double>(n);
+    double m2 = 0.0;
+    double m3 = 0.0;
+    double m4 = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double d = values[i] - mean;
+        const double d2 = d * d;
+        m2 += d2;
+        m3 += d2 * d;
+        m4 += d2 * d2;
+    }
+    return {mean, m2, m3, m4, min, max};
+}
+
+#if CPPTEMPLATE_X86_KERNELS
+
+CPPTEMPLATE_AVX2 inline double hsum(__m256d v) noexcept {
+    const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+CPPTEMPLATE_AVX2 inline double hmin(__m256d v) noexcept {
+    const __m128d pair = _mm_min_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_min_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+CPPTEMPLATE_AVX2 inline double hmax(__m256d v) noexcept {
+    const __m128d pair = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+// _mm512_min/max_pd, _mm512_extractf64x4_pd and _mm512_castpd512_pd256 pass an undefined merge source
+// that GCC 12 flags with -Wmaybe-uninitialized; the full-mask forms compile to
+// the same instructions
+CPPTEMPLATE_AVX512 inline __m512d min512(__m512d a, __m512d b) noexcept {
+    return _mm512_mask_min_pd(a, 0xFF, a, b);
+}
+
+CPPTEMPLATE_AVX512 inline __m512d max512(__m512d a, __m512d b) noexcept {
+    return _mm512_mask_max_pd(a, 0xFF, a, b);
+}
+
+CPPTEMPLATE_AVX512 inline __m256d low_half(__m512d v) noexcept {
+    return _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 0);
+}
+
+CPPTEMPLATE_AVX512 inline __m256d high_half(__m512d v) noexcept {
+    return _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 1);
+}
+
+CPPTEMPLATE_AVX512 inline double hsum(__m512d v) noexcept {
+    return hsum(_mm256_add_pd(low_half(v), high_half(v)));
+}
+
+// Two vectors per iteration to hide add latency; scalar tail
+CPPTEMPLATE_AVX2 BlockMoments block_avx2(const double* values, std::size_t n) noexcept {
+    if (n < 8) {
+        return block_scalar(values, n);
+    }
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    __m256d min = _mm256_loadu_pd(values);
+    __m256d max = min;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256d a = _mm256_loadu_pd(values + i);
+        const __m256d b = _mm256_loadu_pd(values + i + 4);
+        sum0 = _mm256_add_pd(sum0, a);
+        sum1 = _mm256_add_pd(sum1, b);
+        min = _mm256_min_pd(min, _mm256_min_pd(a, b));
+        max = _mm256_max_pd(max, _mm256_max_pd(a, b));
+    }
+    double sum = hsum(_mm256_add_pd(sum0, sum1));
+    double lo = hmin(min);
+    double hi = hmax(max);
+    for (std::size_t j = i; j < n; ++j) {
+        sum += values[j];
+        lo = std::min(lo, values[j]);
+        hi = std::max(hi, values[j]);
+    }
+    const double mean = sum / static_cast<double>(n);
+
+    const __m256d vmean = _mm256_set1_pd(mean);
+    __m256d m2 = _mm256_setzero_pd();
+    __m256d m3 = _mm256_setzero_pd();
+    __m256d m4 = _mm256_setzero_pd();
+    for (std::size_t j = 0; j < i; j += 4) {
+        const __m256d d = _mm256_sub_pd(_mm256_loadu_pd(values + j), vmean);
+        const __m256d d2 = _mm256_mul_pd(d, d);
+        m2 = _mm256_add_pd(m2, d2);
+        m3 = _mm256_add_pd(m3, _mm256_mul_pd(d2, d));
+        m4 = _mm256_add_pd(m4, _mm256_mul_pd(d2, d2));
+    }
+    BlockMoments result{mean, hsum(m2), hsum(m3), hsum(m4), lo, hi};
+    for (std::size_t j = i; j < n; ++j) {
+        const double d = values[j] - mean;
+        const double d2 = d * d;
+        result.m2 += d2;
+        result.m3 += d2 * d;
+        result.m4 += d2 * d2;
+    }
+    return result;
+}
+
+CPPTEMPLATE_AVX512 BlockMoments block_avx512(const double* values, std::size_t n) noexcept {
+    if (n < 16) {
+        return block_scalar(values, n);
+    }
+    __m512d sum0 = _mm512_setzero_pd();
+    __m512d sum1 = _mm512_setzero_pd();
+    __m512d min = _mm512_loadu_pd(values);
+    __m512d max = min;
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512d a = _mm512_loadu_pd(values + i);
+        const __m512d b = _mm512_loadu_pd(values + i + 8);
+        sum0 = _mm512_add_pd(sum0, a);
+        sum1 = _mm512_add_pd(sum1, b);
+        min = min512(min, min512(a, b));
+        max = max512(max, max512(a, b));
+    }
+    double sum = hsum(_mm512_add_pd(sum0, sum1));
+    double lo = hmin(_mm256_min_pd(low_half(min), high_half(min)));
+    double hi = hmax(_mm256_max_pd(low_half(max), high_half(max)));
+    for (std::size_t j = i; j < n; ++j) {
+        sum += values[j];
+        lo = std::min(lo, values[j]);
+        hi = std::max(hi, values[j]);
+    }
+    const double mean = sum / static_cast<double>(n);
+
+    const __m512d vmean = _mm512_set1_pd(mean);
+    __m512d m2 = _mm512_setzero_pd();
+    __m512d m3 = _mm512_setzero_pd();
+    __m512d m4 = _mm512_setzero_pd();
+    for (std::size_t j = 0; j < i; j += 8) {
+        const __m512d d = _mm512_sub_pd(_mm512_loadu_pd(values + j), vmean);
+        const __m512d d2 = _mm512_mul_pd(d, d);
+        m2 = _mm512_add_pd(m2, d2);
+        m3 = _mm512_add_pd(m3, _mm512_mul_pd(d2, d));
+        m4 = _mm512_add_pd(m4, _mm512_mul_pd(d2, d2));
+    }
+    BlockMoments result{mean, hsum(m2), hsum(m3), hsum(m4), lo, hi};
+    for (std::size_t j = i; j < n; ++j) {
+        const double d = values[j] - mean;
+        const double d2 = d * d;
+        result.m2 += d2;
+        result.m3 += d2 * d;
+        result.m4 += d2 * d2;
+    }
+    return result;
+}
+
+#endif // CPPTEMPLATE_X86_KERNELS
+
+BlockKernel select_block_kernel() noexcept {
+    switch (core::simd_level()) {
+#if CPPTEMPLATE_X86_KERNELS
+        case core::SimdLevel::Avx512: return block_avx512;
+        case core::SimdLevel::Avx2: return block_avx2;
+#endif
+        default: return block_scalar;
+    }
+}
+
+} // namespace
+
+void RunningStats::add(std::span<const double> values) noexcept {
+    const BlockKernel kernel = select_block_kernel();
+    while (!values.empty()) {
+        const std::size_t n = std::min(values.size(), BlockSize);
+        const BlockMoments block = kernel(values.data(), n);
+        merge(n, block.mean, block.m2, block.m3, block.m4, block.min, block.max);
+        values = values.subspan(n);
+    }
+}
+
+void RunningStats::merge(const RunningStats& other) noexcept {
+    merge(other.count_, other.mean_, other.m2_, other.m3_, other.m4_, other.min_, other.max_);
+}
+
+void RunningStats::merge(std::uint64_t count, double mean, double m2, double m3, double m4,
+                         double min, double max) noexcept {
+    if (count == 0) {
+        return;
+    }
+    if (count_ == 0) {
+        count_ = count;
+        mean_ = mean;
+        m2_ = m2;
+        m3_ = m3;
+        m4_ = m4;
+        min_ = min;
+        max_ = max;
+        return;
+    }
+
+    // Pébay, "Formulas for robust, one-pass parallel computation of
+    // covariances and arbitrary-order statistical moments" (2008)
+    const double na = static_cast<double>(count_);
+    const double nb = static_cast<double>(count);
+    const double n = na + nb;
+    const double delta = mean - mean_;
+    const double delta_n = delta / n;
+    const double delta_n2 = delta_n * delta_n;
+    const double cross = delta * delta_n * na * nb; // delta^2 * na * nb / n
+
+    const double new_m4 = m4_ + m4 + cross * delta_n2 * (na * na - na * nb + nb * nb) +
+                          6.0 * delta_n2 * (na * na * m2 + nb * nb * m2_) +
+                          4.0 * delta_n * (na * m3 - nb * m3_);
+    const double new_m3 = m3_ + m3 + cross * delta_n * (na - nb) +
+                          3.0 * delta_n * (na * m2 - nb * m2_);
+    m2_ += m2 + cross;
+    m3_ = new_m3;
+    m4_ = new_m4;
+    mean_ += delta_n * nb;
+    count_ += count;
+    min_ = std::min(min_, min);
+    max_ = std::max(max_, max);
+}
+
+} // namespace cpptemplate::math
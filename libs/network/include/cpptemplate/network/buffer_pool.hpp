@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cpptemplate/network/export.hpp"
+
+namespace cpptemplate::network {
+
+/**
+ * @brief Byte buffer with separate read and write positions
+ *
+ * Bytes in [begin, end) are readable, bytes in [end, capacity) writable.
+ * The memory belongs to the BufferPool that handed the buffer out (or, once
+ * grown past the pool's size, to the buffer itself until it goes back to
+ * the pool), so a Buffer is a plain movable handle.
+ */
+class Buffer {
+public:
+    Buffer() = default;
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    Buffer(Buffer&& other) noexcept
+        : data_(other.data_), capacity_(other.capacity_), begin_(other.begin_), end_(other.end_) {
+        other.data_ = nullptr;
+        other.capacity_ = other.begin_ = other.end_ = 0;
+    }
+
+    Buffer& operator=(Buffer&& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(begin_, other.begin_);
+        std::swap(end_, other.end_);
+        return *this;
+    }
+
+    /// Whether the buffer holds memory
+    [[nodiscard]] explicit operator bool() const noexcept {
+        return data_ != nullptr;
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    /// Bytes waiting to be read
+    [[nodiscard]] std::size_t size() const noexcept {
+        return end_ - begin_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return begin_ == end_;
+    }
+
+    [[nodiscard]] std::string_view readable() const noexcept {
+        return {data_ + begin_, end_ - begin_};
+    }
+
+    [[nodiscard]] char* write_position() noexcept {
+        return data_ + end_;
+    }
+
+    /// Bytes free after the readable ones
+    [[nodiscard]] std::size_t writable() const noexcept {
+        return capacity_ - end_;
+    }
+
+    /// Mark n bytes at write_position() as written
+    void commit(std::size_t n) noexcept {
+        end_ += static_cast<std::uint32_t>(n);
+    }
+
+    /// Drop n bytes from the front of the readable ones
+    void consume(std::size_t n) noexcept {
+        begin_ += static_cast<std::uint32_t>(n);
+        if (begin_ == end_) {
+            begin_ = end_ = 0;
+        }
+    }
+
+    /**
+     * @brief Append bytes up to the free space
+     * @param bytes Bytes to append
+     * @return Number of bytes appended
+     */
+    std::size_t append(std::string_view bytes) noexcept;
+
+    /// Move the readable bytes to the front, making all free space writable
+    void compact() noexcept;
+
+private:
+    friend class BufferPool;
+
+    Buffer(char* data, std::size_t capacity) noexcept
+        : data_(data), capacity_(static_cast<std::uint32_t>(capacity)) {}
+
+    char* data_ = nullptr;
+    std::uint32_t capacity_ = 0;
+    std::uint32_t begin_ = 0;
+    std::uint32_t end_ = 0;
+};
+
+/**
+ * @brief Free list of equally sized I/O buffers
+ *
+ * Connections take a buffer only while they have bytes in flight and give it
+ * back when idle, so memory follows the number of busy connections rather
+ * than open ones. Released buffers are cached up to a limit for the next
+ * acquire(). Not thread-safe: each reactor owns its own pool.
+ */
+class CPPTEMPLATE_NETWORK_API BufferPool {
+public:
+    /**
+     * @brief Create an empty pool
+     * @param buffer_size Capacity of each buffer
+     * @param max_cached Released buffers kept for reuse; more are freed
+     */
+    explicit BufferPool(std::size_t buffer_size = 16384, std::size_t max_cached = 1024);
+
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * @brief Take an empty buffer
+     * @return Buffer of buffer_size() bytes
+     */
+    [[nodiscard]] Buffer acquire();
+
+    /**
+     * @brief Return a buffer, leaving it empty
+     *
+     * Buffers grown past buffer_size() are freed rather than cached.
+     *
+     * @param buffer Buffer from acquire() or grow(); nothing happens if it holds no memory
+     */
+    void release(Buffer& buffer) noexcept;
+
+    /**
+     * @brief Move a buffer's readable bytes into a larger one
+     * @param buffer Buffer to grow; keeps its readable bytes
+     * @param capacity New capacity, larger than the current one
+     */
+    void grow(Buffer& buffer, std::size_t capacity);
+
+    [[nodiscard]] std::size_t buffer_size() const noexcept {
+        return buffer_size_;
+    }
+
+    /// Buffers handed out and not yet released
+    [[nodiscard]] std::size_t outstanding() const noexcept {
+        return outstanding_;
+    }
+
+    /// Released buffers kept for reuse
+    [[nodiscard]] std::size_t cached() const noexcept {
+        return free_.size();
+    }
+
+private:
+    std::size_t buffer_size_;
+    std::size_t max_cached_;
+    std::size_t outstanding_ = 0;
+    std::vector<char*> free_;
+};
+
+} // namespace cpptemplate::network
@@ -0,0 +1,20 @@
+#pragma once
+
+// Export macros for dynamic libraries
+#ifdef CPPTEMPLATE_NETWORK_STATIC
+    #define CPPTEMPLATE_NETWORK_API
+#else
+    #ifdef CPPTEMPLATE_NETWORK_BUILDING
+        #if defined(_WIN32) || defined(_WIN64)
+            #define CPPTEMPLATE_NETWORK_API __declspec(dllexport)
+        #else
+            #define CPPTEMPLATE_NETWORK_API __attribute__((visibility("default")))
+        #endif
+    #else
+        #if defined(_WIN32) || defined(_WIN64)
+            #define CPPTEMPLATE_NETWORK_API __declspec(dllimport)
+        #else
+            #define CPPTEMPLATE_NETWORK_API
+        #endif
+    #endif
+#endif
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "cpptemplate/network/export.hpp"
+
+namespace cpptemplate::network {
+
+class Connection;
+
+/**
+ * @brief Header field, both parts viewing the parsed bytes
+ */
+struct HttpHeader {
+    std::string_view name;  ///< As sent; compare case-insensitively
+    std::string_view value; ///< Without surrounding whitespace
+};
+
+/**
+ * @brief HTTP/1.x request as parsed by HttpParser
+ *
+ * Nothing is copied: every view points into the bytes passed to
+ * HttpParser::parse(), so a request is valid only as long as they are.
+ * Headers are held inline, so parsing does not allocate either.
+ */
+struct CPPTEMPLATE_NETWORK_API HttpRequest {
+    /// Headers a request may have; more are answered with 431
+    static constexpr std::size_t MaxHeaders = 64;
+
+    std::string_view method; ///< E.g. "GET"
+    std::string_view target; ///< Request target as sent, e.g. "/search?q=x"
+    std::string_view path;   ///< target up to any '?'
+    std::string_view query;  ///< target after the '?', empty if there is none
+    int minor_version = 1;   ///< 1 for HTTP/1.1, 0 for HTTP/1.0
+    std::string_view body;   ///< Content-Length bytes after the head
+    bool keep_alive = true;  ///< Whether the connection may carry another request
+
+    /// Headers in the order received
+    [[nodiscard]] std::span<const HttpHeader> headers() const noexcept {
+        return {header_fields.data(), header_count};
+    }
+
+    /**
+     * @brief Find a header
+     * @param name Header name, matched case-insensitively
+     * @return Value of the first header called name, or an empty view if there is none
+     */
+    [[nodiscard]] std::string_view header(std::string_view name) const noexcept;
+
+    std::array<HttpHeader, MaxHeaders> header_fields{}; ///< Storage behind headers()
+    std::size_t header_count = 0;                       ///< Headers in use
+};
+
+/**
+ * @brief Limits HttpParser enforces
+ */
+struct HttpLimits {
+    std::size_t max_head = 64 * 1024; ///< Request line and headers; larger heads get a 431
+    std::size_t max_body = 1 << 20;   ///< Content-Length; larger bodies get a 413
+};
+
+/**
+ * @brief Outcome of HttpParser::parse()
+ */
+struct HttpParseResult {
+    enum class Status : std::uint8_t {
+        Complete,   ///< A request was parsed; consumed is its size
+        Incomplete, ///< More bytes are needed; nothing was consumed
+        Error       ///< The bytes are not a valid request; see error
+    };
+
+    Status status = Status::Incomplete;
+    std::size_t consumed = 0; ///< Bytes of the request, when Complete
+    int error = 0;            ///< Status code to answer an Error with: 400, 413, 431, 501 or 505
+};
+
+/**
+ * @brief Incremental, zero-copy HTTP/1.0 and HTTP/1.1 request parser
+ *
+ * Feed it the unconsumed bytes of a connection, starting at the first byte
+ * of the next request. A Complete result describes one request and how
+ * many bytes it took; parse again from there for a pipelined one. An
+ * Incomplete result consumes nothing: call again with the same bytes plus
+ * whatever arrived since. The parser remembers how far it got, so a
+ * request trickling in is not re-parsed from its start for every packet,
+ * and a body still arriving costs a size check.
+ *
+ * Request lines and header values are scanned for their terminating CR or
+ * LF with the SIMD level of core::simd_level(), checking on the way for
+ * bytes a field may not contain. Bare LF line ends are accepted, obsolete
+ * line folding is not, and bodies must be framed by Content-Length: a
+ * Transfer-Encoding is answered with 501, as decoding chunks would mean
+ * copying the body.
+ */
+class CPPTEMPLATE_NETWORK_API HttpParser {
+public:
+    /**
+     * @brief Create a parser
+     * @param limits Size limits to enforce
+     */
+    explicit HttpParser(HttpLimits limits = {}) noexcept : limits_(limits) {}
+
+    /**
+     * @brief Parse the next request
+     * @param bytes Unconsumed bytes, starting where the previous request ended
+     * @param request Filled with views into bytes when Complete; unspecified otherwise
+     * @return Whether a request was parsed, more bytes are needed, or the bytes are invalid
+     */
+    HttpParseResult parse(std::string_view bytes, HttpRequest& request) noexcept;
+
+    /// Forget a partly received request, e.g. before reusing the parser on another connection
+    void reset() noexcept {
+        scanned_ = 0;
+        expected_ = 0;
+    }
+
+private:
+    HttpParseResult parse_head(std::string_view bytes, HttpRequest& request) noexcept;
+
+    HttpLimits limits_;
+    std::size_t scanned_ = 0;  ///< Bytes already known to hold no end of head
+    std::size_t expected_ = 0; ///< Size of the request once its head is known, else 0
+};
+
+/**
+ * @brief Reason phrase of a status code
+ * @param status Status code
+ * @return E.g. "Not Found"; "Unknown" for codes without a standard phrase
+ */
+[[nodiscard]] CPPTEMPLATE_NETWORK_API std::string_view http_reason(int status) noexcept;
+
+/**
+ * @brief HTTP/1.1 response written as one gather write
+ *
+ * The status line and headers are formatted into an inline buffer (a long
+ * head moves to the heap); Content-Length, and "Connection: close" when
+ * keep-alive is off, are added when the head is finished. The body is not
+ * copied: send() and write() hand the head and the body to the kernel
+ * together, as sendmsg() or writev() with two iovecs.
+ */
+class CPPTEMPLATE_NETWORK_API HttpResponse {
+public:
+    /**
+     * @brief Start a response
+     * @param status Status code, 100 to 999
+     * @param reason Reason phrase; http_reason(status) if empty
+     * @throws std::invalid_argument If status is out of range or reason contains
+     *         CR, LF or NUL
+     */
+    explicit HttpResponse(int status = 200, std::string_view reason = {});
+
+    HttpResponse(const HttpResponse&) = delete;
+    HttpResponse& operator=(const HttpResponse&) = delete;
+
+    [[nodiscard]] int status() const noexcept {
+        return status_;
+    }
+
+    /**
+     * @brief Add a header
+     *
+     * Names and values are checked rather than escaped, so that data from a
+     * request cannot end the line and inject headers or a body.
+     *
+     * @throws std::invalid_argument If name is not a token or value contains
+     *         CR, LF or NUL
+     * @throws std::logic_error If the head is already finished
+     */
+    HttpResponse& header(std::string_view name, std::string_view value);
+
+    /**
+     * @brief Set the body without copying it
+     * @param body Bytes that must outlive send() or write()
+     */
+    HttpResponse& body(std::string_view body) noexcept {
+        body_ = body;
+        return *this;
+    }
+
+    /// Set a body the response owns, for one built by the handler
+    HttpResponse& own_body(std::string body) noexcept {
+        owned_body_ = std::move(body);
+        body_ = owned_body_;
+        return *this;
+    }
+
+    [[nodiscard]] std::string_view body() const noexcept {
+        return body_;
+    }
+
+    /// Whether the connection stays open after this response; true by default
+    HttpResponse& keep_alive(bool keep) noexcept {
+        keep_alive_ = keep;
+        return *this;
+    }
+
+    [[nodiscard]] bool keep_alive() const noexcept {
+        return keep_alive_;
+    }
+
+    /**
+     * @brief Finish and get the head
+     * @return Status line, headers and the blank line ending them
+     */
+    [[nodiscard]] std::string_view head();
+
+    /// Head and body, the pieces of the gather write
+    [[nodiscard]] std::array<std::string_view, 2> pieces() {
+        const std::string_view finished = head();
+        return {finished, body_};
+    }
+
+    /**
+     * @brief Send on a connection with one gather write
+     * @return False if the connection is closing or failed
+     */
+    bool send(Connection& connection);
+
+    /**
+     * @brief Write the whole response to a blocking socket or file with writev()
+     * @param fd Descriptor
+     * @return False if a write failed; errno tells why
+     */
+    bool write(int fd);
+
+private:
+    void append(std::string_view text);
+
+    static constexpr std::size_t InlineHead = 512;
+
+    int status_;
+    bool keep_alive_ = true;
+    bool finished_ = false;
+    std::size_t size_ = 0;
+    std::array<char, InlineHead> inline_head_;
+    std::string long_head_; ///< The head once it outgrows inline_head_
+    std::string_view body_;
+    std::string owned_body_;
+};
+
+} // namespace cpptemplate::network
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cpptemplate/core/error.hpp"
+#include "cpptemplate/core/expected.hpp"
+#include "cpptemplate/network/export.hpp"
+
+namespace cpptemplate::network {
+
+namespace detail {
+class ClientLoop;
+} // namespace detail
+
+/**
+ * @brief Why an HttpClient request failed
+ */
+enum class HttpClientErrc {
+    InvalidUrl = 1,   ///< Not an http:// URL with a host
+    ResolveFailed,    ///< The host name did not resolve
+    ConnectFailed,    ///< No connection could be made
+    ConnectionClosed, ///< The connection closed or failed before the response was complete
+    Timeout,          ///< No complete response within HttpClientOptions::request_timeout
+    BadResponse,      ///< The server's bytes are not an HTTP/1.x response
+    ResponseTooLarge, ///< Over HttpClientOptions::max_response
+    Shutdown          ///< The client was destroyed first
+};
+
+/**
+ * @brief Category of HttpClientErrc
+ * @return Category singleton
+ */
+[[nodiscard]] CPPTEMPLATE_NETWORK_API const core::ErrorCategory& http_client_category() noexcept;
+
+/**
+ * @brief Convert an HttpClientErrc to a core::Error
+ * @param code Error code
+ * @return Error in http_client_category()
+ */
+[[nodiscard]] inline core::Error make_error(HttpClientErrc code) noexcept {
+    return {static_cast<int>(code), http_client_category()};
+}
+
+/**
+ * @brief Settings of an HttpClient
+ */
+struct HttpClientOptions {
+    std::size_t max_connections_per_host = 8;          ///< Open connections per host and port
+    std::size_t max_pipeline = 8;                      ///< Per connection; 1 turns pipelining off
+    bool keep_alive = true;                            ///< False opens one connection per request
+    std::chrono::milliseconds idle_timeout{30'000};    ///< Close pooled connections idle this long
+    std::chrono::milliseconds request_timeout{30'000}; ///< Dispatch to full response; 0 for none
+    std::chrono::seconds dns_ttl{60};                  ///< How long a resolved host name is reused
+    std::size_t max_response = 64 << 20;               ///< Head plus body; larger responses fail
+};
+
+/**
+ * @brief Request for HttpClient
+ */
+struct HttpClientRequest {
+    std::string method = "GET";
+    std::string url; ///< "http://host[:port][/path][?query]"; IPv6 hosts in brackets
+    /// Host and Content-Length are added if absent
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+};
+
+/**
+ * @brief Response received by HttpClient
+ */
+struct CPPTEMPLATE_NETWORK_API HttpClientResponse {
+    int status = 0;
+    std::string head; ///< Status line and header lines as received
+    std::string body; ///< Without chunked framing
+
+    /**
+     * @brief Find a header
+     * @param name Header name, matched case-insensitively
+     * @return Value of the first header called name, or an empty view if there is none
+     */
+    [[nodiscard]] std::string_view header(std::string_view name) const noexcept;
+};
+
+/// Response or the reason there is none
+using HttpResult = core::Expected<HttpClientResponse>;
+
+/**
+ * @brief Counters of an HttpClient
+ */
+struct HttpClientStats {
+    std::uint64_t requests = 0;    ///< Completed, with a response or an error
+    std::uint64_t connections = 0; ///< Connections opened
+    std::uint64_t reused = 0;      ///< Requests sent on a connection that had carried one before
+    std::uint64_t pipelined = 0;   ///< Requests sent behind another in flight on their connection
+    std::uint64_t retried = 0;     ///< Requests sent again after their connection closed under them
+};
+
+/**
+ * @brief Asynchronous HTTP/1.1 client with per-host connection pools
+ *
+ * Requests go to a pool per host and port. A request takes an idle pooled
+ * connection if there is one, else opens a new one up to
+ * max_connections_per_host, else is pipelined behind the requests in
+ * flight on the least loaded connection, up to max_pipeline; the rest
+ * wait for a connection to free up. Only idempotent requests (GET, HEAD,
+ * PUT, DELETE, OPTIONS, TRACE) are pipelined, and only behind other
+ * idempotent ones (RFC 9112, 9.3.2). Those are also sent once more on a
+ * fresh connection if theirs closes before they are answered, which
+ * covers a server dropping an idle keep-alive connection as a request is
+ * sent. Host names are cached for dns_ttl. A lookup the cache cannot
+ * answer runs on the calling thread, or on a resolver thread when
+ * request() is called from a callback or a coroutine resumed by fetch(),
+ * so the event loop never waits for DNS.
+ *
+ * One event loop thread does all the I/O and runs every callback, in the
+ * order responses arrive, which for one connection is the order the
+ * requests were sent. Callbacks never run inside request(). request() and
+ * fetch() may be called from any thread, callbacks included; exceptions
+ * thrown by callbacks are ignored. Plain http only: there is no TLS.
+ *
+ * @example
+ * ```cpp
+ * HttpClient client;
+ * client.get("http://127.0.0.1:8080/health", [](HttpResult result) {
+ *     if (result.has_value()) {
+ *         std::cout << result.value().status << '\n';
+ *     }
+ * });
+ * ```
+ */
+class CPPTEMPLATE_NETWORK_API HttpClient {
+public:
+    /// Receives the response; runs on the client's loop thread
+    using Callback = std::function<void(HttpResult result)>;
+
+    /**
+     * @brief Awaitable returned by fetch()
+     *
+     * The coroutine resumes on the client's loop thread.
+     */
+    class Awaiter {
+    public:
+        [[nodiscard]] bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            client_->request(std::move(request_), [this, handle](HttpResult result) {
+                result_.emplace(std::move(result));
+                handle.resume();
+            });
+        }
+
+        HttpResult await_resume() {
+            return std::move(*result_);
+        }
+
+    private:
+        friend class HttpClient;
+
+        Awaiter(HttpClient& client, HttpClientRequest request) noexcept
+            : client_(&client), request_(std::move(request)) {}
+
+        HttpClient* client_;
+        HttpClientRequest request_;
+        std::optional<HttpResult> result_;
+    };
+
+    /**
+     * @brief Create a client and start its event loop
+     * @param options Settings
+     * @throws std::invalid_argument If max_connections_per_host or max_pipeline is 0
+     * @throws core::Exception If the event loop cannot be set up, or off Linux
+     */
+    explicit HttpClient(HttpClientOptions options = {});
+
+    /// Fail pending requests with HttpClientErrc::Shutdown and stop the loop; not from a callback
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    /**
+     * @brief Send a request
+     * @param request Request
+     * @param callback Called once with the response or the error
+     */
+    void request(HttpClientRequest request, Callback callback);
+
+    /// GET url
+    void get(std::string url, Callback callback) {
+        HttpClientRequest request;
+        request.url = std::move(url);
+        this->request(std::move(request), std::move(callback));
+    }
+
+    /**
+     * @brief Send a request from a coroutine
+     * @return Awaitable producing the HttpResult
+     *
+     * @example
+     * ```cpp
+     * HttpResult result = co_await client.fetch({.url = "http://127.0.0.1:8080/"});
+     * ```
+     */
+    [[nodiscard]] Awaiter fetch(HttpClientRequest request) noexcept {
+        return {*this, std::move(request)};
+    }
+
+    /// Counters; each is read without stopping the loop
+    [[nodiscard]] HttpClientStats stats() const noexcept;
+
+    [[nodiscard]] const HttpClientOptions& options() const noexcept {
+        return options_;
+    }
+
+private:
+    HttpClientOptions options_;
+    std::unique_ptr<detail::ClientLoop> loop_;
+};
+
+} // namespace cpptemplate::network
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cpptemplate/network/buffer_pool.hpp"
+#include "cpptemplate/network/export.hpp"
+
+namespace cpptemplate::network {
+
+namespace detail {
+class Reactor;
+class EpollReactor;
+class UringReactor;
+struct OutputQueue;
+} // namespace detail
+
+/**
+ * @brief How a TcpServer's event loops wait for the kernel
+ */
+enum class Backend : std::uint8_t {
+    Auto,   ///< IoUring when io_uring_available(), else Epoll
+    Epoll,  ///< Edge-triggered epoll readiness with non-blocking system calls
+    IoUring ///< Batched io_uring submissions with multishot accept and receive
+};
+
+/**
+ * @brief Settings of a TcpServer
+ */
+struct ServerOptions {
+    std::string host = "0.0.0.0";       ///< Address to bind, IPv4 or IPv6 literal
+    std::uint16_t port = 0;             ///< Port to bind; 0 picks a free one, see TcpServer::port()
+    std::size_t threads = 0;            ///< Event loops; 0 means one per hardware thread
+    bool reuse_port = true;             ///< One SO_REUSEPORT listener per loop, not a shared one
+    bool pin_threads = false;           ///< Pin loop i to CPU i
+    bool no_delay = true;               ///< Set TCP_NODELAY on accepted sockets
+    int backlog = 4096;                 ///< listen() backlog, capped by net.core.somaxconn
+    std::size_t buffer_size = 16384;    ///< Size of pooled I/O buffers
+    std::size_t max_input = 1 << 20;    ///< Unread input a connection may hold before closing
+    Backend backend = Backend::Auto;    ///< Event mechanism of the loops
+    std::size_t ring_buffers = 1024;    ///< IoUring: receive buffers per loop, a power of two
+};
+
+/**
+ * @brief Counters of a TcpServer, summed over its loops
+ */
+struct ServerStats {
+    std::uint64_t accepted = 0;       ///< Connections accepted since start()
+    std::uint64_t active = 0;         ///< Connections open now
+    std::uint64_t bytes_received = 0;
+    std::uint64_t bytes_sent = 0;
+};
+
+/**
+ * @brief One accepted connection
+ *
+ * Owned by the event loop that accepted it and only valid inside the
+ * server's callbacks, which all run on that loop's thread. Input is read
+ * into a pooled buffer that the connection holds only while it has
+ * unconsumed bytes, and output that the socket cannot take at once is
+ * queued in pooled buffers, so an idle connection costs about 100 bytes
+ * plus the kernel's socket.
+ */
+class CPPTEMPLATE_NETWORK_API Connection {
+public:
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /// Unique over the server's lifetime
+    [[nodiscard]] std::uint64_t id() const noexcept {
+        return id_;
+    }
+
+    /// Socket descriptor
+    [[nodiscard]] int fd() const noexcept {
+        return fd_;
+    }
+
+    /**
+     * @brief Address of the peer
+     * @return "address:port", e.g. "127.0.0.1:52814" or "[::1]:52814"
+     */
+    [[nodiscard]] std::string peer() const;
+
+    /**
+     * @brief Send bytes, queueing what the socket does not take at once
+     * @param bytes Bytes to send
+     * @return False if the connection is closing or failed
+     */
+    bool send(std::string_view bytes);
+
+    /**
+     * @brief Send several pieces with one gather write
+     * @param pieces Bytes to send, in order
+     * @return False if the connection is closing or failed
+     */
+    bool send(std::span<const std::string_view> pieces);
+
+    /// Bytes queued behind the socket, for callers applying backpressure
+    [[nodiscard]] std::size_t pending_output() const noexcept;
+
+    /**
+     * @brief Close once the queued output is sent
+     *
+     * Further input is ignored and further send() calls fail. The close
+     * callback runs when the socket is closed.
+     */
+    void close() noexcept;
+
+    /// Whether close() was called or the connection failed or hung up
+    [[nodiscard]] bool closing() const noexcept {
+        return closing_;
+    }
+
+    /**
+     * @brief Attach state to the connection, e.g. a protocol parser
+     * @param data State kept alive until the connection is destroyed
+     */
+    void set_user_data(std::shared_ptr<void> data) noexcept {
+        user_data_ = std::move(data);
+    }
+
+    /// State set by set_user_data(), cast to T
+    template<typename T>
+    [[nodiscard]] T* user_data() const noexcept {
+        return static_cast<T*>(user_data_.get());
+    }
+
+private:
+    friend class detail::Reactor;
+    friend class detail::EpollReactor;
+    friend class detail::UringReactor;
+
+    Connection(detail::Reactor& reactor, int fd, std::uint32_t slot, std::uint64_t id) noexcept;
+    ~Connection();
+
+    detail::Reactor* reactor_;
+    std::uint64_t id_;
+    int fd_;
+    std::uint32_t slot_;
+    bool closing_ = false;
+    bool failed_ = false;
+    std::uint8_t io_flags_ = 0; ///< Backend bookkeeping, e.g. requests in flight
+    Buffer input_;
+    std::unique_ptr<detail::OutputQueue> output_;
+    std::shared_ptr<void> user_data_;
+};
+
+/**
+ * @brief Multi-reactor TCP server on epoll or io_uring
+ *
+ * Runs one event loop per thread. With reuse_port (the default) each
+ * loop has its own SO_REUSEPORT listener on the same port, so the kernel
+ * spreads new connections over the loops without a shared accept lock.
+ *
+ * The epoll backend keeps sockets non-blocking and edge-triggered. Each is
+ * registered once for input and output, so sending never costs an
+ * epoll_ctl() call. The io_uring backend keeps one multishot accept and one
+ * multishot receive per socket in flight. Receives land in buffers
+ * registered with the kernel, and the sends of a batch of completions go to the
+ * kernel with the next wait, so a busy loop makes one system call per
+ * batch rather than several per request.
+ *
+ * Callbacks run on the loop that owns the connection and must not block.
+ * on_data() receives every byte not yet consumed and returns how many it
+ * consumed. The rest stays buffered and is passed again with the next
+ * bytes, so protocol parsers can wait for whole messages. A callback that
+ * throws closes its connection without flushing it.
+ *
+ * Linux only; start() throws elsewhere.
+ *
+ * @example
+ * ```cpp
+ * TcpServer server({.port = 7000});
+ * server.on_data([](Connection& connection, std::string_view bytes) {
+ *     connection.send(bytes); // echo
+ *     return bytes.size();
+ * });
+ * server.start();
+ * ```
+ */
+class CPPTEMPLATE_NETWORK_API TcpServer {
+public:
+    using ConnectHandler = std::function<void(Connection&)>;
+    /**
+     * Returns the number of bytes consumed, at most bytes.size(). The bytes are
+     * the server's own, so a handler may rewrite those it consumes in place,
+     * e.g. to unmask them.
+     */
+    using DataHandler = std::function<std::size_t(Connection&, std::string_view bytes)>;
+    using CloseHandler = std::function<void(Connection&)>;
+
+    /**
+     * @brief Create a stopped server
+     * @param options Settings
+     * @throws std::invalid_argument If host is not an address literal, the buffer sizes
+     *         are zero, over 4 GiB, or max_input is below buffer_size, or ring_buffers is
+     *         not a power of two up to 32768
+     */
+    explicit TcpServer(ServerOptions options = {});
+
+    /// Calls stop()
+    ~TcpServer();
+
+    TcpServer(const TcpServer&) = delete;
+    TcpServer& operator=(const TcpServer&) = delete;
+
+    /// Set the callback for new connections; call before start()
+    void on_connect(ConnectHandler handler) {
+        on_connect_ = std::move(handler);
+    }
+
+    /// Set the callback for received bytes; call before start(). Without one input is discarded.
+    void on_data(DataHandler handler) {
+        on_data_ = std::move(handler);
+    }
+
+    /// Set the callback for closed connections; call before start()
+    void on_close(CloseHandler handler) {
+        on_close_ = std::move(handler);
+    }
+
+    /**
+     * @brief Bind, listen and start the event loops
+     * @throws core::Exception If the address cannot be bound, a system call fails, the
+     *         IoUring backend was asked for but is not available, or the server is
+     *         already running
+     */
+    void start();
+
+    /**
+     * @brief Stop the event loops and close every connection
+     *
+     * The close callback runs for each open connection. Safe to call more
+     * than once, but not from a callback.
+     */
+    void stop();
+
+    /// Whether start() has run and stop() has not
+    [[nodiscard]] bool running() const noexcept {
+        return !reactors_.empty();
+    }
+
+    /// Bound port, useful with ServerOptions::port 0; 0 before start()
+    [[nodiscard]] std::uint16_t port() const noexcept {
+        return port_;
+    }
+
+    /// Number of event loops while running
+    [[nodiscard]] std::size_t threads() const noexcept {
+        return reactors_.size();
+    }
+
+    /// Backend in use while running: Epoll or IoUring, never Auto
+    [[nodiscard]] Backend backend() const noexcept {
+        return backend_;
+    }
+
+    /// Counters summed over the loops; each is read without stopping the loops
+    [[nodiscard]] ServerStats stats() const noexcept;
+
+    [[nodiscard]] const ServerOptions& options() const noexcept {
+        return options_;
+    }
+
+private:
+    friend class detail::Reactor;
+
+    ServerOptions options_;
+    ConnectHandler on_connect_;
+    DataHandler on_data_;
+    CloseHandler on_close_;
+    std::vector<std::unique_ptr<detail::Reactor>> reactors_;
+    int shared_listener_ = -1; ///< Without reuse_port, the listener all loops accept from
+    std::uint16_t port_ = 0;
+    Backend backend_ = Backend::Epoll;
+};
+
+/**
+ * @brief Whether the io_uring backend can be used
+ *
+ * True if the library was built with ENABLE_IO_URING and the running kernel
+ * has the operations the backend needs (Linux 5.7 or later) and does not
+ * block io_uring, as some sandboxes do. Multishot requests and mapped
+ * buffer rings are used where the kernel has them.
+ *
+ * @return Whether Backend::IoUring would start
+ */
+CPPTEMPLATE_NETWORK_API bool io_uring_available() noexcept;
+
+/**
+ * @brief Raise the soft limit on open files to the hard limit
+ *
+ * Each connection is a file descriptor and the usual soft limit is 1024,
+ * so servers expecting many connections call this at startup.
+ *
+ * @return The limit now in effect
+ */
+CPPTEMPLATE_NETWORK_API std::size_t raise_open_file_limit() noexcept;
+
+} // namespace cpptemplate::network
@@ -0,0 +1,618 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cpptemplate/network/export.hpp"
+#include "cpptemplate/network/http.hpp"
+#include "cpptemplate/network/tcp_server.hpp"
+
+namespace cpptemplate::network {
+
+/**
+ * @brief Frame opcodes (RFC 6455, 5.2)
+ */
+enum class WsOpcode : std::uint8_t {
+    Continuation = 0x0,
+    Text = 0x1,
+    Binary = 0x2,
+    Close = 0x8,
+    Ping = 0x9,
+    Pong = 0xA
+};
+
+/**
+ * @brief Status codes of a Close frame (RFC 6455, 7.4.1)
+ */
+enum class WsCloseCode : std::uint16_t {
+    Normal = 1000,
+    GoingAway = 1001,
+    ProtocolError = 1002,
+    UnsupportedData = 1003,
+    NoStatus = 1005,       ///< Reported when a Close frame had no code; never sent
+    Abnormal = 1006,       ///< Reported when the connection ended without a Close frame; never sent
+    InvalidPayload = 1007, ///< E.g. a text message that is not UTF-8
+    PolicyViolation = 1008,
+    MessageTooBig = 1009,
+    InternalError = 1011
+};
+
+/**
+ * @brief Which end of the connection a parser or frame is for
+ *
+ * Clients mask every frame they send and servers mask none, so each side
+ * rejects frames masked the wrong way.
+ */
+enum class WsRole : std::uint8_t { Server, Client };
+
+/// Masking key of a client frame, in the order it is sent
+using WsMaskKey = std::array<std::uint8_t, 4>;
+
+/// Largest frame header: 2 bytes, 8 of extended length and 4 of masking key
+inline constexpr std::size_t WsMaxHeader = 14;
+
+/**
+ * @brief Limits WsParser enforces
+ */
+struct WsLimits {
+    /// Payload of a message, all fragments together; larger ones fail with 1009
+    std::size_t max_message = 16 << 20;
+};
+
+/**
+ * @brief Message or control frame as parsed by WsParser
+ */
+struct WsMessage {
+    WsOpcode opcode = WsOpcode::Text; ///< Text, Binary, Close, Ping or Pong
+    std::string_view payload;         ///< Unmasked; see WsParser::parse() for how long it is valid
+    bool compressed = false;          ///< RSV1 was set: the payload is permessage-deflate data
+};
+
+/**
+ * @brief Outcome of WsParser::parse()
+ */
+struct WsParseResult {
+    enum class Status : std::uint8_t {
+        Complete,   ///< A message or control frame was parsed
+        Incomplete, ///< More bytes are needed
+        Error       ///< The bytes break the protocol; see close_code
+    };
+
+    Status status = Status::Incomplete;
+    /// Bytes used, whatever the status; drop them before the next call
+    std::size_t consumed = 0;
+    WsCloseCode close_code = WsCloseCode::Normal; ///< Code to close with on Error: 1002 or 1009
+};
+
+/**
+ * @brief Incremental RFC 6455 frame parser that unmasks in place
+ *
+ * Feed it the unconsumed bytes of a connection. A frame that has fully
+ * arrived and is a whole message is unmasked where it lies and returned as
+ * a view of those bytes, so small messages are never copied. Fragments are
+ * gathered in a buffer of the parser's own and returned as one message
+ * once the last arrives; a data frame over 64 KiB is moved there as it
+ * arrives rather than held until complete. Control frames (Close, Ping,
+ * Pong) are returned as they come, also between the fragments of a
+ * message. Masks are removed with the SIMD level of core::simd_level().
+ *
+ * Only bytes reported as consumed are modified. A returned payload is
+ * valid until the next call and, when it views the input, as long as the
+ * bytes passed in. UTF-8 in text messages and the contents of Close frames
+ * are left for the caller to check, since a compressed message can only be
+ * checked once inflated.
+ */
+class CPPTEMPLATE_NETWORK_API WsParser {
+public:
+    /**
+     * @brief Create a parser
+     * @param role Receiving end: a server takes only masked frames, a client only unmasked ones
+     * @param limits Size limits to enforce
+     */
+    explicit WsParser(WsRole role, WsLimits limits = {}) noexcept : limits_(limits), role_(role) {}
+
+    /**
+     * @brief Parse the next message or control frame
+     * @param bytes Unconsumed bytes, starting where the consumed ones ended; modified in place
+     * @param message Filled in when Complete
+     * @return Status, bytes consumed and, on Error, the close code
+     */
+    WsParseResult parse(std::span<char> bytes, WsMessage& message);
+
+    /// Accept RSV1 on the first frame of a message, once permessage-deflate is negotiated
+    void allow_compressed(bool allow) noexcept {
+        allow_compressed_ = allow;
+    }
+
+    /// Forget a partly received message
+    void reset() noexcept;
+
+private:
+    /// Return the gathered fragments as the message
+    WsParseResult deliver(WsMessage& message, std::size_t consumed) noexcept;
+
+    WsLimits limits_;
+    WsRole role_;
+    bool allow_compressed_ = false;
+    bool in_message_ = false;         ///< Fragments of a message are being gathered
+    bool message_compressed_ = false; ///< RSV1 of that message's first frame
+    WsOpcode message_opcode_ = WsOpcode::Text;
+    std::string fragments_;
+    // A data frame streamed into fragments_ as it arrives
+    std::uint64_t frame_left_ = 0; ///< Payload bytes of it still to come; 0 if there is none
+    bool frame_fin_ = false;
+    std::size_t frame_phase_ = 0;  ///< Payload bytes of it already unmasked, mod 4
+    WsMaskKey frame_key_{};
+    bool frame_masked_ = false;
+    bool delivered_ = false;       ///< fragments_ holds a message already returned
+};
+
+/**
+ * @brief XOR bytes with a masking key in place (RFC 6455, 5.3)
+ *
+ * Masking and unmasking are the same operation. Uses the SIMD level of
+ * core::simd_level().
+ *
+ * @param data Bytes to mask or unmask
+ * @param key Masking key of the frame
+ * @param offset Position of data[0] in the frame's payload, for a payload handled in parts
+ */
+CPPTEMPLATE_NETWORK_API void ws_mask(std::span<char> data,
+                                     const WsMaskKey& key,
+                                     std::size_t offset = 0) noexcept;
+
+/**
+ * @brief Check UTF-8 as a text message must be (RFC 3629)
+ *
+ * Overlong forms, surrogates and code points past U+10FFFF are invalid.
+ * ASCII runs are skipped with the SIMD level of core::simd_level().
+ *
+ * @param text Bytes
+ * @return Whether text is well-formed UTF-8
+ */
+[[nodiscard]] CPPTEMPLATE_NETWORK_API bool ws_valid_utf8(std::string_view text) noexcept;
+
+/**
+ * @brief Write a frame header
+ * @param out At least WsMaxHeader bytes
+ * @param opcode Opcode
+ * @param payload_size Payload length
+ * @param key Masking key, which a client must give and a server must not
+ * @param compressed Set RSV1, for the first frame of a permessage-deflate message
+ * @param fin Whether this is the last frame of its message
+ * @return Header length, 2 to 14
+ */
+CPPTEMPLATE_NETWORK_API std::size_t ws_frame_header(
+    char* out,
+    WsOpcode opcode,
+    std::uint64_t payload_size,
+    const std::optional<WsMaskKey>& key = std::nullopt,
+    bool compressed = false,
+    bool fin = true) noexcept;
+
+/**
+ * @brief Append a whole frame to a buffer, masking its payload when a key is given
+ * @param out Buffer to append to
+ * @param opcode Opcode
+ * @param payload Payload, copied
+ * @param key Masking key; a client must give one, see ws_random_mask()
+ * @param compressed Set RSV1
+ */
+CPPTEMPLATE_NETWORK_API void ws_append_frame(std::string& out,
+                                             WsOpcode opcode,
+                                             std::string_view payload,
+                                             const std::optional<WsMaskKey>& key = std::nullopt,
+                                             bool compressed = false);
+
+/// Whole frame in a new string; see ws_append_frame()
+[[nodiscard]] inline std::string ws_frame(WsOpcode opcode, std::string_view payload,
+                                          const std::optional<WsMaskKey>& key = std::nullopt,
+                                          bool compressed = false) {
+    std::string frame;
+    ws_append_frame(frame, opcode, payload, key, compressed);
+    return frame;
+}
+
+/**
+ * @brief Fresh masking key for a client frame
+ * @return Key from the kernel's CSPRNG (getrandom(), drawn in per-thread batches), as
+ *         RFC 6455, 10.3 asks
+ */
+[[nodiscard]] CPPTEMPLATE_NETWORK_API WsMaskKey ws_random_mask() noexcept;
+
+/**
+ * @brief Sec-WebSocket-Accept value answering a Sec-WebSocket-Key (RFC 6455, 4.2.2)
+ * @param key Client's key
+ * @return Base64 of the SHA-1 of key and the protocol's GUID
+ */
+[[nodiscard]] CPPTEMPLATE_NETWORK_API std::string ws_accept_key(std::string_view key);
+
+/**
+ * @brief Random Sec-WebSocket-Key for a client handshake
+ * @return Base64 of 16 bytes from the same source as ws_random_mask()
+ */
+[[nodiscard]] CPPTEMPLATE_NETWORK_API std::string ws_client_key();
+
+/**
+ * @brief Client's opening handshake
+ * @param host Host header value, e.g. "example.com:8080"
+ * @param target Request target, e.g. "/chat"
+ * @param key Key from ws_client_key()
+ * @param deflate Offer permessage-deflate without context takeover, so a WsCompressor used
+ *        with keep_context false suits both directions
+ * @return Request head to send
+ */
+[[nodiscard]] CPPTEMPLATE_NETWORK_API std::string ws_upgrade_request(std::string_view host,
+                                                                     std::string_view target,
+                                                                     std::string_view key,
+                                                                     bool deflate = false);
+
+/**
+ * @brief Check the server's handshake response
+ * @param head Status line and headers, up to and including the blank line
+ * @param key Key the client sent
+ * @param deflate Set to whether permessage-deflate was accepted, if not null
+ * @return Whether the server switched to the WebSocket protocol for this key, with no
+ *         extension other than the permessage-deflate ws_upgrade_request() offers
+ */
+[[nodiscard]] CPPTEMPLATE_NETWORK_API bool ws_check_upgrade_response(
+    std::string_view head,
+    std::string_view key,
+    bool* deflate = nullptr) noexcept;
+
+/**
+ * @brief Whether permessage-deflate is available
+ *
+ * True if the library was built with ENABLE_PERMESSAGE_DEFLATE and zlib
+ * was found.
+ */
+[[nodiscard]] CPPTEMPLATE_NETWORK_API bool permessage_deflate_available() noexcept;
+
+/**
+ * @brief permessage-deflate compression and decompression (RFC 7692)
+ *
+ * Holds one raw-deflate and one inflate stream. Without context takeover
+ * each message resets its stream instead of creating one, so a compressor
+ * is reused across messages and, in a server, across connections.
+ */
+class CPPTEMPLATE_NETWORK_API WsCompressor {
+public:
+    /**
+     * @brief Create the zlib streams
+     * @param level zlib compression level, 0 to 9
+     * @throws std::invalid_argument If level is out of range
+     * @throws core::Exception If permessage-deflate is not available or zlib fails
+     */
+    explicit WsCompressor(int level = 1);
+    ~WsCompressor();
+
+    WsCompressor(const WsCompressor&) = delete;
+    WsCompressor& operator=(const WsCompressor&) = delete;
+
+    /**
+     * @brief Compress a message payload
+     * @param payload Message payload
+     * @param out Buffer the compressed payload is appended to
+     * @param keep_context Continue the stream of earlier messages instead of starting afresh
+     */
+    void compress(std::string_view payload, std::string& out, bool keep_context = false);
+
+    /**
+     * @brief Decompress a message payload
+     * @param payload Compressed payload, as received
+     * @param out Buffer the message is appended to
+     * @param limit Largest message to produce
+     * @param keep_context Continue the stream of earlier messages instead of starting afresh
+     * @return False if the payload is not valid deflate data or inflates past limit; in the
+     *         latter case out has grown by more than limit
+     */
+    [[nodiscard]] bool decompress(std::string_view payload, std::string& out, std::size_t limit,
+                                  bool keep_context = false);
+
+    /// Change the compression level for later messages
+    void set_level(int level);
+
+    [[nodiscard]] int level() const noexcept {
+        return level_;
+    }
+
+private:
+    struct Streams;
+
+    std::unique_ptr<Streams> streams_;
+    int level_;
+};
+
+/**
+ * @brief Server frame serialized once for many connections
+ *
+ * Server frames are not masked, so the same bytes go to every client.
+ * The frame is built once and shared by reference count: each connection
+ * queues a reference and writes straight from the shared bytes, copying
+ * only what its socket does not take at once. With compress set the
+ * frame is also deflated once, without context takeover, and connections
+ * that negotiated permessage-deflate get that version.
+ *
+ * @example
+ * ```cpp
+ * const WsFrame frame(WsOpcode::Text, update, true);
+ * for (WsConnection* subscriber : room) {
+ *     subscriber->send(frame);
+ * }
+ * ```
+ */
+class CPPTEMPLATE_NETWORK_API WsFrame {
+public:
+    /**
+     * @brief Build a frame
+     * @param opcode Opcode of an unfragmented message or control frame
+     * @param payload Payload, copied
+     * @param compress Also build a compressed version, if permessage-deflate is available
+     */
+    WsFrame(WsOpcode opcode, std::string_view payload, bool compress = false);
+
+    /// Frame bytes, uncompressed
+    [[nodiscard]] std::string_view bytes() const noexcept {
+        return *plain_;
+    }
+
+    /// Frame bytes, compressed if a compressed version was built, else uncompressed
+    [[nodiscard]] std::string_view compressed_bytes() const noexcept {
+        return compressed_ ? std::string_view(*compressed_) : std::string_view(*plain_);
+    }
+
+    /// References held, by this frame and the connections that still have it queued
+    [[nodiscard]] long use_count() const noexcept {
+        return plain_.use_count();
+    }
+
+private:
+    friend class WsConnection;
+
+    std::shared_ptr<const std::string> plain_;
+    std::shared_ptr<const std::string> compressed_; ///< Null unless compressed and worth it
+};
+
+class WebSocketServer;
+
+/**
+ * @brief One WebSocket connection of a WebSocketServer
+ *
+ * Like the Connection it sits on, it belongs to one event loop and is only
+ * valid inside the server's callbacks. Frames sent from a callback are
+ * queued, and when the outermost callback returns every connection with
+ * queued frames is written with one gather write. Small frames are
+ * coalesced that way into one system call per connection per batch of
+ * input, and a broadcast costs one write per subscriber.
+ */
+class CPPTEMPLATE_NETWORK_API WsConnection {
+public:
+    WsConnection(const WsConnection&) = delete;
+    WsConnection& operator=(const WsConnection&) = delete;
+
+    /**
+     * @brief Queue a message or control frame
+     * @param opcode Text, Binary, Ping or Pong
+     * @param payload Payload, copied; Text must be UTF-8
+     * @return False if the connection is closing
+     *
+     * Messages are compressed when permessage-deflate was negotiated and
+     * they are at least WsServerOptions::compress_min bytes.
+     */
+    bool send(WsOpcode opcode, std::string_view payload);
+
+    bool send_text(std::string_view text) {
+        return send(WsOpcode::Text, text);
+    }
+
+    bool send_binary(std::string_view data) {
+        return send(WsOpcode::Binary, data);
+    }
+
+    /**
+     * @brief Queue a shared frame without copying it
+     * @return False if the connection is closing
+     */
+    bool send(const WsFrame& frame);
+
+    /**
+     * @brief Start the closing handshake: queue a Close frame and close once it is written
+     * @param code Status code; NoStatus and Abnormal send a Close frame without one
+     * @param reason UTF-8 reason, at most 123 bytes
+     */
+    void close(WsCloseCode code = WsCloseCode::Normal, std::string_view reason = {});
+
+    /// Write the queued frames now instead of when the callback returns
+    void flush();
+
+    /// Whether close() was called, a Close frame arrived or the connection failed
+    [[nodiscard]] bool closing() const noexcept;
+
+    /// Whether permessage-deflate was negotiated
+    [[nodiscard]] bool deflate() const noexcept {
+        return deflate_;
+    }
+
+    /// Code of the Close frame received, NoStatus if it had none, Abnormal if none arrived
+    [[nodiscard]] WsCloseCode close_code() const noexcept {
+        return close_code_;
+    }
+
+    /// Queued bytes: frames not yet written plus what the socket has not taken
+    [[nodiscard]] std::size_t pending_output() const noexcept;
+
+    /// Underlying TCP connection
+    [[nodiscard]] Connection& connection() noexcept {
+        return *connection_;
+    }
+
+    [[nodiscard]] std::uint64_t id() const noexcept {
+        return connection_->id();
+    }
+
+    /// Attach state to the connection, e.g. its subscriptions
+    void set_user_data(std::shared_ptr<void> data) noexcept {
+        user_data_ = std::move(data);
+    }
+
+    /// State set by set_user_data(), cast to T
+    template<typename T>
+    [[nodiscard]] T* user_data() const noexcept {
+        return static_cast<T*>(user_data_.get());
+    }
+
+private:
+    friend class WebSocketServer;
+
+    /// A queued frame: a range of scratch_, or a shared frame
+    struct Piece {
+        std::shared_ptr<const std::string> shared;
+        std::size_t offset = 0; ///< Into scratch_ when shared is null
+        std::size_t size = 0;
+    };
+
+    WsConnection(WebSocketServer& server, Connection& connection) noexcept;
+
+    /// Queue a frame built in scratch_ from offset on
+    void queued(std::size_t offset);
+    void mark_dirty();
+
+    WebSocketServer* server_;
+    Connection* connection_;
+    HttpParser handshake_;
+    WsParser parser_;
+    bool open_ = false;       ///< Handshake done
+    bool deflate_ = false;
+    bool close_sent_ = false;
+    bool dirty_ = false;      ///< In the loop's list of connections to flush
+    WsCloseCode close_code_ = WsCloseCode::Abnormal;
+    std::vector<Piece> pieces_;
+    std::string scratch_; ///< Frames built for this connection alone
+    std::size_t queued_ = 0;
+    std::shared_ptr<void> user_data_;
+};
+
+/**
+ * @brief Settings of a WebSocketServer
+ */
+struct WsServerOptions {
+    ServerOptions tcp;                ///< Listener, loops and buffers
+    WsLimits limits;                  ///< Message size limit
+    std::string path;                 ///< Only upgrade requests for this path; empty for any
+    bool permessage_deflate = false;  ///< Accept permessage-deflate offers, if available
+    int compression_level = 1;        ///< zlib level of compressed messages
+    std::size_t compress_min = 128;   ///< Smaller messages are sent uncompressed
+    /// Queued bytes that are written without waiting for the callback to end
+    std::size_t flush_threshold = 64 * 1024;
+};
+
+/**
+ * @brief RFC 6455 WebSocket server on a TcpServer
+ *
+ * Each connection starts as HTTP: a valid upgrade request is answered with
+ * 101, anything else with 400, 404 or 426 and a close. After that, frames
+ * are parsed in place with WsParser, fragments are joined, pings are
+ * answered, text is checked to be UTF-8, and a Close frame is echoed
+ * before the connection closes. Protocol errors close with the matching
+ * code.
+ *
+ * With permessage_deflate, an offer is accepted with both
+ * server_no_context_takeover and client_no_context_takeover, so each
+ * message is compressed and inflated on its own. Then no connection holds
+ * zlib state: each loop thread has one WsCompressor, reset per message,
+ * and a WsFrame compressed once suits every connection.
+ *
+ * Linux only, like TcpServer.
+ *
+ * @example
+ * ```cpp
+ * WebSocketServer server({.tcp = {.port = 9000}});
+ * server.on_message([](WsConnection& ws, const WsMessage& message) {
+ *     ws.send(message.opcode, message.payload); // echo
+ * });
+ * server.start();
+ * ```
+ */
+class CPPTEMPLATE_NETWORK_API WebSocketServer {
+public:
+    using OpenHandler = std::function<void(WsConnection&, const HttpRequest& request)>;
+    /// Gets Text and Binary messages, decompressed; control frames are handled by the server
+    using MessageHandler = std::function<void(WsConnection&, const WsMessage& message)>;
+    /// Runs for every connection that was opened, however it closed; see WsConnection::close_code()
+    using CloseHandler = std::function<void(WsConnection&)>;
+
+    /**
+     * @brief Create a stopped server
+     * @param options Settings
+     * @throws std::invalid_argument As TcpServer does, or if compression_level is not 0 to 9
+     */
+    explicit WebSocketServer(WsServerOptions options = {});
+
+    WebSocketServer(const WebSocketServer&) = delete;
+    WebSocketServer& operator=(const WebSocketServer&) = delete;
+
+    /// Set the callback for completed handshakes; call before start()
+    void on_open(OpenHandler handler) {
+        on_open_ = std::move(handler);
+    }
+
+    /// Set the callback for messages; call before start()
+    void on_message(MessageHandler handler) {
+        on_message_ = std::move(handler);
+    }
+
+    /// Set the callback for closed connections; call before start()
+    void on_close(CloseHandler handler) {
+        on_close_ = std::move(handler);
+    }
+
+    /// Start listening; see TcpServer::start()
+    void start() {
+        server_.start();
+    }
+
+    /// Stop and close every connection; see TcpServer::stop()
+    void stop() {
+        server_.stop();
+    }
+
+    /// Bound port; 0 before start()
+    [[nodiscard]] std::uint16_t port() const noexcept {
+        return server_.port();
+    }
+
+    /// Counters of the underlying TcpServer
+    [[nodiscard]] ServerStats stats() const noexcept {
+        return server_.stats();
+    }
+
+    [[nodiscard]] const WsServerOptions& options() const noexcept {
+        return options_;
+    }
+
+private:
+    friend class WsConnection;
+
+    std::size_t on_data(Connection& connection, std::string_view bytes);
+    std::size_t handshake(WsConnection& ws, std::string_view bytes);
+    void dispatch(WsConnection& ws, const WsMessage& message);
+    void fail(WsConnection& ws, WsCloseCode code);
+
+    WsServerOptions options_;
+    bool deflate_ = false; ///< permessage_deflate was asked for and is available
+    OpenHandler on_open_;
+    MessageHandler on_message_;
+    CloseHandler on_close_;
+    TcpServer server_;
+};
+
+} // namespace cpptemplate::network
@@ -0,0 +1,65 @@
+#include "cpptemplate/network/buffer_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cpptemplate::network {
+
+std::size_t Buffer::append(std::string_view bytes) noexcept {
+    const std::size_t n = std::min(bytes.size(), writable());
+    std::memcpy(write_position(), bytes.data(), n);
+    commit(n);
+    return n;
+}
+
+void Buffer::compact() noexcept {
+    if (begin_ != 0) {
+        std::memmove(data_, data_ + begin_, size());
+        end_ -= begin_;
+        begin_ = 0;
+    }
+}
+
+BufferPool::BufferPool(std::size_t buffer_size, std::size_t max_cached)
+    : buffer_size_(buffer_size), max_cached_(max_cached) {
+    free_.reserve(max_cached_); // release() must not allocate
+}
+
+BufferPool::~BufferPool() {
+    for (char* data : free_) {
+        delete[] data;
+    }
+}
+
+Buffer BufferPool::acquire() {
+    ++outstanding_;
+    if (!free_.empty()) {
+        char* data = free_.back();
+        free_.pop_back();
+        return {data, buffer_size_};
+    }
+    return {new char[buffer_size_], buffer_size_};
+}
+
+void BufferPool::release(Buffer& buffer) noexcept {
+    if (!buffer) {
+        return;
+    }
+    --outstanding_;
+    if (buffer.capacity() == buffer_size_ && free_.size() < max_cached_) {
+        free_.push_back(buffer.data_);
+    } else {
+        delete[] buffer.data_;
+    }
+    buffer = Buffer();
+}
+
+void BufferPool::grow(Buffer& buffer, std::size_t capacity) {
+    Buffer larger(new char[capacity], capacity);
+    larger.append(buffer.readable());
+    release(buffer);
+    ++outstanding_;
+    buffer = std::move(larger);
+}
+
+} // namespace cpptemplate::network
@@ -0,0 +1,319 @@
+#include "reactor.hpp"
+
+#if defined(__linux__)
+
+    #include <array>
+    #include <cerrno>
+    #include <string>
+    #include <system_error>
+
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <unistd.h>
+
+    #include "cpptemplate/core/exception.hpp"
+
+namespace cpptemplate::network::detail {
+
+namespace {
+
+// Connection tags are slot | generation << 32 with generations below 2^24
+constexpr std::uint64_t ListenerTag = ~std::uint64_t{0};
+constexpr std::uint64_t WakeTag = ~std::uint64_t{0} - 1;
+
+// Connections accepted per listener wakeup before existing ones get a turn
+constexpr int MaxAcceptsPerEvent = 64;
+
+// Buffers gathered into one sendmsg() call
+constexpr std::size_t MaxIovecs = 64;
+
+/// Gather write that reports a closed peer as EPIPE instead of raising SIGPIPE
+ssize_t send_iovecs(int fd, iovec* iovecs, std::size_t count) noexcept {
+    msghdr message{};
+    message.msg_iov = iovecs;
+    message.msg_iovlen = count;
+    return ::sendmsg(fd, &message, MSG_NOSIGNAL);
+}
+
+} // namespace
+
+EpollReactor::EpollReactor(TcpServer& server, std::size_t index, std::size_t loops, int listener,
+                           bool owns_listener)
+    : Reactor(server, index, loops), listener_(listener), owns_listener_(owns_listener) {
+    const auto fail_setup = [this](const char* what) {
+        const auto message = std::generic_category().message(errno);
+        close_descriptors();
+        throw core::Exception(what + (": " + message));
+    };
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        fail_setup("epoll_create1 failed");
+    }
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        fail_setup("eventfd failed");
+    }
+
+    epoll_event wake{};
+    wake.events = EPOLLIN;
+    wake.data.u64 = WakeTag;
+    epoll_event accept{};
+    accept.events = owns_listener ? EPOLLIN : EPOLLIN | EPOLLEXCLUSIVE;
+    accept.data.u64 = ListenerTag;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake) < 0 ||
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listener_, &accept) < 0) {
+        fail_setup("Failed to register listener");
+    }
+    spare_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+EpollReactor::~EpollReactor() {
+    stop();
+    close_descriptors();
+}
+
+void EpollReactor::close_descriptors() noexcept {
+    for (const int fd : {epoll_fd_, wake_fd_, spare_fd_}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (owns_listener_) {
+        ::close(listener_);
+    }
+    epoll_fd_ = wake_fd_ = spare_fd_ = -1;
+    owns_listener_ = false;
+}
+
+void EpollReactor::wake() noexcept {
+    const std::uint64_t one = 1;
+    if (::write(wake_fd_, &one, sizeof one) < 0) {
+        // Only fails if the counter is saturated, which also wakes the loop
+    }
+}
+
+void EpollReactor::close_socket(Connection& connection) noexcept {
+    ::close(connection.fd_); // Also removes it from the epoll set
+}
+
+void EpollReactor::run() noexcept {
+    std::array<epoll_event, 256> events{};
+    bool stopping = false;
+    while (!stopping) {
+        const int count =
+            ::epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            const std::uint64_t tag = events[static_cast<std::size_t>(i)].data.u64;
+            if (tag == WakeTag) {
+                stopping = true;
+            } else if (tag == ListenerTag) {
+                accept_connections();
+            } else {
+                on_event(tag, events[static_cast<std::size_t>(i)].events);
+            }
+        }
+    }
+    destroy_all();
+}
+
+void EpollReactor::accept_connections() {
+    const bool no_delay = server_.options().no_delay;
+    for (int i = 0; i < MaxAcceptsPerEvent; ++i) {
+        const int fd = ::accept4(listener_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0) {
+            if (no_delay) {
+                const int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+            }
+            Connection* connection = adopt(fd);
+            if (connection == nullptr) {
+                continue;
+            }
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            const auto tag = static_cast<std::uint64_t>(generation(*connection) & GenerationMask);
+            event.data.u64 = connection->slot_ | tag << 32;
+            if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+                abandon(*connection);
+                continue;
+            }
+            opened(*connection);
+            continue;
+        }
+        if (errno == EINTR || errno == ECONNABORTED) {
+            continue;
+        }
+        if ((errno == EMFILE || errno == ENFILE) && spare_fd_ >= 0) {
+            // Out of descriptors: free the spare to accept and drop the client at once,
+            // rather than leaving it in the backlog where the listener stays readable
+            ::close(spare_fd_);
+            const int rejected = ::accept(listener_, nullptr, nullptr);
+            if (rejected >= 0) {
+                ::close(rejected);
+            }
+            spare_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        }
+        return; // EAGAIN, or an error that retrying now would not fix
+    }
+}
+
+void EpollReactor::on_event(std::uint64_t tag, std::uint32_t events) {
+    Connection* connection =
+        find(static_cast<std::uint32_t>(tag), static_cast<std::uint32_t>(tag >> 32));
+    if (connection == nullptr) {
+        return; // Closed earlier in this batch
+    }
+
+    if ((events & EPOLLERR) != 0) {
+        fail(*connection);
+    } else {
+        if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) != 0) {
+            read(*connection, events);
+        }
+        if ((events & EPOLLOUT) != 0) {
+            flush(*connection);
+        }
+    }
+    finish(*connection);
+}
+
+void EpollReactor::read(Connection& connection, std::uint32_t events) {
+    Buffer& input = connection.input_;
+    const std::size_t buffer_size = pool_.buffer_size();
+    while (!connection.closing_) {
+        // A pooled buffer to start with; once one fills, compact it or double it
+        std::size_t room = buffer_size;
+        if (!input.empty()) {
+            if (input.writable() == 0) {
+                input.compact();
+            }
+            room = input.writable() > 0 ? input.writable() : input.capacity();
+        }
+        if (!reserve_input(connection, room)) {
+            break;
+        }
+
+        const std::size_t space = input.writable();
+        const ssize_t n = ::read(connection.fd_, input.write_position(), space);
+        if (n > 0) {
+            input.commit(static_cast<std::size_t>(n));
+            count(counters_.bytes_received, static_cast<std::uint64_t>(n));
+            deliver(connection);
+            // A short read drained the socket, and with edge triggering the next
+            // bytes raise a new event; only a pending hang-up needs reading on to EOF
+            if (static_cast<std::size_t>(n) < space && (events & (EPOLLRDHUP | EPOLLHUP)) == 0) {
+                break;
+            }
+        } else if (n == 0) {
+            connection.closing_ = true; // Peer is done sending; flush, then close
+        } else if (errno != EINTR) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                fail(connection);
+            }
+            break;
+        }
+    }
+    trim_input(connection);
+}
+
+bool EpollReactor::send(Connection& connection, std::span<const std::string_view> pieces) {
+    if (connection.closing_) {
+        return false;
+    }
+
+    std::size_t written = 0;
+    if (!connection.output_) {
+        // Nothing queued, so write straight from the caller's memory
+        std::size_t index = 0;
+        std::size_t offset = 0;
+        while (index < pieces.size()) {
+            std::array<iovec, MaxIovecs> iovecs{};
+            std::size_t count = 0;
+            std::size_t batch = 0;
+            for (std::size_t i = index; i < pieces.size() && count < MaxIovecs; ++i) {
+                const std::string_view piece = pieces[i].substr(i == index ? offset : 0);
+                if (!piece.empty()) {
+                    iovecs[count++] = {const_cast<char*>(piece.data()), piece.size()};
+                    batch += piece.size();
+                }
+            }
+            if (count == 0) {
+                return true;
+            }
+
+            const ssize_t n = send_iovecs(connection.fd_, iovecs.data(), count);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                fail(connection);
+                return false;
+            }
+            Reactor::count(counters_.bytes_sent, static_cast<std::uint64_t>(n));
+            written += static_cast<std::size_t>(n);
+            for (auto left = static_cast<std::size_t>(n); index < pieces.size();) {
+                const std::size_t rest = pieces[index].size() - offset;
+                if (left < rest) {
+                    offset += left;
+                    break;
+                }
+                left -= rest;
+                offset = 0;
+                ++index;
+            }
+            if (static_cast<std::size_t>(n) < batch) {
+                break; // The socket buffer is full
+            }
+        }
+        if (index == pieces.size()) {
+            return true;
+        }
+    }
+    queue(connection, pieces, written);
+    return true;
+}
+
+void EpollReactor::flush(Connection& connection) {
+    if (!connection.output_) {
+        return;
+    }
+    OutputQueue& output = *connection.output_;
+    while (output.bytes > 0) {
+        std::array<iovec, MaxIovecs> iovecs{};
+        std::size_t count = 0;
+        for (auto it = output.buffers.begin(); it != output.buffers.end() && count < MaxIovecs;
+             ++it) {
+            const std::string_view bytes = it->readable();
+            iovecs[count++] = {const_cast<char*>(bytes.data()), bytes.size()};
+        }
+
+        const ssize_t n = send_iovecs(connection.fd_, iovecs.data(), count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                fail(connection);
+            }
+            return;
+        }
+        consume_output(output, static_cast<std::size_t>(n));
+    }
+    recycle(std::move(connection.output_));
+}
+
+} // namespace cpptemplate::network::detail
+
+#endif
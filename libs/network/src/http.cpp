@@ -0,0 +1,416 @@
+#include "cpptemplate/network/http.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__linux__)
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+#include "cpptemplate/network/tcp_server.hpp"
+#include "http_common.hpp"
+#include "http_kernels.hpp"
+
+namespace cpptemplate::network {
+
+namespace {
+
+using Status = HttpParseResult::Status;
+using detail::find_head_end;
+using detail::iequals;
+using detail::is_space;
+using detail::lists_token;
+
+// tchar of RFC 9110: what methods and header names are made of
+constexpr auto TokenChars = [] {
+    std::array<bool, 256> table{};
+    for (const unsigned char c :
+         std::string_view("!#$%&'*+-.^_`|~0123456789"
+                          "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ")) {
+        table[c] = true;
+    }
+    return table;
+}();
+
+constexpr bool is_token(char c) noexcept {
+    return TokenChars[static_cast<unsigned char>(c)];
+}
+
+/// Whether text fits on one line of a head: a CR, LF or NUL written there
+/// would let the caller's data end the line and forge headers or a body
+constexpr bool fits_one_line(std::string_view text) noexcept {
+    return text.find_first_of(std::string_view("\r\n\0", 3)) == std::string_view::npos;
+}
+
+} // namespace
+
+std::string_view HttpRequest::header(std::string_view name) const noexcept {
+    for (const HttpHeader& field : headers()) {
+        if (iequals(field.name, name)) {
+            return field.value;
+        }
+    }
+    return {};
+}
+
+HttpParseResult HttpParser::parse(std::string_view bytes, HttpRequest& request) noexcept {
+    if (expected_ != 0) {
+        // Head parsed before; only the body was missing
+        if (bytes.size() < expected_) {
+            return {};
+        }
+    } else if (scanned_ != 0 &&
+               find_head_end(bytes, scanned_ >= 2 ? scanned_ - 2 : 0) == std::string_view::npos) {
+        // Still no end of head, so parsing from the start would stop short again
+        scanned_ = bytes.size();
+        if (scanned_ > limits_.max_head) {
+            reset();
+            return {Status::Error, 0, 431};
+        }
+        return {};
+    }
+    return parse_head(bytes, request);
+}
+
+HttpParseResult HttpParser::parse_head(std::string_view bytes, HttpRequest& request) noexcept {
+    const auto error = [this](int status) {
+        reset();
+        return HttpParseResult{Status::Error, 0, status};
+    };
+    const auto incomplete = [&] {
+        scanned_ = bytes.size();
+        return scanned_ > limits_.max_head ? error(431) : HttpParseResult{};
+    };
+    const detail::HttpKernels& kernels = detail::http_kernels();
+    const char* const data = bytes.data();
+    const std::size_t size = bytes.size();
+    std::size_t i = 0;
+
+    // Line end at i: 0 if the bytes stop first, npos if something else is there
+    const auto line_end = [&](std::size_t at) -> std::size_t {
+        if (at == size) {
+            return 0;
+        }
+        if (data[at] == '\n') {
+            return 1;
+        }
+        if (data[at] != '\r') {
+            return std::string_view::npos;
+        }
+        if (at + 1 == size) {
+            return 0;
+        }
+        return data[at + 1] == '\n' ? 2 : std::string_view::npos;
+    };
+
+    // Empty lines before a request line are ignored (RFC 9112, 2.2)
+    while (i < size && (data[i] == '\r' || data[i] == '\n')) {
+        ++i;
+    }
+
+    // Request line: method SP target SP HTTP/1.x
+    const std::size_t method_start = i;
+    while (i < size && is_token(data[i])) {
+        ++i;
+    }
+    if (i == size) {
+        return incomplete();
+    }
+    if (i == method_start || data[i] != ' ') {
+        return error(400);
+    }
+    request.method = bytes.substr(method_start, i - method_start);
+
+    const std::size_t target_start = ++i;
+    i += kernels.find_target_end(data + i, size - i);
+    if (i == size) {
+        return incomplete();
+    }
+    if (i == target_start || data[i] != ' ') {
+        return error(400);
+    }
+    request.target = bytes.substr(target_start, i - target_start);
+    const std::size_t question = request.target.find('?');
+    request.path = request.target.substr(0, question);
+    request.query = question == std::string_view::npos ? std::string_view{}
+                                                       : request.target.substr(question + 1);
+
+    ++i;
+    constexpr std::string_view Protocol = "HTTP/";
+    if (size - i < Protocol.size() + 3) {
+        // Reject a wrong protocol as soon as it shows, rather than when the line is complete
+        const std::size_t seen = std::min(size - i, Protocol.size());
+        return bytes.substr(i, seen) == Protocol.substr(0, seen) ? incomplete() : error(400);
+    }
+    if (bytes.substr(i, Protocol.size()) != Protocol) {
+        return error(400);
+    }
+    const char major = data[i + 5];
+    const char minor = data[i + 7];
+    if (major < '0' || major > '9' || data[i + 6] != '.' || minor < '0' || minor > '9') {
+        return error(400);
+    }
+    if (major != '1') {
+        return error(505);
+    }
+    request.minor_version = minor - '0';
+    i += Protocol.size() + 3;
+    std::size_t end = line_end(i);
+    if (end == 0) {
+        return incomplete();
+    }
+    if (end == std::string_view::npos) {
+        return error(400);
+    }
+    i += end;
+
+    // Header fields, up to the blank line
+    request.header_count = 0;
+    std::size_t content_length = 0;
+    bool has_length = false;
+    bool has_encoding = false;
+    bool close = false;
+    bool keep_alive = false;
+    for (;;) {
+        end = line_end(i);
+        if (end == 0) {
+            return incomplete();
+        }
+        if (end != std::string_view::npos) {
+            i += end;
+            break;
+        }
+        if (is_space(data[i])) {
+            return error(400); // Obsolete line folding
+        }
+
+        const std::size_t name_start = i;
+        while (i < size && is_token(data[i])) {
+            ++i;
+        }
+        if (i == size) {
+            return incomplete();
+        }
+        if (i == name_start || data[i] != ':') {
+            return error(400);
+        }
+        const std::string_view name = bytes.substr(name_start, i - name_start);
+        ++i;
+        while (i < size && is_space(data[i])) {
+            ++i;
+        }
+        const std::size_t value_start = i;
+        i += kernels.find_value_end(data + i, size - i);
+        std::size_t value_end = i;
+        end = line_end(i);
+        if (end == 0) {
+            return incomplete();
+        }
+        if (end == std::string_view::npos) {
+            return error(400); // A control byte inside the value
+        }
+        i += end;
+        while (value_end > value_start && is_space(data[value_end - 1])) {
+            --value_end;
+        }
+        const std::string_view value = bytes.substr(value_start, value_end - value_start);
+
+        if (request.header_count == HttpRequest::MaxHeaders) {
+            return error(431);
+        }
+        request.header_fields[request.header_count++] = {name, value};
+
+        if (iequals(name, "content-length")) {
+            std::size_t length = 0;
+            const auto [last, ec] =
+                std::from_chars(value.data(), value.data() + value.size(), length);
+            if (ec == std::errc::result_out_of_range) {
+                return error(413);
+            }
+            if (ec != std::errc{} || last != value.data() + value.size() || value.empty() ||
+                (has_length && length != content_length)) {
+                return error(400); // Not a number, or conflicting lengths (RFC 9112, 6.3)
+            }
+            content_length = length;
+            has_length = true;
+        } else if (iequals(name, "transfer-encoding")) {
+            has_encoding = true;
+        } else if (iequals(name, "connection")) {
+            close = close || lists_token(value, "close");
+            keep_alive = keep_alive || lists_token(value, "keep-alive");
+        }
+    }
+
+    const std::size_t head_size = i;
+    if (head_size > limits_.max_head) {
+        return error(431);
+    }
+    if (has_encoding) {
+        return error(501);
+    }
+    if (content_length > limits_.max_body) {
+        return error(413);
+    }
+    request.keep_alive = request.minor_version >= 1 ? !close : keep_alive && !close;
+
+    const std::size_t total = head_size + content_length;
+    if (size < total) {
+        expected_ = total;
+        return {};
+    }
+    request.body = bytes.substr(head_size, content_length);
+    reset();
+    return {Status::Complete, total, 0};
+}
+
+std::string_view http_reason(int status) noexcept {
+    switch (status) {
+        case 100: return "Continue";
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 307: return "Temporary Redirect";
+        case 308: return "Permanent Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 411: return "Length Required";
+        case 413: return "Content Too Large";
+        case 414: return "URI Too Long";
+        case 415: return "Unsupported Media Type";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+    }
+}
+
+HttpResponse::HttpResponse(int status, std::string_view reason) : status_(status) {
+    if (status < 100 || status > 999) {
+        throw std::invalid_argument("HTTP status must have three digits");
+    }
+    if (!fits_one_line(reason)) {
+        throw std::invalid_argument("HTTP reason phrase must not contain CR, LF or NUL");
+    }
+    const char code[] = {static_cast<char>('0' + status / 100),
+                         static_cast<char>('0' + status / 10 % 10),
+                         static_cast<char>('0' + status % 10)};
+    append("HTTP/1.1 ");
+    append({code, sizeof code});
+    append(" ");
+    append(reason.empty() ? http_reason(status) : reason);
+    append("\r\n");
+}
+
+HttpResponse& HttpResponse::header(std::string_view name, std::string_view value) {
+    if (finished_) {
+        throw std::logic_error("Headers cannot be added once the head is finished");
+    }
+    if (name.empty() || !std::all_of(name.begin(), name.end(), is_token)) {
+        throw std::invalid_argument("HTTP header name must be a token");
+    }
+    if (!fits_one_line(value)) {
+        throw std::invalid_argument("HTTP header value must not contain CR, LF or NUL");
+    }
+    append(name);
+    append(": ");
+    append(value);
+    append("\r\n");
+    return *this;
+}
+
+std::string_view HttpResponse::head() {
+    if (!finished_) {
+        // 1xx, 204 and 304 responses never carry a body or its length (RFC 9110, 8.6)
+        if (status_ >= 200 && status_ != 204 && status_ != 304) {
+            std::array<char, 24> digits{};
+            const auto [last, ec] =
+                std::to_chars(digits.data(), digits.data() + digits.size(), body_.size());
+            append("Content-Length: ");
+            append({digits.data(), static_cast<std::size_t>(last - digits.data())});
+            append("\r\n");
+        }
+        if (!keep_alive_) {
+            append("Connection: close\r\n");
+        }
+        append("\r\n");
+        finished_ = true;
+    }
+    return long_head_.empty() ? std::string_view(inline_head_.data(), size_)
+                              : std::string_view(long_head_);
+}
+
+bool HttpResponse::send(Connection& connection) {
+    const auto both = pieces();
+    return both[1].empty() ? connection.send(both[0])
+                           : connection.send(std::span<const std::string_view>(both));
+}
+
+bool HttpResponse::write(int fd) {
+#if defined(__linux__)
+    auto both = pieces();
+    while (!both[0].empty() || !both[1].empty()) {
+        std::array<iovec, 2> iovecs{};
+        int count = 0;
+        for (const std::string_view piece : both) {
+            if (!piece.empty()) {
+                iovecs[static_cast<std::size_t>(count++)] = {const_cast<char*>(piece.data()),
+                                                             piece.size()};
+            }
+        }
+        const ssize_t n = ::writev(fd, iovecs.data(), count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        auto left = static_cast<std::size_t>(n);
+        for (std::string_view& piece : both) {
+            const std::size_t taken = std::min(left, piece.size());
+            piece.remove_prefix(taken);
+            left -= taken;
+        }
+    }
+    return true;
+#else
+    static_cast<void>(fd);
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+void HttpResponse::append(std::string_view text) {
+    if (long_head_.empty() && size_ + text.size() <= InlineHead) {
+        std::memcpy(inline_head_.data() + size_, text.data(), text.size());
+    } else {
+        if (long_head_.empty()) {
+            long_head_.reserve(2 * InlineHead + text.size());
+            long_head_.assign(inline_head_.data(), size_);
+        }
+        long_head_.append(text);
+    }
+    size_ += text.size();
+}
+
+} // namespace cpptemplate::network
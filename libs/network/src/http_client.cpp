@@ -1 +1,1273 @@
-// Stub implementation
+#include "cpptemplate/network/http_client.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+#include "cpptemplate/core/exception.hpp"
+#include "http_common.hpp"
+
+namespace cpptemplate::network {
+
+namespace {
+
+class HttpClientCategory final : public core::ErrorCategory {
+public:
+    std::string_view name() const noexcept override {
+        return "http_client";
+    }
+
+    std::string_view message(int code) const noexcept override {
+        switch (static_cast<HttpClientErrc>(code)) {
+            case HttpClientErrc::InvalidUrl: return "Invalid URL";
+            case HttpClientErrc::ResolveFailed: return "Host name did not resolve";
+            case HttpClientErrc::ConnectFailed: return "Connection failed";
+            case HttpClientErrc::ConnectionClosed:
+                return "Connection closed before the response was complete";
+            case HttpClientErrc::Timeout: return "Request timed out";
+            case HttpClientErrc::BadResponse: return "Malformed HTTP response";
+            case HttpClientErrc::ResponseTooLarge: return "Response too large";
+            case HttpClientErrc::Shutdown: return "Client shut down";
+        }
+        return "Unknown error";
+    }
+};
+
+} // namespace
+
+const core::ErrorCategory& http_client_category() noexcept {
+    static const HttpClientCategory category;
+    return category;
+}
+
+std::string_view HttpClientResponse::header(std::string_view name) const noexcept {
+    std::string_view rest = head;
+    rest.remove_prefix(std::min(rest.find('\n'), rest.size())); // Status line
+    while (!rest.empty()) {
+        rest.remove_prefix(1);
+        const std::size_t end = std::min(rest.find('\n'), rest.size());
+        const std::string_view line = rest.substr(0, end);
+        const std::size_t colon = line.find(':');
+        if (colon != std::string_view::npos && detail::iequals(line.substr(0, colon), name)) {
+            std::string_view value = line.substr(colon + 1);
+            if (value.ends_with('\r')) {
+                value.remove_suffix(1);
+            }
+            return detail::trim_spaces(value);
+        }
+        rest.remove_prefix(end);
+    }
+    return {};
+}
+
+#if defined(__linux__)
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Address {
+    sockaddr_storage storage{};
+    socklen_t length = 0;
+};
+
+using Addresses = std::vector<Address>;
+
+struct Url {
+    std::string host;
+    std::uint16_t port = 80;
+    std::string_view authority; ///< host[:port] as written, for the Host header
+    std::string_view target;    ///< Path and query, "/" at least
+};
+
+/// Split an http:// URL; nullopt if it is not one
+std::optional<Url> parse_url(std::string_view url) {
+    constexpr std::string_view Scheme = "http://";
+    if (url.size() < Scheme.size() || !detail::iequals(url.substr(0, Scheme.size()), Scheme)) {
+        return std::nullopt;
+    }
+    url.remove_prefix(Scheme.size());
+    url = url.substr(0, url.find('#'));
+    const std::size_t authority_end = std::min(url.find_first_of("/?"), url.size());
+
+    Url result;
+    result.authority = url.substr(0, authority_end);
+    result.target = url.substr(authority_end);
+    std::string_view host = result.authority;
+    std::string_view port;
+    if (host.starts_with('[')) {
+        const std::size_t close = host.find(']');
+        if (close == std::string_view::npos ||
+            (close + 1 < host.size() && host[close + 1] != ':')) {
+            return std::nullopt;
+        }
+        port = host.substr(std::min(close + 2, host.size()));
+        host = host.substr(1, close - 1);
+    } else if (const std::size_t colon = host.rfind(':'); colon != std::string_view::npos) {
+        port = host.substr(colon + 1);
+        host = host.substr(0, colon);
+    }
+    if (host.empty() || host.find('@') != std::string_view::npos) {
+        return std::nullopt; // No user info
+    }
+    if (!port.empty()) {
+        unsigned value = 0;
+        const auto [last, ec] = std::from_chars(port.data(), port.data() + port.size(), value);
+        if (ec != std::errc{} || last != port.data() + port.size() || value == 0 || value > 65535) {
+            return std::nullopt;
+        }
+        result.port = static_cast<std::uint16_t>(value);
+    }
+    result.host = host;
+    return result;
+}
+
+bool is_idempotent(std::string_view method) noexcept {
+    for (const std::string_view safe : {"GET", "HEAD", "PUT", "DELETE", "OPTIONS", "TRACE"}) {
+        if (method == safe) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Request line, headers and body in one string, ready to write
+std::string serialize(const HttpClientRequest& request, const Url& url, bool keep_alive) {
+    const std::string_view target = url.target.empty() ? "/" : url.target;
+    const bool query_only = target.front() == '?';
+    bool has_host = false;
+    bool has_length = false;
+    std::size_t size =
+        request.method.size() + target.size() + url.authority.size() + request.body.size() + 96;
+    for (const auto& [name, value] : request.headers) {
+        has_host = has_host || detail::iequals(name, "host");
+        has_length = has_length || detail::iequals(name, "content-length");
+        size += name.size() + value.size() + 4;
+    }
+
+    std::string bytes;
+    bytes.reserve(size);
+    bytes.append(request.method).append(" ");
+    if (query_only) {
+        bytes.append("/");
+    }
+    bytes.append(target).append(" HTTP/1.1\r\n");
+    if (!has_host) {
+        bytes.append("Host: ").append(url.authority).append("\r\n");
+    }
+    for (const auto& [name, value] : request.headers) {
+        bytes.append(name).append(": ").append(value).append("\r\n");
+    }
+    const std::string_view method = request.method;
+    if (!has_length &&
+        (!request.body.empty() || method == "POST" || method == "PUT" || method == "PATCH")) {
+        std::array<char, 24> digits{};
+        const auto [last, ec] =
+            std::to_chars(digits.data(), digits.data() + digits.size(), request.body.size());
+        bytes.append("Content-Length: ").append(digits.data(), last).append("\r\n");
+    }
+    if (!keep_alive) {
+        bytes.append("Connection: close\r\n");
+    }
+    bytes.append("\r\n").append(request.body);
+    return bytes;
+}
+
+/**
+ * Incremental HTTP/1.x response parser. Unlike HttpParser it copies: the
+ * response outlives the receive buffer, so the head and the body, less any
+ * chunked framing, are appended to an HttpClientResponse as they arrive.
+ */
+class ResponseParser {
+public:
+    enum class Result : std::uint8_t { Complete, Incomplete, Error, TooLarge };
+
+    /**
+     * @param bytes Received bytes, starting after what earlier calls consumed
+     * @param head_request Whether the request was HEAD, whose response has no body
+     * @param limit Largest head plus body
+     * @param response Filled in as the response arrives
+     * @param consumed Set to the bytes used; may be fewer than given even when Incomplete
+     */
+    Result parse(std::string_view bytes,
+                 bool head_request,
+                 std::size_t limit,
+                 HttpClientResponse& response,
+                 std::size_t& consumed) {
+        consumed = 0;
+        for (;;) {
+            const std::string_view rest = bytes.substr(consumed);
+            switch (stage_) {
+                case Stage::Head: {
+                    const std::size_t end = detail::find_head_end(rest, 0);
+                    if (end == std::string_view::npos) {
+                        return rest.size() > limit ? Result::TooLarge : Result::Incomplete;
+                    }
+                    if (end > limit) {
+                        return Result::TooLarge;
+                    }
+                    const Result head = parse_head(rest.substr(0, end), response);
+                    consumed += end;
+                    if (head != Result::Complete) {
+                        return head;
+                    }
+                    if (response.status < 200 && response.status != 101) {
+                        continue; // Interim response such as 100 Continue; the real one follows
+                    }
+                    if (head_request || response.status < 200 || response.status == 204 ||
+                        response.status == 304) {
+                        return Result::Complete;
+                    }
+                    if (chunked_) {
+                        stage_ = Stage::ChunkSize;
+                    } else if (has_length_) {
+                        if (remaining_ == 0) {
+                            return Result::Complete;
+                        }
+                        if (remaining_ > limit - response.head.size()) {
+                            return Result::TooLarge;
+                        }
+                        response.body.reserve(remaining_);
+                        stage_ = Stage::Body;
+                    } else {
+                        keep_alive_ = false; // The body ends when the server closes
+                        stage_ = Stage::UntilClose;
+                    }
+                    break;
+                }
+                case Stage::Body:
+                case Stage::ChunkData: {
+                    const std::size_t take = std::min(remaining_, rest.size());
+                    response.body.append(rest.substr(0, take));
+                    consumed += take;
+                    remaining_ -= take;
+                    if (remaining_ != 0) {
+                        return Result::Incomplete;
+                    }
+                    if (stage_ == Stage::Body) {
+                        stage_ = Stage::Head;
+                        return Result::Complete;
+                    }
+                    stage_ = Stage::ChunkEnd;
+                    break;
+                }
+                case Stage::ChunkSize: {
+                    const std::size_t end = rest.find('\n');
+                    if (end == std::string_view::npos) {
+                        return rest.size() > MaxChunkLine ? Result::Error : Result::Incomplete;
+                    }
+                    // Hex size, then optional extensions after ';', which are ignored
+                    std::size_t size = 0;
+                    const auto [last, ec] =
+                        std::from_chars(rest.data(), rest.data() + end, size, 16);
+                    if (ec == std::errc::result_out_of_range) {
+                        return Result::TooLarge;
+                    }
+                    // rest[end] is the LF, so *last is always readable
+                    if (ec != std::errc{} || (*last != ';' && *last != '\r' && *last != '\n' &&
+                                              !detail::is_space(*last))) {
+                        return Result::Error;
+                    }
+                    consumed += end + 1;
+                    if (size == 0) {
+                        stage_ = Stage::Trailers;
+                    } else if (size > limit - response.head.size() - response.body.size()) {
+                        return Result::TooLarge;
+                    } else {
+                        remaining_ = size;
+                        stage_ = Stage::ChunkData;
+                    }
+                    break;
+                }
+                case Stage::ChunkEnd:
+                    if (rest.starts_with('\n')) {
+                        consumed += 1;
+                    } else if (rest.starts_with("\r\n")) {
+                        consumed += 2;
+                    } else if (rest.size() < 2) {
+                        return Result::Incomplete;
+                    } else {
+                        return Result::Error;
+                    }
+                    stage_ = Stage::ChunkSize;
+                    break;
+                case Stage::Trailers: {
+                    // Trailer fields are skipped up to the blank line
+                    const std::size_t end = rest.find('\n');
+                    if (end == std::string_view::npos) {
+                        return rest.size() > MaxChunkLine ? Result::Error : Result::Incomplete;
+                    }
+                    consumed += end + 1;
+                    if (end == 0 || (end == 1 && rest[0] == '\r')) {
+                        stage_ = Stage::Head;
+                        return Result::Complete;
+                    }
+                    break;
+                }
+                case Stage::UntilClose:
+                    if (rest.size() > limit - response.head.size() - response.body.size()) {
+                        return Result::TooLarge;
+                    }
+                    response.body.append(rest);
+                    consumed += rest.size();
+                    return Result::Incomplete;
+            }
+        }
+    }
+
+    /// The server closed: true if that completed a response whose body runs until the close
+    bool finish_on_close() noexcept {
+        if (stage_ != Stage::UntilClose) {
+            return false;
+        }
+        stage_ = Stage::Head;
+        return true;
+    }
+
+    /// Whether part of a response was consumed
+    [[nodiscard]] bool started() const noexcept {
+        return stage_ != Stage::Head;
+    }
+
+    /// Whether the connection may carry another request after the response just completed
+    [[nodiscard]] bool keep_alive() const noexcept {
+        return keep_alive_;
+    }
+
+private:
+    enum class Stage : std::uint8_t {
+        Head,
+        Body,
+        ChunkSize,
+        ChunkData,
+        ChunkEnd,
+        Trailers,
+        UntilClose
+    };
+
+    static constexpr std::size_t MaxChunkLine = 1024;
+
+    Result parse_head(std::string_view head, HttpClientResponse& response) {
+        // Status line: HTTP/1.x SP 3DIGIT [SP reason]
+        const std::size_t line_end = head.find('\n');
+        const std::string_view line = head.substr(0, line_end);
+        if (line.size() < 12 || !line.starts_with("HTTP/1.") || line[7] < '0' || line[7] > '9' ||
+            line[8] != ' ') {
+            return Result::Error;
+        }
+        int status = 0;
+        const auto [last, ec] = std::from_chars(line.data() + 9, line.data() + 12, status);
+        if (ec != std::errc{} || last != line.data() + 12 || status < 100) {
+            return Result::Error;
+        }
+
+        bool close = false;
+        bool keep_alive = false;
+        chunked_ = false;
+        has_length_ = false;
+        remaining_ = 0;
+        std::string_view rest = head.substr(line_end + 1);
+        while (!rest.empty()) {
+            const std::size_t end = rest.find('\n');
+            std::string_view field = rest.substr(0, end);
+            rest.remove_prefix(end + 1);
+            if (field.ends_with('\r')) {
+                field.remove_suffix(1);
+            }
+            if (field.empty()) {
+                break;
+            }
+            const std::size_t colon = field.find(':');
+            if (colon == std::string_view::npos || colon == 0) {
+                return Result::Error;
+            }
+            const std::string_view name = field.substr(0, colon);
+            const std::string_view value = detail::trim_spaces(field.substr(colon + 1));
+            if (detail::iequals(name, "content-length")) {
+                std::size_t length = 0;
+                const auto [end_of_length, length_ec] =
+                    std::from_chars(value.data(), value.data() + value.size(), length);
+                if (length_ec != std::errc{} || end_of_length != value.data() + value.size() ||
+                    (has_length_ && length != remaining_)) {
+                    return Result::Error;
+                }
+                has_length_ = true;
+                remaining_ = length;
+            } else if (detail::iequals(name, "transfer-encoding")) {
+                // Chunked must be the final coding; any other coding runs until the close
+                const std::string_view last_coding = value.substr(value.rfind(',') + 1);
+                chunked_ = detail::iequals(detail::trim_spaces(last_coding), "chunked");
+            } else if (detail::iequals(name, "connection")) {
+                close = close || detail::lists_token(value, "close");
+                keep_alive = keep_alive || detail::lists_token(value, "keep-alive");
+            }
+        }
+        if (chunked_) {
+            has_length_ = false; // Transfer-Encoding overrides Content-Length (RFC 9112, 6.3)
+        }
+        keep_alive_ = line[7] >= '1' ? !close : keep_alive && !close;
+        response.status = status;
+        response.head.assign(head);
+        return Result::Complete;
+    }
+
+    Stage stage_ = Stage::Head;
+    std::size_t remaining_ = 0;
+    bool has_length_ = false;
+    bool chunked_ = false;
+    bool keep_alive_ = true;
+};
+
+/// A request on its way through the client
+struct Pending {
+    std::string bytes; ///< Serialized request
+    HttpClient::Callback callback;
+    bool idempotent = true;
+    bool head = false;
+    bool retried = false;
+    Clock::time_point deadline{};
+};
+
+/// A request handed from request() to the loop
+struct Submission {
+    std::string key; ///< "host:port", naming the pool
+    std::shared_ptr<const Addresses> addresses;
+    Pending request;
+    HttpClientErrc error{}; ///< Set when the request failed before reaching the loop
+};
+
+/// A submission from the loop thread waiting for its host name to resolve
+struct Lookup {
+    Submission submission;
+    std::string host;
+    std::uint16_t port = 0;
+};
+
+struct HostPool;
+
+struct ClientConnection {
+    HostPool* pool = nullptr;
+    int fd = -1;
+    bool connected = false;
+    bool reusable = true;       ///< May take more requests
+    std::uint64_t served = 0;   ///< Responses received
+    std::deque<Pending> in_flight; ///< Assigned requests, answered in this order
+    std::size_t unsent = 0;        ///< Index in in_flight of the first request not fully written
+    std::size_t unsent_offset = 0; ///< Bytes of that request already written
+    /// Non-idempotent requests in flight, which nothing is pipelined behind
+    std::size_t idempotent_blockers = 0;
+    std::string input;             ///< Receive buffer; input_size bytes of it are in use
+    std::size_t input_size = 0;
+    ResponseParser parser;
+    HttpClientResponse response; ///< Being received for in_flight.front()
+    Clock::time_point idle_since{};
+};
+
+struct HostPool {
+    std::shared_ptr<const Addresses> addresses;
+    std::size_t next_address = 0; ///< Connections rotate through the addresses
+    std::vector<std::unique_ptr<ClientConnection>> connections;
+    std::deque<Pending> waiting;
+};
+
+struct CachedAddresses {
+    std::shared_ptr<const Addresses> addresses;
+    Clock::time_point expires;
+};
+
+// Bytes read per recv() at least; the buffer doubles past that
+constexpr std::size_t ReadSize = 16384;
+
+// Requests gathered into one sendmsg() call
+constexpr std::size_t MaxIovecs = 16;
+
+// How often timeouts are checked while any connection is open
+constexpr auto SweepInterval = std::chrono::milliseconds(100);
+
+} // namespace
+
+namespace detail {
+
+/**
+ * @brief Event loop of an HttpClient: pools, connections and the thread
+ *
+ * Everything but submit(), resolve(), the DNS cache and the counters is
+ * touched only by the loop's thread. Host names requested from the loop
+ * thread that the cache cannot answer go to a resolver thread, which
+ * submits the request once the lookup is done. Connections closed while a batch of epoll events is
+ * handled are kept until the batch ends, so later events naming them are
+ * recognised (by fd -1) and dropped.
+ */
+class ClientLoop {
+public:
+    explicit ClientLoop(const HttpClientOptions& options);
+    ~ClientLoop();
+
+    ClientLoop(const ClientLoop&) = delete;
+    ClientLoop& operator=(const ClientLoop&) = delete;
+
+    /// Hand a request to the loop; any thread
+    void submit(Submission submission);
+
+    /// Addresses of host, from the cache while fresh; nullptr if it does not resolve. Any thread.
+    std::shared_ptr<const Addresses> resolve(const std::string& key,
+                                             const std::string& host,
+                                             std::uint16_t port);
+
+    /// Fresh cached addresses for key, or nullptr; any thread
+    std::shared_ptr<const Addresses> cached(const std::string& key);
+
+    /// Resolve on the resolver thread, then submit; loop thread only
+    void resolve_then_submit(Lookup lookup);
+
+    [[nodiscard]] bool on_loop_thread() const noexcept {
+        return std::this_thread::get_id() == thread_.get_id();
+    }
+
+    void add_stats(HttpClientStats& stats) const noexcept;
+
+private:
+    struct alignas(64) Counters {
+        std::atomic<std::uint64_t> requests{0};
+        std::atomic<std::uint64_t> connections{0};
+        std::atomic<std::uint64_t> reused{0};
+        std::atomic<std::uint64_t> pipelined{0};
+        std::atomic<std::uint64_t> retried{0};
+    };
+
+    /// Counters have a single writer, so a plain store avoids a locked add
+    static void count(std::atomic<std::uint64_t>& counter) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void close_descriptors() noexcept;
+    void run() noexcept;
+    void run_resolver() noexcept;
+    void drain_submissions();
+    void accept(Submission submission);
+    void dispatch(HostPool& pool);
+    ClientConnection* pick(HostPool& pool, const Pending& request);
+    ClientConnection* open(HostPool& pool);
+    void assign(ClientConnection& connection, Pending request);
+    void on_event(ClientConnection& connection, std::uint32_t events);
+    bool flush(ClientConnection& connection);
+    bool read(ClientConnection& connection);
+    bool process(ClientConnection& connection);
+    void answer(ClientConnection& connection);
+    void close(ClientConnection& connection, HttpClientErrc reason);
+    void sweep(Clock::time_point now);
+    void complete(Pending& request, HttpResult result);
+    void fail_everything();
+
+    HttpClientOptions options_;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::thread thread_;
+    std::atomic<bool> stopping_{false};
+
+    std::mutex mutex_; ///< Guards queue_ and wake_pending_
+    std::vector<Submission> queue_;
+    bool wake_pending_ = false;
+
+    std::mutex dns_mutex_; ///< Guards dns_
+    std::unordered_map<std::string, CachedAddresses> dns_;
+
+    std::thread resolver_;
+    std::mutex resolver_mutex_; ///< Guards lookups_ and resolver_stopping_
+    std::condition_variable resolver_wake_;
+    std::deque<Lookup> lookups_;
+    bool resolver_stopping_ = false;
+
+    // Loop thread only
+    std::vector<Submission> local_; ///< Submitted by callbacks
+    std::unordered_map<std::string, HostPool> pools_;
+    std::vector<HostPool*> redispatch_; ///< Pools whose waiting requests may now find a connection
+    std::vector<std::unique_ptr<ClientConnection>> closed_;
+    std::size_t open_connections_ = 0;
+    Clock::time_point next_sweep_{};
+
+    Counters counters_;
+};
+
+ClientLoop::ClientLoop(const HttpClientOptions& options) : options_(options) {
+    const auto fail_setup = [this](const char* what) {
+        const auto message = std::generic_category().message(errno);
+        close_descriptors();
+        throw core::Exception(what + (": " + message));
+    };
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        fail_setup("epoll_create1 failed");
+    }
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        fail_setup("eventfd failed");
+    }
+    epoll_event wake{};
+    wake.events = EPOLLIN;
+    wake.data.ptr = nullptr;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake) < 0) {
+        fail_setup("Failed to register eventfd");
+    }
+    thread_ = std::thread([this] { run(); });
+    resolver_ = std::thread([this] { run_resolver(); });
+}
+
+ClientLoop::~ClientLoop() {
+    // Stop the resolver first: lookups it has not started fail on the loop, which is still running
+    std::deque<Lookup> abandoned;
+    {
+        const std::lock_guard lock(resolver_mutex_);
+        resolver_stopping_ = true;
+        abandoned.swap(lookups_);
+    }
+    resolver_wake_.notify_one();
+    resolver_.join();
+    for (Lookup& lookup : abandoned) {
+        lookup.submission.error = HttpClientErrc::Shutdown;
+        submit(std::move(lookup.submission));
+    }
+
+    stopping_.store(true, std::memory_order_release);
+    const std::uint64_t one = 1;
+    static_cast<void>(::write(wake_fd_, &one, sizeof one));
+    thread_.join();
+    close_descriptors();
+}
+
+void ClientLoop::close_descriptors() noexcept {
+    for (const int fd : {epoll_fd_, wake_fd_}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    epoll_fd_ = -1;
+    wake_fd_ = -1;
+}
+
+void ClientLoop::submit(Submission submission) {
+    if (on_loop_thread()) {
+        local_.push_back(std::move(submission)); // From a callback: picked up when the batch ends
+        return;
+    }
+    bool wake = false;
+    {
+        const std::lock_guard lock(mutex_);
+        queue_.push_back(std::move(submission));
+        wake = !wake_pending_;
+        wake_pending_ = true;
+    }
+    // One wakeup per batch of submissions, however many threads submit
+    if (wake) {
+        const std::uint64_t one = 1;
+        static_cast<void>(::write(wake_fd_, &one, sizeof one));
+    }
+}
+
+std::shared_ptr<const Addresses> ClientLoop::cached(const std::string& key) {
+    const std::lock_guard lock(dns_mutex_);
+    const auto entry = dns_.find(key);
+    return entry != dns_.end() && entry->second.expires > Clock::now() ? entry->second.addresses
+                                                                       : nullptr;
+}
+
+std::shared_ptr<const Addresses> ClientLoop::resolve(const std::string& key,
+                                                     const std::string& host,
+                                                     std::uint16_t port) {
+    if (auto addresses = cached(key)) {
+        return addresses;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* list = nullptr;
+    if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &list) != 0) {
+        return nullptr;
+    }
+    auto addresses = std::make_shared<Addresses>();
+    for (const addrinfo* entry = list; entry != nullptr; entry = entry->ai_next) {
+        if (entry->ai_addrlen <= sizeof(sockaddr_storage)) {
+            Address& address = addresses->emplace_back();
+            std::memcpy(&address.storage, entry->ai_addr, entry->ai_addrlen);
+            address.length = entry->ai_addrlen;
+        }
+    }
+    ::freeaddrinfo(list);
+    if (addresses->empty()) {
+        return nullptr;
+    }
+
+    const std::lock_guard lock(dns_mutex_);
+    dns_[key] = {addresses, Clock::now() + options_.dns_ttl};
+    return addresses;
+}
+
+void ClientLoop::resolve_then_submit(Lookup lookup) {
+    {
+        const std::lock_guard lock(resolver_mutex_);
+        if (!resolver_stopping_) {
+            lookups_.push_back(std::move(lookup));
+            resolver_wake_.notify_one();
+            return;
+        }
+    }
+    // A callback run while the client shuts down
+    lookup.submission.error = HttpClientErrc::Shutdown;
+    submit(std::move(lookup.submission));
+}
+
+void ClientLoop::run_resolver() noexcept {
+    for (;;) {
+        Lookup lookup;
+        {
+            std::unique_lock lock(resolver_mutex_);
+            resolver_wake_.wait(lock, [this] { return resolver_stopping_ || !lookups_.empty(); });
+            if (resolver_stopping_) {
+                return;
+            }
+            lookup = std::move(lookups_.front());
+            lookups_.pop_front();
+        }
+        // An earlier lookup of the same host may have filled the cache meanwhile
+        Submission& submission = lookup.submission;
+        submission.addresses = resolve(submission.key, lookup.host, lookup.port);
+        if (!submission.addresses) {
+            submission.error = HttpClientErrc::ResolveFailed;
+        }
+        submit(std::move(submission));
+    }
+}
+
+void ClientLoop::add_stats(HttpClientStats& stats) const noexcept {
+    stats.requests += counters_.requests.load(std::memory_order_relaxed);
+    stats.connections += counters_.connections.load(std::memory_order_relaxed);
+    stats.reused += counters_.reused.load(std::memory_order_relaxed);
+    stats.pipelined += counters_.pipelined.load(std::memory_order_relaxed);
+    stats.retried += counters_.retried.load(std::memory_order_relaxed);
+}
+
+void ClientLoop::run() noexcept {
+    std::array<epoll_event, 64> events{};
+    while (!stopping_.load(std::memory_order_acquire)) {
+        // Without connections there are no timeouts to check, so sleep until woken
+        const int timeout = open_connections_ == 0 ? -1 : static_cast<int>(SweepInterval.count());
+        const int n =
+            ::epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), timeout);
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                std::uint64_t value = 0;
+                static_cast<void>(::read(wake_fd_, &value, sizeof value));
+            } else {
+                on_event(*static_cast<ClientConnection*>(events[i].data.ptr), events[i].events);
+            }
+        }
+        drain_submissions();
+        const auto now = Clock::now();
+        if (now >= next_sweep_) {
+            sweep(now);
+            next_sweep_ = now + SweepInterval;
+        }
+        while (!redispatch_.empty()) {
+            auto pools = std::move(redispatch_);
+            redispatch_.clear();
+            for (HostPool* pool : pools) {
+                dispatch(*pool);
+            }
+            drain_submissions();
+        }
+        closed_.clear();
+    }
+    fail_everything();
+}
+
+void ClientLoop::drain_submissions() {
+    std::vector<Submission> batch;
+    {
+        const std::lock_guard lock(mutex_);
+        batch.swap(queue_);
+        wake_pending_ = false;
+    }
+    for (Submission& submission : batch) {
+        accept(std::move(submission));
+    }
+    // Callbacks run by accept() may submit more
+    while (!local_.empty()) {
+        batch.clear();
+        batch.swap(local_);
+        for (Submission& submission : batch) {
+            accept(std::move(submission));
+        }
+    }
+}
+
+void ClientLoop::accept(Submission submission) {
+    if (submission.error != HttpClientErrc{}) {
+        complete(submission.request, core::unexpected(submission.error));
+        return;
+    }
+    HostPool& pool = pools_[submission.key];
+    pool.addresses = std::move(submission.addresses);
+    pool.waiting.push_back(std::move(submission.request));
+    dispatch(pool);
+}
+
+void ClientLoop::dispatch(HostPool& pool) {
+    while (!pool.waiting.empty()) {
+        ClientConnection* connection = pick(pool, pool.waiting.front());
+        if (connection == nullptr && !pool.connections.empty()) {
+            break; // Waits for a connection to free up
+        }
+        Pending request = std::move(pool.waiting.front());
+        pool.waiting.pop_front();
+        if (connection == nullptr) {
+            complete(request, core::unexpected(HttpClientErrc::ConnectFailed));
+        } else {
+            assign(*connection, std::move(request));
+        }
+    }
+}
+
+ClientConnection* ClientLoop::pick(HostPool& pool, const Pending& request) {
+    ClientConnection* least_loaded = nullptr;
+    for (const auto& connection : pool.connections) {
+        if (!connection->reusable) {
+            continue;
+        }
+        if (connection->in_flight.empty()) {
+            return connection.get();
+        }
+        if (request.idempotent && connection->idempotent_blockers == 0 &&
+            connection->in_flight.size() < options_.max_pipeline &&
+            (least_loaded == nullptr ||
+             connection->in_flight.size() < least_loaded->in_flight.size())) {
+            least_loaded = connection.get();
+        }
+    }
+    if (pool.connections.size() < options_.max_connections_per_host) {
+        if (ClientConnection* fresh = open(pool)) {
+            return fresh;
+        }
+    }
+    return least_loaded;
+}
+
+ClientConnection* ClientLoop::open(HostPool& pool) {
+    if (!pool.addresses || pool.addresses->empty()) {
+        return nullptr;
+    }
+    const Address& address = (*pool.addresses)[pool.next_address++ % pool.addresses->size()];
+    const int fd =
+        ::socket(address.storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    const int connected =
+        ::connect(fd, reinterpret_cast<const sockaddr*>(&address.storage), address.length);
+    if (connected < 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    auto connection = std::make_unique<ClientConnection>();
+    connection->pool = &pool;
+    connection->fd = fd;
+    connection->connected = connected == 0;
+    connection->reusable = options_.keep_alive;
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = connection.get();
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    count(counters_.connections);
+    ++open_connections_;
+    pool.connections.push_back(std::move(connection));
+    return pool.connections.back().get();
+}
+
+void ClientLoop::assign(ClientConnection& connection, Pending request) {
+    if (connection.served > 0) {
+        count(counters_.reused);
+    }
+    if (!connection.in_flight.empty()) {
+        count(counters_.pipelined);
+    }
+    if (!request.idempotent) {
+        ++connection.idempotent_blockers;
+    }
+    if (options_.request_timeout.count() > 0) {
+        request.deadline = Clock::now() + options_.request_timeout;
+    }
+    connection.in_flight.push_back(std::move(request));
+    if (!options_.keep_alive) {
+        connection.reusable = false; // One request per connection
+    }
+    if (connection.connected) {
+        flush(connection);
+    }
+}
+
+void ClientLoop::on_event(ClientConnection& connection, std::uint32_t events) {
+    if (connection.fd < 0) {
+        return; // Closed earlier in this batch
+    }
+    if (!connection.connected) {
+        int error = 0;
+        socklen_t length = sizeof error;
+        ::getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0 || (events & EPOLLERR) != 0) {
+            close(connection, HttpClientErrc::ConnectFailed);
+            return;
+        }
+        if ((events & EPOLLOUT) == 0) {
+            return;
+        }
+        connection.connected = true;
+    }
+    if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0 && !read(connection)) {
+        return;
+    }
+    if ((events & EPOLLOUT) != 0) {
+        flush(connection);
+    }
+}
+
+bool ClientLoop::flush(ClientConnection& connection) {
+    while (connection.unsent < connection.in_flight.size()) {
+        // Requests are written from where they are, several per call when pipelined
+        std::array<iovec, MaxIovecs> iovecs{};
+        std::size_t count = 0;
+        for (std::size_t i = connection.unsent;
+             i < connection.in_flight.size() && count < MaxIovecs;
+             ++i) {
+            std::string& bytes = connection.in_flight[i].bytes;
+            const std::size_t offset = i == connection.unsent ? connection.unsent_offset : 0;
+            iovecs[count++] = {bytes.data() + offset, bytes.size() - offset};
+        }
+        msghdr message{};
+        message.msg_iov = iovecs.data();
+        message.msg_iovlen = count;
+        const ssize_t n = ::sendmsg(connection.fd, &message, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return true; // EPOLLOUT resumes
+            }
+            close(connection, HttpClientErrc::ConnectionClosed);
+            return false;
+        }
+        auto left = static_cast<std::size_t>(n);
+        while (left > 0) {
+            const std::size_t rest =
+                connection.in_flight[connection.unsent].bytes.size() - connection.unsent_offset;
+            if (left < rest) {
+                connection.unsent_offset += left;
+                break;
+            }
+            left -= rest;
+            ++connection.unsent;
+            connection.unsent_offset = 0;
+        }
+    }
+    return true;
+}
+
+bool ClientLoop::read(ClientConnection& connection) {
+    for (;;) {
+        if (connection.input.size() - connection.input_size < ReadSize / 4) {
+            connection.input.resize(std::max(ReadSize, connection.input.size() * 2));
+        }
+        const ssize_t n = ::recv(connection.fd, connection.input.data() + connection.input_size,
+                                 connection.input.size() - connection.input_size, 0);
+        if (n > 0) {
+            connection.input_size += static_cast<std::size_t>(n);
+            if (!process(connection)) {
+                return false;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        // Closed or failed: a body running until the close is complete now
+        if (n == 0 && !connection.in_flight.empty() && connection.parser.finish_on_close()) {
+            answer(connection);
+        }
+        close(connection, HttpClientErrc::ConnectionClosed);
+        return false;
+    }
+}
+
+bool ClientLoop::process(ClientConnection& connection) {
+    std::size_t start = 0;
+    while (start < connection.input_size && !connection.in_flight.empty()) {
+        std::size_t consumed = 0;
+        const std::string_view bytes(connection.input.data() + start,
+                                     connection.input_size - start);
+        const auto result = connection.parser.parse(bytes,
+                                                    connection.in_flight.front().head,
+                                                    options_.max_response,
+                                                    connection.response,
+                                                    consumed);
+        start += consumed;
+        if (result == ResponseParser::Result::Incomplete) {
+            break;
+        }
+        if (result != ResponseParser::Result::Complete) {
+            close(connection,
+                  result == ResponseParser::Result::TooLarge ? HttpClientErrc::ResponseTooLarge
+                                                             : HttpClientErrc::BadResponse);
+            return false;
+        }
+        answer(connection);
+        if (!connection.reusable) {
+            // Done with: requests still in flight are sent again on another connection
+            close(connection, HttpClientErrc::ConnectionClosed);
+            return false;
+        }
+    }
+    if (start > 0) {
+        std::memmove(connection.input.data(),
+                     connection.input.data() + start,
+                     connection.input_size - start);
+        connection.input_size -= start;
+    }
+    if (connection.in_flight.empty()) {
+        if (connection.input_size > 0) {
+            close(connection, HttpClientErrc::BadResponse); // Bytes nobody asked for
+            return false;
+        }
+        connection.idle_since = Clock::now();
+    }
+    if (!connection.pool->waiting.empty()) {
+        redispatch_.push_back(connection.pool);
+    }
+    return true;
+}
+
+void ClientLoop::answer(ClientConnection& connection) {
+    Pending request = std::move(connection.in_flight.front());
+    connection.in_flight.pop_front();
+    if (connection.unsent > 0) {
+        --connection.unsent;
+    } else {
+        // Answered before it was completely sent: the rest of the stream is unusable
+        connection.unsent_offset = 0;
+        connection.reusable = false;
+    }
+    if (!request.idempotent) {
+        --connection.idempotent_blockers;
+    }
+    ++connection.served;
+    if (!connection.parser.keep_alive()) {
+        connection.reusable = false;
+    }
+    HttpClientResponse response = std::move(connection.response);
+    connection.response = {};
+    complete(request, std::move(response));
+}
+
+void ClientLoop::close(ClientConnection& connection, HttpClientErrc reason) {
+    HostPool& pool = *connection.pool;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection.fd, nullptr);
+    ::close(connection.fd);
+    connection.fd = -1;
+    --open_connections_;
+
+    const auto is_self = [&](const auto& candidate) { return candidate.get() == &connection; };
+    const auto self = std::find_if(pool.connections.begin(), pool.connections.end(), is_self);
+    closed_.push_back(std::move(*self));
+    pool.connections.erase(self);
+
+    // The first request gets the error if its response had started or the failure is its own (a
+    // timeout, a bad response); requests behind it, and one on a connection that carried others
+    // before, are sent once more where they are idempotent
+    std::deque<Pending> requests = std::move(connection.in_flight);
+    const bool front_started = connection.parser.started() || connection.input_size > 0;
+    std::deque<Pending> retries;
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        Pending& request = requests[i];
+        const bool front_fails =
+            i == 0 &&
+            (front_started || reason != HttpClientErrc::ConnectionClosed || connection.served == 0);
+        const bool retry = reason != HttpClientErrc::ConnectFailed && request.idempotent &&
+                           !request.retried && !front_fails;
+        if (retry) {
+            request.retried = true;
+            count(counters_.retried);
+            retries.push_back(std::move(request));
+        } else {
+            const HttpClientErrc error = i == 0 ? reason : HttpClientErrc::ConnectionClosed;
+            complete(request, core::unexpected(error));
+        }
+    }
+    pool.waiting.insert(pool.waiting.begin(), std::make_move_iterator(retries.begin()),
+                        std::make_move_iterator(retries.end()));
+    if (!pool.waiting.empty()) {
+        redispatch_.push_back(&pool);
+    }
+}
+
+void ClientLoop::sweep(Clock::time_point now) {
+    std::vector<std::pair<ClientConnection*, HttpClientErrc>> expired;
+    for (auto& [key, pool] : pools_) {
+        for (const auto& connection : pool.connections) {
+            if (connection->in_flight.empty()) {
+                if (now - connection->idle_since >= options_.idle_timeout) {
+                    expired.emplace_back(connection.get(), HttpClientErrc::ConnectionClosed);
+                }
+            } else if (options_.request_timeout.count() > 0 &&
+                       connection->in_flight.front().deadline <= now) {
+                expired.emplace_back(connection.get(), HttpClientErrc::Timeout);
+            }
+        }
+    }
+    for (const auto& [connection, reason] : expired) {
+        close(*connection, reason);
+    }
+}
+
+void ClientLoop::complete(Pending& request, HttpResult result) {
+    count(counters_.requests);
+    try {
+        request.callback(std::move(result));
+    } catch (...) {
+        // A throwing callback must not take the loop down
+    }
+}
+
+void ClientLoop::fail_everything() {
+    const auto shutdown = [this](Pending& request) {
+        complete(request, core::unexpected(HttpClientErrc::Shutdown));
+    };
+    for (auto& [key, pool] : pools_) {
+        for (const auto& connection : pool.connections) {
+            ::close(connection->fd);
+            for (Pending& request : connection->in_flight) {
+                shutdown(request);
+            }
+        }
+        pool.connections.clear();
+        for (Pending& request : pool.waiting) {
+            shutdown(request);
+        }
+        pool.waiting.clear();
+    }
+    // Submissions not yet seen, including any made by the callbacks above
+    for (;;) {
+        std::vector<Submission> batch;
+        {
+            const std::lock_guard lock(mutex_);
+            batch.swap(queue_);
+        }
+        batch.insert(batch.end(),
+                     std::make_move_iterator(local_.begin()),
+                     std::make_move_iterator(local_.end()));
+        local_.clear();
+        if (batch.empty()) {
+            break;
+        }
+        for (Submission& submission : batch) {
+            shutdown(submission.request);
+        }
+    }
+}
+
+} // namespace detail
+
+HttpClient::HttpClient(HttpClientOptions options) : options_(std::move(options)) {
+    if (options_.max_connections_per_host == 0 || options_.max_pipeline == 0) {
+        throw std::invalid_argument("max_connections_per_host and max_pipeline must be at least 1");
+    }
+    loop_ = std::make_unique<detail::ClientLoop>(options_);
+}
+
+HttpClient::~HttpClient() = default;
+
+void HttpClient::request(HttpClientRequest request, Callback callback) {
+    Submission submission;
+    submission.request.callback = std::move(callback);
+    const auto url = parse_url(request.url);
+    if (!url) {
+        submission.error = HttpClientErrc::InvalidUrl;
+    } else {
+        submission.key.append(url->host).append(":").append(std::to_string(url->port));
+        submission.request.bytes = serialize(request, *url, options_.keep_alive);
+        submission.request.idempotent = is_idempotent(request.method);
+        submission.request.head = request.method == "HEAD";
+        if (loop_->on_loop_thread()) {
+            // From a callback or a resumed coroutine: a lookup here would stall every connection
+            submission.addresses = loop_->cached(submission.key);
+            if (!submission.addresses) {
+                loop_->resolve_then_submit({std::move(submission), url->host, url->port});
+                return;
+            }
+        } else {
+            submission.addresses = loop_->resolve(submission.key, url->host, url->port);
+            if (!submission.addresses) {
+                submission.error = HttpClientErrc::ResolveFailed;
+            }
+        }
+    }
+    loop_->submit(std::move(submission));
+}
+
+HttpClientStats HttpClient::stats() const noexcept {
+    HttpClientStats stats;
+    loop_->add_stats(stats);
+    return stats;
+}
+
+#else
+
+namespace detail {
+
+class ClientLoop {};
+
+} // namespace detail
+
+HttpClient::HttpClient(HttpClientOptions options) : options_(std::move(options)) {
+    throw core::Exception("HttpClient is only supported on Linux");
+}
+
+HttpClient::~HttpClient() = default;
+
+void HttpClient::request(HttpClientRequest, Callback) {}
+
+HttpClientStats HttpClient::stats() const noexcept {
+    return {};
+}
+
+#endif
+
+} // namespace cpptemplate::network
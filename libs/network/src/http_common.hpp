@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+
+// Text helpers shared by the server side (http.cpp) and HttpClient
+
+namespace cpptemplate::network::detail {
+
+constexpr bool is_space(char c) noexcept {
+    return c == ' ' || c == '\t';
+}
+
+constexpr char to_lower(char c) noexcept {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c;
+}
+
+/// ASCII case-insensitive comparison, as header names and tokens are compared
+inline bool iequals(std::string_view a, std::string_view b) noexcept {
+    const auto same = [](char x, char y) { return to_lower(x) == to_lower(y); };
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), same);
+}
+
+/// text without leading and trailing spaces and tabs
+inline std::string_view trim_spaces(std::string_view text) noexcept {
+    while (!text.empty() && is_space(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && is_space(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/// Whether a comma-separated list such as a Connection header holds token
+inline bool lists_token(std::string_view list, std::string_view token) noexcept {
+    while (!list.empty()) {
+        const std::size_t comma = std::min(list.find(','), list.size());
+        if (iequals(trim_spaces(list.substr(0, comma)), token)) {
+            return true;
+        }
+        list.remove_prefix(std::min(comma + 1, list.size()));
+    }
+    return false;
+}
+
+/// Offset just past the first blank line that starts at or after from, npos if there is none
+inline std::size_t find_head_end(std::string_view bytes, std::size_t from) noexcept {
+    // memchr for LF, the fastest scan there is, then a look at what follows
+    for (std::size_t i = bytes.find('\n', from); i != std::string_view::npos;
+         i = bytes.find('\n', i + 1)) {
+        if (i + 1 < bytes.size() && bytes[i + 1] == '\n') {
+            return i + 2;
+        }
+        if (i + 2 < bytes.size() && bytes[i + 1] == '\r' && bytes[i + 2] == '\n') {
+            return i + 3;
+        }
+    }
+    return std::string_view::npos;
+}
+
+} // namespace cpptemplate::network::detail
@@ -0,0 +1,193 @@
+#include "http_kernels.hpp"
+
+#include <bit>
+#include <cstdint>
+
+#if CPPTEMPLATE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+#if CPPTEMPLATE_NEON_KERNELS
+    #include <arm_neon.h>
+#endif
+
+namespace cpptemplate::network::detail {
+
+namespace {
+
+// Scalar kernels
+
+constexpr bool ends_value(char c) noexcept {
+    const auto byte = static_cast<unsigned char>(c);
+    return (byte < 0x20 && byte != '\t') || byte == 0x7F;
+}
+
+constexpr bool ends_target(char c) noexcept {
+    const auto byte = static_cast<unsigned char>(c);
+    return byte <= 0x20 || byte == 0x7F;
+}
+
+std::size_t find_value_end_scalar(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    while (i < n && !ends_value(s[i])) {
+        ++i;
+    }
+    return i;
+}
+
+std::size_t find_target_end_scalar(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    while (i < n && !ends_target(s[i])) {
+        ++i;
+    }
+    return i;
+}
+
+constexpr HttpKernels ScalarKernels{find_value_end_scalar, find_target_end_scalar};
+
+#if CPPTEMPLATE_X86_KERNELS
+
+// x86 kernels: byte <= limit is min(byte, limit) == byte in unsigned terms,
+// which leaves bytes of 0x80 and above (UTF-8 in values) alone
+
+CPPTEMPLATE_SSE42 inline __m128i at_most_sse(__m128i v, char limit) noexcept {
+    return _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(limit)), v);
+}
+
+CPPTEMPLATE_SSE42 inline unsigned value_end_mask_sse(__m128i v) noexcept {
+    const __m128i control =
+        _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), at_most_sse(v, 0x1F));
+    return static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_or_si128(control, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)))));
+}
+
+CPPTEMPLATE_SSE42 inline unsigned target_end_mask_sse(__m128i v) noexcept {
+    return static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_or_si128(at_most_sse(v, 0x20), _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)))));
+}
+
+CPPTEMPLATE_SSE42 std::size_t find_value_end_sse(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const unsigned hits =
+            value_end_mask_sse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)));
+        if (hits != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(hits));
+        }
+    }
+    return i + find_value_end_scalar(s + i, n - i);
+}
+
+CPPTEMPLATE_SSE42 std::size_t find_target_end_sse(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const unsigned hits =
+            target_end_mask_sse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)));
+        if (hits != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(hits));
+        }
+    }
+    return i + find_target_end_scalar(s + i, n - i);
+}
+
+constexpr HttpKernels Sse42Kernels{find_value_end_sse, find_target_end_sse};
+
+CPPTEMPLATE_AVX2 inline __m256i at_most_avx2(__m256i v, char limit) noexcept {
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(limit)), v);
+}
+
+CPPTEMPLATE_AVX2 std::size_t find_value_end_avx2(const char* s, std::size_t n) noexcept {
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const __m256i control =
+            _mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), at_most_avx2(v, 0x1F));
+        const auto hits = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_or_si256(control, _mm256_cmpeq_epi8(v, del))));
+        if (hits != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(hits));
+        }
+    }
+    return i + find_value_end_sse(s + i, n - i);
+}
+
+CPPTEMPLATE_AVX2 std::size_t find_target_end_avx2(const char* s, std::size_t n) noexcept {
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const auto hits = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_or_si256(at_most_avx2(v, 0x20), _mm256_cmpeq_epi8(v, del))));
+        if (hits != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(hits));
+        }
+    }
+    return i + find_target_end_sse(s + i, n - i);
+}
+
+constexpr HttpKernels Avx2Kernels{find_value_end_avx2, find_target_end_avx2};
+
+#endif // CPPTEMPLATE_X86_KERNELS
+
+#if CPPTEMPLATE_NEON_KERNELS
+
+// As in the utils kernels: narrowing by 4 bits packs a compare result into
+// 64 bits, 4 per byte
+
+inline std::uint64_t nibble_mask(uint8x16_t bytes) noexcept {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(bytes), 4)), 0);
+}
+
+inline uint8x16_t load(const char* s) noexcept {
+    return vld1q_u8(reinterpret_cast<const std::uint8_t*>(s));
+}
+
+std::size_t find_value_end_neon(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint8x16_t v = load(s + i);
+        const uint8x16_t control =
+            vbicq_u8(vcleq_u8(v, vdupq_n_u8(0x1F)), vceqq_u8(v, vdupq_n_u8('\t')));
+        const std::uint64_t hits = nibble_mask(vorrq_u8(control, vceqq_u8(v, vdupq_n_u8(0x7F))));
+        if (hits != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(hits)) / 4;
+        }
+    }
+    return i + find_value_end_scalar(s + i, n - i);
+}
+
+std::size_t find_target_end_neon(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint8x16_t v = load(s + i);
+        const std::uint64_t hits =
+            nibble_mask(vorrq_u8(vcleq_u8(v, vdupq_n_u8(0x20)), vceqq_u8(v, vdupq_n_u8(0x7F))));
+        if (hits != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(hits)) / 4;
+        }
+    }
+    return i + find_target_end_scalar(s + i, n - i);
+}
+
+constexpr HttpKernels NeonKernels{find_value_end_neon, find_target_end_neon};
+
+#endif // CPPTEMPLATE_NEON_KERNELS
+
+} // namespace
+
+const HttpKernels& http_kernels(core::SimdLevel level) noexcept {
+    switch (level) {
+#if CPPTEMPLATE_X86_KERNELS
+        case core::SimdLevel::Avx512:
+        case core::SimdLevel::Avx2: return Avx2Kernels;
+        case core::SimdLevel::Sse42: return Sse42Kernels;
+#endif
+#if CPPTEMPLATE_NEON_KERNELS
+        case core::SimdLevel::Neon: return NeonKernels;
+#endif
+        default: return ScalarKernels;
+    }
+}
+
+} // namespace cpptemplate::network::detail
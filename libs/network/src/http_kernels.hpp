@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+#include "cpptemplate/core/simd.hpp"
+
+namespace cpptemplate::network::detail {
+
+/**
+ * @brief Scanners behind HttpParser for one core::SimdLevel
+ *
+ * Both stop at the first byte a field may not hold, which for a well-formed
+ * request is the CR or LF ending its line; the parser then checks which
+ * byte it found.
+ */
+struct HttpKernels {
+    /// Index of the first control byte other than HT, or DEL, in s[0, n); n if there is none
+    std::size_t (*find_value_end)(const char* s, std::size_t n) noexcept;
+    /// Index of the first control byte, space or DEL in s[0, n); n if there is none
+    std::size_t (*find_target_end)(const char* s, std::size_t n) noexcept;
+};
+
+/**
+ * @brief Get the scanners of a level
+ * @param level Level, which must be supported by the running CPU
+ * @return Kernel table with static storage duration
+ */
+const HttpKernels& http_kernels(core::SimdLevel level) noexcept;
+
+/**
+ * @brief Get the scanners of the active level
+ * @return Kernel table for core::simd_level()
+ */
+inline const HttpKernels& http_kernels() noexcept {
+    return http_kernels(core::simd_level());
+}
+
+} // namespace cpptemplate::network::detail
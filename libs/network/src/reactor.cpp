@@ -0,0 +1,285 @@
+#include "reactor.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#include "cpptemplate/core/exception.hpp"
+
+namespace cpptemplate::network::detail {
+
+namespace {
+
+// Drained output queues kept for reuse, so a busy connection does not
+// allocate one per response
+constexpr std::size_t MaxSpareQueues = 1024;
+
+} // namespace
+
+Reactor::Reactor(TcpServer& server, std::size_t index, std::size_t loops)
+    : server_(server), index_(index), loops_(loops), pool_(server.options().buffer_size) {}
+
+void Reactor::start() {
+    thread_ = std::thread([this] { run(); });
+#if defined(__linux__)
+    if (server_.options().pin_threads) {
+        const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index_ % cpus, &set);
+        ::pthread_setaffinity_np(thread_.native_handle(), sizeof set, &set);
+    }
+#endif
+}
+
+void Reactor::stop() noexcept {
+    if (!thread_.joinable()) {
+        return;
+    }
+    wake();
+    thread_.join();
+}
+
+void Reactor::add_stats(ServerStats& stats) const noexcept {
+    stats.accepted += counters_.accepted.load(std::memory_order_relaxed);
+    stats.active += counters_.active.load(std::memory_order_relaxed);
+    stats.bytes_received += counters_.bytes_received.load(std::memory_order_relaxed);
+    stats.bytes_sent += counters_.bytes_sent.load(std::memory_order_relaxed);
+}
+
+Connection* Reactor::adopt(int fd) noexcept {
+    try {
+        if (free_slots_.empty()) {
+            // Room for every slot on the free list, so destroy() never allocates
+            if (free_slots_.capacity() <= slots_.size()) {
+                free_slots_.reserve(2 * slots_.size() + 16);
+            }
+            slots_.push_back({});
+            free_slots_.push_back(static_cast<std::uint32_t>(slots_.size() - 1));
+        }
+        const std::uint32_t slot = free_slots_.back();
+        auto* connection = new Connection(*this, fd, slot, next_id_ * loops_ + index_);
+        free_slots_.pop_back();
+        ++next_id_;
+        slots_[slot].connection = connection;
+        return connection;
+    } catch (...) {
+#if defined(__linux__)
+        ::close(fd);
+#endif
+        return nullptr;
+    }
+}
+
+void Reactor::abandon(Connection& connection) noexcept {
+    close_socket(connection);
+    Slot& slot = slots_[connection.slot_];
+    slot.connection = nullptr;
+    ++slot.generation;
+    free_slots_.push_back(connection.slot_);
+    delete &connection;
+}
+
+void Reactor::opened(Connection& connection) {
+    count(counters_.accepted, 1);
+    count(counters_.active, 1);
+    if (server_.on_connect_) {
+        try {
+            server_.on_connect_(connection);
+        } catch (...) {
+            fail(connection);
+        }
+    }
+    finish(connection);
+}
+
+std::uint32_t Reactor::generation(const Connection& connection) const noexcept {
+    return slots_[connection.slot_].generation;
+}
+
+void Reactor::receive(Connection& connection, std::string_view bytes) {
+    if (connection.closing_) {
+        return; // Input after close() is ignored
+    }
+    count(counters_.bytes_received, bytes.size());
+    Buffer& input = connection.input_;
+    if (input.empty()) {
+        // Common case: hand the handler the kernel's bytes and copy only what it leaves
+        std::size_t consumed = bytes.size();
+        if (server_.on_data_) {
+            try {
+                consumed = std::min(server_.on_data_(connection, bytes), consumed);
+            } catch (...) {
+                fail(connection);
+                return;
+            }
+        }
+        bytes.remove_prefix(consumed);
+        if (!bytes.empty() && !connection.closing_ && reserve_input(connection, bytes.size())) {
+            input.append(bytes);
+        }
+    } else if (reserve_input(connection, bytes.size())) {
+        input.append(bytes);
+        deliver(connection);
+    }
+    trim_input(connection);
+}
+
+void Reactor::deliver(Connection& connection) {
+    Buffer& input = connection.input_;
+    std::size_t consumed = input.size();
+    if (server_.on_data_) {
+        try {
+            consumed = std::min(server_.on_data_(connection, input.readable()), consumed);
+        } catch (...) {
+            fail(connection);
+            return;
+        }
+    }
+    input.consume(consumed);
+}
+
+bool Reactor::reserve_input(Connection& connection, std::size_t n) {
+    Buffer& input = connection.input_;
+    if (!input) {
+        input = pool_.acquire();
+    }
+    if (input.writable() >= n) {
+        return true;
+    }
+    input.compact();
+    const std::size_t needed = input.size() + n;
+    if (input.capacity() >= needed) {
+        return true;
+    }
+    const std::size_t max_input = server_.options().max_input;
+    if (needed > max_input) {
+        fail(connection); // The handler is not consuming; stop reading
+        return false;
+    }
+    pool_.grow(input, std::min(std::bit_ceil(needed), max_input));
+    return true;
+}
+
+void Reactor::trim_input(Connection& connection) noexcept {
+    if (connection.input_ && connection.input_.empty()) {
+        pool_.release(connection.input_);
+    }
+}
+
+void Reactor::queue(Connection& connection,
+                    std::span<const std::string_view> pieces,
+                    std::size_t skip) {
+    if (!connection.output_) {
+        if (spare_queues_.empty()) {
+            connection.output_ = std::make_unique<OutputQueue>();
+        } else {
+            connection.output_ = std::move(spare_queues_.back());
+            spare_queues_.pop_back();
+        }
+    }
+    OutputQueue& output = *connection.output_;
+    for (std::string_view piece : pieces) {
+        const std::size_t skipped = std::min(skip, piece.size());
+        piece.remove_prefix(skipped);
+        skip -= skipped;
+        output.bytes += piece.size();
+        while (!piece.empty()) {
+            if (output.buffers.empty() || output.buffers.back().writable() == 0) {
+                output.buffers.push_back(pool_.acquire());
+            }
+            piece.remove_prefix(output.buffers.back().append(piece));
+        }
+    }
+}
+
+void Reactor::consume_output(OutputQueue& output, std::size_t n) noexcept {
+    count(counters_.bytes_sent, n);
+    output.bytes -= n;
+    while (n > 0) {
+        Buffer& front = output.buffers.front();
+        const std::size_t taken = std::min(n, front.size());
+        front.consume(taken);
+        n -= taken;
+        if (front.empty()) {
+            pool_.release(front);
+            output.buffers.pop_front();
+        }
+    }
+}
+
+void Reactor::recycle(std::unique_ptr<OutputQueue> output) noexcept {
+    for (Buffer& buffer : output->buffers) {
+        pool_.release(buffer);
+    }
+    output->buffers.clear();
+    output->bytes = 0;
+    if (spare_queues_.size() < MaxSpareQueues) {
+        try {
+            spare_queues_.push_back(std::move(output));
+        } catch (...) {
+            // Freed instead
+        }
+    }
+}
+
+void Reactor::finish(Connection& connection) {
+    if (connection.failed_ || (connection.closing_ && connection.pending_output() == 0)) {
+        destroy(connection);
+    }
+}
+
+void Reactor::fail(Connection& connection) noexcept {
+    connection.closing_ = true;
+    connection.failed_ = true;
+    if (connection.output_ && (connection.io_flags_ & OutputInFlight) == 0) {
+        recycle(std::move(connection.output_));
+    }
+}
+
+void Reactor::destroy(Connection& connection) noexcept {
+    if (server_.on_close_) {
+        try {
+            server_.on_close_(connection);
+        } catch (...) {
+            // Closing anyway
+        }
+    }
+    close_socket(connection);
+    pool_.release(connection.input_);
+    fail(connection);
+
+    Slot& slot = slots_[connection.slot_];
+    slot.connection = nullptr;
+    ++slot.generation;
+    free_slots_.push_back(connection.slot_);
+    counters_.active.store(counters_.active.load(std::memory_order_relaxed) - 1,
+                           std::memory_order_relaxed);
+    delete &connection;
+}
+
+void Reactor::destroy_all() noexcept {
+    for (const Slot& slot : slots_) {
+        if (slot.connection != nullptr) {
+            destroy(*slot.connection);
+        }
+    }
+}
+
+#if !defined(CPPTEMPLATE_NETWORK_HAS_IO_URING)
+
+bool uring_supported() noexcept {
+    return false;
+}
+
+std::unique_ptr<Reactor> make_uring_reactor(TcpServer&, std::size_t, std::size_t, int, bool) {
+    throw core::Exception("The network library was built without io_uring support");
+}
+
+#endif
+
+} // namespace cpptemplate::network::detail
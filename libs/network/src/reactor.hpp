@@ -0,0 +1,242 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+#endif
+
+#include "cpptemplate/network/buffer_pool.hpp"
+#include "cpptemplate/network/tcp_server.hpp"
+
+namespace cpptemplate::network::detail {
+
+/// Output the socket did not take yet, in pooled buffers
+struct OutputQueue {
+    std::deque<Buffer> buffers;
+    std::size_t bytes = 0;
+#if defined(__linux__)
+    // Gather list of a send the kernel completes asynchronously, which must
+    // stay put until it does
+    static constexpr std::size_t MaxIovecs = 16;
+    std::array<iovec, MaxIovecs> iovecs{};
+    msghdr message{};
+#endif
+};
+
+/**
+ * @brief One event loop of a TcpServer
+ *
+ * How the loop learns about sockets is up to the backend (EpollReactor,
+ * UringReactor). The base owns what they share: the thread, a buffer pool,
+ * the connection slots, the callbacks around a connection's life and the
+ * counters. Everything but the counters, start() and stop() is touched only
+ * by the loop's thread, so nothing here takes a lock.
+ *
+ * Connections live in slots. Backends tag kernel requests with the slot and
+ * its generation, so events still queued for a connection closed earlier
+ * in the same batch are recognised and dropped.
+ */
+class Reactor {
+public:
+    /**
+     * @param server Server whose callbacks and options to use
+     * @param index Position among the server's loops
+     * @param loops Number of loops, the stride of connection ids
+     */
+    Reactor(TcpServer& server, std::size_t index, std::size_t loops);
+    virtual ~Reactor() = default;
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    /// Start the loop's thread
+    void start();
+
+    /// Wake the loop, wait for it to close its connections and exit
+    void stop() noexcept;
+
+    /// Send on a connection of this loop; false if the connection is closing or failed
+    virtual bool send(Connection& connection, std::span<const std::string_view> pieces) = 0;
+
+    /// Add this loop's counters to stats
+    void add_stats(ServerStats& stats) const noexcept;
+
+protected:
+    struct alignas(64) Counters {
+        std::atomic<std::uint64_t> accepted{0};
+        std::atomic<std::uint64_t> active{0};
+        std::atomic<std::uint64_t> bytes_received{0};
+        std::atomic<std::uint64_t> bytes_sent{0};
+    };
+
+    /// Counters have a single writer, so a plain store avoids a locked add
+    static void count(std::atomic<std::uint64_t>& counter, std::uint64_t n) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    /// The loop; returns once woken, after destroy_all()
+    virtual void run() noexcept = 0;
+
+    /// Make run() return; called from another thread
+    virtual void wake() noexcept = 0;
+
+    /// Close the socket of a connection being destroyed
+    virtual void close_socket(Connection& connection) noexcept = 0;
+
+    /**
+     * @brief Give an accepted socket a slot and a Connection
+     * @return The connection, or nullptr with fd closed if out of memory
+     */
+    Connection* adopt(int fd) noexcept;
+
+    /// Undo adopt() for a socket the backend could not register, closing it
+    void abandon(Connection& connection) noexcept;
+
+    /// Count an adopted connection as open and run the connect callback
+    void opened(Connection& connection);
+
+    // Tags need only the low 24 bits of a generation: a slot would have to be
+    // reused 16 million times within one batch for two to be confused
+    static constexpr std::uint32_t GenerationMask = 0x00FF'FFFF;
+
+    // Connection::io_flags_ bit that backends set while the kernel reads from the
+    // output queue; fail() then leaves the queue for close_socket() to dispose of
+    static constexpr std::uint8_t OutputInFlight = 1;
+
+    /// Connection of a request tag, or nullptr if it has closed since
+    [[nodiscard]] Connection* find(std::uint32_t slot, std::uint32_t generation) const noexcept {
+        if (slot >= slots_.size() ||
+            ((slots_[slot].generation ^ generation) & GenerationMask) != 0) {
+            return nullptr;
+        }
+        return slots_[slot].connection;
+    }
+
+    /// Generation of a connection's slot, for tagging requests
+    [[nodiscard]] std::uint32_t generation(const Connection& connection) const noexcept;
+
+    /// Pass fresh bytes to the handler and buffer what it leaves; no copy while nothing is buffered
+    void receive(Connection& connection, std::string_view bytes);
+
+    /// Pass the buffered input to the handler
+    void deliver(Connection& connection);
+
+    /// Make room for n more input bytes; fails the connection past max_input
+    bool reserve_input(Connection& connection, std::size_t n);
+
+    /// Give back an input buffer that holds nothing, so idle connections hold none
+    void trim_input(Connection& connection) noexcept;
+
+    /// Copy pieces, less the first skip bytes, to the connection's output queue
+    void queue(Connection& connection, std::span<const std::string_view> pieces, std::size_t skip);
+
+    /// Drop sent bytes from the front of an output queue
+    void consume_output(OutputQueue& output, std::size_t n) noexcept;
+
+    /// Return an output queue and its buffers to the pools
+    void recycle(std::unique_ptr<OutputQueue> output) noexcept;
+
+    /// Destroy the connection if it failed, or asked to close and has nothing left to send
+    void finish(Connection& connection);
+
+    /// Mark the connection failed and drop its output, unless the kernel is reading it
+    void fail(Connection& connection) noexcept;
+
+    /// Run the close callback, close the socket and free the slot
+    void destroy(Connection& connection) noexcept;
+
+    /// destroy() every open connection
+    void destroy_all() noexcept;
+
+    TcpServer& server_;
+    std::size_t index_;
+    std::size_t loops_;
+    BufferPool pool_;
+    Counters counters_;
+
+private:
+    struct Slot {
+        Connection* connection = nullptr;
+        std::uint32_t generation = 0;
+    };
+
+    std::thread thread_;
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> free_slots_;
+    std::vector<std::unique_ptr<OutputQueue>> spare_queues_;
+    std::uint64_t next_id_ = 0;
+};
+
+/**
+ * @brief Reactor on edge-triggered epoll
+ *
+ * Sockets are registered once for input and output, so sending never costs
+ * an epoll_ctl() call. send() writes straight from the caller's memory and
+ * queues only what the socket refuses, which is flushed on EPOLLOUT.
+ */
+class EpollReactor final : public Reactor {
+public:
+    /**
+     * @param server Server whose callbacks and options to use
+     * @param index Position among the server's loops
+     * @param loops Number of loops, the stride of connection ids
+     * @param listener Listening socket
+     * @param owns_listener Whether the listener is this loop's own, to close on destruction;
+     *        a shared one is registered with EPOLLEXCLUSIVE so one loop wakes per connection
+     * @throws core::Exception If epoll or the eventfd cannot be set up; an owned listener
+     *         is closed
+     */
+    EpollReactor(TcpServer& server,
+                 std::size_t index,
+                 std::size_t loops,
+                 int listener,
+                 bool owns_listener);
+    ~EpollReactor() override;
+
+    bool send(Connection& connection, std::span<const std::string_view> pieces) override;
+
+private:
+    void run() noexcept override;
+    void wake() noexcept override;
+    void close_socket(Connection& connection) noexcept override;
+
+    void close_descriptors() noexcept;
+    void accept_connections();
+    void on_event(std::uint64_t tag, std::uint32_t events);
+    void read(Connection& connection, std::uint32_t events);
+    void flush(Connection& connection);
+
+    int listener_;
+    bool owns_listener_;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    int spare_fd_ = -1;
+};
+
+/// Whether the io_uring backend is built and the running kernel has what it needs
+bool uring_supported() noexcept;
+
+/**
+ * @brief Create an io_uring reactor; call only if uring_supported()
+ * @param server Server whose callbacks and options to use
+ * @param index Position among the server's loops
+ * @param loops Number of loops, the stride of connection ids
+ * @param listener Listening socket
+ * @param owns_listener Whether to close the listener on destruction
+ * @throws core::Exception If the ring cannot be set up; an owned listener is closed
+ */
+std::unique_ptr<Reactor> make_uring_reactor(TcpServer& server, std::size_t index, std::size_t loops,
+                                            int listener, bool owns_listener);
+
+} // namespace cpptemplate::network::detail
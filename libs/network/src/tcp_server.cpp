@@ -1 +1,302 @@
-// Stub implementation
+#include "cpptemplate/network/tcp_server.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#if defined(__linux__)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/resource.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+#include "cpptemplate/core/exception.hpp"
+#include "reactor.hpp"
+
+namespace cpptemplate::network {
+
+#if defined(__linux__)
+
+namespace {
+
+/// Parse an address literal; false if host is neither IPv4 nor IPv6
+bool parse_address(const std::string& host, std::uint16_t port, sockaddr_storage& address,
+                   socklen_t& length) noexcept {
+    address = {};
+    auto* v4 = reinterpret_cast<sockaddr_in*>(&address);
+    if (::inet_pton(AF_INET, host.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        length = sizeof(sockaddr_in);
+        return true;
+    }
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(&address);
+    if (::inet_pton(AF_INET6, host.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(port);
+        length = sizeof(sockaddr_in6);
+        return true;
+    }
+    return false;
+}
+
+/// Bound or peer address as "address:port"
+std::string format_address(const sockaddr_storage& address) {
+    std::array<char, INET6_ADDRSTRLEN> text{};
+    std::uint16_t port = 0;
+    std::string result;
+    if (address.ss_family == AF_INET6) {
+        const auto* v6 = reinterpret_cast<const sockaddr_in6*>(&address);
+        ::inet_ntop(AF_INET6, &v6->sin6_addr, text.data(), text.size());
+        port = ntohs(v6->sin6_port);
+        result.append("[").append(text.data()).append("]");
+    } else {
+        const auto* v4 = reinterpret_cast<const sockaddr_in*>(&address);
+        ::inet_ntop(AF_INET, &v4->sin_addr, text.data(), text.size());
+        port = ntohs(v4->sin_port);
+        result.append(text.data());
+    }
+    result.append(":").append(std::to_string(port));
+    return result;
+}
+
+/// Non-blocking listening socket on host:port
+int open_listener(const ServerOptions& options, std::uint16_t port) {
+    sockaddr_storage address{};
+    socklen_t length = 0;
+    parse_address(options.host, port, address, length);
+
+    const int fd = ::socket(address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw core::Exception("socket failed: " + std::generic_category().message(errno));
+    }
+    const int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    if (options.reuse_port && ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof one) < 0) {
+        const auto message = std::generic_category().message(errno);
+        ::close(fd);
+        throw core::Exception("SO_REUSEPORT failed: " + message);
+    }
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), length) < 0 ||
+        ::listen(fd, options.backlog) < 0) {
+        const auto message = std::generic_category().message(errno);
+        ::close(fd);
+        throw core::Exception("Failed to listen on '" + format_address(address) + "': " + message);
+    }
+    return fd;
+}
+
+} // namespace
+
+Connection::Connection(detail::Reactor& reactor,
+                       int fd,
+                       std::uint32_t slot,
+                       std::uint64_t id) noexcept
+    : reactor_(&reactor), id_(id), fd_(fd), slot_(slot) {}
+
+Connection::~Connection() = default;
+
+std::string Connection::peer() const {
+    sockaddr_storage address{};
+    socklen_t length = sizeof address;
+    if (::getpeername(fd_, reinterpret_cast<sockaddr*>(&address), &length) < 0) {
+        return {};
+    }
+    return format_address(address);
+}
+
+bool Connection::send(std::string_view bytes) {
+    return reactor_->send(*this, std::span(&bytes, 1));
+}
+
+bool Connection::send(std::span<const std::string_view> pieces) {
+    return reactor_->send(*this, pieces);
+}
+
+std::size_t Connection::pending_output() const noexcept {
+    return output_ ? output_->bytes : 0;
+}
+
+void Connection::close() noexcept {
+    closing_ = true;
+}
+
+TcpServer::TcpServer(ServerOptions options) : options_(std::move(options)) {
+    sockaddr_storage address{};
+    socklen_t length = 0;
+    if (!parse_address(options_.host, options_.port, address, length)) {
+        throw std::invalid_argument("Host must be an IPv4 or IPv6 address: '" + options_.host +
+                                    "'");
+    }
+    constexpr std::size_t MaxBuffer = std::numeric_limits<std::uint32_t>::max();
+    if (options_.buffer_size == 0 || options_.max_input > MaxBuffer ||
+        options_.max_input < options_.buffer_size) {
+        throw std::invalid_argument(
+            "Buffer sizes must satisfy 0 < buffer_size <= max_input < 4 GiB");
+    }
+    if (!std::has_single_bit(options_.ring_buffers) || options_.ring_buffers > 32768) {
+        throw std::invalid_argument("ring_buffers must be a power of two up to 32768");
+    }
+}
+
+TcpServer::~TcpServer() {
+    stop();
+}
+
+void TcpServer::start() {
+    if (running()) {
+        throw core::Exception("TcpServer is already running");
+    }
+    const std::size_t loops = options_.threads != 0
+                                  ? options_.threads
+                                  : std::max(1u, std::thread::hardware_concurrency());
+    Backend backend = options_.backend;
+    if (backend == Backend::Auto) {
+        backend = detail::uring_supported() ? Backend::IoUring : Backend::Epoll;
+    } else if (backend == Backend::IoUring && !detail::uring_supported()) {
+        throw core::Exception("The io_uring backend is not available");
+    }
+
+    std::vector<std::unique_ptr<detail::Reactor>> reactors;
+    try {
+        int listener = open_listener(options_, options_.port);
+        sockaddr_storage bound{};
+        socklen_t length = sizeof bound;
+        ::getsockname(listener, reinterpret_cast<sockaddr*>(&bound), &length);
+        port_ = ntohs(bound.ss_family == AF_INET6
+                          ? reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port
+                          : reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+        if (!options_.reuse_port) {
+            shared_listener_ = listener;
+        }
+
+        reactors.reserve(loops);
+        for (std::size_t i = 0; i < loops; ++i) {
+            if (options_.reuse_port && i > 0) {
+                // Bound to the port the first listener got, so port 0 works too
+                listener = open_listener(options_, port_);
+            }
+            if (backend == Backend::IoUring) {
+                reactors.push_back(
+                    detail::make_uring_reactor(*this, i, loops, listener, options_.reuse_port));
+            } else {
+                reactors.push_back(std::make_unique<detail::EpollReactor>(
+                    *this, i, loops, listener, options_.reuse_port));
+            }
+        }
+        for (auto& reactor : reactors) {
+            reactor->start();
+        }
+    } catch (...) {
+        reactors.clear();
+        if (shared_listener_ >= 0) {
+            ::close(shared_listener_);
+            shared_listener_ = -1;
+        }
+        port_ = 0;
+        throw;
+    }
+    reactors_ = std::move(reactors);
+    backend_ = backend;
+}
+
+void TcpServer::stop() {
+    for (auto& reactor : reactors_) {
+        reactor->stop();
+    }
+    reactors_.clear();
+    if (shared_listener_ >= 0) {
+        ::close(shared_listener_);
+        shared_listener_ = -1;
+    }
+    port_ = 0;
+}
+
+ServerStats TcpServer::stats() const noexcept {
+    ServerStats stats;
+    for (const auto& reactor : reactors_) {
+        reactor->add_stats(stats);
+    }
+    return stats;
+}
+
+bool io_uring_available() noexcept {
+    return detail::uring_supported();
+}
+
+std::size_t raise_open_file_limit() noexcept {
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) < 0) {
+        return 0;
+    }
+    if (limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        ::getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return static_cast<std::size_t>(limit.rlim_cur);
+}
+
+#else
+
+Connection::Connection(detail::Reactor& reactor,
+                       int fd,
+                       std::uint32_t slot,
+                       std::uint64_t id) noexcept
+    : reactor_(&reactor), id_(id), fd_(fd), slot_(slot) {}
+
+Connection::~Connection() = default;
+
+std::string Connection::peer() const {
+    return {};
+}
+
+bool Connection::send(std::string_view) {
+    return false;
+}
+
+bool Connection::send(std::span<const std::string_view>) {
+    return false;
+}
+
+std::size_t Connection::pending_output() const noexcept {
+    return 0;
+}
+
+void Connection::close() noexcept {
+    closing_ = true;
+}
+
+TcpServer::TcpServer(ServerOptions options) : options_(std::move(options)) {}
+
+TcpServer::~TcpServer() = default;
+
+void TcpServer::start() {
+    throw core::Exception("TcpServer is only supported on Linux");
+}
+
+void TcpServer::stop() {}
+
+ServerStats TcpServer::stats() const noexcept {
+    return {};
+}
+
+bool io_uring_available() noexcept {
+    return false;
+}
+
+std::size_t raise_open_file_limit() noexcept {
+    return 0;
+}
+
+#endif
+
+} // namespace cpptemplate::network
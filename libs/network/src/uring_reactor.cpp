@@ -0,0 +1,828 @@
+#include "reactor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "cpptemplate/core/exception.hpp"
+
+namespace cpptemplate::network::detail {
+
+namespace {
+
+// There is no liburing dependency; these are the three system calls it wraps
+
+int uring_setup(unsigned entries, io_uring_params& params) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+}
+
+int uring_enter(int ring, unsigned submit, unsigned wait, unsigned flags, const void* arg,
+                std::size_t arg_size) noexcept {
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_enter, ring, submit, wait, flags, arg, arg_size));
+}
+
+int uring_register(int ring, unsigned opcode, const void* arg, unsigned count) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ring, opcode, arg, count));
+}
+
+/// Anonymous mapping, page aligned as buffer rings must be; nullptr on failure
+char* map_memory(std::size_t size) noexcept {
+    void* memory =
+        ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? nullptr : static_cast<char*>(memory);
+}
+
+/**
+ * @brief Submission and completion queues of one io_uring instance
+ *
+ * Submission entry i always sits at position i of the index array, so
+ * queueing an entry is a store to it and a tail bump; the tail is
+ * published by submit().
+ */
+class Ring {
+public:
+    Ring() = default;
+
+    ~Ring() {
+        close();
+    }
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    /**
+     * @brief Create and map the ring
+     * @param entries Submission queue size
+     * @param completions Completion queue size, at least entries
+     * @throws core::Exception If the ring cannot be created or mapped
+     */
+    void open(unsigned entries, unsigned completions) {
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+        params.cq_entries = completions;
+        fd_ = uring_setup(entries, params);
+        if (fd_ < 0 && errno == EINVAL) {
+            // Kernels before 5.19 lack the last two flags, which are only optimisations
+            params = {};
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = completions;
+            fd_ = uring_setup(entries, params);
+        }
+        if (fd_ < 0) {
+            throw core::Exception("io_uring_setup failed: " +
+                                  std::generic_category().message(errno));
+        }
+        ext_arg_ = (params.features & IORING_FEAT_EXT_ARG) != 0;
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_map) {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+        sq_map_ = map_ring(sq_size_, IORING_OFF_SQ_RING);
+        cq_map_ = single_map ? nullptr : map_ring(cq_size_, IORING_OFF_CQ_RING);
+        entries_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        entries_ = reinterpret_cast<io_uring_sqe*>(map_ring(entries_size_, IORING_OFF_SQES));
+
+        char* sq = sq_map_;
+        char* cq = single_map ? sq_map_ : cq_map_;
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        completions_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        auto* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < sq_entries_; ++i) {
+            array[i] = i;
+        }
+        tail_ = *sq_tail_;
+    }
+
+    /// Unmap and close the ring, which cancels whatever is still in flight
+    void close() noexcept {
+        if (entries_ != nullptr) {
+            ::munmap(entries_, entries_size_);
+        }
+        if (cq_map_ != nullptr) {
+            ::munmap(cq_map_, cq_size_);
+        }
+        if (sq_map_ != nullptr) {
+            ::munmap(sq_map_, sq_size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        entries_ = nullptr;
+        cq_map_ = sq_map_ = nullptr;
+        fd_ = -1;
+    }
+
+    [[nodiscard]] int fd() const noexcept {
+        return fd_;
+    }
+
+    /// Next free submission entry, cleared; submits the queue first if it is full
+    io_uring_sqe& next_entry() noexcept {
+        while (tail_ - std::atomic_ref(*sq_head_).load(std::memory_order_acquire) >= sq_entries_) {
+            submit(0);
+        }
+        io_uring_sqe& entry = entries_[tail_ & sq_mask_];
+        std::memset(&entry, 0, sizeof entry);
+        ++tail_;
+        ++unsubmitted_;
+        return entry;
+    }
+
+    /**
+     * @brief Submit the queued entries and wait for wait completions
+     * @param timeout Upper bound on the wait, if the kernel supports one
+     *
+     * Errors are not reported: EINTR, ETIME and EBUSY (completions to reap
+     * first) all mean the caller should reap and come round again.
+     */
+    void submit(unsigned wait, const __kernel_timespec* timeout = nullptr) noexcept {
+        std::atomic_ref(*sq_tail_).store(tail_, std::memory_order_release);
+        unsigned flags = wait > 0 ? IORING_ENTER_GETEVENTS : 0;
+        io_uring_getevents_arg arg{};
+        const void* arg_pointer = nullptr;
+        std::size_t arg_size = 0;
+        if (timeout != nullptr && ext_arg_) {
+            arg.sigmask_sz = _NSIG / 8;
+            arg.ts = reinterpret_cast<std::uint64_t>(timeout);
+            flags |= IORING_ENTER_EXT_ARG;
+            arg_pointer = &arg;
+            arg_size = sizeof arg;
+        }
+        const int submitted = uring_enter(fd_, unsubmitted_, wait, flags, arg_pointer, arg_size);
+        if (submitted > 0) {
+            unsubmitted_ -= std::min(unsubmitted_, static_cast<unsigned>(submitted));
+        }
+    }
+
+    /// Oldest unhandled completion, or nullptr
+    [[nodiscard]] const io_uring_cqe* peek() const noexcept {
+        const unsigned head = *cq_head_;
+        if (head == std::atomic_ref(*cq_tail_).load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &completions_[head & cq_mask_];
+    }
+
+    /// Hand the completion from peek() back to the kernel
+    void pop() noexcept {
+        std::atomic_ref(*cq_head_).store(*cq_head_ + 1, std::memory_order_release);
+    }
+
+private:
+    char* map_ring(std::size_t size, off_t offset) {
+        void* memory =
+            ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        if (memory == MAP_FAILED) {
+            const auto message = std::generic_category().message(errno);
+            close();
+            throw core::Exception("Failed to map io_uring: " + message);
+        }
+        return static_cast<char*>(memory);
+    }
+
+    int fd_ = -1;
+    bool ext_arg_ = false;
+    char* sq_map_ = nullptr;
+    std::size_t sq_size_ = 0;
+    char* cq_map_ = nullptr;
+    std::size_t cq_size_ = 0;
+    io_uring_sqe* entries_ = nullptr;
+    std::size_t entries_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* completions_ = nullptr;
+    unsigned tail_ = 0;
+    unsigned unsubmitted_ = 0;
+};
+
+/**
+ * @brief Whether a receive can take a buffer from a registered buffer ring
+ *
+ * Registering one is not proof: some kernels accept the ring yet never see
+ * the buffers added to it and fail every receive with ENOBUFS, so this
+ * receives a byte through one.
+ */
+bool buffer_ring_works() noexcept {
+    static const bool works = [] {
+        constexpr std::size_t Page = 4096;
+        char* memory = map_memory(2 * Page); // The ring, then its one buffer
+        int sockets[2] = {-1, -1};
+        bool ok = false;
+        try {
+            Ring ring;
+            ring.open(4, 8);
+            io_uring_buf_reg registration{};
+            registration.ring_addr = reinterpret_cast<std::uint64_t>(memory);
+            registration.ring_entries = 1;
+            if (memory != nullptr &&
+                uring_register(ring.fd(), IORING_REGISTER_PBUF_RING, &registration, 1) == 0 &&
+                ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) == 0 &&
+                ::write(sockets[1], "x", 1) == 1) {
+                auto* buffers = reinterpret_cast<io_uring_buf_ring*>(memory);
+                buffers->bufs[0].addr = reinterpret_cast<std::uint64_t>(memory + Page);
+                buffers->bufs[0].len = Page;
+                std::atomic_ref(buffers->tail).store(1, std::memory_order_release);
+
+                io_uring_sqe& entry = ring.next_entry();
+                entry.opcode = IORING_OP_RECV;
+                entry.fd = sockets[0];
+                entry.flags = IOSQE_BUFFER_SELECT;
+                entry.len = 1;
+                ring.submit(1);
+                const io_uring_cqe* completion = ring.peek();
+                ok = completion != nullptr && completion->res == 1;
+            }
+        } catch (...) {
+            ok = false;
+        }
+        // The ring is closed by now, so the memory is no longer registered
+        for (const int fd : sockets) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        if (memory != nullptr) {
+            ::munmap(memory, 2 * Page);
+        }
+        return ok;
+    }();
+    return works;
+}
+
+// Kind of request, in the top byte of its user_data; connection requests carry
+// the slot in the low 32 bits and the generation in the 24 bits between
+enum Op : std::uint8_t {
+    AcceptOp = 1,
+    WakeOp,
+    ReceiveOp,
+    SendOp,
+    ProvideOp,
+    CancelOp
+};
+
+constexpr std::uint64_t tag(Op op, std::uint32_t slot = 0, std::uint32_t generation = 0) noexcept {
+    return static_cast<std::uint64_t>(op) << 56 |
+           static_cast<std::uint64_t>(generation & 0x00FF'FFFF) << 32 | slot;
+}
+
+// Submission queue entries; a full queue is submitted early, so this only
+// bounds the batch size
+constexpr unsigned QueueEntries = 1024;
+
+// Completions can outnumber submissions several times over with multishot
+// requests; the kernel keeps overflow, but that path is slow
+constexpr unsigned CompletionEntries = 4 * QueueEntries;
+
+// Group id of the receive buffers
+constexpr std::uint16_t BufferGroup = 0;
+
+// Connection::io_flags_ bits besides OutputInFlight
+constexpr std::uint8_t ReceiveArmed = 2;
+constexpr std::uint8_t Ready = 4;
+
+} // namespace
+
+/**
+ * @brief Reactor on io_uring
+ *
+ * One ring per loop, driven without liburing. Each connection has one
+ * multishot receive in flight, which picks buffers the loop registered
+ * with the kernel; the handler sees the bytes in place and only what it
+ * leaves is copied. Buffers go back to the kernel through a mapped buffer
+ * ring (IORING_REGISTER_PBUF_RING) where that works, else by
+ * IORING_OP_PROVIDE_BUFFERS requests.
+ *
+ * send() copies into the connection's output queue and marks it ready.
+ * After each batch of completions the ready queues go out as one sendmsg
+ * request each. Those requests are submitted by the same io_uring_enter()
+ * call that waits for the next batch, so a busy loop makes one system
+ * call per batch.
+ *
+ * Requests hold the socket and, for sends, the output queue, so a closed
+ * connection shuts its socket down to end them and hands a queue still in
+ * flight to orphans_ until its completion arrives.
+ */
+class UringReactor final : public Reactor {
+public:
+    UringReactor(TcpServer& server,
+                 std::size_t index,
+                 std::size_t loops,
+                 int listener,
+                 bool owns_listener);
+    ~UringReactor() override;
+
+    bool send(Connection& connection, std::span<const std::string_view> pieces) override;
+
+private:
+    void run() noexcept override;
+    void wake() noexcept override;
+    void close_socket(Connection& connection) noexcept override;
+
+    void setup_buffers();
+    void close_descriptors() noexcept;
+
+    /// Next submission entry, counted as in flight until its last completion
+    io_uring_sqe& next_entry() noexcept {
+        ++in_flight_;
+        return ring_.next_entry();
+    }
+
+    /// Handle every completion in the ring
+    void reap();
+
+    void arm_accept() noexcept;
+    void arm_wake() noexcept;
+    void arm_receive(Connection& connection) noexcept;
+    void start_send(Connection& connection) noexcept;
+    void mark_ready(Connection& connection);
+    /// Re-arm receives and start sends for the connections marked ready
+    void process_ready() noexcept;
+
+    void on_accept(int result, std::uint32_t flags);
+    void on_receive(std::uint64_t user_data, int result, std::uint32_t flags);
+    void on_send(std::uint64_t user_data, int result);
+
+    /// Give a receive buffer back to the kernel
+    void recycle_buffer(std::uint16_t id) noexcept;
+    /// Queue requests providing the buffers recycled without a buffer ring
+    void provide_buffers() noexcept;
+
+    /// Tag for a request of a connection
+    [[nodiscard]] std::uint64_t tag_of(Op op, const Connection& connection) const noexcept {
+        return tag(op, connection.slot_, generation(connection));
+    }
+
+    Ring ring_;
+    int listener_;
+    bool owns_listener_;
+    int wake_fd_ = -1;
+    int spare_fd_ = -1;
+
+    // Receive buffers, buffer_count_ of pool_.buffer_size() bytes each
+    char* buffers_ = nullptr;
+    std::size_t buffers_size_ = 0;
+    unsigned buffer_count_ = 0;
+    // Either the mapped ring they return through, or recycled_ awaiting provide_buffers()
+    io_uring_buf_ring* buffer_ring_ = nullptr;
+    std::size_t buffer_ring_size_ = 0;
+    std::uint16_t buffer_tail_ = 0;
+    std::vector<std::uint16_t> recycled_;
+
+    std::vector<std::uint64_t> ready_;
+    std::vector<std::pair<std::uint64_t, std::unique_ptr<OutputQueue>>> orphans_;
+    std::size_t in_flight_ = 0;
+    bool accept_armed_ = false;
+    bool multishot_accept_ = true;
+    bool multishot_receive_ = true;
+    bool stopping_ = false;
+};
+
+UringReactor::UringReactor(TcpServer& server, std::size_t index, std::size_t loops, int listener,
+                           bool owns_listener)
+    : Reactor(server, index, loops), listener_(listener), owns_listener_(owns_listener) {
+    try {
+        ring_.open(QueueEntries, CompletionEntries);
+        setup_buffers();
+        wake_fd_ = ::eventfd(0, EFD_CLOEXEC);
+        if (wake_fd_ < 0) {
+            throw core::Exception("eventfd failed: " + std::generic_category().message(errno));
+        }
+        ready_.reserve(1024);
+    } catch (...) {
+        close_descriptors();
+        throw;
+    }
+    spare_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    arm_wake();
+    arm_accept();
+}
+
+UringReactor::~UringReactor() {
+    stop();
+    close_descriptors();
+}
+
+void UringReactor::setup_buffers() {
+    buffer_count_ = static_cast<unsigned>(server_.options().ring_buffers);
+    buffers_size_ = buffer_count_ * pool_.buffer_size();
+    buffers_ = map_memory(buffers_size_);
+    if (buffers_ == nullptr) {
+        throw core::Exception("Failed to allocate receive buffers: " +
+                              std::generic_category().message(errno));
+    }
+
+    if (buffer_ring_works()) {
+        buffer_ring_size_ = buffer_count_ * sizeof(io_uring_buf);
+        buffer_ring_ = reinterpret_cast<io_uring_buf_ring*>(map_memory(buffer_ring_size_));
+        io_uring_buf_reg registration{};
+        registration.ring_addr = reinterpret_cast<std::uint64_t>(buffer_ring_);
+        registration.ring_entries = buffer_count_;
+        registration.bgid = BufferGroup;
+        if (buffer_ring_ == nullptr ||
+            uring_register(ring_.fd(), IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+            throw core::Exception("Failed to register receive buffers: " +
+                                  std::generic_category().message(errno));
+        }
+    } else {
+        recycled_.reserve(buffer_count_);
+    }
+    for (unsigned id = 0; id < buffer_count_; ++id) {
+        recycle_buffer(static_cast<std::uint16_t>(id));
+    }
+    provide_buffers();
+}
+
+void UringReactor::close_descriptors() noexcept {
+    ring_.close(); // First, so the kernel lets go of the buffers
+    if (buffer_ring_ != nullptr) {
+        ::munmap(buffer_ring_, buffer_ring_size_);
+        buffer_ring_ = nullptr;
+    }
+    if (buffers_ != nullptr) {
+        ::munmap(buffers_, buffers_size_);
+        buffers_ = nullptr;
+    }
+    for (auto& [tag, output] : orphans_) {
+        recycle(std::move(output));
+    }
+    orphans_.clear();
+    for (const int fd : {wake_fd_, spare_fd_}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (owns_listener_) {
+        ::close(listener_);
+    }
+    wake_fd_ = spare_fd_ = -1;
+    owns_listener_ = false;
+}
+
+void UringReactor::wake() noexcept {
+    const std::uint64_t one = 1;
+    if (::write(wake_fd_, &one, sizeof one) < 0) {
+        // Only fails if the counter is saturated, which also wakes the loop
+    }
+}
+
+void UringReactor::close_socket(Connection& connection) noexcept {
+    if ((connection.io_flags_ & OutputInFlight) != 0) {
+        try {
+            orphans_.emplace_back(tag_of(SendOp, connection), std::move(connection.output_));
+        } catch (...) {
+            // The kernel may still read it, so leak it rather than free it
+            static_cast<void>(connection.output_.release());
+        }
+    }
+    // Shutting down ends the receive and send in flight; closing alone would not
+    ::shutdown(connection.fd_, SHUT_RDWR);
+    ::close(connection.fd_);
+}
+
+void UringReactor::run() noexcept {
+    while (!stopping_) {
+        provide_buffers();
+        process_ready();
+        if (!accept_armed_) {
+            arm_accept();
+        }
+        ring_.submit(1);
+        reap();
+    }
+
+    destroy_all();
+    if (accept_armed_) {
+        io_uring_sqe& entry = next_entry();
+        entry.opcode = IORING_OP_ASYNC_CANCEL;
+        entry.addr = tag(AcceptOp);
+        entry.user_data = tag(CancelOp);
+    }
+    // Wait for the kernel to let go of the output queues still in flight
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    const __kernel_timespec timeout{0, 10'000'000};
+    while (in_flight_ > 0 && std::chrono::steady_clock::now() < deadline) {
+        ring_.submit(1, &timeout);
+        reap();
+    }
+}
+
+void UringReactor::reap() {
+    while (const io_uring_cqe* completion = ring_.peek()) {
+        // Copied out, so the entry goes back to the kernel before the handlers run
+        const std::uint64_t user_data = completion->user_data;
+        const int result = completion->res;
+        const std::uint32_t flags = completion->flags;
+        ring_.pop();
+        if ((flags & IORING_CQE_F_MORE) == 0) {
+            --in_flight_;
+        }
+        switch (static_cast<Op>(user_data >> 56)) {
+        case AcceptOp:
+            on_accept(result, flags);
+            break;
+        case WakeOp:
+            stopping_ = true;
+            break;
+        case ReceiveOp:
+            on_receive(user_data, result, flags);
+            break;
+        case SendOp:
+            on_send(user_data, result);
+            break;
+        case ProvideOp:
+        case CancelOp:
+            break;
+        }
+    }
+}
+
+void UringReactor::arm_accept() noexcept {
+    io_uring_sqe& entry = next_entry();
+    entry.opcode = IORING_OP_ACCEPT;
+    entry.fd = listener_;
+    entry.accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    entry.ioprio = multishot_accept_ ? IORING_ACCEPT_MULTISHOT : 0;
+    entry.user_data = tag(AcceptOp);
+    accept_armed_ = true;
+}
+
+void UringReactor::arm_wake() noexcept {
+    io_uring_sqe& entry = next_entry();
+    entry.opcode = IORING_OP_POLL_ADD;
+    entry.fd = wake_fd_;
+    entry.poll32_events = POLLIN;
+    entry.user_data = tag(WakeOp);
+}
+
+void UringReactor::arm_receive(Connection& connection) noexcept {
+    io_uring_sqe& entry = next_entry();
+    entry.opcode = IORING_OP_RECV;
+    entry.fd = connection.fd_;
+    entry.flags = IOSQE_BUFFER_SELECT;
+    entry.buf_group = BufferGroup;
+    // A multishot receive takes its length from the buffers; a single one needs it
+    entry.len = multishot_receive_ ? 0 : static_cast<std::uint32_t>(pool_.buffer_size());
+    entry.ioprio = multishot_receive_ ? IORING_RECV_MULTISHOT : 0;
+    entry.user_data = tag_of(ReceiveOp, connection);
+    connection.io_flags_ |= ReceiveArmed;
+}
+
+void UringReactor::start_send(Connection& connection) noexcept {
+    OutputQueue& output = *connection.output_;
+    std::size_t count = 0;
+    for (auto it = output.buffers.begin();
+         it != output.buffers.end() && count < OutputQueue::MaxIovecs;
+         ++it) {
+        const std::string_view bytes = it->readable();
+        output.iovecs[count++] = {const_cast<char*>(bytes.data()), bytes.size()};
+    }
+    output.message = {};
+    output.message.msg_iov = output.iovecs.data();
+    output.message.msg_iovlen = count;
+
+    io_uring_sqe& entry = next_entry();
+    entry.opcode = IORING_OP_SENDMSG;
+    entry.fd = connection.fd_;
+    entry.addr = reinterpret_cast<std::uint64_t>(&output.message);
+    entry.len = 1;
+    entry.msg_flags = MSG_NOSIGNAL;
+    entry.user_data = tag_of(SendOp, connection);
+    connection.io_flags_ |= OutputInFlight;
+}
+
+void UringReactor::mark_ready(Connection& connection) {
+    if ((connection.io_flags_ & Ready) == 0) {
+        ready_.push_back(tag_of(ReceiveOp, connection));
+        connection.io_flags_ |= Ready;
+    }
+}
+
+void UringReactor::process_ready() noexcept {
+    for (const std::uint64_t ready : ready_) {
+        Connection* connection =
+            find(static_cast<std::uint32_t>(ready), static_cast<std::uint32_t>(ready >> 32));
+        if (connection == nullptr) {
+            continue; // Closed since
+        }
+        connection->io_flags_ &= static_cast<std::uint8_t>(~Ready);
+        if ((connection->io_flags_ & ReceiveArmed) == 0 && !connection->closing_) {
+            arm_receive(*connection);
+        }
+        if ((connection->io_flags_ & OutputInFlight) == 0 && connection->output_) {
+            if (connection->output_->bytes > 0) {
+                start_send(*connection);
+            } else {
+                recycle(std::move(connection->output_));
+            }
+        }
+    }
+    ready_.clear();
+}
+
+bool UringReactor::send(Connection& connection, std::span<const std::string_view> pieces) {
+    if (connection.closing_) {
+        return false;
+    }
+    // The caller's memory is gone by the time the kernel sends, so copy
+    queue(connection, pieces, 0);
+    mark_ready(connection);
+    return true;
+}
+
+void UringReactor::on_accept(int result, std::uint32_t flags) {
+    if ((flags & IORING_CQE_F_MORE) == 0) {
+        accept_armed_ = false; // Re-armed by the loop
+    }
+    if (result >= 0) {
+        if (stopping_) {
+            ::close(result);
+            return;
+        }
+        if (server_.options().no_delay) {
+            const int one = 1;
+            ::setsockopt(result, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        }
+        Connection* connection = adopt(result);
+        if (connection != nullptr) {
+            arm_receive(*connection);
+            opened(*connection);
+        }
+    } else if (result == -EINVAL && multishot_accept_) {
+        multishot_accept_ = false; // Kernel before 5.19
+    } else if ((result == -EMFILE || result == -ENFILE) && spare_fd_ >= 0) {
+        // As in EpollReactor: drop the client at once rather than retry forever
+        ::close(spare_fd_);
+        const int rejected = ::accept(listener_, nullptr, nullptr);
+        if (rejected >= 0) {
+            ::close(rejected);
+        }
+        spare_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+}
+
+void UringReactor::on_receive(std::uint64_t user_data, int result, std::uint32_t flags) {
+    const bool has_buffer = (flags & IORING_CQE_F_BUFFER) != 0;
+    const auto buffer = static_cast<std::uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+    Connection* connection =
+        find(static_cast<std::uint32_t>(user_data), static_cast<std::uint32_t>(user_data >> 32));
+    if (connection == nullptr) {
+        if (has_buffer) {
+            recycle_buffer(buffer); // Data for a connection closed since
+        }
+        return;
+    }
+    const bool more = (flags & IORING_CQE_F_MORE) != 0;
+    if (!more) {
+        connection->io_flags_ &= static_cast<std::uint8_t>(~ReceiveArmed);
+    }
+
+    if (result > 0 && has_buffer) {
+        const std::size_t offset = std::size_t{buffer} * pool_.buffer_size();
+        receive(*connection, {buffers_ + offset, static_cast<std::size_t>(result)});
+        recycle_buffer(buffer);
+        if (!more) {
+            mark_ready(*connection); // Single-shot, or the kernel ended it; receive again
+        }
+    } else if (result == 0) {
+        connection->closing_ = true; // Peer is done sending; flush, then close
+    } else if (result == -ENOBUFS || result == -EINTR) {
+        mark_ready(*connection); // Buffers are back by the end of the batch
+    } else if (result == -EINVAL && multishot_receive_) {
+        multishot_receive_ = false; // Kernel before 6.0
+        mark_ready(*connection);
+    } else {
+        fail(*connection);
+    }
+    finish(*connection);
+}
+
+void UringReactor::on_send(std::uint64_t user_data, int result) {
+    Connection* connection =
+        find(static_cast<std::uint32_t>(user_data), static_cast<std::uint32_t>(user_data >> 32));
+    if (connection == nullptr) {
+        const auto orphan = std::find_if(orphans_.begin(), orphans_.end(), [&](const auto& entry) {
+            return entry.first == user_data;
+        });
+        if (orphan != orphans_.end()) {
+            recycle(std::move(orphan->second));
+            *orphan = std::move(orphans_.back());
+            orphans_.pop_back();
+        }
+        return;
+    }
+
+    connection->io_flags_ &= static_cast<std::uint8_t>(~OutputInFlight);
+    if (connection->failed_ || result < 0) {
+        fail(*connection); // Also drops the queue fail() had to leave to the kernel
+    } else {
+        consume_output(*connection->output_, static_cast<std::size_t>(result));
+        mark_ready(*connection); // Sends the rest, or recycles the queue
+    }
+    finish(*connection);
+}
+
+void UringReactor::recycle_buffer(std::uint16_t id) noexcept {
+    if (buffer_ring_ == nullptr) {
+        recycled_.push_back(id); // Reserved for every buffer, so this never allocates
+        return;
+    }
+    io_uring_buf& entry = buffer_ring_->bufs[buffer_tail_ & (buffer_count_ - 1)];
+    entry.addr = reinterpret_cast<std::uint64_t>(buffers_ + std::size_t{id} * pool_.buffer_size());
+    entry.len = static_cast<std::uint32_t>(pool_.buffer_size());
+    entry.bid = id;
+    ++buffer_tail_;
+    std::atomic_ref(buffer_ring_->tail).store(buffer_tail_, std::memory_order_release);
+}
+
+void UringReactor::provide_buffers() noexcept {
+    // One request per run of consecutive ids; buffers tend to come back in order
+    std::size_t i = 0;
+    while (i < recycled_.size()) {
+        const std::uint16_t first = recycled_[i];
+        std::size_t run = 1;
+        while (i + run < recycled_.size() && recycled_[i + run] == first + run) {
+            ++run;
+        }
+        io_uring_sqe& entry = next_entry();
+        entry.opcode = IORING_OP_PROVIDE_BUFFERS;
+        entry.fd = static_cast<std::int32_t>(run);
+        entry.addr =
+            reinterpret_cast<std::uint64_t>(buffers_ + std::size_t{first} * pool_.buffer_size());
+        entry.len = static_cast<std::uint32_t>(pool_.buffer_size());
+        entry.off = first;
+        entry.buf_group = BufferGroup;
+        entry.user_data = tag(ProvideOp);
+        i += run;
+    }
+    recycled_.clear();
+}
+
+bool uring_supported() noexcept {
+    static const bool supported = [] {
+        try {
+            Ring ring;
+            ring.open(4, 8);
+            constexpr unsigned ProbeOps = 64;
+            constexpr std::size_t ProbeSize =
+                sizeof(io_uring_probe) + ProbeOps * sizeof(io_uring_probe_op);
+            alignas(io_uring_probe) char storage[ProbeSize]{};
+            auto* probe = reinterpret_cast<io_uring_probe*>(storage);
+            if (uring_register(ring.fd(), IORING_REGISTER_PROBE, probe, ProbeOps) != 0) {
+                return false; // Before 5.6
+            }
+            for (const unsigned op : {IORING_OP_ACCEPT,
+                                      IORING_OP_RECV,
+                                      IORING_OP_SENDMSG,
+                                      IORING_OP_POLL_ADD,
+                                      IORING_OP_ASYNC_CANCEL,
+                                      IORING_OP_PROVIDE_BUFFERS}) {
+                if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0) {
+                    return false;
+                }
+            }
+            return true;
+        } catch (...) {
+            return false; // Too old, disabled (kernel.io_uring_disabled) or filtered by seccomp
+        }
+    }();
+    return supported;
+}
+
+std::unique_ptr<Reactor> make_uring_reactor(TcpServer& server, std::size_t index, std::size_t loops,
+                                            int listener, bool owns_listener) {
+    return std::make_unique<UringReactor>(server, index, loops, listener, owns_listener);
+}
+
+} // namespace cpptemplate::network::detail
@@ -1 +1,1291 @@
-// Stub implementation
+#include "cpptemplate/network/websocket.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#if defined(__linux__)
+    #include <sys/random.h>
+#endif
+
+#if CPPTEMPLATE_NETWORK_HAS_ZLIB
+    #include <zlib.h>
+#endif
+
+#include "cpptemplate/core/exception.hpp"
+#include "http_common.hpp"
+#include "ws_kernels.hpp"
+
+namespace cpptemplate::network {
+
+namespace {
+
+using Status = WsParseResult::Status;
+using detail::iequals;
+using detail::lists_token;
+using detail::trim_spaces;
+
+/// Data frames larger than this leave the input as they arrive instead of when complete
+constexpr std::uint64_t StreamThreshold = 64 * 1024;
+
+/// Largest Close reason: a control payload holds 125 bytes, two of them the code
+constexpr std::size_t MaxCloseReason = 123;
+
+constexpr std::string_view Guid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+constexpr std::string_view DeflateResponse =
+    "permessage-deflate; server_no_context_takeover; client_no_context_takeover";
+
+constexpr bool is_control(WsOpcode opcode) noexcept {
+    return static_cast<std::uint8_t>(opcode) >= 0x8;
+}
+
+constexpr bool is_known(std::uint8_t opcode) noexcept {
+    return opcode <= 0x2 || (opcode >= 0x8 && opcode <= 0xA);
+}
+
+/// Close codes a peer may send (RFC 6455, 7.4)
+constexpr bool is_valid_close_code(std::uint16_t code) noexcept {
+    return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1014) ||
+           (code >= 3000 && code <= 4999);
+}
+
+// SHA-1 (RFC 3174), needed only for Sec-WebSocket-Accept
+
+class Sha1 {
+public:
+    void update(std::string_view data) noexcept {
+        length_ += data.size();
+        for (const char c : data) {
+            buffer_[buffered_++] = static_cast<std::uint8_t>(c);
+            if (buffered_ == buffer_.size()) {
+                block();
+                buffered_ = 0;
+            }
+        }
+    }
+
+    std::array<std::uint8_t, 20> finish() noexcept {
+        const std::uint64_t bits = length_ * 8;
+        buffer_[buffered_++] = 0x80;
+        if (buffered_ > 56) {
+            std::fill(buffer_.begin() + static_cast<std::ptrdiff_t>(buffered_), buffer_.end(), 0);
+            block();
+            buffered_ = 0;
+        }
+        std::fill(
+            buffer_.begin() + static_cast<std::ptrdiff_t>(buffered_), buffer_.begin() + 56, 0);
+        for (int i = 0; i < 8; ++i) {
+            buffer_[56 + static_cast<std::size_t>(i)] =
+                static_cast<std::uint8_t>(bits >> (56 - 8 * i));
+        }
+        block();
+
+        std::array<std::uint8_t, 20> digest{};
+        for (std::size_t i = 0; i < 20; ++i) {
+            digest[i] = static_cast<std::uint8_t>(state_[i / 4] >> (24 - 8 * (i % 4)));
+        }
+        return digest;
+    }
+
+private:
+    static constexpr std::uint32_t rotl(std::uint32_t x, int n) noexcept {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    void block() noexcept {
+        std::array<std::uint32_t, 80> w{};
+        for (std::size_t i = 0; i < 16; ++i) {
+            w[i] = static_cast<std::uint32_t>(buffer_[4 * i]) << 24 |
+                   static_cast<std::uint32_t>(buffer_[4 * i + 1]) << 16 |
+                   static_cast<std::uint32_t>(buffer_[4 * i + 2]) << 8 | buffer_[4 * i + 3];
+        }
+        for (std::size_t i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        std::uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3], e = state_[4];
+        for (std::size_t i = 0; i < 80; ++i) {
+            std::uint32_t f = 0;
+            std::uint32_t k = 0;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            const std::uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        state_[0] += a;
+        state_[1] += b;
+        state_[2] += c;
+        state_[3] += d;
+        state_[4] += e;
+    }
+
+    std::array<std::uint32_t, 5> state_{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::array<std::uint8_t, 64> buffer_{};
+    std::size_t buffered_ = 0;
+    std::uint64_t length_ = 0;
+};
+
+constexpr std::string_view Base64Chars =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/// Write the padded base64 of n bytes, 4 * ceil(n / 3) characters
+void base64_encode(const std::uint8_t* in, std::size_t n, char* out) noexcept {
+    for (std::size_t i = 0; i < n; i += 3) {
+        const std::uint32_t group = static_cast<std::uint32_t>(in[i]) << 16 |
+                                    (i + 1 < n ? static_cast<std::uint32_t>(in[i + 1]) << 8 : 0) |
+                                    (i + 2 < n ? in[i + 2] : 0);
+        *out++ = Base64Chars[group >> 18];
+        *out++ = Base64Chars[(group >> 12) & 0x3F];
+        *out++ = i + 1 < n ? Base64Chars[(group >> 6) & 0x3F] : '=';
+        *out++ = i + 2 < n ? Base64Chars[group & 0x3F] : '=';
+    }
+}
+
+using AcceptKey = std::array<char, 28>;
+
+AcceptKey accept_key(std::string_view key) noexcept {
+    Sha1 sha1;
+    sha1.update(key);
+    sha1.update(Guid);
+    const auto digest = sha1.finish();
+    AcceptKey accept{};
+    base64_encode(digest.data(), digest.size(), accept.data());
+    return accept;
+}
+
+/// Whether key is what a client must send: base64 of 16 bytes
+bool is_valid_client_key(std::string_view key) noexcept {
+    const auto is_base64 = [](char c) { return Base64Chars.find(c) != std::string_view::npos; };
+    return key.size() == 24 && key.ends_with("==") &&
+           std::all_of(key.begin(), key.end() - 2, is_base64);
+}
+
+/// Fill out from the kernel's CSPRNG; std::random_device where getrandom() is missing
+void fill_random(std::uint8_t* out, std::size_t size) {
+#if defined(__linux__)
+    while (size > 0) {
+        const ssize_t n = ::getrandom(out, size, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break; // ENOSYS on kernels before 3.17
+        }
+        out += n;
+        size -= static_cast<std::size_t>(n);
+    }
+#endif
+    if (size > 0) {
+        std::random_device device;
+        for (std::size_t i = 0; i < size; ++i) {
+            out[i] = static_cast<std::uint8_t>(device());
+        }
+    }
+}
+
+/**
+ * Unpredictable bytes for masking keys and handshake nonces (RFC 6455,
+ * 5.3 and 10.3). They come from the kernel in per-thread batches, so a
+ * mask costs a copy rather than a system call. No entropy source at all
+ * terminates, as predictable masks must not go out.
+ */
+void random_bytes(std::uint8_t* out, std::size_t size) noexcept {
+    struct Batch {
+        std::array<std::uint8_t, 256> bytes{};
+        std::size_t used = 256;
+    };
+    thread_local Batch batch;
+    while (size > 0) {
+        if (batch.used == batch.bytes.size()) {
+            fill_random(batch.bytes.data(), batch.bytes.size());
+            batch.used = 0;
+        }
+        const std::size_t take = std::min(size, batch.bytes.size() - batch.used);
+        std::memcpy(out, batch.bytes.data() + batch.used, take);
+        // Handed-out bytes are not kept around
+        std::memset(batch.bytes.data() + batch.used, 0, take);
+        batch.used += take;
+        out += take;
+        size -= take;
+    }
+}
+
+/// permessage-deflate parameters of one extension element (RFC 7692, 7)
+struct DeflateParams {
+    bool server_no_context_takeover = false;
+    bool client_no_context_takeover = false;
+    int server_max_window_bits = 15;
+    int client_max_window_bits = 15; ///< 0 when given without a value, as only an offer may
+};
+
+/**
+ * Parse "permessage-deflate; param; param=value"; nullopt if it names
+ * another extension or a parameter is unknown, repeated or out of range
+ */
+std::optional<DeflateParams> parse_deflate(std::string_view element) noexcept {
+    std::size_t semicolon = std::min(element.find(';'), element.size());
+    if (!iequals(trim_spaces(element.substr(0, semicolon)), "permessage-deflate")) {
+        return std::nullopt;
+    }
+    DeflateParams params;
+    unsigned seen = 0;
+    while (semicolon < element.size()) {
+        element.remove_prefix(semicolon + 1);
+        semicolon = std::min(element.find(';'), element.size());
+        const std::string_view param = element.substr(0, semicolon);
+        const std::size_t equals = std::min(param.find('='), param.size());
+        const std::string_view name = trim_spaces(param.substr(0, equals));
+        std::string_view value = trim_spaces(param.substr(std::min(equals + 1, param.size())));
+        const bool has_value = equals < param.size();
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+            value = value.substr(1, value.size() - 2);
+        }
+        const auto window_bits = [&]() -> int {
+            if (value.size() == 1 && value[0] >= '8' && value[0] <= '9') {
+                return value[0] - '0';
+            }
+            if (value.size() == 2 && value[0] == '1' && value[1] >= '0' && value[1] <= '5') {
+                return 10 + (value[1] - '0');
+            }
+            return -1;
+        };
+
+        unsigned bit = 0;
+        if (iequals(name, "server_no_context_takeover") && !has_value) {
+            bit = 1;
+            params.server_no_context_takeover = true;
+        } else if (iequals(name, "client_no_context_takeover") && !has_value) {
+            bit = 2;
+            params.client_no_context_takeover = true;
+        } else if (iequals(name, "server_max_window_bits") && has_value) {
+            bit = 4;
+            params.server_max_window_bits = window_bits();
+        } else if (iequals(name, "client_max_window_bits")) {
+            bit = 8;
+            params.client_max_window_bits = has_value ? window_bits() : 0;
+        }
+        if (bit == 0 || (seen & bit) != 0 || params.server_max_window_bits < 0 ||
+            params.client_max_window_bits < 0) {
+            return std::nullopt;
+        }
+        seen |= bit;
+    }
+    return params;
+}
+
+/// Whether any header called name lists token
+bool headers_list(const HttpRequest& request,
+                  std::string_view name,
+                  std::string_view token) noexcept {
+    const auto matches = [&](const HttpHeader& field) {
+        return iequals(field.name, name) && lists_token(field.value, token);
+    };
+    return std::any_of(request.headers().begin(), request.headers().end(), matches);
+}
+
+/**
+ * Whether the client offers permessage-deflate in a form a server keeping
+ * no context accepts: any client window, the server's at its default
+ */
+bool accepts_deflate_offer(const HttpRequest& request) noexcept {
+    for (const HttpHeader& field : request.headers()) {
+        if (!iequals(field.name, "Sec-WebSocket-Extensions")) {
+            continue;
+        }
+        std::string_view offers = field.value;
+        while (!offers.empty()) {
+            const std::size_t comma = std::min(offers.find(','), offers.size());
+            const auto params = parse_deflate(offers.substr(0, comma));
+            if (params && params->server_max_window_bits == 15) {
+                return true;
+            }
+            offers.remove_prefix(std::min(comma + 1, offers.size()));
+        }
+    }
+    return false;
+}
+
+#if CPPTEMPLATE_NETWORK_HAS_ZLIB
+constexpr bool HasZlib = true;
+#else
+constexpr bool HasZlib = false;
+#endif
+
+std::unique_ptr<WsCompressor>& compressor_slot() noexcept {
+    thread_local std::unique_ptr<WsCompressor> compressor;
+    return compressor;
+}
+
+/// The calling thread's compressor, shared by the connections of its loop and by WsFrame
+WsCompressor& thread_compressor(int level) {
+    auto& compressor = compressor_slot();
+    if (!compressor) {
+        compressor = std::make_unique<WsCompressor>(level);
+    } else if (compressor->level() != level) {
+        compressor->set_level(level);
+    }
+    return *compressor;
+}
+
+/// The calling thread's compressor at whatever level it was last used with
+WsCompressor& thread_compressor() {
+    const auto& compressor = compressor_slot();
+    return compressor ? *compressor : thread_compressor(1);
+}
+
+/// Scratch for payloads being compressed, one per thread
+std::string& deflate_buffer() {
+    thread_local std::string buffer;
+    return buffer;
+}
+
+/// Scratch for inflated messages, one per thread; apart from deflate_buffer() as handlers
+/// may echo them
+std::string& inflate_buffer() {
+    thread_local std::string buffer;
+    return buffer;
+}
+
+/// Queued WsConnection output of one loop thread
+struct LoopState {
+    int depth = 0;                    ///< Server callbacks running on this thread
+    std::vector<WsConnection*> dirty; ///< Connections with queued frames, flushed at depth 0
+};
+
+LoopState& loop_state() noexcept {
+    thread_local LoopState state;
+    return state;
+}
+
+/// Marks a server callback running; the outermost one flushes what the callbacks queued
+class CallbackScope {
+public:
+    CallbackScope() noexcept : state_(loop_state()) {
+        ++state_.depth;
+    }
+
+    ~CallbackScope() {
+        if (--state_.depth != 0) {
+            return;
+        }
+        // Index loop: a flush does not queue, but stay safe if the list grows
+        for (std::size_t i = 0; i < state_.dirty.size(); ++i) {
+            WsConnection* ws = state_.dirty[i];
+            try {
+                ws->flush();
+            } catch (...) {
+                ws->connection().close();
+            }
+        }
+        state_.dirty.clear();
+    }
+
+    CallbackScope(const CallbackScope&) = delete;
+    CallbackScope& operator=(const CallbackScope&) = delete;
+
+private:
+    LoopState& state_;
+};
+
+} // namespace
+
+// Parser
+
+void WsParser::reset() noexcept {
+    in_message_ = false;
+    message_compressed_ = false;
+    fragments_.clear();
+    frame_left_ = 0;
+    frame_phase_ = 0;
+    delivered_ = false;
+}
+
+WsParseResult WsParser::deliver(WsMessage& message, std::size_t consumed) noexcept {
+    in_message_ = false;
+    delivered_ = true;
+    message = {message_opcode_, fragments_, message_compressed_};
+    return {Status::Complete, consumed};
+}
+
+WsParseResult WsParser::parse(std::span<char> bytes, WsMessage& message) {
+    if (delivered_) {
+        fragments_.clear();
+        delivered_ = false;
+    }
+    std::size_t consumed = 0;
+    const auto error = [&](WsCloseCode code) {
+        reset();
+        return WsParseResult{Status::Error, consumed, code};
+    };
+
+    for (;;) {
+        const std::size_t available = bytes.size() - consumed;
+        char* const data = bytes.data() + consumed;
+
+        if (frame_left_ > 0) {
+            // Inside a large frame: unmask what has arrived and move it out of the input
+            const auto n =
+                static_cast<std::size_t>(std::min<std::uint64_t>(frame_left_, available));
+            if (n == 0) {
+                return {Status::Incomplete, consumed};
+            }
+            if (frame_masked_) {
+                ws_mask({data, n}, frame_key_, frame_phase_);
+            }
+            frame_phase_ = (frame_phase_ + n) % 4;
+            fragments_.append(data, n);
+            consumed += n;
+            frame_left_ -= n;
+            if (frame_left_ > 0) {
+                return {Status::Incomplete, consumed};
+            }
+            if (frame_fin_) {
+                return deliver(message, consumed);
+            }
+            continue;
+        }
+
+        if (available < 2) {
+            return {Status::Incomplete, consumed};
+        }
+        const auto* p = reinterpret_cast<const std::uint8_t*>(data);
+        const bool fin = (p[0] & 0x80) != 0;
+        const bool rsv1 = (p[0] & 0x40) != 0;
+        const std::uint8_t code = p[0] & 0x0F;
+        const bool masked = (p[1] & 0x80) != 0;
+        if ((p[0] & 0x30) != 0 || !is_known(code) || masked != (role_ == WsRole::Server)) {
+            return error(WsCloseCode::ProtocolError);
+        }
+
+        std::size_t header = 2;
+        std::uint64_t length = p[1] & 0x7F;
+        if (length == 126) {
+            if (available < 4) {
+                return {Status::Incomplete, consumed};
+            }
+            length = static_cast<std::uint64_t>(p[2]) << 8 | p[3];
+            header = 4;
+        } else if (length == 127) {
+            if (available < 10) {
+                return {Status::Incomplete, consumed};
+            }
+            length = 0;
+            for (std::size_t i = 2; i < 10; ++i) {
+                length = length << 8 | p[i];
+            }
+            if ((length >> 63) != 0) {
+                return error(WsCloseCode::ProtocolError);
+            }
+            header = 10;
+        }
+        WsMaskKey key{};
+        if (masked) {
+            if (available < header + 4) {
+                return {Status::Incomplete, consumed};
+            }
+            std::memcpy(key.data(), p + header, 4);
+            header += 4;
+        }
+
+        const auto opcode = static_cast<WsOpcode>(code);
+        const bool control = is_control(opcode);
+        if (control) {
+            if (!fin || length > 125 || rsv1) {
+                return error(WsCloseCode::ProtocolError);
+            }
+        } else if (opcode == WsOpcode::Continuation) {
+            if (!in_message_ || rsv1) {
+                return error(WsCloseCode::ProtocolError);
+            }
+        } else if (in_message_ || (rsv1 && !allow_compressed_)) {
+            return error(WsCloseCode::ProtocolError);
+        }
+        const std::uint64_t so_far = opcode == WsOpcode::Continuation ? fragments_.size() : 0;
+        if (!control && length > limits_.max_message - so_far) {
+            return error(WsCloseCode::MessageTooBig);
+        }
+
+        if (available - header < length) {
+            if (control || length <= StreamThreshold) {
+                return {Status::Incomplete, consumed};
+            }
+            // Too large to hold in the input until complete: stream it
+            consumed += header;
+            if (opcode != WsOpcode::Continuation) {
+                in_message_ = true;
+                message_opcode_ = opcode;
+                message_compressed_ = rsv1;
+            }
+            fragments_.reserve(fragments_.size() + static_cast<std::size_t>(length));
+            frame_left_ = length;
+            frame_fin_ = fin;
+            frame_phase_ = 0;
+            frame_key_ = key;
+            frame_masked_ = masked;
+            continue;
+        }
+
+        const auto size = static_cast<std::size_t>(length);
+        char* const payload = data + header;
+        if (masked) {
+            ws_mask({payload, size}, key);
+        }
+        consumed += header + size;
+        if (control || (fin && opcode != WsOpcode::Continuation)) {
+            // A whole message where it lies: no copy
+            message = {opcode, {payload, size}, rsv1};
+            return {Status::Complete, consumed};
+        }
+        if (opcode != WsOpcode::Continuation) {
+            in_message_ = true;
+            message_opcode_ = opcode;
+            message_compressed_ = rsv1;
+        }
+        fragments_.append(payload, size);
+        if (fin) {
+            return deliver(message, consumed);
+        }
+    }
+}
+
+// Framing
+
+void ws_mask(std::span<char> data, const WsMaskKey& key, std::size_t offset) noexcept {
+    // Rotate the key so that its first byte lines up with data[0]
+    std::array<std::uint8_t, 4> rotated{};
+    for (std::size_t i = 0; i < 4; ++i) {
+        rotated[i] = key[(offset + i) % 4];
+    }
+    std::uint32_t word = 0;
+    std::memcpy(&word, rotated.data(), 4);
+    detail::ws_kernels().mask(data.data(), data.size(), word);
+}
+
+bool ws_valid_utf8(std::string_view text) noexcept {
+    const detail::WsKernels& kernels = detail::ws_kernels();
+    const auto* s = reinterpret_cast<const std::uint8_t*>(text.data());
+    const std::size_t n = text.size();
+    const auto continuation =
+        [&](std::size_t i, std::uint8_t low = 0x80, std::uint8_t high = 0xBF) {
+            return i < n && s[i] >= low && s[i] <= high;
+        };
+    std::size_t i = 0;
+    while (i < n) {
+        const std::uint8_t c = s[i];
+        if (c < 0x80) {
+            i += kernels.ascii_prefix(text.data() + i, n - i);
+        } else if (c < 0xC2) {
+            return false; // A stray continuation byte, or an overlong two-byte form
+        } else if (c < 0xE0) {
+            if (!continuation(i + 1)) {
+                return false;
+            }
+            i += 2;
+        } else if (c < 0xF0) {
+            // E0 would be overlong below A0; ED above 9F encodes a surrogate
+            const std::uint8_t low = c == 0xE0 ? 0xA0 : 0x80;
+            const std::uint8_t high = c == 0xED ? 0x9F : 0xBF;
+            if (!continuation(i + 1, low, high) || !continuation(i + 2)) {
+                return false;
+            }
+            i += 3;
+        } else if (c < 0xF5) {
+            // F0 would be overlong below 90; F4 above 8F passes U+10FFFF
+            const std::uint8_t low = c == 0xF0 ? 0x90 : 0x80;
+            const std::uint8_t high = c == 0xF4 ? 0x8F : 0xBF;
+            if (!continuation(i + 1, low, high) || !continuation(i + 2) || !continuation(i + 3)) {
+                return false;
+            }
+            i += 4;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t ws_frame_header(char* out,
+                            WsOpcode opcode,
+                            std::uint64_t payload_size,
+                            const std::optional<WsMaskKey>& key,
+                            bool compressed,
+                            bool fin) noexcept {
+    out[0] = static_cast<char>((fin ? 0x80 : 0) | (compressed ? 0x40 : 0) |
+                               static_cast<std::uint8_t>(opcode));
+    const int mask_bit = key ? 0x80 : 0;
+    std::size_t n = 2;
+    if (payload_size < 126) {
+        out[1] = static_cast<char>(mask_bit | static_cast<int>(payload_size));
+    } else if (payload_size <= 0xFFFF) {
+        out[1] = static_cast<char>(mask_bit | 126);
+        out[2] = static_cast<char>(payload_size >> 8);
+        out[3] = static_cast<char>(payload_size);
+        n = 4;
+    } else {
+        out[1] = static_cast<char>(mask_bit | 127);
+        for (std::size_t i = 0; i < 8; ++i) {
+            out[2 + i] = static_cast<char>(payload_size >> (56 - 8 * i));
+        }
+        n = 10;
+    }
+    if (key) {
+        std::memcpy(out + n, key->data(), 4);
+        n += 4;
+    }
+    return n;
+}
+
+void ws_append_frame(std::string& out,
+                     WsOpcode opcode,
+                     std::string_view payload,
+                     const std::optional<WsMaskKey>& key,
+                     bool compressed) {
+    std::array<char, WsMaxHeader> header{};
+    const std::size_t header_size =
+        ws_frame_header(header.data(), opcode, payload.size(), key, compressed);
+    out.reserve(out.size() + header_size + payload.size());
+    out.append(header.data(), header_size);
+    const std::size_t start = out.size();
+    out.append(payload);
+    if (key) {
+        ws_mask({out.data() + start, payload.size()}, *key);
+    }
+}
+
+// Handshake
+
+WsMaskKey ws_random_mask() noexcept {
+    WsMaskKey key{};
+    random_bytes(key.data(), key.size());
+    return key;
+}
+
+std::string ws_accept_key(std::string_view key) {
+    const AcceptKey accept = accept_key(key);
+    return {accept.data(), accept.size()};
+}
+
+std::string ws_client_key() {
+    std::array<std::uint8_t, 16> nonce{};
+    random_bytes(nonce.data(), nonce.size());
+    std::string key(24, '\0');
+    base64_encode(nonce.data(), nonce.size(), key.data());
+    return key;
+}
+
+std::string ws_upgrade_request(std::string_view host,
+                               std::string_view target,
+                               std::string_view key,
+                               bool deflate) {
+    std::string request;
+    request.reserve(256);
+    request.append("GET ").append(target).append(" HTTP/1.1\r\nHost: ").append(host);
+    request.append("\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: ");
+    request.append(key);
+    request.append("\r\nSec-WebSocket-Version: 13\r\n");
+    if (deflate) {
+        request.append("Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; "
+                       "client_no_context_takeover\r\n");
+    }
+    request.append("\r\n");
+    return request;
+}
+
+bool ws_check_upgrade_response(std::string_view head,
+                               std::string_view key,
+                               bool* deflate) noexcept {
+    if (deflate != nullptr) {
+        *deflate = false;
+    }
+    std::size_t end = std::min(head.find('\n'), head.size());
+    const std::string_view status = head.substr(0, end);
+    if (!status.starts_with("HTTP/1.1 101") ||
+        (status.size() > 12 && status[12] != ' ' && status[12] != '\r')) {
+        return false;
+    }
+
+    const AcceptKey expected = accept_key(key);
+    bool upgrade = false;
+    bool connection = false;
+    bool accepted = false;
+    bool compressed = false;
+    while (end < head.size()) {
+        head.remove_prefix(end + 1);
+        end = std::min(head.find('\n'), head.size());
+        std::string_view line = head.substr(0, end);
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        const std::size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            continue; // The blank line ending the head
+        }
+        const std::string_view name = line.substr(0, colon);
+        const std::string_view value = trim_spaces(line.substr(colon + 1));
+        if (iequals(name, "Upgrade")) {
+            upgrade = upgrade || lists_token(value, "websocket");
+        } else if (iequals(name, "Connection")) {
+            connection = connection || lists_token(value, "upgrade");
+        } else if (iequals(name, "Sec-WebSocket-Accept")) {
+            accepted = value == std::string_view(expected.data(), expected.size());
+        } else if (iequals(name, "Sec-WebSocket-Extensions")) {
+            // Only what was offered may come back: one permessage-deflate without
+            // server context takeover, leaving the client's window at its default
+            const auto params = parse_deflate(value);
+            if (compressed || !params || !params->server_no_context_takeover ||
+                params->client_max_window_bits != 15) {
+                return false;
+            }
+            compressed = true;
+        }
+    }
+    if (deflate != nullptr) {
+        *deflate = compressed;
+    }
+    return upgrade && connection && accepted;
+}
+
+// Compression
+
+bool permessage_deflate_available() noexcept {
+    return HasZlib;
+}
+
+#if CPPTEMPLATE_NETWORK_HAS_ZLIB
+
+struct WsCompressor::Streams {
+    z_stream deflate{};
+    z_stream inflate{};
+    bool deflate_ready = false;
+    bool inflate_ready = false;
+
+    ~Streams() {
+        if (deflate_ready) {
+            deflateEnd(&deflate);
+        }
+        if (inflate_ready) {
+            inflateEnd(&inflate);
+        }
+    }
+};
+
+namespace {
+
+// Raw deflate with the largest window, as permessage-deflate uses by default
+constexpr int WindowBits = -15;
+constexpr int MemLevel = 8;
+
+/// Empty non-final block that ends a sync flush, stripped from and restored to each
+/// message (RFC 7692, 7.2)
+constexpr std::array<unsigned char, 4> FlushTail{0x00, 0x00, 0xFF, 0xFF};
+
+void check_size(std::size_t size) {
+    if (size > std::numeric_limits<uInt>::max()) {
+        throw std::length_error("permessage-deflate payloads are limited to 4 GiB");
+    }
+}
+
+/// Inflate size bytes into out from used on; false on bad data or past start + limit
+bool inflate_into(z_stream& stream,
+                  const void* data,
+                  std::size_t size,
+                  std::string& out,
+                  std::size_t start,
+                  std::size_t limit,
+                  std::size_t& used,
+                  bool& ended) {
+    stream.next_in = static_cast<Bytef*>(const_cast<void*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    for (;;) {
+        if (used == out.size()) {
+            // One past the limit tells an oversized message
+            const std::size_t cap = start + limit + 1;
+            if (used >= cap) {
+                return false;
+            }
+            out.resize(std::min(cap, std::max(2 * out.size(), used + 4096)));
+        }
+        const auto room = static_cast<uInt>(
+            std::min<std::size_t>(out.size() - used, std::numeric_limits<uInt>::max()));
+        stream.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+        stream.avail_out = room;
+        const int rc = ::inflate(&stream, Z_SYNC_FLUSH);
+        used += room - stream.avail_out;
+        if (rc == Z_STREAM_END) {
+            ended = true; // A final block; nothing may follow it
+            return stream.avail_in == 0;
+        }
+        if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            return false;
+        }
+        if (stream.avail_in == 0 && stream.avail_out > 0) {
+            return true;
+        }
+        if (rc == Z_BUF_ERROR && stream.avail_out > 0) {
+            return false; // No progress with input left
+        }
+    }
+}
+
+} // namespace
+
+WsCompressor::WsCompressor(int level) : streams_(std::make_unique<Streams>()), level_(level) {
+    if (level < 0 || level > 9) {
+        throw std::invalid_argument("Compression level must be 0 to 9");
+    }
+    const int rc = deflateInit2(
+        &streams_->deflate, level, Z_DEFLATED, WindowBits, MemLevel, Z_DEFAULT_STRATEGY);
+    if (rc != Z_OK) {
+        throw core::Exception("deflateInit2 failed");
+    }
+    streams_->deflate_ready = true;
+    if (inflateInit2(&streams_->inflate, WindowBits) != Z_OK) {
+        throw core::Exception("inflateInit2 failed");
+    }
+    streams_->inflate_ready = true;
+}
+
+WsCompressor::~WsCompressor() = default;
+
+void WsCompressor::compress(std::string_view payload, std::string& out, bool keep_context) {
+    check_size(payload.size());
+    z_stream& stream = streams_->deflate;
+    if (!keep_context) {
+        deflateReset(&stream);
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(payload.data()));
+    stream.avail_in = static_cast<uInt>(payload.size());
+    const std::size_t start = out.size();
+    std::size_t used = start;
+    out.resize(start + deflateBound(&stream, stream.avail_in) + 16);
+    for (;;) {
+        if (used == out.size()) {
+            out.resize(2 * out.size());
+        }
+        const auto room = static_cast<uInt>(
+            std::min<std::size_t>(out.size() - used, std::numeric_limits<uInt>::max()));
+        stream.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+        stream.avail_out = room;
+        const int rc = ::deflate(&stream, Z_SYNC_FLUSH);
+        if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            out.resize(start);
+            throw core::Exception("deflate failed");
+        }
+        used += room - stream.avail_out;
+        if (stream.avail_out != 0) {
+            break; // Everything consumed and flushed
+        }
+    }
+    out.resize(used);
+    const std::size_t tail = FlushTail.size();
+    const bool has_tail =
+        used - start >= tail && std::memcmp(out.data() + used - tail, FlushTail.data(), tail) == 0;
+    if (has_tail) {
+        out.resize(used - tail);
+    }
+    if (out.size() == start) {
+        out.push_back('\0'); // An empty message is one empty stored block (RFC 7692, 7.2.3.6)
+    }
+}
+
+bool WsCompressor::decompress(std::string_view payload,
+                              std::string& out,
+                              std::size_t limit,
+                              bool keep_context) {
+    check_size(payload.size());
+    z_stream& stream = streams_->inflate;
+    if (!keep_context) {
+        inflateReset(&stream);
+    }
+    const std::size_t start = out.size();
+    std::size_t used = start;
+    bool ended = false;
+    bool ok = inflate_into(stream, payload.data(), payload.size(), out, start, limit, used, ended);
+    if (ok && !ended) {
+        ok = inflate_into(
+            stream, FlushTail.data(), FlushTail.size(), out, start, limit, used, ended);
+    }
+    if (ended || !ok) {
+        inflateReset(&stream); // A later message cannot continue this stream
+    }
+    if (ok || used - start <= limit) {
+        out.resize(used);
+    }
+    return ok;
+}
+
+void WsCompressor::set_level(int level) {
+    if (level < 0 || level > 9) {
+        throw std::invalid_argument("Compression level must be 0 to 9");
+    }
+    if (deflateParams(&streams_->deflate, level, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw core::Exception("deflateParams failed");
+    }
+    level_ = level;
+}
+
+#else
+
+struct WsCompressor::Streams {};
+
+WsCompressor::WsCompressor(int level) : level_(level) {
+    throw core::Exception("The network library was built without permessage-deflate support");
+}
+
+WsCompressor::~WsCompressor() = default;
+
+void WsCompressor::compress(std::string_view, std::string&, bool) {}
+
+bool WsCompressor::decompress(std::string_view, std::string&, std::size_t, bool) {
+    return false;
+}
+
+void WsCompressor::set_level(int level) {
+    level_ = level;
+}
+
+#endif // CPPTEMPLATE_NETWORK_HAS_ZLIB
+
+// Shared frames
+
+WsFrame::WsFrame(WsOpcode opcode, std::string_view payload, bool compress)
+    : plain_(std::make_shared<const std::string>(ws_frame(opcode, payload))) {
+    if (compress && HasZlib && !is_control(opcode) && !payload.empty()) {
+        std::string& deflated = deflate_buffer();
+        deflated.clear();
+        thread_compressor().compress(payload, deflated);
+        if (deflated.size() < payload.size()) {
+            compressed_ =
+                std::make_shared<const std::string>(ws_frame(opcode, deflated, std::nullopt, true));
+        }
+    }
+}
+
+// Server connections
+
+WsConnection::WsConnection(WebSocketServer& server, Connection& connection) noexcept
+    : server_(&server), connection_(&connection), parser_(WsRole::Server, server.options_.limits) {}
+
+bool WsConnection::send(WsOpcode opcode, std::string_view payload) {
+    if (opcode == WsOpcode::Close) {
+        throw std::invalid_argument("Close frames are sent by close()");
+    }
+    if (opcode == WsOpcode::Continuation) {
+        throw std::invalid_argument("Messages are sent whole, not as continuation frames");
+    }
+    const bool control = is_control(opcode);
+    if (control && payload.size() > 125) {
+        throw std::invalid_argument("Control frame payloads are limited to 125 bytes");
+    }
+    if (closing()) {
+        return false;
+    }
+    const std::size_t offset = scratch_.size();
+    const WsServerOptions& options = server_->options_;
+    if (deflate_ && !control && payload.size() >= options.compress_min) {
+        std::string& deflated = deflate_buffer();
+        deflated.clear();
+        thread_compressor(options.compression_level).compress(payload, deflated);
+        ws_append_frame(scratch_, opcode, deflated, std::nullopt, true);
+    } else {
+        ws_append_frame(scratch_, opcode, payload);
+    }
+    queued(offset);
+    return true;
+}
+
+bool WsConnection::send(const WsFrame& frame) {
+    if (closing()) {
+        return false;
+    }
+    const auto& bytes = deflate_ && frame.compressed_ ? frame.compressed_ : frame.plain_;
+    pieces_.push_back({bytes, 0, bytes->size()});
+    queued_ += bytes->size();
+    mark_dirty();
+    return true;
+}
+
+void WsConnection::close(WsCloseCode code, std::string_view reason) {
+    if (reason.size() > MaxCloseReason) {
+        throw std::invalid_argument("Close reasons are limited to 123 bytes");
+    }
+    if (closing()) {
+        return;
+    }
+    close_sent_ = true;
+    const std::size_t offset = scratch_.size();
+    if (code == WsCloseCode::NoStatus || code == WsCloseCode::Abnormal) {
+        ws_append_frame(scratch_, WsOpcode::Close, {});
+    } else {
+        std::array<char, 2 + MaxCloseReason> payload{};
+        payload[0] = static_cast<char>(static_cast<std::uint16_t>(code) >> 8);
+        payload[1] = static_cast<char>(static_cast<std::uint16_t>(code));
+        std::memcpy(payload.data() + 2, reason.data(), reason.size());
+        ws_append_frame(scratch_, WsOpcode::Close, {payload.data(), 2 + reason.size()});
+    }
+    queued(offset);
+}
+
+void WsConnection::flush() {
+    dirty_ = false;
+    if (pieces_.empty()) {
+        return;
+    }
+    // At most a few frames per batch, so a thread's vector rarely grows
+    thread_local std::vector<std::string_view> views;
+    views.clear();
+    for (const Piece& piece : pieces_) {
+        const std::string_view bytes =
+            piece.shared ? std::string_view(*piece.shared) : std::string_view(scratch_);
+        views.push_back(bytes.substr(piece.offset, piece.size));
+    }
+    connection_->send(views);
+    views.clear();
+    // Drops the references to shared frames: the connection holds what the socket did not take
+    pieces_.clear();
+    queued_ = 0;
+    if (scratch_.capacity() > 64 * 1024) {
+        std::string().swap(scratch_);
+    } else {
+        scratch_.clear();
+    }
+    if (close_sent_) {
+        connection_->close();
+    }
+}
+
+bool WsConnection::closing() const noexcept {
+    return close_sent_ || connection_->closing();
+}
+
+std::size_t WsConnection::pending_output() const noexcept {
+    return queued_ + connection_->pending_output();
+}
+
+void WsConnection::queued(std::size_t offset) {
+    const std::size_t size = scratch_.size() - offset;
+    if (!pieces_.empty() && !pieces_.back().shared &&
+        pieces_.back().offset + pieces_.back().size == offset) {
+        pieces_.back().size += size; // Adjacent in scratch_: one piece
+    } else {
+        pieces_.push_back({nullptr, offset, size});
+    }
+    queued_ += size;
+    mark_dirty();
+}
+
+void WsConnection::mark_dirty() {
+    LoopState& state = loop_state();
+    if (state.depth == 0 || queued_ >= server_->options_.flush_threshold) {
+        // Outside a callback nothing would flush it later; past the threshold, waiting only
+        // costs memory
+        flush();
+        return;
+    }
+    if (!dirty_) {
+        dirty_ = true;
+        state.dirty.push_back(this);
+    }
+}
+
+// Server
+
+WebSocketServer::WebSocketServer(WsServerOptions options)
+    : options_(std::move(options)), server_(options_.tcp) {
+    if (options_.compression_level < 0 || options_.compression_level > 9) {
+        throw std::invalid_argument("compression_level must be 0 to 9");
+    }
+    deflate_ = options_.permessage_deflate && permessage_deflate_available();
+
+    server_.on_connect([this](Connection& connection) {
+        connection.set_user_data(
+            std::shared_ptr<WsConnection>(new WsConnection(*this, connection)));
+    });
+    server_.on_data([this](Connection& connection, std::string_view bytes) {
+        return on_data(connection, bytes);
+    });
+    server_.on_close([this](Connection& connection) {
+        auto* ws = connection.user_data<WsConnection>();
+        if (ws == nullptr) {
+            return;
+        }
+        {
+            const CallbackScope scope;
+            if (ws->open_ && on_close_) {
+                try {
+                    on_close_(*ws);
+                } catch (...) {
+                    // Closing anyway
+                }
+            }
+        }
+        std::erase(loop_state().dirty, ws);
+    });
+}
+
+std::size_t WebSocketServer::on_data(Connection& connection, std::string_view bytes) {
+    const CallbackScope scope;
+    WsConnection& ws = *connection.user_data<WsConnection>();
+    std::size_t consumed = 0;
+    if (!ws.open_) {
+        consumed = handshake(ws, bytes);
+        if (!ws.open_) {
+            return consumed;
+        }
+    }
+
+    // The bytes are the server's own input buffer, so frames are unmasked where they lie
+    char* const data = const_cast<char*>(bytes.data());
+    WsMessage message;
+    while (consumed < bytes.size() && !ws.closing()) {
+        const WsParseResult result =
+            ws.parser_.parse({data + consumed, bytes.size() - consumed}, message);
+        consumed += result.consumed;
+        if (result.status == Status::Incomplete) {
+            break;
+        }
+        if (result.status == Status::Error) {
+            fail(ws, result.close_code);
+            break;
+        }
+        dispatch(ws, message);
+    }
+    return consumed;
+}
+
+std::size_t WebSocketServer::handshake(WsConnection& ws, std::string_view bytes) {
+    Connection& connection = *ws.connection_;
+    HttpRequest request;
+    const HttpParseResult result = ws.handshake_.parse(bytes, request);
+    if (result.status == HttpParseResult::Status::Incomplete) {
+        return 0;
+    }
+    const auto reject = [&](int status, std::string_view name = {}, std::string_view value = {}) {
+        HttpResponse response(status);
+        if (!name.empty()) {
+            response.header(name, value);
+        }
+        response.keep_alive(false).send(connection);
+        connection.close();
+        return bytes.size();
+    };
+    if (result.status == HttpParseResult::Status::Error) {
+        return reject(result.error);
+    }
+    if (request.method != "GET" || request.minor_version < 1) {
+        return reject(400);
+    }
+    if (!options_.path.empty() && request.path != options_.path) {
+        return reject(404);
+    }
+    if (!headers_list(request, "Upgrade", "websocket") ||
+        !headers_list(request, "Connection", "upgrade")) {
+        return reject(426, "Upgrade", "websocket");
+    }
+    if (request.header("Sec-WebSocket-Version") != "13") {
+        return reject(426, "Sec-WebSocket-Version", "13");
+    }
+    const std::string_view key = request.header("Sec-WebSocket-Key");
+    if (!is_valid_client_key(key)) {
+        return reject(400);
+    }
+
+    const AcceptKey accept = accept_key(key);
+    const bool deflate = deflate_ && accepts_deflate_offer(request);
+    HttpResponse response(101);
+    response.header("Upgrade", "websocket")
+        .header("Connection", "Upgrade")
+        .header("Sec-WebSocket-Accept", {accept.data(), accept.size()});
+    if (deflate) {
+        response.header("Sec-WebSocket-Extensions", DeflateResponse);
+    }
+    response.send(connection);
+
+    ws.open_ = true;
+    ws.deflate_ = deflate;
+    ws.parser_.allow_compressed(deflate);
+    if (on_open_) {
+        on_open_(ws, request);
+    }
+    return result.consumed;
+}
+
+void WebSocketServer::dispatch(WsConnection& ws, const WsMessage& message) {
+    switch (message.opcode) {
+        case WsOpcode::Ping: ws.send(WsOpcode::Pong, message.payload); return;
+        case WsOpcode::Pong: return;
+        case WsOpcode::Close: {
+            const std::string_view payload = message.payload;
+            WsCloseCode code = WsCloseCode::NoStatus;
+            if (payload.size() == 1) {
+                fail(ws, WsCloseCode::ProtocolError);
+                return;
+            }
+            if (payload.size() >= 2) {
+                const auto value =
+                    static_cast<std::uint16_t>(static_cast<std::uint8_t>(payload[0]) << 8 |
+                                               static_cast<std::uint8_t>(payload[1]));
+                if (!is_valid_close_code(value)) {
+                    fail(ws, WsCloseCode::ProtocolError);
+                    return;
+                }
+                if (!ws_valid_utf8(payload.substr(2))) {
+                    fail(ws, WsCloseCode::InvalidPayload);
+                    return;
+                }
+                code = static_cast<WsCloseCode>(value);
+            }
+            ws.close_code_ = code;
+            ws.close(code); // Echo the code, or send none back if none came
+            return;
+        }
+        default: break;
+    }
+
+    std::string_view payload = message.payload;
+    std::string& inflated = inflate_buffer();
+    if (message.compressed) {
+        inflated.clear();
+        const std::size_t limit = options_.limits.max_message;
+        if (!thread_compressor(options_.compression_level).decompress(payload, inflated, limit)) {
+            const bool too_big = inflated.size() > limit;
+            fail(ws, too_big ? WsCloseCode::MessageTooBig : WsCloseCode::InvalidPayload);
+            return;
+        }
+        payload = inflated;
+    }
+    if (message.opcode == WsOpcode::Text && !ws_valid_utf8(payload)) {
+        fail(ws, WsCloseCode::InvalidPayload);
+        return;
+    }
+    if (on_message_) {
+        on_message_(ws, WsMessage{message.opcode, payload, false});
+    }
+    if (inflated.capacity() > 1 << 20) {
+        std::string().swap(inflated); // Do not keep a large message's buffer for good
+    }
+}
+
+void WebSocketServer::fail(WsConnection& ws, WsCloseCode code) {
+    ws.close(code);
+}
+
+} // namespace cpptemplate::network
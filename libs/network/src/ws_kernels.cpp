@@ -0,0 +1,184 @@
+#include "ws_kernels.hpp"
+
+#include <bit>
+#include <cstring>
+
+#if CPPTEMPLATE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+#if CPPTEMPLATE_NEON_KERNELS
+    #include <arm_neon.h>
+#endif
+
+namespace cpptemplate::network::detail {
+
+namespace {
+
+// Scalar kernels, 8 bytes at a time through memcpy, which compiles to plain
+// unaligned loads and stores
+
+void mask_scalar(char* s, std::size_t n, std::uint32_t key) noexcept {
+    // Both halves hold the key, so the pattern is right in either byte order
+    const std::uint64_t key64 = key | static_cast<std::uint64_t>(key) << 32;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, s + i, 8);
+        word ^= key64;
+        std::memcpy(s + i, &word, 8);
+    }
+    unsigned char bytes[4];
+    std::memcpy(bytes, &key, 4);
+    for (; i < n; ++i) {
+        s[i] = static_cast<char>(s[i] ^ bytes[i % 4]);
+    }
+}
+
+std::size_t ascii_prefix_scalar(const char* s, std::size_t n) noexcept {
+    constexpr std::uint64_t HighBits = 0x8080'8080'8080'8080;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, s + i, 8);
+        if ((word & HighBits) != 0) {
+            break;
+        }
+    }
+    while (i < n && static_cast<unsigned char>(s[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+constexpr WsKernels ScalarKernels{mask_scalar, ascii_prefix_scalar};
+
+#if CPPTEMPLATE_X86_KERNELS
+
+// x86 is little-endian, so a 32-bit lane holding key has its bytes in memory order
+
+CPPTEMPLATE_SSE42 void mask_sse(char* s, std::size_t n, std::uint32_t key) noexcept {
+    const __m128i pattern = _mm_set1_epi32(static_cast<int>(key));
+    std::size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        // Four independent vectors per round keep the load and store ports busy
+        auto* p = reinterpret_cast<__m128i*>(s + i);
+        const __m128i a = _mm_xor_si128(_mm_loadu_si128(p), pattern);
+        const __m128i b = _mm_xor_si128(_mm_loadu_si128(p + 1), pattern);
+        const __m128i c = _mm_xor_si128(_mm_loadu_si128(p + 2), pattern);
+        const __m128i d = _mm_xor_si128(_mm_loadu_si128(p + 3), pattern);
+        _mm_storeu_si128(p, a);
+        _mm_storeu_si128(p + 1, b);
+        _mm_storeu_si128(p + 2, c);
+        _mm_storeu_si128(p + 3, d);
+    }
+    for (; i + 16 <= n; i += 16) {
+        auto* p = reinterpret_cast<__m128i*>(s + i);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), pattern));
+    }
+    mask_scalar(s + i, n - i, key); // i is a multiple of 4, so the key lines up
+}
+
+CPPTEMPLATE_SSE42 std::size_t ascii_prefix_sse(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const auto high = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i))));
+        if (high != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(high));
+        }
+    }
+    return i + ascii_prefix_scalar(s + i, n - i);
+}
+
+constexpr WsKernels Sse42Kernels{mask_sse, ascii_prefix_sse};
+
+CPPTEMPLATE_AVX2 void mask_avx2(char* s, std::size_t n, std::uint32_t key) noexcept {
+    const __m256i pattern = _mm256_set1_epi32(static_cast<int>(key));
+    std::size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        auto* p = reinterpret_cast<__m256i*>(s + i);
+        const __m256i a = _mm256_xor_si256(_mm256_loadu_si256(p), pattern);
+        const __m256i b = _mm256_xor_si256(_mm256_loadu_si256(p + 1), pattern);
+        const __m256i c = _mm256_xor_si256(_mm256_loadu_si256(p + 2), pattern);
+        const __m256i d = _mm256_xor_si256(_mm256_loadu_si256(p + 3), pattern);
+        _mm256_storeu_si256(p, a);
+        _mm256_storeu_si256(p + 1, b);
+        _mm256_storeu_si256(p + 2, c);
+        _mm256_storeu_si256(p + 3, d);
+    }
+    for (; i + 32 <= n; i += 32) {
+        auto* p = reinterpret_cast<__m256i*>(s + i);
+        _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), pattern));
+    }
+    mask_sse(s + i, n - i, key);
+}
+
+CPPTEMPLATE_AVX2 std::size_t ascii_prefix_avx2(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const auto high = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i))));
+        if (high != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(high));
+        }
+    }
+    return i + ascii_prefix_sse(s + i, n - i);
+}
+
+constexpr WsKernels Avx2Kernels{mask_avx2, ascii_prefix_avx2};
+
+#endif // CPPTEMPLATE_X86_KERNELS
+
+#if CPPTEMPLATE_NEON_KERNELS
+
+// AArch64 Linux is little-endian, so a 32-bit lane holding key has its bytes in memory order
+
+void mask_neon(char* s, std::size_t n, std::uint32_t key) noexcept {
+    const uint8x16_t pattern = vreinterpretq_u8_u32(vdupq_n_u32(key));
+    auto* bytes = reinterpret_cast<std::uint8_t*>(s);
+    std::size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        uint8x16x4_t v = vld1q_u8_x4(bytes + i);
+        v.val[0] = veorq_u8(v.val[0], pattern);
+        v.val[1] = veorq_u8(v.val[1], pattern);
+        v.val[2] = veorq_u8(v.val[2], pattern);
+        v.val[3] = veorq_u8(v.val[3], pattern);
+        vst1q_u8_x4(bytes + i, v);
+    }
+    for (; i + 16 <= n; i += 16) {
+        vst1q_u8(bytes + i, veorq_u8(vld1q_u8(bytes + i), pattern));
+    }
+    mask_scalar(s + i, n - i, key);
+}
+
+std::size_t ascii_prefix_neon(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(s + i))) >= 0x80) {
+            break; // The scalar loop below finds which byte
+        }
+    }
+    return i + ascii_prefix_scalar(s + i, n - i);
+}
+
+constexpr WsKernels NeonKernels{mask_neon, ascii_prefix_neon};
+
+#endif // CPPTEMPLATE_NEON_KERNELS
+
+} // namespace
+
+const WsKernels& ws_kernels(core::SimdLevel level) noexcept {
+    switch (level) {
+#if CPPTEMPLATE_X86_KERNELS
+        case core::SimdLevel::Avx512:
+        case core::SimdLevel::Avx2: return Avx2Kernels;
+        case core::SimdLevel::Sse42: return Sse42Kernels;
+#endif
+#if CPPTEMPLATE_NEON_KERNELS
+        case core::SimdLevel::Neon: return NeonKernels;
+#endif
+        default: return ScalarKernels;
+    }
+}
+
+} // namespace cpptemplate::network::detail
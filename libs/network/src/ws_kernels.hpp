@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cpptemplate/core/simd.hpp"
+
+namespace cpptemplate::network::detail {
+
+/**
+ * @brief WebSocket payload kernels for one core::SimdLevel
+ */
+struct WsKernels {
+    /// XOR s[0, n) with key repeated, key's bytes in memory order starting at s[0]
+    void (*mask)(char* s, std::size_t n, std::uint32_t key) noexcept;
+    /// Length of the leading run of ASCII bytes in s[0, n)
+    std::size_t (*ascii_prefix)(const char* s, std::size_t n) noexcept;
+};
+
+/**
+ * @brief Get the kernels of a level
+ * @param level Level, which must be supported by the running CPU
+ * @return Kernel table with static storage duration
+ */
+const WsKernels& ws_kernels(core::SimdLevel level) noexcept;
+
+/**
+ * @brief Get the kernels of the active level
+ * @return Kernel table for core::simd_level()
+ */
+inline const WsKernels& ws_kernels() noexcept {
+    return ws_kernels(core::simd_level());
+}
+
+} // namespace cpptemplate::network::detail
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cpptemplate/core/expected.hpp"
+#include "string_utils.hpp" // For export macros
+
+namespace cpptemplate::utils {
+
+// Parsing and formatting built on std::from_chars and std::to_chars: no
+// locale, no allocation while parsing, and exact round trips. Parsers accept
+// the whole input or fail; surrounding ASCII whitespace and a leading '+'
+// are allowed. Errors are returned as core::Errc::ParseError (not a number,
+// or trailing characters) or core::Errc::OutOfRange (does not fit the type).
+
+/**
+ * @brief Parse a signed decimal integer
+ * @param str Input, e.g. "-42"
+ * @return Value, or an error
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API core::Expected<std::int64_t> parse_int(
+    std::string_view str) noexcept;
+
+/**
+ * @brief Parse an unsigned decimal integer
+ * @param str Input, e.g. "42"; a minus sign is a ParseError
+ * @return Value, or an error
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API core::Expected<std::uint64_t> parse_uint(
+    std::string_view str) noexcept;
+
+/**
+ * @brief Parse a floating-point number
+ *
+ * Accepts fixed and scientific notation, "inf" and "nan". The result is
+ * correctly rounded. A value too large for a double is OutOfRange.
+ *
+ * @param str Input, e.g. "3.25", "-1e-7"
+ * @return Value, or an error
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API core::Expected<double> parse_double(
+    std::string_view str) noexcept;
+
+/**
+ * @brief Parse a delimited row of numbers into a column of doubles
+ *
+ * Each field is parsed as by parse_double(). Delimiters are found 16 or
+ * 32 bytes at a time. Plain decimals of up to 16 characters, the usual
+ * shape of CSV data, are converted with SIMD multiply-adds and one exact
+ * division. Everything else goes through std::from_chars. Either way the
+ * results are bit-identical to parse_double().
+ *
+ * out is cleared first and keeps its capacity, and its data can go straight
+ * to the span overloads of math::Calculator. A row that is empty after
+ * trimming has no fields; an empty field between delimiters is an error.
+ *
+ * @param row Input row, e.g. "1.5,2,-0.25"
+ * @param delimiter Field delimiter
+ * @param out Receives the values; holds the fields before the bad one on error
+ * @return Number of values, or the error of the first bad field
+ */
+CPPTEMPLATE_UTILS_API core::Expected<std::size_t> parse_row(std::string_view row, char delimiter,
+                                                           std::vector<double>& out);
+
+/**
+ * @brief Format an integer in decimal
+ * @param value Value
+ * @return Decimal digits, with a leading '-' if negative
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::string format_int(std::int64_t value);
+
+/**
+ * @brief Format a double in its shortest round-trip form
+ *
+ * The shortest string that parse_double() turns back into exactly value,
+ * e.g. "0.1" rather than "0.10000000000000001"; "inf", "-inf" or "nan" for
+ * non-finite values.
+ *
+ * @param value Value
+ * @return Formatted value
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::string format_double(double value);
+
+/**
+ * @brief Format a double with a fixed number of decimals
+ * @param value Value
+ * @param precision Digits after the decimal point, 0 to 100
+ * @return Formatted value, e.g. "3.14" for (3.14159, 2)
+ * @throws std::invalid_argument If precision is out of range
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::string format_double(double value, int precision);
+
+/**
+ * @brief Append an integer in decimal, without a temporary string
+ * @param out String to append to
+ * @param value Value
+ */
+CPPTEMPLATE_UTILS_API void append_int(std::string& out, std::int64_t value);
+
+/**
+ * @brief Append a double in its shortest round-trip form, without a temporary string
+ * @param out String to append to
+ * @param value Value
+ */
+CPPTEMPLATE_UTILS_API void append_double(std::string& out, double value);
+
+} // namespace cpptemplate::utils
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+#include "string_utils.hpp" // For export macros
+
+namespace cpptemplate::utils {
+
+/**
+ * @brief Monotonic arena for short-lived strings
+ *
+ * A std::pmr::memory_resource that hands out memory by bumping a pointer
+ * and ignores deallocation; everything it handed out is freed at once by
+ * release() or the destructor. Pass it to the std::pmr overloads of the
+ * string_utils functions so all the strings of one request (or parse, or
+ * batch) cost a few block allocations in total.
+ *
+ * The first block is kept across release(), so an arena reused for request
+ * after request stops allocating once it is large enough. Not thread-safe;
+ * use one arena per thread or connection.
+ *
+ * @example
+ * ```cpp
+ * StringArena arena;
+ * for (const auto& request : requests) {
+ *     auto fields = split(request.line, ' ', &arena);
+ *     auto method = to_upper(fields[0], &arena);
+ *     handle(method, fields);
+ *     arena.release();
+ * }
+ * ```
+ */
+class CPPTEMPLATE_UTILS_API StringArena : public std::pmr::memory_resource {
+public:
+    /**
+     * @brief Create an arena
+     * @param initial_size Size of the first block, kept across release()
+     */
+    explicit StringArena(std::size_t initial_size = 4096);
+
+    ~StringArena() override;
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    /**
+     * @brief Free everything allocated from the arena
+     *
+     * Strings and containers still using the arena must not be touched
+     * afterwards, not even destroyed with a non-trivial destructor.
+     * std::pmr::string and std::pmr::vector only deallocate, which the
+     * arena ignores, so destroying them later is fine.
+     */
+    void release() noexcept;
+
+    /**
+     * @brief Bytes handed out since construction or the last release()
+     * @return Sum of the allocation sizes, without alignment padding
+     */
+    [[nodiscard]] std::size_t bytes_used() const noexcept {
+        return bytes_used_;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::unique_ptr<std::byte[]> initial_;
+    std::pmr::monotonic_buffer_resource blocks_;
+    std::size_t bytes_used_ = 0;
+};
+
+} // namespace cpptemplate::utils
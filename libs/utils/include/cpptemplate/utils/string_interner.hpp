@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "string_utils.hpp" // For export macros
+
+namespace cpptemplate::utils {
+
+/**
+ * @brief Thread-safe pool of unique strings with 32-bit IDs
+ *
+ * Each distinct string is copied once into storage owned by the interner
+ * and given an ID; interning it again returns the same ID and copies
+ * nothing. IDs and the views returned by view() stay valid for the
+ * interner's lifetime, so they can be stored and compared instead of
+ * strings.
+ *
+ * Strings are spread over shards by hash, each with its own lock, so
+ * threads interning different strings rarely contend. Looking up a string
+ * that is already interned takes the shard's lock in shared mode, and
+ * view() takes no lock at all.
+ *
+ * @example
+ * ```cpp
+ * StringInterner names;
+ * const auto id = names.intern(to_lower(header_name));
+ * if (id == content_length_id) { ... }
+ * std::string_view name = names.view(id);
+ * ```
+ */
+class CPPTEMPLATE_UTILS_API StringInterner {
+public:
+    using Id = std::uint32_t;
+
+    /**
+     * @brief Create an empty interner
+     * @param shards Number of shards, rounded up to a power of two between 1 and 256
+     */
+    explicit StringInterner(std::size_t shards = 16);
+
+    ~StringInterner();
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    /**
+     * @brief Get the ID of a string, adding it if it is new
+     * @param str String to intern
+     * @return ID of str
+     * @throws std::length_error If the shard of str has run out of IDs
+     */
+    Id intern(std::string_view str);
+
+    /**
+     * @brief Get the ID of a string without adding it
+     * @param str String to look up
+     * @return ID of str, or std::nullopt if it was never interned
+     */
+    [[nodiscard]] std::optional<Id> find(std::string_view str) const;
+
+    /**
+     * @brief Get the string of an ID
+     * @param id ID returned by intern() on this interner
+     * @return View of the interned copy, valid for the interner's lifetime
+     * @throws std::out_of_range If no string has that ID
+     */
+    [[nodiscard]] std::string_view view(Id id) const;
+
+    /**
+     * @brief Number of distinct strings interned
+     * @return String count
+     */
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    /**
+     * @brief Bytes of string storage in use
+     * @return Total length of the interned strings
+     */
+    [[nodiscard]] std::size_t storage_bytes() const noexcept;
+
+private:
+    struct Shard;
+
+    std::unique_ptr<Shard[]> shards_;
+    std::uint32_t shard_bits_ = 0;
+};
+
+} // namespace cpptemplate::utils
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <ranges>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 // Export macros for dynamic libraries
@@ -25,6 +32,11 @@
 
 namespace cpptemplate::utils {
 
+// Character classes are ASCII, as in the "C" locale: whitespace is ' ', '\t',
+// '\n', '\v', '\f' and '\r', and case conversion only changes 'a'-'z' and
+// 'A'-'Z'. Trimming, case conversion and split scan 16 or 32 bytes per
+// instruction where the CPU allows (see simd.hpp).
+
 /**
  * @brief Trim whitespace from both ends of a string
  * @param str Input string
@@ -46,6 +58,27 @@ namespace cpptemplate::utils {
  */
 [[nodiscard]] CPPTEMPLATE_UTILS_API std::string rtrim(std::string_view str);
 
+/**
+ * @brief Trim whitespace from both ends without copying
+ * @param str Input string
+ * @return View of str without leading and trailing whitespace
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::string_view trim_view(std::string_view str) noexcept;
+
+/**
+ * @brief Trim whitespace from the left end without copying
+ * @param str Input string
+ * @return View of str without leading whitespace
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::string_view ltrim_view(std::string_view str) noexcept;
+
+/**
+ * @brief Trim whitespace from the right end without copying
+ * @param str Input string
+ * @return View of str without trailing whitespace
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::string_view rtrim_view(std::string_view str) noexcept;
+
 /**
  * @brief Convert string to uppercase
  * @param str Input string
@@ -66,10 +99,128 @@ namespace cpptemplate::utils {
  * @param delimiter Delimiter character
  * @return Vector of string parts
  */
-[[nodiscard]] CPPTEMPLATE_UTILS_API std::vector<std::string> split(std::string_view str, char delimiter);
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::vector<std::string> split(std::string_view str,
+                                                                   char delimiter);
+
+/**
+ * @brief Split string by delimiter without copying the tokens
+ *
+ * Like split(), empty tokens are skipped.
+ *
+ * @param str Input string, which must outlive the returned views
+ * @param delimiter Delimiter character
+ * @return Views of the non-empty tokens of str
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::vector<std::string_view> split_view(std::string_view str,
+                                                                             char delimiter);
+
+/**
+ * @brief Split string by delimiter into a caller-owned buffer
+ *
+ * out is cleared first and keeps its capacity, so splitting line after
+ * line into the same vector stops allocating once it has grown to the
+ * widest line.
+ *
+ * @param str Input string, which must outlive the views stored in out
+ * @param delimiter Delimiter character
+ * @param out Receives views of the non-empty tokens of str
+ * @return Number of tokens
+ */
+CPPTEMPLATE_UTILS_API std::size_t split(std::string_view str,
+                                        char delimiter,
+                                        std::vector<std::string_view>& out);
+
+/**
+ * @brief Lazy range over the non-empty tokens of a string
+ *
+ * Each increment scans for the next delimiter, so nothing is allocated
+ * and a loop that stops early never scans the rest of the input. The
+ * iterators hold the input view themselves and stay valid after the
+ * Tokenizer is gone (it is a borrowed range), but not after the
+ * characters it views are.
+ *
+ * @example
+ * ```cpp
+ * for (std::string_view field : Tokenizer(line, ',')) {
+ *     consume(trim_view(field));
+ * }
+ * ```
+ */
+class CPPTEMPLATE_UTILS_API Tokenizer : public std::ranges::view_interface<Tokenizer> {
+public:
+    /// Forward iterator yielding std::string_view tokens
+    class iterator {
+    public:
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+
+        iterator() = default;
+
+        [[nodiscard]] std::string_view operator*() const noexcept {
+            return token_;
+        }
+
+        iterator& operator++() noexcept {
+            token_ = Tokenizer::next(str_, delimiter_, pos_);
+            return *this;
+        }
+
+        iterator operator++(int) noexcept {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        [[nodiscard]] friend bool operator==(const iterator& a, const iterator& b) noexcept {
+            return a.pos_ == b.pos_;
+        }
+
+    private:
+        friend class Tokenizer;
+
+        iterator(std::string_view str, char delimiter, std::size_t pos) noexcept
+            : str_(str), pos_(pos), delimiter_(delimiter) {}
+
+        std::string_view str_;
+        std::string_view token_;
+        std::size_t pos_ = End; ///< Just past token_, or End once exhausted
+        char delimiter_ = '\0';
+    };
+
+    Tokenizer() = default;
+
+    /**
+     * @brief Tokenize a string
+     * @param str Input string, which must outlive the tokens
+     * @param delimiter Delimiter character
+     */
+    Tokenizer(std::string_view str, char delimiter) noexcept : str_(str), delimiter_(delimiter) {}
+
+    [[nodiscard]] iterator begin() const noexcept {
+        return ++iterator(str_, delimiter_, 0);
+    }
+
+    [[nodiscard]] iterator end() const noexcept {
+        return {};
+    }
+
+private:
+    static constexpr std::size_t End = std::string_view::npos;
+
+    /// Token starting the scan at pos; advances pos past it, or to End with an empty view
+    static std::string_view next(std::string_view str, char delimiter, std::size_t& pos) noexcept;
+
+    std::string_view str_;
+    char delimiter_ = '\0';
+};
 
 /**
  * @brief Join strings with delimiter
+ *
+ * Sizes the result exactly before copying, so it allocates once.
+ *
  * @param strings Vector of strings to join
  * @param delimiter Delimiter string
  * @return Joined string
@@ -95,6 +246,12 @@ namespace cpptemplate::utils {
 
 /**
  * @brief Replace all occurrences of a substring
+ *
+ * Matches do not overlap and are found left to right in the original
+ * string, never in inserted text. The result is built in one pass, in
+ * place when to is no longer than from, so the cost is linear whatever the
+ * lengths of from and to.
+ *
  * @param str Input string
  * @param from Substring to replace
  * @param to Replacement string
@@ -104,4 +261,167 @@ namespace cpptemplate::utils {
                                                             std::string_view from, 
                                                             std::string_view to);
 
-} // namespace cpptemplate::utils
\ No newline at end of file
+/**
+ * @brief Replaces many substrings in a single scan
+ *
+ * The patterns are compiled once into an Aho-Corasick automaton, so
+ * replace() reads each input byte about once however many patterns there
+ * are. Where matches overlap, the one starting first wins, and among those
+ * starting at the same byte the longest; scanning resumes after it, as with
+ * replace_all(). Bytes that occur in no pattern share one column of the
+ * transition table, which keeps it small for large pattern sets.
+ *
+ * Immutable after construction, so one instance may be shared by threads.
+ *
+ * @example
+ * ```cpp
+ * const MultiReplacer escape({{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}});
+ * std::string html = escape.replace(text);
+ * ```
+ */
+class CPPTEMPLATE_UTILS_API MultiReplacer {
+public:
+    /**
+     * @brief Compile a set of replacements
+     * @param replacements Pairs of pattern and replacement; a pattern given
+     *        twice keeps its first replacement
+     * @throws std::invalid_argument If a pattern is empty
+     */
+    explicit MultiReplacer(const std::vector<std::pair<std::string, std::string>>& replacements);
+
+    /**
+     * @brief Replace every match in a string
+     * @param str Input string
+     * @return String with replacements
+     */
+    [[nodiscard]] std::string replace(std::string_view str) const;
+
+    /// Number of distinct patterns
+    [[nodiscard]] std::size_t size() const noexcept {
+        return replacements_.size();
+    }
+
+private:
+    /// Offset of a state's row in table_
+    using State = std::uint32_t;
+
+    /// Words after the transitions in each row
+    enum Slot : std::size_t {
+        Output, ///< 1 + index of the longest pattern ending in the state, 0 if none
+        Depth   ///< Length of the prefix the state stands for
+    };
+
+    /// Byte to column; 0 for bytes in no pattern. 16 bits, since patterns
+    /// using all 256 byte values need 257 columns
+    std::array<std::uint16_t, 256> classes_{};
+    std::array<bool, 256> starts_{};     ///< Bytes some pattern starts with
+    std::size_t columns_ = 1;
+    std::size_t stride_ = 3;             ///< columns_ transitions, then the Slots
+    std::vector<State> table_;
+    std::vector<std::uint32_t> lengths_; ///< Pattern lengths
+    std::vector<std::string> replacements_;
+};
+
+/**
+ * @brief Replace many substrings in a single scan
+ *
+ * Compiles a MultiReplacer for one call; keep a MultiReplacer to apply the
+ * same set to many strings.
+ *
+ * @param str Input string
+ * @param replacements Pairs of pattern and replacement
+ * @return String with replacements
+ * @throws std::invalid_argument If a pattern is empty
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::string replace_all(
+    std::string_view str, const std::vector<std::pair<std::string, std::string>>& replacements);
+
+// Overloads allocating their result from a memory resource, typically a
+// StringArena (string_arena.hpp) that frees a whole request's strings at
+// once. They behave like the std::string versions above.
+
+/**
+ * @brief Trim whitespace from both ends of a string
+ * @param str Input string
+ * @param resource Resource the result allocates from
+ * @return Trimmed string
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::pmr::string trim(std::string_view str,
+                                                          std::pmr::memory_resource* resource);
+
+/**
+ * @brief Trim whitespace from the left end of a string
+ * @param str Input string
+ * @param resource Resource the result allocates from
+ * @return Left-trimmed string
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::pmr::string ltrim(std::string_view str,
+                                                           std::pmr::memory_resource* resource);
+
+/**
+ * @brief Trim whitespace from the right end of a string
+ * @param str Input string
+ * @param resource Resource the result allocates from
+ * @return Right-trimmed string
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::pmr::string rtrim(std::string_view str,
+                                                           std::pmr::memory_resource* resource);
+
+/**
+ * @brief Convert string to uppercase
+ * @param str Input string
+ * @param resource Resource the result allocates from
+ * @return Uppercase string
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::pmr::string to_upper(std::string_view str,
+                                                              std::pmr::memory_resource* resource);
+
+/**
+ * @brief Convert string to lowercase
+ * @param str Input string
+ * @param resource Resource the result allocates from
+ * @return Lowercase string
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::pmr::string to_lower(std::string_view str,
+                                                              std::pmr::memory_resource* resource);
+
+/**
+ * @brief Split string by delimiter
+ * @param str Input string
+ * @param delimiter Delimiter character
+ * @param resource Resource the vector and its strings allocate from
+ * @return Vector of string parts
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::pmr::vector<std::pmr::string>
+split(std::string_view str, char delimiter, std::pmr::memory_resource* resource);
+
+/**
+ * @brief Join strings with delimiter
+ * @param strings Strings to join
+ * @param delimiter Delimiter string
+ * @param resource Resource the result allocates from
+ * @return Joined string
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::pmr::string join(
+    const std::pmr::vector<std::pmr::string>& strings,
+    std::string_view delimiter,
+    std::pmr::memory_resource* resource);
+
+/**
+ * @brief Replace all occurrences of a substring
+ * @param str Input string
+ * @param from Substring to replace
+ * @param to Replacement string
+ * @param resource Resource the result allocates from
+ * @return String with replacements
+ */
+[[nodiscard]] CPPTEMPLATE_UTILS_API std::pmr::string replace_all(
+    std::string_view str,
+    std::string_view from,
+    std::string_view to,
+    std::pmr::memory_resource* resource);
+
+} // namespace cpptemplate::utils
+
+template<>
+inline constexpr bool std::ranges::enable_borrowed_range<cpptemplate::utils::Tokenizer> = true;
\ No newline at end of file
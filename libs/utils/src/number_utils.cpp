@@ -0,0 +1,160 @@
+#include "cpptemplate/utils/number_utils.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include "string_kernels.hpp"
+
+namespace cpptemplate::utils {
+
+namespace {
+
+using core::Errc;
+
+/// Trim and drop a leading '+', which from_chars does not accept
+std::string_view number_text(std::string_view str) noexcept {
+    str = trim_view(str);
+    if (str.size() > 1 && str.front() == '+' && str[1] != '-' && str[1] != '+') {
+        str.remove_prefix(1);
+    }
+    return str;
+}
+
+/// parse_int() and parse_uint()
+template<typename T>
+core::Expected<T> parse_integer(std::string_view str) noexcept {
+    str = number_text(str);
+    T value{};
+    const auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (error == std::errc::result_out_of_range) {
+        return core::unexpected(Errc::OutOfRange);
+    }
+    if (error != std::errc() || end != str.data() + str.size()) {
+        return core::unexpected(Errc::ParseError);
+    }
+    return value;
+}
+
+/// Appends the to_chars form of value, given a bound on its length
+template<typename... Format>
+void append_chars(std::string& out, std::size_t max_size, double value, Format... format) {
+    const std::size_t size = out.size();
+    out.resize(size + max_size);
+    const auto result = std::to_chars(out.data() + size, out.data() + out.size(), value, format...);
+    out.resize(static_cast<std::size_t>(result.ptr - out.data()));
+}
+
+// Longest shortest-form double, e.g. "-2.2250738585072014e-308"
+constexpr std::size_t MaxShortestDouble = 32;
+
+} // namespace
+
+core::Expected<std::int64_t> parse_int(std::string_view str) noexcept {
+    return parse_integer<std::int64_t>(str);
+}
+
+core::Expected<std::uint64_t> parse_uint(std::string_view str) noexcept {
+    return parse_integer<std::uint64_t>(str);
+}
+
+core::Expected<double> parse_double(std::string_view str) noexcept {
+    str = number_text(str);
+    double value = 0.0;
+    const auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (error == std::errc::result_out_of_range) {
+        return core::unexpected(Errc::OutOfRange);
+    }
+    if (error != std::errc() || end != str.data() + str.size()) {
+        return core::unexpected(Errc::ParseError);
+    }
+    return value;
+}
+
+core::Expected<std::size_t> parse_row(std::string_view row,
+                                      char delimiter,
+                                      std::vector<double>& out) {
+    out.clear();
+    row = trim_view(row);
+    if (row.empty()) {
+        return std::size_t{0};
+    }
+
+    const auto& kernels = detail::string_kernels();
+    const char* const row_end = row.data() + row.size();
+    std::size_t pos = 0;
+    while (true) {
+        const std::size_t end =
+            pos + kernels.find_byte(row.data() + pos, row.size() - pos, delimiter);
+        const std::string_view field = row.substr(pos, end - pos);
+
+        const bool negative = !field.empty() && field.front() == '-';
+        const std::string_view digits = field.substr(negative ? 1 : 0);
+        double value = 0.0;
+        bool parsed = false;
+        if (!digits.empty() && digits.size() <= 16) {
+            // The kernel loads 16 bytes; near the end of the row, from a copy
+            if (row_end - digits.data() >= 16) {
+                parsed = kernels.parse_decimal(digits.data(), digits.size(), value);
+            } else {
+                std::array<char, 16> padded{};
+                std::memcpy(padded.data(), digits.data(), digits.size());
+                parsed = kernels.parse_decimal(padded.data(), digits.size(), value);
+            }
+            value = negative ? -value : value;
+        }
+        if (!parsed) {
+            const auto slow = parse_double(field);
+            if (!slow.has_value()) {
+                return core::Unexpected(slow.error());
+            }
+            value = *slow;
+        }
+        out.push_back(value);
+
+        if (end == row.size()) {
+            return out.size();
+        }
+        pos = end + 1;
+    }
+}
+
+std::string format_int(std::int64_t value) {
+    std::string result;
+    append_int(result, value);
+    return result;
+}
+
+std::string format_double(double value) {
+    std::string result;
+    append_double(result, value);
+    return result;
+}
+
+std::string format_double(double value, int precision) {
+    if (precision < 0 || precision > 100) {
+        throw std::invalid_argument("Precision must be between 0 and 100");
+    }
+    // Sign, 309 integer digits of DBL_MAX, point and the decimals
+    std::string result;
+    append_chars(result,
+                 311 + static_cast<std::size_t>(precision),
+                 value,
+                 std::chars_format::fixed,
+                 precision);
+    return result;
+}
+
+void append_int(std::string& out, std::int64_t value) {
+    std::array<char, 20> buffer{};
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    out.append(buffer.data(), result.ptr);
+}
+
+void append_double(std::string& out, double value) {
+    append_chars(out, MaxShortestDouble, value);
+}
+
+} // namespace cpptemplate::utils
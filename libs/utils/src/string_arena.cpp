@@ -0,0 +1,33 @@
+#include "cpptemplate/utils/string_arena.hpp"
+
+#include <algorithm>
+
+namespace cpptemplate::utils {
+
+StringArena::StringArena(std::size_t initial_size)
+    : initial_(std::make_unique<std::byte[]>(std::max<std::size_t>(initial_size, 64))),
+      blocks_(initial_.get(), std::max<std::size_t>(initial_size, 64)) {}
+
+StringArena::~StringArena() = default;
+
+void StringArena::release() noexcept {
+    // Rewinds to the first block and returns the others upstream
+    blocks_.release();
+    bytes_used_ = 0;
+}
+
+void* StringArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* ptr = blocks_.allocate(bytes, alignment);
+    bytes_used_ += bytes;
+    return ptr;
+}
+
+void StringArena::do_deallocate(void*, std::size_t, std::size_t) {
+    // Freed all at once by release()
+}
+
+bool StringArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+} // namespace cpptemplate::utils
@@ -0,0 +1,165 @@
+#include "cpptemplate/utils/string_interner.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <memory_resource>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "cpptemplate/core/string_hash.hpp"
+
+namespace cpptemplate::utils {
+
+namespace {
+
+// Views live in blocks of BlockBase, 2 * BlockBase, 4 * BlockBase... entries,
+// so a shard never moves a view once written and readers need no lock
+constexpr std::size_t BlockBase = 64;
+constexpr std::size_t MaxBlocks = 27; // BlockBase * (2^27 - 1) > 2^32 views
+
+struct Slot {
+    std::size_t block;
+    std::size_t offset;
+};
+
+Slot slot_of(std::size_t index) noexcept {
+    const auto block = static_cast<std::size_t>(std::bit_width(index / BlockBase + 1)) - 1;
+    return {block, index - BlockBase * ((std::size_t{1} << block) - 1)};
+}
+
+/// String with its hash, computed once to pick both the shard and the bucket
+struct Key {
+    explicit Key(std::string_view s) noexcept : Key(s, core::detail::StringHash{}(s)) {}
+    Key(std::string_view s, std::size_t h) noexcept : str(s), hash(h) {}
+
+    /// Shard from the top bits of the hash; the map uses the low ones
+    [[nodiscard]] std::uint32_t shard(std::uint32_t shard_bits) const noexcept {
+        return shard_bits == 0 ? 0 : static_cast<std::uint32_t>(hash >> (sizeof(std::size_t) * 8 - shard_bits));
+    }
+
+    friend bool operator==(const Key& a, const Key& b) noexcept {
+        return a.hash == b.hash && a.str == b.str;
+    }
+
+    std::string_view str;
+    std::size_t hash;
+};
+
+struct KeyHash {
+    std::size_t operator()(const Key& key) const noexcept {
+        return key.hash;
+    }
+};
+
+} // namespace
+
+struct alignas(64) StringInterner::Shard {
+    ~Shard() {
+        for (auto& block : views) {
+            delete[] block.load(std::memory_order_relaxed);
+        }
+    }
+
+    mutable std::shared_mutex mutex;
+    /// Keys view the copies in chars; guarded by mutex
+    std::unordered_map<Key, Id, KeyHash> ids;
+    std::pmr::monotonic_buffer_resource chars{1024}; ///< Guarded by mutex
+    std::array<std::atomic<std::string_view*>, MaxBlocks> views{};
+    std::atomic<std::uint32_t> count{0}; ///< Views published so far
+    std::atomic<std::size_t> bytes{0};
+};
+
+StringInterner::StringInterner(std::size_t shards) {
+    const std::size_t count = std::bit_ceil(std::clamp<std::size_t>(shards, 1, 256));
+    shard_bits_ = static_cast<std::uint32_t>(std::countr_zero(count));
+    shards_ = std::make_unique<Shard[]>(count);
+}
+
+StringInterner::~StringInterner() = default;
+
+StringInterner::Id StringInterner::intern(std::string_view str) {
+    const Key key(str);
+    const std::uint32_t shard_index = key.shard(shard_bits_);
+    Shard& shard = shards_[shard_index];
+
+    {
+        const std::shared_lock lock(shard.mutex);
+        if (const auto it = shard.ids.find(key); it != shard.ids.end()) {
+            return it->second;
+        }
+    }
+
+    const std::unique_lock lock(shard.mutex);
+    if (const auto it = shard.ids.find(key); it != shard.ids.end()) {
+        return it->second; // Another thread added it first
+    }
+
+    const std::uint32_t index = shard.count.load(std::memory_order_relaxed);
+    if (std::uint64_t{index} >= (std::uint64_t{1} << (32 - shard_bits_))) {
+        throw std::length_error("String interner shard is full");
+    }
+
+    const auto [block, offset] = slot_of(index);
+    std::string_view* views = shard.views[block].load(std::memory_order_relaxed);
+    if (views == nullptr) {
+        views = new std::string_view[BlockBase << block];
+        shard.views[block].store(views, std::memory_order_relaxed);
+    }
+
+    std::string_view copy;
+    if (!str.empty()) {
+        auto* chars = static_cast<char*>(shard.chars.allocate(str.size(), 1));
+        str.copy(chars, str.size());
+        copy = {chars, str.size()};
+    }
+    const Id id = (index << shard_bits_) | shard_index;
+    shard.ids.emplace(Key(copy, key.hash), id);
+    views[offset] = copy;
+    shard.bytes.fetch_add(str.size(), std::memory_order_relaxed);
+    // Publishes the view and its block to view()
+    shard.count.store(index + 1, std::memory_order_release);
+    return id;
+}
+
+std::optional<StringInterner::Id> StringInterner::find(std::string_view str) const {
+    const Key key(str);
+    const Shard& shard = shards_[key.shard(shard_bits_)];
+    const std::shared_lock lock(shard.mutex);
+    if (const auto it = shard.ids.find(key); it != shard.ids.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::string_view StringInterner::view(Id id) const {
+    const Shard& shard = shards_[id & ((Id{1} << shard_bits_) - 1)];
+    const std::uint32_t index = id >> shard_bits_;
+    if (index >= shard.count.load(std::memory_order_acquire)) {
+        throw std::out_of_range("Unknown string ID " + std::to_string(id));
+    }
+    const auto [block, offset] = slot_of(index);
+    return shard.views[block].load(std::memory_order_relaxed)[offset];
+}
+
+std::size_t StringInterner::size() const noexcept {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < (std::size_t{1} << shard_bits_); ++i) {
+        total += shards_[i].count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::size_t StringInterner::storage_bytes() const noexcept {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < (std::size_t{1} << shard_bits_); ++i) {
+        total += shards_[i].bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+} // namespace cpptemplate::utils
@@ -0,0 +1,404 @@
+#include "string_kernels.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if CPPTEMPLATE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+#if CPPTEMPLATE_NEON_KERNELS
+    #include <arm_neon.h>
+#endif
+
+namespace cpptemplate::utils::detail {
+
+namespace {
+
+// Scalar kernels: plain loops the compiler vectorizes for the baseline ISA
+
+constexpr bool is_space(char c) noexcept {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+void to_upper_scalar(const char* in, char* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        const char c = in[i];
+        out[i] = (c >= 'a' && c <= 'z') ? static_cast<char>(c ^ 0x20) : c;
+    }
+}
+
+void to_lower_scalar(const char* in, char* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        const char c = in[i];
+        out[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c ^ 0x20) : c;
+    }
+}
+
+std::size_t skip_space_scalar(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    while (i < n && is_space(s[i])) {
+        ++i;
+    }
+    return i;
+}
+
+std::size_t skip_space_back_scalar(const char* s, std::size_t n) noexcept {
+    while (n > 0 && is_space(s[n - 1])) {
+        --n;
+    }
+    return n;
+}
+
+std::size_t find_byte_scalar(const char* s, std::size_t n, char c) noexcept {
+    // The C library's memchr is the best portable byte search there is
+    const void* found = n == 0 ? nullptr : std::memchr(s, c, n);
+    return found == nullptr ? n : static_cast<std::size_t>(static_cast<const char*>(found) - s);
+}
+
+// Decimals of at most 16 digits have a mantissa below 2^53 and at most 15
+// fraction digits, so mantissa and 10^fraction are exact doubles and one
+// correctly rounded division gives the correctly rounded value (Clinger's
+// fast path)
+constexpr double ExactPowersOf10[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                      1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+inline double scale_decimal(std::uint64_t mantissa, std::size_t fraction_digits) noexcept {
+    const auto value = static_cast<double>(mantissa);
+    return fraction_digits == 0 ? value : value / ExactPowersOf10[fraction_digits];
+}
+
+bool parse_decimal_scalar(const char* s, std::size_t n, double& out) noexcept {
+    std::uint64_t mantissa = 0;
+    std::size_t dot = n;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto digit = static_cast<unsigned char>(s[i] - '0');
+        if (digit <= 9) {
+            mantissa = mantissa * 10 + digit;
+        } else if (s[i] == '.' && dot == n) {
+            dot = i;
+        } else {
+            return false;
+        }
+    }
+    if (n == 1 && dot == 0) {
+        return false; // "." alone
+    }
+    out = scale_decimal(mantissa, dot == n ? 0 : n - dot - 1);
+    return true;
+}
+
+constexpr StringKernels ScalarKernels{
+    to_upper_scalar, to_lower_scalar, skip_space_scalar, skip_space_back_scalar, find_byte_scalar,
+    parse_decimal_scalar,
+};
+
+#if CPPTEMPLATE_X86_KERNELS
+
+// x86 kernels: one compare per character class and movemask to find lanes.
+// Ranges use the signed-compare trick: adding 0x80 - first maps
+// [first, first + width) onto the lowest signed byte values.
+
+CPPTEMPLATE_SSE42 inline __m128i in_range_sse(__m128i v, char first, int width) noexcept {
+    const __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - first)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + width)));
+}
+
+CPPTEMPLATE_SSE42 inline __m128i space_sse(__m128i v) noexcept {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), in_range_sse(v, '\t', 5));
+}
+
+/// Flip bit 5 of the bytes in [first, first + 26)
+CPPTEMPLATE_SSE42 void flip_case_sse(const char* in,
+                                     char* out,
+                                     std::size_t n,
+                                     char first) noexcept {
+    const __m128i bit = _mm_set1_epi8(0x20);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i flip = _mm_and_si128(in_range_sse(v, first, 26), bit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(v, flip));
+    }
+    (first == 'a' ? to_upper_scalar : to_lower_scalar)(in + i, out + i, n - i);
+}
+
+CPPTEMPLATE_SSE42 void to_upper_sse(const char* in, char* out, std::size_t n) noexcept {
+    flip_case_sse(in, out, n, 'a');
+}
+
+CPPTEMPLATE_SSE42 void to_lower_sse(const char* in, char* out, std::size_t n) noexcept {
+    flip_case_sse(in, out, n, 'A');
+}
+
+CPPTEMPLATE_SSE42 std::size_t skip_space_sse(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const auto other = static_cast<unsigned>(~_mm_movemask_epi8(space_sse(v))) & 0xFFFFU;
+        if (other != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(other));
+        }
+    }
+    return i + skip_space_scalar(s + i, n - i);
+}
+
+CPPTEMPLATE_SSE42 std::size_t skip_space_back_sse(const char* s, std::size_t n) noexcept {
+    for (; n >= 16; n -= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + n - 16));
+        const auto other = static_cast<unsigned>(~_mm_movemask_epi8(space_sse(v))) & 0xFFFFU;
+        if (other != 0) {
+            return n - 16 + static_cast<std::size_t>(std::bit_width(other));
+        }
+    }
+    return skip_space_back_scalar(s, n);
+}
+
+CPPTEMPLATE_SSE42 std::size_t find_byte_sse(const char* s, std::size_t n, char c) noexcept {
+    const __m128i needle = _mm_set1_epi8(c);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const auto hits = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+        if (hits != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(hits));
+        }
+    }
+    for (; i < n; ++i) {
+        if (s[i] == c) {
+            return i;
+        }
+    }
+    return n;
+}
+
+/// Validates all 16 lanes at once, drops the dot and right-aligns the digits
+/// with one shuffle, then sums them pairwise with multiply-adds
+CPPTEMPLATE_SSE42 bool parse_decimal_sse(const char* s, std::size_t n, double& out) noexcept {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i lane = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const auto field = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmplt_epi8(lane, _mm_set1_epi8(static_cast<char>(n)))));
+    const auto digits = static_cast<unsigned>(_mm_movemask_epi8(in_range_sse(v, '0', 10))) & field;
+    const auto dots =
+        static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('.')))) & field;
+    if ((digits | dots) != field || (dots & (dots - 1)) != 0 || digits == 0) {
+        return false;
+    }
+
+    const auto dot =
+        static_cast<int>(dots == 0 ? n : static_cast<std::size_t>(std::countr_zero(dots)));
+    const auto count = static_cast<int>(std::popcount(digits));
+    // Lane j takes digit k = j - (16 - count), which sits at byte k + (k >= dot);
+    // negative k has the top bit set, so the shuffle writes 0 there
+    const __m128i k = _mm_sub_epi8(lane, _mm_set1_epi8(static_cast<char>(16 - count)));
+    const __m128i source =
+        _mm_sub_epi8(k, _mm_cmpgt_epi8(k, _mm_set1_epi8(static_cast<char>(dot - 1))));
+    const __m128i aligned = _mm_shuffle_epi8(_mm_sub_epi8(v, _mm_set1_epi8('0')), source);
+
+    const __m128i pairs = _mm_maddubs_epi16(
+        aligned, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    const __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    const __m128i packed = _mm_packus_epi32(quads, quads);
+    const __m128i octets =
+        _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    const auto high = static_cast<std::uint32_t>(_mm_cvtsi128_si32(octets));
+    const auto low = static_cast<std::uint32_t>(_mm_extract_epi32(octets, 1));
+
+    out = scale_decimal(std::uint64_t{high} * 100000000U + low,
+                        dots == 0 ? 0 : n - static_cast<std::size_t>(dot) - 1);
+    return true;
+}
+
+constexpr StringKernels Sse42Kernels{
+    to_upper_sse,
+    to_lower_sse,
+    skip_space_sse,
+    skip_space_back_sse,
+    find_byte_sse,
+    parse_decimal_sse,
+};
+
+CPPTEMPLATE_AVX2 inline __m256i in_range_avx2(__m256i v, char first, int width) noexcept {
+    const __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(0x80 - first)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + width)), shifted);
+}
+
+CPPTEMPLATE_AVX2 inline __m256i space_avx2(__m256i v) noexcept {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), in_range_avx2(v, '\t', 5));
+}
+
+CPPTEMPLATE_AVX2 void flip_case_avx2(const char* in,
+                                     char* out,
+                                     std::size_t n,
+                                     char first) noexcept {
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i flip = _mm256_and_si256(in_range_avx2(v, first, 26), bit);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(v, flip));
+    }
+    flip_case_sse(in + i, out + i, n - i, first);
+}
+
+CPPTEMPLATE_AVX2 void to_upper_avx2(const char* in, char* out, std::size_t n) noexcept {
+    flip_case_avx2(in, out, n, 'a');
+}
+
+CPPTEMPLATE_AVX2 void to_lower_avx2(const char* in, char* out, std::size_t n) noexcept {
+    flip_case_avx2(in, out, n, 'A');
+}
+
+CPPTEMPLATE_AVX2 std::size_t skip_space_avx2(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const auto other = ~static_cast<unsigned>(_mm256_movemask_epi8(space_avx2(v)));
+        if (other != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(other));
+        }
+    }
+    return i + skip_space_sse(s + i, n - i);
+}
+
+CPPTEMPLATE_AVX2 std::size_t skip_space_back_avx2(const char* s, std::size_t n) noexcept {
+    for (; n >= 32; n -= 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + n - 32));
+        const auto other = ~static_cast<unsigned>(_mm256_movemask_epi8(space_avx2(v)));
+        if (other != 0) {
+            return n - 32 + static_cast<std::size_t>(std::bit_width(other));
+        }
+    }
+    return skip_space_back_sse(s, n);
+}
+
+CPPTEMPLATE_AVX2 std::size_t find_byte_avx2(const char* s, std::size_t n, char c) noexcept {
+    const __m256i needle = _mm256_set1_epi8(c);
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const auto hits = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+        if (hits != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(hits));
+        }
+    }
+    return i + find_byte_sse(s + i, n - i, c);
+}
+
+// A field fits one 16-byte lane, so AVX2 reuses the SSE decimal parser
+constexpr StringKernels Avx2Kernels{
+    to_upper_avx2,
+    to_lower_avx2,
+    skip_space_avx2,
+    skip_space_back_avx2,
+    find_byte_avx2,
+    parse_decimal_sse,
+};
+
+#endif // CPPTEMPLATE_X86_KERNELS
+
+#if CPPTEMPLATE_NEON_KERNELS
+
+// NEON has no movemask; narrowing each 16-bit pair by 4 bits packs the
+// compare result into 64 bits, 4 per byte
+
+inline std::uint64_t nibble_mask(uint8x16_t bytes) noexcept {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(bytes), 4)), 0);
+}
+
+inline const std::uint8_t* bytes(const char* s) noexcept {
+    return reinterpret_cast<const std::uint8_t*>(s);
+}
+
+inline uint8x16_t space_neon(uint8x16_t v) noexcept {
+    return vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),
+                    vcleq_u8(vsubq_u8(v, vdupq_n_u8('\t')), vdupq_n_u8(4)));
+}
+
+void flip_case_neon(const char* in, char* out, std::size_t n, char first) noexcept {
+    const uint8x16_t base = vdupq_n_u8(static_cast<std::uint8_t>(first));
+    const uint8x16_t bit = vdupq_n_u8(0x20);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint8x16_t v = vld1q_u8(bytes(in + i));
+        const uint8x16_t letter = vcleq_u8(vsubq_u8(v, base), vdupq_n_u8(25));
+        vst1q_u8(reinterpret_cast<std::uint8_t*>(out + i), veorq_u8(v, vandq_u8(letter, bit)));
+    }
+    (first == 'a' ? to_upper_scalar : to_lower_scalar)(in + i, out + i, n - i);
+}
+
+void to_upper_neon(const char* in, char* out, std::size_t n) noexcept {
+    flip_case_neon(in, out, n, 'a');
+}
+
+void to_lower_neon(const char* in, char* out, std::size_t n) noexcept {
+    flip_case_neon(in, out, n, 'A');
+}
+
+std::size_t skip_space_neon(const char* s, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const std::uint64_t other = nibble_mask(vmvnq_u8(space_neon(vld1q_u8(bytes(s + i)))));
+        if (other != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(other)) / 4;
+        }
+    }
+    return i + skip_space_scalar(s + i, n - i);
+}
+
+std::size_t skip_space_back_neon(const char* s, std::size_t n) noexcept {
+    for (; n >= 16; n -= 16) {
+        const std::uint64_t other = nibble_mask(vmvnq_u8(space_neon(vld1q_u8(bytes(s + n - 16)))));
+        if (other != 0) {
+            return n - 16 + static_cast<std::size_t>(std::bit_width(other) + 3) / 4;
+        }
+    }
+    return skip_space_back_scalar(s, n);
+}
+
+std::size_t find_byte_neon(const char* s, std::size_t n, char c) noexcept {
+    const uint8x16_t needle = vdupq_n_u8(static_cast<std::uint8_t>(c));
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const std::uint64_t hits = nibble_mask(vceqq_u8(vld1q_u8(bytes(s + i)), needle));
+        if (hits != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(hits)) / 4;
+        }
+    }
+    for (; i < n; ++i) {
+        if (s[i] == c) {
+            return i;
+        }
+    }
+    return n;
+}
+
+constexpr StringKernels NeonKernels{
+    to_upper_neon,
+    to_lower_neon,
+    skip_space_neon,
+    skip_space_back_neon,
+    find_byte_neon,
+    parse_decimal_scalar,
+};
+
+#endif // CPPTEMPLATE_NEON_KERNELS
+
+} // namespace
+
+const StringKernels& string_kernels(core::SimdLevel level) noexcept {
+    switch (level) {
+#if CPPTEMPLATE_X86_KERNELS
+        case core::SimdLevel::Avx512:
+        case core::SimdLevel::Avx2: return Avx2Kernels;
+        case core::SimdLevel::Sse42: return Sse42Kernels;
+#endif
+#if CPPTEMPLATE_NEON_KERNELS
+        case core::SimdLevel::Neon: return NeonKernels;
+#endif
+        default: return ScalarKernels;
+    }
+}
+
+} // namespace cpptemplate::utils::detail
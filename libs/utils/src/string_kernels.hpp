@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+#include "cpptemplate/core/simd.hpp"
+
+namespace cpptemplate::utils::detail {
+
+/**
+ * @brief Byte-string kernels for one SimdLevel
+ *
+ * Character classes are ASCII, matching the "C" locale: whitespace is
+ * ' ', '\t', '\n', '\v', '\f' and '\r', and case folding only changes
+ * 'a'-'z' and 'A'-'Z'. Bytes of 0x80 and above are never altered.
+ */
+struct StringKernels {
+    /// out[i] = upper-case in[i]; in and out may be the same pointer
+    void (*to_upper)(const char* in, char* out, std::size_t n) noexcept;
+    /// out[i] = lower-case in[i]; in and out may be the same pointer
+    void (*to_lower)(const char* in, char* out, std::size_t n) noexcept;
+    /// Index of the first non-whitespace byte, n if there is none
+    std::size_t (*skip_space)(const char* s, std::size_t n) noexcept;
+    /// Length left after dropping trailing whitespace
+    std::size_t (*skip_space_back)(const char* s, std::size_t n) noexcept;
+    /// Index of the first byte equal to c, n if there is none
+    std::size_t (*find_byte)(const char* s, std::size_t n, char c) noexcept;
+    /**
+     * Exact value of s[0, n) if it is decimal digits with at most one '.'
+     * (and at least one digit); false for anything else. Requires
+     * 1 <= n <= 16 and 16 readable bytes at s.
+     */
+    bool (*parse_decimal)(const char* s, std::size_t n, double& out) noexcept;
+};
+
+/**
+ * @brief Get the kernels of a level
+ * @param level Level, which must be supported by the running CPU
+ * @return Kernel table with static storage duration
+ */
+const StringKernels& string_kernels(core::SimdLevel level) noexcept;
+
+/**
+ * @brief Get the kernels of the active level
+ * @return Kernel table for core::simd_level()
+ */
+inline const StringKernels& string_kernels() noexcept {
+    return string_kernels(core::simd_level());
+}
+
+} // namespace cpptemplate::utils::detail
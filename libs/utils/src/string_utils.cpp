@@ -1,80 +1,198 @@
 #include "cpptemplate/utils/string_utils.hpp"
 
 #include <algorithm>
-#include <cctype>
-#include <sstream>
+#include <queue>
+#include <stdexcept>
+
+#include "string_kernels.hpp"
 
 namespace cpptemplate::utils {
 
+namespace {
+
+/// join() for any string type, appending to result
+template<typename Strings, typename String>
+String join_into(const Strings& strings, std::string_view delimiter, String result) {
+    if (strings.empty()) {
+        return result;
+    }
+
+    std::size_t size = delimiter.size() * (strings.size() - 1);
+    for (const auto& str : strings) {
+        size += str.size();
+    }
+
+    result.reserve(size);
+    result += strings.front();
+    for (auto it = strings.begin() + 1; it != strings.end(); ++it) {
+        result += delimiter;
+        result += *it;
+    }
+    return result;
+}
+
+/// replace_all() for any string type, allocating a new result from str's allocator
+template<typename String>
+String replace_all_in(String str, std::string_view from, std::string_view to) {
+    if (from.empty()) {
+        return str;
+    }
+
+    std::size_t pos = str.find(from);
+    if (pos == String::npos) {
+        return str;
+    }
+
+    // Not growing: compact in place, writing behind the read position
+    if (to.size() <= from.size()) {
+        char* data = str.data();
+        std::size_t write = pos;
+        do {
+            write += to.copy(data + write, to.size());
+            const std::size_t read = pos + from.size();
+            pos = str.find(from, read);
+            const std::size_t end = pos == String::npos ? str.size() : pos;
+            if (write != read) {
+                std::char_traits<char>::move(data + write, data + read, end - read);
+            }
+            write += end - read;
+        } while (pos != String::npos);
+        str.resize(write);
+        return str;
+    }
+
+    // Growing: copy the runs between matches into a new string
+    String result(str.get_allocator());
+    result.reserve(str.size() + str.size() / 2);
+    std::size_t copied = 0;
+    do {
+        result.append(str, copied, pos - copied);
+        result += to;
+        copied = pos + from.size();
+        pos = str.find(from, copied);
+    } while (pos != String::npos);
+    result.append(str, copied);
+    return result;
+}
+
+} // namespace
+
 std::string trim(std::string_view str) {
-    return ltrim(rtrim(str));
+    return std::string(trim_view(str));
 }
 
 std::string ltrim(std::string_view str) {
-    auto start = std::find_if_not(str.begin(), str.end(), 
-                                  [](unsigned char ch) { return std::isspace(ch); });
-    return std::string(start, str.end());
+    return std::string(ltrim_view(str));
 }
 
 std::string rtrim(std::string_view str) {
-    auto end = std::find_if_not(str.rbegin(), str.rend(),
-                                [](unsigned char ch) { return std::isspace(ch); }).base();
-    return std::string(str.begin(), end);
+    return std::string(rtrim_view(str));
+}
+
+std::pmr::string trim(std::string_view str, std::pmr::memory_resource* resource) {
+    return std::pmr::string(trim_view(str), resource);
+}
+
+std::pmr::string ltrim(std::string_view str, std::pmr::memory_resource* resource) {
+    return std::pmr::string(ltrim_view(str), resource);
+}
+
+std::pmr::string rtrim(std::string_view str, std::pmr::memory_resource* resource) {
+    return std::pmr::string(rtrim_view(str), resource);
+}
+
+std::string_view trim_view(std::string_view str) noexcept {
+    const auto& kernels = detail::string_kernels();
+    const std::size_t end = kernels.skip_space_back(str.data(), str.size());
+    const std::size_t begin = kernels.skip_space(str.data(), end);
+    return str.substr(begin, end - begin);
+}
+
+std::string_view ltrim_view(std::string_view str) noexcept {
+    return str.substr(detail::string_kernels().skip_space(str.data(), str.size()));
+}
+
+std::string_view rtrim_view(std::string_view str) noexcept {
+    return str.substr(0, detail::string_kernels().skip_space_back(str.data(), str.size()));
 }
 
 std::string to_upper(std::string_view str) {
-    std::string result;
-    result.reserve(str.size());
-    std::transform(str.begin(), str.end(), std::back_inserter(result),
-                   [](unsigned char ch) { return std::toupper(ch); });
+    std::string result(str.size(), '\0');
+    detail::string_kernels().to_upper(str.data(), result.data(), str.size());
     return result;
 }
 
 std::string to_lower(std::string_view str) {
-    std::string result;
-    result.reserve(str.size());
-    std::transform(str.begin(), str.end(), std::back_inserter(result),
-                   [](unsigned char ch) { return std::tolower(ch); });
+    std::string result(str.size(), '\0');
+    detail::string_kernels().to_lower(str.data(), result.data(), str.size());
+    return result;
+}
+
+std::pmr::string to_upper(std::string_view str, std::pmr::memory_resource* resource) {
+    std::pmr::string result(str.size(), '\0', resource);
+    detail::string_kernels().to_upper(str.data(), result.data(), str.size());
+    return result;
+}
+
+std::pmr::string to_lower(std::string_view str, std::pmr::memory_resource* resource) {
+    std::pmr::string result(str.size(), '\0', resource);
+    detail::string_kernels().to_lower(str.data(), result.data(), str.size());
     return result;
 }
 
 std::vector<std::string> split(std::string_view str, char delimiter) {
     std::vector<std::string> tokens;
-    std::string token;
-    
-    for (char ch : str) {
-        if (ch == delimiter) {
-            if (!token.empty()) {
-                tokens.push_back(std::move(token));
-                token.clear();
-            }
-        } else {
-            token += ch;
-        }
+    for (const std::string_view token : Tokenizer(str, delimiter)) {
+        tokens.emplace_back(token);
     }
-    
-    if (!token.empty()) {
-        tokens.push_back(std::move(token));
+    return tokens;
+}
+
+std::pmr::vector<std::pmr::string> split(std::string_view str,
+                                         char delimiter,
+                                         std::pmr::memory_resource* resource) {
+    std::pmr::vector<std::pmr::string> tokens(resource);
+    for (const std::string_view token : Tokenizer(str, delimiter)) {
+        tokens.emplace_back(token); // Uses-allocator construction: the string shares resource
     }
-    
     return tokens;
 }
 
-std::string join(const std::vector<std::string>& strings, std::string_view delimiter) {
-    if (strings.empty()) {
-        return {};
+std::vector<std::string_view> split_view(std::string_view str, char delimiter) {
+    std::vector<std::string_view> tokens;
+    split(str, delimiter, tokens);
+    return tokens;
+}
+
+std::size_t split(std::string_view str, char delimiter, std::vector<std::string_view>& out) {
+    out.clear();
+    for (const std::string_view token : Tokenizer(str, delimiter)) {
+        out.push_back(token);
     }
-    
-    std::ostringstream oss;
-    auto it = strings.begin();
-    oss << *it;
-    ++it;
-    
-    for (; it != strings.end(); ++it) {
-        oss << delimiter << *it;
+    return out.size();
+}
+
+std::string_view Tokenizer::next(std::string_view str, char delimiter, std::size_t& pos) noexcept {
+    const auto find_byte = detail::string_kernels().find_byte;
+    while (pos < str.size()) {
+        const std::size_t begin = pos;
+        pos += find_byte(str.data() + pos, str.size() - pos, delimiter);
+        if (pos > begin) {
+            return str.substr(begin, pos - begin);
+        }
+        ++pos; // Empty token: step over the delimiter
     }
-    
-    return oss.str();
+    pos = End;
+    return {};
+}
+
+std::string join(const std::vector<std::string>& strings, std::string_view delimiter) {
+    return join_into(strings, delimiter, std::string());
+}
+
+std::pmr::string join(const std::pmr::vector<std::pmr::string>& strings, std::string_view delimiter,
+                      std::pmr::memory_resource* resource) {
+    return join_into(strings, delimiter, std::pmr::string(resource));
 }
 
 bool starts_with(std::string_view str, std::string_view prefix) {
@@ -88,17 +206,147 @@ bool ends_with(std::string_view str, std::string_view suffix) {
 }
 
 std::string replace_all(std::string str, std::string_view from, std::string_view to) {
-    if (from.empty()) {
-        return str;
+    return replace_all_in(std::move(str), from, to);
+}
+
+std::pmr::string replace_all(std::string_view str, std::string_view from, std::string_view to,
+                             std::pmr::memory_resource* resource) {
+    return replace_all_in(std::pmr::string(str, resource), from, to);
+}
+
+MultiReplacer::MultiReplacer(const std::vector<std::pair<std::string, std::string>>& replacements) {
+    for (const auto& [pattern, replacement] : replacements) {
+        if (pattern.empty()) {
+            throw std::invalid_argument("Replacement patterns must not be empty");
+        }
+        for (const char ch : pattern) {
+            auto& column = classes_[static_cast<unsigned char>(ch)];
+            if (column == 0) {
+                column = static_cast<std::uint16_t>(columns_++);
+            }
+        }
+        starts_[static_cast<unsigned char>(pattern.front())] = true;
     }
-    
-    size_t pos = 0;
-    while ((pos = str.find(from, pos)) != std::string::npos) {
-        str.replace(pos, from.length(), to);
-        pos += to.length();
+    stride_ = columns_ + 2;
+
+    // Trie of the patterns, as rows of stride_ words: the transitions, then
+    // Output and Depth. States are row offsets; 0 is both the root and "no
+    // transition yet".
+    auto add_state = [this](std::uint32_t depth) {
+        const auto row = static_cast<State>(table_.size());
+        table_.resize(table_.size() + stride_, 0);
+        table_[row + columns_ + Depth] = depth;
+        return row;
+    };
+    add_state(0);
+    for (const auto& [pattern, replacement] : replacements) {
+        State state = 0;
+        for (const char ch : pattern) {
+            const std::size_t edge = state + classes_[static_cast<unsigned char>(ch)];
+            if (table_[edge] == 0) {
+                const State child = add_state(table_[state + columns_ + Depth] + 1);
+                table_[edge] = child;
+            }
+            state = table_[edge];
+        }
+        if (table_[state + columns_ + Output] == 0) {
+            lengths_.push_back(static_cast<std::uint32_t>(pattern.size()));
+            replacements_.push_back(replacement);
+            table_[state + columns_ + Output] = static_cast<State>(replacements_.size());
+        }
     }
-    
-    return str;
+
+    // Breadth-first, fill in the missing transitions from the failure state
+    // (the longest proper suffix also in the trie), turning the trie into a
+    // DFA. A state's output falls back to its failure state's, which is the
+    // longest pattern that is a proper suffix.
+    std::vector<State> fail(table_.size() / stride_, 0);
+    std::queue<State> pending;
+    for (std::size_t column = 0; column < columns_; ++column) {
+        if (const State child = table_[column]; child != 0) {
+            pending.push(child);
+        }
+    }
+    while (!pending.empty()) {
+        const State state = pending.front();
+        const State failure = fail[state / stride_];
+        pending.pop();
+        if (table_[state + columns_ + Output] == 0) {
+            table_[state + columns_ + Output] = table_[failure + columns_ + Output];
+        }
+        for (std::size_t column = 0; column < columns_; ++column) {
+            State& target = table_[state + column];
+            const State fallback = table_[failure + column];
+            if (target != 0) {
+                fail[target / stride_] = fallback;
+                pending.push(target);
+            } else {
+                target = fallback;
+            }
+        }
+    }
+}
+
+std::string MultiReplacer::replace(std::string_view str) const {
+    std::string result;
+    result.reserve(str.size());
+
+    const auto* bytes = reinterpret_cast<const unsigned char*>(str.data());
+    const State* table = table_.data();
+    const std::size_t n = str.size();
+    std::size_t copied = 0;
+    std::size_t pos = 0;
+    State state = 0;
+    // Leftmost-longest match seen so far but not yet replaced, 1-based
+    State match = 0;
+    std::size_t match_begin = 0;
+
+    while (true) {
+        if (match != 0) {
+            // Every match still to come starts at or after the start of the
+            // current state's prefix, so once that is past match_begin (or the
+            // input has ended) the candidate is final. Scanning resumes after
+            // it, from the root.
+            if (pos == n || pos - table[state + columns_ + Depth] > match_begin) {
+                result.append(str.substr(copied, match_begin - copied));
+                result += replacements_[match - 1];
+                copied = match_begin + lengths_[match - 1];
+                pos = copied;
+                state = 0;
+                match = 0;
+            }
+        }
+        if (state == 0) {
+            // Nothing pending: skip bytes no pattern starts with
+            while (pos < n && !starts_[bytes[pos]]) {
+                ++pos;
+            }
+        }
+        if (pos == n) {
+            break;
+        }
+
+        state = table[state + classes_[bytes[pos]]];
+        ++pos;
+
+        // The longest pattern ending here starts earliest; a later end with
+        // the same start is a longer match
+        if (const State found = table[state + columns_ + Output]; found != 0) {
+            const std::size_t begin = pos - lengths_[found - 1];
+            if (match == 0 || begin <= match_begin) {
+                match = found;
+                match_begin = begin;
+            }
+        }
+    }
+
+    result.append(str.substr(copied));
+    return result;
+}
+
+std::string replace_all(std::string_view str,
+                        const std::vector<std::pair<std::string, std::string>>& replacements) {
+    return MultiReplacer(replacements).replace(str);
 }
 
-} // namespace cpptemplate::utils
\ No newline at end of file
+} // namespace cpptemplate::utils
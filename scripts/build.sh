@@ -20,6 +20,7 @@ BUILD_NETWORK_LIB="ON"
 BUILD_MAIN_APP="ON"
 BUILD_CLI_APP="ON"
 BUILD_SERVER_APP="ON"
+BUILD_LOG_DECODER_APP="ON"
 
 # Function to show usage
 show_help() {
@@ -50,6 +51,7 @@ OPTIONS:
     --disable-main         Disable main application
     --disable-cli          Disable CLI application
     --disable-server       Disable server application
+    --disable-log-decoder  Disable binary log decoder
 
 Examples:
     $0                                  # Release build with tests
@@ -146,6 +148,10 @@ while [[ $# -gt 0 ]]; do
             BUILD_SERVER_APP="OFF"
             shift
             ;;
+        --disable-log-decoder)
+            BUILD_LOG_DECODER_APP="OFF"
+            shift
+            ;;
         *)
             echo "Unknown option: $1"
             show_help
@@ -202,7 +208,8 @@ cmake -B "$BUILD_DIR" \
     -DBUILD_NETWORK_LIB="$BUILD_NETWORK_LIB" \
     -DBUILD_MAIN_APP="$BUILD_MAIN_APP" \
     -DBUILD_CLI_APP="$BUILD_CLI_APP" \
-    -DBUILD_SERVER_APP="$BUILD_SERVER_APP"
+    -DBUILD_SERVER_APP="$BUILD_SERVER_APP" \
+    -DBUILD_LOG_DECODER_APP="$BUILD_LOG_DECODER_APP"
 
 # Build
 echo "Building..."
@@ -228,7 +235,7 @@ echo "========================================"
 
 # Show executable locations
 echo "Built applications:"
-for app in cpp_template_main cpp_template_cli cpp_template_server; do
+for app in cpp_template_main cpp_template_cli cpp_template_server cpp_template_log_decoder; do
     if [[ -f "$BUILD_DIR/bin/$app" ]]; then
         echo "  $app: $BUILD_DIR/bin/$app"
     elif [[ -f "$BUILD_DIR/bin/$app.exe" ]]; then
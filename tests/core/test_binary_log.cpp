@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "cpptemplate/core/binary_log.hpp"
+#include "cpptemplate/core/exception.hpp"
+#include "cpptemplate/core/logger.hpp"
+
+using namespace cpptemplate::core;
+
+namespace {
+
+template<typename... Args>
+std::string round_trip(std::string_view format, const Args&... args) {
+    std::vector<std::byte> payload((std::size_t{0} + ... + detail::encoded_size(args)));
+    std::byte* out = payload.data();
+    ((out = detail::encode(out, args)), ...);
+
+    spdlog::memory_buf_t text;
+    detail::format_payload(format, detail::ArgTypes<Args...>, payload.data(), text);
+    return std::string(text.data(), text.size());
+}
+
+} // namespace
+
+class BinaryLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::filesystem::create_directories("logs");
+    }
+};
+
+TEST_F(BinaryLogTest, RoundTripArithmeticArguments) {
+    EXPECT_EQ(round_trip("{} {} {} {}", 42, -7LL, 3.5, true), "42 -7 3.5 true");
+    EXPECT_EQ(round_trip("{:x} {:.2f} {}", 255u, 2.0f, 'z'), "ff 2.00 z");
+    EXPECT_EQ(round_trip("{} {}", static_cast<std::int8_t>(-3), static_cast<std::uint16_t>(9)),
+              "-3 9");
+}
+
+TEST_F(BinaryLogTest, RoundTripStringArguments) {
+    const std::string owned = "owned";
+    const std::string_view view = "view";
+    const char* c_string = "c-string";
+
+    EXPECT_EQ(round_trip("{}|{}|{}|{}", owned, view, c_string, "literal"),
+              "owned|view|c-string|literal");
+    EXPECT_EQ(round_trip("[{:>6}]", std::string_view{}), "[      ]");
+}
+
+TEST_F(BinaryLogTest, NullCStringIsCapturedAsMarker) {
+    const char* missing = nullptr;
+
+    EXPECT_EQ(detail::encoded_size(missing), sizeof(std::uint32_t) + 6);
+    EXPECT_EQ(round_trip("[{}]", missing), "[(null)]");
+}
+
+TEST_F(BinaryLogTest, DeferredFormatAcceptsOnlyLiterals) {
+    // The record keeps a pointer to the format text, so runtime strings must not convert
+    static_assert(std::is_constructible_v<DeferredFormat<int>, const char (&)[3]>);
+    static_assert(!std::is_constructible_v<DeferredFormat<int>, std::string>);
+    static_assert(!std::is_constructible_v<DeferredFormat<int>, std::string_view>);
+    static_assert(!std::is_constructible_v<DeferredFormat<int>, const char*>);
+    static_assert(!std::is_constructible_v<DeferredFormat<int>,
+                                           decltype(fmt::runtime(std::string{}))>);
+
+    constexpr DeferredFormat<int, double> format("{} and {:.1f}");
+    EXPECT_EQ(format.get(), "{} and {:.1f}");
+}
+
+TEST_F(BinaryLogTest, RoundTripMatchesEagerFormatting) {
+    const void* pointer = this;
+    EXPECT_EQ(round_trip("{}", pointer), fmt::format("{}", pointer));
+    EXPECT_EQ(round_trip("{:08.3f}", 3.14159), fmt::format("{:08.3f}", 3.14159));
+}
+
+TEST_F(BinaryLogTest, DeferredLoggingThroughLogger) {
+    auto logger = Logger::create("DeferredLogger", {.level = spdlog::level::debug});
+    
+    for (int i = 0; i < 1000; ++i) {
+        logger->log_deferred(spdlog::level::debug, "Deferred {} of {}: {}", i, 1000, "payload");
+    }
+    logger->flush();
+    
+    EXPECT_EQ(BinaryLog::dropped(), 0u);
+}
+
+TEST_F(BinaryLogTest, DeferredLoggingSkipsDisabledLevels) {
+    auto logger = Logger::create("DeferredDisabled");
+    logger->set_level(spdlog::level::warn);
+    
+    // Nothing is captured below the logger level
+    logger->log_deferred(spdlog::level::debug, "Skipped {}", 1);
+    logger->log_deferred(spdlog::level::err, "Kept {}", 2);
+    logger->flush();
+}
+
+TEST_F(BinaryLogTest, DecodeRejectsInvalidInput) {
+    std::istringstream not_a_log("definitely not a binary log");
+    std::ostringstream output;
+    
+    EXPECT_THROW(static_cast<void>(BinaryLog::decode(not_a_log, output)), Exception);
+}
+
+TEST_F(BinaryLogTest, DecodeEmptyLog) {
+    std::istringstream empty_log(std::string("CTBLOG1\n"));
+    std::ostringstream output;
+    
+    EXPECT_EQ(BinaryLog::decode(empty_log, output), 0u);
+    EXPECT_TRUE(output.str().empty());
+}
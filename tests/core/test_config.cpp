@@ -1 +1,183 @@
-// Stub test file
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cpptemplate/core/config.hpp"
+#include "cpptemplate/core/exception.hpp"
+
+using namespace cpptemplate::core;
+
+namespace {
+
+constexpr const char* SampleConfig = R"(
+# Sample configuration
+name = sample app
+debug = yes
+
+[server]
+port = 8080
+timeout = 2.5   ; seconds
+greeting = "hello \"world\""
+
+[server.http]
+keep_alive = off
+)";
+
+} // namespace
+
+class ConfigTest : public ::testing::Test {
+protected:
+    Config config;
+};
+
+TEST_F(ConfigTest, EmptyByDefault) {
+    EXPECT_EQ(config.size(), 0u);
+    EXPECT_EQ(config.version(), 0u);
+    EXPECT_FALSE(config.contains("server.port"));
+    EXPECT_FALSE(config.get<std::int64_t>("server.port").has_value());
+}
+
+TEST_F(ConfigTest, ParsesSectionsAndTypes) {
+    config.load_string(SampleConfig);
+
+    EXPECT_EQ(config.size(), 6u);
+    EXPECT_EQ(config.version(), 1u);
+    EXPECT_EQ(config.get<std::string>("name"), "sample app");
+    EXPECT_EQ(config.get<bool>("debug"), true);
+    EXPECT_EQ(config.get<std::int64_t>("server.port"), 8080);
+    EXPECT_EQ(config.get<double>("server.port"), 8080.0);
+    EXPECT_EQ(config.get<double>("server.timeout"), 2.5);
+    EXPECT_EQ(config.get<std::string>("server.greeting"), "hello \"world\"");
+    EXPECT_EQ(config.get<bool>("server.http.keep_alive"), false);
+}
+
+TEST_F(ConfigTest, TypeMismatchReturnsNullopt) {
+    config.load_string(SampleConfig);
+
+    EXPECT_FALSE(config.get<std::int64_t>("server.timeout").has_value());
+    EXPECT_FALSE(config.get<bool>("server.port").has_value());
+    EXPECT_FALSE(config.get<std::int64_t>("name").has_value());
+    // Every present value can be read as its text
+    EXPECT_EQ(config.get<std::string>("server.port"), "8080");
+}
+
+TEST_F(ConfigTest, HandlesReadCurrentSnapshot) {
+    auto port = config.handle<std::int64_t>("server.port");
+    auto host = config.handle<std::string>("server.host");
+    EXPECT_EQ(port.key(), "server.port");
+    EXPECT_FALSE(port.get().has_value());
+    EXPECT_EQ(port.value_or(80), 80);
+
+    config.load_string(SampleConfig);
+    EXPECT_EQ(port.get(), 8080);
+    EXPECT_EQ(host.value_or("localhost"), "localhost");
+
+    config.load_string("[server]\nport = 9090\nhost = example.com\n");
+    EXPECT_EQ(port.get(), 9090);
+    EXPECT_EQ(host.get(), "example.com");
+    EXPECT_FALSE(config.contains("name"));
+}
+
+TEST_F(ConfigTest, ParseErrorsReportLineAndKeepSnapshot) {
+    config.load_string("port = 1\n");
+
+    const std::vector<std::string> invalid{
+        "[server\nport = 2\n",
+        "port 2\n",
+        "bad key = 2\n",
+        "port = 1\nport = 2\n",
+        "name = \"unterminated\n",
+        "name = \"bad \\q escape\"\n",
+        "name = \"value\" trailing\n",
+    };
+    for (const auto& text : invalid) {
+        EXPECT_THROW(config.load_string(text), Exception) << text;
+    }
+    EXPECT_EQ(config.get<std::int64_t>("port"), 1);
+
+    try {
+        config.load_string("a = 1\n\n[b]\nc\n");
+        FAIL() << "Expected Exception";
+    } catch (const Exception& ex) {
+        EXPECT_NE(std::string(ex.what()).find("line 4"), std::string::npos) << ex.what();
+    }
+}
+
+TEST_F(ConfigTest, ReloadWithoutFileThrows) {
+    EXPECT_THROW(config.reload(), Exception);
+    EXPECT_THROW(config.watch(), Exception);
+    EXPECT_THROW(config.load_file("does/not/exist.ini"), Exception);
+}
+
+TEST_F(ConfigTest, ConcurrentReadsDuringReloads) {
+    auto value = config.handle<std::int64_t>("value");
+    auto label = config.handle<std::string>("label");
+    config.load_string("value = 0\nlabel = v0\n");
+
+    std::atomic<bool> stop{false};
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto number = value.get();
+                const auto text = label.get();
+                if (!number || !text || text->front() != 'v') {
+                    failed = true;
+                }
+            }
+        });
+    }
+
+    for (int i = 1; i <= 2000; ++i) {
+        config.load_string("value = " + std::to_string(i) + "\nlabel = v" + std::to_string(i) +
+                           "\n");
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_FALSE(failed);
+    EXPECT_EQ(value.get(), 2000);
+}
+
+#if defined(__linux__)
+TEST_F(ConfigTest, WatchReloadsOnFileChange) {
+    const auto directory = std::filesystem::temp_directory_path() / "cpptemplate_config_watch";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto path = directory / "app.ini";
+    std::ofstream(path) << "port = 1\n";
+
+    config.load_file(path);
+    auto port = config.handle<std::int64_t>("port");
+    config.watch();
+
+    // Replace by rename, like most editors do
+    std::ofstream(directory / "app.ini.tmp") << "port = 2\n";
+    std::filesystem::rename(directory / "app.ini.tmp", path);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (port.get() != 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(port.get(), 2);
+
+    // A broken edit keeps the previous snapshot and reports the error
+    std::ofstream(path) << "port\n";
+    while (config.last_error().empty() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_FALSE(config.last_error().empty());
+    EXPECT_EQ(port.get(), 2);
+
+    config.stop_watching();
+    std::filesystem::remove_all(directory);
+}
+#endif
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "cpptemplate/core/exception.hpp"
+#include "cpptemplate/core/expected.hpp"
+
+using namespace cpptemplate::core;
+
+namespace {
+
+enum class NetErrc { Timeout = 1 };
+
+class NetCategory final : public ErrorCategory {
+public:
+    std::string_view name() const noexcept override {
+        return "net";
+    }
+
+    std::string_view message(int) const noexcept override {
+        return "Timed out";
+    }
+};
+
+Error make_error(NetErrc code) noexcept {
+    static const NetCategory category;
+    return Error(static_cast<int>(code), category);
+}
+
+Expected<int> parse_digit(char c) {
+    if (c < '0' || c > '9') {
+        return unexpected(Errc::ParseError);
+    }
+    return c - '0';
+}
+
+} // namespace
+
+static_assert(std::is_trivially_copyable_v<Error>);
+static_assert(std::is_trivially_copyable_v<Expected<double>>);
+static_assert(sizeof(Expected<double>) <= 3 * sizeof(void*));
+
+TEST(ExpectedTest, HoldsValue) {
+    const auto result = parse_digit('7');
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, 7);
+    EXPECT_EQ(result.value(), 7);
+    EXPECT_EQ(result.value_or(0), 7);
+}
+
+TEST(ExpectedTest, HoldsError) {
+    const auto result = parse_digit('x');
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), Errc::ParseError);
+    EXPECT_EQ(result.error().category().name(), "core");
+    EXPECT_EQ(result.error().message(), "Parse error");
+    EXPECT_EQ(result.value_or(-1), -1);
+    EXPECT_THROW(static_cast<void>(result.value()), Exception);
+}
+
+TEST(ExpectedTest, ErrorsCompareByCategory) {
+    const Error timeout = NetErrc::Timeout;
+    EXPECT_EQ(timeout, NetErrc::Timeout);
+    EXPECT_EQ(timeout.code(), static_cast<int>(Errc::InvalidArgument));
+    EXPECT_NE(timeout, Error(Errc::InvalidArgument));
+    EXPECT_EQ(timeout.message(), "Timed out");
+}
+
+TEST(ExpectedTest, AndThenAndTransform) {
+    const auto doubled = parse_digit('4').transform([](int v) { return v * 2.0; });
+    static_assert(std::is_same_v<std::remove_const_t<decltype(doubled)>, Expected<double>>);
+    EXPECT_DOUBLE_EQ(doubled.value(), 8.0);
+
+    const auto chained = parse_digit('4').and_then([](int) { return parse_digit('?'); });
+    EXPECT_EQ(chained.error(), Errc::ParseError);
+
+    const auto skipped = parse_digit('?').transform([](int v) { return v + 1; });
+    EXPECT_EQ(skipped.error(), Errc::ParseError);
+}
+
+TEST(ExpectedTest, NonTrivialValueType) {
+    Expected<std::string> text = std::string(64, 'a');
+    Expected<std::string> copy = text;
+    EXPECT_EQ(*copy, *text);
+
+    copy = Expected<std::string>(unexpected(Errc::NotFound));
+    EXPECT_FALSE(copy.has_value());
+    copy = text;
+    EXPECT_EQ(copy->size(), 64u);
+
+    Expected<std::unique_ptr<int>> owned = std::make_unique<int>(5);
+    auto moved = std::move(owned);
+    EXPECT_EQ(**moved, 5);
+}
+
+TEST(ExpectedTest, VoidSpecialization) {
+    Expected<void> ok;
+    EXPECT_TRUE(ok);
+
+    Expected<void> failed = unexpected(Errc::OutOfRange);
+    ASSERT_FALSE(failed);
+    EXPECT_EQ(failed.error(), Errc::OutOfRange);
+}
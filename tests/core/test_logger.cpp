@@ -1,8 +1,18 @@
 #include <gtest/gtest.h>
-#include <memory>
+#include <chrono>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <spdlog/details/console_globals.h>
 
 #include "cpptemplate/core/logger.hpp"
+#include "cpptemplate/core/logger_registry.hpp"
 
 using namespace cpptemplate::core;
 
@@ -16,6 +26,11 @@ protected:
 
     void TearDown() override {
         logger.reset();
+        // Loggers are cached by name; start each test from a fresh instance
+        for (const char* name : {"TestLogger", "AsyncLogger", "AsyncBlock", "AsyncDropOldest",
+                                 "AsyncDropNewest", "AsyncThreads", "AsyncError"}) {
+            LoggerRegistry::instance().drop(name);
+        }
     }
 
     std::shared_ptr<Logger> logger;
@@ -75,4 +90,194 @@ TEST_F(LoggerTest, MoveSemantics) {
     
     // Original logger should be in a valid but unspecified state
     // We don't test its state as it's moved-from
-}
\ No newline at end of file
+}
+
+// Async mode tests
+TEST_F(LoggerTest, CreateAsyncLogger) {
+    auto async_logger = Logger::create("AsyncLogger", {.mode = LogMode::Async});
+    
+    ASSERT_NE(async_logger, nullptr);
+    EXPECT_EQ(async_logger->name(), "AsyncLogger");
+    EXPECT_EQ(async_logger->dropped_messages(), 0u);
+}
+
+TEST_F(LoggerTest, AsyncLoggerBlockPolicyNeverDrops) {
+    auto async_logger = Logger::create(
+        "AsyncBlock", {.mode = LogMode::Async, .queue_size = 4, .level = spdlog::level::debug});
+    
+    for (int i = 0; i < 1000; ++i) {
+        async_logger->debug("Blocking message {}", i);
+    }
+    async_logger->flush();
+    
+    EXPECT_EQ(async_logger->dropped_messages(), 0u);
+}
+
+namespace {
+
+/// Every line logged to the registry's log files so far
+std::string read_log_files() {
+    std::string text;
+    for (const auto& entry : std::filesystem::directory_iterator("logs")) {
+        std::ifstream file(entry.path());
+        text.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    return text;
+}
+
+} // namespace
+
+TEST_F(LoggerTest, AsyncLoggerDropPoliciesCountDrops) {
+    auto drop_oldest = Logger::create(
+        "AsyncDropOldest", {.mode = LogMode::Async,
+                            .queue_size = 2,
+                            .overflow_policy = OverflowPolicy::DropOldest,
+                            .level = spdlog::level::debug});
+    auto drop_newest = Logger::create(
+        "AsyncDropNewest", {.mode = LogMode::Async,
+                            .queue_size = 2,
+                            .overflow_policy = OverflowPolicy::DropNewest,
+                            .level = spdlog::level::debug});
+    const auto run = std::chrono::steady_clock::now().time_since_epoch().count();
+
+    // Both writers stall on the console sink once they pick up a record, so
+    // each keeps at most one record in hand plus the two queued ones
+    constexpr int MessageCount = 1000;
+    {
+        std::lock_guard console(spdlog::details::console_mutex::mutex());
+        for (int i = 0; i < MessageCount; ++i) {
+            drop_oldest->info("Drop oldest {} message {}", run, i);
+            drop_newest->info("Drop newest {} message {}", run, i);
+        }
+    }
+    drop_oldest->flush();
+    drop_newest->flush();
+
+    EXPECT_GE(drop_oldest->dropped_messages(), static_cast<std::uint64_t>(MessageCount - 3));
+    EXPECT_GE(drop_newest->dropped_messages(), static_cast<std::uint64_t>(MessageCount - 3));
+
+    // Drop-oldest keeps the end of the burst, drop-newest its start
+    const auto text = read_log_files();
+    const auto written = [&](std::string_view policy, int i) {
+        return text.find(fmt::format("Drop {} {} message {}\n", policy, run, i)) !=
+            std::string::npos;
+    };
+    EXPECT_TRUE(written("oldest", MessageCount - 1));
+    EXPECT_TRUE(written("oldest", MessageCount - 2));
+    EXPECT_TRUE(written("newest", 0));
+    EXPECT_FALSE(written("newest", MessageCount - 1));
+}
+
+TEST_F(LoggerTest, AsyncErrorDoesNotWaitForTheWriter) {
+    auto async_logger = Logger::create(
+        "AsyncError", {.mode = LogMode::Async,
+                       .queue_size = 4,
+                       .overflow_policy = OverflowPolicy::DropNewest});
+
+    // With the writer stalled, an error record that waited for the queue to drain would hang here
+    {
+        std::lock_guard console(spdlog::details::console_mutex::mutex());
+        for (int i = 0; i < 8; ++i) {
+            async_logger->error("Error while the writer is stalled {}", i);
+        }
+    }
+    async_logger->flush();
+
+    EXPECT_GT(async_logger->dropped_messages(), 0u);
+}
+
+TEST_F(LoggerTest, AsyncLoggerFromManyThreads) {
+    auto async_logger = Logger::create(
+        "AsyncThreads", {.mode = LogMode::Async, .queue_size = 64, .level = spdlog::level::debug});
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&async_logger, t] {
+            for (int i = 0; i < 500; ++i) {
+                async_logger->debug("Thread {} message {}", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    async_logger->flush();
+    
+    EXPECT_EQ(async_logger->dropped_messages(), 0u);
+}
+
+
+// Level check tests
+TEST_F(LoggerTest, DefaultLevelIsInfo) {
+    EXPECT_FALSE(logger->should_log(spdlog::level::trace));
+    EXPECT_FALSE(logger->should_log(spdlog::level::debug));
+    EXPECT_TRUE(logger->should_log(spdlog::level::info));
+    EXPECT_TRUE(logger->should_log(spdlog::level::critical));
+}
+
+TEST_F(LoggerTest, ShouldLogFollowsRuntimeLevel) {
+    logger->set_level(spdlog::level::err);
+    EXPECT_FALSE(logger->should_log(spdlog::level::warn));
+    EXPECT_TRUE(logger->should_log(spdlog::level::err));
+    
+    logger->set_level(spdlog::level::trace);
+    EXPECT_EQ(logger->should_log(spdlog::level::trace), is_compiled_in(spdlog::level::trace));
+}
+
+TEST_F(LoggerTest, CompiledInLevels) {
+    EXPECT_TRUE(is_compiled_in(spdlog::level::critical) || ActiveLevel == spdlog::level::off);
+    EXPECT_FALSE(is_compiled_in(spdlog::level::off));
+}
+
+// Lazy argument tests
+TEST_F(LoggerTest, LazyArgumentSkippedWhenDisabled) {
+    int evaluations = 0;
+    logger->set_level(spdlog::level::warn);
+    
+    logger->debug("Lazy value: {}", lazy([&evaluations] { return ++evaluations; }));
+    logger->info("Lazy value: {}", lazy([&evaluations] { return ++evaluations; }));
+    
+    EXPECT_EQ(evaluations, 0);
+}
+
+TEST_F(LoggerTest, LazyArgumentEvaluatedWhenEnabled) {
+    int evaluations = 0;
+    logger->set_level(spdlog::level::warn);
+    
+    logger->warn("Lazy value: {}", lazy([&evaluations] { return ++evaluations; }));
+    
+    EXPECT_EQ(evaluations, is_compiled_in(spdlog::level::warn) ? 1 : 0);
+}
+
+// Call-site macro tests
+TEST_F(LoggerTest, MacroSkipsArgumentsWhenDisabled) {
+    int evaluations = 0;
+    logger->set_level(spdlog::level::warn);
+
+    CPPTEMPLATE_LOG_TRACE(logger, "Counted: {}", ++evaluations);
+    CPPTEMPLATE_LOG_DEBUG(logger, "Counted: {}", ++evaluations);
+    CPPTEMPLATE_LOG_INFO(logger, "Counted: {}", ++evaluations);
+
+    EXPECT_EQ(evaluations, 0);
+}
+
+TEST_F(LoggerTest, MacroEvaluatesArgumentsWhenEnabled) {
+    int evaluations = 0;
+    logger->set_level(spdlog::level::warn);
+
+    CPPTEMPLATE_LOG_WARN(logger, "Counted: {}", ++evaluations);
+    CPPTEMPLATE_LOG_ERROR(logger, "Counted: {}", ++evaluations);
+    CPPTEMPLATE_LOG_CRITICAL(logger, "Counted: {}", ++evaluations);
+
+    EXPECT_EQ(evaluations, (is_compiled_in(spdlog::level::warn) ? 1 : 0) +
+                               (is_compiled_in(spdlog::level::err) ? 1 : 0) +
+                               (is_compiled_in(spdlog::level::critical) ? 1 : 0));
+}
+
+TEST_F(LoggerTest, LazyArgumentFormatsLikeResult) {
+    auto value = lazy([] { return 3.14159; });
+    EXPECT_EQ(fmt::format("{:.2f}", value), "3.14");
+    
+    auto text = lazy([] { return std::string("computed"); });
+    EXPECT_EQ(fmt::format("[{:>10}]", text), "[  computed]");
+}
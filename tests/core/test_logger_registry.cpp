@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "cpptemplate/core/exception.hpp"
+#include "cpptemplate/core/logger_registry.hpp"
+
+using namespace cpptemplate::core;
+
+class LoggerRegistryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::filesystem::create_directories("logs");
+    }
+
+    LoggerRegistry& registry = LoggerRegistry::instance();
+};
+
+TEST_F(LoggerRegistryTest, CreateSameNameReturnsCachedInstance) {
+    auto first = Logger::create("RegistryCached");
+    auto second = Logger::create("RegistryCached");
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(registry.find("RegistryCached"), first);
+    registry.drop("RegistryCached");
+}
+
+TEST_F(LoggerRegistryTest, OptionsOnlyApplyOnCreation) {
+    auto first = Logger::create("RegistryOptions", {.level = spdlog::level::warn});
+    auto second = Logger::create("RegistryOptions", {.level = spdlog::level::trace});
+
+    EXPECT_EQ(first, second);
+    EXPECT_FALSE(second->should_log(spdlog::level::info));
+    registry.drop("RegistryOptions");
+}
+
+TEST_F(LoggerRegistryTest, MismatchedModeOrQueueThrows) {
+    auto async = Logger::create("RegistryMismatch",
+                                {.mode = LogMode::Async, .queue_size = 16});
+
+    EXPECT_THROW(static_cast<void>(Logger::create("RegistryMismatch")), Exception);
+    EXPECT_THROW(static_cast<void>(Logger::create(
+                     "RegistryMismatch", {.mode = LogMode::Async, .queue_size = 1024})),
+                 Exception);
+    EXPECT_THROW(static_cast<void>(Logger::create(
+                     "RegistryMismatch", {.mode = LogMode::Async,
+                                          .queue_size = 16,
+                                          .overflow_policy = OverflowPolicy::DropNewest})),
+                 Exception);
+    // Sizes that round to the same capacity describe the same queue
+    EXPECT_EQ(Logger::create("RegistryMismatch", {.mode = LogMode::Async, .queue_size = 13}),
+              async);
+    registry.drop("RegistryMismatch");
+}
+
+TEST_F(LoggerRegistryTest, AsyncLoggersCountDropsSeparately) {
+    auto lossy = Logger::create("RegistryLossy", {.mode = LogMode::Async,
+                                                  .queue_size = 2,
+                                                  .overflow_policy = OverflowPolicy::DropNewest,
+                                                  .level = spdlog::level::debug});
+    auto quiet = Logger::create("RegistryQuiet", {.mode = LogMode::Async,
+                                                  .queue_size = 1024,
+                                                  .overflow_policy = OverflowPolicy::DropNewest,
+                                                  .level = spdlog::level::debug});
+    for (int i = 0; i < 1000; ++i) {
+        lossy->debug("Lossy message {}", i);
+    }
+    quiet->debug("Quiet message");
+    lossy->flush();
+    quiet->flush();
+
+    EXPECT_LE(lossy->dropped_messages(), 1000u);
+    EXPECT_EQ(quiet->dropped_messages(), 0u);
+    registry.drop("RegistryLossy");
+    registry.drop("RegistryQuiet");
+}
+
+TEST_F(LoggerRegistryTest, FindUnknownReturnsNull) {
+    EXPECT_EQ(registry.find("RegistryMissing"), nullptr);
+}
+
+TEST_F(LoggerRegistryTest, DropRemovesLogger) {
+    auto logger = registry.get("RegistryDropped");
+    const auto size = registry.size();
+
+    EXPECT_TRUE(registry.drop("RegistryDropped"));
+    EXPECT_FALSE(registry.drop("RegistryDropped"));
+    EXPECT_EQ(registry.size(), size - 1);
+    EXPECT_EQ(registry.find("RegistryDropped"), nullptr);
+
+    // The dropped instance stays usable and a new one can take its name
+    logger->info("Still usable after drop");
+    auto replacement = registry.get("RegistryDropped");
+    EXPECT_NE(replacement, logger);
+    registry.drop("RegistryDropped");
+}
+
+TEST_F(LoggerRegistryTest, ConcurrentGetCreatesOneInstance) {
+    constexpr int thread_count = 8;
+    std::vector<std::shared_ptr<Logger>> results(thread_count);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&results, t] {
+            for (int i = 0; i < 1000; ++i) {
+                results[t] = Logger::create("RegistryConcurrent");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& result : results) {
+        EXPECT_EQ(result, results.front());
+    }
+    registry.drop("RegistryConcurrent");
+}
+
+TEST_F(LoggerRegistryTest, ChildLoggerNameAndLevel) {
+    auto parent = Logger::create("RegistryParent", {.level = spdlog::level::debug});
+    auto child = parent->child("conn-42");
+
+    EXPECT_EQ(child->name(), "RegistryParent.conn-42");
+    EXPECT_TRUE(child->should_log(spdlog::level::debug));
+    EXPECT_EQ(registry.find("RegistryParent.conn-42"), nullptr);
+
+    // Levels are independent after creation
+    child->set_level(spdlog::level::err);
+    EXPECT_TRUE(parent->should_log(spdlog::level::debug));
+    registry.drop("RegistryParent");
+}
+
+TEST_F(LoggerRegistryTest, ChildOfAsyncLoggerSharesQueue) {
+    auto parent = Logger::create("RegistryAsyncParent",
+                                 {.mode = LogMode::Async, .level = spdlog::level::debug});
+    for (int i = 0; i < 100; ++i) {
+        auto child = parent->child("request");
+        child->debug("Request {} handled", i);
+        child->log_deferred(spdlog::level::debug, "Deferred request {}", i);
+    }
+    parent->flush();
+    EXPECT_EQ(parent->dropped_messages(), 0u);
+    registry.drop("RegistryAsyncParent");
+}
+
+TEST_F(LoggerRegistryTest, ConfigureAfterCreationThrows) {
+    EXPECT_THROW(LoggerRegistry::configure({.file_sink = FileSinkType::Mapped}), Exception);
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/logger.h>
+
+#include "cpptemplate/core/mapped_file_sink.hpp"
+
+using namespace cpptemplate::core;
+
+namespace {
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream input(path, std::ios::binary);
+    std::ostringstream content;
+    content << input.rdbuf();
+    return content.str();
+}
+
+std::size_t count_lines(const std::string& text) {
+    return static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+} // namespace
+
+class MappedFileSinkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = std::filesystem::temp_directory_path() /
+                    ("cpptemplate_mapped_sink_" +
+                     std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(directory);
+        path = directory / "app.log";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    std::shared_ptr<spdlog::logger> make_logger(std::shared_ptr<MappedFileSink> sink) {
+        sink->set_pattern("%v");
+        auto logger = std::make_shared<spdlog::logger>("mapped", std::move(sink));
+        logger->set_level(spdlog::level::trace);
+        return logger;
+    }
+
+    std::filesystem::path directory;
+    std::filesystem::path path;
+};
+
+TEST_F(MappedFileSinkTest, WritesRecordsAndTrimsOnClose) {
+    {
+        auto sink = std::make_shared<MappedFileSink>(MappedFileSinkOptions{path.string()});
+        auto logger = make_logger(sink);
+        logger->info("first {}", 1);
+        logger->info("second {}", 2);
+    }
+
+    EXPECT_EQ(read_file(path), "first 1\nsecond 2\n");
+}
+
+TEST_F(MappedFileSinkTest, RecordsVisibleBeforeClose) {
+    auto sink = std::make_shared<MappedFileSink>(MappedFileSinkOptions{path.string()});
+    auto logger = make_logger(sink);
+    logger->info("visible without flush");
+
+    // The file is pre-sized; the record sits at its start followed by NULs
+    const auto content = read_file(path);
+    EXPECT_EQ(content.rfind("visible without flush\n", 0), 0u);
+}
+
+TEST_F(MappedFileSinkTest, RecoversFileLeftByCrash) {
+    std::filesystem::create_directories(directory);
+    {
+        std::ofstream crashed(path, std::ios::binary);
+        crashed << "before crash\n" << std::string(4096, '\0');
+    }
+
+    {
+        auto sink = std::make_shared<MappedFileSink>(MappedFileSinkOptions{path.string()});
+        auto logger = make_logger(sink);
+        logger->info("after restart");
+    }
+
+    EXPECT_EQ(read_file(path), "before crash\nafter restart\n");
+}
+
+TEST_F(MappedFileSinkTest, RotatesWhenFull) {
+    const std::string line(99, 'x');
+    {
+        auto sink = std::make_shared<MappedFileSink>(
+            MappedFileSinkOptions{path.string(), 4096, 2});
+        auto logger = make_logger(sink);
+        for (int i = 0; i < 200; ++i) {
+            logger->info("{}", line);
+        }
+    }
+
+    EXPECT_TRUE(std::filesystem::exists(directory / "app.1.log"));
+    EXPECT_TRUE(std::filesystem::exists(directory / "app.2.log"));
+    EXPECT_FALSE(std::filesystem::exists(directory / "app.3.log"));
+    // Rotated files hold whole records only
+    const auto rotated = read_file(directory / "app.1.log");
+    EXPECT_EQ(rotated.size() % (line.size() + 1), 0u);
+    EXPECT_EQ(rotated.find('\0'), std::string::npos);
+}
+
+TEST_F(MappedFileSinkTest, DropsRecordsLargerThanFile) {
+    auto sink = std::make_shared<MappedFileSink>(MappedFileSinkOptions{path.string(), 4096, 1});
+    auto logger = make_logger(sink);
+    logger->info("{}", std::string(8192, 'x'));
+    EXPECT_EQ(sink->dropped(), 1u);
+}
+
+TEST_F(MappedFileSinkTest, ConcurrentWritersAcrossRotations) {
+    constexpr int thread_count = 8;
+    constexpr int per_thread = 2000;
+    {
+        auto sink = std::make_shared<MappedFileSink>(
+            MappedFileSinkOptions{path.string(), 64 * 1024, 16});
+        auto logger = make_logger(sink);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    logger->info("thread {} message {}", t, i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::size_t lines = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        const auto content = read_file(entry.path());
+        EXPECT_EQ(content.find('\0'), std::string::npos) << entry.path();
+        lines += count_lines(content);
+    }
+    EXPECT_EQ(lines, static_cast<std::size_t>(thread_count * per_thread));
+}
+
+TEST_F(MappedFileSinkTest, ConcurrentWritersAcrossManyRotations) {
+    // Around 100 rotations, so both segments are reopened many times under writers
+    constexpr int thread_count = 4;
+    constexpr int per_thread = 4000;
+    {
+        auto sink = std::make_shared<MappedFileSink>(
+            MappedFileSinkOptions{path.string(), 4096, 256});
+        auto logger = make_logger(sink);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    logger->info("thread {} message {}", t, i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::size_t files = 0;
+    std::size_t lines = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        const auto content = read_file(entry.path());
+        EXPECT_EQ(content.find('\0'), std::string::npos) << entry.path();
+        lines += count_lines(content);
+        ++files;
+    }
+    EXPECT_GT(files, 50u);
+    EXPECT_EQ(lines, static_cast<std::size_t>(thread_count * per_thread));
+}
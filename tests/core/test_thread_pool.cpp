@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cpptemplate/core/thread_pool.hpp"
+
+using namespace cpptemplate::core;
+
+namespace {
+
+/// Checks every index is visited once and every subrange respects the grain
+void expect_exact_cover(ThreadPool& pool, std::size_t count, std::size_t grain) {
+    std::vector<std::atomic<int>> visits(count);
+    std::atomic<bool> oversized{false};
+    pool.parallel_for(count, grain, [&](std::size_t begin, std::size_t end) {
+        if (end - begin > grain) {
+            oversized = true;
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            visits[i].fetch_add(1);
+        }
+    });
+    EXPECT_FALSE(oversized);
+    for (std::size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(visits[i].load(), 1) << "index " << i;
+    }
+}
+
+} // namespace
+
+TEST(ThreadPoolTest, CoversEveryIndexOnce) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+    for (const std::size_t count : {0u, 1u, 7u, 1000u, 100'003u}) {
+        expect_exact_cover(pool, count, 64);
+    }
+    expect_exact_cover(pool, 1000, 1);
+}
+
+TEST(ThreadPoolTest, SingleThreadPoolRunsInline) {
+    ThreadPool pool(1);
+    EXPECT_EQ(pool.size(), 1u);
+    const auto caller = std::this_thread::get_id();
+    bool other_thread = false;
+    pool.parallel_for(10'000, 100, [&](std::size_t, std::size_t) {
+        other_thread = other_thread || std::this_thread::get_id() != caller;
+    });
+    EXPECT_FALSE(other_thread);
+    expect_exact_cover(pool, 10'000, 100);
+}
+
+TEST(ThreadPoolTest, AcceptsConstCallables) {
+    ThreadPool pool(3);
+    std::atomic<std::size_t> total{0};
+    const auto count = [&total](std::size_t begin, std::size_t end) { total.fetch_add(end - begin); };
+    pool.parallel_for(5000, 50, count);
+    EXPECT_EQ(total.load(), 5000u);
+
+    struct Counter {
+        std::atomic<std::size_t>* total;
+        void operator()(std::size_t begin, std::size_t end) const {
+            total->fetch_add(end - begin);
+        }
+    };
+    const Counter counter{&total};
+    pool.parallel_for(3000, 7, counter);
+    pool.parallel_for(2000, 7, std::as_const(counter));
+    EXPECT_EQ(total.load(), 10'000u);
+}
+
+TEST(ThreadPoolTest, NestedCalls) {
+    ThreadPool pool(3);
+    std::atomic<std::size_t> total{0};
+    pool.parallel_for(16, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            pool.parallel_for(1000, 10, [&](std::size_t b, std::size_t e) { total.fetch_add(e - b); });
+        }
+    });
+    EXPECT_EQ(total.load(), 16'000u);
+}
+
+TEST(ThreadPoolTest, ConcurrentCallers) {
+    ThreadPool pool(2);
+    std::vector<std::thread> callers;
+    std::atomic<std::size_t> total{0};
+    for (int t = 0; t < 4; ++t) {
+        callers.emplace_back([&] {
+            for (int round = 0; round < 20; ++round) {
+                pool.parallel_for(5000, 50, [&](std::size_t b, std::size_t e) { total.fetch_add(e - b); });
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    EXPECT_EQ(total.load(), 4u * 20u * 5000u);
+}
+
+TEST(ThreadPoolTest, RethrowsFirstException) {
+    ThreadPool pool(4);
+    EXPECT_THROW(pool.parallel_for(10'000, 10,
+                                   [](std::size_t begin, std::size_t) {
+                                       if (begin >= 5000) {
+                                           throw std::runtime_error("boom");
+                                       }
+                                   }),
+                 std::runtime_error);
+    // The pool stays usable
+    expect_exact_cover(pool, 1000, 10);
+}
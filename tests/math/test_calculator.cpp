@@ -1,9 +1,17 @@
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
 #include <stdexcept>
+#include <vector>
 
+#include "cpptemplate/core/simd.hpp"
 #include "cpptemplate/math/calculator.hpp"
 
 using namespace cpptemplate::math;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
 
 class CalculatorTest : public ::testing::Test {
 protected:
@@ -133,4 +141,146 @@ TEST_F(CalculatorTest, SqrtPositiveNumbers) {
 TEST_F(CalculatorTest, SqrtNegativeNumberThrowsException) {
     EXPECT_THROW(calc->sqrt(-1.0), std::invalid_argument);
     EXPECT_THROW(calc->sqrt(-0.1), std::invalid_argument);
-}
\ No newline at end of file
+}
+
+// Non-throwing overloads
+TEST_F(CalculatorTest, DivideNothrowReturnsValue) {
+    const auto result = calc->divide(10.0, 4.0, std::nothrow);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_DOUBLE_EQ(*result, 2.5);
+}
+
+TEST_F(CalculatorTest, DivideNothrowByZeroReturnsError) {
+    const auto result = calc->divide(5.0, 0.0, std::nothrow);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), cpptemplate::core::Errc::DivisionByZero);
+    EXPECT_DOUBLE_EQ(result.value_or(-1.0), -1.0);
+}
+
+TEST_F(CalculatorTest, SqrtNothrow) {
+    EXPECT_DOUBLE_EQ(calc->sqrt(9.0, std::nothrow).value(), 3.0);
+
+    const auto result = calc->sqrt(-1.0, std::nothrow);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), cpptemplate::core::Errc::DomainError);
+}
+
+// Batch operations, run on every kernel level the CPU supports
+class CalculatorBatchTest : public CalculatorTest,
+                            public ::testing::WithParamInterface<SimdLevel> {
+protected:
+    void SetUp() override {
+        CalculatorTest::SetUp();
+        if (set_simd_level(GetParam()) != GetParam()) {
+            GTEST_SKIP() << to_string(GetParam()) << " not supported on this CPU";
+        }
+    }
+
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+        CalculatorTest::TearDown();
+    }
+
+    /// Sizes exercising empty input, vector bodies and every tail length
+    static std::vector<std::size_t> sizes() {
+        return {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 1000};
+    }
+
+    static std::vector<double> sequence(std::size_t n, double start, double step) {
+        std::vector<double> values(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            values[i] = start + step * static_cast<double>(i);
+        }
+        return values;
+    }
+};
+
+TEST_P(CalculatorBatchTest, ArithmeticMatchesScalar) {
+    for (const auto n : sizes()) {
+        const auto a = sequence(n, -3.5, 0.75);
+        const auto b = sequence(n, 2.0, -0.5);
+        std::vector<double> sum(n), difference(n), product(n), powers(n);
+
+        calc->add(a, b, sum);
+        calc->subtract(a, b, difference);
+        calc->multiply(a, b, product);
+        calc->power(b, a, powers);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            EXPECT_DOUBLE_EQ(sum[i], calc->add(a[i], b[i])) << "n=" << n << " i=" << i;
+            EXPECT_DOUBLE_EQ(difference[i], calc->subtract(a[i], b[i]));
+            EXPECT_DOUBLE_EQ(product[i], calc->multiply(a[i], b[i]));
+            const double expected = calc->power(b[i], a[i]);
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(powers[i]));
+            } else {
+                EXPECT_DOUBLE_EQ(powers[i], expected);
+            }
+        }
+    }
+}
+
+TEST_P(CalculatorBatchTest, DivideReportsZeroDivisorsPerElement) {
+    for (const auto n : sizes()) {
+        const auto a = sequence(n, 1.0, 1.0);
+        auto b = sequence(n, -4.0, 1.0); // Exactly 0.0 at i == 4
+        for (std::size_t i = 6; i < n; i += 5) {
+            b[i] = -0.0;
+        }
+        std::vector<double> out(n);
+        std::vector<std::uint8_t> errors(n, 7);
+
+        const auto failed = calc->divide(a, b, out, errors);
+
+        std::size_t expected_failed = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto scalar = calc->divide(a[i], b[i], std::nothrow);
+            if (scalar) {
+                EXPECT_DOUBLE_EQ(out[i], *scalar) << "n=" << n << " i=" << i;
+                EXPECT_EQ(errors[i], 0) << "n=" << n << " i=" << i;
+            } else {
+                ++expected_failed;
+                EXPECT_TRUE(std::isnan(out[i])) << "n=" << n << " i=" << i;
+                EXPECT_EQ(errors[i], 1) << "n=" << n << " i=" << i;
+            }
+        }
+        EXPECT_EQ(failed, expected_failed) << "n=" << n;
+
+        // Without error flags, in place
+        auto in_place = a;
+        EXPECT_EQ(calc->divide(in_place, b, in_place), expected_failed);
+    }
+}
+
+TEST_P(CalculatorBatchTest, SqrtReportsNegativeValuesPerElement) {
+    for (const auto n : sizes()) {
+        const auto values = sequence(n, -2.0, 0.5); // Negative for i < 4, -0.0 never
+        std::vector<double> out(n);
+        std::vector<std::uint8_t> errors(n, 7);
+
+        const auto failed = calc->sqrt(values, out, errors);
+
+        EXPECT_EQ(failed, n < 4 ? n : 4u);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (values[i] < 0.0) {
+                EXPECT_TRUE(std::isnan(out[i]));
+                EXPECT_EQ(errors[i], 1);
+            } else {
+                EXPECT_DOUBLE_EQ(out[i], calc->sqrt(values[i]));
+                EXPECT_EQ(errors[i], 0);
+            }
+        }
+    }
+}
+
+TEST_P(CalculatorBatchTest, MismatchedSizesThrow) {
+    std::vector<double> a(8), b(7), out(8);
+    std::vector<std::uint8_t> errors(3);
+    EXPECT_THROW(calc->add(a, b, out), std::invalid_argument);
+    EXPECT_THROW(calc->sqrt(b, out), std::invalid_argument);
+    EXPECT_THROW(static_cast<void>(calc->divide(a, a, out, errors)), std::invalid_argument);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, CalculatorBatchTest,
+                         ::testing::Values(SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512),
+                         [](const auto& info) { return std::string(to_string(info.param)); });
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/math/expression.hpp"
+
+using namespace cpptemplate::math;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::ThreadPool;
+using cpptemplate::core::to_string;
+
+namespace {
+
+double eval(std::string_view formula, std::vector<double> row = {}) {
+    return Expression::compile(formula).evaluate(row);
+}
+
+std::vector<double> column(std::size_t n, unsigned seed, double low, double high) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(low, high);
+    std::vector<double> values(n);
+    for (auto& v : values) {
+        v = dist(rng);
+    }
+    return values;
+}
+
+void expect_same(double expected, double actual) {
+    if (std::isnan(expected)) {
+        EXPECT_TRUE(std::isnan(actual));
+    } else {
+        EXPECT_DOUBLE_EQ(expected, actual);
+    }
+}
+
+class ExpressionBatchTest : public ::testing::TestWithParam<SimdLevel> {
+protected:
+    void SetUp() override {
+        if (set_simd_level(GetParam()) != GetParam()) {
+            GTEST_SKIP() << to_string(GetParam()) << " not supported on this CPU";
+        }
+    }
+
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+    }
+};
+
+} // namespace
+
+TEST(ExpressionTest, PrecedenceAndAssociativity) {
+    EXPECT_EQ(eval("1 + 2 * 3"), 7.0);
+    EXPECT_EQ(eval("(1 + 2) * 3"), 9.0);
+    EXPECT_EQ(eval("10 - 4 - 3"), 3.0);
+    EXPECT_EQ(eval("2 ^ 3 ^ 2"), 512.0);
+    EXPECT_EQ(eval("-2 ^ 2"), -4.0);
+    EXPECT_EQ(eval("2 ^ -1"), 0.5);
+    EXPECT_EQ(eval("--3 + +1"), 4.0);
+    EXPECT_EQ(eval("sqrt(16) + pow(2, 10)"), 1028.0);
+    EXPECT_EQ(eval("1.5e2 / .5"), 300.0);
+}
+
+TEST(ExpressionTest, VariablesInOrderOfFirstUse) {
+    const auto expr = Expression::compile("y * x + y");
+    ASSERT_EQ(expr.variables(), (std::vector<std::string>{"y", "x"}));
+    EXPECT_EQ(expr.evaluate(std::vector<double>{2.0, 5.0}), 12.0);
+    EXPECT_THROW((void)expr.evaluate(std::vector<double>{1.0}), std::invalid_argument);
+}
+
+TEST(ExpressionTest, DomainErrorsGiveNaN) {
+    EXPECT_TRUE(std::isnan(eval("x / 0", {1.0})));
+    EXPECT_TRUE(std::isnan(eval("sqrt(x)", {-1.0})));
+    EXPECT_TRUE(std::isnan(eval("1 / 0")));
+}
+
+TEST(ExpressionTest, ConstantsFoldAndSubexpressionsAreShared) {
+    EXPECT_TRUE(Expression::compile("2 * (3 + 4) - sqrt(9)").instructions().empty());
+
+    // (x + y) is computed once; the constant part of x * (2 + 3) folds to one multiply
+    const auto shared = Expression::compile("(x + y) * (x + y) + x * (2 + 3)");
+    EXPECT_EQ(shared.instructions().size(), 4u);
+    EXPECT_EQ(shared.evaluate(std::vector<double>{1.0, 2.0}), 14.0);
+
+    const auto square = Expression::compile("x^2");
+    ASSERT_EQ(square.instructions().size(), 1u);
+    EXPECT_EQ(square.instructions()[0].op, Expression::OpCode::Multiply);
+}
+
+TEST(ExpressionTest, SyntaxErrorsNamePosition) {
+    for (const char* bad : {"", "1 +", "(1 + 2", "1 2", "x $ y", "foo(1)", "sqrt 4", "pow(1)", "2x"}) {
+        EXPECT_THROW((void)Expression::compile(bad), std::invalid_argument) << bad;
+    }
+    try {
+        (void)Expression::compile("x + * y");
+        FAIL();
+    } catch (const std::invalid_argument& e) {
+        EXPECT_NE(std::string(e.what()).find("position 4"), std::string::npos) << e.what();
+    }
+    EXPECT_THROW((void)Expression::compile(std::string(10'000, '(') + "1" + std::string(10'000, ')')),
+                 std::invalid_argument);
+}
+
+TEST(ExpressionTest, TrivialProgramsCopyOrFill) {
+    const std::vector<double> x = {1.0, 2.0, 3.0};
+    std::vector<double> out(3);
+    const std::span<const double> columns[] = {x};
+    Expression::compile("x").evaluate(columns, out);
+    EXPECT_EQ(out, x);
+    Expression::compile("4 / 2").evaluate({}, out);
+    EXPECT_EQ(out, (std::vector<double>{2.0, 2.0, 2.0}));
+}
+
+TEST(ExpressionTest, ColumnShapeIsChecked) {
+    const auto expr = Expression::compile("x + y");
+    const std::vector<double> x(4);
+    const std::vector<double> short_y(3);
+    std::vector<double> out(4);
+    const std::span<const double> one[] = {x};
+    const std::span<const double> mismatched[] = {x, short_y};
+    EXPECT_THROW(expr.evaluate(one, out), std::invalid_argument);
+    EXPECT_THROW(expr.evaluate(mismatched, out), std::invalid_argument);
+}
+
+TEST_P(ExpressionBatchTest, BatchMatchesRowByRow) {
+    const auto expr = Expression::compile("sqrt(a^2 + b^2) / (c - 0.5) - pow(a, 0.5) * -b + a / b * c");
+    // Sizes around the block size, with some negative and near-zero values for NaN rows
+    for (const std::size_t n : {1u, 7u, 511u, 512u, 513u, 5'000u}) {
+        const auto a = column(n, 1, -0.5, 4.0);
+        const auto b = column(n, 2, -2.0, 2.0);
+        const auto c = column(n, 3, 0.0, 1.0);
+        const std::span<const double> columns[] = {a, b, c};
+        std::vector<double> out(n);
+        expr.evaluate(columns, out);
+        for (std::size_t i = 0; i < n; ++i) {
+            expect_same(expr.evaluate(std::vector<double>{a[i], b[i], c[i]}), out[i]);
+        }
+    }
+}
+
+TEST_P(ExpressionBatchTest, OutputMayAliasAColumn) {
+    const auto expr = Expression::compile("x * x + 1");
+    auto x = column(2'000, 4, -1.0, 1.0);
+    const auto expected = x;
+    const std::span<const double> columns[] = {x};
+    expr.evaluate(columns, x);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        EXPECT_DOUBLE_EQ(x[i], expected[i] * expected[i] + 1);
+    }
+}
+
+TEST_P(ExpressionBatchTest, PoolEvaluationMatchesSerial) {
+    const auto expr = Expression::compile("(x - y) * (x + y) / 3");
+    const auto x = column(200'003, 5, -10.0, 10.0);
+    const auto y = column(200'003, 6, -10.0, 10.0);
+    const std::span<const double> columns[] = {x, y};
+    std::vector<double> serial(x.size());
+    std::vector<double> parallel(x.size());
+    expr.evaluate(columns, serial);
+    ThreadPool pool(4);
+    expr.evaluate(columns, parallel, pool);
+    EXPECT_EQ(serial, parallel);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, ExpressionBatchTest,
+                         ::testing::Values(SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512),
+                         [](const auto& info) { return std::string(to_string(info.param)); });
+
+TEST(ExpressionCacheTest, ReturnsSameCompiledFormula) {
+    ExpressionCache cache(2);
+    const auto first = cache.get("x + 1");
+    EXPECT_EQ(cache.get("x + 1"), first);
+    EXPECT_NE(cache.get("x+1"), first); // Keyed by exact text
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_THROW((void)cache.get("x +"), std::invalid_argument);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_THROW(ExpressionCache(0), std::invalid_argument);
+}
+
+TEST(ExpressionCacheTest, EvictsLeastRecentlyUsed) {
+    ExpressionCache cache(2);
+    const auto a = cache.get("a");
+    const auto b = cache.get("b");
+    EXPECT_EQ(cache.get("a"), a); // b is now least recent
+    (void)cache.get("c");
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.get("a"), a);
+    EXPECT_NE(cache.get("b"), b); // Recompiled
+    EXPECT_EQ(b->evaluate(std::vector<double>{3.0}), 3.0); // Evicted expressions stay usable
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(ExpressionCacheTest, ConcurrentLookups) {
+    ExpressionCache cache(8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < 500; ++i) {
+                const auto expr = cache.get("x * " + std::to_string((i + t) % 12));
+                EXPECT_EQ(expr->evaluate(std::vector<double>{2.0}), 2.0 * ((i + t) % 12));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_LE(cache.size(), 8u);
+}
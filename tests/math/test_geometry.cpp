@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/math/geometry.hpp"
+
+using namespace cpptemplate::math;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::ThreadPool;
+using cpptemplate::core::to_string;
+
+namespace {
+
+template<std::size_t D>
+PointSet<D> uniform_points(std::size_t n, unsigned seed, double low = 0.0, double high = 1.0) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(low, high);
+    PointSet<D> points;
+    points.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        Point<D> p;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            p[axis] = dist(rng);
+        }
+        points.push_back(p);
+    }
+    return points;
+}
+
+template<std::size_t D>
+Aabb<D> random_box(std::mt19937_64& rng, double extent) {
+    std::uniform_real_distribution<double> corner(-0.1, 1.0);
+    std::uniform_real_distribution<double> size(0.0, extent);
+    Aabb<D> box;
+    for (std::size_t axis = 0; axis < D; ++axis) {
+        box.min[axis] = corner(rng);
+        box.max[axis] = box.min[axis] + size(rng);
+    }
+    return box;
+}
+
+template<std::size_t D>
+std::vector<std::uint32_t> brute_force_query(const PointSet<D>& points, const Aabb<D>& box) {
+    std::vector<std::uint32_t> ids;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (box.contains(points[i])) {
+            ids.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    return ids;
+}
+
+template<std::size_t D>
+std::vector<double> brute_force_nearest(const PointSet<D>& points,
+                                        const Point<D>& query,
+                                        std::size_t k) {
+    std::vector<double> distances;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        distances.push_back(squared_distance(points[i], query));
+    }
+    std::sort(distances.begin(), distances.end());
+    distances.resize(std::min(k, distances.size()));
+    return distances;
+}
+
+template<std::size_t D>
+void expect_index_matches(const PointSet<D>& points, ThreadPool& pool, unsigned seed) {
+    const PointIndex<D> index(points, pool);
+    ASSERT_EQ(index.size(), points.size());
+    EXPECT_EQ(index.bounds(), points.bounds());
+
+    std::mt19937_64 rng(seed);
+    for (int q = 0; q < 50; ++q) {
+        const auto box = random_box<D>(rng, q < 25 ? 0.2 : 1.2);
+        std::vector<std::uint32_t> ids{12345}; // Results are appended
+        const std::size_t found = index.query(box, ids);
+        ids.erase(ids.begin());
+        std::sort(ids.begin(), ids.end());
+        EXPECT_EQ(ids, brute_force_query(points, box));
+        EXPECT_EQ(found, ids.size());
+        EXPECT_EQ(index.count(box), ids.size());
+    }
+
+    std::uniform_real_distribution<double> coordinate(-0.5, 1.5);
+    for (const std::size_t k : {std::size_t{1}, std::size_t{7}, std::size_t{64}}) {
+        Point<D> query;
+        for (std::size_t axis = 0; axis < D; ++axis) {
+            query[axis] = coordinate(rng);
+        }
+        const auto neighbors = index.nearest(query, k);
+        const auto expected = brute_force_nearest(points, query, k);
+        ASSERT_EQ(neighbors.size(), expected.size());
+        for (std::size_t i = 0; i < neighbors.size(); ++i) {
+            EXPECT_DOUBLE_EQ(neighbors[i].squared_distance, expected[i]);
+            EXPECT_EQ(neighbors[i].squared_distance,
+                      squared_distance(points[neighbors[i].id], query));
+        }
+    }
+}
+
+class GeometryKernelTest : public ::testing::TestWithParam<SimdLevel> {
+protected:
+    void SetUp() override {
+        if (set_simd_level(GetParam()) != GetParam()) {
+            GTEST_SKIP() << to_string(GetParam()) << " not supported on this CPU";
+        }
+    }
+
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+    }
+};
+
+} // namespace
+
+TEST(AabbTest, DefaultIsEmptyAndIdentityForExpand) {
+    Aabb2 box;
+    EXPECT_TRUE(box.empty());
+    EXPECT_FALSE(box.contains(Point2{{0.0, 0.0}}));
+
+    box.expand(Point2{{1.0, 2.0}});
+    EXPECT_FALSE(box.empty());
+    EXPECT_EQ(box.min, (Point2{{1.0, 2.0}}));
+    EXPECT_EQ(box.max, (Point2{{1.0, 2.0}}));
+
+    box.expand(Aabb2{{{-1.0, 0.0}}, {{0.0, 5.0}}});
+    EXPECT_EQ(box, (Aabb2{{{-1.0, 0.0}}, {{1.0, 5.0}}}));
+}
+
+TEST(AabbTest, ClosedIntersectionAndDistance) {
+    const Aabb3 box{{{0.0, 0.0, 0.0}}, {{1.0, 1.0, 1.0}}};
+    EXPECT_TRUE(box.contains(Point3{{1.0, 0.0, 0.5}}));
+    EXPECT_TRUE(box.intersects(Aabb3{{{1.0, 1.0, 1.0}}, {{2.0, 2.0, 2.0}}}));
+    EXPECT_FALSE(box.intersects(Aabb3{{{1.5, 0.0, 0.0}}, {{2.0, 1.0, 1.0}}}));
+    EXPECT_EQ(box.squared_distance(Point3{{0.5, 0.5, 0.5}}), 0.0);
+    EXPECT_EQ(box.squared_distance(Point3{{3.0, -1.0, 0.5}}), 5.0);
+    EXPECT_EQ(distance(Point3{{0.0, 0.0, 0.0}}, Point3{{2.0, 3.0, 6.0}}), 7.0);
+}
+
+TEST(GeometryTest, BatchKernelsRejectMismatchedOutput) {
+    const auto points = uniform_points<2>(10, 1);
+    std::vector<std::uint8_t> flags(9);
+    std::vector<double> distances(11);
+    BoxSet<2> boxes;
+    boxes.push_back(Aabb2{{{0.0, 0.0}}, {{1.0, 1.0}}});
+    EXPECT_THROW((void)contains(Aabb2{}, points, flags), std::invalid_argument);
+    EXPECT_THROW(squared_distances(points, Point2{}, distances), std::invalid_argument);
+    EXPECT_THROW((void)intersect(boxes, Aabb2{}, flags), std::invalid_argument);
+}
+
+TEST_P(GeometryKernelTest, BatchKernelsMatchScalarDefinitions) {
+    std::mt19937_64 rng(7);
+    // Sizes around the vector widths
+    for (const std::size_t n : {0u, 1u, 7u, 8u, 9u, 31u, 1'000u}) {
+        const auto points = uniform_points<3>(n, static_cast<unsigned>(n));
+        BoxSet<3> boxes;
+        for (std::size_t i = 0; i < n; ++i) {
+            boxes.push_back(random_box<3>(rng, 0.3));
+        }
+        const auto query = random_box<3>(rng, 0.5);
+        const Point3 center{{0.5, 0.25, 0.75}};
+
+        std::vector<std::uint8_t> inside(n);
+        std::vector<std::uint8_t> hits(n);
+        std::vector<double> distances(n);
+        const std::size_t inside_count = contains(query, points, inside);
+        const std::size_t hit_count = intersect(boxes, query, hits);
+        squared_distances(points, center, distances);
+
+        std::size_t expected_inside = 0;
+        std::size_t expected_hits = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            EXPECT_EQ(inside[i], query.contains(points[i]) ? 1 : 0);
+            EXPECT_EQ(hits[i], query.intersects(boxes[i]) ? 1 : 0);
+            EXPECT_DOUBLE_EQ(distances[i], squared_distance(points[i], center));
+            expected_inside += inside[i];
+            expected_hits += hits[i];
+        }
+        EXPECT_EQ(inside_count, expected_inside);
+        EXPECT_EQ(hit_count, expected_hits);
+    }
+}
+
+TEST_P(GeometryKernelTest, IndexMatchesBruteForce2D) {
+    ThreadPool pool(3);
+    for (const std::size_t n : {1u, 5u, 8u, 9u, 64u, 65u, 513u, 20'000u}) {
+        expect_index_matches(uniform_points<2>(n, static_cast<unsigned>(n)), pool, 11);
+    }
+}
+
+TEST_P(GeometryKernelTest, IndexMatchesBruteForce3D) {
+    ThreadPool pool(2);
+    for (const std::size_t n : {1u, 7u, 100u, 4'097u, 30'000u}) {
+        expect_index_matches(uniform_points<3>(n, static_cast<unsigned>(n) + 1), pool, 13);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, GeometryKernelTest,
+                         ::testing::Values(SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512),
+                         [](const auto& info) { return std::string(to_string(info.param)); });
+
+TEST(PointIndexTest, EmptyIndex) {
+    const PointIndex<2> index{PointSet<2>{}};
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_TRUE(index.bounds().empty());
+    std::vector<std::uint32_t> ids;
+    EXPECT_EQ(index.query(Aabb2{{{0.0, 0.0}}, {{1.0, 1.0}}}, ids), 0u);
+    EXPECT_EQ(index.count(Aabb2{{{0.0, 0.0}}, {{1.0, 1.0}}}), 0u);
+    EXPECT_TRUE(index.nearest(Point2{}, 3).empty());
+}
+
+TEST(PointIndexTest, UnboundedQueryReturnsEveryPointOnce) {
+    constexpr double Inf = std::numeric_limits<double>::infinity();
+    // 1000 is not a multiple of 8 at any level, so every level carries padding
+    const auto points = uniform_points<3>(1'000, 5);
+    const PointIndex<3> index(points);
+    std::vector<std::uint32_t> ids;
+    index.query(Aabb3{{{-Inf, -Inf, -Inf}}, {{Inf, Inf, Inf}}}, ids);
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids.size(), 1'000u);
+    for (std::uint32_t i = 0; i < 1'000; ++i) {
+        EXPECT_EQ(ids[i], i);
+    }
+    EXPECT_EQ(index.nearest(Point3{}, 5'000).size(), 1'000u);
+}
+
+TEST(PointIndexTest, DuplicatePointsAndSingleThreadBuild) {
+    PointSet<2> points;
+    for (int i = 0; i < 300; ++i) {
+        points.push_back(Point2{{0.5, 0.5}});
+        points.push_back(Point2{{static_cast<double>(i), 0.0}});
+    }
+    ThreadPool pool(1);
+    expect_index_matches(points, pool, 17);
+    const PointIndex<2> index(points, pool);
+    EXPECT_EQ(index.count(Aabb2{{{0.5, 0.5}}, {{0.5, 0.5}}}), 300u);
+    const auto nearest = index.nearest(Point2{{0.5, 0.5}}, 300);
+    EXPECT_EQ(nearest.back().squared_distance, 0.0);
+}
+
+TEST(PointIndexTest, BuildIsIndependentOfPoolSize) {
+    const auto points = uniform_points<2>(50'000, 23);
+    ThreadPool one(1);
+    ThreadPool many(8);
+    const PointIndex<2> a(points, one);
+    const PointIndex<2> b(points, many);
+    const Aabb2 box{{{0.2, 0.3}}, {{0.6, 0.4}}};
+    std::vector<std::uint32_t> ids_a;
+    std::vector<std::uint32_t> ids_b;
+    a.query(box, ids_a);
+    b.query(box, ids_b);
+    EXPECT_EQ(ids_a, ids_b);
+}
@@ -1 +1,306 @@
-// Stub test file
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/core/thread_pool.hpp"
+#include "cpptemplate/math/matrix.hpp"
+
+using namespace cpptemplate::math;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+
+namespace {
+
+template<typename T>
+Matrix<T> random_matrix(std::size_t rows, std::size_t cols, std::uint32_t seed) {
+    Matrix<T> m(rows, cols);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<T> dist(T{-1}, T{1});
+    for (auto& value : m.elements()) {
+        value = dist(rng);
+    }
+    return m;
+}
+
+/// c = alpha * a * b + beta * c, accumulated in double
+template<typename T>
+void reference_multiply(MatrixView<const T> a, MatrixView<const T> b, MatrixView<T> c, T alpha,
+                        T beta) {
+    for (std::size_t i = 0; i < c.rows(); ++i) {
+        for (std::size_t j = 0; j < c.cols(); ++j) {
+            double sum = 0.0;
+            for (std::size_t p = 0; p < a.cols(); ++p) {
+                sum += static_cast<double>(a(i, p)) * static_cast<double>(b(p, j));
+            }
+            const double previous = beta == T{0} ? 0.0 : static_cast<double>(beta) * c(i, j);
+            c(i, j) = static_cast<T>(static_cast<double>(alpha) * sum + previous);
+        }
+    }
+}
+
+template<typename T>
+void expect_near(const Matrix<T>& actual, const Matrix<T>& expected, std::size_t depth) {
+    ASSERT_EQ(actual.rows(), expected.rows());
+    ASSERT_EQ(actual.cols(), expected.cols());
+    const double tolerance = (std::is_same_v<T, float> ? 1e-5 : 1e-13) * (depth + 1);
+    for (std::size_t i = 0; i < actual.rows(); ++i) {
+        for (std::size_t j = 0; j < actual.cols(); ++j) {
+            ASSERT_NEAR(actual(i, j), expected(i, j), tolerance) << "at (" << i << ", " << j << ")";
+        }
+    }
+}
+
+} // namespace
+
+TEST(MatrixTest, ConstructionAndAlignment) {
+    const Matrix<double> empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.rows(), 0u);
+
+    Matrix<float> m(3, 5);
+    EXPECT_EQ(m.size(), 15u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(m.data()) % Matrix<float>::Alignment, 0u);
+    for (const auto value : m.elements()) {
+        EXPECT_EQ(value, 0.0F);
+    }
+
+    const Matrix<double> filled(2, 2, 7.5);
+    EXPECT_EQ(filled(1, 1), 7.5);
+
+    const Matrix<double> identity = Matrix<double>::identity(3);
+    EXPECT_EQ(identity(0, 0), 1.0);
+    EXPECT_EQ(identity(0, 1), 0.0);
+}
+
+TEST(MatrixTest, InitializerListAndRows) {
+    const Matrix<double> m{{1, 2, 3}, {4, 5, 6}};
+    EXPECT_EQ(m.rows(), 2u);
+    EXPECT_EQ(m.cols(), 3u);
+    EXPECT_EQ(m(1, 0), 4.0);
+    EXPECT_EQ(m.row(1)[2], 6.0);
+
+    EXPECT_THROW((Matrix<double>{{1, 2}, {3}}), std::invalid_argument);
+}
+
+TEST(MatrixTest, MoveOnlyWithExplicitClone) {
+    static_assert(!std::is_copy_constructible_v<Matrix<double>>);
+    static_assert(std::is_nothrow_move_constructible_v<Matrix<double>>);
+
+    Matrix<double> a{{1, 2}, {3, 4}};
+    const double* storage = a.data();
+    Matrix<double> b = std::move(a);
+    EXPECT_EQ(b.data(), storage);
+    EXPECT_TRUE(a.empty()); // NOLINT(bugprone-use-after-move)
+
+    Matrix<double> c = b.clone();
+    EXPECT_NE(c.data(), b.data());
+    c(0, 0) = 9.0;
+    EXPECT_EQ(b(0, 0), 1.0);
+}
+
+TEST(MatrixTest, ViewsShareStorage) {
+    Matrix<double> m(4, 5);
+    auto block = m.view().block(1, 2, 2, 3);
+    EXPECT_EQ(block.rows(), 2u);
+    EXPECT_EQ(block.cols(), 3u);
+    EXPECT_EQ(block.stride(), 5u);
+
+    block(1, 2) = 42.0;
+    EXPECT_EQ(m(2, 4), 42.0);
+    EXPECT_EQ(block.row(1).size(), 3u);
+
+    const MatrixView<const double> read_only = block;
+    EXPECT_EQ(read_only(1, 2), 42.0);
+
+    EXPECT_THROW(static_cast<void>(m.view().block(3, 0, 2, 1)), std::out_of_range);
+    EXPECT_THROW(static_cast<void>(m.view().block(0, 4, 1, 2)), std::out_of_range);
+    EXPECT_THROW(MatrixView<double>(m.data(), 2, 5, 4), std::invalid_argument);
+}
+
+TEST(MatrixTest, MultiplySmall) {
+    const Matrix<double> a{{1, 2, 3}, {4, 5, 6}};
+    const Matrix<double> b{{7, 8}, {9, 10}, {11, 12}};
+    const Matrix<double> c = a * b;
+    EXPECT_EQ(c.rows(), 2u);
+    EXPECT_EQ(c.cols(), 2u);
+    EXPECT_DOUBLE_EQ(c(0, 0), 58.0);
+    EXPECT_DOUBLE_EQ(c(0, 1), 64.0);
+    EXPECT_DOUBLE_EQ(c(1, 0), 139.0);
+    EXPECT_DOUBLE_EQ(c(1, 1), 154.0);
+
+    EXPECT_THROW(static_cast<void>(a * a), std::invalid_argument);
+}
+
+TEST(MatrixTest, MultiplyIgnoresNanInOutputWhenBetaIsZero) {
+    const auto a = random_matrix<double>(5, 4, 1);
+    const auto b = random_matrix<double>(4, 6, 2);
+    Matrix<double> c(5, 6, std::nan(""));
+    multiply(a, b, c);
+    for (const auto value : c.elements()) {
+        EXPECT_FALSE(std::isnan(value));
+    }
+}
+
+// Products checked against a reference on every kernel level the CPU supports
+template<typename T>
+class MatrixMultiplyTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+        set_gemm_threads(0);
+    }
+
+    /// Run fn once per supported SimdLevel
+    template<typename F>
+    void for_each_level(F fn) {
+        for (const auto level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+            if (set_simd_level(level) != level) {
+                continue;
+            }
+            SCOPED_TRACE(std::string(to_string(level)));
+            fn();
+        }
+    }
+};
+
+using MatrixElementTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(MatrixMultiplyTest, MatrixElementTypes);
+
+TYPED_TEST(MatrixMultiplyTest, MatchesReferenceForOddShapes) {
+    using T = TypeParam;
+    // Shapes around tile and block edges, and a depth spanning two K blocks
+    const std::size_t shapes[][3] = {
+        {1, 1, 1}, {7, 5, 3}, {6, 16, 8}, {13, 29, 17}, {33, 50, 300}, {130, 97, 64},
+    };
+    this->for_each_level([&] {
+        for (const auto& shape : shapes) {
+            const auto a = random_matrix<T>(shape[0], shape[2], 3);
+            const auto b = random_matrix<T>(shape[2], shape[1], 4);
+            Matrix<T> expected(shape[0], shape[1]);
+            reference_multiply<T>(a, b, expected, T{1}, T{0});
+            expect_near(a * b, expected, shape[2]);
+        }
+    });
+}
+
+TYPED_TEST(MatrixMultiplyTest, AlphaBetaAndBlockViews) {
+    using T = TypeParam;
+    this->for_each_level([&] {
+        const auto big_a = random_matrix<T>(40, 40, 5);
+        const auto big_b = random_matrix<T>(40, 40, 6);
+        auto c = random_matrix<T>(40, 40, 7);
+        auto expected = c.clone();
+
+        const auto a = big_a.view().block(3, 5, 21, 17);
+        const auto b = big_b.view().block(1, 2, 17, 30);
+        multiply(a, b, c.view().block(9, 4, 21, 30), T{2}, T{0.5});
+        reference_multiply<T>(a, b, expected.view().block(9, 4, 21, 30), T{2}, T{0.5});
+        expect_near(c, expected, 17);
+    });
+}
+
+TYPED_TEST(MatrixMultiplyTest, ParallelSplitMatchesReference) {
+    using T = TypeParam;
+    // A pool larger than the limit, so the split does not depend on the machine
+    cpptemplate::core::ThreadPool pool(4);
+    set_gemm_threads(3);
+    this->for_each_level([&] {
+        // Tall and wide shapes split rows and columns respectively
+        const std::size_t shapes[][3] = {{301, 150, 120}, {150, 301, 120}};
+        for (const auto& shape : shapes) {
+            const auto a = random_matrix<T>(shape[0], shape[2], 8);
+            const auto b = random_matrix<T>(shape[2], shape[1], 9);
+            Matrix<T> expected(shape[0], shape[1]);
+            reference_multiply<T>(a, b, expected, T{1}, T{0});
+            Matrix<T> c(shape[0], shape[1]);
+            multiply(a.view(), b.view(), c.view(), T{1}, T{0}, pool);
+            expect_near(c, expected, shape[2]);
+            expect_near(a * b, expected, shape[2]);
+        }
+    });
+}
+
+// Expression templates
+TEST(MatrixExpressionTest, FusedChainMatchesElementwiseResult) {
+    const auto a = random_matrix<double>(9, 13, 10);
+    const auto b = random_matrix<double>(9, 13, 11);
+    const auto d = random_matrix<double>(9, 13, 12);
+
+    const Matrix<double> result = a + b * 3.0 - d;
+    for (std::size_t i = 0; i < a.rows(); ++i) {
+        for (std::size_t j = 0; j < a.cols(); ++j) {
+            EXPECT_DOUBLE_EQ(result(i, j), a(i, j) + b(i, j) * 3.0 - d(i, j));
+        }
+    }
+
+    const Matrix<double> other = -(2 * hadamard(a, b)) / 4;
+    EXPECT_DOUBLE_EQ(other(2, 3), -(2 * a(2, 3) * b(2, 3)) / 4);
+}
+
+TEST(MatrixExpressionTest, EvaluationIsLazy) {
+    Matrix<double> a{{1, 2}, {3, 4}};
+    const Matrix<double> b{{10, 20}, {30, 40}};
+    const auto sum = a + b;
+    static_assert(MatrixExpression<decltype(sum)>);
+    EXPECT_EQ(sum.rows(), 2u);
+
+    a(0, 0) = 100; // Seen by the unevaluated expression
+    const auto result = sum.eval();
+    static_assert(std::is_same_v<decltype(result), const Matrix<double>>);
+    EXPECT_EQ(result(0, 0), 110.0);
+    EXPECT_EQ(result(1, 1), 44.0);
+}
+
+TEST(MatrixExpressionTest, ShapeMismatchThrowsWhenBuilt) {
+    const Matrix<float> a(2, 3);
+    const Matrix<float> b(3, 2);
+    EXPECT_THROW(static_cast<void>(a + b), std::invalid_argument);
+    EXPECT_THROW(static_cast<void>(a - b * 2.0F), std::invalid_argument);
+}
+
+TEST(MatrixExpressionTest, TemporariesAreOwnedByTheExpression) {
+    const Matrix<double> a{{1, 2}, {3, 4}};
+    const Matrix<double> identity = Matrix<double>::identity(2);
+    // a * identity is a matrix product held by the expression
+    const auto expression = a * identity + a;
+    const Matrix<double> result = expression;
+    EXPECT_EQ(result(1, 0), 6.0);
+}
+
+TEST(MatrixExpressionTest, AssignmentMayReadTheTarget) {
+    Matrix<double> x{{1, 2}, {3, 4}};
+    const Matrix<double> y{{1, 1}, {1, 1}};
+    const double* storage = x.data();
+
+    x = x * 2.0 + y;
+    EXPECT_EQ(x.data(), storage); // Same shape: evaluated in place
+    EXPECT_EQ(x(1, 1), 9.0);
+
+    x += y;
+    x -= y * 3.0;
+    x *= 2.0;
+    x /= 4.0;
+    EXPECT_EQ(x(0, 0), (3.0 + 1.0 - 3.0) * 2.0 / 4.0);
+
+    x = Matrix<double>(3, 1, 1.0) * 5.0; // New shape: reallocated
+    EXPECT_EQ(x.rows(), 3u);
+    EXPECT_EQ(x(2, 0), 5.0);
+}
+
+TEST(MatrixExpressionTest, AssignIntoBlock) {
+    Matrix<float> m(4, 4);
+    const Matrix<float> ones(2, 3, 1.0F);
+    assign(m.view().block(1, 1, 2, 3), ones * 2.0F + m.view().block(1, 1, 2, 3));
+    EXPECT_EQ(m(0, 0), 0.0F);
+    EXPECT_EQ(m(1, 1), 2.0F);
+    EXPECT_EQ(m(2, 3), 2.0F);
+    EXPECT_EQ(m(3, 3), 0.0F);
+    EXPECT_THROW(assign(m.view(), ones * 1.0F), std::invalid_argument);
+}
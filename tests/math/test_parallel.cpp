@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "cpptemplate/math/parallel.hpp"
+
+using namespace cpptemplate::math;
+using cpptemplate::core::ThreadPool;
+
+namespace {
+
+std::vector<double> random_values(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+    std::vector<double> values(n);
+    for (auto& v : values) {
+        v = dist(rng);
+    }
+    return values;
+}
+
+/// Exact-ish reference: long double accumulation
+long double reference_sum(const std::vector<double>& values) {
+    return std::accumulate(values.begin(), values.end(), 0.0L);
+}
+
+} // namespace
+
+class ParallelTest : public ::testing::TestWithParam<std::size_t> {
+protected:
+    ThreadPool pool_{GetParam()};
+};
+
+TEST_P(ParallelTest, SumIsAccurateAndDeterministic) {
+    for (const std::size_t n : {0u, 1u, 255u, 70'000u, 1'000'003u}) {
+        const auto values = random_values(n, static_cast<unsigned>(n));
+        const double sum = parallel_sum(values, pool_);
+        EXPECT_NEAR(sum, static_cast<double>(reference_sum(values)), 1e-9 * std::max(1.0, std::sqrt(double(n))));
+        ThreadPool serial(1);
+        EXPECT_EQ(sum, parallel_sum(values, serial)); // Bit-identical across pool sizes
+    }
+}
+
+TEST_P(ParallelTest, SumStaysAccurateWhereNaiveLoopDrifts) {
+    // 10^7 copies of 0.1: a left-to-right double loop is off by ~1e-4 relative
+    const std::vector<double> values(10'000'000, 0.1);
+    EXPECT_NEAR(parallel_sum(values, pool_), 1e6, 1e-7);
+}
+
+TEST_P(ParallelTest, Dot) {
+    const auto a = random_values(300'001, 1);
+    const auto b = random_values(300'001, 2);
+    long double expected = 0.0L;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        expected += static_cast<long double>(a[i]) * b[i];
+    }
+    EXPECT_NEAR(parallel_dot(a, b, pool_), static_cast<double>(expected), 1e-3);
+    EXPECT_THROW((void)parallel_dot(a, std::span<const double>(b).first(10), pool_), std::invalid_argument);
+}
+
+TEST_P(ParallelTest, MinMaxFindsFirstOccurrence) {
+    auto values = random_values(500'000, 3);
+    values[123'456] = -5000.0;
+    values[400'000] = -5000.0;
+    values[77] = 5000.0;
+    values[499'999] = 5000.0;
+    const MinMax result = parallel_min_max(values, pool_);
+    EXPECT_EQ(result.min, -5000.0);
+    EXPECT_EQ(result.argmin, 123'456u);
+    EXPECT_EQ(result.max, 5000.0);
+    EXPECT_EQ(result.argmax, 77u);
+    EXPECT_THROW((void)parallel_min_max({}, pool_), std::invalid_argument);
+}
+
+TEST_P(ParallelTest, Histogram) {
+    auto values = random_values(400'000, 4);
+    values.push_back(1000.0);   // Upper edge, last bin
+    values.push_back(1e9);      // Out of range
+    values.push_back(NAN);      // Not counted
+    const auto counts = parallel_histogram(values, -1000.0, 1000.0, 20, pool_);
+    ASSERT_EQ(counts.size(), 20u);
+
+    std::vector<std::uint64_t> expected(20);
+    for (const double v : values) {
+        if (v >= -1000.0 && v <= 1000.0) {
+            ++expected[std::min<std::size_t>(static_cast<std::size_t>((v + 1000.0) / 100.0), 19)];
+        }
+    }
+    EXPECT_EQ(counts, expected);
+    EXPECT_EQ(std::accumulate(counts.begin(), counts.end(), std::uint64_t{0}), 400'001u);
+    EXPECT_THROW((void)parallel_histogram(values, 1.0, 1.0, 4, pool_), std::invalid_argument);
+    EXPECT_THROW((void)parallel_histogram(values, 0.0, 1.0, 0, pool_), std::invalid_argument);
+}
+
+TEST_P(ParallelTest, Sort) {
+    for (const std::size_t n : {0u, 1u, 1000u, 100'000u, 1'000'003u}) {
+        auto values = random_values(n, static_cast<unsigned>(n) + 7);
+        // Plenty of duplicates to exercise ties across merge pieces
+        for (std::size_t i = 0; i < n; i += 3) {
+            values[i] = std::round(values[i] / 100.0);
+        }
+        auto expected = values;
+        std::sort(expected.begin(), expected.end());
+        parallel_sort(values, pool_);
+        ASSERT_EQ(values, expected) << "n = " << n;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(PoolSizes, ParallelTest, ::testing::Values(1u, 2u, 3u, 8u));
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "cpptemplate/math/quantile_sketch.hpp"
+
+using namespace cpptemplate::math;
+
+namespace {
+
+std::vector<double> latency_samples(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::lognormal_distribution<double> dist(0.0, 1.5);
+    std::vector<double> values(n);
+    for (auto& v : values) {
+        v = dist(rng);
+    }
+    return values;
+}
+
+double exact_quantile(std::vector<double> values, double q) {
+    std::sort(values.begin(), values.end());
+    return values[static_cast<std::size_t>(q * static_cast<double>(values.size() - 1))];
+}
+
+void expect_within_accuracy(const QuantileSketch& sketch, const std::vector<double>& values) {
+    for (const double q : {0.0, 0.01, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 1.0}) {
+        const double exact = exact_quantile(values, q);
+        const double tolerance = std::abs(exact) * sketch.relative_accuracy() * (1.0 + 1e-9);
+        EXPECT_NEAR(sketch.quantile(q), exact, tolerance) << "q = " << q;
+    }
+}
+
+} // namespace
+
+TEST(QuantileSketchTest, RejectsInvalidConfiguration) {
+    EXPECT_THROW(QuantileSketch(0.0), std::invalid_argument);
+    EXPECT_THROW(QuantileSketch(1.0), std::invalid_argument);
+    EXPECT_THROW(QuantileSketch(0.01, 0), std::invalid_argument);
+    EXPECT_THROW(ConcurrentQuantileSketch(0.01, 0.0, 1.0), std::invalid_argument);
+    EXPECT_THROW(ConcurrentQuantileSketch(0.01, 2.0, 1.0), std::invalid_argument);
+}
+
+TEST(QuantileSketchTest, EmptySketch) {
+    const QuantileSketch sketch;
+    EXPECT_TRUE(sketch.empty());
+    EXPECT_TRUE(std::isnan(sketch.quantile(0.5)));
+    EXPECT_THROW((void)sketch.quantile(1.5), std::invalid_argument);
+    EXPECT_THROW((void)sketch.quantile(std::numeric_limits<double>::quiet_NaN()), std::invalid_argument);
+}
+
+TEST(QuantileSketchTest, QuantilesWithinRelativeAccuracy) {
+    for (const double accuracy : {0.05, 0.01, 0.001}) {
+        const auto values = latency_samples(100'000, 1);
+        QuantileSketch sketch(accuracy, 1u << 14); // 0.1% needs ~6500 bins for this range
+        sketch.add(values);
+        EXPECT_EQ(sketch.count(), values.size());
+        EXPECT_EQ(sketch.min(), *std::min_element(values.begin(), values.end()));
+        EXPECT_EQ(sketch.max(), *std::max_element(values.begin(), values.end()));
+        expect_within_accuracy(sketch, values);
+    }
+}
+
+TEST(QuantileSketchTest, NegativeZeroAndNonFiniteSamples) {
+    std::vector<double> values;
+    for (int i = -500; i <= 500; ++i) {
+        values.push_back(i * 0.75);
+    }
+    QuantileSketch sketch(0.01);
+    sketch.add(values);
+    sketch.add(std::numeric_limits<double>::quiet_NaN());
+    sketch.add(std::numeric_limits<double>::infinity());
+    EXPECT_EQ(sketch.count(), values.size());
+    EXPECT_EQ(sketch.quantile(0.5), 0.0);
+    expect_within_accuracy(sketch, values);
+}
+
+TEST(QuantileSketchTest, AccuracyDeterminesMemory) {
+    const auto values = latency_samples(100'000, 2);
+    QuantileSketch coarse(0.05);
+    QuantileSketch fine(0.001, 1u << 14);
+    coarse.add(values);
+    fine.add(values);
+    EXPECT_LT(coarse.bin_count() * 10, fine.bin_count());
+}
+
+TEST(QuantileSketchTest, BinLimitCollapsesLowestValues) {
+    QuantileSketch sketch(0.01, 64);
+    std::vector<double> values;
+    for (int i = 0; i < 10'000; ++i) {
+        values.push_back(std::pow(1.01, i % 2000));
+    }
+    sketch.add(values);
+    EXPECT_LE(sketch.bin_count(), 64u);
+    // Upper quantiles keep the guarantee; the minimum stays exact
+    const double exact = exact_quantile(values, 0.99);
+    EXPECT_NEAR(sketch.quantile(0.99), exact, exact * 0.01);
+    EXPECT_EQ(sketch.quantile(0.0), 1.0);
+}
+
+TEST(QuantileSketchTest, MergeEqualsSingleSketch) {
+    const auto values = latency_samples(50'000, 3);
+    QuantileSketch whole(0.01);
+    whole.add(values);
+
+    QuantileSketch left(0.01);
+    QuantileSketch right(0.01);
+    left.add(std::span<const double>(values).first(10'000));
+    right.add(std::span<const double>(values).subspan(10'000));
+    left.merge(right);
+    left.merge(QuantileSketch(0.01));
+
+    EXPECT_EQ(left.count(), whole.count());
+    for (const double q : {0.0, 0.5, 0.99, 0.999, 1.0}) {
+        EXPECT_EQ(left.quantile(q), whole.quantile(q));
+    }
+    EXPECT_THROW(left.merge(QuantileSketch(0.02)), std::invalid_argument);
+}
+
+TEST(QuantileSketchTest, SerializationRoundTrip) {
+    const auto values = latency_samples(100'000, 4);
+    QuantileSketch sketch(0.01);
+    sketch.add(values);
+    sketch.add(-3.0, 5);
+    sketch.add(0.0);
+
+    const auto bytes = sketch.serialize();
+    EXPECT_LT(bytes.size(), sketch.bin_count() * 3 + 64);
+    const auto copy = QuantileSketch::deserialize(bytes);
+    EXPECT_EQ(copy.count(), sketch.count());
+    EXPECT_EQ(copy.sum(), sketch.sum());
+    EXPECT_EQ(copy.relative_accuracy(), sketch.relative_accuracy());
+    for (const double q : {0.0, 0.001, 0.5, 0.99, 1.0}) {
+        EXPECT_EQ(copy.quantile(q), sketch.quantile(q));
+    }
+
+    auto truncated = bytes;
+    truncated.pop_back();
+    EXPECT_THROW((void)QuantileSketch::deserialize(truncated), std::invalid_argument);
+    auto trailing = bytes;
+    trailing.push_back(std::byte{0});
+    EXPECT_THROW((void)QuantileSketch::deserialize(trailing), std::invalid_argument);
+    EXPECT_THROW((void)QuantileSketch::deserialize({}), std::invalid_argument);
+}
+
+TEST(ConcurrentQuantileSketchTest, ParallelAddsAndMerges) {
+    constexpr int Threads = 4;
+    const auto values = latency_samples(40'000, 5);
+    ConcurrentQuantileSketch shared(0.01, 1e-6, 1e6);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < Threads; ++t) {
+        threads.emplace_back([&, t] {
+            const auto part = std::span<const double>(values).subspan(t * 10'000, 10'000);
+            if (t % 2 == 0) {
+                for (const double v : part) {
+                    shared.add(v);
+                }
+            } else {
+                QuantileSketch local(0.01);
+                local.add(part);
+                shared.merge(local);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const QuantileSketch snapshot = shared.snapshot();
+    EXPECT_EQ(snapshot.count(), values.size());
+    EXPECT_EQ(snapshot.min(), *std::min_element(values.begin(), values.end()));
+    EXPECT_EQ(snapshot.max(), *std::max_element(values.begin(), values.end()));
+    expect_within_accuracy(snapshot, values);
+}
@@ -1 +1,179 @@
-// Stub test file
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/math/statistics.hpp"
+
+using namespace cpptemplate::math;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+
+namespace {
+
+/// Two-pass reference moments
+struct Reference {
+    explicit Reference(const std::vector<double>& values) {
+        const double n = static_cast<double>(values.size());
+        for (const double v : values) {
+            mean += v;
+        }
+        mean /= n;
+        double m2 = 0.0;
+        double m3 = 0.0;
+        double m4 = 0.0;
+        for (const double v : values) {
+            const double d = v - mean;
+            m2 += d * d;
+            m3 += d * d * d;
+            m4 += d * d * d * d;
+        }
+        variance = m2 / n;
+        skewness = std::sqrt(n) * m3 / std::pow(m2, 1.5);
+        kurtosis = n * m4 / (m2 * m2) - 3.0;
+    }
+
+    double mean = 0.0;
+    double variance = 0.0;
+    double skewness = 0.0;
+    double kurtosis = 0.0;
+};
+
+std::vector<double> lognormal_samples(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::lognormal_distribution<double> dist(3.0, 0.5);
+    std::vector<double> values(n);
+    for (auto& v : values) {
+        v = dist(rng);
+    }
+    return values;
+}
+
+void expect_matches(const RunningStats& stats, const std::vector<double>& values) {
+    const Reference ref(values);
+    ASSERT_EQ(stats.count(), values.size());
+    EXPECT_NEAR(stats.mean(), ref.mean, 1e-12 * std::abs(ref.mean));
+    EXPECT_NEAR(stats.variance(), ref.variance, 1e-10 * ref.variance);
+    EXPECT_NEAR(stats.skewness(), ref.skewness, 1e-9);
+    EXPECT_NEAR(stats.kurtosis(), ref.kurtosis, 1e-9);
+    EXPECT_EQ(stats.min(), *std::min_element(values.begin(), values.end()));
+    EXPECT_EQ(stats.max(), *std::max_element(values.begin(), values.end()));
+}
+
+} // namespace
+
+TEST(RunningStatsTest, EmptyAndSingleSample) {
+    RunningStats stats;
+    EXPECT_EQ(stats.count(), 0u);
+    EXPECT_EQ(stats.mean(), 0.0);
+    EXPECT_EQ(stats.variance(), 0.0);
+    EXPECT_EQ(stats.min(), std::numeric_limits<double>::infinity());
+
+    stats.add(4.5);
+    EXPECT_EQ(stats.mean(), 4.5);
+    EXPECT_EQ(stats.variance(), 0.0);
+    EXPECT_EQ(stats.sample_variance(), 0.0);
+    EXPECT_EQ(stats.skewness(), 0.0);
+    EXPECT_EQ(stats.min(), 4.5);
+    EXPECT_EQ(stats.max(), 4.5);
+
+    stats.reset();
+    EXPECT_EQ(stats.count(), 0u);
+}
+
+TEST(RunningStatsTest, KnownValues) {
+    RunningStats stats;
+    for (const double v : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) {
+        stats.add(v);
+    }
+    EXPECT_DOUBLE_EQ(stats.mean(), 5.0);
+    EXPECT_DOUBLE_EQ(stats.sum(), 40.0);
+    EXPECT_DOUBLE_EQ(stats.variance(), 4.0);
+    EXPECT_DOUBLE_EQ(stats.stddev(), 2.0);
+    EXPECT_DOUBLE_EQ(stats.sample_variance(), 32.0 / 7.0);
+    EXPECT_EQ(stats.min(), 2.0);
+    EXPECT_EQ(stats.max(), 9.0);
+}
+
+TEST(RunningStatsTest, SampleBySampleMatchesTwoPass) {
+    const auto values = lognormal_samples(10'000, 1);
+    RunningStats stats;
+    for (const double v : values) {
+        stats.add(v);
+    }
+    expect_matches(stats, values);
+}
+
+TEST(RunningStatsTest, StableWithLargeOffset) {
+    // Naive sum-of-squares loses all precision here
+    RunningStats stats;
+    for (int i = 0; i < 1000; ++i) {
+        stats.add(1e9 + (i % 2 == 0 ? 1.0 : -1.0));
+    }
+    EXPECT_NEAR(stats.variance(), 1.0, 1e-6);
+}
+
+TEST(RunningStatsTest, MergeEqualsSingleAccumulator) {
+    const auto values = lognormal_samples(5'000, 2);
+    RunningStats left;
+    RunningStats right;
+    RunningStats empty;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        (i < 1234 ? left : right).add(values[i]);
+    }
+    left.merge(right);
+    left.merge(empty);
+    empty.merge(left);
+    expect_matches(left, values);
+    expect_matches(empty, values);
+}
+
+class RunningStatsSpanTest : public ::testing::TestWithParam<SimdLevel> {
+protected:
+    void SetUp() override {
+        if (set_simd_level(GetParam()) != GetParam()) {
+            GTEST_SKIP() << to_string(GetParam()) << " not supported on this CPU";
+        }
+    }
+
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+    }
+};
+
+TEST_P(RunningStatsSpanTest, SpanUpdateMatchesTwoPass) {
+    // Sizes around vector widths and the internal block size
+    for (const std::size_t n : {1u, 3u, 15u, 17u, 2047u, 2048u, 2049u, 100'003u}) {
+        const auto values = lognormal_samples(n, static_cast<unsigned>(n));
+        RunningStats stats;
+        stats.add(std::span<const double>(values));
+        if (n >= 3) {
+            expect_matches(stats, values);
+        } else {
+            EXPECT_EQ(stats.count(), n);
+            EXPECT_EQ(stats.mean(), values[0]);
+        }
+    }
+}
+
+TEST_P(RunningStatsSpanTest, SpanAndSingleUpdatesMix) {
+    const auto values = lognormal_samples(9'000, 3);
+    RunningStats stats;
+    stats.add(values[0]);
+    stats.add(std::span<const double>(values).subspan(1, 4'000));
+    for (std::size_t i = 4'001; i < 5'000; ++i) {
+        stats.add(values[i]);
+    }
+    stats.add(std::span<const double>(values).subspan(5'000));
+    expect_matches(stats, values);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, RunningStatsSpanTest,
+                         ::testing::Values(SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512),
+                         [](const auto& info) { return std::string(to_string(info.param)); });
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+
+#include "cpptemplate/network/buffer_pool.hpp"
+
+using namespace cpptemplate::network;
+
+TEST(BufferPoolTest, AcquireReleaseReusesMemory) {
+    BufferPool pool(64, 4);
+    Buffer buffer = pool.acquire();
+    ASSERT_TRUE(buffer);
+    EXPECT_EQ(buffer.capacity(), 64u);
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(pool.outstanding(), 1u);
+
+    const char* memory = buffer.write_position();
+    pool.release(buffer);
+    EXPECT_FALSE(buffer);
+    EXPECT_EQ(pool.outstanding(), 0u);
+    EXPECT_EQ(pool.cached(), 1u);
+
+    Buffer again = pool.acquire();
+    EXPECT_EQ(again.write_position(), memory);
+    EXPECT_EQ(pool.cached(), 0u);
+    pool.release(again);
+
+    Buffer empty;
+    pool.release(empty); // No memory, nothing to do
+    EXPECT_EQ(pool.outstanding(), 0u);
+}
+
+TEST(BufferPoolTest, CachesUpToTheLimit) {
+    BufferPool pool(16, 2);
+    Buffer a = pool.acquire();
+    Buffer b = pool.acquire();
+    Buffer c = pool.acquire();
+    pool.release(a);
+    pool.release(b);
+    pool.release(c);
+    EXPECT_EQ(pool.cached(), 2u);
+    EXPECT_EQ(pool.outstanding(), 0u);
+}
+
+TEST(BufferPoolTest, ReadAndWritePositions) {
+    BufferPool pool(8);
+    Buffer buffer = pool.acquire();
+    EXPECT_EQ(buffer.append("abcdefghij"), 8u); // Stops at capacity
+    EXPECT_EQ(buffer.readable(), "abcdefgh");
+    EXPECT_EQ(buffer.writable(), 0u);
+
+    buffer.consume(3);
+    EXPECT_EQ(buffer.readable(), "defgh");
+    EXPECT_EQ(buffer.writable(), 0u);
+    buffer.compact();
+    EXPECT_EQ(buffer.readable(), "defgh");
+    EXPECT_EQ(buffer.writable(), 3u);
+
+    buffer.write_position()[0] = 'x';
+    buffer.commit(1);
+    EXPECT_EQ(buffer.readable(), "defghx");
+
+    buffer.consume(buffer.size()); // Emptied: the whole capacity is writable again
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(buffer.writable(), 8u);
+    pool.release(buffer);
+}
+
+TEST(BufferPoolTest, GrowKeepsReadableBytes) {
+    BufferPool pool(8, 4);
+    Buffer buffer = pool.acquire();
+    buffer.append("12345678");
+    buffer.consume(2);
+
+    pool.grow(buffer, 32);
+    EXPECT_EQ(buffer.capacity(), 32u);
+    EXPECT_EQ(buffer.readable(), "345678");
+    EXPECT_EQ(buffer.writable(), 26u);
+    EXPECT_EQ(pool.outstanding(), 1u);
+    EXPECT_EQ(pool.cached(), 1u); // The original went back
+
+    pool.release(buffer); // Oversized: freed, not cached
+    EXPECT_EQ(pool.cached(), 1u);
+    EXPECT_EQ(pool.outstanding(), 0u);
+}
+
+TEST(BufferPoolTest, BuffersMove) {
+    BufferPool pool(16);
+    Buffer a = pool.acquire();
+    a.append("hello");
+    Buffer b = std::move(a);
+    EXPECT_FALSE(a); // NOLINT(bugprone-use-after-move)
+    EXPECT_EQ(b.readable(), "hello");
+    pool.release(b);
+}
@@ -0,0 +1,361 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/network/http.hpp"
+#include "cpptemplate/network/tcp_server.hpp"
+
+#if defined(__linux__)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+using namespace cpptemplate::network;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+using Status = HttpParseResult::Status;
+
+namespace {
+
+constexpr std::string_view BrowserRequest =
+    "GET /search?q=zero+copy&lang=en HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Cookie: session=0123456789abcdef; theme=dark\r\n"
+    "X-Empty:\r\n"
+    "X-Padded: \t padded value \t \r\n"
+    "\r\n";
+
+constexpr std::string_view PostRequest = "POST /api/items HTTP/1.1\r\n"
+                                         "Host: api.example.com\r\n"
+                                         "Content-Type: application/json\r\n"
+                                         "Content-Length: 14\r\n"
+                                         "\r\n"
+                                         "{\"id\": 42}\r\n\r\n";
+
+/// Parser tests run on every SIMD level the CPU supports, since the kernels do the scanning
+class HttpParserTest : public ::testing::TestWithParam<SimdLevel> {
+protected:
+    void SetUp() override {
+        if (set_simd_level(GetParam()) != GetParam()) {
+            GTEST_SKIP() << to_string(GetParam()) << " not supported on this CPU";
+        }
+    }
+
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+    }
+
+    /// Parse bytes in one go and return the error code, 0 if Complete
+    static int error_of(std::string_view bytes, HttpLimits limits = {}) {
+        HttpParser parser(limits);
+        HttpRequest request;
+        const auto result = parser.parse(bytes, request);
+        EXPECT_NE(result.status, Status::Incomplete) << bytes;
+        return result.error;
+    }
+};
+
+} // namespace
+
+TEST_P(HttpParserTest, ParsesRequestLineAndHeadersAsViews) {
+    HttpParser parser;
+    HttpRequest request;
+    const auto result = parser.parse(BrowserRequest, request);
+    ASSERT_EQ(result.status, Status::Complete);
+    EXPECT_EQ(result.consumed, BrowserRequest.size());
+
+    EXPECT_EQ(request.method, "GET");
+    EXPECT_EQ(request.target, "/search?q=zero+copy&lang=en");
+    EXPECT_EQ(request.path, "/search");
+    EXPECT_EQ(request.query, "q=zero+copy&lang=en");
+    EXPECT_EQ(request.minor_version, 1);
+    EXPECT_TRUE(request.keep_alive);
+    EXPECT_TRUE(request.body.empty());
+
+    ASSERT_EQ(request.headers().size(), 7u);
+    EXPECT_EQ(request.headers()[0].name, "Host");
+    EXPECT_EQ(request.header("host"), "www.example.com");
+    EXPECT_EQ(request.header("COOKIE"), "session=0123456789abcdef; theme=dark");
+    EXPECT_EQ(request.header("x-empty"), "");
+    EXPECT_EQ(request.header("X-Padded"), "padded value");
+    EXPECT_EQ(request.header("Missing").data(), nullptr);
+
+    // Views into the input, not copies
+    const auto inside = [&](std::string_view view) {
+        return view.data() >= BrowserRequest.data() &&
+               view.data() + view.size() <= BrowserRequest.data() + BrowserRequest.size();
+    };
+    EXPECT_TRUE(inside(request.method));
+    EXPECT_TRUE(inside(request.path));
+    EXPECT_TRUE(inside(request.header("User-Agent")));
+}
+
+TEST_P(HttpParserTest, BodyIsFramedByContentLength) {
+    HttpParser parser;
+    HttpRequest request;
+    const auto result = parser.parse(PostRequest, request);
+    ASSERT_EQ(result.status, Status::Complete);
+    EXPECT_EQ(result.consumed, PostRequest.size());
+    EXPECT_EQ(request.method, "POST");
+    EXPECT_EQ(request.body, "{\"id\": 42}\r\n\r\n");
+    EXPECT_EQ(request.query, "");
+}
+
+TEST_P(HttpParserTest, ByteByByteGivesTheSameRequest) {
+    for (const std::string_view input : {BrowserRequest, PostRequest}) {
+        HttpParser parser;
+        HttpRequest request;
+        for (std::size_t n = 0; n < input.size(); ++n) {
+            ASSERT_EQ(parser.parse(input.substr(0, n), request).status, Status::Incomplete) << n;
+        }
+        const auto result = parser.parse(input, request);
+        ASSERT_EQ(result.status, Status::Complete);
+        EXPECT_EQ(result.consumed, input.size());
+        EXPECT_EQ(request.header("Host").empty(), false);
+    }
+}
+
+TEST_P(HttpParserTest, PipelinedRequestsParseOneAfterAnother) {
+    const std::string pipeline = std::string(PostRequest) + std::string(BrowserRequest) +
+                                 "GET /last HTTP/1.1\nHost: x\nConnection: close\n\nGET /partial";
+    HttpParser parser;
+    HttpRequest request;
+    std::string_view rest = pipeline;
+    std::vector<std::string> paths;
+    for (;;) {
+        const auto result = parser.parse(rest, request);
+        if (result.status != Status::Complete) {
+            EXPECT_EQ(result.status, Status::Incomplete);
+            break;
+        }
+        paths.emplace_back(request.path);
+        rest.remove_prefix(result.consumed);
+    }
+    EXPECT_EQ(paths, (std::vector<std::string>{"/api/items", "/search", "/last"}));
+    EXPECT_FALSE(request.keep_alive);
+    EXPECT_EQ(rest, "GET /partial");
+}
+
+TEST_P(HttpParserTest, KeepAliveFollowsVersionAndConnection) {
+    const auto keep_alive = [](std::string_view bytes) {
+        HttpParser parser;
+        HttpRequest request;
+        EXPECT_EQ(parser.parse(bytes, request).status, Status::Complete) << bytes;
+        return request.keep_alive;
+    };
+    EXPECT_TRUE(keep_alive("GET / HTTP/1.1\r\n\r\n"));
+    EXPECT_FALSE(keep_alive("GET / HTTP/1.1\r\nConnection: Upgrade, Close\r\n\r\n"));
+    EXPECT_FALSE(keep_alive("GET / HTTP/1.0\r\n\r\n"));
+    EXPECT_TRUE(keep_alive("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"));
+    EXPECT_TRUE(keep_alive("\r\n\r\nGET / HTTP/1.1\r\n\r\n"));
+}
+
+TEST_P(HttpParserTest, MalformedRequestsGetTheirStatus) {
+    EXPECT_EQ(error_of("GET / HTTP/1.1\r\n\r\n"), 0);
+    EXPECT_EQ(error_of("G@T / HTTP/1.1\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET  / HTTP/1.1\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET /a\x7F HTTP/1.1\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET / FTP/1.1\r\n"), 400);
+    EXPECT_EQ(error_of("GET / FT"), 400);
+    EXPECT_EQ(error_of("GET / HTTP/2.0\r\n\r\n"), 505);
+    EXPECT_EQ(error_of("GET / HTTP/1.1\rX\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET / HTTP/1.1\r\nNo-Colon\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET / HTTP/1.1\r\nBad Name: x\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET / HTTP/1.1\r\nA: b\r\n folded\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET / HTTP/1.1\r\nA: b\x01" "c\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n"), 400);
+    EXPECT_EQ(error_of("GET / HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n"), 413);
+    const HttpLimits small_body{.max_head = 1024, .max_body = 10};
+    EXPECT_EQ(error_of("GET / HTTP/1.1\r\nContent-Length: 11\r\n\r\n", small_body), 413);
+    EXPECT_EQ(error_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"), 501);
+
+    std::string many = "GET / HTTP/1.1\r\n";
+    for (std::size_t i = 0; i <= HttpRequest::MaxHeaders; ++i) {
+        many += "X: y\r\n";
+    }
+    EXPECT_EQ(error_of(many + "\r\n"), 431);
+}
+
+TEST_P(HttpParserTest, OversizedHeadIsRejectedWhileArriving) {
+    HttpParser parser({.max_head = 256, .max_body = 1024});
+    HttpRequest request;
+    std::string input = "GET / HTTP/1.1\r\nX-Long: ";
+    EXPECT_EQ(parser.parse(input, request).status, Status::Incomplete);
+    input.append(300, 'a');
+    const auto result = parser.parse(input, request);
+    EXPECT_EQ(result.status, Status::Error);
+    EXPECT_EQ(result.error, 431);
+}
+
+TEST_P(HttpParserTest, LongValuesCrossEveryVectorWidth) {
+    // Values ending at each offset around the 16- and 32-byte strides, with an
+    // invalid byte planted at the end
+    for (std::size_t n = 0; n <= 70; ++n) {
+        std::string value(n, 'v');
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [i = 0](char) mutable { return static_cast<char>(0x80 + i++ % 0x7F); });
+        const std::string good = "GET /" + value + " HTTP/1.1\r\nA: " + value + "\r\n\r\n";
+        HttpParser parser;
+        HttpRequest request;
+        ASSERT_EQ(parser.parse(good, request).status, Status::Complete) << n;
+        EXPECT_EQ(request.header("a"), value);
+        EXPECT_EQ(request.path.size(), n + 1);
+        EXPECT_EQ(error_of("GET / HTTP/1.1\r\nA: " + value + "\x1F\r\n\r\n"), 400) << n;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, HttpParserTest,
+                         ::testing::Values(SimdLevel::Scalar, SimdLevel::Sse42, SimdLevel::Avx2,
+                                           SimdLevel::Avx512, SimdLevel::Neon),
+                         [](const auto& info) {
+                             std::string name(to_string(info.param));
+                             std::replace(name.begin(), name.end(), '.', '_');
+                             return name;
+                         });
+
+TEST(HttpResponseTest, HeadCarriesStatusHeadersAndLength) {
+    HttpResponse response(404);
+    response.header("Content-Type", "text/plain").body("missing");
+    EXPECT_EQ(response.head(), "HTTP/1.1 404 Not Found\r\n"
+                               "Content-Type: text/plain\r\n"
+                               "Content-Length: 7\r\n"
+                               "\r\n");
+    EXPECT_THROW(response.header("Late", "x"), std::logic_error);
+    const auto pieces = response.pieces();
+    EXPECT_EQ(pieces[1], "missing");
+}
+
+TEST(HttpResponseTest, CloseAndBodylessStatuses) {
+    HttpResponse closing(200, "Fine");
+    closing.keep_alive(false);
+    EXPECT_EQ(closing.head(),
+              "HTTP/1.1 200 Fine\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+
+    HttpResponse empty(204);
+    EXPECT_EQ(empty.head(), "HTTP/1.1 204 No Content\r\n\r\n");
+
+    EXPECT_THROW(HttpResponse(99), std::invalid_argument);
+    EXPECT_EQ(http_reason(431), "Request Header Fields Too Large");
+    EXPECT_EQ(http_reason(299), "Unknown");
+}
+
+TEST(HttpResponseTest, RejectsLineBreaksInTheHead) {
+    HttpResponse response;
+    EXPECT_THROW(response.header("Location", "/a\r\nSet-Cookie: x=1"), std::invalid_argument);
+    EXPECT_THROW(response.header("Location", "/a\n\n<html>"), std::invalid_argument);
+    EXPECT_THROW(response.header("Location", std::string_view("/a\0b", 4)), std::invalid_argument);
+    EXPECT_THROW(response.header("X-A\r\nX-B", "1"), std::invalid_argument);
+    EXPECT_THROW(response.header("X A", "1"), std::invalid_argument);
+    EXPECT_THROW(response.header("", "1"), std::invalid_argument);
+    EXPECT_THROW(HttpResponse(200, "OK\r\nSet-Cookie: x=1"), std::invalid_argument);
+
+    // Rejected headers leave nothing behind; tabs and obs-text are valid in values
+    response.header("X-Tab", "a\tb \xff");
+    EXPECT_EQ(response.head(), "HTTP/1.1 200 OK\r\n"
+                               "X-Tab: a\tb \xff\r\n"
+                               "Content-Length: 0\r\n"
+                               "\r\n");
+}
+
+TEST(HttpResponseTest, LongHeadMovesToTheHeap) {
+    HttpResponse response;
+    const std::string value(1000, 'x');
+    response.header("A", value).header("B", value).own_body(std::string(5, 'b'));
+    const std::string_view head = response.head();
+    EXPECT_TRUE(head.starts_with("HTTP/1.1 200 OK\r\nA: " + value + "\r\nB: " + value));
+    EXPECT_TRUE(head.ends_with("Content-Length: 5\r\n\r\n"));
+    EXPECT_EQ(response.body(), "bbbbb");
+}
+
+#if defined(__linux__)
+
+TEST(HttpResponseTest, WriteGathersHeadAndBody) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    const std::string body(100000, 'z'); // More than the socket buffer, so writev() returns short
+    HttpResponse response;
+    response.body(body);
+    const std::string expected = std::string(response.head()) + body;
+
+    std::string received;
+    std::thread reader([&] {
+        char buffer[4096];
+        for (ssize_t n; (n = ::read(fds[1], buffer, sizeof buffer)) > 0;) {
+            received.append(buffer, static_cast<std::size_t>(n));
+        }
+    });
+    EXPECT_TRUE(response.write(fds[0]));
+    ::close(fds[0]);
+    reader.join();
+    ::close(fds[1]);
+    EXPECT_EQ(received, expected);
+}
+
+TEST(HttpResponseTest, ServesPipelinedRequestsOverTcpServer) {
+    ServerOptions options;
+    options.host = "127.0.0.1";
+    options.threads = 1;
+    TcpServer server(options);
+    server.on_connect(
+        [](Connection& connection) { connection.set_user_data(std::make_shared<HttpParser>()); });
+    server.on_data([](Connection& connection, std::string_view bytes) {
+        auto& parser = *connection.user_data<HttpParser>();
+        std::size_t consumed = 0;
+        HttpRequest request;
+        for (;;) {
+            const auto result = parser.parse(bytes.substr(consumed), request);
+            if (result.status != Status::Complete) {
+                break;
+            }
+            consumed += result.consumed;
+            HttpResponse response;
+            response.body(request.path).keep_alive(request.keep_alive).send(connection);
+            if (!request.keep_alive) {
+                connection.close();
+                break;
+            }
+        }
+        return consumed;
+    });
+    server.start();
+
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    timeval timeout{5, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(server.port());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof address), 0);
+    const std::string_view requests =
+        "GET /a HTTP/1.1\r\n\r\nGET /bb HTTP/1.1\r\n\r\nGET /c HTTP/1.0\r\n\r\n";
+    ASSERT_EQ(::send(fd, requests.data(), requests.size(), MSG_NOSIGNAL),
+              static_cast<ssize_t>(requests.size()));
+
+    std::string received;
+    char buffer[4096];
+    for (ssize_t n; (n = ::recv(fd, buffer, sizeof buffer, 0)) > 0;) {
+        received.append(buffer, static_cast<std::size_t>(n));
+    }
+    ::close(fd);
+    EXPECT_EQ(received, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n/a"
+                        "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\n/bb"
+                        "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\n/c");
+}
+
+#endif
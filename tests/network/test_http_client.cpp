@@ -0,0 +1,458 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cpptemplate/network/http.hpp"
+#include "cpptemplate/network/http_client.hpp"
+#include "cpptemplate/network/tcp_server.hpp"
+
+#if defined(__linux__)
+
+using namespace cpptemplate::network;
+using namespace std::chrono_literals;
+
+namespace {
+
+/// Per-connection state of LoopbackServer
+struct ServerConnection {
+    HttpParser parser;
+    int requests = 0;
+};
+
+/**
+ * Loopback HTTP server answering each request with its path. A custom
+ * handler may instead write raw bytes and return false to close.
+ */
+class LoopbackServer {
+public:
+    /// Gets the request and its number on the connection, from 1; returns whether to keep it open
+    using Handler = std::function<bool(Connection&, const HttpRequest&, int)>;
+
+    explicit LoopbackServer(Handler handler = {})
+        : handler_(std::move(handler)), server_(options()) {
+        server_.on_connect([](Connection& connection) {
+            connection.set_user_data(std::make_shared<ServerConnection>());
+        });
+        server_.on_data([this](Connection& connection, std::string_view bytes) {
+            auto& state = *connection.user_data<ServerConnection>();
+            std::size_t consumed = 0;
+            HttpRequest request;
+            while (!connection.closing()) {
+                const auto result = state.parser.parse(bytes.substr(consumed), request);
+                if (result.status != HttpParseResult::Status::Complete) {
+                    break;
+                }
+                consumed += result.consumed;
+                if (handler_) {
+                    if (!handler_(connection, request, ++state.requests)) {
+                        connection.close();
+                    }
+                    continue;
+                }
+                HttpResponse response;
+                response.body(request.path).keep_alive(request.keep_alive).send(connection);
+                if (!request.keep_alive) {
+                    connection.close();
+                }
+            }
+            return consumed;
+        });
+        server_.start();
+    }
+
+    [[nodiscard]] std::string url(std::string_view path = "/") const {
+        std::string url = "http://127.0.0.1:";
+        url.append(std::to_string(server_.port())).append(path);
+        return url;
+    }
+
+    [[nodiscard]] std::uint64_t accepted() const noexcept {
+        return server_.stats().accepted;
+    }
+
+private:
+    static ServerOptions options() {
+        ServerOptions options;
+        options.host = "127.0.0.1";
+        options.threads = 1;
+        return options;
+    }
+
+    Handler handler_;
+    TcpServer server_;
+};
+
+/// Send a request and wait for its result
+HttpResult fetch(HttpClient& client, HttpClientRequest request) {
+    auto promise = std::make_shared<std::promise<HttpResult>>();
+    auto future = promise->get_future();
+    client.request(std::move(request),
+                   [promise](HttpResult result) { promise->set_value(std::move(result)); });
+    if (future.wait_for(5s) != std::future_status::ready) {
+        ADD_FAILURE() << "no response";
+        return cpptemplate::core::unexpected(HttpClientErrc::Timeout);
+    }
+    return future.get();
+}
+
+HttpClientRequest make_request(std::string method, std::string url) {
+    HttpClientRequest request;
+    request.method = std::move(method);
+    request.url = std::move(url);
+    return request;
+}
+
+HttpResult get(HttpClient& client, std::string url) {
+    return fetch(client, make_request("GET", std::move(url)));
+}
+
+/// "/<i>"
+std::string numbered(int i) {
+    std::string path = "/";
+    path.append(std::to_string(i));
+    return path;
+}
+
+/// Minimal eager coroutine, enough to co_await HttpClient::fetch()
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {}
+    };
+};
+
+Task fetch_twice(HttpClient& client,
+                 std::string url,
+                 std::promise<std::vector<std::string>>& done) {
+    std::vector<std::string> bodies;
+    for (int i = 0; i < 2; ++i) {
+        HttpResult result = co_await client.fetch(make_request("GET", url));
+        bodies.push_back(result.has_value() ? result.value().body : "error");
+    }
+    done.set_value(std::move(bodies));
+}
+
+/// Fetch each URL in turn, each request made on the loop thread by the resumed coroutine
+Task fetch_chain(HttpClient& client,
+                 std::vector<std::string> urls,
+                 std::promise<std::vector<std::string>>& done) {
+    std::vector<std::string> bodies;
+    for (std::string& url : urls) {
+        HttpResult result = co_await client.fetch(make_request("GET", std::move(url)));
+        bodies.push_back(result.has_value() ? result.value().body
+                                            : std::string(result.error().message()));
+    }
+    done.set_value(std::move(bodies));
+}
+
+} // namespace
+
+TEST(HttpClientTest, GetsResponse) {
+    LoopbackServer server;
+    HttpClient client;
+    const auto result = get(client, server.url("/hello?x=1"));
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_EQ(result.value().status, 200);
+    EXPECT_EQ(result.value().body, "/hello");
+    EXPECT_EQ(result.value().header("content-length"), "6");
+    EXPECT_TRUE(result.value().header("X-Missing").empty());
+}
+
+TEST(HttpClientTest, PostsBodyWithContentLength) {
+    LoopbackServer server([](Connection& connection, const HttpRequest& request, int) {
+        HttpResponse response(201);
+        response.header("X-Method", request.method).body(request.body).send(connection);
+        return true;
+    });
+    HttpClient client;
+    HttpClientRequest request;
+    request.method = "POST";
+    request.url = server.url("/items");
+    request.headers = {{"Content-Type", "application/json"}};
+    request.body = R"({"id": 42})";
+    const auto result = fetch(client, request);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_EQ(result.value().status, 201);
+    EXPECT_EQ(result.value().header("X-Method"), "POST");
+    EXPECT_EQ(result.value().body, request.body);
+}
+
+TEST(HttpClientTest, ReusesKeepAliveConnection) {
+    LoopbackServer server;
+    HttpClient client;
+    for (int i = 0; i < 20; ++i) {
+        const auto result = get(client, server.url(numbered(i)));
+        ASSERT_TRUE(result.has_value()) << result.error().message();
+        EXPECT_EQ(result.value().body, numbered(i));
+    }
+    const auto stats = client.stats();
+    EXPECT_EQ(stats.requests, 20U);
+    EXPECT_EQ(stats.connections, 1U);
+    EXPECT_EQ(stats.reused, 19U);
+    EXPECT_EQ(server.accepted(), 1U);
+}
+
+TEST(HttpClientTest, OpensConnectionPerRequestWithoutKeepAlive) {
+    LoopbackServer server;
+    HttpClientOptions options;
+    options.keep_alive = false;
+    HttpClient client(options);
+    for (int i = 0; i < 5; ++i) {
+        const auto result = get(client, server.url());
+        ASSERT_TRUE(result.has_value()) << result.error().message();
+        EXPECT_EQ(result.value().header("Connection"), "close");
+    }
+    EXPECT_EQ(client.stats().connections, 5U);
+    EXPECT_EQ(client.stats().reused, 0U);
+}
+
+TEST(HttpClientTest, PipelinesOnOneConnectionInOrder) {
+    LoopbackServer server;
+    HttpClientOptions options;
+    options.max_connections_per_host = 1;
+    options.max_pipeline = 16;
+    HttpClient client(options);
+
+    constexpr int Count = 64;
+    std::vector<std::string> bodies;
+    std::promise<void> done;
+    for (int i = 0; i < Count; ++i) {
+        // Callbacks all run on the loop thread, so bodies needs no lock
+        client.get(server.url(numbered(i)), [&](HttpResult result) {
+            bodies.push_back(result.has_value() ? result.value().body
+                                                : std::string(result.error().message()));
+            if (bodies.size() == Count) {
+                done.set_value();
+            }
+        });
+    }
+    ASSERT_EQ(done.get_future().wait_for(5s), std::future_status::ready);
+    for (int i = 0; i < Count; ++i) {
+        EXPECT_EQ(bodies[static_cast<std::size_t>(i)], numbered(i));
+    }
+    EXPECT_EQ(client.stats().connections, 1U);
+    EXPECT_GT(client.stats().pipelined, 0U);
+}
+
+TEST(HttpClientTest, DoesNotPipelineBehindPost) {
+    LoopbackServer server;
+    HttpClientOptions options;
+    options.max_connections_per_host = 1;
+    HttpClient client(options);
+
+    std::vector<std::string> bodies;
+    std::promise<void> done;
+    const auto collect = [&](HttpResult result) {
+        bodies.push_back(result.has_value() ? result.value().body : "error");
+        if (bodies.size() == 3) {
+            done.set_value();
+        }
+    };
+    client.request(make_request("POST", server.url("/post")), collect);
+    client.get(server.url("/a"), collect);
+    client.get(server.url("/b"), collect);
+    ASSERT_EQ(done.get_future().wait_for(5s), std::future_status::ready);
+    EXPECT_EQ(bodies, (std::vector<std::string>{"/post", "/a", "/b"}));
+    EXPECT_LE(client.stats().pipelined, 1U); // At most /b behind /a, never behind the POST
+}
+
+TEST(HttpClientTest, DecodesChunkedBody) {
+    LoopbackServer server([](Connection& connection, const HttpRequest&, int) {
+        connection.send("HTTP/1.1 100 Continue\r\n\r\n"
+                        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                        "5;ext=1\r\nhello\r\n7\r\n, world\r\n0\r\nX-Trailer: t\r\n\r\n");
+        return true;
+    });
+    HttpClient client;
+    for (int i = 0; i < 2; ++i) {
+        const auto result = get(client, server.url());
+        ASSERT_TRUE(result.has_value()) << result.error().message();
+        EXPECT_EQ(result.value().status, 200);
+        EXPECT_EQ(result.value().body, "hello, world");
+    }
+    EXPECT_EQ(client.stats().connections, 1U);
+}
+
+TEST(HttpClientTest, ReadsBodyUntilClose) {
+    LoopbackServer server([](Connection& connection, const HttpRequest&, int) {
+        connection.send("HTTP/1.0 200 OK\r\n\r\nuntil the end");
+        return false;
+    });
+    HttpClient client;
+    const auto result = get(client, server.url());
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_EQ(result.value().body, "until the end");
+}
+
+TEST(HttpClientTest, HeadResponseHasNoBody) {
+    LoopbackServer server([](Connection& connection, const HttpRequest&, int) {
+        connection.send("HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n");
+        return true;
+    });
+    HttpClient client;
+    for (int i = 0; i < 2; ++i) {
+        const auto result = fetch(client, make_request("HEAD", server.url()));
+        ASSERT_TRUE(result.has_value()) << result.error().message();
+        EXPECT_TRUE(result.value().body.empty());
+    }
+    EXPECT_EQ(client.stats().connections, 1U);
+}
+
+TEST(HttpClientTest, RetriesIdempotentRequestOnStaleConnection) {
+    // The server drops each connection at its second request, as one closing an idle
+    // keep-alive connection would
+    LoopbackServer server([](Connection& connection, const HttpRequest& request, int number) {
+        if (number > 1) {
+            return false;
+        }
+        HttpResponse response;
+        response.body(request.path).send(connection);
+        return true;
+    });
+    HttpClient client;
+    for (int i = 0; i < 3; ++i) {
+        const auto result = get(client, server.url(numbered(i)));
+        ASSERT_TRUE(result.has_value()) << result.error().message();
+        EXPECT_EQ(result.value().body, numbered(i));
+    }
+    EXPECT_EQ(client.stats().retried, 2U);
+    EXPECT_EQ(client.stats().connections, 3U);
+}
+
+TEST(HttpClientTest, DoesNotRetryPost) {
+    LoopbackServer server([](Connection& connection, const HttpRequest& request, int number) {
+        if (number > 1) {
+            return false;
+        }
+        HttpResponse response;
+        response.body(request.path).send(connection);
+        return true;
+    });
+    HttpClient client;
+    ASSERT_TRUE(get(client, server.url()).has_value());
+    const auto result = fetch(client, make_request("POST", server.url()));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), HttpClientErrc::ConnectionClosed);
+    EXPECT_EQ(client.stats().retried, 0U);
+}
+
+TEST(HttpClientTest, ReportsErrors) {
+    HttpClient client;
+    EXPECT_EQ(get(client, "ftp://127.0.0.1/").error(), HttpClientErrc::InvalidUrl);
+    EXPECT_EQ(get(client, "http://:80/").error(), HttpClientErrc::InvalidUrl);
+    EXPECT_EQ(get(client, "http://127.0.0.1:99999/").error(), HttpClientErrc::InvalidUrl);
+    EXPECT_EQ(get(client, "http://host.invalid/").error(), HttpClientErrc::ResolveFailed);
+
+    std::string refused;
+    {
+        // A port that was just free: nothing listens on it any more
+        LoopbackServer server;
+        refused = server.url();
+    }
+    EXPECT_EQ(get(client, refused).error(), HttpClientErrc::ConnectFailed);
+}
+
+TEST(HttpClientTest, RejectsMalformedAndOversizedResponses) {
+    LoopbackServer garbage([](Connection& connection, const HttpRequest&, int) {
+        connection.send("SSH-2.0-OpenSSH_9.6\r\n\r\n");
+        return true;
+    });
+    LoopbackServer large([](Connection& connection, const HttpRequest&, int) {
+        connection.send("HTTP/1.1 200 OK\r\nContent-Length: 100000\r\n\r\n");
+        return true;
+    });
+    HttpClientOptions options;
+    options.max_response = 1024;
+    HttpClient client(options);
+    EXPECT_EQ(get(client, garbage.url()).error(), HttpClientErrc::BadResponse);
+    EXPECT_EQ(get(client, large.url()).error(), HttpClientErrc::ResponseTooLarge);
+}
+
+TEST(HttpClientTest, TimesOutSilentServer) {
+    LoopbackServer server([](Connection&, const HttpRequest&, int) { return true; });
+    HttpClientOptions options;
+    options.request_timeout = 100ms;
+    HttpClient client(options);
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = get(client, server.url());
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), HttpClientErrc::Timeout);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 100ms);
+}
+
+TEST(HttpClientTest, AwaitsFromCoroutine) {
+    LoopbackServer server;
+    HttpClient client;
+    std::promise<std::vector<std::string>> done;
+    auto future = done.get_future();
+    fetch_twice(client, server.url("/co"), done);
+    ASSERT_EQ(future.wait_for(5s), std::future_status::ready);
+    EXPECT_EQ(future.get(), (std::vector<std::string>{"/co", "/co"}));
+    EXPECT_EQ(client.stats().reused, 1U);
+}
+
+TEST(HttpClientTest, ResolvesNewHostsFromCallbacksOffTheLoop) {
+    LoopbackServer first;
+    LoopbackServer second;
+    HttpClient client;
+    std::promise<std::vector<std::string>> done;
+    auto future = done.get_future();
+    // After the first response every host is new to the cache, so it is resolved off the loop
+    fetch_chain(client, {first.url("/first"), second.url("/second"), "http://host.invalid/"}, done);
+    ASSERT_EQ(future.wait_for(5s), std::future_status::ready);
+    EXPECT_EQ(future.get(),
+              (std::vector<std::string>{"/first", "/second", "Host name did not resolve"}));
+
+    // A plain callback chains the same way
+    std::promise<HttpResult> chained;
+    auto chained_future = chained.get_future();
+    LoopbackServer third;
+    client.get(first.url("/again"), [&](HttpResult) {
+        client.get(third.url("/third"),
+                   [&](HttpResult result) { chained.set_value(std::move(result)); });
+    });
+    ASSERT_EQ(chained_future.wait_for(5s), std::future_status::ready);
+    const auto result = chained_future.get();
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    EXPECT_EQ(result.value().body, "/third");
+}
+
+TEST(HttpClientTest, FailsPendingRequestsOnDestruction) {
+    LoopbackServer server([](Connection&, const HttpRequest&, int) { return true; });
+    std::vector<HttpClientErrc> errors;
+    {
+        HttpClient client;
+        for (int i = 0; i < 3; ++i) {
+            client.get(server.url(), [&](HttpResult result) {
+                errors.push_back(result.has_value()
+                                     ? HttpClientErrc{}
+                                     : static_cast<HttpClientErrc>(result.error().code()));
+            });
+        }
+    }
+    EXPECT_EQ(errors, std::vector<HttpClientErrc>(3, HttpClientErrc::Shutdown));
+}
+
+TEST(HttpClientTest, RejectsZeroLimits) {
+    EXPECT_THROW(HttpClient({.max_connections_per_host = 0}), std::invalid_argument);
+    EXPECT_THROW(HttpClient({.max_pipeline = 0}), std::invalid_argument);
+}
+
+#endif
@@ -0,0 +1,361 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cpptemplate/core/exception.hpp"
+#include "cpptemplate/network/tcp_server.hpp"
+
+#if defined(__linux__)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+using namespace cpptemplate::network;
+
+#if defined(__linux__)
+
+namespace {
+
+/// Blocking loopback client with a receive timeout, so a broken server fails the test
+/// instead of hanging it
+class Client {
+public:
+    explicit Client(std::uint16_t port) : fd_(::socket(AF_INET, SOCK_STREAM, 0)) {
+        timeval timeout{5, 0};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0) {
+            throw std::runtime_error("connect failed");
+        }
+    }
+
+    ~Client() {
+        ::close(fd_);
+    }
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    void send(std::string_view bytes) const {
+        while (!bytes.empty()) {
+            const auto n = ::send(fd_, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+            if (n <= 0) {
+                throw std::runtime_error("send failed");
+            }
+            bytes.remove_prefix(static_cast<std::size_t>(n));
+        }
+    }
+
+    /// Read exactly size bytes, or fewer if the server closes or the timeout passes
+    [[nodiscard]] std::string receive(std::size_t size) const {
+        std::string result(size, '\0');
+        std::size_t got = 0;
+        while (got < size) {
+            const auto n = ::recv(fd_, result.data() + got, size - got, 0);
+            if (n <= 0) {
+                break;
+            }
+            got += static_cast<std::size_t>(n);
+        }
+        result.resize(got);
+        return result;
+    }
+
+    /// Whether the server closed the connection, gracefully or with a reset
+    [[nodiscard]] bool closed_by_peer() const {
+        char byte = 0;
+        const auto n = ::recv(fd_, &byte, 1, 0);
+        return n == 0 || (n < 0 && errno == ECONNRESET);
+    }
+
+    void shutdown_write() const {
+        ::shutdown(fd_, SHUT_WR);
+    }
+
+private:
+    int fd_;
+};
+
+/// Wait until predicate holds, for at most five seconds
+template<typename Predicate>
+bool eventually(Predicate predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+ServerOptions loopback(std::size_t threads,
+                       bool reuse_port = true,
+                       Backend backend = Backend::Auto) {
+    ServerOptions options;
+    options.host = "127.0.0.1";
+    options.threads = threads;
+    options.reuse_port = reuse_port;
+    options.backend = backend;
+    return options;
+}
+
+void echo(TcpServer& server) {
+    server.on_data([](Connection& connection, std::string_view bytes) {
+        connection.send(bytes);
+        return bytes.size();
+    });
+}
+
+/// Every test runs on each backend the kernel supports
+class TcpServerTest : public ::testing::TestWithParam<Backend> {
+protected:
+    void SetUp() override {
+        if (GetParam() == Backend::IoUring && !io_uring_available()) {
+            GTEST_SKIP() << "io_uring is not available";
+        }
+    }
+
+    [[nodiscard]] ServerOptions loopback(std::size_t threads, bool reuse_port = true) const {
+        return ::loopback(threads, reuse_port, GetParam());
+    }
+};
+
+} // namespace
+
+TEST_P(TcpServerTest, EchoesOnAnEphemeralPort) {
+    TcpServer server(loopback(2));
+    echo(server);
+    server.start();
+    ASSERT_TRUE(server.running());
+    ASSERT_NE(server.port(), 0);
+    EXPECT_EQ(server.threads(), 2u);
+    EXPECT_EQ(server.backend(), GetParam());
+
+    std::vector<std::unique_ptr<Client>> clients;
+    for (int i = 0; i < 8; ++i) {
+        clients.push_back(std::make_unique<Client>(server.port()));
+    }
+    for (std::size_t i = 0; i < clients.size(); ++i) {
+        const std::string message = "hello " + std::to_string(i);
+        clients[i]->send(message);
+        EXPECT_EQ(clients[i]->receive(message.size()), message);
+    }
+
+    // Counters are updated after the echo is on its way, so they may lag the client
+    EXPECT_TRUE(eventually([&] {
+        const auto stats = server.stats();
+        return stats.accepted == 8 && stats.active == 8 && stats.bytes_sent == stats.bytes_received;
+    }));
+}
+
+TEST_P(TcpServerTest, SharedListenerAlsoWorks) {
+    TcpServer server(loopback(2, false));
+    echo(server);
+    server.start();
+    Client client(server.port());
+    client.send("ping");
+    EXPECT_EQ(client.receive(4), "ping");
+}
+
+TEST_P(TcpServerTest, UnconsumedBytesArePassedAgain) {
+    // Line protocol: reply to each complete line, keep the partial one
+    TcpServer server(loopback(1));
+    server.on_data([](Connection& connection, std::string_view bytes) {
+        std::size_t consumed = 0;
+        for (std::size_t end = bytes.find('\n'); end != std::string_view::npos;
+             end = bytes.find('\n', consumed)) {
+            const std::string_view pieces[] = {"<", bytes.substr(consumed, end - consumed), ">"};
+            connection.send(pieces);
+            consumed = end + 1;
+        }
+        return consumed;
+    });
+    server.start();
+
+    Client client(server.port());
+    client.send("al");
+    client.send("pha\nbe");
+    EXPECT_EQ(client.receive(7), "<alpha>");
+    client.send("ta\ngamma\n");
+    EXPECT_EQ(client.receive(13), "<beta><gamma>");
+}
+
+TEST_P(TcpServerTest, LargeResponsesArriveWholeAndInOrder) {
+    // Far more than the socket buffers hold, so most of it is queued and sent in pieces
+    std::string payload(8 << 20, '\0');
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<char>('a' + i % 23);
+    }
+    TcpServer server(loopback(1));
+    std::atomic<std::size_t> pending_after_send{0};
+    server.on_data([&](Connection& connection, std::string_view bytes) {
+        connection.send(payload);
+        pending_after_send = connection.pending_output();
+        connection.close(); // Graceful: after the queue drains
+        return bytes.size();
+    });
+    server.start();
+
+    Client client(server.port());
+    client.send("go");
+    EXPECT_EQ(client.receive(payload.size()), payload);
+    EXPECT_TRUE(client.closed_by_peer());
+    EXPECT_GT(pending_after_send.load(), 0u);
+    EXPECT_TRUE(eventually([&] { return server.stats().active == 0; }));
+    EXPECT_EQ(server.stats().bytes_sent, payload.size()); // Counted before the close
+}
+
+TEST_P(TcpServerTest, CallbacksSeeEveryConnection) {
+    TcpServer server(loopback(2));
+    std::mutex mutex;
+    std::set<std::uint64_t> connected;
+    std::set<std::uint64_t> closed;
+    server.on_connect([&](Connection& connection) {
+        std::lock_guard lock(mutex);
+        EXPECT_TRUE(connected.insert(connection.id()).second); // Ids are unique
+        EXPECT_EQ(connection.peer().rfind("127.0.0.1:", 0), 0u);
+    });
+    server.on_close([&](Connection& connection) {
+        std::lock_guard lock(mutex);
+        closed.insert(connection.id());
+    });
+    server.start();
+
+    {
+        Client first(server.port());
+        Client second(server.port());
+        ASSERT_TRUE(eventually([&] { return server.stats().active == 2; }));
+    }
+    // Clients closing is seen as end of input
+    EXPECT_TRUE(eventually([&] { return server.stats().active == 0; }));
+
+    Client third(server.port());
+    ASSERT_TRUE(eventually([&] { return server.stats().active == 1; }));
+    server.stop(); // Closes the open one
+    EXPECT_FALSE(server.running());
+
+    std::lock_guard lock(mutex);
+    EXPECT_EQ(connected.size(), 3u);
+    EXPECT_EQ(closed, connected);
+}
+
+TEST_P(TcpServerTest, HalfClosedClientStillGetsItsReply) {
+    TcpServer server(loopback(1));
+    echo(server);
+    server.start();
+    Client client(server.port());
+    client.send("last words");
+    client.shutdown_write();
+    EXPECT_EQ(client.receive(10), "last words");
+    EXPECT_TRUE(client.closed_by_peer());
+}
+
+TEST_P(TcpServerTest, CloseFromHandlerAndThrowingHandlers) {
+    TcpServer server(loopback(1));
+    server.on_data([](Connection& connection, std::string_view bytes) -> std::size_t {
+        if (bytes.starts_with("throw")) {
+            throw std::runtime_error("bad input");
+        }
+        EXPECT_TRUE(connection.send("bye"));
+        connection.close();
+        EXPECT_TRUE(connection.closing());
+        EXPECT_FALSE(connection.send("ignored"));
+        return bytes.size();
+    });
+    server.start();
+
+    Client polite(server.port());
+    polite.send("quit");
+    EXPECT_EQ(polite.receive(3), "bye");
+    EXPECT_TRUE(polite.closed_by_peer());
+
+    Client rude(server.port());
+    rude.send("throw");
+    EXPECT_TRUE(rude.closed_by_peer());
+    EXPECT_TRUE(eventually([&] { return server.stats().active == 0; }));
+}
+
+TEST_P(TcpServerTest, InputLimitClosesGreedyConnections) {
+    ServerOptions options = loopback(1);
+    options.buffer_size = 1024;
+    options.max_input = 4096;
+    TcpServer server(options);
+    server.on_data([](Connection&, std::string_view) { return std::size_t{0}; }); // Never consumes
+    server.start();
+
+    Client client(server.port());
+    client.send(std::string(8192, 'x'));
+    EXPECT_TRUE(client.closed_by_peer());
+}
+
+TEST_P(TcpServerTest, RestartsAndRejectsBadOptions) {
+    TcpServer server(loopback(1));
+    server.start();
+    EXPECT_THROW(server.start(), cpptemplate::core::Exception);
+    server.stop();
+    server.stop();
+    EXPECT_EQ(server.port(), 0);
+    server.start();
+    EXPECT_TRUE(server.running());
+
+    ServerOptions taken = loopback(1, false);
+    taken.port = server.port();
+    TcpServer conflicting(taken);
+    EXPECT_THROW(conflicting.start(), cpptemplate::core::Exception);
+    EXPECT_FALSE(conflicting.running());
+
+    ServerOptions bad_host;
+    bad_host.host = "localhost"; // Literals only
+    EXPECT_THROW(TcpServer{bad_host}, std::invalid_argument);
+    ServerOptions bad_sizes;
+    bad_sizes.max_input = bad_sizes.buffer_size - 1;
+    EXPECT_THROW(TcpServer{bad_sizes}, std::invalid_argument);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends,
+                         TcpServerTest,
+                         ::testing::Values(Backend::Epoll, Backend::IoUring),
+                         [](const auto& info) {
+                             return info.param == Backend::Epoll ? "Epoll" : "IoUring";
+                         });
+
+TEST(TcpServerBackendTest, AutoPrefersIoUring) {
+    TcpServer server(loopback(1));
+    echo(server);
+    server.start();
+    EXPECT_EQ(server.backend(), io_uring_available() ? Backend::IoUring : Backend::Epoll);
+    Client client(server.port());
+    client.send("ping");
+    EXPECT_EQ(client.receive(4), "ping");
+}
+
+TEST(TcpServerBackendTest, UnavailableIoUringThrowsAndBadRingSizesAreRejected) {
+    if (!io_uring_available()) {
+        TcpServer server(loopback(1, true, Backend::IoUring));
+        EXPECT_THROW(server.start(), cpptemplate::core::Exception);
+        EXPECT_FALSE(server.running());
+    }
+    ServerOptions odd = loopback(1);
+    odd.ring_buffers = 1000;
+    EXPECT_THROW(TcpServer{odd}, std::invalid_argument);
+}
+
+TEST(TcpServerBackendTest, RaisesOpenFileLimit) {
+    EXPECT_GT(raise_open_file_limit(), 0u);
+}
+
+#endif
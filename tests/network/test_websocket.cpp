@@ -0,0 +1,738 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/network/tcp_server.hpp"
+#include "cpptemplate/network/websocket.hpp"
+
+#if defined(__linux__)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+using namespace cpptemplate::network;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+using Status = WsParseResult::Status;
+
+namespace {
+
+constexpr WsMaskKey Key{0x37, 0xFA, 0x21, 0x3D};
+
+/// Bytes 0, 1, 2, ... as a payload
+std::string counting(std::size_t size) {
+    std::string payload(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+        payload[i] = static_cast<char>(i * 7 + 3);
+    }
+    return payload;
+}
+
+/// Close frame payload: the code big-endian, then the reason
+std::string close_payload(std::uint16_t code, std::string_view reason = {}) {
+    std::string payload{static_cast<char>(code >> 8), static_cast<char>(code & 0xFF)};
+    payload.append(reason);
+    return payload;
+}
+
+/**
+ * Feeds bytes to a parser as a server feeds a connection's buffer: append,
+ * parse, drop what was consumed
+ */
+class Feeder {
+public:
+    explicit Feeder(WsRole role = WsRole::Server, WsLimits limits = {}) : parser_(role, limits) {}
+
+    WsParser& parser() noexcept {
+        return parser_;
+    }
+
+    /// Append bytes and parse once; the message payload is copied out
+    WsParseResult feed(std::string_view bytes) {
+        buffer_.append(bytes);
+        WsMessage message;
+        const auto result = parser_.parse(buffer_, message);
+        if (result.status == Status::Complete) {
+            opcode = message.opcode;
+            payload.assign(message.payload);
+        }
+        buffer_.erase(0, result.consumed);
+        return result;
+    }
+
+    [[nodiscard]] std::size_t buffered() const noexcept {
+        return buffer_.size();
+    }
+
+    WsOpcode opcode = WsOpcode::Continuation;
+    std::string payload;
+
+private:
+    WsParser parser_;
+    std::string buffer_;
+};
+
+/// Frame and kernel tests run on every SIMD level the CPU supports
+class WsKernelTest : public ::testing::TestWithParam<SimdLevel> {
+protected:
+    void SetUp() override {
+        if (set_simd_level(GetParam()) != GetParam()) {
+            GTEST_SKIP() << to_string(GetParam()) << " not supported on this CPU";
+        }
+    }
+
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+    }
+};
+
+} // namespace
+
+TEST_P(WsKernelTest, MaskMatchesDefinitionAtEveryLengthAndOffset) {
+    for (std::size_t size = 0; size <= 300; ++size) {
+        for (std::size_t offset = 0; offset < 4; ++offset) {
+            const std::string original = counting(size);
+            std::string data = original;
+            ws_mask(data, Key, offset);
+            for (std::size_t i = 0; i < size; ++i) {
+                ASSERT_EQ(static_cast<std::uint8_t>(data[i]),
+                          static_cast<std::uint8_t>(original[i] ^ Key[(offset + i) % 4]))
+                    << "size " << size << ", offset " << offset << ", byte " << i;
+            }
+            ws_mask(data, Key, offset);
+            ASSERT_EQ(data, original);
+        }
+    }
+}
+
+TEST_P(WsKernelTest, ValidatesUtf8) {
+    const std::string ascii(200, 'a');
+    EXPECT_TRUE(ws_valid_utf8(""));
+    EXPECT_TRUE(ws_valid_utf8(ascii));
+    EXPECT_TRUE(ws_valid_utf8("\xCE\xBA\xE1\xBD\xB9\xCF\x83\xCE\xBC\xCE\xB5")); // κόσμε
+    EXPECT_TRUE(ws_valid_utf8("\xF0\x9F\x98\x80 and \xEF\xBF\xBF and \xF4\x8F\xBF\xBF"));
+    EXPECT_TRUE(ws_valid_utf8(ascii + "\xC3\xA9" + ascii));
+
+    for (const std::string_view bad : {"\x80",
+                                       "\xC0\x80",
+                                       "\xC1\xBF",
+                                       "\xE0\x80\x80",
+                                       "\xED\xA0\x80",
+                                       "\xF0\x80\x80\x80",
+                                       "\xF4\x90\x80\x80",
+                                       "\xF5\x80\x80\x80",
+                                       "\xFF",
+                                       "\xE2\x82",
+                                       "\xF0\x9F\x98"}) {
+        EXPECT_FALSE(ws_valid_utf8(bad)) << testing::PrintToString(bad);
+        // Also past a run long enough for the vector kernels to skip
+        EXPECT_FALSE(ws_valid_utf8(ascii + std::string(bad))) << testing::PrintToString(bad);
+        EXPECT_FALSE(ws_valid_utf8(ascii + std::string(bad) + ascii))
+            << testing::PrintToString(bad);
+    }
+}
+
+TEST_P(WsKernelTest, ParsesMaskedFramesInPlace) {
+    const std::string payload = counting(1000);
+    std::string bytes = ws_frame(WsOpcode::Binary, payload, Key);
+    WsParser parser(WsRole::Server);
+    WsMessage message;
+    const auto result = parser.parse(bytes, message);
+    ASSERT_EQ(result.status, Status::Complete);
+    EXPECT_EQ(result.consumed, bytes.size());
+    EXPECT_EQ(message.opcode, WsOpcode::Binary);
+    EXPECT_EQ(message.payload, payload);
+    // A whole message is returned where it lies, unmasked
+    EXPECT_EQ(message.payload.data(), bytes.data() + 4 + 4);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, WsKernelTest,
+                         ::testing::Values(SimdLevel::Scalar, SimdLevel::Sse42, SimdLevel::Avx2,
+                                           SimdLevel::Avx512, SimdLevel::Neon),
+                         [](const auto& info) {
+                             std::string name(to_string(info.param));
+                             std::replace(name.begin(), name.end(), '.', '_');
+                             return name;
+                         });
+
+TEST(WsFrameTest, HeaderUsesShortestLengthEncoding) {
+    std::array<char, WsMaxHeader> header{};
+    EXPECT_EQ(ws_frame_header(header.data(), WsOpcode::Text, 125), 2U);
+    EXPECT_EQ(header[0], '\x81');
+    EXPECT_EQ(header[1], '\x7D');
+    EXPECT_EQ(ws_frame_header(header.data(), WsOpcode::Binary, 126), 4U);
+    EXPECT_EQ(ws_frame_header(header.data(), WsOpcode::Binary, 65535), 4U);
+    EXPECT_EQ(ws_frame_header(header.data(), WsOpcode::Binary, 65536), 10U);
+    EXPECT_EQ(ws_frame_header(header.data(), WsOpcode::Binary, 65536, Key), 14U);
+    EXPECT_EQ(header[1], '\xFF');
+    EXPECT_EQ(ws_frame_header(header.data(), WsOpcode::Ping, 0, Key, false, false), 6U);
+    EXPECT_EQ(header[0], '\x09');
+    ws_frame_header(header.data(), WsOpcode::Text, 3, std::nullopt, true);
+    EXPECT_EQ(header[0], '\xC1');
+}
+
+TEST(WsFrameTest, ParsesByteByByteAndJoinsFragmentsAroundControlFrames) {
+    std::string bytes;
+    // "Hel" starts a text message, a ping arrives, then "lo" ends it
+    std::array<char, WsMaxHeader> header{};
+    std::string first = "Hel";
+    ws_mask(first, Key);
+    bytes
+        .append(header.data(), ws_frame_header(header.data(), WsOpcode::Text, 3, Key, false, false))
+        .append(first);
+    ws_append_frame(bytes, WsOpcode::Ping, "are you there", Key);
+    std::string second = "lo";
+    ws_mask(second, Key);
+    bytes.append(header.data(), ws_frame_header(header.data(), WsOpcode::Continuation, 2, Key))
+        .append(second);
+
+    Feeder feeder;
+    std::vector<std::pair<WsOpcode, std::string>> received;
+    for (const char c : bytes) {
+        const auto result = feeder.feed({&c, 1});
+        ASSERT_NE(result.status, Status::Error);
+        if (result.status == Status::Complete) {
+            received.emplace_back(feeder.opcode, feeder.payload);
+        }
+    }
+    ASSERT_EQ(received.size(), 2U);
+    EXPECT_EQ(received[0], std::make_pair(WsOpcode::Ping, std::string("are you there")));
+    EXPECT_EQ(received[1], std::make_pair(WsOpcode::Text, std::string("Hello")));
+    EXPECT_EQ(feeder.buffered(), 0U);
+}
+
+TEST(WsFrameTest, RejectsProtocolViolations) {
+    const auto error_of = [](std::string_view bytes, WsRole role = WsRole::Server) {
+        Feeder feeder(role);
+        const auto result = feeder.feed(bytes);
+        EXPECT_EQ(result.status, Status::Error) << testing::PrintToString(bytes);
+        return result.close_code;
+    };
+    std::array<char, WsMaxHeader> header{};
+    const auto head = [&](WsOpcode opcode, std::uint64_t size, bool fin = true) {
+        return std::string(header.data(),
+                           ws_frame_header(header.data(), opcode, size, Key, false, fin));
+    };
+
+    EXPECT_EQ(error_of(ws_frame(WsOpcode::Text, "unmasked")), WsCloseCode::ProtocolError);
+    EXPECT_EQ(error_of(ws_frame(WsOpcode::Text, "masked", Key), WsRole::Client),
+              WsCloseCode::ProtocolError);
+    EXPECT_EQ(error_of("\xA1\x80" + std::string(4, 'k')), WsCloseCode::ProtocolError); // RSV2
+    EXPECT_EQ(error_of("\x83\x80" + std::string(4, 'k')), WsCloseCode::ProtocolError); // Opcode 3
+    EXPECT_EQ(error_of(head(WsOpcode::Ping, 0, false)), WsCloseCode::ProtocolError);
+    EXPECT_EQ(error_of(head(WsOpcode::Ping, 126)), WsCloseCode::ProtocolError);
+    EXPECT_EQ(error_of(head(WsOpcode::Continuation, 0)), WsCloseCode::ProtocolError);
+    EXPECT_EQ(error_of(head(WsOpcode::Text, 0, false) + head(WsOpcode::Text, 0)),
+              WsCloseCode::ProtocolError);
+    // RSV1 without a negotiated extension, then a 64-bit length with its MSB set
+    EXPECT_EQ(error_of(ws_frame(WsOpcode::Text, "x", Key, true)), WsCloseCode::ProtocolError);
+    EXPECT_EQ(error_of("\x82\xFF\x80" + std::string(11, '\0')), WsCloseCode::ProtocolError);
+
+    Feeder compressed;
+    compressed.parser().allow_compressed(true);
+    EXPECT_EQ(compressed.feed(ws_frame(WsOpcode::Text, "x", Key, true)).status, Status::Complete);
+}
+
+TEST(WsFrameTest, EnforcesMessageLimitAcrossFragments) {
+    std::array<char, WsMaxHeader> header{};
+    Feeder feeder(WsRole::Server, {.max_message = 100});
+    EXPECT_EQ(feeder.feed(ws_frame(WsOpcode::Binary, std::string(100, 'x'), Key)).status,
+              Status::Complete);
+    const std::string first(
+        header.data(), ws_frame_header(header.data(), WsOpcode::Binary, 60, Key, false, false));
+    EXPECT_EQ(feeder.feed(first + std::string(60, 'x')).status, Status::Incomplete);
+    const std::string second(header.data(),
+                             ws_frame_header(header.data(), WsOpcode::Continuation, 41, Key));
+    const auto result = feeder.feed(second);
+    EXPECT_EQ(result.status, Status::Error);
+    EXPECT_EQ(result.close_code, WsCloseCode::MessageTooBig);
+}
+
+TEST(WsFrameTest, StreamsLargeFramesOutOfTheInput) {
+    const std::string payload = counting(300'000);
+    const std::string bytes = ws_frame(WsOpcode::Binary, payload, Key);
+    Feeder feeder;
+    std::size_t most_buffered = 0;
+    WsParseResult result;
+    for (std::size_t i = 0; i < bytes.size(); i += 7001) {
+        result = feeder.feed(std::string_view(bytes).substr(i, 7001));
+        most_buffered = std::max(most_buffered, feeder.buffered());
+        ASSERT_NE(result.status, Status::Error);
+    }
+    ASSERT_EQ(result.status, Status::Complete);
+    EXPECT_EQ(feeder.payload, payload);
+    // Each chunk was taken as it came, not held until the frame was whole
+    EXPECT_LE(most_buffered, 7001U);
+}
+
+TEST(WsHandshakeTest, AcceptKeyMatchesRfcExample) {
+    EXPECT_EQ(ws_accept_key("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+
+    const std::string key = ws_client_key();
+    EXPECT_EQ(key.size(), 24U);
+    EXPECT_TRUE(key.ends_with("=="));
+    EXPECT_NE(key, ws_client_key());
+}
+
+TEST(WsHandshakeTest, RandomMasksDoNotRepeatAcrossThreads) {
+    // Several per-thread batches each; among 4000 random 32-bit keys even one collision is
+    // a 1 in 500 chance
+    std::array<std::vector<WsMaskKey>, 4> masks;
+    std::vector<std::thread> threads;
+    for (auto& thread_masks : masks) {
+        threads.emplace_back([&thread_masks] {
+            for (int i = 0; i < 1000; ++i) {
+                thread_masks.push_back(ws_random_mask());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::set<WsMaskKey> distinct;
+    for (const auto& thread_masks : masks) {
+        distinct.insert(thread_masks.begin(), thread_masks.end());
+    }
+    EXPECT_GE(distinct.size(), 3998U);
+}
+
+TEST(WsHandshakeTest, ChecksUpgradeResponses) {
+    const std::string key = ws_client_key();
+    std::string response =
+        "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: ";
+    response.append(ws_accept_key(key)).append("\r\n");
+
+    bool deflate = true;
+    EXPECT_TRUE(ws_check_upgrade_response(response + "\r\n", key, &deflate));
+    EXPECT_FALSE(deflate);
+    EXPECT_FALSE(ws_check_upgrade_response(response + "\r\n", ws_client_key()));
+    EXPECT_FALSE(ws_check_upgrade_response("HTTP/1.1 200 OK\r\n\r\n", key));
+
+    std::string extended = response;
+    extended.append(
+        "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover\r\n\r\n");
+    EXPECT_TRUE(ws_check_upgrade_response(extended, key, &deflate));
+    EXPECT_TRUE(deflate);
+    extended = response;
+    extended.append(
+        "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits=10\r\n\r\n");
+    EXPECT_FALSE(ws_check_upgrade_response(extended, key));
+
+    const std::string request = ws_upgrade_request("example.com", "/chat", key, true);
+    EXPECT_TRUE(request.starts_with("GET /chat HTTP/1.1\r\nHost: example.com\r\n"));
+    EXPECT_NE(request.find("Sec-WebSocket-Key: " + key + "\r\n"), std::string::npos);
+    EXPECT_NE(request.find("permessage-deflate"), std::string::npos);
+    EXPECT_TRUE(request.ends_with("\r\n\r\n"));
+}
+
+TEST(WsCompressorTest, RoundTripsMessagesAndEnforcesLimits) {
+    if (!permessage_deflate_available()) {
+        EXPECT_THROW(WsCompressor(), std::exception);
+        GTEST_SKIP() << "built without permessage-deflate";
+    }
+    WsCompressor compressor;
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text.append("{\"price\": ")
+            .append(std::to_string(100 + i % 7))
+            .append(", \"symbol\": \"ABC\"}\n");
+    }
+    for (int round = 0; round < 3; ++round) {
+        std::string compressed;
+        compressor.compress(text, compressed);
+        EXPECT_LT(compressed.size(), text.size() / 4);
+        std::string inflated = "kept:";
+        ASSERT_TRUE(compressor.decompress(compressed, inflated, text.size()));
+        EXPECT_EQ(inflated, "kept:" + text);
+
+        std::string capped;
+        EXPECT_FALSE(compressor.decompress(compressed, capped, text.size() - 1));
+        EXPECT_GT(capped.size(), text.size() - 1);
+    }
+
+    std::string empty;
+    compressor.compress("", empty);
+    EXPECT_FALSE(empty.empty());
+    std::string inflated;
+    ASSERT_TRUE(compressor.decompress(empty, inflated, 10));
+    EXPECT_TRUE(inflated.empty());
+    EXPECT_FALSE(compressor.decompress("\xFF\xFF\xFF\xFF", inflated, 100));
+    EXPECT_THROW(WsCompressor(10), std::invalid_argument);
+}
+
+#if defined(__linux__)
+
+namespace {
+
+/// Blocking loopback WebSocket client with a receive timeout, built on the sans-IO helpers
+class WsClient {
+public:
+    struct Frame {
+        WsOpcode opcode = WsOpcode::Text;
+        std::string payload;
+        bool compressed = false;
+    };
+
+    explicit WsClient(std::uint16_t port) : fd_(::socket(AF_INET, SOCK_STREAM, 0)) {
+        timeval timeout{5, 0};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0) {
+            throw std::runtime_error("connect failed");
+        }
+    }
+
+    ~WsClient() {
+        ::close(fd_);
+    }
+
+    WsClient(const WsClient&) = delete;
+    WsClient& operator=(const WsClient&) = delete;
+
+    /// Send an upgrade request; returns the response head
+    std::string handshake(std::string_view request) {
+        send_raw(request);
+        std::size_t end = std::string::npos;
+        while ((end = input_.find("\r\n\r\n")) == std::string::npos && receive_more()) {
+        }
+        if (end == std::string::npos) {
+            return input_;
+        }
+        std::string head = input_.substr(0, end + 4);
+        input_.erase(0, end + 4);
+        return head;
+    }
+
+    /// Complete the handshake, false if the server refused it
+    bool open(bool offer_deflate = false) {
+        const std::string key = ws_client_key();
+        const bool ok = ws_check_upgrade_response(
+            handshake(ws_upgrade_request("127.0.0.1", "/", key, offer_deflate)), key, &deflate);
+        parser_.allow_compressed(deflate);
+        return ok;
+    }
+
+    void send_raw(std::string_view bytes) const {
+        while (!bytes.empty()) {
+            const auto n = ::send(fd_, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw std::runtime_error("send failed");
+            }
+            bytes.remove_prefix(static_cast<std::size_t>(n));
+        }
+    }
+
+    void send(WsOpcode opcode, std::string_view payload, bool compressed = false) const {
+        send_raw(ws_frame(opcode, payload, ws_random_mask(), compressed));
+    }
+
+    /// Next frame from the server, nullopt if it closed, broke the protocol or went quiet
+    std::optional<Frame> next() {
+        for (;;) {
+            WsMessage message;
+            const auto result = parser_.parse(input_, message);
+            if (result.status == Status::Complete) {
+                Frame frame{message.opcode, std::string(message.payload), message.compressed};
+                input_.erase(0, result.consumed);
+                return frame;
+            }
+            input_.erase(0, result.consumed);
+            if (result.status == Status::Error || !receive_more()) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    /// Whether the server closed the connection
+    [[nodiscard]] bool closed_by_peer() const {
+        char byte = 0;
+        auto n = ::recv(fd_, &byte, 1, 0);
+        while (n < 0 && errno == EINTR) {
+            n = ::recv(fd_, &byte, 1, 0);
+        }
+        return n == 0 || (n < 0 && errno == ECONNRESET);
+    }
+
+    bool deflate = false;
+
+private:
+    bool receive_more() {
+        char buffer[65536];
+        auto n = ::recv(fd_, buffer, sizeof buffer, 0);
+        while (n < 0 && errno == EINTR) {
+            // io_uring work for a ring set up on this thread can interrupt the wait
+            n = ::recv(fd_, buffer, sizeof buffer, 0);
+        }
+        if (n <= 0) {
+            return false;
+        }
+        input_.append(buffer, static_cast<std::size_t>(n));
+        return true;
+    }
+
+    int fd_;
+    WsParser parser_{WsRole::Client};
+    std::string input_;
+};
+
+/// Wait until predicate holds, for at most five seconds
+template<typename Predicate>
+bool eventually(Predicate predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+WsServerOptions loopback() {
+    WsServerOptions options;
+    options.tcp.host = "127.0.0.1";
+    options.tcp.threads = 1;
+    return options;
+}
+
+void echo(WebSocketServer& server) {
+    server.on_message([](WsConnection& ws, const WsMessage& message) {
+        ws.send(message.opcode, message.payload);
+    });
+}
+
+} // namespace
+
+TEST(WebSocketServerTest, EchoesMessagesAndAnswersPings) {
+    WebSocketServer server(loopback());
+    echo(server);
+    server.start();
+
+    WsClient client(server.port());
+    ASSERT_TRUE(client.open());
+    client.send(WsOpcode::Text, "hello");
+    auto frame = client.next();
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(frame->opcode, WsOpcode::Text);
+    EXPECT_EQ(frame->payload, "hello");
+
+    client.send(WsOpcode::Ping, "ping?");
+    frame = client.next();
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(frame->opcode, WsOpcode::Pong);
+    EXPECT_EQ(frame->payload, "ping?");
+
+    const std::string large = counting(200'000);
+    client.send(WsOpcode::Binary, large);
+    frame = client.next();
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(frame->opcode, WsOpcode::Binary);
+    EXPECT_EQ(frame->payload, large);
+}
+
+TEST(WebSocketServerTest, CoalescesFramesQueuedInOneCallback) {
+    std::atomic<std::size_t> queued{0};
+    std::atomic<std::size_t> written{1};
+    WebSocketServer server(loopback());
+    server.on_message([&](WsConnection& ws, const WsMessage&) {
+        for (int i = 0; i < 100; ++i) {
+            ws.send_text(std::to_string(i));
+        }
+        // Nothing is written until the callback returns
+        queued = ws.pending_output();
+        written = ws.connection().pending_output();
+    });
+    server.start();
+
+    WsClient client(server.port());
+    ASSERT_TRUE(client.open());
+    client.send(WsOpcode::Text, "go");
+    for (int i = 0; i < 100; ++i) {
+        const auto frame = client.next();
+        ASSERT_TRUE(frame);
+        EXPECT_EQ(frame->payload, std::to_string(i));
+    }
+    EXPECT_GT(queued.load(), 200U);
+    EXPECT_EQ(written.load(), 0U);
+}
+
+TEST(WebSocketServerTest, EchoesCloseAndReportsCode) {
+    std::atomic<int> closes{0};
+    std::atomic<int> code{0};
+    WebSocketServer server(loopback());
+    server.on_close([&](WsConnection& ws) {
+        code = static_cast<int>(ws.close_code());
+        ++closes;
+    });
+    server.start();
+
+    WsClient client(server.port());
+    ASSERT_TRUE(client.open());
+    client.send(WsOpcode::Close, close_payload(1000, "bye"));
+    const auto frame = client.next();
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(frame->opcode, WsOpcode::Close);
+    EXPECT_EQ(frame->payload, close_payload(1000));
+    EXPECT_TRUE(client.closed_by_peer());
+    ASSERT_TRUE(eventually([&] { return closes == 1; }));
+    EXPECT_EQ(code.load(), 1000);
+}
+
+TEST(WebSocketServerTest, ClosesOnInvalidInputWithMatchingCode) {
+    WebSocketServer server(loopback());
+    echo(server);
+    server.start();
+
+    const auto close_code_after = [&](std::string_view bytes) -> int {
+        WsClient client(server.port());
+        EXPECT_TRUE(client.open());
+        client.send_raw(bytes);
+        const auto frame = client.next();
+        if (!frame || frame->opcode != WsOpcode::Close || frame->payload.size() < 2) {
+            return 0;
+        }
+        EXPECT_TRUE(client.closed_by_peer());
+        return static_cast<std::uint8_t>(frame->payload[0]) << 8 |
+               static_cast<std::uint8_t>(frame->payload[1]);
+    };
+    EXPECT_EQ(close_code_after(ws_frame(WsOpcode::Text, "\xC0\xAF", Key)), 1007);
+    EXPECT_EQ(close_code_after(ws_frame(WsOpcode::Text, "unmasked")), 1002);
+    EXPECT_EQ(close_code_after(ws_frame(WsOpcode::Close, close_payload(999), Key)), 1002);
+    EXPECT_EQ(close_code_after(ws_frame(WsOpcode::Close, close_payload(1000, "\xFF"), Key)), 1007);
+}
+
+TEST(WebSocketServerTest, RefusesBadUpgradeRequests) {
+    WsServerOptions options = loopback();
+    options.path = "/chat";
+    WebSocketServer server(options);
+    server.start();
+
+    const auto status_of = [&](const std::string& request) {
+        WsClient client(server.port());
+        return client.handshake(request).substr(0, 12);
+    };
+    const std::string key = ws_client_key();
+    EXPECT_EQ(status_of(ws_upgrade_request("localhost", "/chat", key)), "HTTP/1.1 101");
+    EXPECT_EQ(status_of(ws_upgrade_request("localhost", "/other", key)), "HTTP/1.1 404");
+    EXPECT_EQ(status_of(ws_upgrade_request("localhost", "/chat", "short")), "HTTP/1.1 400");
+    EXPECT_EQ(status_of("GET /chat HTTP/1.1\r\nHost: localhost\r\n\r\n"), "HTTP/1.1 426");
+
+    std::string old_version = ws_upgrade_request("localhost", "/chat", key);
+    old_version.replace(old_version.find("Version: 13"), 11, "Version: 8");
+    WsClient client(server.port());
+    const std::string head = client.handshake(old_version);
+    EXPECT_TRUE(head.starts_with("HTTP/1.1 426"));
+    EXPECT_NE(head.find("Sec-WebSocket-Version: 13\r\n"), std::string::npos);
+}
+
+TEST(WebSocketServerTest, NegotiatesPermessageDeflate) {
+    if (!permessage_deflate_available()) {
+        GTEST_SKIP() << "built without permessage-deflate";
+    }
+    WsServerOptions options = loopback();
+    options.permessage_deflate = true;
+    options.compress_min = 16;
+    WebSocketServer server(options);
+    echo(server);
+    server.start();
+
+    std::string text;
+    for (int i = 0; i < 50; ++i) {
+        text.append("compressible text ");
+    }
+    WsClient client(server.port());
+    ASSERT_TRUE(client.open(true));
+    ASSERT_TRUE(client.deflate);
+    WsCompressor compressor;
+    for (int round = 0; round < 2; ++round) {
+        std::string compressed;
+        compressor.compress(text, compressed);
+        client.send(WsOpcode::Text, compressed, true);
+        const auto frame = client.next();
+        ASSERT_TRUE(frame);
+        EXPECT_TRUE(frame->compressed);
+        EXPECT_LT(frame->payload.size(), text.size());
+        std::string inflated;
+        ASSERT_TRUE(compressor.decompress(frame->payload, inflated, 1 << 20));
+        EXPECT_EQ(inflated, text);
+    }
+    client.send(WsOpcode::Text, "short");
+    const auto frame = client.next();
+    ASSERT_TRUE(frame);
+    EXPECT_FALSE(frame->compressed);
+    EXPECT_EQ(frame->payload, "short");
+
+    WsClient plain(server.port());
+    ASSERT_TRUE(plain.open(false));
+    EXPECT_FALSE(plain.deflate);
+    plain.send(WsOpcode::Text, text);
+    const auto echoed = plain.next();
+    ASSERT_TRUE(echoed);
+    EXPECT_FALSE(echoed->compressed);
+    EXPECT_EQ(echoed->payload, text);
+}
+
+TEST(WebSocketServerTest, BroadcastSharesOneSerializedFrame) {
+    // Touched only on the server's single loop, and declared to outlive it
+    std::set<WsConnection*> subscribers;
+    std::atomic<long> queued_refs{0};
+    std::atomic<long> flushed_refs{0};
+    WebSocketServer server(loopback());
+    server.on_open([&](WsConnection& ws, const HttpRequest&) { subscribers.insert(&ws); });
+    server.on_close([&](WsConnection& ws) { subscribers.erase(&ws); });
+    server.on_message([&](WsConnection&, const WsMessage& message) {
+        const WsFrame frame(WsOpcode::Text, message.payload);
+        for (WsConnection* subscriber : subscribers) {
+            subscriber->send(frame);
+        }
+        queued_refs = frame.use_count();
+        for (WsConnection* subscriber : subscribers) {
+            subscriber->flush();
+        }
+        flushed_refs = frame.use_count();
+    });
+    server.start();
+
+    std::vector<std::unique_ptr<WsClient>> clients;
+    for (int i = 0; i < 3; ++i) {
+        clients.push_back(std::make_unique<WsClient>(server.port()));
+        ASSERT_TRUE(clients.back()->open());
+    }
+    clients[1]->send(WsOpcode::Text, "news");
+    for (const auto& client : clients) {
+        const auto frame = client->next();
+        ASSERT_TRUE(frame);
+        EXPECT_EQ(frame->payload, "news");
+    }
+    // Stored once the writes are made, so possibly after the clients have the frame
+    ASSERT_TRUE(eventually([&] { return flushed_refs != 0; }));
+    EXPECT_EQ(queued_refs.load(), 4); // The frame and one reference per subscriber
+    EXPECT_EQ(flushed_refs.load(), 1);
+}
+
+#endif
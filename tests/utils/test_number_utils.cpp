@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
+#include "cpptemplate/utils/number_utils.hpp"
+
+using namespace cpptemplate::utils;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::Errc;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
+
+TEST(NumberUtilsTest, ParseInt) {
+    EXPECT_EQ(parse_int("42").value(), 42);
+    EXPECT_EQ(parse_int("-42").value(), -42);
+    EXPECT_EQ(parse_int(" +7\r\n").value(), 7);
+    EXPECT_EQ(parse_int("-9223372036854775808").value(), std::numeric_limits<std::int64_t>::min());
+    EXPECT_EQ(parse_int("9223372036854775808").error(), Errc::OutOfRange);
+    EXPECT_EQ(parse_int("").error(), Errc::ParseError);
+    EXPECT_EQ(parse_int("12abc").error(), Errc::ParseError);
+    EXPECT_EQ(parse_int("1.5").error(), Errc::ParseError);
+    EXPECT_EQ(parse_int("+-1").error(), Errc::ParseError);
+    EXPECT_EQ(parse_int("+").error(), Errc::ParseError);
+}
+
+TEST(NumberUtilsTest, ParseUint) {
+    EXPECT_EQ(parse_uint("18446744073709551615").value(),
+              std::numeric_limits<std::uint64_t>::max());
+    EXPECT_EQ(parse_uint("18446744073709551616").error(), Errc::OutOfRange);
+    EXPECT_EQ(parse_uint("-1").error(), Errc::ParseError);
+}
+
+TEST(NumberUtilsTest, ParseDouble) {
+    EXPECT_EQ(parse_double("3.25").value(), 3.25);
+    EXPECT_EQ(parse_double("-1e-7").value(), -1e-7);
+    EXPECT_EQ(parse_double(" +0.1 ").value(), 0.1);
+    EXPECT_EQ(parse_double(".5").value(), 0.5);
+    EXPECT_EQ(parse_double("5.").value(), 5.0);
+    EXPECT_EQ(parse_double("2.2250738585072014e-308").value(), std::numeric_limits<double>::min());
+    EXPECT_TRUE(std::isinf(parse_double("-inf").value()));
+    EXPECT_TRUE(std::isnan(parse_double("nan").value()));
+    EXPECT_EQ(parse_double("1e400").error(), Errc::OutOfRange);
+    EXPECT_EQ(parse_double("1,5").error(), Errc::ParseError);
+    EXPECT_EQ(parse_double("0x10").error(), Errc::ParseError);
+    EXPECT_EQ(parse_double("   ").error(), Errc::ParseError);
+}
+
+TEST(NumberUtilsTest, FormatRoundTrips) {
+    EXPECT_EQ(format_int(0), "0");
+    EXPECT_EQ(format_int(std::numeric_limits<std::int64_t>::min()), "-9223372036854775808");
+    EXPECT_EQ(format_double(0.1), "0.1");
+    EXPECT_EQ(format_double(-2.5), "-2.5");
+    EXPECT_EQ(format_double(1e300), "1e+300");
+    EXPECT_EQ(format_double(std::numeric_limits<double>::infinity()), "inf");
+    EXPECT_EQ(format_double(3.14159, 2), "3.14");
+    EXPECT_EQ(format_double(-0.5, 0), "-0");
+    EXPECT_EQ(format_double(std::numeric_limits<double>::max(), 100).size(), 309u + 1 + 100);
+    EXPECT_THROW((void)format_double(1.0, -1), std::invalid_argument);
+
+    std::mt19937_64 rng(5);
+    for (int i = 0; i < 1000; ++i) {
+        const double value = std::bit_cast<double>(rng());
+        if (std::isfinite(value)) {
+            EXPECT_EQ(parse_double(format_double(value)).value(), value);
+        }
+    }
+}
+
+TEST(NumberUtilsTest, AppendWritesInPlace) {
+    std::string line = "x=";
+    append_int(line, -12);
+    line += ",y=";
+    append_double(line, 0.25);
+    EXPECT_EQ(line, "x=-12,y=0.25");
+}
+
+// parse_row at every SIMD level, against from_chars field by field
+
+class NumberSimdTest : public ::testing::TestWithParam<SimdLevel> {
+protected:
+    void SetUp() override {
+        if (set_simd_level(GetParam()) != GetParam()) {
+            GTEST_SKIP() << to_string(GetParam()) << " not supported on this CPU";
+        }
+    }
+
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+    }
+};
+
+TEST_P(NumberSimdTest, ParseRowMatchesFromChars) {
+    std::mt19937_64 rng(11);
+    auto digits = [&rng](std::size_t n) {
+        std::string result(n, '0');
+        for (auto& ch : result) {
+            ch = static_cast<char>('0' + rng() % 10);
+        }
+        return result;
+    };
+
+    std::vector<double> values;
+    for (int round = 0; round < 500; ++round) {
+        // Plain decimals of 1 to 20 characters, so both the fast path and
+        // the fallback run, with the odd exponent and sign
+        std::string row;
+        std::vector<std::string> fields;
+        for (std::size_t i = 0; i < 1 + rng() % 12; ++i) {
+            std::string field = rng() % 4 == 0 ? "-" : "";
+            const std::size_t integer = rng() % 12;
+            const std::size_t fraction = rng() % 9;
+            field += digits(integer);
+            if (fraction > 0 || integer == 0) {
+                field += '.' + digits(std::max<std::size_t>(fraction, 1));
+            }
+            if (rng() % 10 == 0) {
+                field += "e-" + digits(1);
+            }
+            fields.push_back(field);
+            row += (i == 0 ? "" : ",") + field;
+        }
+
+        const auto count = parse_row(row, ',', values);
+        ASSERT_TRUE(count.has_value()) << row;
+        ASSERT_EQ(*count, fields.size());
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            double expected = 0.0;
+            std::from_chars(fields[i].data(), fields[i].data() + fields[i].size(), expected);
+            // Bitwise, so -0 and 0 differ
+            EXPECT_EQ(std::bit_cast<std::uint64_t>(values[i]),
+                      std::bit_cast<std::uint64_t>(expected))
+                << fields[i] << " in " << row;
+        }
+    }
+}
+
+TEST_P(NumberSimdTest, ParseRowEdgeCases) {
+    std::vector<double> values = {99.0};
+    EXPECT_EQ(parse_row("", ',', values).value(), 0u);
+    EXPECT_TRUE(values.empty());
+    EXPECT_EQ(parse_row(" 1 ; -2.5;+3;1e3;.5;7.\r\n", ';', values).value(), 6u);
+    EXPECT_EQ(values, (std::vector<double>{1.0, -2.5, 3.0, 1000.0, 0.5, 7.0}));
+    EXPECT_EQ(parse_row("1234567890123456,0.000000000000001,9999999999999999", ',', values).value(),
+              3u);
+    EXPECT_EQ(values, (std::vector<double>{1234567890123456.0, 1e-15, 9999999999999999.0}));
+
+    EXPECT_EQ(parse_row("1,,2", ',', values).error(), Errc::ParseError);
+    EXPECT_EQ(values, std::vector<double>{1.0});
+    EXPECT_EQ(parse_row("1,2,", ',', values).error(), Errc::ParseError);
+    EXPECT_EQ(parse_row("1,.,2", ',', values).error(), Errc::ParseError);
+    EXPECT_EQ(parse_row("1.2.3", ',', values).error(), Errc::ParseError);
+    EXPECT_EQ(parse_row("-", ',', values).error(), Errc::ParseError);
+    EXPECT_EQ(parse_row("12a4", ',', values).error(), Errc::ParseError);
+    EXPECT_EQ(parse_row("1,1e999", ',', values).error(), Errc::OutOfRange);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, NumberSimdTest,
+                         ::testing::Values(SimdLevel::Scalar, SimdLevel::Sse42, SimdLevel::Avx2,
+                                           SimdLevel::Avx512, SimdLevel::Neon),
+                         [](const auto& info) {
+                             std::string name(to_string(info.param));
+                             std::replace(name.begin(), name.end(), '.', '_');
+                             return name;
+                         });
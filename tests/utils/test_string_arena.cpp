@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "cpptemplate/utils/string_arena.hpp"
+#include "cpptemplate/utils/string_utils.hpp"
+
+using namespace cpptemplate::utils;
+
+namespace {
+
+/// Whether ptr points into the arena's current block, just before its next allocation
+bool from_arena(StringArena& arena, const char* ptr) {
+    // Allocations are bump-pointer, so a fresh one lands right after the last
+    const auto* probe = static_cast<const char*>(arena.allocate(1, 1));
+    return ptr < probe && probe - ptr < 4096;
+}
+
+} // namespace
+
+TEST(StringArenaTest, OverloadsAllocateFromTheResource) {
+    StringArena arena;
+    const std::string long_input = "  a header value long enough to leave the small-string buffer  ";
+
+    const auto trimmed = trim(long_input, &arena);
+    EXPECT_EQ(std::string_view(trimmed), trim(long_input));
+    EXPECT_EQ(trimmed.get_allocator().resource(), &arena);
+    EXPECT_TRUE(from_arena(arena, trimmed.data()));
+
+    EXPECT_EQ(std::string_view(ltrim(long_input, &arena)), ltrim(long_input));
+    EXPECT_EQ(std::string_view(rtrim(long_input, &arena)), rtrim(long_input));
+    EXPECT_EQ(std::string_view(to_upper(long_input, &arena)), to_upper(long_input));
+    EXPECT_EQ(to_lower("MiXeD", &arena), "mixed");
+    EXPECT_EQ(std::string_view(replace_all(long_input, " ", "__", &arena)), replace_all(long_input, " ", "__"));
+    EXPECT_EQ(std::string_view(replace_all(long_input, "long", "", &arena)), replace_all(long_input, "long", ""));
+    EXPECT_GT(arena.bytes_used(), 0u);
+}
+
+TEST(StringArenaTest, SplitAndJoinShareTheResource) {
+    StringArena arena;
+    const auto fields = split("alpha,,beta,a value that does not fit inline,", ',', &arena);
+    ASSERT_EQ(fields.size(), 3u);
+    EXPECT_EQ(fields[0], "alpha");
+    EXPECT_EQ(fields[2], "a value that does not fit inline");
+    EXPECT_EQ(fields.get_allocator().resource(), &arena);
+    EXPECT_EQ(fields[2].get_allocator().resource(), &arena);
+
+    const auto joined = join(fields, " | ", &arena);
+    EXPECT_EQ(joined, "alpha | beta | a value that does not fit inline");
+    EXPECT_EQ(joined.get_allocator().resource(), &arena);
+}
+
+TEST(StringArenaTest, ReleaseReusesTheFirstBlock) {
+    StringArena arena(1024);
+    const void* first = arena.allocate(16, 8);
+    (void)arena.allocate(100000, 8); // Needs a block from upstream
+    EXPECT_EQ(arena.bytes_used(), 100016u);
+
+    arena.release();
+    EXPECT_EQ(arena.bytes_used(), 0u);
+    EXPECT_EQ(arena.allocate(16, 8), first);
+}
+
+TEST(StringArenaTest, ComparesEqualOnlyToItself) {
+    StringArena a;
+    StringArena b;
+    EXPECT_TRUE(a.is_equal(a));
+    EXPECT_FALSE(a.is_equal(b));
+    EXPECT_FALSE(a.is_equal(*std::pmr::new_delete_resource()));
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "cpptemplate/utils/string_interner.hpp"
+
+using namespace cpptemplate::utils;
+
+TEST(StringInternerTest, SameStringSameId) {
+    StringInterner interner;
+    const auto host = interner.intern("Host");
+    const auto accept = interner.intern("Accept");
+    EXPECT_NE(host, accept);
+    EXPECT_EQ(interner.intern(std::string("Host")), host);
+    EXPECT_EQ(interner.intern("host"), interner.intern("host"));
+    EXPECT_NE(interner.intern("host"), host);
+    EXPECT_EQ(interner.size(), 3u);
+    EXPECT_EQ(interner.storage_bytes(), 14u);
+}
+
+TEST(StringInternerTest, ViewsAreStableCopies) {
+    StringInterner interner;
+    std::string key = "Content-Type";
+    const auto id = interner.intern(key);
+    const auto view = interner.view(id);
+    key.assign("overwritten!");
+    EXPECT_EQ(view, "Content-Type");
+
+    // Growing the pool never moves earlier strings
+    for (int i = 0; i < 10000; ++i) {
+        (void)interner.intern("key-" + std::to_string(i));
+    }
+    EXPECT_EQ(interner.view(id).data(), view.data());
+    EXPECT_EQ(interner.view(interner.intern("key-1234")), "key-1234");
+}
+
+TEST(StringInternerTest, FindDoesNotAdd) {
+    StringInterner interner;
+    EXPECT_FALSE(interner.find("missing").has_value());
+    EXPECT_EQ(interner.size(), 0u);
+    const auto id = interner.intern("present");
+    EXPECT_EQ(interner.find("present"), id);
+}
+
+TEST(StringInternerTest, EmptyStringAndUnknownIds) {
+    StringInterner interner(1);
+    const auto empty = interner.intern("");
+    EXPECT_EQ(interner.view(empty), "");
+    EXPECT_EQ(interner.intern(""), empty);
+    EXPECT_THROW((void)interner.view(empty + 1), std::out_of_range);
+    EXPECT_THROW((void)StringInterner().view(0), std::out_of_range);
+}
+
+TEST(StringInternerTest, ShardCountsAreRoundedToPowersOfTwo) {
+    for (const std::size_t shards : {0, 1, 3, 16, 1000}) {
+        StringInterner interner(shards);
+        std::unordered_set<StringInterner::Id> ids;
+        for (int i = 0; i < 1000; ++i) {
+            const auto id = interner.intern(std::to_string(i));
+            ids.insert(id);
+            ASSERT_EQ(interner.view(id), std::to_string(i));
+        }
+        EXPECT_EQ(ids.size(), 1000u);
+        EXPECT_EQ(interner.size(), 1000u);
+    }
+}
+
+TEST(StringInternerTest, ConcurrentInternAgreesOnIds) {
+    StringInterner interner(4);
+    constexpr int Threads = 8;
+    constexpr int Keys = 2000;
+    std::vector<std::vector<StringInterner::Id>> ids(Threads, std::vector<StringInterner::Id>(Keys));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < Threads; ++t) {
+        threads.emplace_back([&, t] {
+            // Each thread starts at a different key, so they race to add each one
+            for (int i = 0; i < Keys; ++i) {
+                const int key = (i + t * Keys / Threads) % Keys;
+                const auto id = interner.intern("key-" + std::to_string(key));
+                ids[t][key] = id;
+                if (interner.view(id) != "key-" + std::to_string(key)) {
+                    ADD_FAILURE() << "Wrong view for key " << key;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(interner.size(), static_cast<std::size_t>(Keys));
+    for (int t = 1; t < Threads; ++t) {
+        EXPECT_EQ(ids[t], ids[0]);
+    }
+}
@@ -1,8 +1,19 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cpptemplate/core/simd.hpp"
 #include "cpptemplate/utils/string_utils.hpp"
 
 using namespace cpptemplate::utils;
+using cpptemplate::core::detected_simd_level;
+using cpptemplate::core::set_simd_level;
+using cpptemplate::core::SimdLevel;
+using cpptemplate::core::to_string;
 
 class StringUtilsTest : public ::testing::Test {
 protected:
@@ -177,4 +188,306 @@ TEST_F(StringUtilsTest, ReplaceAllWithEmpty) {
 
 TEST_F(StringUtilsTest, ReplaceAllOverlapping) {
     EXPECT_EQ(replace_all("aaa", "aa", "b"), "ba");
-}
\ No newline at end of file
+}
+// SIMD kernels against byte-at-a-time references, at every level the CPU supports
+
+namespace {
+
+std::string reference_upper(std::string_view str) {
+    std::string result(str);
+    for (auto& ch : result) {
+        if (ch >= 'a' && ch <= 'z') {
+            ch = static_cast<char>(ch - 'a' + 'A');
+        }
+    }
+    return result;
+}
+
+std::string reference_lower(std::string_view str) {
+    std::string result(str);
+    for (auto& ch : result) {
+        if (ch >= 'A' && ch <= 'Z') {
+            ch = static_cast<char>(ch - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+bool reference_space(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+}
+
+/// Every byte value, letters and whitespace boundaries included
+std::string all_bytes(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::string result(n, '\0');
+    for (auto& ch : result) {
+        ch = static_cast<char>(byte(rng));
+    }
+    return result;
+}
+
+} // namespace
+
+class StringSimdTest : public ::testing::TestWithParam<SimdLevel> {
+protected:
+    void SetUp() override {
+        if (set_simd_level(GetParam()) != GetParam()) {
+            GTEST_SKIP() << to_string(GetParam()) << " not supported on this CPU";
+        }
+    }
+
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+    }
+};
+
+TEST_P(StringSimdTest, CaseConversionMatchesReference) {
+    // Lengths around the 16- and 32-byte vector widths
+    for (std::size_t n = 0; n <= 100; ++n) {
+        const auto str = all_bytes(n, static_cast<unsigned>(n));
+        EXPECT_EQ(to_upper(str), reference_upper(str)) << n;
+        EXPECT_EQ(to_lower(str), reference_lower(str)) << n;
+    }
+    const std::string boundaries = "@AZ[`az{\x7f\x80\xc1\xe1\xff";
+    EXPECT_EQ(to_upper(boundaries), "@AZ[`AZ{\x7f\x80\xc1\xe1\xff");
+    EXPECT_EQ(to_lower(boundaries), "@az[`az{\x7f\x80\xc1\xe1\xff");
+}
+
+TEST_P(StringSimdTest, TrimFindsFirstAndLastNonSpace) {
+    const std::string spaces = " \t\n\v\f\r";
+    for (std::size_t lead = 0; lead <= 40; lead += 3) {
+        for (std::size_t trail = 0; trail <= 40; trail += 5) {
+            std::string padded;
+            for (std::size_t i = 0; i < lead; ++i) {
+                padded += spaces[i % spaces.size()];
+            }
+            padded += "a \x08 b\x0e";
+            for (std::size_t i = 0; i < trail; ++i) {
+                padded += spaces[(i + 3) % spaces.size()];
+            }
+            EXPECT_EQ(trim(padded), "a \x08 b\x0e");
+            EXPECT_EQ(ltrim(padded), padded.substr(lead));
+            EXPECT_EQ(rtrim(padded), padded.substr(0, padded.size() - trail));
+        }
+        EXPECT_EQ(trim(std::string(lead, ' ')), "");
+    }
+    for (std::size_t n = 0; n <= 70; ++n) {
+        const auto str = all_bytes(n, static_cast<unsigned>(n) + 7);
+        const auto begin = std::find_if_not(str.begin(), str.end(), reference_space);
+        const auto end = std::find_if_not(str.rbegin(), str.rend(), reference_space).base();
+        EXPECT_EQ(trim(str), begin < end ? std::string(begin, end) : std::string());
+    }
+}
+
+TEST_P(StringSimdTest, SplitFindsEveryDelimiter) {
+    for (std::size_t n = 0; n <= 100; n += 7) {
+        std::string str;
+        std::vector<std::string> expected;
+        for (std::size_t i = 0; i < n; ++i) {
+            expected.push_back(std::string(i % 37 + 1, static_cast<char>('a' + i % 26)));
+            str += expected.back();
+            str += (i % 3 == 0) ? ",," : ",";
+        }
+        EXPECT_EQ(split(str, ','), expected);
+    }
+    EXPECT_EQ(split(std::string(100, ','), ','), std::vector<std::string>{});
+    EXPECT_EQ(split(std::string("\xff\xfe\xff", 3), '\xfe'),
+              (std::vector<std::string>{"\xff", "\xff"}));
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, StringSimdTest,
+                         ::testing::Values(SimdLevel::Scalar, SimdLevel::Sse42, SimdLevel::Avx2,
+                                           SimdLevel::Avx512, SimdLevel::Neon),
+                         [](const auto& info) {
+                             std::string name(to_string(info.param));
+                             std::replace(name.begin(), name.end(), '.', '_');
+                             return name;
+                         });
+
+// Zero-copy variants
+
+TEST_F(StringUtilsTest, TrimViewsPointIntoInput) {
+    const std::string input = " \t value \r\n";
+    const auto trimmed = trim_view(input);
+    EXPECT_EQ(trimmed, "value");
+    EXPECT_EQ(trimmed.data(), input.data() + 3);
+    EXPECT_EQ(ltrim_view(input), "value \r\n");
+    EXPECT_EQ(rtrim_view(input), " \t value");
+    EXPECT_EQ(trim_view("   "), "");
+    EXPECT_EQ(trim_view(""), "");
+}
+
+TEST_F(StringUtilsTest, SplitViewMatchesSplit) {
+    for (const std::string input : {"", ",", "a", "a,b", ",,a,,b,,", "one,two,,three,"}) {
+        const auto views = split_view(input, ',');
+        const auto strings = split(input, ',');
+        ASSERT_EQ(views.size(), strings.size()) << input;
+        for (std::size_t i = 0; i < views.size(); ++i) {
+            EXPECT_EQ(views[i], strings[i]);
+            EXPECT_GE(views[i].data(), input.data());
+            EXPECT_LE(views[i].data() + views[i].size(), input.data() + input.size());
+        }
+    }
+}
+
+TEST_F(StringUtilsTest, SplitIntoBufferReusesCapacity) {
+    std::vector<std::string_view> fields;
+    EXPECT_EQ(split("a,b,c,d", ',', fields), 4u);
+    EXPECT_EQ(fields, (std::vector<std::string_view>{"a", "b", "c", "d"}));
+    const auto* storage = fields.data();
+    EXPECT_EQ(split("x,,y", ',', fields), 2u);
+    EXPECT_EQ(fields, (std::vector<std::string_view>{"x", "y"}));
+    EXPECT_EQ(fields.data(), storage);
+    EXPECT_EQ(split("", ',', fields), 0u);
+    EXPECT_TRUE(fields.empty());
+}
+
+TEST_F(StringUtilsTest, TokenizerIsLazyForwardRange) {
+    static_assert(std::ranges::forward_range<Tokenizer>);
+    static_assert(std::ranges::view<Tokenizer>);
+    static_assert(std::ranges::borrowed_range<Tokenizer>);
+
+    std::vector<std::string_view> tokens;
+    for (const std::string_view token : Tokenizer(",,alpha,beta,,gamma,", ',')) {
+        tokens.push_back(token);
+    }
+    EXPECT_EQ(tokens, (std::vector<std::string_view>{"alpha", "beta", "gamma"}));
+
+    EXPECT_TRUE(Tokenizer("", ',').empty());
+    EXPECT_TRUE(Tokenizer(",,,", ',').empty());
+    EXPECT_EQ(std::ranges::distance(Tokenizer("a b  c", ' ')), 3);
+
+    // Iterators outlive the Tokenizer and copies advance independently
+    auto it = Tokenizer("k=v;x=y", ';').begin();
+    auto copy = it++;
+    EXPECT_EQ(*copy, "k=v");
+    EXPECT_EQ(*it, "x=y");
+    EXPECT_EQ(++it, Tokenizer::iterator{});
+}
+
+// Single-pass join and replacement
+
+TEST_F(StringUtilsTest, JoinSizesResultExactly) {
+    const std::vector<std::string> parts = {"", "a", "", "bc", ""};
+    const auto joined = join(parts, "::");
+    EXPECT_EQ(joined, "::a::::bc::");
+    EXPECT_EQ(join({"x", "y"}, ""), "xy");
+}
+
+TEST_F(StringUtilsTest, ReplaceAllChangesLength) {
+    EXPECT_EQ(replace_all("a.b.c", ".", "::"), "a::b::c");
+    EXPECT_EQ(replace_all("a::b::c", "::", "."), "a.b.c");
+    EXPECT_EQ(replace_all("abab", "ab", "ba"), "baba");
+    EXPECT_EQ(replace_all("xxxx", "x", "xx"), "xxxxxxxx");
+    EXPECT_EQ(replace_all(std::string(1000, 'a'), "a", ""), "");
+}
+
+TEST_F(StringUtilsTest, MultiReplaceSubstitutesEveryPattern) {
+    const MultiReplacer escape({{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}, {"\"", "&quot;"}});
+    EXPECT_EQ(escape.size(), 4u);
+    EXPECT_EQ(escape.replace(R"(<a href="x">&</a>)"),
+              "&lt;a href=&quot;x&quot;&gt;&amp;&lt;/a&gt;");
+    EXPECT_EQ(escape.replace("plain"), "plain");
+    EXPECT_EQ(escape.replace(""), "");
+    // Inserted text is never rescanned
+    EXPECT_EQ(escape.replace("&amp;"), "&amp;amp;");
+}
+
+TEST_F(StringUtilsTest, MultiReplacePrefersLeftmostThenLongest) {
+    EXPECT_EQ(replace_all("abcd", {{"bc", "X"}, {"abcd", "Y"}}), "Y");
+    EXPECT_EQ(replace_all("abcx", {{"bc", "X"}, {"abcd", "Y"}}), "aXx");
+    EXPECT_EQ(replace_all("hers", {{"he", "1"}, {"hers", "2"}, {"she", "3"}}), "2");
+    EXPECT_EQ(replace_all("ushers", {{"he", "1"}, {"hers", "2"}, {"she", "3"}}), "u3rs");
+    EXPECT_EQ(replace_all("aaaa", {{"a", "1"}, {"aa", "2"}}), "22");
+    EXPECT_EQ(replace_all("aaa", {{"aa", "b"}}), "ba");
+    // A duplicate pattern keeps its first replacement
+    EXPECT_EQ(replace_all("cat", {{"cat", "dog"}, {"cat", "cow"}}), "dog");
+}
+
+TEST_F(StringUtilsTest, MultiReplaceMatchesRepeatedSingleReplace) {
+    // Patterns without overlaps give the same result as one pass per pattern
+    const std::vector<std::pair<std::string, std::string>> pairs = {
+        {"{name}", "World"}, {"{greeting}", "Hello"}, {"{punct}", "!"}};
+    const std::string text = "{greeting}, {name}{punct} {name}{name} {unknown}";
+    std::string expected = text;
+    for (const auto& [from, to] : pairs) {
+        expected = replace_all(expected, from, to);
+    }
+    EXPECT_EQ(replace_all(text, pairs), expected);
+    EXPECT_EQ(replace_all(std::string_view("\x80\xff{name}\x00", 9), pairs),
+              std::string("\x80\xffWorld\x00", 8));
+}
+
+TEST_F(StringUtilsTest, MultiReplaceRejectsEmptyPattern) {
+    EXPECT_THROW(MultiReplacer({{"a", "b"}, {"", "c"}}), std::invalid_argument);
+    EXPECT_EQ(replace_all("abc", {}), "abc");
+}
+
+TEST_F(StringUtilsTest, MultiReplaceHandlesEveryByteValue) {
+    // One pattern per byte value plus a two-byte one: 257 columns
+    std::vector<std::pair<std::string, std::string>> pairs;
+    std::string text;
+    std::string expected;
+    for (int byte = 1; byte < 256; ++byte) {
+        const std::string replacement = '[' + std::to_string(byte) + ']';
+        pairs.emplace_back(std::string(1, static_cast<char>(byte)), replacement);
+        text += static_cast<char>(byte);
+        expected += replacement;
+    }
+    pairs.emplace_back(std::string(1, '\0'), "<nul>");
+    pairs.emplace_back(std::string(2, '\0'), "<two-nul>");
+    const MultiReplacer replacer(pairs);
+
+    EXPECT_EQ(replacer.replace("\x01\x01"), "[1][1]");
+    EXPECT_EQ(replacer.replace("\xff\xfe"), "[255][254]");
+    EXPECT_EQ(replacer.replace(std::string_view("\0\0\0", 3)), "<two-nul><nul>");
+    EXPECT_EQ(replacer.replace(text), expected);
+    EXPECT_EQ(replacer.replace(text.insert(0, 1, '\0')), expected.insert(0, "<nul>"));
+}
+
+TEST_F(StringUtilsTest, MultiReplaceMatchesBruteForce) {
+    // Small alphabet so patterns overlap and share prefixes and suffixes
+    std::mt19937 rng(7);
+    auto random_string = [&rng](std::size_t max_length) {
+        std::string result(1 + rng() % max_length, 'a');
+        for (auto& ch : result) {
+            ch = static_cast<char>('a' + rng() % 3);
+        }
+        return result;
+    };
+    for (int round = 0; round < 200; ++round) {
+        std::vector<std::pair<std::string, std::string>> pairs;
+        for (int i = 0; i < 1 + round % 6; ++i) {
+            pairs.emplace_back(random_string(4), std::to_string(i));
+        }
+        const std::string text = random_string(40);
+
+        // At each position take the longest pattern starting there, first listed on ties
+        std::string expected;
+        for (std::size_t pos = 0; pos < text.size();) {
+            const std::pair<std::string, std::string>* best = nullptr;
+            for (const auto& pair : pairs) {
+                if (text.compare(pos, pair.first.size(), pair.first) == 0 &&
+                    (best == nullptr || pair.first.size() > best->first.size())) {
+                    best = &pair;
+                }
+            }
+            if (best != nullptr) {
+                expected += best->second;
+                pos += best->first.size();
+            } else {
+                expected += text[pos++];
+            }
+        }
+        ASSERT_EQ(replace_all(text, pairs), expected) << "round " << round;
+    }
+}
+
+TEST_F(StringUtilsTest, ReplaceAllShrinksInPlace) {
+    EXPECT_EQ(replace_all("--a----b--", "--", "-"), "-a--b-");
+    EXPECT_EQ(replace_all("<br><br>x<br>", "<br>", ""), "x");
+    EXPECT_EQ(replace_all("same size", "size", "SIZE"), "same SIZE");
+    EXPECT_EQ(replace_all("abc", "abc", "x"), "x");
+}